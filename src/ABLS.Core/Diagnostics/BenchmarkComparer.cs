@@ -0,0 +1,137 @@
+using Newtonsoft.Json.Linq;
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+
+namespace ABLS.Core.Diagnostics
+{
+    /// <summary>
+    /// Compares two firmware benchmark runs (JSON lines from RUN_BENCHMARK on a
+    /// module, UDP 8010, or from HostSim's abls-bench) and flags cases that got slower.
+    /// </summary>
+    /// <remarks>
+    /// Each run is a header line ("type":"abls-benchmark" with firmware, target and
+    /// cpu_hz), one "result" line per case and an "end" line with the case count.
+    /// Cases are compared on min_cycles per operation, the least noisy figure.
+    /// Runs from different targets or clock rates are not comparable and are refused.
+    /// </remarks>
+    public class BenchmarkComparer
+    {
+        /// <summary>
+        /// A case is only a regression if it also slowed by at least this many
+        /// cycles - keeps jitter on very short cases from failing a build.
+        /// </summary>
+        private const long MinimumCycleIncrease = 20;
+
+        public double ThresholdPercent { get; set; } = 10.0;
+
+        /// <summary>
+        /// Cases slower than the threshold in the last comparison.
+        /// </summary>
+        public int Regressions { get; private set; }
+
+        public void Compare(string baselinePath, string currentPath, TextWriter output)
+        {
+            var baseline = Load(baselinePath);
+            var current = Load(currentPath);
+
+            if (baseline.Target != current.Target || baseline.CpuHz != current.CpuHz)
+            {
+                throw new InvalidDataException(
+                    $"Runs are not comparable: {baseline.Target} at {baseline.CpuHz}Hz vs {current.Target} at {current.CpuHz}Hz");
+            }
+
+            output.WriteLine($"Baseline {baseline.Firmware} ({baseline.Git}), current {current.Firmware} ({current.Git}), " +
+                $"{current.Target}, threshold {ThresholdPercent.ToString("F1", CultureInfo.InvariantCulture)}%");
+            output.WriteLine($"{"case",-20} {"baseline",12} {"current",12} {"change",9}");
+
+            Regressions = 0;
+            foreach (var (name, cycles) in current.MinCycles)
+            {
+                if (!baseline.MinCycles.TryGetValue(name, out long before))
+                {
+                    output.WriteLine($"{name,-20} {"-",12} {cycles,12} {"new",9}");
+                    continue;
+                }
+
+                double change = before > 0 ? (cycles - before) * 100.0 / before : 0.0;
+                bool regression = change > ThresholdPercent && cycles - before >= MinimumCycleIncrease;
+                if (regression) Regressions++;
+
+                output.WriteLine($"{name,-20} {before,12} {cycles,12} {change.ToString("+0.0;-0.0;0.0", CultureInfo.InvariantCulture) + "%",9}" +
+                    (regression ? "  REGRESSION" : ""));
+            }
+
+            foreach (var name in baseline.MinCycles.Keys)
+            {
+                if (!current.MinCycles.ContainsKey(name))
+                {
+                    output.WriteLine($"{name,-20} {baseline.MinCycles[name],12} {"-",12} {"missing",9}");
+                }
+            }
+        }
+
+        private class BenchmarkRun
+        {
+            public string Firmware = "";
+            public string Git = "";
+            public string Target = "";
+            public long CpuHz;
+            public readonly Dictionary<string, long> MinCycles = new Dictionary<string, long>();
+        }
+
+        private static BenchmarkRun Load(string path)
+        {
+            var run = new BenchmarkRun();
+            bool haveHeader = false;
+            int expectedCases = -1;
+
+            foreach (var line in File.ReadLines(path))
+            {
+                if (string.IsNullOrWhiteSpace(line)) continue;
+
+                // Console captures may carry other output - only JSON lines count
+                JObject record;
+                try
+                {
+                    record = JObject.Parse(line);
+                }
+                catch (Newtonsoft.Json.JsonReaderException)
+                {
+                    continue;
+                }
+
+                switch ((string?)record["type"])
+                {
+                    case "abls-benchmark":
+                        haveHeader = true;
+                        run.Firmware = (string?)record["firmware"] ?? "";
+                        run.Git = (string?)record["git"] ?? "";
+                        run.Target = (string?)record["target"] ?? "";
+                        run.CpuHz = (long?)record["cpu_hz"] ?? 0;
+                        break;
+                    case "result":
+                        run.MinCycles[(string?)record["name"] ?? ""] = (long?)record["min_cycles"] ?? 0;
+                        break;
+                    case "end":
+                        expectedCases = (int?)record["cases"] ?? -1;
+                        break;
+                    case "error":
+                        throw new InvalidDataException($"{path}: benchmark not run - {(string?)record["reason"]}");
+                }
+            }
+
+            if (!haveHeader)
+            {
+                throw new InvalidDataException($"{path}: no benchmark header");
+            }
+            if (expectedCases >= 0 && expectedCases != run.MinCycles.Count)
+            {
+                // UDP results can be lost - a partial run would hide regressions
+                throw new InvalidDataException($"{path}: {run.MinCycles.Count} of {expectedCases} cases present");
+            }
+            return run;
+        }
+    }
+}
@@ -0,0 +1,334 @@
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Text;
+
+namespace ABLS.Core.Diagnostics
+{
+    /// <summary>
+    /// Turns a module's binary event log (/logs/abls_NNN.blg, written by BinaryLog
+    /// in the firmware) back into text lines in the same layout as the SD text log.
+    /// </summary>
+    /// <remarks>
+    /// The file is a sequence of sections, one per boot or day, each starting with
+    /// a 16-byte header ("ABLSBLOG", version, role, start millis). Records carry an
+    /// 8-byte header (sync 0xA5, type, length, millis). DEFINE records give a call
+    /// site's level, component and printf format; EVENT records give the site ID and
+    /// the tagged raw arguments, which are formatted here rather than on the module.
+    /// </remarks>
+    public class BinaryLogDecoder
+    {
+        private const string FileMagic = "ABLSBLOG";
+        private const int FileHeaderSize = 16;
+        private const int RecordHeaderSize = 8;
+        private const byte RecordSync = 0xA5;
+
+        private const byte RecordDefine = 1;
+        private const byte RecordEvent = 2;
+        private const byte RecordDropped = 3;
+
+        private static readonly string[] LevelNames = { "DEBUG", "INFO", "WARN", "ERROR", "CRIT" };
+        private static readonly string[] RoleNames = { "LEFT_WING", "CENTRE", "RIGHT_WING", "SPARE_3", "SPARE_4" };
+
+        private class Site
+        {
+            public int Level;
+            public string Component = "";
+            public string Format = "";
+        }
+
+        private readonly Dictionary<uint, Site> _sites = new Dictionary<uint, Site>();
+
+        /// <summary>
+        /// Number of records skipped because they were damaged or referenced an undefined site.
+        /// </summary>
+        public int SkippedRecords { get; private set; }
+
+        /// <summary>
+        /// Decodes a whole log file, writing one line per record.
+        /// </summary>
+        public void Decode(string path, TextWriter output)
+        {
+            Decode(File.ReadAllBytes(path), output);
+        }
+
+        /// <summary>
+        /// Decodes log bytes, writing one line per record.
+        /// </summary>
+        public void Decode(byte[] data, TextWriter output)
+        {
+            int offset = 0;
+            while (offset < data.Length)
+            {
+                if (IsFileHeader(data, offset))
+                {
+                    // New section - sites define themselves again
+                    _sites.Clear();
+                    byte role = data[offset + 10];
+                    uint startMillis = BitConverter.ToUInt32(data, offset + 12);
+                    string roleName = role < RoleNames.Length ? RoleNames[role] : "UNKNOWN";
+                    output.WriteLine($"{FormatTimestamp(startMillis)} --- log start, {roleName} module ---");
+                    offset += FileHeaderSize;
+                    continue;
+                }
+
+                if (data[offset] != RecordSync || offset + RecordHeaderSize > data.Length)
+                {
+                    // Damaged or unused space - resynchronise on the next record
+                    offset++;
+                    continue;
+                }
+
+                byte type = data[offset + 1];
+                int length = BitConverter.ToUInt16(data, offset + 2);
+                uint millis = BitConverter.ToUInt32(data, offset + 4);
+                if (length < RecordHeaderSize || offset + length > data.Length)
+                {
+                    SkippedRecords++;
+                    offset++;
+                    continue;
+                }
+
+                DecodeRecord(type, millis, data, offset + RecordHeaderSize, length - RecordHeaderSize, output);
+                offset += length;
+            }
+        }
+
+        private void DecodeRecord(byte type, uint millis, byte[] data, int offset, int length, TextWriter output)
+        {
+            switch (type)
+            {
+                case RecordDefine:
+                    if (length < 6) { SkippedRecords++; return; }
+                    uint defineId = BitConverter.ToUInt32(data, offset);
+                    var site = new Site { Level = data[offset + 4] };
+                    int position = offset + 6;
+                    site.Component = ReadCString(data, ref position, offset + length);
+                    site.Format = ReadCString(data, ref position, offset + length);
+                    _sites[defineId] = site;
+                    break;
+
+                case RecordEvent:
+                    if (length < 4) { SkippedRecords++; return; }
+                    uint siteId = BitConverter.ToUInt32(data, offset);
+                    if (!_sites.TryGetValue(siteId, out Site? eventSite))
+                    {
+                        SkippedRecords++;
+                        return;
+                    }
+                    var args = ReadArguments(data, offset + 4, offset + length);
+                    string level = eventSite.Level < LevelNames.Length ? LevelNames[eventSite.Level] : "UNKNOWN";
+                    output.WriteLine($"{FormatTimestamp(millis)} [{level}] {eventSite.Component}: {FormatMessage(eventSite.Format, args)}");
+                    break;
+
+                case RecordDropped:
+                    uint count = length >= 4 ? BitConverter.ToUInt32(data, offset) : 0;
+                    output.WriteLine($"{FormatTimestamp(millis)} [WARN] BinaryLog: {count} events dropped");
+                    break;
+
+                default:
+                    SkippedRecords++;
+                    break;
+            }
+        }
+
+        private static bool IsFileHeader(byte[] data, int offset)
+        {
+            if (offset + FileHeaderSize > data.Length) return false;
+            for (int i = 0; i < FileMagic.Length; i++)
+            {
+                if (data[offset + i] != (byte)FileMagic[i]) return false;
+            }
+            return true;
+        }
+
+        private static string ReadCString(byte[] data, ref int position, int end)
+        {
+            int start = position;
+            while (position < end && data[position] != 0) position++;
+            string text = Encoding.ASCII.GetString(data, start, position - start);
+            if (position < end) position++; // Terminator
+            return text;
+        }
+
+        private static List<object> ReadArguments(byte[] data, int position, int end)
+        {
+            var args = new List<object>();
+            while (position < end)
+            {
+                char tag = (char)data[position++];
+                switch (tag)
+                {
+                    case 'i': args.Add((long)BitConverter.ToInt32(data, position)); position += 4; break;
+                    case 'u': args.Add((ulong)BitConverter.ToUInt32(data, position)); position += 4; break;
+                    case 'q': args.Add(BitConverter.ToInt64(data, position)); position += 8; break;
+                    case 'Q': args.Add(BitConverter.ToUInt64(data, position)); position += 8; break;
+                    case 'f': args.Add((double)BitConverter.ToSingle(data, position)); position += 4; break;
+                    case 'd': args.Add(BitConverter.ToDouble(data, position)); position += 8; break;
+                    case 's':
+                        int size = data[position++];
+                        args.Add(Encoding.ASCII.GetString(data, position, Math.Min(size, end - position)));
+                        position += size;
+                        break;
+                    default:
+                        return args; // Unknown tag - the rest cannot be located
+                }
+            }
+            return args;
+        }
+
+        /// <summary>
+        /// printf subset used by BLOG() sites: flags "-0+ ", width, precision,
+        /// length modifiers (ignored - the record carries the real type) and
+        /// the d i u x X o c s f F e E g G % conversions.
+        /// </summary>
+        public static string FormatMessage(string format, IReadOnlyList<object> args)
+        {
+            var result = new StringBuilder();
+            int argIndex = 0;
+
+            for (int i = 0; i < format.Length; i++)
+            {
+                char c = format[i];
+                if (c != '%' || i + 1 >= format.Length)
+                {
+                    result.Append(c);
+                    continue;
+                }
+
+                // Flags
+                int j = i + 1;
+                bool leftAlign = false, zeroPad = false, plus = false, space = false;
+                for (; j < format.Length && "-0+ #".IndexOf(format[j]) >= 0; j++)
+                {
+                    if (format[j] == '-') leftAlign = true;
+                    if (format[j] == '0') zeroPad = true;
+                    if (format[j] == '+') plus = true;
+                    if (format[j] == ' ') space = true;
+                }
+
+                int width = 0;
+                for (; j < format.Length && char.IsDigit(format[j]); j++) width = width * 10 + (format[j] - '0');
+
+                int precision = -1;
+                if (j < format.Length && format[j] == '.')
+                {
+                    precision = 0;
+                    for (j++; j < format.Length && char.IsDigit(format[j]); j++) precision = precision * 10 + (format[j] - '0');
+                }
+
+                for (; j < format.Length && "hlLqjzt".IndexOf(format[j]) >= 0; j++) { }
+                if (j >= format.Length)
+                {
+                    result.Append(format, i, format.Length - i);
+                    break;
+                }
+
+                char conversion = format[j];
+                i = j;
+
+                if (conversion == '%')
+                {
+                    result.Append('%');
+                    continue;
+                }
+
+                if (argIndex >= args.Count)
+                {
+                    result.Append("<missing>");
+                    continue;
+                }
+
+                string text = FormatArgument(conversion, precision, args[argIndex++]);
+                if ((plus || space) && "dieEfFgG".IndexOf(conversion) >= 0 && !text.StartsWith("-"))
+                {
+                    text = (plus ? "+" : " ") + text;
+                }
+
+                if (text.Length < width)
+                {
+                    if (leftAlign)
+                    {
+                        text = text.PadRight(width);
+                    }
+                    else if (zeroPad && conversion != 's' && conversion != 'c')
+                    {
+                        bool signed = text.Length > 0 && (text[0] == '-' || text[0] == '+' || text[0] == ' ');
+                        text = signed ? text[0] + text.Substring(1).PadLeft(width - 1, '0') : text.PadLeft(width, '0');
+                    }
+                    else
+                    {
+                        text = text.PadLeft(width);
+                    }
+                }
+
+                result.Append(text);
+            }
+
+            return result.ToString();
+        }
+
+        private static string FormatArgument(char conversion, int precision, object value)
+        {
+            var invariant = CultureInfo.InvariantCulture;
+
+            switch (conversion)
+            {
+                case 'd':
+                case 'i':
+                    return Convert.ToInt64(value is ulong u ? unchecked((long)u) : value, invariant).ToString(invariant);
+                case 'u':
+                    return (value is long l ? unchecked((ulong)l) : Convert.ToUInt64(value, invariant)).ToString(invariant);
+                case 'x':
+                    return ToUnsigned(value).ToString("x", invariant);
+                case 'X':
+                    return ToUnsigned(value).ToString("X", invariant);
+                case 'o':
+                    return Convert.ToString(unchecked((long)ToUnsigned(value)), 8);
+                case 'c':
+                    return ((char)ToUnsigned(value)).ToString();
+                case 's':
+                    string s = value as string ?? Convert.ToString(value, invariant) ?? "";
+                    return precision >= 0 && precision < s.Length ? s.Substring(0, precision) : s;
+                case 'f':
+                case 'F':
+                    return Convert.ToDouble(value, invariant).ToString("F" + (precision < 0 ? 6 : precision), invariant);
+                case 'e':
+                case 'E':
+                    return FormatExponent(Convert.ToDouble(value, invariant), precision < 0 ? 6 : precision, conversion);
+                case 'g':
+                case 'G':
+                    return Convert.ToDouble(value, invariant).ToString("G" + (precision <= 0 ? 6 : precision), invariant);
+                default:
+                    return Convert.ToString(value, invariant) ?? "";
+            }
+        }
+
+        private static ulong ToUnsigned(object value)
+        {
+            // Negative 32-bit values print as their 32-bit pattern, as on the module
+            if (value is long l) return l < 0 && l >= int.MinValue ? (uint)(int)l : unchecked((ulong)l);
+            return Convert.ToUInt64(value, CultureInfo.InvariantCulture);
+        }
+
+        private static string FormatExponent(double value, int precision, char conversion)
+        {
+            // C style: one leading digit, at least two exponent digits
+            string text = value.ToString((conversion == 'E' ? "E" : "e") + precision, CultureInfo.InvariantCulture);
+            int marker = text.IndexOfAny(new[] { 'e', 'E' });
+            string mantissa = text.Substring(0, marker + 2);
+            int exponent = int.Parse(text.Substring(marker + 2), CultureInfo.InvariantCulture);
+            return mantissa + exponent.ToString("00", CultureInfo.InvariantCulture);
+        }
+
+        private static string FormatTimestamp(uint millis)
+        {
+            // Matches DiagnosticManager::formatTimestamp()
+            uint seconds = millis / 1000;
+            uint minutes = seconds / 60;
+            uint hours = minutes / 60;
+            return $"{hours % 24:00}:{minutes % 60:00}:{seconds % 60:00}.{millis % 1000:000}";
+        }
+    }
+}
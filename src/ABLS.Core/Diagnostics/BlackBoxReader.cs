@@ -0,0 +1,151 @@
+using System;
+using System.Globalization;
+using System.IO;
+using System.Text;
+
+namespace ABLS.Core.Diagnostics
+{
+    /// <summary>
+    /// Turns a module's black-box recording (/blackbox/bb_NNN.bin, written by
+    /// FlightRecorder in the firmware) into CSV, one row per record, oldest first.
+    /// </summary>
+    /// <remarks>
+    /// The first 512-byte sector is a header ("ABLSBBOX", mode, capacity, bytes
+    /// written, ring offset, trigger). Records are fixed 32 bytes: type, channel,
+    /// sequence, micros, then a 24-byte payload. In triggered mode the data area
+    /// is a ring - once more than its capacity has been written the oldest record
+    /// starts at the ring offset. Type 0 records are sector padding and are skipped.
+    /// </remarks>
+    public class BlackBoxReader
+    {
+        private const string FileMagic = "ABLSBBOX";
+        private const int RecordSize = 32;
+        private const int PayloadColumns = 12;
+
+        private const byte RecordImu = 1;
+        private const byte RecordRadar = 2;
+        private const byte RecordGnss = 3;
+        private const byte RecordRam = 4;
+        private const byte RecordCommand = 5;
+        private const byte RecordTrigger = 6;
+
+        private static readonly string[] TypeNames = { "EMPTY", "IMU", "RADAR", "GNSS", "RAM", "COMMAND", "TRIGGER" };
+        private static readonly string[] TriggerNames = { "NONE", "SAFETY", "ESTOP", "MANUAL" };
+
+        /// <summary>
+        /// Records read, and sequence gaps seen (records the module dropped).
+        /// </summary>
+        public int Records { get; private set; }
+        public int SequenceGaps { get; private set; }
+
+        /// <summary>
+        /// Converts a whole recording, writing a summary line to <paramref name="summary"/>
+        /// and the records as CSV to <paramref name="output"/>.
+        /// </summary>
+        public void Convert(string path, TextWriter output, TextWriter summary)
+        {
+            Convert(File.ReadAllBytes(path), output, summary);
+        }
+
+        public void Convert(byte[] data, TextWriter output, TextWriter summary)
+        {
+            if (data.Length < 64 || Encoding.ASCII.GetString(data, 0, FileMagic.Length) != FileMagic)
+            {
+                throw new InvalidDataException("Not a black-box recording");
+            }
+
+            byte mode = data[10];
+            byte role = data[11];
+            int headerSize = BitConverter.ToUInt16(data, 14);
+            uint capacity = BitConverter.ToUInt32(data, 16);
+            uint dataBytes = BitConverter.ToUInt32(data, 20);
+            uint ringOffset = BitConverter.ToUInt32(data, 24);
+            uint triggerReason = BitConverter.ToUInt32(data, 28);
+            uint triggerMicros = BitConverter.ToUInt32(data, 32);
+            uint dropped = BitConverter.ToUInt32(data, 40);
+            bool complete = data[48] != 0;
+
+            string trigger = triggerReason < TriggerNames.Length ? TriggerNames[triggerReason] : "UNKNOWN";
+            summary.WriteLine($"Mode {(mode == 1 ? "continuous" : "triggered")}, role {role}, " +
+                $"{Math.Min(dataBytes, capacity) / RecordSize} record slots used, {dropped} dropped, " +
+                $"trigger {trigger} at {triggerMicros}us{(complete ? "" : ", not closed cleanly")}");
+
+            // Oldest first: after the ring offset to the end, then from the start
+            long available = Math.Min(Math.Min((long)dataBytes, capacity), data.Length - headerSize);
+            long start = dataBytes > capacity ? ringOffset : 0;
+
+            output.WriteLine("type,channel,sequence,micros,v1,v2,v3,v4,v5,v6,v7,v8,v9,v10,v11,v12");
+            int lastSequence = -1;
+            for (long i = 0; i + RecordSize <= available; i += RecordSize)
+            {
+                int offset = headerSize + (int)((start + i) % available);
+                byte type = data[offset];
+                if (type == 0) continue;
+
+                int sequence = BitConverter.ToUInt16(data, offset + 2);
+                if (lastSequence >= 0 && sequence != ((lastSequence + 1) & 0xFFFF)) SequenceGaps++;
+                lastSequence = sequence;
+                Records++;
+
+                string name = type < TypeNames.Length ? TypeNames[type] : type.ToString(CultureInfo.InvariantCulture);
+                output.WriteLine($"{name},{data[offset + 1]},{sequence},{BitConverter.ToUInt32(data, offset + 4)},{string.Join(",", PadColumns(FormatPayload(type, data, offset + 8)))}");
+            }
+        }
+
+        private static object[] PadColumns(object[] values)
+        {
+            var columns = new object[PayloadColumns];
+            for (int i = 0; i < columns.Length; i++) columns[i] = i < values.Length ? values[i] : "";
+            return columns;
+        }
+
+        private static object[] FormatPayload(byte type, byte[] data, int p)
+        {
+            var invariant = CultureInfo.InvariantCulture;
+            string F(float value) => value.ToString("G6", invariant);
+            short S(int at) => BitConverter.ToInt16(data, p + at);
+
+            switch (type)
+            {
+                case RecordImu:
+                    // Quaternion I J K Real, linear accel m/s^2, gyro rad/s, accuracies, report ID
+                    return new object[] {
+                        F(S(0) / 16384f), F(S(2) / 16384f), F(S(4) / 16384f), F(S(6) / 16384f),
+                        F(S(8) / 100f), F(S(10) / 100f), F(S(12) / 100f),
+                        F(S(14) / 1000f), F(S(16) / 1000f), F(S(18) / 1000f),
+                        data[p + 20], data[p + 21], BitConverter.ToUInt16(data, p + 22) };
+                case RecordRadar:
+                    return new object[] {
+                        F(BitConverter.ToSingle(data, p)), data[p + 20],
+                        BitConverter.ToUInt32(data, p + 4), BitConverter.ToInt32(data, p + 12),
+                        BitConverter.ToUInt32(data, p + 8), BitConverter.ToInt32(data, p + 16) };
+                case RecordGnss:
+                    double lat = BitConverter.ToInt32(data, p) * 1e-7 + (sbyte)data[p + 20] * 1e-9;
+                    double lon = BitConverter.ToInt32(data, p + 4) * 1e-7 + (sbyte)data[p + 21] * 1e-9;
+                    return new object[] {
+                        lat.ToString("F9", invariant), lon.ToString("F9", invariant),
+                        (BitConverter.ToInt32(data, p + 8) / 1000.0).ToString("F3", invariant),
+                        (BitConverter.ToUInt32(data, p + 12) / 10000.0).ToString("F4", invariant),
+                        BitConverter.ToUInt32(data, p + 16), data[p + 22] & 0x01, (data[p + 22] >> 1) & 0x03 };
+                case RecordRam:
+                    // Position, target, PID output, feed-forward, raw ADC, PWM, flags
+                    return new object[] {
+                        F(BitConverter.ToSingle(data, p)), F(BitConverter.ToSingle(data, p + 4)),
+                        F(BitConverter.ToSingle(data, p + 8)), F(BitConverter.ToSingle(data, p + 12)),
+                        S(16), BitConverter.ToUInt16(data, p + 18), data[p + 20] };
+                case RecordCommand:
+                    return new object[] {
+                        BitConverter.ToUInt32(data, p), F(BitConverter.ToSingle(data, p + 4)),
+                        F(BitConverter.ToSingle(data, p + 8)), F(BitConverter.ToSingle(data, p + 12)),
+                        BitConverter.ToUInt32(data, p + 16), data[p + 20] };
+                case RecordTrigger:
+                    uint reason = BitConverter.ToUInt32(data, p);
+                    return new object[] {
+                        reason < TriggerNames.Length ? TriggerNames[reason] : reason.ToString(invariant),
+                        BitConverter.ToUInt32(data, p + 4) };
+                default:
+                    return new object[0];
+            }
+        }
+    }
+}
@@ -1,3 +1,4 @@
+using ABLS.Core.Diagnostics;
 using ABLS.Core.Models;
 using ABLS.Core.Networking;
 using System;
@@ -9,6 +10,43 @@ namespace ABLS.Core
     {
         static async Task Main(string[] args)
         {
+            // Offline tool: decode a module's binary event log to text
+            if (args.Length == 2 && args[0] == "decode-log")
+            {
+                var decoder = new BinaryLogDecoder();
+                decoder.Decode(args[1], Console.Out);
+                if (decoder.SkippedRecords > 0)
+                {
+                    Console.Error.WriteLine($"{decoder.SkippedRecords} damaged or undefined records skipped");
+                }
+                return;
+            }
+
+            if (args.Length == 2 && args[0] == "decode-blackbox")
+            {
+                var reader = new BlackBoxReader();
+                reader.Convert(args[1], Console.Out, Console.Error);
+                Console.Error.WriteLine($"{reader.Records} records, {reader.SequenceGaps} sequence gaps");
+                return;
+            }
+
+            // CI gate: non-zero exit if any benchmark case slowed past the threshold
+            if ((args.Length == 3 || args.Length == 4) && args[0] == "compare-benchmark")
+            {
+                var comparer = new BenchmarkComparer();
+                if (args.Length == 4)
+                {
+                    comparer.ThresholdPercent = double.Parse(args[3], System.Globalization.CultureInfo.InvariantCulture);
+                }
+                comparer.Compare(args[1], args[2], Console.Out);
+                if (comparer.Regressions > 0)
+                {
+                    Console.Error.WriteLine($"{comparer.Regressions} benchmark regressions");
+                    Environment.ExitCode = 1;
+                }
+                return;
+            }
+
             // --- Configuration ---
             int listenPort = 8888;
             string controlTeensyIp = "192.168.1.100"; // Example IP for the control Teensy
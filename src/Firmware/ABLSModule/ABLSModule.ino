@@ -14,6 +14,10 @@
  * - Pin 5 Reserved for Future Module
  * - Pin 6 Reserved for Future Module
  * 
+ * Startup is staged and never halts once the role is known: hydraulics go
+ * into a safe hold first, then sensors and network come up from loop() in
+ * the background while StartupSequencer reports each stage.
+ * 
  * Author: James Hassall @ RobotsGoFarming.com
  * Version: 1.0.0
  */
@@ -24,20 +28,25 @@
 #include "SensorManager.h"
 #include "NetworkManager.h"
 #include "HydraulicController.h"
+#include "TerrainPreview.h"
 #include "VersionManager.h"
 #include "OTAUpdateManager.h"
 #include "UpdateSafetyManager.h"
 #include "FlashBackupManager.h"
+#include "FirmwareHash.h"
+#include "LoopProfiler.h"
+#include "FlightRecorder.h"
+#include "StartupSequencer.h"
 
 // Global component instances
 SensorManager sensorManager;
 NetworkManager networkManager;
 HydraulicController hydraulicController;
+TerrainPreview terrainPreview;
 OTAUpdateManager otaUpdateManager;
 
 void setup() {
-    Serial.begin(115200);
-    while (!Serial && millis() < 3000); // Wait for serial or timeout
+    Serial.begin(115200); // No wait for a USB host - hydraulics must reach their safe hold first
     
     // Initialize built-in LED for error indication
     pinMode(LED_BUILTIN, OUTPUT);
@@ -48,6 +57,9 @@ void setup() {
     // Step 1: Initialize diagnostic system (OLED + SD logging)
     DiagnosticManager::initialize();
     
+    // Step 1b: Start the cycle-counter profiler before anything is timed
+    LoopProfiler::initialize();
+    
     // Step 2: Detect hardware role
     ModuleConfig::detectRole();
     
@@ -61,37 +73,39 @@ void setup() {
     
     Serial.print("Module Role: ");
     Serial.println(ModuleConfig::getRoleName());
+    Serial.print("Firmware Build: ");
+    Serial.println(ModuleConfig::getBuildName());
     
-    // Step 3: Initialize sensors (all modules)
-    Serial.println("Initializing sensors...");
-    if (!sensorManager.initialize()) {
-        DiagnosticManager::logError("Setup", "Sensor initialization failed");
-        DiagnosticManager::showErrorScreen("Sensor Init Failed");
-        while(1) { delay(1000); } // Halt on sensor failure
+    // Step 2b: Black-box recorder (needs the SD card and the role)
+    if (!FlightRecorder::initialize()) {
+        Serial.println("Flight recorder not available");
     }
     
-    // Step 4: Initialize network (all modules)
+    // Step 3: Hydraulic controller first (centre module only) - valves neutral
+    // at once, holding the rams where they are once feedback is available
+    Serial.println("Initializing hydraulic controller...");
+    hydraulicController.initialize();
+    
+    // Step 4: Start sensors (all modules) - any that fail retry from update()
+    Serial.println("Initializing sensors...");
+    sensorManager.initialize();
+    
+    // Step 5: Start network (all modules) - link, DHCP and sockets follow from update()
     Serial.println("Initializing network...");
-    if (!networkManager.initialize()) {
-        DiagnosticManager::logError("Setup", "Network initialization failed");
-        DiagnosticManager::showErrorScreen("Network Init Failed");
-        while(1) { delay(1000); } // Halt on network failure
-    }
+    networkManager.initialize();
     
-    // Step 5: Initialize hydraulic controller (centre module only)
-    Serial.println("Initializing hydraulic controller...");
-    if (!hydraulicController.initialize()) {
-        DiagnosticManager::logError("Setup", "Hydraulic controller initialization failed");
-        DiagnosticManager::showErrorScreen("Hydraulic Init Failed");
-        while(1) { delay(1000); } // Halt on hydraulic failure
+    // Step 5b: Initialize DEM terrain preview (centre module, optional)
+    Serial.println("Initializing terrain preview...");
+    if (!terrainPreview.initialize()) {
+        // A broken DEM only costs the feed-forward - levelling carries on without it
+        DiagnosticManager::logError("Setup", "Terrain preview initialization failed - DEM ignored");
     }
     
     // Step 6: Initialize Firmware Update system
     Serial.println("Initializing OTA update system...");
     if (!OTAUpdateManager::initialize()) {
-        DiagnosticManager::logError("Setup", "Firmware Updater initialization failed");
-        DiagnosticManager::showErrorScreen("Updater Init Failed");
-        while(1) { delay(1000); } // Halt on OTA failure
+        // Levelling does not depend on it - report and carry on without updates
+        DiagnosticManager::logError("Setup", "Firmware Updater initialization failed - OTA updates disabled");
     }
     
     // Step 6b: Initialize Update Safety Manager
@@ -104,20 +118,31 @@ void setup() {
     FlashBackupManager::init();
     DiagnosticManager::logMessage(LOG_INFO, "Setup", "Firmware backup system initialized");
     
+#ifdef FIRMWARE_HASH_RUN_BENCHMARK
+    // Bench test only - compares SHA256/CRC32 backends over the running image
+    FirmwareHash::runBenchmark();
+#endif
+    
     // Step 7: Connect components together
     networkManager.setSensorManager(&sensorManager);
     networkManager.setHydraulicController(&hydraulicController);
+    UpdateSafetyManager::setSensorManager(&sensorManager);
+    terrainPreview.setSensorManager(&sensorManager);
+    terrainPreview.setHydraulicController(&hydraulicController);
     
-    // Step 8: Final status update
-    DiagnosticManager::setSystemStatus("All systems initialized - Ready");
-    DiagnosticManager::logMessage(LOG_INFO, "Setup", "All systems initialized successfully");
+    // Step 8: Hand over to the staged bring-up - loop() runs from here on
+    StartupSequencer::begin(&sensorManager, &networkManager, &hydraulicController);
+    DiagnosticManager::setSystemStatus(StartupSequencer::getStatusString());
+    DiagnosticManager::logMessage(LOG_INFO, "Setup", "Setup complete - remaining stages starting in background");
     
-    Serial.println("=== Setup Complete - System Ready ===");
+    Serial.println("=== Setup Complete - Staged Startup Running ===");
     Serial.println("Module initialization complete");
     Serial.println("=====================================");
 }
 
 void loop() {
+    PROFILE_SCOPE(PROBE_LOOP);
+    
     // Update diagnostic display and logging
     DiagnosticManager::updateDisplay();
     
@@ -125,17 +150,17 @@ void loop() {
     sensorManager.update();
     networkManager.update();
     hydraulicController.update();
+    terrainPreview.update();
     UpdateSafetyManager::update();
     OTAUpdateManager::update();
+    StartupSequencer::update();
     
-    // Send sensor data to Toughbook at 50Hz (every 20ms)
-    static uint32_t lastSensorDataSent = 0;
-    if (millis() - lastSensorDataSent >= 20) {
+    // Send sensor data to Toughbook at 50Hz - drift-free 20ms schedule
+    if (networkManager.isSensorSendDue()) {
         SensorDataPacket sensorPacket;
         sensorManager.populatePacket(&sensorPacket);
         hydraulicController.populateRamPositions(&sensorPacket);
         networkManager.sendSensorData(sensorPacket);
-        lastSensorDataSent = millis();
     }
     
     // Update diagnostic information every 2 seconds
@@ -149,7 +174,7 @@ void loop() {
         );
         
         // Update system status
-        String systemStatus = "Running - ";
+        String systemStatus = StartupSequencer::isOperational() ? "Running - " : StartupSequencer::getStatusString() + " - ";
         systemStatus += ModuleConfig::getRoleName();
         if (ModuleConfig::getRole() == MODULE_CENTRE) {
             systemStatus += " - " + hydraulicController.getStatusString();
@@ -181,14 +206,21 @@ void loop() {
         
         Serial.println();
         
-        DiagnosticManager::logMessage(LOG_DEBUG, "System", 
+        DIAG_LOG(LOG_DEBUG, "System", 
             "Heartbeat - Uptime: " + String(uptime) + "s, " +
             "TX: " + String(networkManager.getPacketsSent()) + ", " +
-            "RX: " + String(networkManager.getPacketsReceived()));
+            "RX: " + String(networkManager.getPacketsReceived()) + ", " +
+            LoopProfiler::getStatusString());
         
         lastHeartbeat = millis();
     }
     
+    // Write buffered log lines to SD in whole blocks
+    DiagnosticManager::serviceLog();
+    
+    // Black-box buffers go to SD as whole halves
+    FlightRecorder::service();
+    
     // Small delay to prevent overwhelming the system
     delay(5);
 }
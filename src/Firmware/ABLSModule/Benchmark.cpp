@@ -0,0 +1,412 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Firmware Benchmark Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "Benchmark.h"
+#include "HydraulicController.h"
+#include "SensorManager.h"
+#include "SensorPacketCodec.h"
+#include "TelemetryBatcher.h"
+#include "RtcmFramer.h"
+#include "FirmwareHash.h"
+#include "DiagnosticManager.h"
+#include "LoopProfiler.h"
+#include "ModuleConfig.h"
+#include "VersionManager.h"
+
+#if defined(__IMXRT1062__)
+#define BENCHMARK_TARGET    "teensy41"
+#else
+#define BENCHMARK_TARGET    "host"
+#endif
+
+#define BENCHMARK_RTCM_PAYLOAD  300     // Typical MSM7 observation message
+#define BENCHMARK_PID_DT        0.005   // Default 200Hz control tick
+
+// Static member initialization - hashed data lives in OCRAM, where the DCP can reach it
+DMAMEM uint8_t Benchmark::_buffer[BENCHMARK_BUFFER_SIZE];
+
+// Results land here so the compiler cannot drop the work being timed
+static volatile uint32_t benchmarkSink = 0;
+
+// Times BENCHMARK_BATCHES batches of `iterations` calls to operation(i).
+// One untimed call first warms the caches and branch predictor.
+template <typename Operation>
+static void measure(BenchmarkResult* result, uint32_t iterations, Operation operation) {
+    uint32_t minCycles = UINT32_MAX;
+    uint32_t maxCycles = 0;
+    uint64_t totalCycles = 0;
+
+    operation(0);
+    for (int batch = 0; batch < BENCHMARK_BATCHES; batch++) {
+        uint32_t start = LoopProfiler::cycles();
+        for (uint32_t i = 0; i < iterations; i++) {
+            operation(i);
+        }
+        uint32_t perOperation = (LoopProfiler::cycles() - start) / iterations;
+
+        if (perOperation < minCycles) minCycles = perOperation;
+        if (perOperation > maxCycles) maxCycles = perOperation;
+        totalCycles += perOperation;
+    }
+
+    result->iterations = iterations;
+    result->minCycles = minCycles;
+    result->meanCycles = (uint32_t)(totalCycles / BENCHMARK_BATCHES);
+    result->maxCycles = maxCycles;
+}
+
+// A representative packet - encode cost does not depend on the values
+static void fillSamplePacket(SensorDataPacket* packet) {
+    packet->SenderId = SENDER_CENTRE;
+    packet->Timestamp = millis();
+    packet->SampleTimeMicros = micros();
+    packet->Latitude = 52.2053370;
+    packet->Longitude = 0.1218170;
+    packet->Altitude = 16.25f;
+    packet->GPSFixQuality = 1;
+    packet->RTKStatus = 2;
+    packet->HorizontalAccuracy = 0.014f;
+    packet->QuaternionW = 0.9998f;
+    packet->QuaternionX = 0.0123f;
+    packet->QuaternionY = -0.0087f;
+    packet->QuaternionZ = 0.0101f;
+    packet->AccelZ = 9.81f;
+    packet->GyroX = 0.012f;
+    packet->RadarDistance = 0.842f;
+    packet->RadarValid = 1;
+    packet->RamPosCenterPercent = 50.0f;
+    packet->RamPosLeftPercent = 48.5f;
+    packet->RamPosRightPercent = 51.2f;
+}
+
+int Benchmark::run(SensorManager* sensorManager, HydraulicController* hydraulicController,
+                   BenchmarkLineHandler_t handler, void* context) {
+    if (!handler) return -1;
+
+    // Blocking loop() under live control would delay command processing
+    if (hydraulicController && hydraulicController->_isActiveModule && hydraulicController->_haveCommand &&
+        millis() - hydraulicController->_lastCommandMillis < BENCHMARK_COMMAND_QUIET_MS) {
+        emitError("control commands active", handler, context);
+        return -1;
+    }
+
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+    FirmwareHash::initialize();
+
+    for (uint32_t i = 0; i < BENCHMARK_BUFFER_SIZE; i++) {
+        _buffer[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    emitHeader(handler, context);
+
+    int reported = 0;
+    BenchmarkResult result;
+
+    #define BENCHMARK_CASE(caseName, call) \
+        memset(&result, 0, sizeof(result)); \
+        result.name = caseName; \
+        if (call) { emitResult(result, handler, context); reported++; }
+
+    BENCHMARK_CASE("pid.legacy", benchLegacyPID(hydraulicController, &result));
+    BENCHMARK_CASE("pid.profiled", benchProfiledPID(hydraulicController, &result));
+    BENCHMARK_CASE("ram.position", benchRamPosition(hydraulicController, &result));
+    BENCHMARK_CASE("sensor.populate", benchPopulatePacket(sensorManager, &result));
+    BENCHMARK_CASE("packet.encode_v1", benchEncodeV1(&result));
+    BENCHMARK_CASE("packet.encode_v2", benchEncodeV2(&result));
+    BENCHMARK_CASE("packet.build_batch", benchBuildBatch(&result));
+    BENCHMARK_CASE("rtcm.frame", benchRtcmFrame(&result));
+    BENCHMARK_CASE("crc32", benchCrc32(&result));
+    BENCHMARK_CASE("sha256.software", benchSha256Software(&result));
+    BENCHMARK_CASE("sha256.dcp", benchSha256Dcp(&result));
+    BENCHMARK_CASE("log.message", benchLogMessage(&result));
+    BENCHMARK_CASE("oled.render", benchDisplayRender(&result));
+    BENCHMARK_CASE("oled.flush", benchDisplayFlush(&result));
+    BENCHMARK_CASE("oled.chunk", benchDisplayChunk(&result));
+
+    #undef BENCHMARK_CASE
+
+    char line[BENCHMARK_LINE_MAX];
+    int len = snprintf(line, sizeof(line), "{\"type\":\"end\",\"cases\":%d}", reported);
+    handler(line, (size_t)len, context);
+
+    DiagnosticManager::logMessage(LOG_INFO, "Benchmark", String(reported) + " cases reported");
+    return reported;
+}
+
+void Benchmark::emitHeader(BenchmarkLineHandler_t handler, void* context) {
+    char line[BENCHMARK_LINE_MAX];
+    int len = snprintf(line, sizeof(line),
+        "{\"type\":\"abls-benchmark\",\"format\":%d,\"firmware\":\"%d.%d.%d\",\"build\":%lu,\"git\":\"%s\","
+        "\"role\":\"%s\",\"target\":\"%s\",\"cpu_hz\":%lu,\"batches\":%d}",
+        BENCHMARK_FORMAT_VERSION, FIRMWARE_VERSION_MAJOR, FIRMWARE_VERSION_MINOR, FIRMWARE_VERSION_PATCH,
+        (unsigned long)FIRMWARE_BUILD_NUMBER, FIRMWARE_GIT_HASH, ModuleConfig::getRoleName().c_str(),
+        BENCHMARK_TARGET, (unsigned long)F_CPU_ACTUAL, BENCHMARK_BATCHES);
+    if (len > 0 && (size_t)len < sizeof(line)) handler(line, (size_t)len, context);
+}
+
+void Benchmark::emitResult(const BenchmarkResult& result, BenchmarkLineHandler_t handler, void* context) {
+    char line[BENCHMARK_LINE_MAX];
+    int len = snprintf(line, sizeof(line),
+        "{\"type\":\"result\",\"name\":\"%s\",\"iterations\":%lu,\"bytes\":%lu,"
+        "\"min_cycles\":%lu,\"mean_cycles\":%lu,\"max_cycles\":%lu}",
+        result.name, (unsigned long)result.iterations, (unsigned long)result.bytes,
+        (unsigned long)result.minCycles, (unsigned long)result.meanCycles, (unsigned long)result.maxCycles);
+    if (len > 0 && (size_t)len < sizeof(line)) handler(line, (size_t)len, context);
+}
+
+void Benchmark::emitError(const char* reason, BenchmarkLineHandler_t handler, void* context) {
+    char line[BENCHMARK_LINE_MAX];
+    int len = snprintf(line, sizeof(line), "{\"type\":\"error\",\"reason\":\"%s\"}", reason);
+    if (len > 0 && (size_t)len < sizeof(line)) handler(line, (size_t)len, context);
+    DiagnosticManager::logMessage(LOG_WARNING, "Benchmark", String("Not run - ") + reason);
+}
+
+//******************************************************************************
+// Hydraulic control - scratch channels, the live rams are never touched
+//******************************************************************************
+
+bool Benchmark::benchLegacyPID(HydraulicController* controller, BenchmarkResult* result) {
+    if (!controller) return false;
+
+    RamChannel channel(RAM_CENTER_ADC_CHANNEL, RAM_CENTER_VALVE_PIN, "Benchmark");
+    channel.setpointPositionPercent = 60.0;
+    measure(result, 256, [&](uint32_t i) {
+        channel.currentPositionPercent = 50.0 + (i & 15) * 0.1;
+        benchmarkSink += (uint32_t)controller->runPID(channel, BENCHMARK_PID_DT);
+    });
+    return true;
+}
+
+bool Benchmark::benchProfiledPID(HydraulicController* controller, BenchmarkResult* result) {
+    if (!controller) return false;
+
+    // Setpoint jumps every 64 ticks so the profile is always in motion
+    RamChannel channel(RAM_CENTER_ADC_CHANNEL, RAM_CENTER_VALVE_PIN, "Benchmark");
+    measure(result, 256, [&](uint32_t i) {
+        if ((i & 63) == 0) {
+            channel.setpointPositionPercent = (channel.setpointPositionPercent > 50.0) ? 30.0 : 70.0;
+        }
+        channel.currentPositionPercent = channel.profilePosition;
+        benchmarkSink += (uint32_t)controller->runProfiledPID(channel, (float)BENCHMARK_PID_DT);
+    });
+    return true;
+}
+
+bool Benchmark::benchRamPosition(HydraulicController* controller, BenchmarkResult* result) {
+    // Single-shot mode reads the live ADS1115 here - not a conversion benchmark
+    if (!controller || controller->_adcAcquisitionMode != ADC_ACQ_CONTINUOUS) return false;
+
+    RamChannel channel(RAM_CENTER_ADC_CHANNEL, RAM_CENTER_VALVE_PIN, "Benchmark");
+    channel.adcSampleTime = millis();
+    uint32_t staleBefore = controller->_adcStaleSamples;
+    measure(result, 256, [&](uint32_t i) {
+        channel.rawAdcValue = (int16_t)((i * 977) & 0x7FFF);
+        benchmarkSink += (uint32_t)controller->readChannelPosition(channel);
+    });
+    controller->_adcStaleSamples = staleBefore;
+    return true;
+}
+
+//******************************************************************************
+// Sensor data path
+//******************************************************************************
+
+bool Benchmark::benchPopulatePacket(SensorManager* sensorManager, BenchmarkResult* result) {
+    if (!sensorManager) return false;
+
+    SensorDataPacket packet;
+    measure(result, 64, [&](uint32_t) {
+        sensorManager->populatePacket(&packet);
+        benchmarkSink += packet.Timestamp;
+    });
+    return true;
+}
+
+bool Benchmark::benchEncodeV1(BenchmarkResult* result) {
+    SensorDataPacket packet;
+    fillSamplePacket(&packet);
+    SensorDataPacketV1 wire;
+    measure(result, 256, [&](uint32_t) {
+        SensorPacketCodec::encodeV1(packet, &wire);
+        benchmarkSink += wire.SenderId;
+    });
+    result->bytes = sizeof(wire);
+    return true;
+}
+
+bool Benchmark::benchEncodeV2(BenchmarkResult* result) {
+    SensorDataPacket packet;
+    fillSamplePacket(&packet);
+    SensorDataPacketV2 wire;
+    measure(result, 256, [&](uint32_t i) {
+        SensorPacketCodec::encodeV2(packet, i, &wire);
+        benchmarkSink += wire.Flags;
+    });
+    result->bytes = sizeof(wire);
+    return true;
+}
+
+bool Benchmark::benchBuildBatch(BenchmarkResult* result) {
+    // One 20ms send tick: eight 400Hz IMU samples and a radar measurement
+    // recorded, then packed. Skipped while live telemetry owns the queues.
+    if (TelemetryBatcher::isEnabled()) return false;
+
+    static uint8_t batch[TELEMETRY_MAX_DATAGRAM];
+    ImuSnapshot imu;
+    RadarSnapshot radar;
+    radar.distance = 1.0f;
+    radar.valid = true;
+    size_t length = 0;
+
+    TelemetryBatcher::setEnabled(true);
+    measure(result, 64, [&](uint32_t i) {
+        for (uint32_t sample = 0; sample < 8; sample++) {
+            imu.sampleMicros = i * 20000 + sample * 2500;
+            imu.gyroZ = sample * 0.01f;
+            TelemetryBatcher::recordImu(imu);
+        }
+        radar.sampleMicros = i * 20000;
+        TelemetryBatcher::recordRadar(radar);
+        length = TelemetryBatcher::build(SENDER_CENTRE, i, i * 20000 + 20000, batch, sizeof(batch));
+        benchmarkSink += length;
+    });
+    TelemetryBatcher::setEnabled(false);
+
+    result->bytes = (uint32_t)length;
+    return true;
+}
+
+bool Benchmark::benchRtcmFrame(BenchmarkResult* result) {
+    // One complete MSM7-sized frame per operation, CRC checked by the framer
+    static uint8_t frame[RTCM_HEADER_SIZE + BENCHMARK_RTCM_PAYLOAD + RTCM_CRC_SIZE];
+    static RtcmFramer framer;
+    const size_t payloadEnd = RTCM_HEADER_SIZE + BENCHMARK_RTCM_PAYLOAD;
+
+    frame[0] = RTCM_PREAMBLE;
+    frame[1] = (uint8_t)((BENCHMARK_RTCM_PAYLOAD >> 8) & 0x03);
+    frame[2] = (uint8_t)(BENCHMARK_RTCM_PAYLOAD & 0xFF);
+    frame[3] = (uint8_t)(1077 >> 4);
+    frame[4] = (uint8_t)((1077 & 0x0F) << 4);
+    for (size_t i = 5; i < payloadEnd; i++) {
+        frame[i] = _buffer[i];
+    }
+    uint32_t crc = RtcmFramer::crc24q(frame, payloadEnd);
+    frame[payloadEnd] = (uint8_t)(crc >> 16);
+    frame[payloadEnd + 1] = (uint8_t)(crc >> 8);
+    frame[payloadEnd + 2] = (uint8_t)crc;
+
+    framer.reset();
+    measure(result, 32, [&](uint32_t) {
+        framer.push(frame, sizeof(frame));
+    });
+    benchmarkSink += framer.getFrameCount();
+    result->bytes = sizeof(frame);
+    return framer.getCrcErrors() == 0;
+}
+
+//******************************************************************************
+// Firmware integrity
+//******************************************************************************
+
+bool Benchmark::benchCrc32(BenchmarkResult* result) {
+    measure(result, 16, [&](uint32_t) {
+        benchmarkSink += FirmwareHash::crc32(_buffer, BENCHMARK_BUFFER_SIZE);
+    });
+    result->bytes = BENCHMARK_BUFFER_SIZE;
+    return true;
+}
+
+bool Benchmark::benchSha256Software(BenchmarkResult* result) {
+    HashBackend_t preferred = FirmwareHash::getPreferredBackend();
+    FirmwareHash::setPreferredBackend(HASH_BACKEND_SOFTWARE);
+
+    uint8_t hash[32];
+    measure(result, 4, [&](uint32_t) {
+        FirmwareHash::sha256(_buffer, BENCHMARK_BUFFER_SIZE, hash);
+        benchmarkSink += hash[0];
+    });
+
+    FirmwareHash::setPreferredBackend(preferred);
+    result->bytes = BENCHMARK_BUFFER_SIZE;
+    return true;
+}
+
+bool Benchmark::benchSha256Dcp(BenchmarkResult* result) {
+    if (!FirmwareHash::isDcpAvailable()) return false;
+
+    HashBackend_t preferred = FirmwareHash::getPreferredBackend();
+    FirmwareHash::setPreferredBackend(HASH_BACKEND_DCP);
+
+    uint8_t hash[32];
+    measure(result, 4, [&](uint32_t) {
+        FirmwareHash::sha256(_buffer, BENCHMARK_BUFFER_SIZE, hash);
+        benchmarkSink += hash[0];
+    });
+
+    FirmwareHash::setPreferredBackend(preferred);
+    result->bytes = BENCHMARK_BUFFER_SIZE;
+    return true;
+}
+
+//******************************************************************************
+// Diagnostics
+//******************************************************************************
+
+bool Benchmark::benchLogMessage(BenchmarkResult* result) {
+    // Real lines into the live ring - kept few so the log is not flooded
+    if (!DiagnosticManager::isSDCardAvailable() || !DiagnosticManager::isLogEnabled(LOG_INFO)) return false;
+
+    measure(result, 4, [&](uint32_t i) {
+        DiagnosticManager::logMessage(LOG_INFO, "Benchmark", "Log formatting case " + String(i));
+    });
+    return true;
+}
+
+bool Benchmark::benchDisplayRender(BenchmarkResult* result) {
+    if (!DiagnosticManager::_displayAvailable) return false;
+
+    // Every page in turn, into the frame buffer only
+    measure(result, 8, [&](uint32_t i) {
+        DiagnosticManager::_display.clearDisplay();
+        switch (i % DISPLAY_MAX) {
+            case DISPLAY_STATUS: DiagnosticManager::drawStatusPage(); break;
+            case DISPLAY_NETWORK: DiagnosticManager::drawNetworkPage(); break;
+            case DISPLAY_SENSORS: DiagnosticManager::drawSensorsPage(); break;
+            default: DiagnosticManager::drawSystemPage(); break;
+        }
+    });
+    return true;
+}
+
+bool Benchmark::benchDisplayFlush(BenchmarkResult* result) {
+    if (!DiagnosticManager::_displayAvailable) return false;
+
+    // The chunked I2C frame push, bus lock and yields included as in updateDisplay()
+    measure(result, 1, [&](uint32_t) {
+        DiagnosticManager::pushDisplayFrame();
+    });
+    result->bytes = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+    return true;
+}
+
+bool Benchmark::benchDisplayChunk(BenchmarkResult* result) {
+    if (!DiagnosticManager::_displayAvailable) return false;
+
+    // One updateDisplay() step after a typical small change - a status
+    // field ticking over - diff scan and write included
+    measure(result, 8, [&](uint32_t i) {
+        DiagnosticManager::_display.fillRect((int16_t)(i * 6), 56, 6, 8, SSD1306_INVERSE);
+        DiagnosticManager::_displayDirty = true;
+        DiagnosticManager::_pushPage = 0;
+        DiagnosticManager::_pushColumn = 0;
+        DiagnosticManager::pushDisplayChunk();
+    });
+    result->bytes = 6;  // The inverted cell's columns, one page
+    return true;
+}
@@ -0,0 +1,79 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Firmware Benchmark
+ *
+ * Microbenchmarks of the firmware hot paths on the DWT cycle counter:
+ * - PID (legacy and profiled), ram position conversion, sensor packet
+ *   populate, encode and batch build, RTCM framing, CRC32, SHA-256, log formatting
+ *   and OLED frame rendering
+ * - Each case runs BENCHMARK_BATCHES batches; min/mean/max cycles per
+ *   operation are taken over the batches - min is the figure to trend
+ * - Results are JSON lines (one header line, one line per case) for
+ *   comparing firmware versions (compare-benchmark in ABLS.Core)
+ * - On the module it runs on a RUN_BENCHMARK update command; HostSim
+ *   builds the same cases natively as abls-bench
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+
+class SensorManager;
+class HydraulicController;
+
+#define BENCHMARK_FORMAT_VERSION    1
+#define BENCHMARK_BATCHES           8
+#define BENCHMARK_BUFFER_SIZE       4096    // Bytes hashed per CRC32/SHA-256 operation
+#define BENCHMARK_LINE_MAX          256
+#define BENCHMARK_COMMAND_QUIET_MS  2000    // Centre refuses to run within this of a command
+
+// Receives each JSON line (no newline); runs in the caller's context
+typedef void (*BenchmarkLineHandler_t)(const char* line, size_t len, void* context);
+
+struct BenchmarkResult {
+    const char* name;
+    uint32_t iterations;        // Operations per batch
+    uint32_t bytes;             // Bytes per operation (0 = not a throughput case)
+    uint32_t minCycles;         // Per operation
+    uint32_t meanCycles;
+    uint32_t maxCycles;
+};
+
+class Benchmark {
+public:
+    // Runs every case the available subsystems allow, blocking for roughly
+    // a second (the control tick keeps running). Either pointer may be null.
+    // Returns the number of cases reported, or -1 if refused.
+    static int run(SensorManager* sensorManager, HydraulicController* hydraulicController,
+                   BenchmarkLineHandler_t handler, void* context);
+
+private:
+    static uint8_t _buffer[BENCHMARK_BUFFER_SIZE];
+
+    static void emitHeader(BenchmarkLineHandler_t handler, void* context);
+    static void emitResult(const BenchmarkResult& result, BenchmarkLineHandler_t handler, void* context);
+    static void emitError(const char* reason, BenchmarkLineHandler_t handler, void* context);
+
+    // Cases - each fills one result, false if it cannot run here
+    static bool benchLegacyPID(HydraulicController* controller, BenchmarkResult* result);
+    static bool benchProfiledPID(HydraulicController* controller, BenchmarkResult* result);
+    static bool benchRamPosition(HydraulicController* controller, BenchmarkResult* result);
+    static bool benchPopulatePacket(SensorManager* sensorManager, BenchmarkResult* result);
+    static bool benchEncodeV1(BenchmarkResult* result);
+    static bool benchEncodeV2(BenchmarkResult* result);
+    static bool benchBuildBatch(BenchmarkResult* result);
+    static bool benchRtcmFrame(BenchmarkResult* result);
+    static bool benchCrc32(BenchmarkResult* result);
+    static bool benchSha256Software(BenchmarkResult* result);
+    static bool benchSha256Dcp(BenchmarkResult* result);
+    static bool benchLogMessage(BenchmarkResult* result);
+    static bool benchDisplayRender(BenchmarkResult* result);
+    static bool benchDisplayFlush(BenchmarkResult* result);
+    static bool benchDisplayChunk(BenchmarkResult* result);
+};
+
+#endif // BENCHMARK_H
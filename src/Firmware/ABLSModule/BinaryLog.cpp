@@ -0,0 +1,278 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Binary Log Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "BinaryLog.h"
+#include "ModuleConfig.h"
+
+// Static member initialization
+char BinaryLog::_buffer[BLOG_BUFFER_SIZE];
+volatile uint32_t BinaryLog::_head = 0;
+uint32_t BinaryLog::_tail = 0;
+volatile uint32_t BinaryLog::_events = 0;
+volatile uint32_t BinaryLog::_dropped = 0;
+uint32_t BinaryLog::_droppedReported = 0;
+volatile uint16_t BinaryLog::_generation = 1;
+bool BinaryLog::_active = false;
+bool BinaryLog::_fileOpen = false;
+bool BinaryLog::_dirty = false;
+FsFile BinaryLog::_file;
+char BinaryLog::_fileName[32] = "";
+uint32_t BinaryLog::_lastFlush = 0;
+uint32_t BinaryLog::_lastSync = 0;
+
+void BinaryLog::initialize() {
+    _active = DiagnosticManager::isSDCardAvailable();
+    _lastFlush = millis();
+    _lastSync = millis();
+
+    if (_active) {
+        DiagnosticManager::logMessage(LOG_INFO, "BinaryLog",
+            String(BLOG_BUFFER_SIZE / 1024) + "KB event ring, level >= " + String((int)BLOG_MIN_LEVEL) + " compiled in");
+    }
+}
+
+size_t BinaryLog::put(uint8_t* record, size_t len, uint8_t tag, const void* value, size_t size) {
+    // Arguments that do not fit are dropped; the decoder prints them as missing
+    if (len + 1 + size > BLOG_MAX_RECORD) return len;
+    record[len] = tag;
+    memcpy(&record[len + 1], value, size);
+    return len + 1 + size;
+}
+
+size_t BinaryLog::encodeArg(uint8_t* record, size_t len, const char* value) {
+    if (!value) value = "(null)";
+    size_t size = strnlen(value, BLOG_MAX_STRING);
+    if (len + 2 + size > BLOG_MAX_RECORD) return len;
+    record[len] = BLOG_ARG_STRING;
+    record[len + 1] = (uint8_t)size;
+    memcpy(&record[len + 2], value, size);
+    return len + 2 + size;
+}
+
+void BinaryLog::commit(BinaryLogSite* site, uint8_t* record, size_t len) {
+    BinaryLogRecordHeader header;
+    header.Sync = BLOG_RECORD_SYNC;
+    header.Type = BLOG_RECORD_EVENT;
+    header.Length = (uint16_t)len;
+    header.TimestampMillis = millis();
+    memcpy(record, &header, sizeof(header));
+
+    uint32_t siteId = (uint32_t)(uintptr_t)site;
+    memcpy(&record[sizeof(header)], &siteId, sizeof(siteId));
+
+    // Definition and event go in together so a reader never sees one without the other
+    noInterrupts();
+    bool stored = true;
+    if (site->generation != _generation) {
+        stored = appendDefinition(site, header.TimestampMillis) > 0;
+        if (stored) site->generation = _generation;
+    }
+    stored = stored && append(record, len);
+    if (stored) {
+        _events++;
+    } else {
+        _dropped++;
+    }
+    interrupts();
+}
+
+bool BinaryLog::append(const uint8_t* data, size_t len) {
+    // All-or-nothing so the file never holds half a record
+    uint32_t head = _head;
+    if (BLOG_BUFFER_SIZE - (head - _tail) < len) return false;
+
+    for (size_t i = 0; i < len; i++) {
+        _buffer[(head + i) & (BLOG_BUFFER_SIZE - 1)] = data[i];
+    }
+    _head = head + len;
+    return true;
+}
+
+size_t BinaryLog::appendDefinition(const BinaryLogSite* site, uint32_t now) {
+    uint8_t record[sizeof(BinaryLogRecordHeader) + 4 + 2 + BLOG_MAX_TEXT + 2];
+    size_t len = sizeof(BinaryLogRecordHeader);
+
+    uint32_t siteId = (uint32_t)(uintptr_t)site;
+    memcpy(&record[len], &siteId, sizeof(siteId));
+    len += sizeof(siteId);
+    record[len++] = (uint8_t)site->level;
+    record[len++] = 0; // Reserved
+
+    // Component and format, each NUL terminated, format truncated if needed
+    size_t componentLen = strnlen(site->component, BLOG_MAX_TEXT / 4);
+    memcpy(&record[len], site->component, componentLen);
+    len += componentLen;
+    record[len++] = '\0';
+
+    size_t formatLen = strnlen(site->format, BLOG_MAX_TEXT - componentLen);
+    memcpy(&record[len], site->format, formatLen);
+    len += formatLen;
+    record[len++] = '\0';
+
+    BinaryLogRecordHeader header;
+    header.Sync = BLOG_RECORD_SYNC;
+    header.Type = BLOG_RECORD_DEFINE;
+    header.Length = (uint16_t)len;
+    header.TimestampMillis = now;
+    memcpy(record, &header, sizeof(header));
+
+    return append(record, len) ? len : 0;
+}
+
+void BinaryLog::createFileName(char* buffer, size_t bufferSize, uint32_t now) {
+    // Daily file alongside the text log
+    uint32_t days = now / (24UL * 60UL * 60UL * 1000UL);
+    snprintf(buffer, bufferSize, "/logs/abls_%03lu.blg", (unsigned long)days);
+}
+
+bool BinaryLog::openFile() {
+    char fileName[32];
+    createFileName(fileName, sizeof(fileName), millis());
+
+    if (_fileOpen && strcmp(fileName, _fileName) == 0) return true;
+
+    if (_fileOpen) {
+        _file.close();
+        _fileOpen = false;
+    }
+
+    if (!_file.open(&SD.sdfs, fileName, O_WRONLY | O_CREAT | O_APPEND)) return false;
+
+    if (_file.fileSize() == 0) {
+        _file.preAllocate(BLOG_PREALLOCATE_BYTES);
+    }
+
+    // Every file (new or appended) starts a section with its own header
+    BinaryLogFileHeader header;
+    memcpy(header.Magic, BLOG_FILE_MAGIC, sizeof(header.Magic));
+    header.Version = BLOG_FILE_VERSION;
+    header.ModuleRole = (uint8_t)ModuleConfig::getRole();
+    header.Reserved = 0;
+    header.StartMillis = millis();
+    _file.write((const uint8_t*)&header, sizeof(header));
+
+    strncpy(_fileName, fileName, sizeof(_fileName) - 1);
+    _fileName[sizeof(_fileName) - 1] = '\0';
+    _fileOpen = true;
+    _dirty = true;
+    return true;
+}
+
+size_t BinaryLog::writeBytes(uint32_t limit, uint32_t maxBytes, bool alignToBlock) {
+    uint32_t pending = limit - _tail;
+    if (pending == 0) return 0;
+
+    uint32_t toWrite = min(pending, maxBytes);
+    if (alignToBlock) {
+        uint32_t position = (uint32_t)_file.curPosition();
+        uint32_t firstBlock = LOG_BLOCK_SIZE - (position % LOG_BLOCK_SIZE);
+        if (toWrite < firstBlock) return 0;
+        toWrite = firstBlock + ((toWrite - firstBlock) / LOG_BLOCK_SIZE) * LOG_BLOCK_SIZE;
+    }
+
+    uint32_t written = 0;
+    while (written < toWrite) {
+        uint32_t offset = (_tail + written) & (BLOG_BUFFER_SIZE - 1);
+        uint32_t run = min(toWrite - written, (uint32_t)(BLOG_BUFFER_SIZE - offset));
+        size_t result = _file.write((const uint8_t*)&_buffer[offset], run);
+        written += result;
+        if (result != run) break;
+    }
+
+    // Space is only released to writers after the bytes are on the card
+    noInterrupts();
+    _tail += written;
+    interrupts();
+    _dirty = _dirty || (written > 0);
+    return written;
+}
+
+void BinaryLog::service() {
+    if (!_active) return;
+
+    uint32_t now = millis();
+
+    // Report drops as soon as there is room again
+    uint32_t dropped = _dropped;
+    if (dropped != _droppedReported) {
+        uint8_t record[sizeof(BinaryLogRecordHeader) + 4];
+        BinaryLogRecordHeader header;
+        header.Sync = BLOG_RECORD_SYNC;
+        header.Type = BLOG_RECORD_DROPPED;
+        header.Length = sizeof(record);
+        header.TimestampMillis = now;
+        memcpy(record, &header, sizeof(header));
+        uint32_t count = dropped - _droppedReported;
+        memcpy(&record[sizeof(header)], &count, sizeof(count));
+
+        noInterrupts();
+        bool stored = append(record, sizeof(record));
+        interrupts();
+        if (stored) _droppedReported = dropped;
+    }
+
+    // New day: finish the old file, then start a new generation so every
+    // site defines itself again in the new file
+    char fileName[32];
+    createFileName(fileName, sizeof(fileName), now);
+    if (_fileOpen && strcmp(fileName, _fileName) != 0) {
+        noInterrupts();
+        uint32_t boundary = _head;
+        _generation++;
+        interrupts();
+        while (_tail != boundary) {
+            if (writeBytes(boundary, BLOG_BUFFER_SIZE, false) == 0) break;
+        }
+        _file.close();
+        _fileOpen = false;
+        _dirty = false;
+    }
+
+    uint32_t head = _head;
+    if (head == _tail) {
+        if (_dirty && now - _lastSync >= LOG_SYNC_INTERVAL_MS) {
+            _file.sync();
+            _dirty = false;
+            _lastSync = now;
+        }
+        return;
+    }
+
+    if (!openFile()) return;
+
+    // Whole blocks whenever there are any; partial data only once it is stale
+    if (writeBytes(head, LOG_MAX_WRITE_BYTES, true) > 0) {
+        _lastFlush = now;
+    } else if (now - _lastFlush >= LOG_FLUSH_INTERVAL_MS) {
+        writeBytes(head, LOG_MAX_WRITE_BYTES, false);
+        _lastFlush = now;
+    }
+
+    if (_dirty && now - _lastSync >= LOG_SYNC_INTERVAL_MS) {
+        _file.sync();
+        _dirty = false;
+        _lastSync = now;
+    }
+}
+
+void BinaryLog::flush() {
+    if (!_active) return;
+
+    if (_head != _tail && openFile()) {
+        while (_tail != _head) {
+            if (writeBytes(_head, BLOG_BUFFER_SIZE, false) == 0) break;
+        }
+    }
+
+    if (_fileOpen) {
+        _file.sync();
+        _dirty = false;
+        _lastSync = millis();
+    }
+    _lastFlush = millis();
+}
@@ -0,0 +1,171 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Binary Log - Deferred-Format Event Logging
+ *
+ * printf-style logging for control and sensor paths without String:
+ * - BLOG() records a call-site ID plus the raw arguments, no formatting
+ * - Each call site's component and format string are written to the file
+ *   once per log file, so the log decodes without the firmware image
+ * - Sites below BLOG_MIN_LEVEL compile away entirely
+ * - Nothing is recorded (or evaluated) without an SD card
+ * - Safe from the control tick ISR; no heap, no SD access on the hot path
+ * - Decoded to text on the host: ABLS.Core decode-log <file.blg>
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <type_traits>
+#include "DiagnosticManager.h"
+
+// Ring and record limits
+#define BLOG_BUFFER_SIZE        8192    // RAM ring for encoded records (power of two)
+#define BLOG_MAX_RECORD         96      // Longest single event record
+#define BLOG_MAX_STRING         31      // Longest string argument (truncated beyond)
+#define BLOG_MAX_TEXT           160     // Longest component + format in a definition
+#define BLOG_PREALLOCATE_BYTES  (4UL * 1024UL * 1024UL)
+
+// Sites below this level are removed at compile time
+#ifndef BLOG_MIN_LEVEL
+#define BLOG_MIN_LEVEL          LOG_DEBUG
+#endif
+
+// File format (little-endian)
+#define BLOG_FILE_MAGIC         "ABLSBLOG"
+#define BLOG_FILE_VERSION       1
+#define BLOG_RECORD_SYNC        0xA5
+
+typedef enum {
+    BLOG_RECORD_DEFINE = 1,     // Call site: level, component, format
+    BLOG_RECORD_EVENT = 2,      // Call site ID + tagged arguments
+    BLOG_RECORD_DROPPED = 3     // Events lost because the ring was full
+} BinaryLogRecord_t;
+
+// Argument type tags in an event record
+#define BLOG_ARG_INT32          'i'
+#define BLOG_ARG_UINT32         'u'
+#define BLOG_ARG_INT64          'q'
+#define BLOG_ARG_UINT64         'Q'
+#define BLOG_ARG_FLOAT          'f'
+#define BLOG_ARG_DOUBLE         'd'
+#define BLOG_ARG_STRING         's'     // Length byte + bytes, no terminator
+
+#pragma pack(push, 1)
+
+// 8-byte header on every record
+struct BinaryLogRecordHeader {
+    uint8_t Sync;               // BLOG_RECORD_SYNC
+    uint8_t Type;               // BinaryLogRecord_t
+    uint16_t Length;            // Whole record including this header
+    uint32_t TimestampMillis;
+};
+
+// File starts with this, before the first record
+struct BinaryLogFileHeader {
+    char Magic[8];              // BLOG_FILE_MAGIC, not terminated
+    uint16_t Version;
+    uint8_t ModuleRole;
+    uint8_t Reserved;
+    uint32_t StartMillis;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(BinaryLogRecordHeader) == 8, "BinaryLogRecordHeader must be 8 bytes");
+static_assert(sizeof(BinaryLogFileHeader) == 16, "BinaryLogFileHeader must be 16 bytes");
+
+// One per BLOG() call site, static storage
+struct BinaryLogSite {
+    LogLevel_t level;
+    const char* component;
+    const char* format;
+    uint16_t generation;        // Log file the definition was last written to
+};
+
+// Never called - lets the compiler check BLOG() arguments against the format
+static inline void blogFormatCheck(const char*, ...) __attribute__((format(printf, 1, 2)));
+static inline void blogFormatCheck(const char*, ...) {}
+
+#define BLOG(level, component, format, ...) \
+    do { \
+        if ((level) >= LOG_WARNING) DiagnosticManager::countLevel(level); \
+        if ((level) >= BLOG_MIN_LEVEL && BinaryLog::isEnabled(level)) { \
+            static BinaryLogSite blogSite_ = { (level), (component), (format), 0 }; \
+            if (0) blogFormatCheck((format), ##__VA_ARGS__); \
+            BinaryLog::write(&blogSite_, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+class BinaryLog {
+public:
+    // Initialization - after the SD card is up
+    static void initialize();
+    static bool isActive() { return _active; }
+    static bool isEnabled(LogLevel_t level) { return _active && DiagnosticManager::isLogEnabled(level); }
+
+    // Recording - any context
+    template <typename... Args>
+    static void write(BinaryLogSite* site, Args... args) {
+        uint8_t record[BLOG_MAX_RECORD];
+        size_t len = sizeof(BinaryLogRecordHeader) + sizeof(uint32_t);
+        int unused[] = { 0, (len = encodeArg(record, len, args), 0)... };
+        (void)unused;
+        commit(site, record, len);
+    }
+
+    // SD service - foreground only
+    static void service();      // Idle-time write of whole blocks (from serviceLog())
+    static void flush();        // Write everything and sync
+
+    // Statistics
+    static uint32_t getEventCount() { return _events; }
+    static uint32_t getDropCount() { return _dropped; }
+
+private:
+    static char _buffer[BLOG_BUFFER_SIZE];
+    static volatile uint32_t _head;     // Total bytes appended
+    static uint32_t _tail;              // Total bytes written to SD
+    static volatile uint32_t _events;
+    static volatile uint32_t _dropped;
+    static uint32_t _droppedReported;
+    static volatile uint16_t _generation;
+    static bool _active;
+    static bool _fileOpen;
+    static bool _dirty;
+    static FsFile _file;
+    static char _fileName[32];
+    static uint32_t _lastFlush;
+    static uint32_t _lastSync;
+
+    // Argument encoders - anything else (String in particular) will not compile
+    static size_t encodeArg(uint8_t* record, size_t len, int32_t value) { return put(record, len, BLOG_ARG_INT32, &value, 4); }
+    static size_t encodeArg(uint8_t* record, size_t len, uint32_t value) { return put(record, len, BLOG_ARG_UINT32, &value, 4); }
+    static size_t encodeArg(uint8_t* record, size_t len, int64_t value) { return put(record, len, BLOG_ARG_INT64, &value, 8); }
+    static size_t encodeArg(uint8_t* record, size_t len, uint64_t value) { return put(record, len, BLOG_ARG_UINT64, &value, 8); }
+    static size_t encodeArg(uint8_t* record, size_t len, float value) { return put(record, len, BLOG_ARG_FLOAT, &value, 4); }
+    static size_t encodeArg(uint8_t* record, size_t len, double value) { return put(record, len, BLOG_ARG_DOUBLE, &value, 8); }
+    static size_t encodeArg(uint8_t* record, size_t len, const char* value);
+
+    // Narrower integers, bool and long promote to the 32-bit encoders
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && sizeof(T) <= 4, size_t>::type
+    encodeArg(uint8_t* record, size_t len, T value) {
+        if (std::is_signed<T>::value) return encodeArg(record, len, (int32_t)value);
+        return encodeArg(record, len, (uint32_t)value);
+    }
+
+    static size_t put(uint8_t* record, size_t len, uint8_t tag, const void* value, size_t size);
+    static void commit(BinaryLogSite* site, uint8_t* record, size_t len);
+    static bool append(const uint8_t* data, size_t len);
+    static size_t appendDefinition(const BinaryLogSite* site, uint32_t now);
+    static void createFileName(char* buffer, size_t bufferSize, uint32_t now);
+    static bool openFile();
+    static size_t writeBytes(uint32_t limit, uint32_t maxBytes, bool alignToBlock);
+};
+
+#endif // BINARY_LOG_H
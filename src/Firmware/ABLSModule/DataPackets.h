@@ -16,6 +16,12 @@ const unsigned int COMMAND_PORT = 8002;
 const unsigned int RTCM_PORT = 8003;
 const unsigned int OTA_COMMAND_PORT = 8004;
 const unsigned int OTA_RESPONSE_PORT = 8005;
+const unsigned int FIRMWARE_MULTICAST_PORT = 8006;   // Toughbook -> modules, multicast group
+const unsigned int FIRMWARE_REPORT_PORT = 8007;      // Modules -> Toughbook, block reports
+const unsigned int LEVELLING_PORT = 8008;            // Wings/Toughbook -> centre, local levelling
+const unsigned int PROFILER_PORT = 8009;             // Profile request in, report back to the requester
+const unsigned int BENCHMARK_REPORT_PORT = 8010;     // Modules -> RUN_BENCHMARK requester, JSON lines
+const unsigned int LINK_PROBE_PORT = 8011;           // RTT probes to the Toughbook, echoed back
 
 // Sender ID enumeration
 typedef enum {
@@ -26,10 +32,74 @@ typedef enum {
 } SenderId_t;
 
 // --- Outgoing: Sensor Data from ABLS Modules to Toughbook ---
+// In-memory sample assembled each cycle. NetworkManager serialises it as
+// SensorDataPacketV2 (default) or SensorDataPacketV1 (compatibility); the
+// batched format (v3) comes from TelemetryBatcher instead.
 struct SensorDataPacket {
     // Packet Metadata
     uint8_t SenderId = SENDER_UNKNOWN;
     uint32_t Timestamp = 0;
+    uint32_t SampleTimeMicros = 0;   // micros() of the IMU sample in this packet
+    uint32_t RadarSampleMicros = 0;  // micros() of the radar measurement
+    uint32_t RamSampleMicros = 0;    // micros() of the oldest ram ADC sample
+    
+    // GPS Data (High-Precision)
+    double Latitude = 0.0;
+    double Longitude = 0.0;
+    double Altitude = 0.0;
+    float GpsHeading = 0.0;
+    float GpsSpeed = 0.0;
+    int Satellites = 0;
+    uint8_t GPSFixQuality = 0;       // 0=No fix, 1=GPS fix, 2=DGPS fix
+    
+    // RTK Quality Data
+    uint8_t RTKStatus = 0;           // 0=None, 1=Float, 2=Fixed
+    float HorizontalAccuracy = 999.0; // Accuracy in meters
+    uint32_t GPSTimestamp = 0;       // iTOW for synchronization
+
+    // IMU Data (Quaternion + Linear)
+    float QuaternionW = 1.0;
+    float QuaternionX = 0.0;
+    float QuaternionY = 0.0;
+    float QuaternionZ = 0.0;
+    float AccelX = 0.0;
+    float AccelY = 0.0;
+    float AccelZ = 0.0;
+    float GyroX = 0.0;
+    float GyroY = 0.0;
+    float GyroZ = 0.0;
+
+    // Radar Data
+    float RadarDistance = 0.0;
+    uint8_t RadarValid = 0;          // 0=Invalid, 1=Valid
+    
+    // Dead Reckoning (Wing modules only) - GNSS/IMU fused at IMU rate
+    double FusedLatitude = 0.0;
+    double FusedLongitude = 0.0;
+    double FusedAltitude = 0.0;
+    float VelocityNorth = 0.0;       // m/s
+    float VelocityEast = 0.0;
+    float VelocityDown = 0.0;
+    uint8_t FusionValid = 0;         // 0=Invalid, 1=Valid
+    
+    // Hydraulic Ram Positions (Centre module only)
+    float RamPosCenterPercent = 50.0;
+    float RamPosLeftPercent = 50.0;
+    float RamPosRightPercent = 50.0;
+    
+    // Command echo (Centre module only) - last command the valves acted on
+    uint8_t CommandEchoValid = 0;
+    uint32_t CommandId = 0;
+    uint32_t CommandReceiveMicros = 0;   // micros() when the datagram was read
+    uint32_t CommandApplyMicros = 0;     // micros() of the first control tick using it
+};
+
+// --- Wire format v1: original raw struct (compatibility mode) ---
+// Layout must not change - existing Toughbook builds read it byte-for-byte.
+struct SensorDataPacketV1 {
+    // Packet Metadata
+    uint8_t SenderId = SENDER_UNKNOWN;
+    uint32_t Timestamp = 0;
     
     // GPS Data (High-Precision)
     double Latitude = 0.0;
@@ -67,6 +137,186 @@ struct SensorDataPacket {
     float RamPosRightPercent = 50.0;
 };
 
+// --- Wire format v2: packed, versioned, little-endian ---
+// All multi-byte fields are little-endian (native on the i.MX RT1062).
+// Sequence increments per packet per module so the receiver can detect
+// loss and reordering.
+#define SENSOR_PACKET_MAGIC         0xAB15
+#define SENSOR_PACKET_VERSION       2
+
+// SensorDataPacketV2::Flags
+#define SENSOR_FLAG_GPS_FIX         0x01
+#define SENSOR_FLAG_RADAR_VALID     0x02
+#define SENSOR_FLAG_TIME_SYNCED     0x04    // SampleGpsTimeMicros is valid
+#define SENSOR_FLAG_FUSION_VALID    0x08    // Fused position/velocity are valid
+#define SENSOR_FLAG_COMMAND_ECHO    0x10    // Command echo fields are valid
+
+// Fixed-point scales
+#define SENSOR_SCALE_LATLON         1e9     // int64 = degrees * 1e9
+#define SENSOR_SCALE_QUAT           16384.0 // Q14, matches BNO080 rotation vector
+#define SENSOR_SCALE_ACCEL          100.0   // int16 = m/s^2 * 100
+#define SENSOR_SCALE_GYRO           1000.0  // int16 = rad/s * 1000
+#define SENSOR_SCALE_RAM            100.0   // int16 = percent * 100
+#define SENSOR_SCALE_VELOCITY       1000.0  // int16 = m/s * 1000
+
+typedef enum {
+    SENSOR_WIRE_V1 = 1,     // Raw SensorDataPacketV1 struct
+    SENSOR_WIRE_V2 = 2,     // Packed SensorDataPacketV2
+    SENSOR_WIRE_BATCHED = 3 // SensorBatchHeader + per-stream sample arrays
+} SensorWireFormat_t;
+
+struct __attribute__((packed)) SensorPacketHeaderV2 {
+    uint16_t Magic;                 // SENSOR_PACKET_MAGIC
+    uint8_t Version;                // SENSOR_PACKET_VERSION
+    uint8_t SenderId;               // SenderId_t
+    uint32_t Sequence;              // Per-module packet counter
+    uint32_t SampleTimeMicros;      // Module micros() at sample capture
+    uint64_t SampleGpsTimeMicros;   // Same instant in GPS time-of-week microseconds
+    uint16_t PayloadLength;         // Bytes following this header
+};
+
+struct __attribute__((packed)) SensorDataPacketV2 {
+    SensorPacketHeaderV2 Header;
+    
+    // GPS Data
+    int64_t LatitudeE9;             // Degrees * 1e9
+    int64_t LongitudeE9;            // Degrees * 1e9
+    int32_t AltitudeMm;             // Millimetres above ellipsoid
+    uint16_t HorizontalAccuracyMm;  // Saturates at 65535
+    uint32_t GPSTimestamp;          // iTOW (ms)
+    int16_t GpsHeadingCdeg;         // Degrees * 100, -180..180 (negative = west of north)
+    uint16_t GpsSpeedCms;           // cm/s
+    uint8_t Satellites;
+    uint8_t GPSFixQuality;
+    uint8_t RTKStatus;
+    uint8_t Flags;                  // SENSOR_FLAG_*
+    
+    // IMU Data
+    int16_t QuaternionW, QuaternionX, QuaternionY, QuaternionZ;  // Q14
+    int16_t AccelX, AccelY, AccelZ;                              // m/s^2 * 100
+    int16_t GyroX, GyroY, GyroZ;                                 // rad/s * 1000
+    
+    // Radar Data
+    uint16_t RadarDistanceMm;
+    
+    // Hydraulic Ram Positions (Centre module only)
+    int16_t RamPosCenter, RamPosLeft, RamPosRight;               // Percent * 100
+    
+    // Sample times relative to the header sample time (same clock)
+    int32_t RadarTimeOffsetUs;
+    int32_t RamTimeOffsetUs;
+    
+    // Dead Reckoning (Wing modules only) - valid with SENSOR_FLAG_FUSION_VALID
+    int64_t FusedLatitudeE9;        // Degrees * 1e9
+    int64_t FusedLongitudeE9;       // Degrees * 1e9
+    int32_t FusedAltitudeMm;        // Millimetres
+    int16_t VelocityNorth, VelocityEast, VelocityDown;           // mm/s
+    
+    // Command echo (Centre module only) - valid with SENSOR_FLAG_COMMAND_ECHO.
+    // Fields are only ever appended; older readers stop at PayloadLength.
+    uint32_t CommandId;             // Last ControlCommandPacket the valves acted on
+    int32_t CommandReceiveOffsetUs; // Datagram read time - header sample time
+    int32_t CommandApplyOffsetUs;   // First control tick using it - header sample time
+};
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "SensorDataPacketV2 is defined little-endian");
+static_assert(sizeof(SensorPacketHeaderV2) == 22, "SensorPacketHeaderV2 layout changed");
+static_assert(sizeof(SensorDataPacketV2) == 130, "SensorDataPacketV2 layout changed");
+
+// --- Wire format v3: batched streams ---
+// Same header as v2 with Version 3. Header.SampleTimeMicros is the batch
+// reference time; every record carries its own offset from it. After the
+// SensorBatchHeader come SectionCount sections, each a SensorBatchSection
+// followed by Count records of RecordSize bytes - readers skip streams they
+// do not know by RecordSize, and records only ever grow at the end.
+// High-rate streams carry every sample (or every Nth, per stream interval)
+// since the last datagram; GNSS and command echo appear only when they
+// changed, and are repeated every TELEMETRY_SLOW_REPEAT_US so loss heals.
+#define SENSOR_BATCH_VERSION        3
+
+typedef enum {
+    SENSOR_STREAM_IMU = 0,
+    SENSOR_STREAM_RADAR = 1,
+    SENSOR_STREAM_RAM = 2,          // Centre module only
+    SENSOR_STREAM_FUSION = 3,       // Wing modules only
+    SENSOR_STREAM_GNSS = 4,         // On change
+    SENSOR_STREAM_COMMAND_ECHO = 5, // On change, centre module only
+    SENSOR_STREAM_COUNT
+} SensorStreamId_t;
+
+struct __attribute__((packed)) SensorBatchHeader {
+    SensorPacketHeaderV2 Header;    // Version = SENSOR_BATCH_VERSION
+    uint8_t Flags;                  // SENSOR_FLAG_TIME_SYNCED only
+    uint8_t SectionCount;
+    uint16_t Dropped;               // Samples overwritten before they could be sent (saturates)
+};
+
+struct __attribute__((packed)) SensorBatchSection {
+    uint8_t StreamId;               // SensorStreamId_t
+    uint8_t Count;
+    uint8_t RecordSize;
+    uint8_t Reserved;
+};
+
+struct __attribute__((packed)) SensorBatchImu {
+    int32_t TimeOffsetUs;           // Sample time - header sample time
+    int16_t QuaternionW, QuaternionX, QuaternionY, QuaternionZ;  // Q14
+    int16_t AccelX, AccelY, AccelZ;                              // m/s^2 * 100
+    int16_t GyroX, GyroY, GyroZ;                                 // rad/s * 1000
+};
+
+struct __attribute__((packed)) SensorBatchRadar {
+    int32_t TimeOffsetUs;
+    uint16_t DistanceMm;
+    uint8_t Valid;
+    uint8_t Reserved;
+};
+
+struct __attribute__((packed)) SensorBatchRam {
+    int32_t TimeOffsetUs;           // Oldest of the three ADC samples
+    int16_t RamPosCenter, RamPosLeft, RamPosRight;               // Percent * 100
+};
+
+struct __attribute__((packed)) SensorBatchFusion {
+    int32_t TimeOffsetUs;
+    int64_t FusedLatitudeE9;        // Degrees * 1e9
+    int64_t FusedLongitudeE9;
+    int32_t FusedAltitudeMm;
+    int16_t VelocityNorth, VelocityEast, VelocityDown;           // mm/s
+    uint8_t Valid;
+    uint8_t Reserved;
+};
+
+struct __attribute__((packed)) SensorBatchGnss {
+    int32_t TimeOffsetUs;           // Epoch arrival
+    int64_t LatitudeE9;
+    int64_t LongitudeE9;
+    int32_t AltitudeMm;
+    uint16_t HorizontalAccuracyMm;
+    uint32_t GPSTimestamp;          // iTOW (ms)
+    int16_t GpsHeadingCdeg;
+    uint16_t GpsSpeedCms;
+    uint8_t Satellites;
+    uint8_t GPSFixQuality;
+    uint8_t RTKStatus;
+    uint8_t Reserved;
+};
+
+struct __attribute__((packed)) SensorBatchCommandEcho {
+    uint32_t CommandId;
+    int32_t ReceiveOffsetUs;
+    int32_t ApplyOffsetUs;
+};
+
+static_assert(sizeof(SensorBatchHeader) == 26, "SensorBatchHeader layout changed");
+static_assert(sizeof(SensorBatchSection) == 4, "SensorBatchSection layout changed");
+static_assert(sizeof(SensorBatchImu) == 24, "SensorBatchImu layout changed");
+static_assert(sizeof(SensorBatchRadar) == 8, "SensorBatchRadar layout changed");
+static_assert(sizeof(SensorBatchRam) == 10, "SensorBatchRam layout changed");
+static_assert(sizeof(SensorBatchFusion) == 32, "SensorBatchFusion layout changed");
+static_assert(sizeof(SensorBatchGnss) == 38, "SensorBatchGnss layout changed");
+static_assert(sizeof(SensorBatchCommandEcho) == 12, "SensorBatchCommandEcho layout changed");
+
 // --- Incoming: Control Commands from Toughbook to Centre Module ---
 struct ControlCommandPacket {
     // Command Metadata
@@ -83,10 +333,159 @@ struct ControlCommandPacket {
     uint8_t SystemEnable = 1;        // 1=System enabled
 };
 
+// --- Local levelling: wing heights and Toughbook supervision to the centre ---
+// Wings send their radar height straight to the centre module on every new
+// radar measurement, so the height loop closes without the Toughbook. The
+// Toughbook only supervises - target heights and enable - and must refresh
+// that at least every LEVELLING_SUPERVISION_TIMEOUT_MS. Ram autotune is
+// requested on the same port and reported back one packet per ram.
+#define LEVELLING_PACKET_MAGIC      0xAB19
+#define LEVELLING_PACKET_VERSION    1
+
+typedef enum {
+    LEVELLING_MSG_WING_HEIGHT = 1,  // Wing module -> centre
+    LEVELLING_MSG_SUPERVISION = 2,  // Toughbook -> centre
+    LEVELLING_MSG_AUTOTUNE_REQUEST = 3, // Toughbook -> centre
+    LEVELLING_MSG_AUTOTUNE_REPORT = 4   // Centre -> requester, one per ram tuned
+} LevellingMessageType_t;
+
+// LevellingPacketHeader::Flags
+#define LEVELLING_FLAG_RADAR_VALID  0x01    // Wing height: radar measurement valid
+#define LEVELLING_FLAG_TILT_VALID   0x02    // Wing height: tilt compensation applied
+#define LEVELLING_FLAG_ENABLE       0x01    // Supervision: run the local height loop
+#define LEVELLING_FLAG_GAINS_SAVED  0x01    // Autotune report: gains written to EEPROM
+
+struct __attribute__((packed)) LevellingPacketHeader {
+    uint16_t Magic;                 // LEVELLING_PACKET_MAGIC
+    uint8_t Version;                // LEVELLING_PACKET_VERSION
+    uint8_t MessageType;            // LevellingMessageType_t
+    uint8_t SenderId;               // SenderId_t (SENDER_UNKNOWN from the Toughbook)
+    uint8_t Flags;                  // LEVELLING_FLAG_*
+    uint32_t Sequence;              // Per-sender packet counter
+};
+
+struct __attribute__((packed)) WingHeightPacket {
+    LevellingPacketHeader Header;
+    uint32_t SampleTimeMicros;      // Sender micros() at radar measurement
+    uint16_t HeightMm;              // Radar distance corrected for wing tilt
+    int16_t RollCdeg;               // Wing roll, degrees * 100
+    int16_t PitchCdeg;              // Wing pitch, degrees * 100
+};
+
+struct __attribute__((packed)) LevellingSupervisionPacket {
+    LevellingPacketHeader Header;
+    uint16_t TargetHeightLeftMm;    // Boom height above ground wanted at each wing
+    uint16_t TargetHeightRightMm;
+};
+
+typedef enum {
+    AUTOTUNE_ACTION_START = 1,      // Tune the rams in RamMask, in channel order
+    AUTOTUNE_ACTION_ABORT = 2,      // Stop, ram under test back on its previous gains
+    AUTOTUNE_ACTION_FORGET = 3      // Default gains, saved gains erased
+} AutotuneAction_t;
+
+typedef enum {
+    AUTOTUNE_RESULT_OK = 0,         // New gains in use
+    AUTOTUNE_RESULT_MOVING,         // Machine not stationary - refused or aborted
+    AUTOTUNE_RESULT_BUSY,           // Startup hold, e-stop, local levelling or a tune already running
+    AUTOTUNE_RESULT_ABORTED,        // Toughbook abort or emergency stop
+    AUTOTUNE_RESULT_NOT_REACHED,    // Ram never got to the test position
+    AUTOTUNE_RESULT_NO_OSCILLATION, // Relay produced no steady oscillation
+    AUTOTUNE_RESULT_EXCURSION,      // Ram left the test window under relay
+    AUTOTUNE_RESULT_OVERSHOOT,      // Still overshooting after every retry
+    AUTOTUNE_RESULT_NOT_SETTLED,    // Step did not settle in time
+    AUTOTUNE_RESULT_SAFETY_TRIP,    // Ram outside the safe stroke
+    AUTOTUNE_RESULT_INVALID         // Bad request - no rams, or not the centre module
+} AutotuneResult_t;
+
+#define AUTOTUNE_RAM_NONE           0xFF    // Autotune report: whole request refused
+
+struct __attribute__((packed)) AutotuneRequestPacket {
+    LevellingPacketHeader Header;
+    uint8_t Action;                 // AutotuneAction_t
+    uint8_t RamMask;                // Bit 0 centre, 1 left, 2 right
+    uint16_t TargetSettlingMs;      // 0 = fastest the identified loop allows
+};
+
+struct __attribute__((packed)) AutotuneReportPacket {
+    LevellingPacketHeader Header;   // Flags: LEVELLING_FLAG_GAINS_SAVED
+    uint8_t Ram;                    // 0 centre, 1 left, 2 right, AUTOTUNE_RAM_NONE for a refusal
+    uint8_t Result;                 // AutotuneResult_t
+    uint8_t Attempts;               // Step benchmarks run
+    uint8_t Reserved;
+    float Kp;                       // Gains in use after the tune
+    float Ki;
+    float Kd;
+    float UltimateGain;             // Relay identification (PID output per %)
+    uint16_t UltimatePeriodMs;
+    uint16_t DeadTimeMs;            // Valve and feedback lag
+    float ValveGain;                // Ram %/s per PID output unit
+    uint16_t TargetSettlingMs;
+    uint16_t RiseTimeMs;            // Step benchmark, 10-90%
+    uint16_t OvershootCentiPercent; // Percent of the step * 100
+    uint16_t SettlingTimeMs;        // Into 2% of the step and staying there
+};
+
+static_assert(sizeof(LevellingPacketHeader) == 10, "LevellingPacketHeader layout changed");
+static_assert(sizeof(WingHeightPacket) == 20, "WingHeightPacket layout changed");
+static_assert(sizeof(LevellingSupervisionPacket) == 14, "LevellingSupervisionPacket layout changed");
+static_assert(sizeof(AutotuneRequestPacket) == 14, "AutotuneRequestPacket layout changed");
+static_assert(sizeof(AutotuneReportPacket) == 46, "AutotuneReportPacket layout changed");
+
+// --- Diagnostics: loop profiler export ---
+// Any host may send a ProfileRequestPacket; the module answers the sender
+// with one ProfileReportHeader followed by ProbeCount ProfileProbeRecords.
+#define PROFILE_PACKET_MAGIC        0xAB1B
+#define PROFILE_PACKET_VERSION      1
+#define PROFILE_HISTOGRAM_BINS      24      // log2 bins of CPU cycles
+#define PROFILE_HISTOGRAM_FIRST_BIT 6       // Bin 0 = below 128 cycles, bin 23 = 2^29 and up
+
+typedef enum {
+    PROFILE_MSG_REQUEST = 1,
+    PROFILE_MSG_REPORT = 2
+} ProfileMessageType_t;
+
+#define PROFILE_FLAG_RESET          0x01    // Request: clear statistics after reporting
+
+struct __attribute__((packed)) ProfileRequestPacket {
+    uint16_t Magic;                 // PROFILE_PACKET_MAGIC
+    uint8_t Version;                // PROFILE_PACKET_VERSION
+    uint8_t MessageType;            // PROFILE_MSG_REQUEST
+    uint8_t Flags;                  // PROFILE_FLAG_*
+    uint8_t Reserved[3];
+};
+
+struct __attribute__((packed)) ProfileReportHeader {
+    uint16_t Magic;                 // PROFILE_PACKET_MAGIC
+    uint8_t Version;                // PROFILE_PACKET_VERSION
+    uint8_t MessageType;            // PROFILE_MSG_REPORT
+    uint8_t SenderId;               // SenderId_t
+    uint8_t ProbeCount;
+    uint8_t HistogramBins;          // PROFILE_HISTOGRAM_BINS
+    uint8_t HistogramFirstBit;      // PROFILE_HISTOGRAM_FIRST_BIT
+    uint32_t CpuHz;                 // Cycles per second, to convert to time
+    uint32_t Sequence;              // Per-module report counter
+    uint32_t WindowMillis;          // Time covered since the last reset
+};
+
+struct __attribute__((packed)) ProfileProbeRecord {
+    uint8_t ProbeId;                // ProfileProbe_t
+    uint8_t Reserved;
+    uint32_t Count;
+    uint32_t MinCycles;
+    uint32_t MaxCycles;
+    uint32_t MeanCycles;
+    uint16_t Histogram[PROFILE_HISTOGRAM_BINS];  // Saturating counts
+};
+
+static_assert(sizeof(ProfileRequestPacket) == 8, "ProfileRequestPacket layout changed");
+static_assert(sizeof(ProfileReportHeader) == 20, "ProfileReportHeader layout changed");
+static_assert(sizeof(ProfileProbeRecord) == 66, "ProfileProbeRecord layout changed");
+
 // --- RgFModuleUpdate: Firmware Update Commands ---
 struct RgFModuleUpdateCommandPacket {
     // Command Metadata
-    char Command[32] = "STATUS_QUERY";  // Commands: STATUS_QUERY, START_UPDATE, ABORT_UPDATE
+    char Command[32] = "STATUS_QUERY";  // Commands: STATUS_QUERY, START_UPDATE, ABORT_UPDATE, RUN_BENCHMARK
     uint32_t Timestamp = 0;
     
     // Update Parameters (for START_UPDATE command)
@@ -119,4 +518,204 @@ struct RgFModuleUpdateStatusPacket {
     uint32_t PacketsReceived = 0;
 };
 
+// --- RgFModuleUpdate: Timing telemetry ---
+// Deadline summary for the module's periodic tasks. Sent on
+// OTA_RESPONSE_PORT after every status response and every
+// TIMING_STATUS_INTERVAL_MS, so fleet timing shows up without a console.
+// Each periodic send closes its reporting window.
+#define TIMING_PACKET_MAGIC         0xAB1C
+#define TIMING_PACKET_VERSION       1
+
+typedef enum {
+    TIMING_CHANNEL_SENSOR_SEND = 0, // 50Hz sensor packet to the Toughbook
+    TIMING_CHANNEL_HYDRAULIC = 1,   // Hydraulic control tick (centre module)
+    TIMING_CHANNEL_IMU = 2,         // IMU poll, or rotation vector reports on INT
+    TIMING_CHANNEL_COUNT
+} TimingChannel_t;
+
+struct __attribute__((packed)) TimingChannelRecord {
+    uint32_t NominalPeriodUs;
+    uint32_t Count;                 // Runs in the window (0 = channel not in use)
+    uint32_t MinPeriodUs;
+    uint32_t MaxPeriodUs;
+    uint32_t MeanPeriodUs;
+    uint32_t MeanJitterUs;          // Mean |actual - nominal| period
+    uint32_t MaxJitterUs;
+    uint32_t Overruns;              // Runs more than half a period late
+    uint32_t Skipped;               // Whole periods missed
+};
+
+struct __attribute__((packed)) TimingStatusPacket {
+    uint16_t Magic;                 // TIMING_PACKET_MAGIC
+    uint8_t Version;                // TIMING_PACKET_VERSION
+    uint8_t SenderId;               // SenderId_t
+    uint32_t Timestamp;             // millis() at send
+    uint32_t WindowMillis;          // Time covered by the records
+    uint8_t ChannelCount;           // TIMING_CHANNEL_COUNT
+    uint8_t Reserved[3];
+    TimingChannelRecord Channels[TIMING_CHANNEL_COUNT];
+};
+
+static_assert(sizeof(TimingChannelRecord) == 36, "TimingChannelRecord layout changed");
+static_assert(sizeof(TimingStatusPacket) == 16 + 36 * TIMING_CHANNEL_COUNT, "TimingStatusPacket layout changed");
+
+// --- RgFModuleUpdate: Link-quality telemetry ---
+// Per-socket traffic and loss counters, command sequence gaps and Toughbook
+// round-trip times. Sent on OTA_RESPONSE_PORT alongside the timing status.
+// Socket and command counters run from boot; round-trip and receive queue
+// figures cover WindowMillis and each periodic send closes the window.
+#define LINK_PACKET_MAGIC           0xAB1D
+#define LINK_PACKET_VERSION         1
+
+typedef enum {
+    LINK_MSG_STATUS = 1,            // Module -> Toughbook, LinkStatusPacket
+    LINK_MSG_PROBE = 2,             // Module -> Toughbook, LinkProbePacket
+    LINK_MSG_ECHO = 3               // Toughbook -> module, the probe returned with only MessageType changed
+} LinkMessageType_t;
+
+typedef enum {
+    LINK_SOCKET_SENSOR = 0,         // SENSOR_DATA_PORT
+    LINK_SOCKET_COMMAND = 1,        // COMMAND_PORT (centre module)
+    LINK_SOCKET_RTCM = 2,           // RTCM_PORT, relay out (centre) or corrections in (wings)
+    LINK_SOCKET_LEVELLING = 3,      // LEVELLING_PORT
+    LINK_SOCKET_UPDATE_COMMAND = 4, // OTA_COMMAND_PORT
+    LINK_SOCKET_UPDATE_STATUS = 5,  // OTA_RESPONSE_PORT and benchmark lines
+    LINK_SOCKET_FIRMWARE_MCAST = 6, // FIRMWARE_MULTICAST_PORT, block reports out
+    LINK_SOCKET_PROFILER = 7,       // PROFILER_PORT
+    LINK_SOCKET_PROBE = 8,          // LINK_PROBE_PORT
+    LINK_SOCKET_COUNT
+} LinkSocket_t;
+
+struct __attribute__((packed)) LinkSocketRecord {
+    uint32_t TxPackets;
+    uint32_t TxFailures;            // endPacket() refused - no buffer, no route or no link
+    uint32_t RxPackets;             // Accepted datagrams
+    uint32_t RxDropped;             // Overwritten in the socket receive queue before being read
+    uint32_t RxWrongSize;           // Length not valid for the port
+    uint32_t RxInvalid;             // Short read, bad magic/version or unknown message
+    uint16_t RxQueueHighWater;      // Most datagrams waiting at one poll in the window
+    uint16_t RxQueueCapacity;       // Socket receive queue depth
+};
+
+struct __attribute__((packed)) LinkStatusPacket {
+    uint16_t Magic;                 // LINK_PACKET_MAGIC
+    uint8_t Version;                // LINK_PACKET_VERSION
+    uint8_t MessageType;            // LINK_MSG_STATUS
+    uint8_t SenderId;               // SenderId_t
+    uint8_t SocketCount;            // LINK_SOCKET_COUNT
+    uint8_t Reserved[2];
+    uint32_t Timestamp;             // millis() at send
+    uint32_t WindowMillis;          // Time covered by the round-trip and queue figures
+    
+    // Incoming command sequence (centre module) - by CommandId
+    uint32_t CommandsMissed;        // CommandIds skipped and not seen since
+    uint32_t CommandsDuplicated;    // Same CommandId again
+    uint32_t CommandsReordered;     // Arrived after a newer CommandId
+    uint32_t CommandResyncs;        // CommandId jumped too far - Toughbook restarted
+    
+    // Round trip to the Toughbook over LINK_PROBE_PORT
+    uint32_t ProbesSent;            // In the window
+    uint32_t ProbesAnswered;        // In the window, echoes of this boot's probes only
+    uint32_t RttMinUs;
+    uint32_t RttMeanUs;
+    uint32_t RttMaxUs;
+    uint32_t RttLastUs;             // Most recent echo, kept across windows (0 = none yet)
+    
+    LinkSocketRecord Sockets[LINK_SOCKET_COUNT];
+};
+
+struct __attribute__((packed)) LinkProbePacket {
+    uint16_t Magic;                 // LINK_PACKET_MAGIC
+    uint8_t Version;                // LINK_PACKET_VERSION
+    uint8_t MessageType;            // LINK_MSG_PROBE, or LINK_MSG_ECHO on return
+    uint8_t SenderId;               // SenderId_t
+    uint8_t Reserved[3];
+    uint32_t Sequence;              // Per-module probe counter
+    uint32_t SendMicros;            // Module micros() at send, echoed unchanged
+};
+
+static_assert(sizeof(LinkSocketRecord) == 28, "LinkSocketRecord layout changed");
+static_assert(sizeof(LinkStatusPacket) == 56 + 28 * LINK_SOCKET_COUNT, "LinkStatusPacket layout changed");
+static_assert(sizeof(LinkProbePacket) == 16, "LinkProbePacket layout changed");
+
+// --- RgFModuleUpdate: Multicast Firmware Distribution ---
+// One image is multicast to every module in a role group at once. The image
+// is cut into blocks; after every FecGroupSize data blocks the Toughbook
+// sends one XOR parity block, so a module rebuilds any single lost block of
+// a group without asking. Remaining gaps are reported on request and the
+// Toughbook multicasts the union of what is missing, serving all modules
+// with one repair pass. All fields are little-endian.
+#define FIRMWARE_MCAST_MAGIC            0xAB17
+#define FIRMWARE_MCAST_VERSION          1
+#define FIRMWARE_MCAST_MAX_BLOCK_SIZE   1024    // Data bytes per block datagram
+#define FIRMWARE_MCAST_MAX_FEC_GROUP    32      // Data blocks per parity block
+#define FIRMWARE_MCAST_MAX_RANGES       64      // Missing ranges per report
+#define FIRMWARE_MCAST_ROLE_ALL         0xFF    // RoleMask: every module
+
+typedef enum {
+    FW_MCAST_ANNOUNCE = 1,          // Session parameters, repeated through the session
+    FW_MCAST_DATA = 2,              // Image block
+    FW_MCAST_PARITY = 3,            // XOR of one FEC group of blocks
+    FW_MCAST_QUERY = 4,             // Toughbook asks every module for a report
+    FW_MCAST_ABORT = 5,             // Toughbook abandons the session
+    FW_MCAST_REPORT = 6             // Module state and missing blocks (unicast reply)
+} FirmwareMulticastType_t;
+
+// FirmwareMulticastReport::State
+typedef enum {
+    FW_MCAST_STATE_IDLE = 0,
+    FW_MCAST_STATE_PREPARING = 1,   // Erasing the staging area
+    FW_MCAST_STATE_RECEIVING = 2,   // Ready for blocks
+    FW_MCAST_STATE_COMPLETE = 3,    // All blocks held - validating and flashing
+    FW_MCAST_STATE_INSTALLED = 4,   // Flashed and verified - reboot required
+    FW_MCAST_STATE_FAILED = 5,
+    FW_MCAST_STATE_DECLINED = 6     // Not safe to update, or another update running
+} FirmwareMulticastState_t;
+
+struct __attribute__((packed)) FirmwareMulticastHeader {
+    uint16_t Magic;                 // FIRMWARE_MCAST_MAGIC
+    uint8_t Version;                // FIRMWARE_MCAST_VERSION
+    uint8_t Type;                   // FirmwareMulticastType_t
+    uint32_t SessionId;             // Chosen by the Toughbook per transfer
+};
+
+struct __attribute__((packed)) FirmwareMulticastAnnounce {
+    FirmwareMulticastHeader Header;
+    uint8_t RoleMask;               // Bit per ModuleRole_t, or FIRMWARE_MCAST_ROLE_ALL
+    uint8_t FecGroupSize;           // Data blocks per parity block (0 = no parity)
+    uint16_t BlockSize;             // Bytes per block (last block may be short)
+    uint32_t ImageSize;
+    uint16_t BlockCount;
+    uint16_t VersionMajor;
+    uint16_t VersionMinor;
+    uint16_t VersionPatch;
+    uint8_t ImageSha256[32];
+};
+
+// FW_MCAST_DATA: Index is the block; FW_MCAST_PARITY: Index is the group.
+// The datagram carries Length bytes of Data.
+struct __attribute__((packed)) FirmwareMulticastBlock {
+    FirmwareMulticastHeader Header;
+    uint16_t Index;
+    uint16_t Length;
+    uint8_t Data[FIRMWARE_MCAST_MAX_BLOCK_SIZE];
+};
+
+struct __attribute__((packed)) FirmwareBlockRange {
+    uint16_t First;
+    uint16_t Count;
+};
+
+// Sent to the Toughbook on FIRMWARE_REPORT_PORT; only RangeCount ranges are sent
+struct __attribute__((packed)) FirmwareMulticastReport {
+    FirmwareMulticastHeader Header;
+    uint8_t SenderId;               // SenderId_t
+    uint8_t State;                  // FirmwareMulticastState_t
+    uint16_t BlocksReceived;        // Including recovered blocks
+    uint16_t BlocksRecovered;       // Rebuilt from parity
+    uint16_t MissingCount;          // All missing blocks, listed or not
+    uint8_t RangeCount;
+    FirmwareBlockRange Ranges[FIRMWARE_MCAST_MAX_RANGES];  // Lowest missing first
+};
+
 #endif // DATA_PACKETS_H
@@ -0,0 +1,403 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Dead Reckoning Filter Implementation
+ * 
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "DeadReckoningFilter.h"
+
+// WGS84 ellipsoid
+static const double WGS84_A = 6378137.0;
+static const double WGS84_E2 = 6.69437999014e-3;
+
+DeadReckoningFilter::DeadReckoningFilter() :
+    _initialized(false),
+    _yawOffset(0.0f),
+    _originLat(0.0),
+    _originLon(0.0),
+    _originAlt(0.0),
+    _metresPerDegLat(111320.0),
+    _metresPerDegLon(111320.0),
+    _lastPredictMicros(0),
+    _historyHead(0),
+    _historyCount(0),
+    _predictCount(0),
+    _correctionCount(0),
+    _rejectedCount(0),
+    _consecutiveRejects(0)
+{
+    _leverArm[0] = DR_LEVER_ARM_X;
+    _leverArm[1] = DR_LEVER_ARM_Y;
+    _leverArm[2] = DR_LEVER_ARM_Z;
+    
+    // IMU frame (ENU) to NED until the first orientation arrives
+    memset(_rotation, 0, sizeof(_rotation));
+    _rotation[0][1] = 1.0f;
+    _rotation[1][0] = 1.0f;
+    _rotation[2][2] = -1.0f;
+    
+    reset();
+}
+
+void DeadReckoningFilter::setLeverArm(float x, float y, float z) {
+    _leverArm[0] = x;
+    _leverArm[1] = y;
+    _leverArm[2] = z;
+}
+
+void DeadReckoningFilter::reset() {
+    _initialized = false;
+    memset(_pos, 0, sizeof(_pos));
+    memset(_vel, 0, sizeof(_vel));
+    memset(_accelBias, 0, sizeof(_accelBias));
+    memset(_P, 0, sizeof(_P));
+    _yawOffset = 0.0f;
+    _historyHead = 0;
+    _historyCount = 0;
+    _consecutiveRejects = 0;
+}
+
+void DeadReckoningFilter::predict(uint32_t sampleMicros, float accelX, float accelY, float accelZ,
+                                  float quatI, float quatJ, float quatK, float quatReal) {
+    updateRotation(quatI, quatJ, quatK, quatReal);
+    
+    uint32_t lastMicros = _lastPredictMicros;
+    _lastPredictMicros = sampleMicros;
+    
+    // Nothing to propagate until GNSS has given us an origin
+    if (!_initialized || lastMicros == 0) return;
+    
+    float dt = (int32_t)(sampleMicros - lastMicros) * 1e-6f;
+    if (dt <= 0.0f) return;
+    if (dt > DR_MAX_DT) dt = DR_MAX_DT;
+    
+    // NOMINAL STATE PROPAGATION - BNO080 linear accel already has gravity removed
+    float accelBody[3] = {
+        accelX - _accelBias[0],
+        accelY - _accelBias[1],
+        accelZ - _accelBias[2]
+    };
+    float accelNed[3];
+    rotateToNed(accelBody, accelNed);
+    
+    for (int i = 0; i < 3; i++) {
+        _pos[i] += _vel[i] * dt + 0.5f * accelNed[i] * dt * dt;
+        _vel[i] += accelNed[i] * dt;
+    }
+    
+    // ERROR-STATE TRANSITION - Phi = I + F*dt
+    float phi[DR_STATE_COUNT][DR_STATE_COUNT];
+    memset(phi, 0, sizeof(phi));
+    for (int i = 0; i < DR_STATE_COUNT; i++) phi[i][i] = 1.0f;
+    for (int i = 0; i < 3; i++) {
+        phi[DR_STATE_POS + i][DR_STATE_VEL + i] = dt;
+        for (int j = 0; j < 3; j++) {
+            phi[DR_STATE_VEL + i][DR_STATE_ABIAS + j] = -_rotation[i][j] * dt;
+        }
+    }
+    // d(Rz(yaw) * a) / d(yaw) = (-a_E, a_N, 0)
+    phi[DR_STATE_VEL + 0][DR_STATE_YAW] = -accelNed[1] * dt;
+    phi[DR_STATE_VEL + 1][DR_STATE_YAW] = accelNed[0] * dt;
+    
+    // P = Phi * P * Phi^T + Qd
+    float temp[DR_STATE_COUNT][DR_STATE_COUNT];
+    for (int i = 0; i < DR_STATE_COUNT; i++) {
+        for (int j = 0; j < DR_STATE_COUNT; j++) {
+            float sum = 0.0f;
+            for (int k = 0; k < DR_STATE_COUNT; k++) sum += phi[i][k] * _P[k][j];
+            temp[i][j] = sum;
+        }
+    }
+    for (int i = 0; i < DR_STATE_COUNT; i++) {
+        for (int j = 0; j < DR_STATE_COUNT; j++) {
+            float sum = 0.0f;
+            for (int k = 0; k < DR_STATE_COUNT; k++) sum += temp[i][k] * phi[j][k];
+            _P[i][j] = sum;
+        }
+    }
+    
+    const float accelVar = DR_ACCEL_NOISE * DR_ACCEL_NOISE;
+    for (int i = 0; i < 3; i++) {
+        _P[DR_STATE_POS + i][DR_STATE_POS + i] += accelVar * dt * dt * dt / 3.0f;
+        _P[DR_STATE_VEL + i][DR_STATE_VEL + i] += accelVar * dt;
+        _P[DR_STATE_ABIAS + i][DR_STATE_ABIAS + i] += DR_ABIAS_NOISE * DR_ABIAS_NOISE * dt;
+    }
+    _P[DR_STATE_YAW][DR_STATE_YAW] += DR_YAW_NOISE * DR_YAW_NOISE * dt;
+    symmetrise();
+    
+    // Remember where the antenna was for delayed GNSS epochs
+    HistoryEntry& entry = _history[_historyHead];
+    entry.micros = sampleMicros;
+    rotateToNed(_leverArm, entry.antennaOffset);
+    for (int i = 0; i < 3; i++) entry.pos[i] = _pos[i];
+    _historyHead = (_historyHead + 1) % DR_HISTORY_SIZE;
+    if (_historyCount < DR_HISTORY_SIZE) _historyCount++;
+    
+    // Keep float position resolution sub-millimetre
+    if (fabsf(_pos[0]) > DR_REANCHOR_DISTANCE || fabsf(_pos[1]) > DR_REANCHOR_DISTANCE) {
+        reanchor();
+    }
+    
+    _predictCount++;
+}
+
+bool DeadReckoningFilter::correct(uint32_t epochMicros, double latitude, double longitude, double altitude,
+                                  float horizontalSigma, float verticalSigma) {
+    if (horizontalSigma > DR_MAX_GNSS_SIGMA) {
+        _rejectedCount++;
+        return false;
+    }
+    
+    if (horizontalSigma < DR_MIN_POS_SIGMA) horizontalSigma = DR_MIN_POS_SIGMA;
+    if (verticalSigma < DR_MIN_POS_SIGMA) verticalSigma = DR_MIN_POS_SIGMA;
+    
+    if (!_initialized) {
+        initializeAt(latitude, longitude, altitude, horizontalSigma, verticalSigma);
+        return true;
+    }
+    
+    // Measured antenna position in the local frame
+    float measured[3] = {
+        (float)((latitude - _originLat) * _metresPerDegLat),
+        (float)((longitude - _originLon) * _metresPerDegLon),
+        (float)(-(altitude - _originAlt))
+    };
+    
+    // LATENCY COMPENSATION - compare against the state when the epoch was taken
+    const HistoryEntry* past = findHistory(epochMicros);
+    float pastPos[3], antenna[3];
+    if (past) {
+        memcpy(pastPos, past->pos, sizeof(pastPos));
+        memcpy(antenna, past->antennaOffset, sizeof(antenna));
+    } else {
+        memcpy(pastPos, _pos, sizeof(pastPos));
+        rotateToNed(_leverArm, antenna);
+    }
+    
+    float innovation[3];
+    for (int i = 0; i < 3; i++) {
+        innovation[i] = measured[i] - (pastPos[i] + antenna[i]);
+    }
+    
+    // H: identity on position, lever arm sensitivity to yaw offset
+    float H[3][DR_STATE_COUNT];
+    memset(H, 0, sizeof(H));
+    for (int i = 0; i < 3; i++) H[i][DR_STATE_POS + i] = 1.0f;
+    H[0][DR_STATE_YAW] = -antenna[1];
+    H[1][DR_STATE_YAW] = antenna[0];
+    
+    // PHt = P * H^T, S = H * P * H^T + R
+    float PHt[DR_STATE_COUNT][3];
+    for (int i = 0; i < DR_STATE_COUNT; i++) {
+        for (int j = 0; j < 3; j++) {
+            float sum = 0.0f;
+            for (int k = 0; k < DR_STATE_COUNT; k++) sum += _P[i][k] * H[j][k];
+            PHt[i][j] = sum;
+        }
+    }
+    float S[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            float sum = 0.0f;
+            for (int k = 0; k < DR_STATE_COUNT; k++) sum += H[i][k] * PHt[k][j];
+            S[i][j] = sum;
+        }
+    }
+    S[0][0] += horizontalSigma * horizontalSigma;
+    S[1][1] += horizontalSigma * horizontalSigma;
+    S[2][2] += verticalSigma * verticalSigma;
+    
+    // 3x3 inverse by cofactors
+    float det = S[0][0] * (S[1][1] * S[2][2] - S[1][2] * S[2][1])
+              - S[0][1] * (S[1][0] * S[2][2] - S[1][2] * S[2][0])
+              + S[0][2] * (S[1][0] * S[2][1] - S[1][1] * S[2][0]);
+    if (fabsf(det) < 1e-12f) {
+        _rejectedCount++;
+        return false;
+    }
+    float invDet = 1.0f / det;
+    float Sinv[3][3];
+    Sinv[0][0] = (S[1][1] * S[2][2] - S[1][2] * S[2][1]) * invDet;
+    Sinv[0][1] = (S[0][2] * S[2][1] - S[0][1] * S[2][2]) * invDet;
+    Sinv[0][2] = (S[0][1] * S[1][2] - S[0][2] * S[1][1]) * invDet;
+    Sinv[1][0] = (S[1][2] * S[2][0] - S[1][0] * S[2][2]) * invDet;
+    Sinv[1][1] = (S[0][0] * S[2][2] - S[0][2] * S[2][0]) * invDet;
+    Sinv[1][2] = (S[0][2] * S[1][0] - S[0][0] * S[1][2]) * invDet;
+    Sinv[2][0] = (S[1][0] * S[2][1] - S[1][1] * S[2][0]) * invDet;
+    Sinv[2][1] = (S[0][1] * S[2][0] - S[0][0] * S[2][1]) * invDet;
+    Sinv[2][2] = (S[0][0] * S[1][1] - S[0][1] * S[1][0]) * invDet;
+    
+    // INNOVATION GATE - reject outliers (multipath, RTK fix changes)
+    float normalised = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) normalised += innovation[i] * Sinv[i][j] * innovation[j];
+    }
+    if (normalised > DR_INNOVATION_GATE) {
+        _rejectedCount++;
+        if (++_consecutiveRejects >= DR_MAX_CONSECUTIVE_REJECTS) {
+            // Filter has diverged from GNSS - start again from this fix
+            reset();
+            initializeAt(latitude, longitude, altitude, horizontalSigma, verticalSigma);
+        }
+        return false;
+    }
+    _consecutiveRejects = 0;
+    
+    // K = PHt * S^-1
+    float K[DR_STATE_COUNT][3];
+    for (int i = 0; i < DR_STATE_COUNT; i++) {
+        for (int j = 0; j < 3; j++) {
+            K[i][j] = PHt[i][0] * Sinv[0][j] + PHt[i][1] * Sinv[1][j] + PHt[i][2] * Sinv[2][j];
+        }
+    }
+    
+    // Error estimate, injected into the current nominal state. Over the
+    // latency window the error is effectively constant, so this is exact
+    // to first order.
+    float dx[DR_STATE_COUNT];
+    for (int i = 0; i < DR_STATE_COUNT; i++) {
+        dx[i] = K[i][0] * innovation[0] + K[i][1] * innovation[1] + K[i][2] * innovation[2];
+    }
+    for (int i = 0; i < 3; i++) {
+        _pos[i] += dx[DR_STATE_POS + i];
+        _vel[i] += dx[DR_STATE_VEL + i];
+        _accelBias[i] += dx[DR_STATE_ABIAS + i];
+    }
+    _yawOffset += dx[DR_STATE_YAW];
+    if (_yawOffset > PI) _yawOffset -= TWO_PI;
+    if (_yawOffset < -PI) _yawOffset += TWO_PI;
+    
+    // P = (I - K*H) * P = P - K * PHt^T
+    for (int i = 0; i < DR_STATE_COUNT; i++) {
+        for (int j = 0; j < DR_STATE_COUNT; j++) {
+            _P[i][j] -= K[i][0] * PHt[j][0] + K[i][1] * PHt[j][1] + K[i][2] * PHt[j][2];
+        }
+    }
+    symmetrise();
+    
+    _correctionCount++;
+    return true;
+}
+
+void DeadReckoningFilter::getPosition(double* latitude, double* longitude, double* altitude) {
+    if (latitude) *latitude = _originLat + _pos[0] / _metresPerDegLat;
+    if (longitude) *longitude = _originLon + _pos[1] / _metresPerDegLon;
+    if (altitude) *altitude = _originAlt - _pos[2];
+}
+
+void DeadReckoningFilter::getVelocity(float* north, float* east, float* down) {
+    if (north) *north = _vel[0];
+    if (east) *east = _vel[1];
+    if (down) *down = _vel[2];
+}
+
+void DeadReckoningFilter::initializeAt(double latitude, double longitude, double altitude,
+                                       float horizontalSigma, float verticalSigma) {
+    setOrigin(latitude, longitude, altitude);
+    
+    // Fix is at the antenna - place the IMU one lever arm away
+    float antenna[3];
+    rotateToNed(_leverArm, antenna);
+    for (int i = 0; i < 3; i++) {
+        _pos[i] = -antenna[i];
+        _vel[i] = 0.0f;
+        _accelBias[i] = 0.0f;
+    }
+    _yawOffset = 0.0f;
+    
+    memset(_P, 0, sizeof(_P));
+    _P[DR_STATE_POS + 0][DR_STATE_POS + 0] = horizontalSigma * horizontalSigma;
+    _P[DR_STATE_POS + 1][DR_STATE_POS + 1] = horizontalSigma * horizontalSigma;
+    _P[DR_STATE_POS + 2][DR_STATE_POS + 2] = verticalSigma * verticalSigma;
+    for (int i = 0; i < 3; i++) {
+        _P[DR_STATE_VEL + i][DR_STATE_VEL + i] = DR_INIT_VEL_SIGMA * DR_INIT_VEL_SIGMA;
+        _P[DR_STATE_ABIAS + i][DR_STATE_ABIAS + i] = DR_INIT_ABIAS_SIGMA * DR_INIT_ABIAS_SIGMA;
+    }
+    _P[DR_STATE_YAW][DR_STATE_YAW] = DR_INIT_YAW_SIGMA * DR_INIT_YAW_SIGMA;
+    
+    _historyHead = 0;
+    _historyCount = 0;
+    _consecutiveRejects = 0;
+    _initialized = true;
+}
+
+void DeadReckoningFilter::setOrigin(double latitude, double longitude, double altitude) {
+    _originLat = latitude;
+    _originLon = longitude;
+    _originAlt = altitude;
+    
+    // Local radii of curvature for the flat-earth tangent plane
+    double sinLat = sin(latitude * DEG_TO_RAD);
+    double denom = 1.0 - WGS84_E2 * sinLat * sinLat;
+    double meridian = WGS84_A * (1.0 - WGS84_E2) / (denom * sqrt(denom));
+    double prime = WGS84_A / sqrt(denom);
+    _metresPerDegLat = meridian * DEG_TO_RAD;
+    _metresPerDegLon = prime * cos(latitude * DEG_TO_RAD) * DEG_TO_RAD;
+}
+
+void DeadReckoningFilter::reanchor() {
+    double latitude, longitude, altitude;
+    getPosition(&latitude, &longitude, &altitude);
+    
+    float shift[3] = { _pos[0], _pos[1], _pos[2] };
+    setOrigin(latitude, longitude, altitude);
+    
+    for (int i = 0; i < 3; i++) _pos[i] = 0.0f;
+    for (int n = 0; n < _historyCount; n++) {
+        for (int i = 0; i < 3; i++) _history[n].pos[i] -= shift[i];
+    }
+}
+
+void DeadReckoningFilter::updateRotation(float quatI, float quatJ, float quatK, float quatReal) {
+    // Rotation vector quaternion: body to IMU world frame (ENU)
+    float x = quatI, y = quatJ, z = quatK, w = quatReal;
+    float r[3][3] = {
+        { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z),        2.0f * (x * z + w * y) },
+        { 2.0f * (x * y + w * z),        1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x) },
+        { 2.0f * (x * z - w * y),        2.0f * (y * z + w * x),        1.0f - 2.0f * (x * x + y * y) }
+    };
+    
+    // ENU to NED, then the estimated yaw offset to true north
+    float c = cosf(_yawOffset);
+    float s = sinf(_yawOffset);
+    for (int j = 0; j < 3; j++) {
+        float north = r[1][j];
+        float east = r[0][j];
+        _rotation[0][j] = c * north - s * east;
+        _rotation[1][j] = s * north + c * east;
+        _rotation[2][j] = -r[2][j];
+    }
+}
+
+void DeadReckoningFilter::rotateToNed(const float body[3], float ned[3]) {
+    for (int i = 0; i < 3; i++) {
+        ned[i] = _rotation[i][0] * body[0] + _rotation[i][1] * body[1] + _rotation[i][2] * body[2];
+    }
+}
+
+const DeadReckoningFilter::HistoryEntry* DeadReckoningFilter::findHistory(uint32_t micros) {
+    const HistoryEntry* best = nullptr;
+    uint32_t bestOffset = DR_HISTORY_MAX_OFFSET_US;
+    
+    for (int n = 0; n < _historyCount; n++) {
+        const HistoryEntry& entry = _history[n];
+        uint32_t offset = (uint32_t)abs((int32_t)(entry.micros - micros));
+        if (offset <= bestOffset) {
+            bestOffset = offset;
+            best = &entry;
+        }
+    }
+    return best;
+}
+
+void DeadReckoningFilter::symmetrise() {
+    for (int i = 0; i < DR_STATE_COUNT; i++) {
+        for (int j = i + 1; j < DR_STATE_COUNT; j++) {
+            float average = 0.5f * (_P[i][j] + _P[j][i]);
+            _P[i][j] = average;
+            _P[j][i] = average;
+        }
+    }
+}
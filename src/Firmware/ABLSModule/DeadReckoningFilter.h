@@ -0,0 +1,143 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Dead Reckoning Filter (Wing modules only)
+ *
+ * Float error-state Kalman filter fusing 100Hz BNO080 data with 10Hz
+ * HPPOSLLH so boom tip position is current between GNSS epochs:
+ * - Nominal state: NED position/velocity, accel bias, IMU yaw offset
+ * - Propagated on every IMU sample with gravity-compensated acceleration
+ *   rotated by the BNO080 orientation
+ * - Corrected by GNSS position at the antenna (lever arm applied)
+ * - GNSS latency handled by comparing against the state at the epoch time
+ *
+ * Orientation comes from the BNO080 fusion and is not re-estimated here,
+ * apart from the yaw offset between the IMU frame and true north (the
+ * magnetometer is disabled on the metal boom).
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef DEAD_RECKONING_FILTER_H
+#define DEAD_RECKONING_FILTER_H
+
+#include <Arduino.h>
+
+// Error state layout
+#define DR_STATE_POS        0   // 3: North, East, Down position error (m)
+#define DR_STATE_VEL        3   // 3: North, East, Down velocity error (m/s)
+#define DR_STATE_ABIAS      6   // 3: Body accelerometer bias error (m/s^2)
+#define DR_STATE_YAW        9   // 1: IMU frame yaw offset error (rad)
+#define DR_STATE_COUNT      10
+
+// Process noise (continuous-time spectral densities)
+#define DR_ACCEL_NOISE          0.35f   // m/s^2/sqrt(Hz) - BNO080 linear accel incl. vibration
+#define DR_ABIAS_NOISE          0.002f  // m/s^2/sqrt(s)
+#define DR_YAW_NOISE            0.002f  // rad/sqrt(s) - BNO080 game rotation drift
+
+// Initial uncertainty
+#define DR_INIT_VEL_SIGMA       1.0f    // m/s
+#define DR_INIT_ABIAS_SIGMA     0.2f    // m/s^2
+#define DR_INIT_YAW_SIGMA       3.14f   // rad - heading unknown until moving
+
+// Measurement handling
+#define DR_MIN_POS_SIGMA        0.01f   // Floor on reported GNSS accuracy (m)
+#define DR_MAX_GNSS_SIGMA       1.0f    // Ignore fixes worse than this (m)
+#define DR_INNOVATION_GATE      25.0f   // Chi-square-ish gate on normalised innovation
+#define DR_MAX_CONSECUTIVE_REJECTS 10   // Re-initialise on GNSS after this many gated fixes
+#define DR_HISTORY_MAX_OFFSET_US   20000 // Nearest history entry must be this close
+#define DR_MAX_DT               0.1f    // Longest IMU gap propagated in one step (s)
+#define DR_REANCHOR_DISTANCE    5000.0f // Move the local origin beyond this (m)
+#define DR_MAX_COAST_MS         2000    // Fused output invalid after this long without GNSS
+
+// State history for latency compensation (640ms at 100Hz)
+#define DR_HISTORY_SIZE         64
+
+#ifndef DR_GNSS_DEFAULT_LATENCY_US
+#define DR_GNSS_DEFAULT_LATENCY_US  40000   // HPPOSLLH epoch-to-arrival when time sync is unavailable
+#endif
+
+// Default IMU-to-antenna lever arm in the IMU body frame (m)
+#ifndef DR_LEVER_ARM_X
+#define DR_LEVER_ARM_X          0.0f
+#define DR_LEVER_ARM_Y          0.0f
+#define DR_LEVER_ARM_Z          0.0f
+#endif
+
+class DeadReckoningFilter {
+public:
+    DeadReckoningFilter();
+
+    // Configuration
+    void setLeverArm(float x, float y, float z);
+    void reset();
+
+    // IMU propagation - linear accel (m/s^2, body) and rotation vector quaternion
+    void predict(uint32_t sampleMicros, float accelX, float accelY, float accelZ,
+                 float quatI, float quatJ, float quatK, float quatReal);
+
+    // GNSS position correction at the given epoch time (local micros)
+    bool correct(uint32_t epochMicros, double latitude, double longitude, double altitude,
+                 float horizontalSigma, float verticalSigma);
+
+    // Output
+    bool isInitialized() { return _initialized; }
+    void getPosition(double* latitude, double* longitude, double* altitude);
+    void getVelocity(float* north, float* east, float* down);
+    uint32_t getLastPredictMicros() { return _lastPredictMicros; }
+    float getYawOffset() { return _yawOffset; }
+
+    // Statistics
+    uint32_t getPredictCount() { return _predictCount; }
+    uint32_t getCorrectionCount() { return _correctionCount; }
+    uint32_t getRejectedCount() { return _rejectedCount; }
+
+private:
+    // Nominal state
+    bool _initialized;
+    float _pos[3];              // NED relative to origin (m)
+    float _vel[3];              // NED (m/s)
+    float _accelBias[3];        // Body (m/s^2)
+    float _yawOffset;           // IMU frame to NED (rad)
+
+    // Local tangent-plane origin
+    double _originLat, _originLon, _originAlt;
+    double _metresPerDegLat, _metresPerDegLon;
+
+    // Error covariance
+    float _P[DR_STATE_COUNT][DR_STATE_COUNT];
+
+    // Configuration
+    float _leverArm[3];
+
+    // Latest orientation (IMU body to NED, yaw offset applied)
+    float _rotation[3][3];
+    uint32_t _lastPredictMicros;
+
+    // History for delayed measurements
+    struct HistoryEntry {
+        uint32_t micros;
+        float pos[3];
+        float antennaOffset[3];     // Lever arm rotated into NED at that time
+    };
+    HistoryEntry _history[DR_HISTORY_SIZE];
+    uint8_t _historyHead;
+    uint8_t _historyCount;
+
+    // Statistics
+    uint32_t _predictCount;
+    uint32_t _correctionCount;
+    uint32_t _rejectedCount;
+    uint8_t _consecutiveRejects;
+
+    // Internal methods
+    void initializeAt(double latitude, double longitude, double altitude, float horizontalSigma, float verticalSigma);
+    void setOrigin(double latitude, double longitude, double altitude);
+    void reanchor();
+    void updateRotation(float quatI, float quatJ, float quatK, float quatReal);
+    void rotateToNed(const float body[3], float ned[3]);
+    const HistoryEntry* findHistory(uint32_t micros);
+    void symmetrise();
+};
+
+#endif // DEAD_RECKONING_FILTER_H
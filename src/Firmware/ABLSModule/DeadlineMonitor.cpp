@@ -0,0 +1,112 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Deadline Monitor Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "DeadlineMonitor.h"
+
+DeadlineMonitor::DeadlineMonitor(uint32_t periodMicros) :
+    _periodMicros(periodMicros ? periodMicros : 1),
+    _started(false),
+    _nextMicros(0),
+    _lastRunMicros(0),
+    _count(0),
+    _minPeriod(0),
+    _maxPeriod(0),
+    _totalPeriod(0),
+    _totalJitter(0),
+    _maxJitter(0),
+    _overruns(0),
+    _skipped(0)
+{
+}
+
+void DeadlineMonitor::setPeriod(uint32_t periodMicros) {
+    _periodMicros = periodMicros ? periodMicros : 1;
+    _started = false;
+}
+
+bool DeadlineMonitor::due(uint32_t nowMicros) {
+    if (!_started) {
+        _started = true;
+        _nextMicros = nowMicros + _periodMicros;
+        _lastRunMicros = nowMicros;
+        return true;
+    }
+
+    if ((int32_t)(nowMicros - _nextMicros) < 0) return false;
+
+    // Advance from the deadline, not from now - whole missed periods are
+    // dropped rather than run back-to-back to catch up
+    uint32_t lateness = nowMicros - _nextMicros;
+    uint32_t missed = lateness / _periodMicros;
+    _skipped += missed;
+    _nextMicros += (missed + 1) * _periodMicros;
+
+    recordRun(nowMicros, lateness);
+    return true;
+}
+
+void DeadlineMonitor::observe(uint32_t nowMicros) {
+    if (!_started) {
+        _started = true;
+        _lastRunMicros = nowMicros;
+        return;
+    }
+
+    // No schedule of our own - lateness is how much longer than nominal
+    // this interval was
+    uint32_t interval = nowMicros - _lastRunMicros;
+    uint32_t lateness = (interval > _periodMicros) ? interval - _periodMicros : 0;
+    if (lateness >= _periodMicros) _skipped += lateness / _periodMicros;
+
+    recordRun(nowMicros, lateness);
+}
+
+void DeadlineMonitor::recordRun(uint32_t nowMicros, uint32_t latenessMicros) {
+    uint32_t interval = nowMicros - _lastRunMicros;
+    _lastRunMicros = nowMicros;
+
+    uint32_t jitter = (interval > _periodMicros) ? interval - _periodMicros : _periodMicros - interval;
+
+    if (_count == 0 || interval < _minPeriod) _minPeriod = interval;
+    if (interval > _maxPeriod) _maxPeriod = interval;
+    if (jitter > _maxJitter) _maxJitter = jitter;
+    if (latenessMicros > _periodMicros / 2) _overruns++;
+
+    _count++;
+    _totalPeriod += interval;
+    _totalJitter += jitter;
+}
+
+void DeadlineMonitor::getStats(DeadlineStats* stats) {
+    if (!stats) return;
+
+    noInterrupts();
+    stats->periodMicros = _periodMicros;
+    stats->count = _count;
+    stats->minPeriodMicros = _minPeriod;
+    stats->maxPeriodMicros = _maxPeriod;
+    stats->meanPeriodMicros = _count ? (uint32_t)(_totalPeriod / _count) : 0;
+    stats->meanJitterMicros = _count ? (uint32_t)(_totalJitter / _count) : 0;
+    stats->maxJitterMicros = _maxJitter;
+    stats->overruns = _overruns;
+    stats->skipped = _skipped;
+    interrupts();
+}
+
+void DeadlineMonitor::resetWindow() {
+    noInterrupts();
+    _count = 0;
+    _minPeriod = 0;
+    _maxPeriod = 0;
+    _totalPeriod = 0;
+    _totalJitter = 0;
+    _maxJitter = 0;
+    _overruns = 0;
+    _skipped = 0;
+    interrupts();
+}
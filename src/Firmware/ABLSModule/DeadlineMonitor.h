@@ -0,0 +1,70 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Deadline Monitor
+ *
+ * Measures how well a periodic task keeps its period:
+ * - Drift-free scheduling: each deadline is the previous one plus the
+ *   period, never "now plus the period", so lateness does not accumulate
+ * - Missed slots are counted and skipped, the schedule keeps its phase
+ * - Actual period, jitter and overruns per reporting window
+ * - observe() for tasks timed elsewhere (IntervalTimer, sensor INT)
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <Arduino.h>
+
+struct DeadlineStats {
+    uint32_t periodMicros;      // Nominal
+    uint32_t count;             // Runs in this window
+    uint32_t minPeriodMicros;   // Actual run-to-run interval
+    uint32_t maxPeriodMicros;
+    uint32_t meanPeriodMicros;
+    uint32_t meanJitterMicros;  // Mean |actual - nominal|
+    uint32_t maxJitterMicros;
+    uint32_t overruns;          // Started more than half a period late
+    uint32_t skipped;           // Whole periods missed
+};
+
+class DeadlineMonitor {
+public:
+    explicit DeadlineMonitor(uint32_t periodMicros);
+
+    // Configuration - restarts the schedule on the next due()
+    void setPeriod(uint32_t periodMicros);
+    uint32_t getPeriod() { return _periodMicros; }
+
+    // Scheduled task - true when the next deadline has passed
+    bool due(uint32_t nowMicros);
+
+    // Externally timed task - record one run at nowMicros (ISR safe)
+    void observe(uint32_t nowMicros);
+
+    // Reporting window - reading is safe against observe() in an ISR
+    void getStats(DeadlineStats* stats);
+    void resetWindow();
+
+private:
+    uint32_t _periodMicros;
+    bool _started;
+    uint32_t _nextMicros;       // Next deadline (scheduled mode)
+    uint32_t _lastRunMicros;
+
+    // Window accumulators
+    uint32_t _count;
+    uint32_t _minPeriod;
+    uint32_t _maxPeriod;
+    uint64_t _totalPeriod;
+    uint64_t _totalJitter;
+    uint32_t _maxJitter;
+    uint32_t _overruns;
+    uint32_t _skipped;
+
+    void recordRun(uint32_t nowMicros, uint32_t latenessMicros);
+};
+
+#endif // DEADLINE_MONITOR_H
@@ -0,0 +1,324 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Delta Firmware Patcher Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "DeltaPatcher.h"
+#include "FirmwareHash.h"
+#include "FlashBackupManager.h"
+
+DeltaPatcher::DeltaPatcher() :
+    _state(STATE_HEADER),
+    _result(DELTA_OK),
+    _sourceBank(0),
+    _sourceCapacity(0),
+    _targetCapacity(0),
+    _handler(nullptr),
+    _handlerContext(nullptr),
+    _headerCount(0),
+    _sourceSize(0),
+    _targetSize(0),
+    _varint(0),
+    _varintShift(0),
+    _diffRemaining(0),
+    _extraRemaining(0),
+    _literalRemaining(0),
+    _seek(0),
+    _sourcePos(0),
+    _patchBytes(0),
+    _outputBytes(0),
+    _copiedBytes(0),
+    _recordCount(0)
+{
+    memset(_targetSha256, 0, sizeof(_targetSha256));
+}
+
+bool DeltaPatcher::isDeltaPatch(const uint8_t* data, size_t len) {
+    if (!data || len < 4) return false;
+    uint32_t magic;
+    memcpy(&magic, data, 4);
+    return magic == DELTA_PATCH_MAGIC;
+}
+
+void DeltaPatcher::begin(uint32_t sourceBank, uint32_t sourceCapacity, uint32_t targetCapacity,
+                         DeltaOutputHandler_t handler, void* context) {
+    _sourceBank = sourceBank;
+    _sourceCapacity = sourceCapacity;
+    _targetCapacity = targetCapacity;
+    _handler = handler;
+    _handlerContext = context;
+    reset();
+}
+
+void DeltaPatcher::reset() {
+    _state = STATE_HEADER;
+    _result = DELTA_OK;
+    _headerCount = 0;
+    _sourceSize = 0;
+    _targetSize = 0;
+    memset(_targetSha256, 0, sizeof(_targetSha256));
+    _varint = 0;
+    _varintShift = 0;
+    _diffRemaining = 0;
+    _extraRemaining = 0;
+    _literalRemaining = 0;
+    _seek = 0;
+    _sourcePos = 0;
+    _patchBytes = 0;
+    _outputBytes = 0;
+    _copiedBytes = 0;
+    _recordCount = 0;
+}
+
+DeltaResult_t DeltaPatcher::push(const uint8_t* data, size_t len) {
+    if (_state == STATE_ERROR) return _result;
+    if (!data || len == 0) return DELTA_OK;
+
+    _patchBytes += len;
+    size_t i = 0;
+
+    while (i < len && _state != STATE_DONE && _state != STATE_ERROR) {
+        switch (_state) {
+            case STATE_HEADER: {
+                size_t take = min(len - i, (size_t)(DELTA_PATCH_HEADER_SIZE - _headerCount));
+                memcpy(_header + _headerCount, data + i, take);
+                _headerCount += take;
+                i += take;
+                if (_headerCount == DELTA_PATCH_HEADER_SIZE && parseHeader()) {
+                    _state = STATE_DIFF_LENGTH;
+                }
+                break;
+            }
+
+            case STATE_DIFF_LENGTH:
+                if (readVarint(data[i++])) {
+                    _diffRemaining = _varint;
+                    _state = STATE_EXTRA_LENGTH;
+                }
+                break;
+
+            case STATE_EXTRA_LENGTH:
+                if (readVarint(data[i++])) {
+                    _extraRemaining = _varint;
+                    if ((uint64_t)_outputBytes + _diffRemaining + _extraRemaining > _targetSize) {
+                        fail(DELTA_ERROR_CORRUPT);
+                        break;
+                    }
+                    _state = STATE_SEEK;
+                }
+                break;
+
+            case STATE_SEEK:
+                if (readVarint(data[i++])) {
+                    _seek = (int32_t)((_varint >> 1) ^ (0 - (_varint & 1)));
+                    if ((uint64_t)_sourcePos + _diffRemaining > _sourceSize) {
+                        fail(DELTA_ERROR_CORRUPT);
+                        break;
+                    }
+                    _recordCount++;
+                    if (_diffRemaining > 0) {
+                        _state = STATE_ZERO_RUN;
+                    } else if (_extraRemaining > 0) {
+                        _state = STATE_EXTRA_DATA;
+                    } else {
+                        recordDone();
+                    }
+                }
+                break;
+
+            case STATE_ZERO_RUN:
+                if (readVarint(data[i++])) {
+                    if (_varint > _diffRemaining) {
+                        fail(DELTA_ERROR_CORRUPT);
+                        break;
+                    }
+                    _diffRemaining -= _varint;
+                    if (!copySource(_varint, nullptr)) break;
+                    _state = STATE_LITERAL_RUN;
+                }
+                break;
+
+            case STATE_LITERAL_RUN:
+                if (readVarint(data[i++])) {
+                    if (_varint > _diffRemaining) {
+                        fail(DELTA_ERROR_CORRUPT);
+                        break;
+                    }
+                    _diffRemaining -= _varint;
+                    _literalRemaining = _varint;
+                    if (_literalRemaining > 0) {
+                        _state = STATE_LITERAL_DATA;
+                    } else if (_diffRemaining > 0) {
+                        _state = STATE_ZERO_RUN;
+                    } else if (_extraRemaining > 0) {
+                        _state = STATE_EXTRA_DATA;
+                    } else {
+                        recordDone();
+                    }
+                }
+                break;
+
+            case STATE_LITERAL_DATA: {
+                size_t take = min(len - i, (size_t)_literalRemaining);
+                if (!copySource(take, data + i)) break;
+                i += take;
+                _literalRemaining -= take;
+                if (_literalRemaining == 0) {
+                    if (_diffRemaining > 0) {
+                        _state = STATE_ZERO_RUN;
+                    } else if (_extraRemaining > 0) {
+                        _state = STATE_EXTRA_DATA;
+                    } else {
+                        recordDone();
+                    }
+                }
+                break;
+            }
+
+            case STATE_EXTRA_DATA: {
+                size_t take = min(len - i, (size_t)_extraRemaining);
+                if (!emit(data + i, take)) break;
+                i += take;
+                _extraRemaining -= take;
+                if (_extraRemaining == 0) {
+                    recordDone();
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return (_state == STATE_ERROR) ? _result : DELTA_OK;
+}
+
+bool DeltaPatcher::parseHeader() {
+    uint32_t magic, headerCrc;
+    uint16_t version;
+    uint8_t sourceSha256[32];
+
+    memcpy(&magic, _header, 4);
+    memcpy(&version, _header + 4, 2);
+    memcpy(&_sourceSize, _header + 8, 4);
+    memcpy(sourceSha256, _header + 12, 32);
+    memcpy(&_targetSize, _header + 44, 4);
+    memcpy(_targetSha256, _header + 48, 32);
+    memcpy(&headerCrc, _header + 80, 4);
+
+    if (magic != DELTA_PATCH_MAGIC || version != DELTA_PATCH_VERSION ||
+        FirmwareHash::crc32(_header, 80) != headerCrc) {
+        fail(DELTA_ERROR_HEADER);
+        return false;
+    }
+
+    if (_targetSize == 0 || _targetSize > _targetCapacity) {
+        fail(DELTA_ERROR_TOO_LARGE);
+        return false;
+    }
+
+    // The patch is only meaningful against the exact image it was built from
+    uint8_t actual[32];
+    if (_sourceSize > _sourceCapacity) {
+        fail(DELTA_ERROR_SOURCE_MISMATCH);
+        return false;
+    }
+    FirmwareHash::sha256((const uint8_t*)_sourceBank, _sourceSize, actual);
+    if (memcmp(actual, sourceSha256, 32) != 0) {
+        fail(DELTA_ERROR_SOURCE_MISMATCH);
+        return false;
+    }
+
+    return true;
+}
+
+bool DeltaPatcher::readVarint(uint8_t byte) {
+    if (_varintShift == 0) _varint = 0;
+    _varint |= (uint32_t)(byte & 0x7F) << _varintShift;
+    if (byte & 0x80) {
+        _varintShift += 7;
+        if (_varintShift > 28) {
+            fail(DELTA_ERROR_CORRUPT);
+        }
+        return false;
+    }
+
+    // Complete - _varint holds the value until the next varint starts
+    _varintShift = 0;
+    return true;
+}
+
+bool DeltaPatcher::copySource(uint32_t len, const uint8_t* diff) {
+    uint8_t buffer[DELTA_COPY_BUFFER_SIZE];
+
+    while (len > 0) {
+        uint32_t chunk = min(len, (uint32_t)DELTA_COPY_BUFFER_SIZE);
+        if (FlashBackupManager::readFirmwareFromBank(_sourceBank, buffer, chunk, _sourcePos) != BACKUP_SUCCESS) {
+            fail(DELTA_ERROR_CORRUPT);
+            return false;
+        }
+        if (diff) {
+            for (uint32_t n = 0; n < chunk; n++) {
+                buffer[n] += diff[n];
+            }
+            diff += chunk;
+        } else {
+            _copiedBytes += chunk;
+        }
+        if (!emit(buffer, chunk)) return false;
+
+        _sourcePos += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+bool DeltaPatcher::emit(const uint8_t* data, size_t len) {
+    if (len == 0) return true;
+    if (!_handler || !_handler(data, len, _handlerContext)) {
+        fail(DELTA_ERROR_OUTPUT);
+        return false;
+    }
+    _outputBytes += len;
+    return true;
+}
+
+void DeltaPatcher::recordDone() {
+    int64_t next = (int64_t)_sourcePos + _seek;
+    if (next < 0 || next > (int64_t)_sourceSize) {
+        fail(DELTA_ERROR_CORRUPT);
+        return;
+    }
+    _sourcePos = (uint32_t)next;
+    _state = (_outputBytes == _targetSize) ? STATE_DONE : STATE_DIFF_LENGTH;
+}
+
+DeltaResult_t DeltaPatcher::fail(DeltaResult_t result) {
+    _state = STATE_ERROR;
+    _result = result;
+    return result;
+}
+
+String DeltaPatcher::getStatusString() {
+    String status = "Delta: ";
+    status += resultToString(_result);
+    status += ", patch " + String(_patchBytes) + " bytes -> image " + String(_outputBytes) + "/" + String(_targetSize);
+    status += ", " + String(_recordCount) + " records, " + String(_copiedBytes) + " bytes unchanged";
+    return status;
+}
+
+const char* DeltaPatcher::resultToString(DeltaResult_t result) {
+    switch (result) {
+        case DELTA_OK: return "OK";
+        case DELTA_ERROR_HEADER: return "BAD_HEADER";
+        case DELTA_ERROR_SOURCE_MISMATCH: return "SOURCE_MISMATCH";
+        case DELTA_ERROR_TOO_LARGE: return "TOO_LARGE";
+        case DELTA_ERROR_CORRUPT: return "CORRUPT";
+        case DELTA_ERROR_OUTPUT: return "OUTPUT_FAILED";
+        default: return "UNKNOWN";
+    }
+}
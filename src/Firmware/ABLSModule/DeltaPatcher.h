@@ -0,0 +1,140 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Delta Firmware Patcher
+ *
+ * Rebuilds a new firmware image from a compact binary patch against the
+ * image already in flash, so an update transfers only what changed:
+ * - bsdiff-style records: add-diff against the source, then literal bytes,
+ *   then a source seek - relocated code becomes long runs of zero diff
+ * - Zero runs in the diff are run-length coded (no decompressor needed)
+ * - Streaming: patch bytes may arrive in arbitrary chunks, output is handed
+ *   to a callback in order as it is produced
+ * - Source image is checked against the SHA-256 in the patch header
+ *   before any output is produced
+ *
+ * Patch layout (little-endian):
+ *   Header (84 bytes)
+ *     uint32  magic "RgFD"          uint16 version, uint16 reserved
+ *     uint32  sourceSize            uint8  sourceSha256[32]
+ *     uint32  targetSize            uint8  targetSha256[32]
+ *     uint32  CRC32 of the preceding 80 bytes
+ *   Records, repeated until targetSize bytes are produced
+ *     varint  diffLength            varint extraLength
+ *     varint  zigzag source seek applied after the record
+ *     diff    (varint zeroRun, varint literalRun, literalRun bytes)...
+ *             summing to diffLength; output = source + diff
+ *     extra   extraLength literal bytes
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef DELTA_PATCHER_H
+#define DELTA_PATCHER_H
+
+#include <Arduino.h>
+
+#define DELTA_PATCH_MAGIC           0x44466752  // "RgFD"
+#define DELTA_PATCH_VERSION         1
+#define DELTA_PATCH_HEADER_SIZE     84
+#define DELTA_COPY_BUFFER_SIZE      256         // Source bytes staged per output call
+
+typedef enum {
+    DELTA_OK = 0,
+    DELTA_ERROR_HEADER,             // Bad magic, version or header CRC
+    DELTA_ERROR_SOURCE_MISMATCH,    // Running image is not the patch source
+    DELTA_ERROR_TOO_LARGE,          // Target does not fit the staging area
+    DELTA_ERROR_CORRUPT,            // Record runs outside source or target
+    DELTA_ERROR_OUTPUT              // Output handler refused data
+} DeltaResult_t;
+
+// Receives reconstructed image bytes in order; return false to abort
+typedef bool (*DeltaOutputHandler_t)(const uint8_t* data, size_t len, void* context);
+
+class DeltaPatcher {
+public:
+    DeltaPatcher();
+
+    // Patch detection on the first bytes of a download
+    static bool isDeltaPatch(const uint8_t* data, size_t len);
+
+    // Start a patch against the image at sourceBank
+    void begin(uint32_t sourceBank, uint32_t sourceCapacity, uint32_t targetCapacity,
+               DeltaOutputHandler_t handler, void* context);
+    void reset();
+
+    // Feed patch bytes - output handler runs as image bytes are produced
+    DeltaResult_t push(const uint8_t* data, size_t len);
+
+    // Status
+    bool isComplete() { return _state == STATE_DONE; }
+    DeltaResult_t getResult() { return _result; }
+    uint32_t getSourceSize() { return _sourceSize; }
+    uint32_t getTargetSize() { return _targetSize; }
+    const uint8_t* getTargetSha256() { return _targetSha256; }
+
+    // Statistics
+    uint32_t getPatchBytes() { return _patchBytes; }
+    uint32_t getOutputBytes() { return _outputBytes; }
+    uint32_t getCopiedBytes() { return _copiedBytes; }
+    uint32_t getRecordCount() { return _recordCount; }
+    String getStatusString();
+
+    static const char* resultToString(DeltaResult_t result);
+
+private:
+    enum State {
+        STATE_HEADER,
+        STATE_DIFF_LENGTH,
+        STATE_EXTRA_LENGTH,
+        STATE_SEEK,
+        STATE_ZERO_RUN,
+        STATE_LITERAL_RUN,
+        STATE_LITERAL_DATA,
+        STATE_EXTRA_DATA,
+        STATE_DONE,
+        STATE_ERROR
+    };
+
+    State _state;
+    DeltaResult_t _result;
+
+    // Source and output
+    uint32_t _sourceBank;
+    uint32_t _sourceCapacity;
+    uint32_t _targetCapacity;
+    DeltaOutputHandler_t _handler;
+    void* _handlerContext;
+
+    // Header
+    uint8_t _header[DELTA_PATCH_HEADER_SIZE];
+    uint8_t _headerCount;
+    uint32_t _sourceSize;
+    uint32_t _targetSize;
+    uint8_t _targetSha256[32];
+
+    // Current record
+    uint32_t _varint;
+    uint8_t _varintShift;
+    uint32_t _diffRemaining;
+    uint32_t _extraRemaining;
+    uint32_t _literalRemaining;
+    int32_t _seek;
+    uint32_t _sourcePos;
+
+    // Statistics
+    uint32_t _patchBytes;
+    uint32_t _outputBytes;
+    uint32_t _copiedBytes;
+    uint32_t _recordCount;
+
+    // Internal methods
+    bool parseHeader();
+    bool readVarint(uint8_t byte);
+    bool copySource(uint32_t len, const uint8_t* diff);
+    bool emit(const uint8_t* data, size_t len);
+    void recordDone();
+    DeltaResult_t fail(DeltaResult_t result);
+};
+
+#endif // DELTA_PATCHER_H
@@ -7,16 +7,38 @@
  */
 
 #include "DiagnosticManager.h"
+#include "BinaryLog.h"
+#include "FlightRecorder.h"
+#include "I2CBusGuard.h"
+#include "LoopProfiler.h"
 
 // Static member initialization
-Adafruit_SSD1306 DiagnosticManager::_display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
-File DiagnosticManager::_logFile;
+Adafruit_SSD1306 DiagnosticManager::_display(SCREEN_WIDTH, SCREEN_HEIGHT, &I2CBusGuard::wire(OLED_I2C_BUS), OLED_RESET,
+                                              I2C_BUS_CLOCK_HZ, I2C_BUS_CLOCK_HZ);   // Not dropped to 100kHz after each command
+FsFile DiagnosticManager::_logFile;
+char DiagnosticManager::_logBuffer[LOG_BUFFER_SIZE];
+uint32_t DiagnosticManager::_logHead = 0;
+uint32_t DiagnosticManager::_logTail = 0;
+uint32_t DiagnosticManager::_logDropped = 0;
+uint32_t DiagnosticManager::_logDroppedReported = 0;
+uint32_t DiagnosticManager::_logEntries = 0;
+uint32_t DiagnosticManager::_lastLogFlush = 0;
+uint32_t DiagnosticManager::_lastLogSync = 0;
+bool DiagnosticManager::_logFileOpen = false;
+bool DiagnosticManager::_logDirty = false;
+char DiagnosticManager::_logFileName[32] = "";
+LogLevel_t DiagnosticManager::_logLevel = LOG_DEFAULT_LEVEL;
 bool DiagnosticManager::_initialized = false;
 bool DiagnosticManager::_displayAvailable = false;
 bool DiagnosticManager::_sdCardAvailable = false;
 uint32_t DiagnosticManager::_startTime = 0;
 uint32_t DiagnosticManager::_lastDisplayUpdate = 0;
 DisplayPage_t DiagnosticManager::_currentPage = DISPLAY_STATUS;
+uint8_t DiagnosticManager::_displaySent[SCREEN_WIDTH * OLED_PAGE_COUNT];
+bool DiagnosticManager::_displayDirty = false;
+uint8_t DiagnosticManager::_pushPage = 0;
+uint8_t DiagnosticManager::_pushColumn = 0;
+uint32_t DiagnosticManager::_displayBytesSent = 0;
 uint32_t DiagnosticManager::_pageChangeTime = 0;
 
 // Display content
@@ -35,7 +57,7 @@ bool DiagnosticManager::initialize() {
     Serial.println("Initializing Diagnostic Manager...");
     
     // Initialize I2C for OLED display
-    Wire.begin();
+    I2CBusGuard::beginBus(OLED_I2C_BUS);
     
     // Initialize OLED display
     _displayAvailable = initializeOLED();
@@ -55,6 +77,9 @@ bool DiagnosticManager::initialize() {
         Serial.println("❌ SD Card initialization failed");
     }
     
+    // Binary event log shares the card
+    BinaryLog::initialize();
+    
     _initialized = (_displayAvailable || _sdCardAvailable);
     
     if (_initialized) {
@@ -68,20 +93,107 @@ bool DiagnosticManager::initialize() {
 }
 
 bool DiagnosticManager::initializeOLED() {
-    // SSD1306_SWITCHCAPVCC = generate display voltage from 3.3V internally
-    if (!_display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
-        return false;
+    // SSD1306_SWITCHCAPVCC = generate display voltage from 3.3V internally.
+    // The bus is already started - the library's own Wire.begin() would reset its clock
+    {
+        I2CBusLock busLock(OLED_I2C_BUS, I2C_PRIORITY_DISPLAY);
+        if (!_display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS, true, false)) {
+            return false;
+        }
     }
     
     _display.clearDisplay();
     _display.setTextSize(1);
     _display.setTextColor(SSD1306_WHITE);
     _display.setCursor(0, 0);
-    _display.display();
+    pushDisplayFrame();
     
     return true;
 }
 
+void DiagnosticManager::pushDisplayFrame() {
+    // Page-addressed writes of OLED_I2C_CHUNK_BYTES instead of one 1KB display()
+    // transfer. Control and IMU reads queued against the bus run between writes,
+    // so they wait at most one chunk behind the display rather than a whole frame.
+    const uint8_t* buffer = _display.getBuffer();
+    I2CBusLock busLock(OLED_I2C_BUS, I2C_PRIORITY_DISPLAY);
+    
+    for (uint8_t page = 0; page < OLED_PAGE_COUNT; page++) {
+        addressDisplay(page, 0);
+        
+        // The SSD1306 keeps its address pointer across other devices' transactions
+        const uint8_t* row = buffer + page * SCREEN_WIDTH;
+        for (uint16_t offset = 0; offset < SCREEN_WIDTH; offset += OLED_I2C_CHUNK_BYTES) {
+            I2CBusGuard::yieldTo(OLED_I2C_BUS, I2C_PRIORITY_DISPLAY);
+            writeDisplayData(row + offset, (size_t)min(OLED_I2C_CHUNK_BYTES, SCREEN_WIDTH - offset));
+        }
+    }
+    
+    memcpy(_displaySent, buffer, sizeof(_displaySent));
+    _displayDirty = false;
+}
+
+bool DiagnosticManager::pushDisplayChunk() {
+    // Diff the frame buffer against what the panel holds, resuming where the
+    // last call stopped, and send the next changed run of one page
+    const uint8_t* buffer = _display.getBuffer();
+    
+    while (_pushPage < OLED_PAGE_COUNT) {
+        uint16_t base = _pushPage * SCREEN_WIDTH;
+        uint16_t first = _pushColumn;
+        while (first < SCREEN_WIDTH && buffer[base + first] == _displaySent[base + first]) {
+            first++;
+        }
+        if (first == SCREEN_WIDTH) {
+            _pushPage++;
+            _pushColumn = 0;
+            continue;
+        }
+        
+        // Unchanged columns inside one write cost less than re-addressing past them
+        uint16_t end = min(first + OLED_I2C_CHUNK_BYTES, SCREEN_WIDTH);
+        while (end > first + 1 && buffer[base + end - 1] == _displaySent[base + end - 1]) {
+            end--;
+        }
+        
+        {
+            I2CBusLock busLock(OLED_I2C_BUS, I2C_PRIORITY_DISPLAY);
+            addressDisplay(_pushPage, (uint8_t)first);
+            writeDisplayData(&buffer[base + first], end - first);
+        }
+        memcpy(&_displaySent[base + first], &buffer[base + first], end - first);
+        _pushColumn = (uint8_t)end;
+        return true;
+    }
+    
+    _displayDirty = false;
+    return false;
+}
+
+void DiagnosticManager::addressDisplay(uint8_t page, uint8_t column) {
+    // Caller holds the bus. Window runs to the end of the page so data writes
+    // advance along it.
+    TwoWire& wire = I2CBusGuard::wire(OLED_I2C_BUS);
+    wire.beginTransmission(SCREEN_ADDRESS);
+    wire.write((uint8_t)0x00);     // Command stream
+    wire.write((uint8_t)SSD1306_PAGEADDR);
+    wire.write(page);
+    wire.write(page);
+    wire.write((uint8_t)SSD1306_COLUMNADDR);
+    wire.write(column);
+    wire.write((uint8_t)(SCREEN_WIDTH - 1));
+    wire.endTransmission();
+}
+
+void DiagnosticManager::writeDisplayData(const uint8_t* data, size_t count) {
+    TwoWire& wire = I2CBusGuard::wire(OLED_I2C_BUS);
+    wire.beginTransmission(SCREEN_ADDRESS);
+    wire.write((uint8_t)0x40);     // Data stream
+    wire.write(data, count);
+    wire.endTransmission();
+    _displayBytesSent += count;
+}
+
 bool DiagnosticManager::initializeSDCard() {
     if (!SD.begin(SD_CS_PIN)) {
         return false;
@@ -114,8 +226,7 @@ void DiagnosticManager::showBootScreen() {
     _display.setCursor(0, 56);
     _display.println("v1.0.0");
     
-    _display.display();
-    delay(2000); // Show boot screen for 2 seconds
+    pushDisplayFrame(); // Stays up until the first status page - startup does not wait on it
 }
 
 void DiagnosticManager::showErrorScreen(const String& error) {
@@ -140,16 +251,27 @@ void DiagnosticManager::showErrorScreen(const String& error) {
         y += 8;
     }
     
-    _display.display();
+    pushDisplayFrame();
 }
 
 void DiagnosticManager::updateDisplay() {
     if (!_displayAvailable) return;
     
+    PROFILE_SCOPE(PROBE_DISPLAY_UPDATE);
+    
+    // Finish sending the last frame first - a bounded write or two per loop
+    // rather than a full-frame burst, and only where the frame changed
+    if (_displayDirty) {
+        for (int i = 0; i < OLED_CHUNKS_PER_UPDATE; i++) {
+            if (!pushDisplayChunk()) break;
+        }
+        return;
+    }
+    
     uint32_t now = millis();
     
-    // Update display every 500ms
-    if (now - _lastDisplayUpdate < 500) return;
+    // Redraw every 500ms
+    if (now - _lastDisplayUpdate < OLED_REFRESH_MS) return;
     _lastDisplayUpdate = now;
     
     // Auto-cycle through pages every 5 seconds
@@ -179,7 +301,11 @@ void DiagnosticManager::updateDisplay() {
             break;
     }
     
-    _display.display();
+    // Drawing touches only the frame buffer; the changed columns go out from
+    // the following calls
+    _displayDirty = true;
+    _pushPage = 0;
+    _pushColumn = 0;
 }
 
 void DiagnosticManager::drawStatusPage() {
@@ -285,8 +411,10 @@ void DiagnosticManager::drawSystemPage() {
     _display.println(getFreeMemory());
     
     _display.setCursor(0, 42);
-    _display.print("Log Entries: ");
-    _display.println("0");
+    _display.print("Log: ");
+    _display.print(_logEntries);
+    _display.print(" Drop: ");
+    _display.println(_logDropped);
     
     _display.setCursor(0, 56);
     _display.println("System: Running");
@@ -302,32 +430,167 @@ void DiagnosticManager::setDisplayPage(DisplayPage_t page) {
     _pageChangeTime = millis();
 }
 
-void DiagnosticManager::logMessage(LogLevel_t level, const String& component, const String& message) {
-    if (!_sdCardAvailable) return;
-    
-    // Count errors and warnings
+void DiagnosticManager::countLevel(LogLevel_t level) {
     if (level == LOG_ERROR || level == LOG_CRITICAL) {
         _errorCount++;
     } else if (level == LOG_WARNING) {
         _warningCount++;
     }
+}
+
+void DiagnosticManager::logMessage(LogLevel_t level, const String& component, const String& message) {
+    // Count errors and warnings
+    countLevel(level);
+    
+    if (!_sdCardAvailable || level < _logLevel) return;
+    
+    // Report lines lost to a full ring as soon as there is room again
+    if (_logDropped != _logDroppedReported) {
+        char notice[64];
+        int len = snprintf(notice, sizeof(notice), "[WARN] DiagnosticManager: %lu log lines dropped\n",
+                           (unsigned long)(_logDropped - _logDroppedReported));
+        if (appendLogLine(notice, len)) {
+            _logDroppedReported = _logDropped;
+        }
+    }
+    
+    // Format straight into a stack buffer - no heap, no SD access
+    char line[LOG_LINE_MAX];
+    char timestamp[16];
+    formatTimestamp(timestamp, sizeof(timestamp));
+    int len = snprintf(line, sizeof(line), "%s [%s] %s: %s\n",
+                       timestamp, getLogLevelString(level), component.c_str(), message.c_str());
+    if (len < 0) return;
+    if ((size_t)len >= sizeof(line)) {
+        // Truncated - keep the line terminated
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+    
+    if (appendLogLine(line, len)) {
+        _logEntries++;
+    } else {
+        _logDropped++;
+    }
+}
+
+bool DiagnosticManager::appendLogLine(const char* line, size_t len) {
+    // All-or-nothing so the file never contains half a line
+    if (LOG_BUFFER_SIZE - (_logHead - _logTail) < len) {
+        return false;
+    }
     
-    // Create log file name based on current date
+    for (size_t i = 0; i < len; i++) {
+        _logBuffer[(_logHead + i) & (LOG_BUFFER_SIZE - 1)] = line[i];
+    }
+    _logHead += len;
+    return true;
+}
+
+bool DiagnosticManager::openLogFile() {
     char logFileName[32];
     createLogFileName(logFileName, sizeof(logFileName));
     
-    // Open log file for appending
-    _logFile = SD.open(logFileName, FILE_WRITE);
-    if (_logFile) {
-        _logFile.print(getTimestamp());
-        _logFile.print(" [");
-        _logFile.print(getLogLevelString(level));
-        _logFile.print("] ");
-        _logFile.print(component);
-        _logFile.print(": ");
-        _logFile.println(message);
+    // Same day - keep the current file
+    if (_logFileOpen && strcmp(logFileName, _logFileName) == 0) {
+        return true;
+    }
+    
+    if (_logFileOpen) {
         _logFile.close();
+        _logFileOpen = false;
+    }
+    
+    // Open log file for appending and keep it open
+    if (!_logFile.open(&SD.sdfs, logFileName, O_WRONLY | O_CREAT | O_APPEND)) {
+        return false;
+    }
+    
+    // A fresh file gets contiguous clusters so appends never walk the FAT
+    if (_logFile.fileSize() == 0) {
+        _logFile.preAllocate(LOG_PREALLOCATE_BYTES);
+    }
+    
+    strncpy(_logFileName, logFileName, sizeof(_logFileName) - 1);
+    _logFileName[sizeof(_logFileName) - 1] = '\0';
+    _logFileOpen = true;
+    return true;
+}
+
+size_t DiagnosticManager::writeLogBytes(uint32_t maxBytes, bool alignToBlock) {
+    uint32_t pending = _logHead - _logTail;
+    if (pending == 0) return 0;
+    
+    if (!openLogFile()) return 0;
+    
+    uint32_t toWrite = min(pending, maxBytes);
+    
+    if (alignToBlock) {
+        // End the write on a sector boundary of the file
+        uint32_t position = (uint32_t)_logFile.curPosition();
+        uint32_t firstBlock = LOG_BLOCK_SIZE - (position % LOG_BLOCK_SIZE);
+        if (toWrite < firstBlock) return 0;
+        toWrite = firstBlock + ((toWrite - firstBlock) / LOG_BLOCK_SIZE) * LOG_BLOCK_SIZE;
+    }
+    
+    size_t written = 0;
+    while (written < toWrite) {
+        // Contiguous run up to the end of the ring
+        uint32_t offset = (_logTail + written) & (LOG_BUFFER_SIZE - 1);
+        uint32_t run = min(toWrite - written, (uint32_t)(LOG_BUFFER_SIZE - offset));
+        size_t result = _logFile.write(&_logBuffer[offset], run);
+        if (result != run) {
+            written += result;
+            break;
+        }
+        written += run;
+    }
+    
+    _logTail += written;
+    _logDirty = _logDirty || (written > 0);
+    return written;
+}
+
+void DiagnosticManager::serviceLog() {
+    if (!_sdCardAvailable) return;
+    
+    PROFILE_SCOPE(PROBE_LOG_SERVICE);
+    
+    uint32_t now = millis();
+    
+    // Whole blocks whenever there are any; partial data only once it is stale
+    if (writeLogBytes(LOG_MAX_WRITE_BYTES, true) > 0) {
+        _lastLogFlush = now;
+    } else if (_logHead != _logTail && now - _lastLogFlush >= LOG_FLUSH_INTERVAL_MS) {
+        writeLogBytes(LOG_MAX_WRITE_BYTES, false);
+        _lastLogFlush = now;
+    }
+    
+    // Directory entry update is the expensive part - do it rarely
+    if (_logDirty && now - _lastLogSync >= LOG_SYNC_INTERVAL_MS) {
+        _logFile.sync();
+        _logDirty = false;
+        _lastLogSync = now;
+    }
+    
+    BinaryLog::service();
+}
+
+void DiagnosticManager::flushLog() {
+    if (!_sdCardAvailable) return;
+    
+    while (_logHead != _logTail) {
+        if (writeLogBytes(LOG_BUFFER_SIZE, false) == 0) break;
     }
+    
+    if (_logFileOpen) {
+        _logFile.sync();
+        _logDirty = false;
+        _lastLogSync = millis();
+    }
+    _lastLogFlush = millis();
+    
+    BinaryLog::flush();
 }
 
 void DiagnosticManager::logStartup() {
@@ -350,6 +613,8 @@ void DiagnosticManager::logError(const String& component, const String& error) {
 
 void DiagnosticManager::logCrash(const String& reason) {
     logMessage(LOG_CRITICAL, "System", "CRASH: " + reason);
+    FlightRecorder::stop();
+    flushLog(); // May be the last thing we get to do
 }
 
 uint32_t DiagnosticManager::getFreeMemory() {
@@ -365,7 +630,7 @@ uint32_t DiagnosticManager::getFreeMemory() {
     }
 }
 
-String DiagnosticManager::getLogLevelString(LogLevel_t level) {
+const char* DiagnosticManager::getLogLevelString(LogLevel_t level) {
     switch (level) {
         case LOG_DEBUG:    return "DEBUG";
         case LOG_INFO:     return "INFO";
@@ -376,24 +641,22 @@ String DiagnosticManager::getLogLevelString(LogLevel_t level) {
     }
 }
 
-String DiagnosticManager::getTimestamp() {
+void DiagnosticManager::formatTimestamp(char* buffer, size_t bufferSize) {
     uint32_t ms = millis();
     uint32_t seconds = ms / 1000;
     uint32_t minutes = seconds / 60;
     uint32_t hours = minutes / 60;
     
-    char timestamp[16];
-    snprintf(timestamp, sizeof(timestamp), "%02lu:%02lu:%02lu.%03lu", 
-             hours % 24, minutes % 60, seconds % 60, ms % 1000);
-    
-    return String(timestamp);
+    snprintf(buffer, bufferSize, "%02lu:%02lu:%02lu.%03lu", 
+             (unsigned long)(hours % 24), (unsigned long)(minutes % 60),
+             (unsigned long)(seconds % 60), (unsigned long)(ms % 1000));
 }
 
 void DiagnosticManager::createLogFileName(char* buffer, size_t bufferSize) {
     // For now, use a simple daily log file name
     // In a real implementation, you might use RTC for actual date
     uint32_t days = millis() / (24UL * 60UL * 60UL * 1000UL);
-    snprintf(buffer, bufferSize, "/logs/abls_%03lu.log", days);
+    snprintf(buffer, bufferSize, "/logs/abls_%03lu.log", (unsigned long)days);
 }
 
 void DiagnosticManager::setNetworkStatus(const String& status, const String& ip) {
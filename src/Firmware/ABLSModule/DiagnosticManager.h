@@ -23,6 +23,7 @@
 #include <SD.h>
 #include <SPI.h>
 #include "ModuleConfig.h"
+#include "I2CBusGuard.h"
 
 // OLED Display Configuration
 #define SCREEN_WIDTH    128
@@ -30,9 +31,29 @@
 #define OLED_RESET      -1  // Reset pin (or -1 if sharing Arduino reset pin)
 #define SCREEN_ADDRESS  0x3C // I2C address for 128x64 display
 
+// OLED bus - build with -DOLED_I2C_BUS=I2C_BUS_WIRE1 to take frame pushes
+// off the bus the ram ADC and IMU use
+#ifndef OLED_I2C_BUS
+#define OLED_I2C_BUS    I2C_BUS_WIRE
+#endif
+
+#define OLED_PAGE_COUNT         (SCREEN_HEIGHT / 8)
+#define OLED_I2C_CHUNK_BYTES    32  // Data bytes per write (~0.8ms at 400kHz) - fits the Teensy Wire buffer
+#define OLED_REFRESH_MS         500
+#define OLED_CHUNKS_PER_UPDATE  1   // Changed-column writes sent per updateDisplay() call
+
 // SD Card Configuration
 #define SD_CS_PIN       BUILTIN_SDCARD  // Teensy 4.1 built-in SD card CS pin
 
+// Asynchronous log buffer configuration
+#define LOG_BUFFER_SIZE         16384   // RAM ring for formatted lines (power of two)
+#define LOG_BLOCK_SIZE          512     // SD sector - writes are aligned to this
+#define LOG_MAX_WRITE_BYTES     4096    // Upper bound per serviceLog() call
+#define LOG_FLUSH_INTERVAL_MS   1000    // Write a partial block if data is older than this
+#define LOG_SYNC_INTERVAL_MS    5000    // Commit directory entry this often
+#define LOG_PREALLOCATE_BYTES   (16UL * 1024UL * 1024UL)  // Contiguous clusters for a new log file
+#define LOG_LINE_MAX            256     // Longest single formatted line
+
 // Log levels
 typedef enum {
     LOG_DEBUG = 0,
@@ -42,6 +63,20 @@ typedef enum {
     LOG_CRITICAL = 4
 } LogLevel_t;
 
+#ifndef LOG_DEFAULT_LEVEL
+#define LOG_DEFAULT_LEVEL       LOG_INFO
+#endif
+
+// Level-filtered logging - the message expression (and any String
+// concatenation inside it) is only evaluated if the level is enabled.
+// Hot paths use BLOG() from BinaryLog.h instead, which never builds a String.
+#define DIAG_LOG(level, component, message) \
+    do { \
+        if (DiagnosticManager::isLogEnabled(level)) { \
+            DiagnosticManager::logMessage((level), (component), (message)); \
+        } \
+    } while (0)
+
 // Display pages for cycling through different information
 typedef enum {
     DISPLAY_STATUS = 0,     // Module role, uptime, status
@@ -71,6 +106,19 @@ public:
     static void logError(const String& component, const String& error);
     static void logCrash(const String& reason);
     
+    // Log buffering and filtering
+    static bool isLogEnabled(LogLevel_t level) {
+        // Without a card only warnings and above matter (they are counted)
+        return level >= _logLevel && (_sdCardAvailable || level >= LOG_WARNING);
+    }
+    static void countLevel(LogLevel_t level);
+    static void setLogLevel(LogLevel_t level) { _logLevel = level; }
+    static LogLevel_t getLogLevel() { return _logLevel; }
+    static void serviceLog();   // Idle-time flush of whole blocks (call from loop())
+    static void flushLog();     // Write everything buffered and sync (before halt/reset)
+    static uint32_t getLogDropCount() { return _logDropped; }
+    static uint32_t getLogEntryCount() { return _logEntries; }
+    
     // System Information
     static void updateSystemStats();
     static uint32_t getUptime() { return millis() - _startTime; }
@@ -83,9 +131,25 @@ public:
     static void setSystemStatus(const String& status);
 
 private:
+    friend class Benchmark;     // Times frame rendering
+
     // Hardware objects
     static Adafruit_SSD1306 _display;
-    static File _logFile;
+    static FsFile _logFile;
+    
+    // Asynchronous log ring (foreground only)
+    static char _logBuffer[LOG_BUFFER_SIZE];
+    static uint32_t _logHead;           // Total bytes appended
+    static uint32_t _logTail;           // Total bytes written to SD
+    static uint32_t _logDropped;        // Lines lost because the ring was full
+    static uint32_t _logDroppedReported;
+    static uint32_t _logEntries;
+    static uint32_t _lastLogFlush;
+    static uint32_t _lastLogSync;
+    static bool _logFileOpen;
+    static bool _logDirty;              // Written since last sync
+    static char _logFileName[32];
+    static LogLevel_t _logLevel;
     
     // State tracking
     static bool _initialized;
@@ -94,6 +158,11 @@ private:
     static uint32_t _startTime;
     static uint32_t _lastDisplayUpdate;
     static DisplayPage_t _currentPage;
+    static uint8_t _displaySent[SCREEN_WIDTH * OLED_PAGE_COUNT];   // What the panel is showing
+    static bool _displayDirty;          // Frame drawn but not yet fully sent
+    static uint8_t _pushPage;           // Diff scan position
+    static uint8_t _pushColumn;
+    static uint32_t _displayBytesSent;
     static uint32_t _pageChangeTime;
     
     // Display content
@@ -108,14 +177,21 @@ private:
     
     // Internal methods
     static bool initializeOLED();
+    static void pushDisplayFrame();     // Whole frame now (boot and error screens)
+    static bool pushDisplayChunk();     // Next changed run of the frame; false once the panel matches
+    static void addressDisplay(uint8_t page, uint8_t column);
+    static void writeDisplayData(const uint8_t* data, size_t count);
     static bool initializeSDCard();
     static void drawStatusPage();
     static void drawNetworkPage();
     static void drawSensorsPage();
     static void drawSystemPage();
-    static String getLogLevelString(LogLevel_t level);
-    static String getTimestamp();
+    static const char* getLogLevelString(LogLevel_t level);
+    static void formatTimestamp(char* buffer, size_t bufferSize);
     static void createLogFileName(char* buffer, size_t bufferSize);
+    static bool appendLogLine(const char* line, size_t len);
+    static bool openLogFile();
+    static size_t writeLogBytes(uint32_t maxBytes, bool alignToBlock);
 };
 
 #endif // DIAGNOSTIC_MANAGER_H
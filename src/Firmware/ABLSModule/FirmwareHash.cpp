@@ -0,0 +1,592 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Firmware Hash Service Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "FirmwareHash.h"
+#include "DiagnosticManager.h"
+
+// Static member initialization
+bool FirmwareHash::_initialized = false;
+bool FirmwareHash::_dcpAvailable = false;
+bool FirmwareHash::_dcpSessionActive = false;
+HashBackend_t FirmwareHash::_preferredBackend = HASH_BACKEND_SOFTWARE;
+uint32_t FirmwareHash::_crcTable[8][256];
+uint32_t FirmwareHash::_dcpPacketCount = 0;
+uint32_t FirmwareHash::_dcpErrorCount = 0;
+
+//******************************************************************************
+// DCP registers and work packet (i.MX RT1062 reference manual, chapter 15)
+//******************************************************************************
+
+#if FIRMWARE_HASH_HAVE_DCP
+
+#define DCP_BASE                    0x402FC000
+#define DCP_REG(offset)             (*(volatile uint32_t*)(DCP_BASE + (offset)))
+#define DCP_CTRL                    DCP_REG(0x000)
+#define DCP_STAT_CLR                DCP_REG(0x018)
+#define DCP_CHANNELCTRL             DCP_REG(0x020)
+#define DCP_CONTEXT                 DCP_REG(0x050)
+#define DCP_CH0CMDPTR               DCP_REG(0x100)
+#define DCP_CH0SEMA                 DCP_REG(0x110)
+#define DCP_CH0STAT                 DCP_REG(0x120)
+#define DCP_CH0STAT_CLR             DCP_REG(0x128)
+
+#define DCP_CTRL_SFTRST             (1UL << 31)
+#define DCP_CTRL_CLKGATE            (1UL << 30)
+#define DCP_CTRL_PRESENT_SHA        (1UL << 28)
+#define DCP_CTRL_GATHER_RESIDUAL    (1UL << 23)
+#define DCP_CTRL_CONTEXT_CACHING    (1UL << 22)
+#define DCP_CHANNELCTRL_CH0         (1UL << 0)
+#define DCP_CH0SEMA_VALUE(reg)      (((reg) >> 16) & 0xFF)
+#define DCP_CH0STAT_ERRORS          0x7E
+
+#define DCP_CONTROL0_DECR_SEMAPHORE (1UL << 1)
+#define DCP_CONTROL0_ENABLE_HASH    (1UL << 6)
+#define DCP_CONTROL0_HASH_INIT      (1UL << 12)
+#define DCP_CONTROL0_HASH_TERM      (1UL << 13)
+#define DCP_CONTROL1_HASH_SHA256    (2UL << 16)
+
+struct DcpPacket {
+    uint32_t next;
+    uint32_t control0;
+    uint32_t control1;
+    uint32_t source;
+    uint32_t destination;
+    uint32_t bufferSize;
+    uint32_t payload;
+    uint32_t status;
+};
+
+// The DCP is a bus master that cannot reach the tightly-coupled memories,
+// so everything it touches lives in OCRAM
+DMAMEM static DcpPacket dcpPacket __attribute__((aligned(32)));
+DMAMEM static uint8_t dcpDigest[32] __attribute__((aligned(32)));
+DMAMEM static uint32_t dcpContextBuffer[52] __attribute__((aligned(32)));
+DMAMEM static uint8_t dcpBounce[FIRMWARE_HASH_BOUNCE_SIZE] __attribute__((aligned(32)));
+
+#endif
+
+static const uint8_t SHA256_ABC_DIGEST[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+};
+
+bool FirmwareHash::initialize() {
+    if (_initialized) return true;
+
+    // CRC32 slicing-by-8 tables (8KB, built into RAM for single-cycle access)
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (-(crc & 1)));
+        }
+        _crcTable[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            _crcTable[k][i] = (_crcTable[k - 1][i] >> 8) ^ _crcTable[0][_crcTable[k - 1][i] & 0xFF];
+        }
+    }
+    _initialized = true;
+
+    _dcpAvailable = dcpInitialize() && dcpSelfTest();
+    _preferredBackend = _dcpAvailable ? HASH_BACKEND_DCP : HASH_BACKEND_SOFTWARE;
+
+    DiagnosticManager::logMessage(LOG_INFO, "FirmwareHash", getStatusString());
+    return true;
+}
+
+//******************************************************************************
+// SHA-256
+//******************************************************************************
+
+void FirmwareHash::sha256Begin(Sha256Context* ctx) {
+    if (!_initialized) initialize();
+
+    ctx->datalen = 0;
+    ctx->bitlen = 0;
+    ctx->dcpStarted = false;
+    ctx->failed = false;
+
+    if (_dcpAvailable && _preferredBackend == HASH_BACKEND_DCP && !_dcpSessionActive) {
+        _dcpSessionActive = true;
+        ctx->backend = HASH_BACKEND_DCP;
+    } else {
+        ctx->backend = HASH_BACKEND_SOFTWARE;
+        softwareBegin(ctx);
+    }
+}
+
+void FirmwareHash::sha256Update(Sha256Context* ctx, const uint8_t* data, uint32_t size) {
+    if (ctx->backend == HASH_BACKEND_SOFTWARE) {
+        softwareUpdate(ctx, data, size);
+        return;
+    }
+    if (ctx->failed) return;
+
+    // DCP non-final packets must be whole 64-byte blocks, and the final
+    // (HASH_TERM) packet must not be empty - so always hold back 1..64 bytes
+    while (size > 0) {
+        if (ctx->datalen == 64) {
+            if (!dcpHash(ctx->data, 64, !ctx->dcpStarted, false, nullptr)) {
+                ctx->failed = true;
+                return;
+            }
+            ctx->dcpStarted = true;
+            ctx->datalen = 0;
+        }
+
+        if (ctx->datalen == 0 && size > 64) {
+            uint32_t bulk = (size - 1) & ~63UL;
+            if (!dcpHash(data, bulk, !ctx->dcpStarted, false, nullptr)) {
+                ctx->failed = true;
+                return;
+            }
+            ctx->dcpStarted = true;
+            data += bulk;
+            size -= bulk;
+        }
+
+        uint32_t take = min(64 - ctx->datalen, size);
+        memcpy(ctx->data + ctx->datalen, data, take);
+        ctx->datalen += take;
+        data += take;
+        size -= take;
+    }
+}
+
+void FirmwareHash::sha256Finish(Sha256Context* ctx, uint8_t hash[32]) {
+    if (ctx->backend == HASH_BACKEND_SOFTWARE) {
+        softwareFinish(ctx, hash);
+        return;
+    }
+
+    _dcpSessionActive = false;
+
+    if (!ctx->failed && ctx->datalen == 0 && !ctx->dcpStarted) {
+        // Empty message - nothing for the DCP to terminate
+        softwareBegin(ctx);
+        softwareFinish(ctx, hash);
+        return;
+    }
+
+    if (ctx->failed || !dcpHash(ctx->data, ctx->datalen, !ctx->dcpStarted, true, hash)) {
+        // Running state is lost - return a digest that can never match and
+        // stop using the DCP so the retry runs in software
+        memset(hash, 0, 32);
+        _dcpAvailable = false;
+        DiagnosticManager::logError("FirmwareHash", "DCP hash failed - falling back to software");
+    }
+}
+
+void FirmwareHash::sha256Abort(Sha256Context* ctx) {
+    if (ctx->backend == HASH_BACKEND_DCP) {
+        _dcpSessionActive = false;
+    }
+    ctx->backend = HASH_BACKEND_SOFTWARE;
+    softwareBegin(ctx);
+}
+
+void FirmwareHash::sha256(const uint8_t* data, uint32_t size, uint8_t hash[32]) {
+    Sha256Context ctx;
+    sha256Begin(&ctx);
+    sha256Update(&ctx, data, size);
+    sha256Finish(&ctx, hash);
+}
+
+//******************************************************************************
+// CRC32 - slicing-by-8
+//******************************************************************************
+
+uint32_t FirmwareHash::crc32Update(uint32_t crc, const uint8_t* data, uint32_t size) {
+    if (!_initialized) initialize();
+
+    while (size >= 8) {
+        uint32_t one, two;
+        memcpy(&one, data, 4);
+        memcpy(&two, data + 4, 4);
+        one ^= crc;
+        crc = _crcTable[7][one & 0xFF] ^ _crcTable[6][(one >> 8) & 0xFF] ^
+              _crcTable[5][(one >> 16) & 0xFF] ^ _crcTable[4][one >> 24] ^
+              _crcTable[3][two & 0xFF] ^ _crcTable[2][(two >> 8) & 0xFF] ^
+              _crcTable[1][(two >> 16) & 0xFF] ^ _crcTable[0][two >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size--) {
+        crc = (crc >> 8) ^ _crcTable[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+uint32_t FirmwareHash::crc32(const uint8_t* data, uint32_t size) {
+    return ~crc32Update(FIRMWARE_HASH_CRC32_INIT, data, size);
+}
+
+uint32_t FirmwareHash::crc32Bitwise(const uint8_t* data, uint32_t size) {
+    uint32_t crc = FIRMWARE_HASH_CRC32_INIT;
+    for (uint32_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (-(crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+//******************************************************************************
+// Benchmark
+//******************************************************************************
+
+static String benchmarkResult(const char* name, uint32_t size, uint32_t elapsedMicros) {
+    uint32_t kbPerSecond = elapsedMicros > 0 ? (uint32_t)((uint64_t)size * 1000000ULL / elapsedMicros / 1024) : 0;
+    return String(name) + ": " + String(elapsedMicros) + "us (" + String(kbPerSecond) + " KB/s)";
+}
+
+bool FirmwareHash::runBenchmark(uint32_t address, uint32_t size) {
+    if (!_initialized) initialize();
+
+    const uint8_t* data = (const uint8_t*)(uintptr_t)address;
+    bool consistent = true;
+
+    DiagnosticManager::logMessage(LOG_INFO, "FirmwareHash",
+        "Benchmark over " + String(size) + " bytes at 0x" + String(address, HEX));
+
+    // SHA-256 software
+    Sha256Context ctx;
+    uint8_t softwareDigest[32];
+    uint32_t start = micros();
+    softwareBegin(&ctx);
+    softwareUpdate(&ctx, data, size);
+    softwareFinish(&ctx, softwareDigest);
+    DiagnosticManager::logMessage(LOG_INFO, "FirmwareHash", benchmarkResult("SHA256 software", size, micros() - start));
+
+    // SHA-256 DCP
+    if (_dcpAvailable && !_dcpSessionActive) {
+        uint8_t dcpResult[32];
+        HashBackend_t preferred = _preferredBackend;
+        _preferredBackend = HASH_BACKEND_DCP;
+        start = micros();
+        sha256(data, size, dcpResult);
+        uint32_t elapsed = micros() - start;
+        _preferredBackend = preferred;
+
+        DiagnosticManager::logMessage(LOG_INFO, "FirmwareHash", benchmarkResult("SHA256 DCP", size, elapsed));
+        if (memcmp(dcpResult, softwareDigest, 32) != 0) {
+            DiagnosticManager::logError("FirmwareHash", "SHA256 DCP result differs from software");
+            consistent = false;
+        }
+    } else {
+        DiagnosticManager::logMessage(LOG_INFO, "FirmwareHash", "SHA256 DCP: unavailable");
+    }
+
+    // CRC32 bitwise reference vs slicing-by-8
+    start = micros();
+    uint32_t bitwiseCrc = crc32Bitwise(data, size);
+    DiagnosticManager::logMessage(LOG_INFO, "FirmwareHash", benchmarkResult("CRC32 bitwise", size, micros() - start));
+
+    start = micros();
+    uint32_t slicedCrc = crc32(data, size);
+    DiagnosticManager::logMessage(LOG_INFO, "FirmwareHash", benchmarkResult("CRC32 slicing-by-8", size, micros() - start));
+
+    if (slicedCrc != bitwiseCrc) {
+        DiagnosticManager::logError("FirmwareHash", "CRC32 slicing-by-8 result differs from bitwise");
+        consistent = false;
+    }
+
+    return consistent;
+}
+
+String FirmwareHash::getStatusString() {
+    String status = "SHA256: ";
+    status += (_dcpAvailable && _preferredBackend == HASH_BACKEND_DCP) ? "DCP" : "software";
+    status += ", CRC32: slicing-by-8";
+    if (_dcpPacketCount > 0 || _dcpErrorCount > 0) {
+        status += ", DCP packets: " + String(_dcpPacketCount) + " (" + String(_dcpErrorCount) + " errors)";
+    }
+    return status;
+}
+
+//******************************************************************************
+// DCP backend
+//******************************************************************************
+
+bool FirmwareHash::dcpInitialize() {
+#if FIRMWARE_HASH_HAVE_DCP
+    CCM_CCGR0 |= CCM_CCGR0_DCP(CCM_CCGR_ON);
+
+    // Reset, then release reset and clock gate
+    DCP_CTRL = DCP_CTRL_SFTRST | DCP_CTRL_CLKGATE | DCP_CTRL_GATHER_RESIDUAL;
+    DCP_CTRL = DCP_CTRL_GATHER_RESIDUAL;
+
+    if (!(DCP_CTRL & DCP_CTRL_PRESENT_SHA)) {
+        return false;
+    }
+
+    DCP_STAT_CLR = 0xFFFFFFFF;
+    DCP_CH0STAT_CLR = 0xFFFFFFFF;
+
+    // Single channel, no context switching - the running hash stays cached
+    // in the DCP between packets of one session
+    DCP_CTRL = DCP_CTRL_GATHER_RESIDUAL | DCP_CTRL_CONTEXT_CACHING;
+    DCP_CHANNELCTRL = DCP_CHANNELCTRL_CH0;
+    DCP_CONTEXT = (uint32_t)dcpContextBuffer;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool FirmwareHash::dcpSelfTest() {
+#if FIRMWARE_HASH_HAVE_DCP
+    // Confirms register access and digest byte order before trusting the DCP
+    const uint8_t* message = (const uint8_t*)"abc";
+    uint8_t digest[32];
+
+    if (!dcpHash(message, 3, true, true, digest)) {
+        return false;
+    }
+    return memcmp(digest, SHA256_ABC_DIGEST, 32) == 0;
+#else
+    return false;
+#endif
+}
+
+bool FirmwareHash::isDcpAddressable(const void* data, uint32_t size) {
+    uint32_t start = (uint32_t)(uintptr_t)data;
+    uint32_t end = start + size;
+
+    // OCRAM (RAM2 / DMAMEM), FlexSPI flash and PSRAM - TCM is not reachable
+    if (start >= 0x20200000 && end <= 0x20280000) return true;
+    if (start >= 0x60000000 && end <= 0x80000000) return true;
+    return false;
+}
+
+bool FirmwareHash::dcpHash(const uint8_t* data, uint32_t size, bool init, bool term, uint8_t* digest) {
+    if (isDcpAddressable(data, size)) {
+        return dcpSubmit(data, size, init, term, digest);
+    }
+
+#if FIRMWARE_HASH_HAVE_DCP
+    // TCM source - stage through OCRAM, keeping non-final chunks block-sized
+    do {
+        uint32_t chunk = min(size, (uint32_t)FIRMWARE_HASH_BOUNCE_SIZE);
+        bool last = (chunk == size);
+        memcpy(dcpBounce, data, chunk);
+        if (!dcpSubmit(dcpBounce, chunk, init, term && last, last ? digest : nullptr)) {
+            return false;
+        }
+        init = false;
+        data += chunk;
+        size -= chunk;
+    } while (size > 0);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool FirmwareHash::dcpSubmit(const uint8_t* data, uint32_t size, bool init, bool term, uint8_t* digest) {
+#if FIRMWARE_HASH_HAVE_DCP
+    // Write back cached RAM sources - flash is not written behind the cache
+    if ((uint32_t)data < 0x60000000 || (uint32_t)data >= 0x70000000) {
+        arm_dcache_flush((void*)data, size);
+    }
+
+    dcpPacket.next = 0;
+    dcpPacket.control0 = DCP_CONTROL0_DECR_SEMAPHORE | DCP_CONTROL0_ENABLE_HASH |
+                         (init ? DCP_CONTROL0_HASH_INIT : 0) | (term ? DCP_CONTROL0_HASH_TERM : 0);
+    dcpPacket.control1 = DCP_CONTROL1_HASH_SHA256;
+    dcpPacket.source = (uint32_t)data;
+    dcpPacket.destination = 0;
+    dcpPacket.bufferSize = size;
+    dcpPacket.payload = term ? (uint32_t)dcpDigest : 0;
+    dcpPacket.status = 0;
+    arm_dcache_flush(&dcpPacket, sizeof(dcpPacket));
+    if (term) {
+        arm_dcache_flush_delete(dcpDigest, sizeof(dcpDigest));
+    }
+
+    DCP_CH0STAT_CLR = 0xFFFFFFFF;
+    DCP_CH0CMDPTR = (uint32_t)&dcpPacket;
+    DCP_CH0SEMA = 1;
+    _dcpPacketCount++;
+
+    uint32_t start = micros();
+    while (DCP_CH0SEMA_VALUE(DCP_CH0SEMA) != 0) {
+        if (micros() - start > FIRMWARE_HASH_DCP_TIMEOUT_US) {
+            _dcpErrorCount++;
+            return false;
+        }
+    }
+
+    if (DCP_CH0STAT & DCP_CH0STAT_ERRORS) {
+        DCP_CH0STAT_CLR = 0xFFFFFFFF;
+        _dcpErrorCount++;
+        return false;
+    }
+
+    if (term && digest) {
+        // DCP writes the SHA-256 digest byte-reversed
+        arm_dcache_delete(dcpDigest, sizeof(dcpDigest));
+        for (int i = 0; i < 32; i++) {
+            digest[i] = dcpDigest[31 - i];
+        }
+    }
+    return true;
+#else
+    (void)data; (void)size; (void)init; (void)term; (void)digest;
+    return false;
+#endif
+}
+
+//******************************************************************************
+// SHA256 Implementation - Lightweight version for Teensy 4.1
+//******************************************************************************
+
+// SHA256 constants
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// SHA256 helper functions
+#define SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define SHA256_CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define SHA256_MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define SHA256_EP0(x) (SHA256_ROTR(x, 2) ^ SHA256_ROTR(x, 13) ^ SHA256_ROTR(x, 22))
+#define SHA256_EP1(x) (SHA256_ROTR(x, 6) ^ SHA256_ROTR(x, 11) ^ SHA256_ROTR(x, 25))
+#define SHA256_SIG0(x) (SHA256_ROTR(x, 7) ^ SHA256_ROTR(x, 18) ^ ((x) >> 3))
+#define SHA256_SIG1(x) (SHA256_ROTR(x, 17) ^ SHA256_ROTR(x, 19) ^ ((x) >> 10))
+
+void FirmwareHash::softwareBegin(Sha256Context* ctx) {
+    ctx->datalen = 0;
+    ctx->bitlen = 0;
+    ctx->state[0] = 0x6a09e667;
+    ctx->state[1] = 0xbb67ae85;
+    ctx->state[2] = 0x3c6ef372;
+    ctx->state[3] = 0xa54ff53a;
+    ctx->state[4] = 0x510e527f;
+    ctx->state[5] = 0x9b05688c;
+    ctx->state[6] = 0x1f83d9ab;
+    ctx->state[7] = 0x5be0cd19;
+}
+
+void FirmwareHash::softwareTransform(Sha256Context* ctx, const uint8_t data[64]) {
+    uint32_t a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
+
+    for (i = 0, j = 0; i < 16; ++i, j += 4)
+        m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
+    for (; i < 64; ++i)
+        m[i] = SHA256_SIG1(m[i - 2]) + m[i - 7] + SHA256_SIG0(m[i - 15]) + m[i - 16];
+
+    a = ctx->state[0];
+    b = ctx->state[1];
+    c = ctx->state[2];
+    d = ctx->state[3];
+    e = ctx->state[4];
+    f = ctx->state[5];
+    g = ctx->state[6];
+    h = ctx->state[7];
+
+    for (i = 0; i < 64; ++i) {
+        t1 = h + SHA256_EP1(e) + SHA256_CH(e, f, g) + sha256_k[i] + m[i];
+        t2 = SHA256_EP0(a) + SHA256_MAJ(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+    ctx->state[5] += f;
+    ctx->state[6] += g;
+    ctx->state[7] += h;
+}
+
+void FirmwareHash::softwareUpdate(Sha256Context* ctx, const uint8_t* data, uint32_t size) {
+    // Whole blocks straight from the source, partial blocks via the buffer
+    while (size > 0) {
+        if (ctx->datalen == 0 && size >= 64) {
+            softwareTransform(ctx, data);
+            ctx->bitlen += 512;
+            data += 64;
+            size -= 64;
+            continue;
+        }
+
+        uint32_t take = min(64 - ctx->datalen, size);
+        memcpy(ctx->data + ctx->datalen, data, take);
+        ctx->datalen += take;
+        data += take;
+        size -= take;
+
+        if (ctx->datalen == 64) {
+            softwareTransform(ctx, ctx->data);
+            ctx->bitlen += 512;
+            ctx->datalen = 0;
+        }
+    }
+}
+
+void FirmwareHash::softwareFinish(Sha256Context* ctx, uint8_t hash[32]) {
+    uint32_t i;
+
+    i = ctx->datalen;
+
+    // Pad whatever data is left in the buffer.
+    if (ctx->datalen < 56) {
+        ctx->data[i++] = 0x80;
+        while (i < 56)
+            ctx->data[i++] = 0x00;
+    } else {
+        ctx->data[i++] = 0x80;
+        while (i < 64)
+            ctx->data[i++] = 0x00;
+        softwareTransform(ctx, ctx->data);
+        memset(ctx->data, 0, 56);
+    }
+
+    // Append to the padding the total message's length in bits and transform.
+    ctx->bitlen += ctx->datalen * 8;
+    ctx->data[63] = ctx->bitlen;
+    ctx->data[62] = ctx->bitlen >> 8;
+    ctx->data[61] = ctx->bitlen >> 16;
+    ctx->data[60] = ctx->bitlen >> 24;
+    ctx->data[59] = ctx->bitlen >> 32;
+    ctx->data[58] = ctx->bitlen >> 40;
+    ctx->data[57] = ctx->bitlen >> 48;
+    ctx->data[56] = ctx->bitlen >> 56;
+    softwareTransform(ctx, ctx->data);
+
+    // Since this implementation uses little endian byte ordering and SHA uses big endian,
+    // reverse all the bytes when copying the final state to the output hash.
+    for (i = 0; i < 4; ++i) {
+        hash[i] = (ctx->state[0] >> (24 - i * 8)) & 0x000000ff;
+        hash[i + 4] = (ctx->state[1] >> (24 - i * 8)) & 0x000000ff;
+        hash[i + 8] = (ctx->state[2] >> (24 - i * 8)) & 0x000000ff;
+        hash[i + 12] = (ctx->state[3] >> (24 - i * 8)) & 0x000000ff;
+        hash[i + 16] = (ctx->state[4] >> (24 - i * 8)) & 0x000000ff;
+        hash[i + 20] = (ctx->state[5] >> (24 - i * 8)) & 0x000000ff;
+        hash[i + 24] = (ctx->state[6] >> (24 - i * 8)) & 0x000000ff;
+        hash[i + 28] = (ctx->state[7] >> (24 - i * 8)) & 0x000000ff;
+    }
+}
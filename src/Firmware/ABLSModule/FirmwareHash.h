@@ -0,0 +1,112 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Firmware Hash Service
+ *
+ * One interface for the SHA-256 and CRC32 checks used by firmware update,
+ * verification and backup:
+ * - SHA-256 on the i.MX RT1062 DCP (Data Co-Processor) when available,
+ *   with the portable software implementation as fallback
+ * - CRC32 (IEEE 802.3, reflected - as stored in backups and sent by the
+ *   Toughbook) using a slicing-by-8 table, 8 bytes per step
+ * - Benchmark comparing the backends on a region of flash
+ *
+ * The DCP keeps the running SHA-256 state in its channel 0 context, so only
+ * one incremental DCP session can be open at a time; a second concurrent
+ * sha256Begin() transparently uses the software backend. The DCP's own
+ * CRC32 mode is the non-reflected CRC-32/MPEG-2 variant, which does not
+ * match existing checksums, so CRC32 always runs in software.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef FIRMWARE_HASH_H
+#define FIRMWARE_HASH_H
+
+#include <Arduino.h>
+
+#if defined(__IMXRT1062__) && !defined(FIRMWARE_HASH_DISABLE_DCP)
+#define FIRMWARE_HASH_HAVE_DCP      1
+#else
+#define FIRMWARE_HASH_HAVE_DCP      0
+#endif
+
+#define FIRMWARE_HASH_CRC32_INIT    0xFFFFFFFF
+#define FIRMWARE_HASH_DCP_TIMEOUT_US 100000     // Per DCP work packet
+#define FIRMWARE_HASH_BOUNCE_SIZE   4096        // OCRAM staging for TCM sources
+
+#ifndef FIRMWARE_HASH_BENCHMARK_SIZE
+#define FIRMWARE_HASH_BENCHMARK_SIZE (256 * 1024)
+#endif
+
+typedef enum {
+    HASH_BACKEND_SOFTWARE = 0,
+    HASH_BACKEND_DCP
+} HashBackend_t;
+
+// Incremental SHA-256 state - software state, or the DCP tail buffer
+struct Sha256Context {
+    uint32_t state[8];
+    uint64_t bitlen;
+    uint32_t datalen;
+    uint8_t data[64];
+    HashBackend_t backend;
+    bool dcpStarted;            // First DCP packet (HASH_INIT) issued
+    bool failed;                // DCP error mid-session - digest is invalid
+};
+
+class FirmwareHash {
+public:
+    // Initialization - builds CRC tables, enables and self-tests the DCP
+    static bool initialize();
+    static bool isDcpAvailable() { return _dcpAvailable; }
+    static void setPreferredBackend(HashBackend_t backend) { _preferredBackend = backend; }
+    static HashBackend_t getPreferredBackend() { return _preferredBackend; }
+
+    // SHA-256
+    static void sha256Begin(Sha256Context* ctx);
+    static void sha256Update(Sha256Context* ctx, const uint8_t* data, uint32_t size);
+    static void sha256Finish(Sha256Context* ctx, uint8_t hash[32]);
+    static void sha256Abort(Sha256Context* ctx);    // Release an unfinished session
+    static void sha256(const uint8_t* data, uint32_t size, uint8_t hash[32]);
+
+    // CRC32 - crc32Update() is raw: start with FIRMWARE_HASH_CRC32_INIT and
+    // invert the final value (crc32() does both)
+    static uint32_t crc32Update(uint32_t crc, const uint8_t* data, uint32_t size);
+    static uint32_t crc32(const uint8_t* data, uint32_t size);
+
+    // Backend comparison over [address, address+size) - logs results
+    static bool runBenchmark(uint32_t address = 0x60000000, uint32_t size = FIRMWARE_HASH_BENCHMARK_SIZE);
+
+    // Diagnostics
+    static uint32_t getDcpPacketCount() { return _dcpPacketCount; }
+    static uint32_t getDcpErrorCount() { return _dcpErrorCount; }
+    static String getStatusString();
+
+private:
+    static bool _initialized;
+    static bool _dcpAvailable;
+    static bool _dcpSessionActive;
+    static HashBackend_t _preferredBackend;
+    static uint32_t _crcTable[8][256];
+    static uint32_t _dcpPacketCount;
+    static uint32_t _dcpErrorCount;
+
+    // Software SHA-256
+    static void softwareBegin(Sha256Context* ctx);
+    static void softwareUpdate(Sha256Context* ctx, const uint8_t* data, uint32_t size);
+    static void softwareFinish(Sha256Context* ctx, uint8_t hash[32]);
+    static void softwareTransform(Sha256Context* ctx, const uint8_t data[64]);
+
+    // DCP SHA-256
+    static bool dcpInitialize();
+    static bool dcpSelfTest();
+    static bool dcpHash(const uint8_t* data, uint32_t size, bool init, bool term, uint8_t* digest);
+    static bool dcpSubmit(const uint8_t* data, uint32_t size, bool init, bool term, uint8_t* digest);
+    static bool isDcpAddressable(const void* data, uint32_t size);
+
+    // Reference bitwise CRC32 for the benchmark
+    static uint32_t crc32Bitwise(const uint8_t* data, uint32_t size);
+};
+
+#endif // FIRMWARE_HASH_H
@@ -0,0 +1,464 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Multicast Firmware Receiver Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "FirmwareMulticastReceiver.h"
+#include "RgFModuleUpdater.h"
+#include "UpdateSafetyManager.h"
+#include "VersionManager.h"
+
+FirmwareMulticastReceiver::FirmwareMulticastReceiver() :
+    _state(FW_MCAST_STATE_IDLE),
+    _role(SENDER_UNKNOWN),
+    _sessionId(0),
+    _imageSize(0),
+    _blockSize(0),
+    _blockCount(0),
+    _fecGroupSize(0),
+    _groupCount(0),
+    _parityBase(0),
+    _received(nullptr),
+    _parityHeld(nullptr),
+    _recoverBuffer(nullptr),
+    _receivedCount(0),
+    _recoveredCount(0),
+    _lastPacketMillis(0),
+    _reportPending(false),
+    _lastError(""),
+    _duplicateBlocks(0),
+    _rejectedPackets(0)
+{
+}
+
+void FirmwareMulticastReceiver::handleDatagram(const uint8_t* data, size_t len) {
+    if (!data || len < sizeof(FirmwareMulticastHeader)) {
+        _rejectedPackets++;
+        return;
+    }
+
+    const FirmwareMulticastHeader* header = (const FirmwareMulticastHeader*)data;
+    if (header->Magic != FIRMWARE_MCAST_MAGIC || header->Version != FIRMWARE_MCAST_VERSION) {
+        _rejectedPackets++;
+        return;
+    }
+
+    if (header->Type == FW_MCAST_ANNOUNCE) {
+        if (len < sizeof(FirmwareMulticastAnnounce)) {
+            _rejectedPackets++;
+            return;
+        }
+        handleAnnounce((const FirmwareMulticastAnnounce*)data);
+        return;
+    }
+
+    // Everything else belongs to the session this module joined
+    if (_state == FW_MCAST_STATE_IDLE || header->SessionId != _sessionId) {
+        return;
+    }
+    _lastPacketMillis = millis();
+
+    switch (header->Type) {
+        case FW_MCAST_DATA:
+            handleBlock((const FirmwareMulticastBlock*)data, len);
+            break;
+
+        case FW_MCAST_PARITY:
+            handleParity((const FirmwareMulticastBlock*)data, len);
+            break;
+
+        case FW_MCAST_QUERY:
+            _reportPending = true;
+            break;
+
+        case FW_MCAST_ABORT:
+            abort("Session aborted by Toughbook");
+            break;
+
+        default:
+            _rejectedPackets++;
+            break;
+    }
+}
+
+void FirmwareMulticastReceiver::handleAnnounce(const FirmwareMulticastAnnounce* announce) {
+    if (announce->RoleMask != FIRMWARE_MCAST_ROLE_ALL &&
+        (_role >= 8 || !(announce->RoleMask & (1 << _role)))) {
+        return;
+    }
+
+    // Repeated announce - the Toughbook re-announces until every module answers
+    if (announce->Header.SessionId == _sessionId && _state != FW_MCAST_STATE_IDLE) {
+        _lastPacketMillis = millis();
+        _reportPending = true;
+        return;
+    }
+
+    if (isActive()) {
+        logEvent("Ignoring session 0x" + String(announce->Header.SessionId, HEX) + " - session 0x" +
+                 String(_sessionId, HEX) + " in progress", LOG_WARNING);
+        return;
+    }
+
+    uint32_t blocks = (announce->BlockSize > 0) ?
+                      (announce->ImageSize + announce->BlockSize - 1) / announce->BlockSize : 0;
+    if (announce->ImageSize == 0 || announce->BlockSize == 0 ||
+        announce->BlockSize > FIRMWARE_MCAST_MAX_BLOCK_SIZE ||
+        announce->FecGroupSize > FIRMWARE_MCAST_MAX_FEC_GROUP ||
+        blocks != announce->BlockCount || blocks > FIRMWARE_MCAST_MAX_BLOCKS) {
+        _rejectedPackets++;
+        logEvent("Invalid session announce: " + String(announce->ImageSize) + " bytes, " +
+                 String(announce->BlockCount) + " x " + String(announce->BlockSize), LOG_WARNING);
+        return;
+    }
+
+    // New session
+    _sessionId = announce->Header.SessionId;
+    _imageSize = announce->ImageSize;
+    _blockSize = announce->BlockSize;
+    _blockCount = announce->BlockCount;
+    _fecGroupSize = announce->FecGroupSize;
+    _groupCount = (_fecGroupSize > 0) ? (_blockCount + _fecGroupSize - 1) / _fecGroupSize : 0;
+    _parityBase = (_imageSize + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+    _receivedCount = 0;
+    _recoveredCount = 0;
+    _duplicateBlocks = 0;
+    _lastPacketMillis = millis();
+    _lastError = "";
+
+    logEvent("Session 0x" + String(_sessionId, HEX) + " announced: v" + String(announce->VersionMajor) + "." +
+             String(announce->VersionMinor) + "." + String(announce->VersionPatch) + ", " + String(_imageSize) +
+             " bytes in " + String(_blockCount) + " blocks, FEC 1/" + String(_fecGroupSize));
+
+    // Same gate as a unicast START_UPDATE
+    UpdateStatus_t updateStatus = VersionManager::getUpdateStatus();
+    if (updateStatus != UPDATE_IDLE && updateStatus != UPDATE_SUCCESS && updateStatus != UPDATE_FAILED) {
+        _lastError = "Another update is in progress";
+        setState(FW_MCAST_STATE_DECLINED);
+        return;
+    }
+
+    SafetyCheckResult_t safetyResult = UpdateSafetyManager::isSafeToUpdate();
+    if (safetyResult != SAFETY_OK) {
+        _lastError = String("Not safe to update - ") + safetyResultToString(safetyResult);
+        setState(FW_MCAST_STATE_DECLINED);
+        return;
+    }
+
+    if (!acquireWorkspace()) {
+        fail(String("Update arena busy (") + UpdateArena::useToString(UpdateArena::getOwner()) + ")");
+        return;
+    }
+
+    uint32_t stagingSize = _parityBase + (uint32_t)_groupCount * _blockSize;
+    stagingSize = (stagingSize + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+    if (!RgFModuleUpdater::beginStagedDownload(_imageSize, stagingSize, announce->ImageSha256)) {
+        fail(RgFModuleUpdater::getStatusMessage());
+        return;
+    }
+
+    setState(FW_MCAST_STATE_PREPARING);
+}
+
+void FirmwareMulticastReceiver::handleBlock(const FirmwareMulticastBlock* block, size_t len) {
+    // Blocks sent while still erasing are picked up in the repair pass
+    if (_state != FW_MCAST_STATE_RECEIVING) {
+        return;
+    }
+
+    uint16_t index = block->Index;
+    if (index >= _blockCount || block->Length != blockLength(index) ||
+        len < offsetof(FirmwareMulticastBlock, Data) + block->Length) {
+        _rejectedPackets++;
+        return;
+    }
+
+    if (testBit(_received, index)) {
+        _duplicateBlocks++;
+        return;
+    }
+
+    if (!RgFModuleUpdater::writeStagedBlock((uint32_t)index * _blockSize, block->Data, block->Length)) {
+        fail(RgFModuleUpdater::getStatusMessage());
+        return;
+    }
+    setBit(_received, index);
+    _receivedCount++;
+
+    // Parity already held for this group may now rebuild its last gap
+    if (_fecGroupSize > 0) {
+        uint16_t group = index / _fecGroupSize;
+        if (testBit(_parityHeld, group)) {
+            uint32_t parityAddress = RgFModuleUpdater::getBufferAddress() + _parityBase + (uint32_t)group * _blockSize;
+            if (!recoverGroup(group, (const uint8_t*)parityAddress)) return;
+        }
+    }
+
+    if (_receivedCount == _blockCount) {
+        setState(FW_MCAST_STATE_COMPLETE);
+    }
+}
+
+void FirmwareMulticastReceiver::handleParity(const FirmwareMulticastBlock* block, size_t len) {
+    if (_state != FW_MCAST_STATE_RECEIVING || _fecGroupSize == 0) {
+        return;
+    }
+
+    uint16_t group = block->Index;
+    if (group >= _groupCount || block->Length != _blockSize ||
+        len < offsetof(FirmwareMulticastBlock, Data) + block->Length) {
+        _rejectedPackets++;
+        return;
+    }
+
+    if (testBit(_parityHeld, group)) {
+        _duplicateBlocks++;
+        return;
+    }
+
+    uint16_t missingBlock;
+    uint16_t missing = countMissing(group, &missingBlock);
+    if (missing == 0) {
+        return;
+    }
+
+    if (missing == 1) {
+        // Rebuild straight from the datagram - parity never reaches flash
+        if (!recoverGroup(group, block->Data)) return;
+    } else {
+        // Keep it until all but one of the group's blocks have arrived
+        uint32_t offset = _parityBase + (uint32_t)group * _blockSize;
+        if (!RgFModuleUpdater::writeStagedBlock(offset, block->Data, _blockSize)) {
+            fail(RgFModuleUpdater::getStatusMessage());
+            return;
+        }
+        setBit(_parityHeld, group);
+    }
+
+    if (_receivedCount == _blockCount) {
+        setState(FW_MCAST_STATE_COMPLETE);
+    }
+}
+
+bool FirmwareMulticastReceiver::recoverGroup(uint16_t group, const uint8_t* parity) {
+    uint16_t missingBlock;
+    if (countMissing(group, &missingBlock) != 1) {
+        return true;
+    }
+
+    // Lost block = parity XOR every other block of the group (short last block zero padded)
+    memcpy(_recoverBuffer, parity, _blockSize);
+    const uint8_t* staging = (const uint8_t*)RgFModuleUpdater::getBufferAddress();
+    uint16_t first = group * _fecGroupSize;
+    uint16_t last = min((uint32_t)first + _fecGroupSize, (uint32_t)_blockCount);
+
+    for (uint16_t index = first; index < last; index++) {
+        if (index == missingBlock) continue;
+        const uint8_t* source = staging + (uint32_t)index * _blockSize;
+        uint16_t length = blockLength(index);
+        for (uint16_t n = 0; n < length; n++) {
+            _recoverBuffer[n] ^= source[n];
+        }
+    }
+
+    if (!RgFModuleUpdater::writeStagedBlock((uint32_t)missingBlock * _blockSize, _recoverBuffer, blockLength(missingBlock))) {
+        fail(RgFModuleUpdater::getStatusMessage());
+        return false;
+    }
+    setBit(_received, missingBlock);
+    _receivedCount++;
+    _recoveredCount++;
+    return true;
+}
+
+uint16_t FirmwareMulticastReceiver::countMissing(uint16_t group, uint16_t* missingBlock) {
+    uint16_t first = group * _fecGroupSize;
+    uint16_t last = min((uint32_t)first + _fecGroupSize, (uint32_t)_blockCount);
+    uint16_t missing = 0;
+
+    for (uint16_t index = first; index < last; index++) {
+        if (!testBit(_received, index)) {
+            *missingBlock = index;
+            missing++;
+        }
+    }
+    return missing;
+}
+
+uint16_t FirmwareMulticastReceiver::blockLength(uint16_t block) {
+    uint32_t offset = (uint32_t)block * _blockSize;
+    return (uint16_t)min((uint32_t)_blockSize, _imageSize - offset);
+}
+
+void FirmwareMulticastReceiver::update() {
+    switch (_state) {
+        case FW_MCAST_STATE_PREPARING:
+            if (!RgFModuleUpdater::eraseStagedSectors(FIRMWARE_MCAST_ERASE_PER_UPDATE)) {
+                fail(RgFModuleUpdater::getStatusMessage());
+                return;
+            }
+            if (RgFModuleUpdater::isStagingErased()) {
+                logEvent("Staging area erased - ready for blocks");
+                setState(FW_MCAST_STATE_RECEIVING);
+            }
+            break;
+
+        case FW_MCAST_STATE_COMPLETE:
+            // Install once the COMPLETE report is out - this blocks while flashing
+            if (!_reportPending) {
+                logEvent("All blocks received (" + String(_recoveredCount) + " rebuilt from parity) - installing");
+                releaseWorkspace();     // Backup and flash copy lease the arena next
+                if (RgFModuleUpdater::completeStagedDownload()) {
+                    setState(FW_MCAST_STATE_INSTALLED);
+                } else {
+                    fail(RgFModuleUpdater::getStatusMessage());
+                }
+            }
+            return;
+
+        default:
+            return;
+    }
+
+    if (millis() - _lastPacketMillis > FIRMWARE_MCAST_SESSION_TIMEOUT_MS) {
+        abort("Session timed out");
+    }
+}
+
+size_t FirmwareMulticastReceiver::takeReport(FirmwareMulticastReport* report) {
+    if (!_reportPending || !report) {
+        return 0;
+    }
+    _reportPending = false;
+
+    report->Header.Magic = FIRMWARE_MCAST_MAGIC;
+    report->Header.Version = FIRMWARE_MCAST_VERSION;
+    report->Header.Type = FW_MCAST_REPORT;
+    report->Header.SessionId = _sessionId;
+    report->SenderId = _role;
+    report->State = (uint8_t)_state;
+    report->BlocksReceived = _receivedCount;
+    report->BlocksRecovered = _recoveredCount;
+    report->MissingCount = 0;
+    report->RangeCount = 0;
+
+    // Missing blocks as ranges, lowest first - later ranges follow the next query
+    if (_state == FW_MCAST_STATE_RECEIVING || _state == FW_MCAST_STATE_PREPARING) {
+        uint16_t index = 0;
+        while (index < _blockCount) {
+            if (testBit(_received, index)) {
+                index++;
+                continue;
+            }
+            uint16_t first = index;
+            while (index < _blockCount && !testBit(_received, index)) index++;
+
+            report->MissingCount += index - first;
+            if (report->RangeCount < FIRMWARE_MCAST_MAX_RANGES) {
+                report->Ranges[report->RangeCount].First = first;
+                report->Ranges[report->RangeCount].Count = index - first;
+                report->RangeCount++;
+            }
+        }
+    }
+
+    return offsetof(FirmwareMulticastReport, Ranges) + report->RangeCount * sizeof(FirmwareBlockRange);
+}
+
+void FirmwareMulticastReceiver::abort(const String& reason) {
+    if (isActive()) {
+        fail(reason);
+    }
+}
+
+bool FirmwareMulticastReceiver::isActive() {
+    return _state == FW_MCAST_STATE_PREPARING ||
+           _state == FW_MCAST_STATE_RECEIVING ||
+           _state == FW_MCAST_STATE_COMPLETE;
+}
+
+uint8_t FirmwareMulticastReceiver::getProgress() {
+    switch (_state) {
+        case FW_MCAST_STATE_RECEIVING:
+            return (_blockCount > 0) ? (uint8_t)(80UL * _receivedCount / _blockCount) : 0;
+        case FW_MCAST_STATE_COMPLETE:
+            return 80;
+        case FW_MCAST_STATE_INSTALLED:
+            return 100;
+        default:
+            return 0;
+    }
+}
+
+String FirmwareMulticastReceiver::getStageString() {
+    switch (_state) {
+        case FW_MCAST_STATE_PREPARING:
+            return "Multicast: preparing staging area";
+        case FW_MCAST_STATE_RECEIVING:
+            return "Multicast: " + String(_receivedCount) + "/" + String(_blockCount) + " blocks, " +
+                   String(_recoveredCount) + " rebuilt";
+        case FW_MCAST_STATE_COMPLETE:
+            return "Multicast: installing";
+        case FW_MCAST_STATE_INSTALLED:
+            return "Multicast: installed - reboot required";
+        case FW_MCAST_STATE_FAILED:
+            return "Multicast: failed";
+        case FW_MCAST_STATE_DECLINED:
+            return "Multicast: declined";
+        default:
+            return "Multicast: idle";
+    }
+}
+
+String FirmwareMulticastReceiver::getStatusString() {
+    String status = getStageString();
+    if (_state != FW_MCAST_STATE_IDLE) {
+        status += ", session 0x" + String(_sessionId, HEX);
+        status += ", " + String(_duplicateBlocks) + " duplicates, " + String(_rejectedPackets) + " rejected";
+    }
+    if (_lastError.length() > 0) {
+        status += ", last error: " + _lastError;
+    }
+    return status;
+}
+
+bool FirmwareMulticastReceiver::acquireWorkspace() {
+    Workspace* workspace = (Workspace*)UpdateArena::acquire(UPDATE_ARENA_MULTICAST, sizeof(Workspace));
+    if (!workspace) {
+        return false;
+    }
+    memset(workspace->received, 0, sizeof(workspace->received));
+    memset(workspace->parityHeld, 0, sizeof(workspace->parityHeld));
+    _received = workspace->received;
+    _parityHeld = workspace->parityHeld;
+    _recoverBuffer = workspace->recover;
+    return true;
+}
+
+void FirmwareMulticastReceiver::releaseWorkspace() {
+    _received = nullptr;
+    _parityHeld = nullptr;
+    _recoverBuffer = nullptr;
+    UpdateArena::release(UPDATE_ARENA_MULTICAST);
+}
+
+void FirmwareMulticastReceiver::setState(FirmwareMulticastState_t state) {
+    _state = state;
+    _reportPending = true;
+}
+
+void FirmwareMulticastReceiver::fail(const String& reason) {
+    // Releases the staging buffer if the download is still open
+    RgFModuleUpdater::abortStagedDownload();
+    releaseWorkspace();
+    _lastError = reason;
+    setState(FW_MCAST_STATE_FAILED);
+    logEvent("Session 0x" + String(_sessionId, HEX) + " failed: " + reason, LOG_ERROR);
+}
+
+void FirmwareMulticastReceiver::logEvent(const String& event, LogLevel_t level) {
+    DiagnosticManager::logMessage(level, "FirmwareMulticast", event);
+}
@@ -0,0 +1,122 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Multicast Firmware Receiver
+ *
+ * Module side of the multicast firmware distribution (see DataPackets.h):
+ * - Joins a session from its ANNOUNCE when the role mask includes this module
+ * - Erases the staging area a few sectors per update() so the main loop keeps
+ *   running, then reports ready
+ * - Programs blocks straight into the RgFModuleUpdater staging area as they
+ *   arrive, in any order; duplicates are ignored
+ * - Rebuilds a single lost block per FEC group from its XOR parity block,
+ *   reading the group's other blocks back from memory-mapped flash
+ * - Reports missing blocks as ranges on request, then validates and flashes
+ *   the image once every block is held
+ *
+ * Staging layout: image blocks from offset 0, parity blocks (kept only for
+ * groups still missing two or more blocks) from the next sector boundary.
+ * The block bitmaps and rebuild buffer are leased from the UpdateArena for
+ * the session and handed back before the install needs it.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef FIRMWARE_MULTICAST_RECEIVER_H
+#define FIRMWARE_MULTICAST_RECEIVER_H
+
+#include <Arduino.h>
+#include "DataPackets.h"
+#include "DiagnosticManager.h"
+#include "UpdateArena.h"
+
+#define FIRMWARE_MCAST_MAX_BLOCKS           4096    // 4MB of 1KB blocks
+#define FIRMWARE_MCAST_ERASE_PER_UPDATE     2       // Staging sectors erased per update()
+#define FIRMWARE_MCAST_SESSION_TIMEOUT_MS   30000   // Abandon a session silent this long
+
+class FirmwareMulticastReceiver {
+public:
+    FirmwareMulticastReceiver();
+
+    // Configuration - role selects sessions by RoleMask and is the report SenderId
+    void setRole(uint8_t role) { _role = role; }
+
+    // Feed one datagram received on the firmware multicast group
+    void handleDatagram(const uint8_t* data, size_t len);
+
+    // Staging erase, timeouts and install - call every loop
+    void update();
+
+    // Report due for the Toughbook - returns bytes to send, 0 when none is due
+    size_t takeReport(FirmwareMulticastReport* report);
+
+    // Abandon the current session (ABORT_UPDATE or FW_MCAST_ABORT)
+    void abort(const String& reason);
+
+    // Status
+    bool isActive();    // Between announce and install, failure or abort
+    FirmwareMulticastState_t getState() { return _state; }
+    uint32_t getSessionId() { return _sessionId; }
+    uint8_t getProgress();
+    String getStageString();
+    String getLastError() { return _lastError; }
+
+    // Statistics
+    uint16_t getBlocksReceived() { return _receivedCount; }
+    uint16_t getBlocksRecovered() { return _recoveredCount; }
+    uint32_t getDuplicateBlocks() { return _duplicateBlocks; }
+    uint32_t getRejectedPackets() { return _rejectedPackets; }
+    String getStatusString();
+
+private:
+    FirmwareMulticastState_t _state;
+    uint8_t _role;
+
+    // Session parameters (from the announce)
+    uint32_t _sessionId;
+    uint32_t _imageSize;
+    uint16_t _blockSize;
+    uint16_t _blockCount;
+    uint8_t _fecGroupSize;
+    uint16_t _groupCount;
+    uint32_t _parityBase;           // Staging offset of parity block 0
+
+    // Session workspace, leased from the UpdateArena announce to complete
+    struct Workspace {
+        uint8_t received[FIRMWARE_MCAST_MAX_BLOCKS / 8];
+        uint8_t parityHeld[FIRMWARE_MCAST_MAX_BLOCKS / 8];
+        uint8_t recover[FIRMWARE_MCAST_MAX_BLOCK_SIZE];     // Parity reconstruction
+    };
+    static_assert(sizeof(Workspace) <= UPDATE_ARENA_SIZE, "Multicast workspace does not fit the update arena");
+
+    // Reception state - bitmaps valid while PREPARING or RECEIVING
+    uint8_t* _received;
+    uint8_t* _parityHeld;
+    uint8_t* _recoverBuffer;
+    uint16_t _receivedCount;
+    uint16_t _recoveredCount;
+    uint32_t _lastPacketMillis;
+    bool _reportPending;
+    String _lastError;
+
+    // Statistics
+    uint32_t _duplicateBlocks;
+    uint32_t _rejectedPackets;
+
+    // Internal methods
+    void handleAnnounce(const FirmwareMulticastAnnounce* announce);
+    void handleBlock(const FirmwareMulticastBlock* block, size_t len);
+    void handleParity(const FirmwareMulticastBlock* block, size_t len);
+    bool recoverGroup(uint16_t group, const uint8_t* parity);
+    uint16_t countMissing(uint16_t group, uint16_t* missingBlock);
+    uint16_t blockLength(uint16_t block);
+    bool testBit(const uint8_t* bitmap, uint16_t index) { return bitmap[index >> 3] & (1 << (index & 7)); }
+    void setBit(uint8_t* bitmap, uint16_t index) { bitmap[index >> 3] |= (1 << (index & 7)); }
+    bool acquireWorkspace();
+    void releaseWorkspace();
+    void setState(FirmwareMulticastState_t state);
+    void fail(const String& reason);
+    void logEvent(const String& event, LogLevel_t level = LOG_INFO);
+};
+
+#endif // FIRMWARE_MULTICAST_RECEIVER_H
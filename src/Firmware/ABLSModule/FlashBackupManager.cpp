@@ -1,5 +1,7 @@
 #include "FlashBackupManager.h"
 #include "FlashTxx.h"
+#include "FirmwareHash.h"
+#include "UpdateArena.h"
 
 // =================================================================
 // ABLS (Automatic Boom Level System)
@@ -22,6 +24,11 @@ BackupStatus FlashBackupManager::_backupStatus = {};
 bool FlashBackupManager::_backupStatusValid = false;
 uint32_t FlashBackupManager::_lastStatusUpdate = 0;
 
+// Backup takes the sector copy buffer and the manifest working copy from
+// the update arena, one after the other
+static_assert(sizeof(BackupManifest) <= BACKUP_MANIFEST_SIZE, "Backup manifest must fit its flash sector");
+static_assert(FLASH_SECTOR_SIZE + sizeof(BackupManifest) <= UPDATE_ARENA_SIZE, "Backup does not fit the update arena");
+
 void FlashBackupManager::init() {
     if (_initialized) {
         return;
@@ -69,81 +76,145 @@ BackupResult_t FlashBackupManager::backupCurrentFirmware() {
         return safetyResult;
     }
     
-    // Get current firmware version and size
+    // Get current firmware version and the real image length
     FirmwareVersion_t currentVersion = VersionManager::getCurrentVersion();
-    uint32_t firmwareSize = FIRMWARE_MAX_SIZE; // For now, backup entire bank
-    
-    reportProgress(10);
+    uint32_t firmwareSize = getImageSize(CURRENT_FIRMWARE_BASE);
+    if (firmwareSize == 0 || firmwareSize > BACKUP_MAX_IMAGE_SIZE) {
+        setLastError(BACKUP_ERROR_INVALID_SIZE, "Running image size unknown or too large: " + String(firmwareSize));
+        return BACKUP_ERROR_INVALID_SIZE;
+    }
     
-    // Erase backup bank
-    DiagnosticManager::logMessage(LOG_INFO, "FlashBackupManager", "Erasing backup bank");
-    BackupResult_t eraseResult = eraseFirmwareBank(BACKUP_FIRMWARE_BASE, firmwareSize);
-    if (eraseResult != BACKUP_SUCCESS) {
-        setLastError(eraseResult, "Failed to erase backup bank");
-        return eraseResult;
+    // Working memory for this backup only
+    uint8_t* arena = UpdateArena::acquire(UPDATE_ARENA_BACKUP, FLASH_SECTOR_SIZE + sizeof(BackupManifest));
+    if (!arena) {
+        setLastError(BACKUP_ERROR_FLASH_BUSY, "Update arena busy (" + String(UpdateArena::useToString(UpdateArena::getOwner())) + ")");
+        return BACKUP_ERROR_FLASH_BUSY;
     }
     
-    reportProgress(30);
+    BackupResult_t result = copyToBackupBank(firmwareSize, currentVersion, arena, (BackupManifest*)(arena + FLASH_SECTOR_SIZE));
+    UpdateArena::release(UPDATE_ARENA_BACKUP);
+    return result;
+}
+
+BackupResult_t FlashBackupManager::copyToBackupBank(uint32_t firmwareSize, const FirmwareVersion_t& currentVersion,
+                                                    uint8_t* sectorBuffer, BackupManifest* manifest) {
+    uint32_t sectorCount = calculateSectorsNeeded(firmwareSize);
     
-    // Copy current firmware to backup bank in chunks
-    const uint32_t CHUNK_SIZE = 4096; // 4KB chunks
-    uint8_t* buffer = (uint8_t*)malloc(CHUNK_SIZE);
-    if (!buffer) {
-        setLastError(BACKUP_ERROR_UNKNOWN, "Failed to allocate copy buffer");
-        return BACKUP_ERROR_UNKNOWN;
+    reportProgress(10);
+    
+    // The previous manifest says what the backup bank already holds; its
+    // sector table is overwritten in place as the new image is walked
+    const BackupManifest* previous = findManifest();
+    bool previousValid = (previous != nullptr);
+    if (previousValid) {
+        memcpy(manifest, previous, sizeof(BackupManifest));
+    } else {
+        memset(manifest, 0, sizeof(BackupManifest));
     }
+    uint32_t previousSectors = previousValid ? manifest->sectorCount : 0;
+    uint32_t previousSize = previousValid ? manifest->imageSize : 0;
     
-    uint32_t totalCopied = 0;
+    DiagnosticManager::logMessage(LOG_INFO, "FlashBackupManager", "Backing up " + String(firmwareSize) + " bytes (" +
+                                String(sectorCount) + " sectors), previous backup " +
+                                (previousValid ? String(previousSize) + " bytes" : String("none")));
+    
+    uint32_t imageChecksum = FIRMWARE_HASH_CRC32_INIT;
+    uint16_t sectorsWritten = 0;
+    uint16_t sectorsSkipped = 0;
+    bool manifestErased = false;
     BackupResult_t copyResult = BACKUP_SUCCESS;
     
-    while (totalCopied < firmwareSize && copyResult == BACKUP_SUCCESS) {
-        uint32_t chunkSize = min(CHUNK_SIZE, firmwareSize - totalCopied);
+    for (uint32_t sector = 0; sector < sectorCount && copyResult == BACKUP_SUCCESS; sector++) {
+        uint32_t offset = sector * FLASH_SECTOR_SIZE;
+        uint32_t length = min((uint32_t)FLASH_SECTOR_SIZE, firmwareSize - offset);
+        const uint8_t* source = (const uint8_t*)(CURRENT_FIRMWARE_BASE + offset);
         
-        // Read chunk from current bank
-        copyResult = readFirmwareFromBank(CURRENT_FIRMWARE_BASE, buffer, chunkSize, totalCopied);
-        if (copyResult != BACKUP_SUCCESS) {
-            break;
-        }
+        uint32_t sectorChecksum = FirmwareHash::crc32(source, length);
+        imageChecksum = FirmwareHash::crc32Update(imageChecksum, source, length);
         
-        // Write chunk to backup bank
-        copyResult = writeFirmwareToBank(BACKUP_FIRMWARE_BASE, buffer, chunkSize, totalCopied);
-        if (copyResult != BACKUP_SUCCESS) {
-            break;
+        // Skip sectors the backup already holds with the same length and CRC
+        bool sameLength = (sector < previousSectors) &&
+                          (min((uint32_t)FLASH_SECTOR_SIZE, previousSize - offset) == length);
+        if (sameLength && manifest->sectorChecksum[sector] == sectorChecksum) {
+            sectorsSkipped++;
+        } else {
+            // Invalidate the old manifest before the bank stops matching it
+            if (!manifestErased) {
+                copyResult = eraseFirmwareBank(BACKUP_MANIFEST_ADDRESS, BACKUP_MANIFEST_SIZE);
+                if (copyResult != BACKUP_SUCCESS) {
+                    break;
+                }
+                manifestErased = true;
+            }
+            
+            copyResult = readFirmwareFromBank(CURRENT_FIRMWARE_BASE, sectorBuffer, length, offset);
+            if (copyResult == BACKUP_SUCCESS) {
+                copyResult = eraseFirmwareBank(BACKUP_FIRMWARE_BASE + offset, FLASH_SECTOR_SIZE);
+            }
+            if (copyResult == BACKUP_SUCCESS) {
+                copyResult = writeFirmwareToBank(BACKUP_FIRMWARE_BASE, sectorBuffer, length, offset);
+            }
+            
+            // Read back only what was written - skipped sectors are covered by the manifest
+            if (copyResult == BACKUP_SUCCESS && _verificationEnabled &&
+                calculateFirmwareChecksum(BACKUP_FIRMWARE_BASE + offset, length) != sectorChecksum) {
+                copyResult = BACKUP_ERROR_VERIFY_FAILED;
+            }
+            sectorsWritten++;
         }
         
-        totalCopied += chunkSize;
+        manifest->sectorChecksum[sector] = sectorChecksum;
         
-        // Update progress (30% to 80% for copy operation)
-        uint8_t progress = 30 + (50 * totalCopied / firmwareSize);
+        // Update progress (10% to 90% for copy operation)
+        uint8_t progress = 10 + (80 * (sector + 1) / sectorCount);
         reportProgress(progress);
     }
     
-    free(buffer);
+    _backupStatus.sectorsWritten = sectorsWritten;
+    _backupStatus.sectorsSkipped = sectorsSkipped;
     
     if (copyResult != BACKUP_SUCCESS) {
-        setLastError(copyResult, "Failed to copy firmware to backup bank");
+        // Old manifest is already erased, so the bank reads as no backup
+        _backupStatus.hasValidBackup = false;
+        setLastError(copyResult, "Failed to copy firmware to backup bank at sector " + String(sectorsWritten + sectorsSkipped));
         return copyResult;
     }
     
-    reportProgress(85);
-    
-    // Verify backup if verification is enabled
-    if (_verificationEnabled) {
-        DiagnosticManager::logMessage(LOG_INFO, "FlashBackupManager", "Verifying backup integrity");
-        BackupResult_t verifyResult = verifyBackupIntegrity();
-        if (verifyResult != BACKUP_SUCCESS) {
-            setLastError(verifyResult, "Backup verification failed");
-            return verifyResult;
+    imageChecksum = ~imageChecksum;
+    
+    // Record the new image - unchanged image and manifest need no flash write
+    bool manifestChanged = manifestErased || !previousValid || previousSize != firmwareSize ||
+                           manifest->imageChecksum != imageChecksum;
+    manifest->sectorCount = sectorCount;
+    manifest->imageSize = firmwareSize;
+    manifest->imageChecksum = imageChecksum;
+    manifest->firmwareVersion = currentVersion;
+    
+    if (manifestChanged) {
+        if (!manifestErased) {
+            BackupResult_t eraseResult = eraseFirmwareBank(BACKUP_MANIFEST_ADDRESS, BACKUP_MANIFEST_SIZE);
+            if (eraseResult != BACKUP_SUCCESS) {
+                _backupStatus.hasValidBackup = false;
+                setLastError(eraseResult, "Failed to erase backup manifest");
+                return eraseResult;
+            }
+        }
+        
+        BackupResult_t manifestResult = writeManifest(manifest);
+        if (manifestResult != BACKUP_SUCCESS) {
+            _backupStatus.hasValidBackup = false;
+            setLastError(manifestResult, "Failed to write backup manifest");
+            return manifestResult;
         }
     }
     
     reportProgress(95);
     
-    // Update backup status
+    // Update backup status - checksum was accumulated from the source during the walk
     _backupStatus.hasValidBackup = true;
     _backupStatus.backupVersion = currentVersion;
-    _backupStatus.backupSize = totalCopied;
-    _backupStatus.backupChecksum = calculateFirmwareChecksum(BACKUP_FIRMWARE_BASE, totalCopied);
+    _backupStatus.backupSize = firmwareSize;
+    _backupStatus.backupChecksum = imageChecksum;
     _backupStatus.backupTimestamp = millis();
     _backupStatus.lastOperation = BACKUP_SUCCESS;
     _backupStatus.lastError = "";
@@ -154,7 +225,8 @@ BackupResult_t FlashBackupManager::backupCurrentFirmware() {
     DiagnosticManager::logMessage(LOG_INFO, "FlashBackupManager", "Backup completed successfully");
     DiagnosticManager::logMessage(LOG_INFO, "FlashBackupManager", "Backup version: " + 
                                 VersionManager::getVersionString(currentVersion));
-    DiagnosticManager::logMessage(LOG_INFO, "FlashBackupManager", "Backup size: " + String(totalCopied) + " bytes");
+    DiagnosticManager::logMessage(LOG_INFO, "FlashBackupManager", "Backup size: " + String(firmwareSize) + " bytes, " +
+                                String(sectorsWritten) + " sectors written, " + String(sectorsSkipped) + " unchanged");
     
     logBackupEvent("BACKUP_COMPLETED_SUCCESS");
     return BACKUP_SUCCESS;
@@ -194,10 +266,19 @@ BackupResult_t FlashBackupManager::restoreFromBackup() {
     
     uint32_t firmwareSize = _backupStatus.backupSize;
     
+    // Copy buffer from the update arena - taken before anything is erased
+    const uint32_t CHUNK_SIZE = FLASH_SECTOR_SIZE;
+    uint8_t* buffer = UpdateArena::acquire(UPDATE_ARENA_RESTORE, CHUNK_SIZE);
+    if (!buffer) {
+        setLastError(BACKUP_ERROR_FLASH_BUSY, "Update arena busy (" + String(UpdateArena::useToString(UpdateArena::getOwner())) + ")");
+        return BACKUP_ERROR_FLASH_BUSY;
+    }
+    
     // Erase current bank (this is the risky part!)
     DiagnosticManager::logMessage(LOG_WARNING, "FlashBackupManager", "Erasing current firmware bank for restore");
     BackupResult_t eraseResult = eraseFirmwareBank(CURRENT_FIRMWARE_BASE, firmwareSize);
     if (eraseResult != BACKUP_SUCCESS) {
+        UpdateArena::release(UPDATE_ARENA_RESTORE);
         setLastError(eraseResult, "CRITICAL: Failed to erase current bank during restore");
         return eraseResult;
     }
@@ -205,13 +286,6 @@ BackupResult_t FlashBackupManager::restoreFromBackup() {
     reportProgress(40);
     
     // Copy backup firmware to current bank
-    const uint32_t CHUNK_SIZE = 4096;
-    uint8_t* buffer = (uint8_t*)malloc(CHUNK_SIZE);
-    if (!buffer) {
-        setLastError(BACKUP_ERROR_UNKNOWN, "CRITICAL: Failed to allocate restore buffer");
-        return BACKUP_ERROR_UNKNOWN;
-    }
-    
     uint32_t totalCopied = 0;
     BackupResult_t copyResult = BACKUP_SUCCESS;
     
@@ -237,7 +311,7 @@ BackupResult_t FlashBackupManager::restoreFromBackup() {
         reportProgress(progress);
     }
     
-    free(buffer);
+    UpdateArena::release(UPDATE_ARENA_RESTORE);
     
     if (copyResult != BACKUP_SUCCESS) {
         setLastError(copyResult, "CRITICAL: Failed to restore firmware from backup");
@@ -339,7 +413,10 @@ String FlashBackupManager::getBackupStatusString() {
     if (status.hasValidBackup) {
         statusStr += "VALID, Version: " + VersionManager::getVersionString(status.backupVersion);
         statusStr += ", Size: " + String(status.backupSize) + " bytes";
-        statusStr += ", Created: " + String((millis() - status.backupTimestamp) / 1000) + "s ago";
+        if (status.backupTimestamp != 0) {
+            statusStr += ", Created: " + String((millis() - status.backupTimestamp) / 1000) + "s ago";
+            statusStr += ", " + String(status.sectorsWritten) + " sectors written, " + String(status.sectorsSkipped) + " unchanged";
+        }
     } else {
         statusStr += "NO_BACKUP";
     }
@@ -363,6 +440,34 @@ BackupResult_t FlashBackupManager::readFirmwareFromBank(uint32_t bankAddress, ui
     return BACKUP_SUCCESS;
 }
 
+uint32_t FlashBackupManager::getImageSize(uint32_t bankAddress) {
+    if (bankAddress != CURRENT_FIRMWARE_BASE && bankAddress != BACKUP_FIRMWARE_BASE) {
+        return 0;
+    }
+    
+    // IVT: header, entry, reserved, DCD, boot data, self, CSF, reserved
+    const uint32_t* ivt = (const uint32_t*)(bankAddress + IMAGE_IVT_OFFSET);
+    if ((ivt[0] & IMAGE_IVT_HEADER_MASK) != IMAGE_IVT_HEADER ||
+        ivt[5] != CURRENT_FIRMWARE_BASE + IMAGE_IVT_OFFSET) {
+        return 0;
+    }
+    
+    // Pointers are linked for bank A - rebase the boot data onto this bank
+    uint32_t bootData = ivt[4];
+    if (bootData < CURRENT_FIRMWARE_BASE + IMAGE_IVT_OFFSET ||
+        bootData + 12 > CURRENT_FIRMWARE_BASE + FIRMWARE_MAX_SIZE) {
+        return 0;
+    }
+    
+    // Boot data: image start, image length, plugin flag
+    const uint32_t* boot = (const uint32_t*)(bankAddress + (bootData - CURRENT_FIRMWARE_BASE));
+    if (boot[0] != CURRENT_FIRMWARE_BASE || boot[1] == 0 || boot[1] > FIRMWARE_MAX_SIZE) {
+        return 0;
+    }
+    
+    return boot[1];
+}
+
 BackupResult_t FlashBackupManager::writeFirmwareToBank(uint32_t bankAddress, const uint8_t* buffer, 
                                                       uint32_t size, uint32_t offset) {
     if (!isValidFlashAddress(bankAddress + offset) || !isValidFlashAddress(bankAddress + offset + size - 1)) {
@@ -397,18 +502,8 @@ BackupResult_t FlashBackupManager::eraseFirmwareBank(uint32_t bankAddress, uint3
 }
 
 uint32_t FlashBackupManager::calculateFirmwareChecksum(uint32_t bankAddress, uint32_t size) {
-    // Simple CRC32 calculation
-    uint32_t crc = 0xFFFFFFFF;
-    uint8_t* data = (uint8_t*)bankAddress;
-    
-    for (uint32_t i = 0; i < size; i++) {
-        crc ^= data[i];
-        for (int j = 0; j < 8; j++) {
-            crc = (crc >> 1) ^ (0xEDB88320 & (-(crc & 1)));
-        }
-    }
-    
-    return ~crc;
+    // CRC32 straight from memory-mapped flash
+    return FirmwareHash::crc32((const uint8_t*)bankAddress, size);
 }
 
 bool FlashBackupManager::verifyFirmwareIntegrity(uint32_t bankAddress, uint32_t size, uint32_t expectedChecksum) {
@@ -416,6 +511,42 @@ bool FlashBackupManager::verifyFirmwareIntegrity(uint32_t bankAddress, uint32_t
     return (calculatedChecksum == expectedChecksum);
 }
 
+const BackupManifest* FlashBackupManager::findManifest() {
+    // Checked in place - the manifest sector is memory-mapped flash
+    const BackupManifest* manifest = (const BackupManifest*)BACKUP_MANIFEST_ADDRESS;
+    
+    if (manifest->magic != BACKUP_MANIFEST_MAGIC || manifest->version != BACKUP_MANIFEST_VERSION) {
+        return nullptr;
+    }
+    if (manifest->imageSize == 0 || manifest->imageSize > BACKUP_MAX_IMAGE_SIZE ||
+        manifest->sectorCount != calculateSectorsNeeded(manifest->imageSize)) {
+        return nullptr;
+    }
+    
+    return (calculateManifestChecksum(manifest) == manifest->manifestChecksum) ? manifest : nullptr;
+}
+
+BackupResult_t FlashBackupManager::writeManifest(BackupManifest* manifest) {
+    // Caller erases the manifest sector first
+    manifest->magic = BACKUP_MANIFEST_MAGIC;
+    manifest->version = BACKUP_MANIFEST_VERSION;
+    memset(&manifest->sectorChecksum[manifest->sectorCount], 0,
+           (BACKUP_MAX_SECTORS - manifest->sectorCount) * sizeof(uint32_t));
+    manifest->manifestChecksum = calculateManifestChecksum(manifest);
+    
+    BackupResult_t result = writeFirmwareToBank(BACKUP_MANIFEST_ADDRESS, (const uint8_t*)manifest, sizeof(BackupManifest));
+    if (result != BACKUP_SUCCESS) {
+        return result;
+    }
+    
+    return (memcmp((const void*)BACKUP_MANIFEST_ADDRESS, manifest, sizeof(BackupManifest)) == 0) ?
+           BACKUP_SUCCESS : BACKUP_ERROR_VERIFY_FAILED;
+}
+
+uint32_t FlashBackupManager::calculateManifestChecksum(const BackupManifest* manifest) {
+    return FirmwareHash::crc32((const uint8_t*)manifest, offsetof(BackupManifest, manifestChecksum));
+}
+
 BackupResult_t FlashBackupManager::verifyBackupIntegrity() {
     if (!_backupStatus.hasValidBackup) {
         return BACKUP_ERROR_NO_BACKUP;
@@ -448,16 +579,19 @@ void FlashBackupManager::reportProgress(uint8_t progress) {
 }
 
 void FlashBackupManager::updateBackupStatus() {
-    // Scan backup bank to determine if valid backup exists
-    // This is a simplified implementation - in practice, you'd look for
-    // specific markers or headers to identify valid firmware
-    
+    // The manifest identifies a completed backup; validateBackup() still
+    // checksums the bank itself before anything is restored from it
     _backupStatus.hasValidBackup = false;
     _backupStatus.backupSize = 0;
     _backupStatus.backupChecksum = 0;
     
-    // TODO: Implement proper backup detection logic
-    // For now, assume no backup until we can properly detect it
+    const BackupManifest* manifest = findManifest();
+    if (manifest) {
+        _backupStatus.hasValidBackup = true;
+        _backupStatus.backupVersion = manifest->firmwareVersion;
+        _backupStatus.backupSize = manifest->imageSize;
+        _backupStatus.backupChecksum = manifest->imageChecksum;
+    }
     
     _backupStatusValid = true;
     _lastStatusUpdate = millis();
@@ -29,6 +29,21 @@ extern "C" {
 #define FIRMWARE_MAX_SIZE       0x400000UL      // 4MB per bank
 // FLASH_SECTOR_SIZE is already defined in FlashTxx.h
 
+// Top 256KB of flash belongs to Teensy EEPROM emulation and the recovery
+// program, so the backup image and its manifest stop below it
+#define FLASH_RESERVED_SIZE     0x40000UL
+#define BACKUP_MANIFEST_SIZE    FLASH_SECTOR_SIZE
+#define BACKUP_MANIFEST_ADDRESS (BACKUP_FIRMWARE_BASE + FIRMWARE_MAX_SIZE - FLASH_RESERVED_SIZE - BACKUP_MANIFEST_SIZE)
+#define BACKUP_MAX_IMAGE_SIZE   (BACKUP_MANIFEST_ADDRESS - BACKUP_FIRMWARE_BASE)
+#define BACKUP_MAX_SECTORS      (BACKUP_MAX_IMAGE_SIZE / FLASH_SECTOR_SIZE)
+#define BACKUP_MANIFEST_MAGIC   0x4D466752      // "RgFM"
+#define BACKUP_MANIFEST_VERSION 1
+
+// i.MX RT boot header - the IVT's boot data records the image length
+#define IMAGE_IVT_OFFSET        0x1000
+#define IMAGE_IVT_HEADER_MASK   0x00FFFFFFUL    // Tag and length, any version
+#define IMAGE_IVT_HEADER        0x002000D1UL    // Tag 0xD1, length 0x0020
+
 // Backup operation result codes
 typedef enum {
     BACKUP_SUCCESS = 0,           // Operation completed successfully
@@ -51,10 +66,25 @@ struct BackupStatus {
     uint32_t backupSize;              // Size of backup firmware in bytes
     uint32_t backupChecksum;          // CRC32 checksum of backup firmware
     uint32_t backupTimestamp;         // Timestamp when backup was created
+    uint16_t sectorsWritten;          // Sectors rewritten by the last backup
+    uint16_t sectorsSkipped;          // Sectors already matching the backup bank
     BackupResult_t lastOperation;     // Result of last backup operation
     String lastError;                 // Description of last error
 };
 
+// Backup manifest - stored at BACKUP_MANIFEST_ADDRESS, describes the image
+// in the backup bank so the next backup only rewrites changed sectors
+struct BackupManifest {
+    uint32_t magic;                   // BACKUP_MANIFEST_MAGIC
+    uint16_t version;                 // BACKUP_MANIFEST_VERSION
+    uint16_t sectorCount;             // Sectors covered by the image
+    uint32_t imageSize;               // Image length in bytes
+    uint32_t imageChecksum;           // CRC32 of the whole image
+    FirmwareVersion_t firmwareVersion;
+    uint32_t sectorChecksum[BACKUP_MAX_SECTORS]; // CRC32 per sector (last may be partial)
+    uint32_t manifestChecksum;        // CRC32 of all preceding fields
+};
+
 class FlashBackupManager {
 public:
     // Initialization and status
@@ -78,6 +108,11 @@ public:
     static BackupResult_t eraseBackupBank();
     static BackupResult_t verifyBackupIntegrity();
     
+    // Bank access (bounds-checked to the two firmware banks)
+    static BackupResult_t readFirmwareFromBank(uint32_t bankAddress, uint8_t* buffer, 
+                                             uint32_t size, uint32_t offset = 0);
+    static uint32_t getImageSize(uint32_t bankAddress);   // From the boot header, 0 if none
+    
     // Rollback preparation and execution
     static bool canRollback();
     static BackupResult_t prepareRollback();
@@ -104,17 +139,22 @@ private:
     static uint32_t _lastStatusUpdate;
     
     // Flash operation helpers
-    static BackupResult_t readFirmwareFromBank(uint32_t bankAddress, uint8_t* buffer, 
-                                             uint32_t size, uint32_t offset = 0);
     static BackupResult_t writeFirmwareToBank(uint32_t bankAddress, const uint8_t* buffer, 
                                             uint32_t size, uint32_t offset = 0);
     static BackupResult_t eraseFirmwareBank(uint32_t bankAddress, uint32_t size);
+    static BackupResult_t copyToBackupBank(uint32_t firmwareSize, const FirmwareVersion_t& currentVersion,
+                                         uint8_t* sectorBuffer, BackupManifest* manifest);
     
     // Verification and integrity checking
     static uint32_t calculateFirmwareChecksum(uint32_t bankAddress, uint32_t size);
     static bool verifyFirmwareIntegrity(uint32_t bankAddress, uint32_t size, uint32_t expectedChecksum);
     static BackupResult_t compareFirmwareBanks(uint32_t bank1Address, uint32_t bank2Address, uint32_t size);
     
+    // Backup manifest
+    static const BackupManifest* findManifest();     // Valid manifest in flash, or nullptr
+    static BackupResult_t writeManifest(BackupManifest* manifest);
+    static uint32_t calculateManifestChecksum(const BackupManifest* manifest);
+    
     // Version management
     static bool extractVersionFromFirmware(uint32_t bankAddress, FirmwareVersion_t* version);
     static BackupResult_t validateFirmwareVersion(const FirmwareVersion_t& version);
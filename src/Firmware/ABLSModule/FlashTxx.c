@@ -81,15 +81,24 @@ RAMFUNC int flash_write_block(uint32_t offset, const void *buf, uint32_t len)
 }
 
 //******************************************************************************
-// firmware_buffer_init() - create buffer in flash for new firmware
+// firmware_buffer_locate() - buffer location after program text, no erase
 //******************************************************************************
-int firmware_buffer_init(uint32_t *buffer_addr, uint32_t *buffer_size)
+void firmware_buffer_locate(uint32_t *buffer_addr, uint32_t *buffer_size)
 {
     // Calculate buffer location after program text
-    uint32_t addr = ((uint32_t)&_etext + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+    *buffer_addr = ((uint32_t)&_etext + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
     
     // Calculate available space (simplified - assumes 4MB available)
-    uint32_t size = 0x400000; // 4MB
+    *buffer_size = 0x400000; // 4MB
+}
+
+//******************************************************************************
+// firmware_buffer_init() - create buffer in flash for new firmware
+//******************************************************************************
+int firmware_buffer_init(uint32_t *buffer_addr, uint32_t *buffer_size)
+{
+    uint32_t addr, size;
+    firmware_buffer_locate(&addr, &size);
     
     // Erase the buffer area
     uint32_t sectors = (size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE;
@@ -38,6 +38,7 @@ RAMFUNC int flash_write_block(uint32_t offset, const void *buf, uint32_t len);
 
 // Firmware buffer management
 int firmware_buffer_init(uint32_t *buffer_addr, uint32_t *buffer_size);
+void firmware_buffer_locate(uint32_t *buffer_addr, uint32_t *buffer_size);
 void firmware_buffer_free(uint32_t buffer_addr, uint32_t buffer_size);
 int check_flash_id(uint32_t addr, uint32_t size);
 
@@ -199,6 +199,21 @@ RAMFUNC int flash_write_block( uint32_t offset, const void *buf, uint32_t len )
 
 #endif // __IMXRT1062__
 
+//******************************************************************************
+// firmware_buffer_locate()	buffer location after code, without erasing
+//******************************************************************************
+void firmware_buffer_locate( uint32_t *buffer_addr, uint32_t *buffer_size )
+{
+  uint32_t code_size = (uint32_t)&_etext - FLASH_BASE_ADDR;
+
+  // round up to next sector boundary
+  code_size = (code_size + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+
+  // buffer is in flash after code, multiple of sector size
+  *buffer_addr = FLASH_BASE_ADDR + code_size;
+  *buffer_size = ((FLASH_SIZE - FLASH_RESERVE - code_size) / FLASH_SECTOR_SIZE) * FLASH_SECTOR_SIZE;
+}
+
 //******************************************************************************
 // firmware_buffer_init()	create buffer in flash for new firmware
 //******************************************************************************
@@ -108,6 +108,7 @@ extern "C" {
 
 // Core flash functions
 int firmware_buffer_init(uint32_t *buffer_addr, uint32_t *buffer_size);
+void firmware_buffer_locate(uint32_t *buffer_addr, uint32_t *buffer_size);
 void firmware_buffer_free(uint32_t buffer_addr, uint32_t buffer_size);
 int flash_write_block(uint32_t offset, const void *buf, uint32_t len);
 int check_flash_id(uint32_t addr, uint32_t size);
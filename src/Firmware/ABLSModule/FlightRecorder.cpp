@@ -0,0 +1,440 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Flight Recorder Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "FlightRecorder.h"
+#include "DiagnosticManager.h"
+#include "ModuleConfig.h"
+#include "LoopProfiler.h"
+
+#define RECORDER_SYNC_INTERVAL_MS   5000
+
+// Static member initialization
+RecorderMode_t FlightRecorder::_mode = RECORDER_DEFAULT_MODE;
+bool FlightRecorder::_initialized = false;
+volatile bool FlightRecorder::_recording = false;
+uint8_t FlightRecorder::_buffers[2][RECORDER_BUFFER_SIZE] __attribute__((aligned(32)));
+volatile uint8_t FlightRecorder::_active = 0;
+volatile uint32_t FlightRecorder::_fill = 0;
+volatile bool FlightRecorder::_pending[2] = { false, false };
+volatile uint32_t FlightRecorder::_length[2] = { 0, 0 };
+uint8_t FlightRecorder::_writeIndex = 0;
+volatile uint16_t FlightRecorder::_sequence = 0;
+volatile uint32_t FlightRecorder::_records = 0;
+volatile uint32_t FlightRecorder::_dropped = 0;
+volatile bool FlightRecorder::_triggered = false;
+volatile uint32_t FlightRecorder::_triggerReason = RECORDER_TRIGGER_NONE;
+volatile uint32_t FlightRecorder::_triggerMicros = 0;
+uint32_t FlightRecorder::_postTriggerStart = 0;
+uint16_t FlightRecorder::_incidents = 0;
+FsFile FlightRecorder::_file;
+bool FlightRecorder::_fileOpen = false;
+uint16_t FlightRecorder::_fileNumber = 0;
+uint32_t FlightRecorder::_dataCapacity = 0;
+uint32_t FlightRecorder::_dataBytes = 0;
+uint32_t FlightRecorder::_fileRecords = 0;
+uint32_t FlightRecorder::_fileDropped = 0;
+uint32_t FlightRecorder::_startMillis = 0;
+uint32_t FlightRecorder::_lastSync = 0;
+
+static const char* triggerName(uint32_t reason) {
+    switch (reason) {
+        case RECORDER_TRIGGER_SAFETY: return "safety violation";
+        case RECORDER_TRIGGER_ESTOP:  return "emergency stop";
+        case RECORDER_TRIGGER_MANUAL: return "manual";
+        default:                      return "none";
+    }
+}
+
+bool FlightRecorder::initialize() {
+    if (_mode == RECORDER_OFF) {
+        DiagnosticManager::logMessage(LOG_INFO, "FlightRecorder", "Disabled");
+        return true;
+    }
+
+    if (!DiagnosticManager::isSDCardAvailable()) {
+        DiagnosticManager::logMessage(LOG_WARNING, "FlightRecorder", "No SD card - recorder disabled");
+        return false;
+    }
+
+    if (!SD.exists("/blackbox")) {
+        SD.mkdir("/blackbox");
+    }
+
+    // Never overwrite an earlier recording - continue after the last file
+    char name[32];
+    for (_fileNumber = 0; _fileNumber < RECORDER_MAX_FILES; _fileNumber++) {
+        snprintf(name, sizeof(name), "/blackbox/bb_%03u.bin", _fileNumber);
+        if (!SD.exists(name)) break;
+    }
+
+    if (!openFile()) {
+        return false;
+    }
+
+    _initialized = true;
+    _recording = true;
+
+    DiagnosticManager::logMessage(LOG_INFO, "FlightRecorder",
+        String(_mode == RECORDER_CONTINUOUS ? "Continuous" : "Triggered") + " recording to bb_" +
+        String(_fileNumber) + ".bin (" + String(_dataCapacity / (1024UL * 1024UL)) + "MB preallocated)");
+    return true;
+}
+
+void FlightRecorder::recordImu(uint32_t micros, const float quat[4], const float linAccel[3],
+                               const float gyro[3], uint8_t quatAccuracy, uint8_t linAccelAccuracy, uint16_t reportId) {
+    if (!_recording) return;
+
+    FlightRecord record = {};
+    record.Type = RECORD_IMU;
+    record.TimestampMicros = micros;
+    for (int i = 0; i < 4; i++) {
+        record.Imu.Quat[i] = (int16_t)constrain(lroundf(quat[i] * 16384.0f), -32768L, 32767L);
+    }
+    for (int i = 0; i < 3; i++) {
+        record.Imu.LinAccel[i] = (int16_t)constrain(lroundf(linAccel[i] * 100.0f), -32768L, 32767L);
+        record.Imu.Gyro[i] = (int16_t)constrain(lroundf(gyro[i] * 1000.0f), -32768L, 32767L);
+    }
+    record.Imu.QuatAccuracy = quatAccuracy;
+    record.Imu.LinAccelAccuracy = linAccelAccuracy;
+    record.Imu.ReportId = reportId;
+    append(record);
+}
+
+void FlightRecorder::recordRadar(uint32_t micros, float distanceM, bool valid, uint32_t peak0Mm, int32_t peak0Strength,
+                                 uint32_t peak1Mm, int32_t peak1Strength) {
+    if (!_recording) return;
+
+    FlightRecord record = {};
+    record.Type = RECORD_RADAR;
+    record.TimestampMicros = micros;
+    record.Radar.DistanceM = distanceM;
+    record.Radar.Peak0Mm = peak0Mm;
+    record.Radar.Peak1Mm = peak1Mm;
+    record.Radar.Peak0Strength = peak0Strength;
+    record.Radar.Peak1Strength = peak1Strength;
+    record.Radar.Valid = valid ? 1 : 0;
+    append(record);
+}
+
+void FlightRecorder::recordGnss(uint32_t micros, int32_t latE7, int8_t latHp, int32_t lonE7, int8_t lonHp,
+                                int32_t heightMm, uint32_t hAcc, uint32_t timeOfWeek, bool validFix, uint8_t rtkStatus) {
+    if (!_recording) return;
+
+    FlightRecord record = {};
+    record.Type = RECORD_GNSS;
+    record.TimestampMicros = micros;
+    record.Gnss.LatE7 = latE7;
+    record.Gnss.LonE7 = lonE7;
+    record.Gnss.HeightMm = heightMm;
+    record.Gnss.HAcc = hAcc;
+    record.Gnss.TimeOfWeek = timeOfWeek;
+    record.Gnss.LatHp = latHp;
+    record.Gnss.LonHp = lonHp;
+    record.Gnss.Flags = (validFix ? 0x01 : 0x00) | ((rtkStatus & 0x03) << 1);
+    append(record);
+}
+
+void FlightRecorder::recordRam(uint8_t channel, uint32_t micros, float position, float target, float pidOutput,
+                               float feedForward, int16_t rawAdc, uint16_t pwm, uint8_t flags) {
+    if (!_recording) return;
+
+    FlightRecord record = {};
+    record.Type = RECORD_RAM;
+    record.Channel = channel;
+    record.TimestampMicros = micros;
+    record.Ram.PositionPercent = position;
+    record.Ram.TargetPercent = target;
+    record.Ram.PidOutput = pidOutput;
+    record.Ram.FeedForwardPercent = feedForward;
+    record.Ram.RawAdc = rawAdc;
+    record.Ram.Pwm = pwm;
+    record.Ram.Flags = flags;
+    append(record);
+}
+
+void FlightRecorder::recordCommand(uint32_t micros, uint32_t commandId, float centre, float left, float right,
+                                   uint32_t receiveMicros, bool accepted) {
+    if (!_recording) return;
+
+    FlightRecord record = {};
+    record.Type = RECORD_COMMAND;
+    record.TimestampMicros = micros;
+    record.Command.CommandId = commandId;
+    record.Command.SetpointCenter = centre;
+    record.Command.SetpointLeft = left;
+    record.Command.SetpointRight = right;
+    record.Command.ReceiveMicros = receiveMicros;
+    record.Command.Accepted = accepted ? 1 : 0;
+    append(record);
+}
+
+void FlightRecorder::trigger(RecorderTrigger_t reason, uint32_t safetyViolations) {
+    if (!_recording) return;
+
+    FlightRecord record = {};
+    record.Type = RECORD_TRIGGER;
+    record.TimestampMicros = micros();
+    record.Trigger.Reason = reason;
+    record.Trigger.SafetyViolations = safetyViolations;
+    append(record);
+
+    // The first trigger names the incident; later ones are just marked
+    noInterrupts();
+    if (!_triggered) {
+        _triggered = true;
+        _triggerReason = reason;
+        _triggerMicros = record.TimestampMicros;
+    }
+    interrupts();
+}
+
+void FlightRecorder::append(FlightRecord& record) {
+    noInterrupts();
+
+    // Active half is full and waiting - move on if the writer has freed the other
+    if (_fill >= RECORDER_BUFFER_SIZE) {
+        uint8_t next = _active ^ 1;
+        if (_pending[next]) {
+            _dropped++;
+            interrupts();
+            return;
+        }
+        _active = next;
+        _fill = 0;
+    }
+
+    record.Sequence = _sequence;
+    _sequence = _sequence + 1;
+    memcpy(&_buffers[_active][_fill], &record, sizeof(record));
+    _fill += sizeof(record);
+    _records++;
+
+    if (_fill >= RECORDER_BUFFER_SIZE) {
+        _length[_active] = RECORDER_BUFFER_SIZE;
+        _pending[_active] = true;
+        uint8_t next = _active ^ 1;
+        if (!_pending[next]) {
+            _active = next;
+            _fill = 0;
+        }
+    }
+
+    interrupts();
+}
+
+void FlightRecorder::swapPartial() {
+    // Hand the partly filled half to the writer (end of file)
+    noInterrupts();
+    if (_fill > 0 && _fill < RECORDER_BUFFER_SIZE && !_pending[_active]) {
+        _length[_active] = _fill;
+        _pending[_active] = true;
+        uint8_t next = _active ^ 1;
+        if (!_pending[next]) {
+            _active = next;
+            _fill = 0;
+        } else {
+            _fill = RECORDER_BUFFER_SIZE; // Producers wait for the writer
+        }
+    }
+    interrupts();
+}
+
+bool FlightRecorder::writePending() {
+    uint8_t index = _writeIndex;
+    if (!_pending[index]) return false;
+
+    // Whole sectors only - pad a partial half with empty records
+    uint32_t length = _length[index];
+    uint32_t padded = (length + 511) & ~511UL;
+    if (padded > length) {
+        memset(&_buffers[index][length], 0, padded - length);
+    }
+
+    bool ok = true;
+    if (_mode == RECORDER_CONTINUOUS && _dataBytes + padded > _dataCapacity) {
+        // File full - keep what we have and stop
+        DiagnosticManager::logMessage(LOG_WARNING, "FlightRecorder", "Recording file full - recorder stopped");
+        _recording = false;
+        ok = false;
+    } else {
+        // Ring: split the write where it wraps back to the start of the data area
+        uint32_t done = 0;
+        while (done < padded) {
+            uint32_t offset = _dataBytes % _dataCapacity;
+            uint32_t run = min(padded - done, _dataCapacity - offset);
+            uint32_t position = RECORDER_HEADER_SIZE + offset;
+            if ((uint32_t)_file.curPosition() != position) {
+                _file.seekSet(position);
+            }
+
+            // Sector-aligned, sector-multiple write from RAM goes straight
+            // to the card as one multi-block transfer
+            if (_file.write(&_buffers[index][done], run) != run) {
+                DiagnosticManager::logError("FlightRecorder", "SD write failed - recorder stopped");
+                _recording = false;
+                ok = false;
+                break;
+            }
+            done += run;
+            _dataBytes += run;
+        }
+    }
+
+    noInterrupts();
+    _pending[index] = false;
+    interrupts();
+    _writeIndex = index ^ 1;
+    return ok;
+}
+
+bool FlightRecorder::openFile() {
+    if (_fileNumber >= RECORDER_MAX_FILES) {
+        DiagnosticManager::logMessage(LOG_WARNING, "FlightRecorder",
+            "All " + String(RECORDER_MAX_FILES) + " recording files used - clear /blackbox to record again");
+        return false;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "/blackbox/bb_%03u.bin", _fileNumber);
+    if (!_file.open(&SD.sdfs, name, O_RDWR | O_CREAT | O_TRUNC)) {
+        DiagnosticManager::logError("FlightRecorder", String("Cannot create ") + name);
+        return false;
+    }
+
+    _dataCapacity = (_mode == RECORDER_CONTINUOUS) ? RECORDER_CONTINUOUS_BYTES : RECORDER_RING_BYTES;
+    if (!_file.preAllocate(RECORDER_HEADER_SIZE + _dataCapacity)) {
+        DiagnosticManager::logError("FlightRecorder", String("Cannot preallocate ") + name + " - card full?");
+        _file.close();
+        return false;
+    }
+    if (!_file.isContiguous()) {
+        DiagnosticManager::logMessage(LOG_WARNING, "FlightRecorder", String(name) + " is fragmented - writes may stall");
+    }
+
+    _fileOpen = true;
+    _dataBytes = 0;
+    _fileRecords = _records;
+    _fileDropped = _dropped;
+    _startMillis = millis();
+    _lastSync = _startMillis;
+    writeHeader(false);
+    return true;
+}
+
+void FlightRecorder::closeFile() {
+    if (!_fileOpen) return;
+
+    swapPartial();
+    while (writePending()) {
+    }
+
+    writeHeader(true);
+    _file.close();
+    _fileOpen = false;
+}
+
+void FlightRecorder::writeHeader(bool complete) {
+    uint8_t sector[RECORDER_HEADER_SIZE];
+    memset(sector, 0, sizeof(sector));
+
+    FlightRecorderFileHeader header;
+    memcpy(header.Magic, RECORDER_FILE_MAGIC, sizeof(header.Magic));
+    header.Version = RECORDER_FILE_VERSION;
+    header.Mode = (uint8_t)_mode;
+    header.ModuleRole = (uint8_t)ModuleConfig::getRole();
+    header.RecordSize = RECORDER_RECORD_SIZE;
+    header.HeaderSize = RECORDER_HEADER_SIZE;
+    header.DataCapacity = _dataCapacity;
+    header.DataBytes = _dataBytes;
+    header.RingOffset = (_dataBytes > _dataCapacity) ? (_dataBytes % _dataCapacity) : 0;
+    header.TriggerReason = _triggered ? _triggerReason : (uint32_t)RECORDER_TRIGGER_NONE;
+    header.TriggerMicros = _triggered ? _triggerMicros : 0;
+    header.Records = _records - _fileRecords;
+    header.Dropped = _dropped - _fileDropped;
+    header.StartMillis = _startMillis;
+    header.Complete = complete ? 1 : 0;
+    memset(header.Reserved, 0, sizeof(header.Reserved));
+    memcpy(sector, &header, sizeof(header));
+
+    uint32_t position = (uint32_t)_file.curPosition();
+    _file.seekSet(0);
+    _file.write(sector, sizeof(sector));
+    if (position > RECORDER_HEADER_SIZE) {
+        _file.seekSet(position);
+    }
+    _file.sync();
+}
+
+void FlightRecorder::service() {
+    if (!_initialized || !_fileOpen) return;
+
+    PROFILE_SCOPE(PROBE_RECORDER_SERVICE);
+
+    while (writePending()) {
+    }
+
+    if (!_recording) {
+        // Stopped by a full file or a write error
+        closeFile();
+        return;
+    }
+
+    uint32_t now = millis();
+
+    if (_mode == RECORDER_TRIGGERED && _triggered) {
+        if (_postTriggerStart == 0) {
+            _postTriggerStart = now ? now : 1;
+            DiagnosticManager::logMessage(LOG_WARNING, "FlightRecorder",
+                String("Incident (") + triggerName(_triggerReason) + ") - keeping " +
+                String(RECORDER_POST_TRIGGER_MS / 1000) + "s more in bb_" + String(_fileNumber) + ".bin");
+        } else if (now - _postTriggerStart >= RECORDER_POST_TRIGGER_MS) {
+            // Incident captured - seal this file and arm the next one
+            closeFile();
+            _incidents++;
+            _postTriggerStart = 0;
+            noInterrupts();
+            _triggered = false;
+            interrupts();
+
+            _fileNumber++;
+            if (!openFile()) {
+                _recording = false;
+                return;
+            }
+            DiagnosticManager::logMessage(LOG_INFO, "FlightRecorder",
+                "Incident saved - re-armed on bb_" + String(_fileNumber) + ".bin");
+            return;
+        }
+    }
+
+    // Keep the header current so a power cut still leaves a readable file
+    if (now - _lastSync >= RECORDER_SYNC_INTERVAL_MS) {
+        writeHeader(false);
+        _lastSync = now;
+    }
+}
+
+void FlightRecorder::stop() {
+    _recording = false;
+    if (_fileOpen) {
+        closeFile();
+    }
+}
+
+String FlightRecorder::getStatusString() {
+    if (_mode == RECORDER_OFF) return "Off";
+    if (!_initialized) return "Not recording";
+    if (!_recording) return "Stopped (" + String(_records) + " records)";
+
+    String status = (_mode == RECORDER_CONTINUOUS) ? "Recording" : "Armed";
+    status += " bb_" + String(_fileNumber) + ", " + String(_records) + " records, " + String(_dropped) + " dropped";
+    if (_mode == RECORDER_TRIGGERED) {
+        status += ", " + String(_incidents) + " incidents";
+    }
+    return status;
+}
@@ -0,0 +1,253 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Flight Recorder - Binary Black Box on SD
+ *
+ * Every IMU, radar, GNSS and ram sample, plus every accepted command,
+ * as fixed 32-byte records:
+ * - Double buffer of RECORDER_BUFFER_SIZE; a full half goes to the card
+ *   in one multi-block write from loop(), producers never touch SD
+ * - Files are preallocated contiguous, so writes never walk the FAT
+ * - Continuous mode fills one file and stops
+ * - Triggered mode records into a ring in the file and, on a safety
+ *   violation or emergency stop, keeps RECORDER_POST_TRIGGER_MS more,
+ *   closes that incident file and re-arms on the next one
+ * - Producers are safe from the control tick ISR
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+// Buffering - each half is one multi-block write (whole sectors)
+#define RECORDER_RECORD_SIZE        32
+#define RECORDER_BUFFER_SIZE        8192
+#define RECORDER_HEADER_SIZE        512     // First sector of every file
+
+// File sizing
+#define RECORDER_CONTINUOUS_BYTES   (256UL * 1024UL * 1024UL)  // ~1.5h at the full stream
+#define RECORDER_RING_BYTES         (4UL * 1024UL * 1024UL)    // ~90s of pre-trigger history
+#define RECORDER_POST_TRIGGER_MS    10000
+#define RECORDER_MAX_FILES          100
+
+// File format
+#define RECORDER_FILE_MAGIC         "ABLSBBOX"
+#define RECORDER_FILE_VERSION       1
+
+typedef enum {
+    RECORDER_OFF = 0,
+    RECORDER_CONTINUOUS = 1,    // Everything, until the file is full
+    RECORDER_TRIGGERED = 2      // Ring, kept around incidents only
+} RecorderMode_t;
+
+#ifndef RECORDER_DEFAULT_MODE
+#define RECORDER_DEFAULT_MODE       RECORDER_TRIGGERED
+#endif
+
+typedef enum {
+    RECORDER_TRIGGER_NONE = 0,
+    RECORDER_TRIGGER_SAFETY = 1,    // Ram outside its safe stroke
+    RECORDER_TRIGGER_ESTOP = 2,     // emergencyStop()
+    RECORDER_TRIGGER_MANUAL = 3
+} RecorderTrigger_t;
+
+typedef enum {
+    RECORD_EMPTY = 0,           // Padding to a sector boundary
+    RECORD_IMU = 1,
+    RECORD_RADAR = 2,
+    RECORD_GNSS = 3,
+    RECORD_RAM = 4,             // One ram's control step - Channel is the ADC channel
+    RECORD_COMMAND = 5,
+    RECORD_TRIGGER = 6
+} FlightRecordType_t;
+
+// Ram record flags
+#define RECORD_RAM_ENABLED          0x01
+#define RECORD_RAM_SAFE             0x02
+#define RECORD_RAM_ESTOP            0x04
+
+#pragma pack(push, 1)
+
+struct FlightRecordImu {
+    int16_t Quat[4];            // I, J, K, Real in Q14
+    int16_t LinAccel[3];        // cm/s^2
+    int16_t Gyro[3];            // mrad/s
+    uint8_t QuatAccuracy;
+    uint8_t LinAccelAccuracy;
+    uint16_t ReportId;
+};
+
+struct FlightRecordRadar {
+    float DistanceM;            // Selected distance, 0 when invalid
+    uint32_t Peak0Mm;
+    uint32_t Peak1Mm;
+    int32_t Peak0Strength;
+    int32_t Peak1Strength;
+    uint8_t Valid;
+    uint8_t Reserved[3];
+};
+
+struct FlightRecordGnss {
+    int32_t LatE7;
+    int32_t LonE7;
+    int32_t HeightMm;           // Above mean sea level
+    uint32_t HAcc;              // 0.1mm
+    uint32_t TimeOfWeek;        // ms
+    int8_t LatHp;               // 1e-9 deg
+    int8_t LonHp;
+    uint8_t Flags;              // bit 0 valid fix, bits 1-2 RTK status
+    uint8_t Reserved;
+};
+
+struct FlightRecordRam {
+    float PositionPercent;
+    float TargetPercent;        // Setpoint plus feed-forward
+    float PidOutput;
+    float FeedForwardPercent;
+    int16_t RawAdc;
+    uint16_t Pwm;
+    uint8_t Flags;              // RECORD_RAM_*
+    uint8_t Reserved[3];
+};
+
+struct FlightRecordCommand {
+    uint32_t CommandId;
+    float SetpointCenter;
+    float SetpointLeft;
+    float SetpointRight;
+    uint32_t ReceiveMicros;
+    uint8_t Accepted;
+    uint8_t Reserved[3];
+};
+
+struct FlightRecordTrigger {
+    uint32_t Reason;            // RecorderTrigger_t
+    uint32_t SafetyViolations;
+    uint8_t Reserved[16];
+};
+
+struct FlightRecord {
+    uint8_t Type;               // FlightRecordType_t
+    uint8_t Channel;
+    uint16_t Sequence;          // Per recorder, wraps - gaps show drops
+    uint32_t TimestampMicros;
+    union {
+        FlightRecordImu Imu;
+        FlightRecordRadar Radar;
+        FlightRecordGnss Gnss;
+        FlightRecordRam Ram;
+        FlightRecordCommand Command;
+        FlightRecordTrigger Trigger;
+        uint8_t Raw[24];
+    };
+};
+
+// First sector of every file (rest of the sector is zero)
+struct FlightRecorderFileHeader {
+    char Magic[8];              // RECORDER_FILE_MAGIC, not terminated
+    uint16_t Version;
+    uint8_t Mode;               // RecorderMode_t
+    uint8_t ModuleRole;
+    uint16_t RecordSize;
+    uint16_t HeaderSize;        // Data starts here
+    uint32_t DataCapacity;      // Bytes of record space after the header
+    uint32_t DataBytes;         // Bytes written in total (ring: may exceed capacity)
+    uint32_t RingOffset;        // Ring: oldest data starts here once wrapped
+    uint32_t TriggerReason;     // RecorderTrigger_t, 0 if none
+    uint32_t TriggerMicros;
+    uint32_t Records;
+    uint32_t Dropped;
+    uint32_t StartMillis;
+    uint8_t Complete;           // Written when the file was closed cleanly
+    uint8_t Reserved[3];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(FlightRecord) == RECORDER_RECORD_SIZE, "FlightRecord must be 32 bytes");
+static_assert(sizeof(FlightRecorderFileHeader) <= RECORDER_HEADER_SIZE, "FlightRecorderFileHeader must fit one sector");
+static_assert(RECORDER_BUFFER_SIZE % 512 == 0, "Recorder buffer must be whole sectors");
+static_assert(RECORDER_RING_BYTES % RECORDER_BUFFER_SIZE == 0, "Ring must be whole buffers");
+
+class FlightRecorder {
+public:
+    // Configuration - call before initialize()
+    static void setMode(RecorderMode_t mode) { _mode = mode; }
+    static RecorderMode_t getMode() { return _mode; }
+
+    // Initialization - after the SD card is up
+    static bool initialize();
+    static bool isRecording() { return _recording; }
+
+    // Producers - any context, cheap no-ops when not recording
+    static void recordImu(uint32_t micros, const float quat[4], const float linAccel[3],
+                          const float gyro[3], uint8_t quatAccuracy, uint8_t linAccelAccuracy, uint16_t reportId);
+    static void recordRadar(uint32_t micros, float distanceM, bool valid, uint32_t peak0Mm, int32_t peak0Strength,
+                            uint32_t peak1Mm, int32_t peak1Strength);
+    static void recordGnss(uint32_t micros, int32_t latE7, int8_t latHp, int32_t lonE7, int8_t lonHp,
+                           int32_t heightMm, uint32_t hAcc, uint32_t timeOfWeek, bool validFix, uint8_t rtkStatus);
+    static void recordRam(uint8_t channel, uint32_t micros, float position, float target, float pidOutput,
+                          float feedForward, int16_t rawAdc, uint16_t pwm, uint8_t flags);
+    static void recordCommand(uint32_t micros, uint32_t commandId, float centre, float left, float right,
+                              uint32_t receiveMicros, bool accepted);
+
+    // Incident marker - any context; ends the current incident in triggered mode
+    static void trigger(RecorderTrigger_t reason, uint32_t safetyViolations);
+
+    // SD service - foreground only
+    static void service();
+    static void stop();         // Flush and close cleanly (before halt/reset)
+
+    // Statistics
+    static uint32_t getRecordCount() { return _records; }
+    static uint32_t getDropCount() { return _dropped; }
+    static uint16_t getIncidentCount() { return _incidents; }
+    static String getStatusString();
+
+private:
+    static RecorderMode_t _mode;
+    static bool _initialized;
+    static volatile bool _recording;
+
+    // Double buffer - producers fill _buffers[_active], service() writes the other
+    static uint8_t _buffers[2][RECORDER_BUFFER_SIZE] __attribute__((aligned(32)));
+    static volatile uint8_t _active;
+    static volatile uint32_t _fill;
+    static volatile bool _pending[2];
+    static volatile uint32_t _length[2];
+    static uint8_t _writeIndex;
+    static volatile uint16_t _sequence;
+    static volatile uint32_t _records;
+    static volatile uint32_t _dropped;
+
+    // Trigger state
+    static volatile bool _triggered;
+    static volatile uint32_t _triggerReason;
+    static volatile uint32_t _triggerMicros;
+    static uint32_t _postTriggerStart;
+    static uint16_t _incidents;
+
+    // File
+    static FsFile _file;
+    static bool _fileOpen;
+    static uint16_t _fileNumber;
+    static uint32_t _dataCapacity;
+    static uint32_t _dataBytes;
+    static uint32_t _fileRecords;
+    static uint32_t _fileDropped;
+    static uint32_t _startMillis;
+    static uint32_t _lastSync;
+
+    static void append(FlightRecord& record);
+    static void swapPartial();
+    static bool writePending();
+    static bool openFile();
+    static void closeFile();
+    static void writeHeader(bool complete);
+};
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,196 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * GNSS Receiver Configuration Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "GnssConfig.h"
+#include "DiagnosticManager.h"
+#include <EEPROM.h>
+
+#define GNSS_CONNECT_WAIT_MS        500     // Per attempt - a wrong baud rate never answers
+
+// u-blox key ID size field (bits 28-30)
+#define GNSS_KEY_SIZE(key)          (((key) >> 28) & 0x07)
+#define GNSS_KEY_SIZE_BIT           1
+#define GNSS_KEY_SIZE_U1            2
+#define GNSS_KEY_SIZE_U2            3
+#define GNSS_KEY_SIZE_U4            4
+
+#define GNSS_CONFIG_LAYERS          (VAL_LAYER_RAM | VAL_LAYER_BBR | VAL_LAYER_FLASH)
+
+// Static member initialization
+bool GnssConfig::_reconfigured = false;
+uint32_t GnssConfig::_configHash = 0;
+uint32_t GnssConfig::_applyMillis = 0;
+GnssMode_t GnssConfig::_mode = GNSS_DEFAULT_MODE;
+
+bool GnssConfig::apply(SFE_UBLOX_GNSS_SERIAL& gps, HardwareSerial& port, GnssMode_t mode, dynModel model) {
+    uint32_t start = millis();
+    _mode = mode;
+    _reconfigured = false;
+
+    Item items[GNSS_CONFIG_MAX_ITEMS];
+    size_t count = buildTable(mode, model, items, GNSS_CONFIG_MAX_ITEMS);
+    _configHash = hashTable(items, count);
+
+    // A configured receiver answers at the working rate straight away
+    bool atWorkingBaud = connect(gps, port, GNSS_UART_BAUD);
+    if (!atWorkingBaud) {
+        if (GNSS_UART_BAUD == GNSS_FACTORY_BAUD || !connect(gps, port, GNSS_FACTORY_BAUD)) {
+            DiagnosticManager::logError("GnssConfig", "Receiver not responding on UART1");
+            return false;
+        }
+
+        // Move UART1 first - the ACK is lost as the rate changes, so it is not checked
+        gps.setVal32(UBLOX_CFG_UART1_BAUDRATE, GNSS_UART_BAUD, VAL_LAYER_RAM);
+        delay(GNSS_BAUD_SWITCH_MS);
+        if (!connect(gps, port, GNSS_UART_BAUD)) {
+            DiagnosticManager::logError("GnssConfig", "Receiver lost after UART1 rate change to " + String(GNSS_UART_BAUD));
+            return false;
+        }
+    }
+
+    // Warm boot: our hash says what was saved, the readback says the receiver still has it
+    uint32_t savedHash = 0;
+    if (atWorkingBaud && loadSavedHash(&savedHash) && savedHash == _configHash &&
+        receiverMatches(gps, items, count)) {
+        _applyMillis = millis() - start;
+        DiagnosticManager::logMessage(LOG_INFO, "GnssConfig",
+            "Receiver configuration current (hash " + String(_configHash, HEX) + ", " + String(_applyMillis) + "ms)");
+        return true;
+    }
+
+    if (!sendTable(gps, items, count)) {
+        DiagnosticManager::logError("GnssConfig", "Receiver rejected configuration VALSET");
+        return false;
+    }
+    saveHash(_configHash);
+    _reconfigured = true;
+    _applyMillis = millis() - start;
+
+    DiagnosticManager::logMessage(LOG_INFO, "GnssConfig",
+        "Receiver configured for " + String(getNavigationRate(mode)) + "Hz and saved (" + String(count) +
+        " keys, hash " + String(_configHash, HEX) + ", " + String(_applyMillis) + "ms)");
+    return true;
+}
+
+uint8_t GnssConfig::getNavigationRate(GnssMode_t mode) {
+    return (mode == GNSS_MODE_HIGH_RATE) ? GNSS_HIGH_RATE_HZ : GNSS_STANDARD_RATE_HZ;
+}
+
+size_t GnssConfig::buildTable(GnssMode_t mode, dynModel model, Item* items, size_t maxItems) {
+    const Item table[] = {
+        // Read back on warm boots - each differs from the factory default
+        { UBLOX_CFG_RATE_MEAS, (uint32_t)(1000 / getNavigationRate(mode)) },
+        { UBLOX_CFG_UART1OUTPROT_NMEA, 0 },
+        { UBLOX_CFG_MSGOUT_UBX_NAV_PVT_UART1, 1 },
+
+        { UBLOX_CFG_RATE_NAV, 1 },
+        { UBLOX_CFG_MSGOUT_UBX_NAV_HPPOSLLH_UART1, 1 },
+        { UBLOX_CFG_UART1OUTPROT_UBX, 1 },
+        { UBLOX_CFG_UART1OUTPROT_RTCM3X, 0 },
+        { UBLOX_CFG_UART1INPROT_UBX, 1 },
+        { UBLOX_CFG_UART1INPROT_NMEA, 0 },
+        { UBLOX_CFG_UART1INPROT_RTCM3X, 1 },        // Corrections from forwardRtcmToGps()
+        { UBLOX_CFG_UART1_BAUDRATE, GNSS_UART_BAUD },
+        { UBLOX_CFG_NAVSPG_DYNMODEL, (uint32_t)model },
+        { UBLOX_CFG_TP_TIMEGRID_TP1, 1 }            // TIMEPULSE on the GPS time grid
+    };
+
+    size_t count = sizeof(table) / sizeof(table[0]);
+    if (count > maxItems) count = maxItems;
+    for (size_t i = 0; i < count; i++) {
+        items[i] = table[i];
+    }
+    return count;
+}
+
+uint32_t GnssConfig::hashTable(const Item* items, size_t count) {
+    // FNV-1a over key and value - any table edit in a new build changes it
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t words[2] = { items[i].key, items[i].value };
+        const uint8_t* bytes = (const uint8_t*)words;
+        for (size_t b = 0; b < sizeof(words); b++) {
+            hash ^= bytes[b];
+            hash *= 16777619UL;
+        }
+    }
+    return hash;
+}
+
+bool GnssConfig::connect(SFE_UBLOX_GNSS_SERIAL& gps, HardwareSerial& port, uint32_t baud) {
+    port.begin(baud);
+    return gps.begin(port, GNSS_CONNECT_WAIT_MS);
+}
+
+bool GnssConfig::sendTable(SFE_UBLOX_GNSS_SERIAL& gps, const Item* items, size_t count) {
+    // One UBX-CFG-VALSET for the whole table, one ACK
+    bool ok = gps.newCfgValset(GNSS_CONFIG_LAYERS);
+    for (size_t i = 0; ok && i < count; i++) {
+        switch (GNSS_KEY_SIZE(items[i].key)) {
+            case GNSS_KEY_SIZE_BIT:
+            case GNSS_KEY_SIZE_U1: ok = gps.addCfgValset8(items[i].key, (uint8_t)items[i].value); break;
+            case GNSS_KEY_SIZE_U2: ok = gps.addCfgValset16(items[i].key, (uint16_t)items[i].value); break;
+            case GNSS_KEY_SIZE_U4: ok = gps.addCfgValset32(items[i].key, items[i].value); break;
+            default:               ok = false; break;
+        }
+    }
+    return ok && gps.sendCfgValset();
+}
+
+bool GnssConfig::receiverMatches(SFE_UBLOX_GNSS_SERIAL& gps, const Item* items, size_t count) {
+    if (count > GNSS_CONFIG_VERIFY_ITEMS) count = GNSS_CONFIG_VERIFY_ITEMS;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = 0;
+        bool read = false;
+        switch (GNSS_KEY_SIZE(items[i].key)) {
+            case GNSS_KEY_SIZE_BIT:
+            case GNSS_KEY_SIZE_U1: {
+                uint8_t v8 = 0;
+                read = gps.getVal8(items[i].key, &v8, VAL_LAYER_RAM);
+                value = v8;
+                break;
+            }
+            case GNSS_KEY_SIZE_U2: {
+                uint16_t v16 = 0;
+                read = gps.getVal16(items[i].key, &v16, VAL_LAYER_RAM);
+                value = v16;
+                break;
+            }
+            case GNSS_KEY_SIZE_U4:
+                read = gps.getVal32(items[i].key, &value, VAL_LAYER_RAM);
+                break;
+        }
+
+        if (!read || value != items[i].value) {
+            // Replaced or factory-reset receiver - the saved hash no longer describes it
+            DiagnosticManager::logMessage(LOG_WARNING, "GnssConfig",
+                "Receiver key " + String(items[i].key, HEX) + " differs from saved configuration");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GnssConfig::loadSavedHash(uint32_t* hash) {
+    EepromRecord record;
+    EEPROM.get(GNSS_CONFIG_EEPROM_ADDRESS, record);
+    if (record.magic != GNSS_CONFIG_EEPROM_MAGIC) return false;
+    *hash = record.hash;
+    return true;
+}
+
+void GnssConfig::saveHash(uint32_t hash) {
+    EepromRecord record = { GNSS_CONFIG_EEPROM_MAGIC, hash };
+    EEPROM.put(GNSS_CONFIG_EEPROM_ADDRESS, record);
+}
+
+String GnssConfig::getStatusString() {
+    return "GNSS: " + String(getNavigationRate(_mode)) + "Hz " +
+           (_reconfigured ? "configured " : "cached ") + String(_applyMillis) + "ms";
+}
@@ -0,0 +1,91 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * GNSS Receiver Configuration
+ *
+ * Brings the ZED-F9P on UART1 to a known configuration at start-up:
+ * - UART1 carries UBX out and UBX + RTCM3 in - no NMEA on the port the
+ *   callback parser reads
+ * - NAV-PVT (speed, heading, satellites) and NAV-HPPOSLLH every epoch,
+ *   at 20Hz in high-rate mode (the F9P RTK maximum) or 10Hz in standard
+ * - The whole table goes out as one batched VALSET to RAM, BBR and flash
+ * - A hash of the table is kept in EEPROM; a warm boot whose hash and
+ *   receiver readback both match sends nothing
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef GNSS_CONFIG_H
+#define GNSS_CONFIG_H
+
+#include <Arduino.h>
+#include <SparkFun_u-blox_GNSS_v3.h>
+
+// Navigation modes
+typedef enum {
+    GNSS_MODE_STANDARD = 0,     // 10Hz
+    GNSS_MODE_HIGH_RATE = 1     // 20Hz - fresher velocity/heading for look-ahead
+} GnssMode_t;
+
+#ifndef GNSS_DEFAULT_MODE
+#define GNSS_DEFAULT_MODE GNSS_MODE_HIGH_RATE
+#endif
+
+#define GNSS_STANDARD_RATE_HZ       10
+#define GNSS_HIGH_RATE_HZ           20
+
+// UART1 rate - 20Hz PVT + HPPOSLLH out and RTCM in overrun the 38400 default
+#ifndef GNSS_UART_BAUD
+#define GNSS_UART_BAUD              115200
+#endif
+#define GNSS_FACTORY_BAUD           38400
+#define GNSS_BAUD_SWITCH_MS         100     // Receiver re-opens UART1 after a rate change
+
+#define GNSS_CONFIG_MAX_ITEMS       16
+#define GNSS_CONFIG_VERIFY_ITEMS    3       // Leading table entries read back on a warm boot
+
+// EEPROM record holding the hash of the last configuration saved to the receiver
+#define GNSS_CONFIG_EEPROM_ADDRESS  0
+#define GNSS_CONFIG_EEPROM_MAGIC    0x474E5343  // "GNSC"
+
+class GnssConfig {
+public:
+    // Open the receiver on port (at GNSS_UART_BAUD, else the factory rate) and make
+    // sure it holds the configuration for mode/model. Returns false if the receiver
+    // does not answer or rejects the configuration.
+    static bool apply(SFE_UBLOX_GNSS_SERIAL& gps, HardwareSerial& port, GnssMode_t mode, dynModel model);
+
+    static uint8_t getNavigationRate(GnssMode_t mode);
+
+    // Diagnostics from the last apply()
+    static bool wasReconfigured() { return _reconfigured; }
+    static uint32_t getConfigHash() { return _configHash; }
+    static uint32_t getApplyMillis() { return _applyMillis; }
+    static String getStatusString();
+
+private:
+    struct Item {
+        uint32_t key;       // u-blox configuration key ID (size in bits 28-30)
+        uint32_t value;
+    };
+
+    struct EepromRecord {
+        uint32_t magic;
+        uint32_t hash;
+    };
+
+    static bool _reconfigured;
+    static uint32_t _configHash;
+    static uint32_t _applyMillis;
+    static GnssMode_t _mode;
+
+    static size_t buildTable(GnssMode_t mode, dynModel model, Item* items, size_t maxItems);
+    static uint32_t hashTable(const Item* items, size_t count);
+    static bool connect(SFE_UBLOX_GNSS_SERIAL& gps, HardwareSerial& port, uint32_t baud);
+    static bool sendTable(SFE_UBLOX_GNSS_SERIAL& gps, const Item* items, size_t count);
+    static bool receiverMatches(SFE_UBLOX_GNSS_SERIAL& gps, const Item* items, size_t count);
+    static bool loadSavedHash(uint32_t* hash);
+    static void saveHash(uint32_t hash);
+};
+
+#endif // GNSS_CONFIG_H
@@ -0,0 +1,155 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * GPS Time Service Implementation
+ * 
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "GpsTimeService.h"
+#include "DiagnosticManager.h"
+#include "BinaryLog.h"
+
+// Static member initialization
+bool GpsTimeService::_initialized = false;
+SeqLock<GpsTimeService::PulseEdge> GpsTimeService::_edge;
+SeqLock<GpsTimeService::TimeModel> GpsTimeService::_model;
+uint32_t GpsTimeService::_processedCount = 0;
+uint32_t GpsTimeService::_lastItow = 0;
+uint32_t GpsTimeService::_lastItowLocalMicros = 0;
+uint32_t GpsTimeService::_lastItowMillis = 0;
+bool GpsTimeService::_haveItow = false;
+uint32_t GpsTimeService::_prevEdgeMicros = 0;
+uint64_t GpsTimeService::_prevEdgeGpsTowMicros = 0;
+bool GpsTimeService::_havePrevEdge = false;
+float GpsTimeService::_localMicrosPerSecond = 1000000.0f;
+uint32_t GpsTimeService::_pulseCount = 0;
+int32_t GpsTimeService::_lastResidualMicros = 0;
+
+bool GpsTimeService::initialize(uint8_t timepulsePin) {
+    pinMode(timepulsePin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(timepulsePin), &timepulseHandler, RISING);
+    _initialized = true;
+    
+    DiagnosticManager::logMessage(LOG_INFO, "GpsTimeService", 
+        "TIMEPULSE capture enabled on pin " + String(timepulsePin));
+    return true;
+}
+
+void GpsTimeService::timepulseHandler() {
+    // Latch first - everything else can wait for the foreground
+    uint32_t now = micros();
+    
+    PulseEdge edge;
+    _edge.read(edge);
+    edge.localMicros = now;
+    edge.count++;
+    _edge.write(edge);
+}
+
+void GpsTimeService::onNavigationEpoch(uint32_t iTOW) {
+    _lastItow = iTOW;
+    _lastItowLocalMicros = micros();
+    _lastItowMillis = millis();
+    _haveItow = true;
+}
+
+void GpsTimeService::update() {
+    if (!_initialized) return;
+    
+    PulseEdge edge;
+    if (!_edge.read(edge) || edge.count == _processedCount) return;
+    
+    bool missedPulse = (edge.count - _processedCount) > 1;
+    _processedCount = edge.count;
+    _pulseCount++;
+    
+    // A pulse is only useful once we know which GPS second it marks
+    if (!_haveItow || millis() - _lastItowMillis > GPS_TIME_NAV_MAX_AGE_MS) {
+        _havePrevEdge = false;
+        return;
+    }
+    
+    // Estimate GPS time at the edge from the last iTOW, then snap to the whole
+    // second - message latency is far below the 500ms rounding margin
+    int32_t sinceItowMicros = (int32_t)(edge.localMicros - _lastItowLocalMicros);
+    int64_t estimateMs = (int64_t)_lastItow + sinceItowMicros / 1000;
+    int64_t edgeSeconds = (estimateMs + 500) / 1000;
+    uint64_t edgeGpsTowMicros = ((uint64_t)edgeSeconds * 1000000ULL) % GPS_WEEK_MICROS;
+    
+    // Discipline the rate from consecutive one-second intervals
+    if (_havePrevEdge && !missedPulse) {
+        uint32_t interval = edge.localMicros - _prevEdgeMicros;
+        uint64_t gpsInterval = (edgeGpsTowMicros + GPS_WEEK_MICROS - _prevEdgeGpsTowMicros) % GPS_WEEK_MICROS;
+        
+        if (gpsInterval == 1000000ULL && abs((int32_t)interval - 1000000) <= GPS_TIME_MAX_RATE_ERROR_US) {
+            _lastResidualMicros = (int32_t)((float)interval - _localMicrosPerSecond);
+            _localMicrosPerSecond += ((float)interval - _localMicrosPerSecond) / (1 << GPS_TIME_RATE_FILTER_SHIFT);
+        } else {
+            BLOG(LOG_DEBUG, "GpsTimeService", 
+                "TIMEPULSE interval rejected: %luus local, %lums GPS",
+                (unsigned long)interval, (unsigned long)(gpsInterval / 1000));
+        }
+    }
+    
+    _prevEdgeMicros = edge.localMicros;
+    _prevEdgeGpsTowMicros = edgeGpsTowMicros;
+    _havePrevEdge = true;
+    
+    TimeModel model;
+    model.anchorLocalMicros = edge.localMicros;
+    model.anchorGpsTowMicros = edgeGpsTowMicros;
+    model.localMicrosPerSecond = _localMicrosPerSecond;
+    model.valid = true;
+    _model.write(model);
+}
+
+bool GpsTimeService::isSynchronized() {
+    TimeModel model;
+    if (!_model.read(model) || !model.valid) return false;
+    return (micros() - model.anchorLocalMicros) < GPS_TIME_HOLDOVER_US;
+}
+
+bool GpsTimeService::toGpsTime(uint32_t localMicros, uint64_t* gpsTowMicros) {
+    if (!gpsTowMicros) return false;
+    
+    TimeModel model;
+    if (!_model.read(model) || !model.valid) return false;
+    
+    // Signed so samples slightly before the anchor convert too
+    int32_t sinceAnchor = (int32_t)(localMicros - model.anchorLocalMicros);
+    if ((uint32_t)abs(sinceAnchor) > GPS_TIME_HOLDOVER_US) return false;
+    
+    int64_t gpsOffset = llround((double)sinceAnchor * (1000000.0 / model.localMicrosPerSecond));
+    int64_t tow = (int64_t)model.anchorGpsTowMicros + gpsOffset;
+    if (tow < 0) tow += GPS_WEEK_MICROS;
+    *gpsTowMicros = (uint64_t)tow % GPS_WEEK_MICROS;
+    return true;
+}
+
+bool GpsTimeService::toLocalMicros(uint64_t gpsTowMicros, uint32_t* localMicros) {
+    if (!localMicros) return false;
+    
+    TimeModel model;
+    if (!_model.read(model) || !model.valid) return false;
+    
+    // Shortest signed distance across the week rollover
+    int64_t sinceAnchor = (int64_t)(gpsTowMicros % GPS_WEEK_MICROS) - (int64_t)model.anchorGpsTowMicros;
+    if (sinceAnchor > (int64_t)(GPS_WEEK_MICROS / 2)) sinceAnchor -= GPS_WEEK_MICROS;
+    if (sinceAnchor < -(int64_t)(GPS_WEEK_MICROS / 2)) sinceAnchor += GPS_WEEK_MICROS;
+    if (llabs(sinceAnchor) > (int64_t)GPS_TIME_HOLDOVER_US) return false;
+    
+    int32_t localOffset = (int32_t)llround((double)sinceAnchor * (model.localMicrosPerSecond / 1000000.0));
+    *localMicros = model.anchorLocalMicros + (uint32_t)localOffset;
+    return true;
+}
+
+float GpsTimeService::getRateErrorPpm() {
+    return (_localMicrosPerSecond - 1000000.0f);  // us per second == ppm
+}
+
+String GpsTimeService::getStatusString() {
+    if (!_initialized) return "Time: OFF";
+    if (!isSynchronized()) return "Time: NO SYNC";
+    return "Time: GPS " + String(getRateErrorPpm(), 1) + "ppm";
+}
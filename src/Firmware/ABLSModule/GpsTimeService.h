@@ -0,0 +1,84 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * GPS Time Service
+ *
+ * Disciplines the local micros() clock to GPS time using the ZED-F9P
+ * TIMEPULSE output so samples from all three modules share one timebase:
+ * - TIMEPULSE ISR latches micros() at each top-of-second edge
+ * - The navigation iTOW identifies which GPS second the edge belongs to
+ * - A filtered local-ticks-per-second estimate removes crystal drift
+ * - Any local micros() timestamp converts to GPS time-of-week microseconds
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef GPS_TIME_SERVICE_H
+#define GPS_TIME_SERVICE_H
+
+#include <Arduino.h>
+#include "SensorSnapshot.h"
+
+// ZED-F9P TIMEPULSE (TP1) - rising edge at the top of each GPS second
+#define GNSS_TIMEPULSE_PIN          21
+
+#define GPS_WEEK_MICROS             604800000000ULL
+#define GPS_TIME_HOLDOVER_US        10000000UL  // Keep converting this long after the last pulse
+#define GPS_TIME_MAX_RATE_ERROR_US  500         // Reject intervals further than this from 1s
+#define GPS_TIME_NAV_MAX_AGE_MS     2000        // iTOW must be this fresh to label a pulse
+#define GPS_TIME_RATE_FILTER_SHIFT  3           // Rate estimate IIR weight = 1/8
+
+class GpsTimeService {
+public:
+    // Initialization and lifecycle
+    static bool initialize(uint8_t timepulsePin = GNSS_TIMEPULSE_PIN);
+    static void update();                           // Foreground: process latest pulse
+    static void onNavigationEpoch(uint32_t iTOW);   // Foreground: from the HPPOSLLH callback
+
+    // Conversion - safe from any context
+    static bool isSynchronized();
+    static bool toGpsTime(uint32_t localMicros, uint64_t* gpsTowMicros);
+    static bool toLocalMicros(uint64_t gpsTowMicros, uint32_t* localMicros);
+
+    // Diagnostics
+    static uint32_t getPulseCount() { return _pulseCount; }
+    static int32_t getLastResidualMicros() { return _lastResidualMicros; }
+    static float getRateErrorPpm();
+    static String getStatusString();
+
+private:
+    // Pulse captured in interrupt context
+    struct PulseEdge {
+        uint32_t localMicros = 0;
+        uint32_t count = 0;
+    };
+
+    // Local-to-GPS mapping anchored at the most recent labelled pulse
+    struct TimeModel {
+        uint32_t anchorLocalMicros = 0;
+        uint64_t anchorGpsTowMicros = 0;
+        float localMicrosPerSecond = 1000000.0f;
+        bool valid = false;
+    };
+
+    static void timepulseHandler();
+
+    static bool _initialized;
+    static SeqLock<PulseEdge> _edge;
+    static SeqLock<TimeModel> _model;
+
+    // Foreground state
+    static uint32_t _processedCount;
+    static uint32_t _lastItow;
+    static uint32_t _lastItowLocalMicros;
+    static uint32_t _lastItowMillis;
+    static bool _haveItow;
+    static uint32_t _prevEdgeMicros;
+    static uint64_t _prevEdgeGpsTowMicros;
+    static bool _havePrevEdge;
+    static float _localMicrosPerSecond;
+    static uint32_t _pulseCount;
+    static int32_t _lastResidualMicros;
+};
+
+#endif // GPS_TIME_SERVICE_H
@@ -8,110 +8,478 @@
 
 #include "HydraulicController.h"
 #include "DiagnosticManager.h"
+#include "BinaryLog.h"
+#include "FlightRecorder.h"
+#include "TelemetryBatcher.h"
+#include "I2CBusGuard.h"
+#include "LoopProfiler.h"
+#include <EEPROM.h>
+
+// Static instance pointer for ISR access
+HydraulicController* HydraulicController::_instance = nullptr;
 
 HydraulicController::HydraulicController() :
     _initialized(false),
     _adcInitialized(false),
     _emergencyStop(false),
+    _startupHold(false),
+    _startupHoldReleased(false),
+    _setpointsCommanded(false),
+    _adcFailures(0),
+    _lastAdcAttempt(0),
+#if !ABLS_ROLE_FIXED
     _moduleRole(MODULE_UNKNOWN),
     _isActiveModule(false),
+#endif
+    _adcAcquisitionMode(ADS_DEFAULT_ACQUISITION_MODE),
+    _adcDataRate(ADS_DEFAULT_DATA_RATE),
+    _adcScanIndex(0),
+    _adcReady(false),
+    _lastAdcConversion(0),
+    _adcStaleSamples(0),
+    _adcRestarts(0),
     _ramCenter(RAM_CENTER_ADC_CHANNEL, RAM_CENTER_VALVE_PIN, "Centre"),
     _ramLeft(RAM_LEFT_ADC_CHANNEL, RAM_LEFT_VALVE_PIN, "Left"),
     _ramRight(RAM_RIGHT_ADC_CHANNEL, RAM_RIGHT_VALVE_PIN, "Right"),
+    _controlLaw(HYDRAULIC_DEFAULT_CONTROL_LAW),
+    _pwmResolutionBits(VALVE_PWM_RESOLUTION_BITS),
+    _pwmFrequencyHz(VALVE_PWM_FREQUENCY_HZ),
+    _pwmMax(255),
+    _pwmNeutral(VALVE_PWM_LEGACY_NEUTRAL),
+    _profileMaxRate(PROFILE_DEFAULT_MAX_RATE),
+    _profileMaxAccel(PROFILE_DEFAULT_MAX_ACCEL),
+    _profileMaxJerk(PROFILE_DEFAULT_MAX_JERK),
+    _levellingMode(LEVELLING_REMOTE),
+    _levellingTargetLeft(0.0f),
+    _levellingTargetRight(0.0f),
+    _levellingCentreGain(LEVELLING_DEFAULT_CENTRE_GAIN),
+    _levellingWingGain(LEVELLING_DEFAULT_WING_GAIN),
+    _lastSupervision(0),
+    _lastLevellingUpdate(0),
+    _levellingDropouts(0),
+    _autotuneReportsPending(0),
+    _controlScheduling(HYDRAULIC_DEFAULT_SCHEDULING),
+    _controlRateHz(HYDRAULIC_CONTROL_RATE_HZ),
+    _controlPeriodMicros(1000000UL / HYDRAULIC_CONTROL_RATE_HZ),
+    _controlDt(1.0 / HYDRAULIC_CONTROL_RATE_HZ),
+    _controlTimerRunning(false),
+    _tickCount(0),
+    _tickOverruns(0),
+    _tickLateStarts(0),
+    _tickMaxMicros(0),
+    _lastTickMicros(0),
+    _tickDeadline(HYDRAULIC_LOOP_PERIOD_US),
+    _reportedOverruns(0),
+    _reportedAdcRestarts(0),
     _lastUpdate(0),
     _lastDiagnosticUpdate(0),
+    _haveCommand(false),
+    _lastCommandId(0),
+    _lastCommandMillis(0),
+    _pendingCommandSerial(0),
+    _pendingCommandId(0),
+    _pendingCommandMicros(0),
+    _appliedCommandSerial(0),
+    _appliedCommandId(0),
+    _appliedReceiveMicros(0),
+    _appliedMicros(0),
     _commandsProcessed(0),
+    _commandsRejectedStale(0),
     _safetyViolations(0)
 {
+    _instance = this;
+    _adcScanOrder[0] = &_ramCenter;
+    _adcScanOrder[1] = &_ramLeft;
+    _adcScanOrder[2] = &_ramRight;
+    memset(_autotuneReports, 0, sizeof(_autotuneReports));
 }
 
-bool HydraulicController::initialize() {
+void HydraulicController::initialize() {
     DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", "Initializing hydraulic system...");
     
-    // Check if this module should have hydraulic control
+    // Check if this module should have hydraulic control (constant in role builds)
+#if !ABLS_ROLE_FIXED
     _moduleRole = ModuleConfig::getRole();
     _isActiveModule = (_moduleRole == MODULE_CENTRE);
+#endif
     
     if (!_isActiveModule) {
         DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
             "Not centre module - hydraulic control disabled");
         _initialized = true; // Mark as initialized but inactive
-        return true;
+        return;
     }
     
     DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
         "Centre module detected - initializing hydraulic control");
     
-    // Initialize ADC
+    // Valves first - nothing moves until each ram's position is known, and the
+    // rams then hold where they are rather than driving to a default
+    initializePins();
+    _startupHold = true;
+    
+    // Gains from the last autotune, before the control tick can use them
+    loadPIDGains();
+    
+    // Initialize ADC - a missing ADS1115 is retried from update(), valves stay neutral
+    _lastAdcAttempt = millis();
     _adcInitialized = initializeADC();
     if (!_adcInitialized) {
-        DiagnosticManager::logError("HydraulicController", "ADC initialization failed");
-        return false;
+        _adcFailures++;
+        DiagnosticManager::logError("HydraulicController", "ADC initialization failed - valves held neutral, retrying");
     }
     
-    // Initialize pins
-    initializePins();
-    
-    // Set all rams to safe middle position
-    setSetpoints(DEFAULT_POSITION_PERCENT, DEFAULT_POSITION_PERCENT, DEFAULT_POSITION_PERCENT);
-    
     _initialized = true;
     
+    // Hand the PID loop to the hardware timer - it services the startup hold too
+    if (_controlScheduling == CONTROL_SCHED_TIMER && !startControlTimer()) {
+        DiagnosticManager::logMessage(LOG_WARNING, "HydraulicController", 
+            "Control timer unavailable - falling back to loop() scheduling at 50Hz");
+        _controlScheduling = CONTROL_SCHED_LOOP;
+        _tickDeadline.setPeriod(HYDRAULIC_LOOP_PERIOD_US);
+    }
+    
+    String controlLaw = "legacy PID, 8-bit PWM";
+    if (_controlLaw == CONTROL_LAW_PROFILED) {
+        controlLaw = "profiled PID, " + String(_pwmResolutionBits) + "-bit PWM at " + String(_pwmFrequencyHz, 0) + "Hz";
+    }
     DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
-        "Hydraulic controller initialized successfully");
+        "Hydraulic controller initialized (" + controlLaw + ") - startup hold until ram feedback");
+}
+
+void HydraulicController::retryADC(uint32_t now) {
+    _lastAdcAttempt = now;
     
-    return true;
+    // initializeADC() takes the bus itself
+    _adcInitialized = initializeADC();
+    if (_adcInitialized) {
+        DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+            "ADS1115 ADC initialized after " + String(_adcFailures + 1) + " attempts");
+        return;
+    }
+    
+    _adcFailures++;
+    if ((_adcFailures % 15) == 0) {
+        DiagnosticManager::logMessage(LOG_WARNING, "HydraulicController", 
+            "ADS1115 still not responding after " + String(_adcFailures) + " attempts - valves held neutral");
+    }
+}
+
+void HydraulicController::serviceStartupHold() {
+    // Control tick (or loop() schedule) - no logging. Valves stay neutral until
+    // there is a position for every ram to hold.
+    setAllValvesNeutral();
+    
+    if (!_adcInitialized) return;
+    if (_adcAcquisitionMode == ADC_ACQ_CONTINUOUS &&
+        (_ramCenter.adcSampleCount == 0 || _ramLeft.adcSampleCount == 0 || _ramRight.adcSampleCount == 0)) {
+        return;
+    }
+    
+    RamChannel* channels[3] = { &_ramCenter, &_ramLeft, &_ramRight };
+    for (int i = 0; i < 3; i++) {
+        RamChannel& channel = *channels[i];
+        channel.currentPositionPercent = readChannelPosition(channel);
+        
+        // Hold here unless the Toughbook has already said where to go
+        if (!_setpointsCommanded) {
+            double hold = channel.currentPositionPercent;
+            if (hold < MIN_POSITION_PERCENT) hold = MIN_POSITION_PERCENT;
+            if (hold > MAX_POSITION_PERCENT) hold = MAX_POSITION_PERCENT;
+            channel.setpointPositionPercent = hold;
+        }
+        
+        // Start the loops clean - profiles restart bumpless from the measurement
+        channel.integral = 0.0;
+        channel.previousError = 0.0;
+        channel.pidOutput = 0.0;
+    }
+    
+    _startupHold = false;
+    _startupHoldReleased = true;
+}
+
+StageState_t HydraulicController::getStartupState() {
+    if (!_isActiveModule) return STAGE_NOT_USED;
+    if (!_startupHold) return STAGE_READY;
+    return (_adcFailures == 0) ? STAGE_STARTING : STAGE_RETRYING;
 }
 
 bool HydraulicController::initializeADC() {
-    // Initialize ADS1115 ADC
-    if (!_ads.begin()) {
+    // Initialize ADS1115 ADC (may share its bus with the IMU INT handler)
+    I2CBusGuard::beginBus(ADS_I2C_BUS);
+    I2CBusGuard::setDeferredService(ADS_I2C_BUS, I2C_PRIORITY_CONTROL, &adcBusService);
+    I2CBusLock busLock(ADS_I2C_BUS, I2C_PRIORITY_CONTROL);
+    if (!_ads.begin(ADS1X15_ADDRESS, &I2CBusGuard::wire(ADS_I2C_BUS))) {
         return false;
     }
+    I2CBusGuard::restoreClock(ADS_I2C_BUS);   // Adafruit_I2CDevice restarts the port
     
     // Set gain for 0-5V range (adjust based on your sensor voltage)
     _ads.setGain(GAIN_ONE); // +/- 4.096V range
     
-    DiagnosticManager::logMessage(LOG_DEBUG, "HydraulicController", "ADS1115 ADC initialized");
+    if (_adcAcquisitionMode == ADC_ACQ_CONTINUOUS) {
+        _ads.setDataRate(_adcDataRate);
+        
+        // RDY pulses low for ~8us at the end of every conversion
+        pinMode(ADS_ALERT_RDY_PIN, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(ADS_ALERT_RDY_PIN), &adcReadyHandler, FALLING);
+        
+        _adcScanIndex = 0;
+        startContinuousConversion();
+        
+        DIAG_LOG(LOG_DEBUG, "HydraulicController", 
+            "ADS1115 continuous conversion started (rate code 0x" + String(_adcDataRate, HEX) + 
+            ", RDY pin " + String(ADS_ALERT_RDY_PIN) + ")");
+    }
+    
+    DIAG_LOG(LOG_DEBUG, "HydraulicController", "ADS1115 ADC initialized");
     return true;
 }
 
+void HydraulicController::startContinuousConversion() {
+    // Writing the config register restarts conversion on the new mux, and the
+    // library programs the threshold registers for conversion-ready on ALERT
+    _ads.startADCReading(muxForChannel(_adcScanOrder[_adcScanIndex]->adcChannel), true);
+    _lastAdcConversion = millis();
+}
+
+void HydraulicController::serviceADC() {
+    // Caller holds the I2C bus. Safe from the control tick - no logging here.
+    uint32_t now = millis();
+    
+    if (!_adcReady) {
+        // ENHANCED ERROR RECOVERY: RDY missed or ADS1115 reset - kick it again
+        if (now - _lastAdcConversion > ADS_RDY_TIMEOUT_MS) {
+            startContinuousConversion();
+            _adcRestarts++;
+        }
+        return;
+    }
+    
+    _adcReady = false;
+    
+    // Store the finished conversion against the channel it was muxed to
+    RamChannel* channel = _adcScanOrder[_adcScanIndex];
+    channel->rawAdcValue = _ads.getLastConversionResults();
+    channel->adcSampleTime = now;
+    channel->adcSampleMicros = micros();
+    channel->adcSampleCount++;
+    
+    // Move the mux on to the next ram
+    _adcScanIndex = (_adcScanIndex + 1) % 3;
+    startContinuousConversion();
+}
+
+void HydraulicController::adcReadyHandler() {
+    if (_instance == nullptr) return;
+    _instance->_adcReady = true;
+}
+
+void HydraulicController::adcBusService() {
+    // Conversion the control tick found waiting behind another bus holder -
+    // runs ahead of IMU, radar and display work as the bus frees up
+    if (_instance == nullptr || !_instance->_adcReady) return;
+    _instance->serviceADC();
+}
+
+uint16_t HydraulicController::muxForChannel(uint8_t adcChannel) {
+    switch (adcChannel) {
+        case 0: return ADS1X15_REG_CONFIG_MUX_SINGLE_0;
+        case 1: return ADS1X15_REG_CONFIG_MUX_SINGLE_1;
+        case 2: return ADS1X15_REG_CONFIG_MUX_SINGLE_2;
+        default: return ADS1X15_REG_CONFIG_MUX_SINGLE_3;
+    }
+}
+
 void HydraulicController::initializePins() {
     // Configure valve control pins as PWM outputs
     pinMode(_ramCenter.valvePin, OUTPUT);
     pinMode(_ramLeft.valvePin, OUTPUT);
     pinMode(_ramRight.valvePin, OUTPUT);
     
+    if (_controlLaw == CONTROL_LAW_PROFILED) {
+        // Resolution is global to analogWrite(); frequency is per PWM module,
+        // so all three valves are set alike (pins 7 and 8 share FlexPWM1.3)
+        analogWriteResolution(_pwmResolutionBits);
+        analogWriteFrequency(_ramCenter.valvePin, _pwmFrequencyHz);
+        analogWriteFrequency(_ramLeft.valvePin, _pwmFrequencyHz);
+        analogWriteFrequency(_ramRight.valvePin, _pwmFrequencyHz);
+        
+        _pwmMax = (1 << _pwmResolutionBits) - 1;
+        _pwmNeutral = 1 << (_pwmResolutionBits - 1);
+    } else {
+        _pwmMax = 255;
+        _pwmNeutral = VALVE_PWM_LEGACY_NEUTRAL;
+    }
+    
     // Set all valves to neutral position (50% PWM)
-    analogWrite(_ramCenter.valvePin, 127);
-    analogWrite(_ramLeft.valvePin, 127);
-    analogWrite(_ramRight.valvePin, 127);
+    setAllValvesNeutral();
+    
+    DIAG_LOG(LOG_DEBUG, "HydraulicController", 
+        "Valve pins initialized - " + String(_controlLaw == CONTROL_LAW_PROFILED ? _pwmResolutionBits : 8) + 
+        "-bit PWM, neutral " + String(_pwmNeutral));
+}
+
+void HydraulicController::setControlRate(uint16_t rateHz) {
+    if (rateHz < HYDRAULIC_CONTROL_RATE_MIN_HZ) rateHz = HYDRAULIC_CONTROL_RATE_MIN_HZ;
+    if (rateHz > HYDRAULIC_CONTROL_RATE_MAX_HZ) rateHz = HYDRAULIC_CONTROL_RATE_MAX_HZ;
+    
+    _controlRateHz = rateHz;
+    _controlPeriodMicros = 1000000UL / rateHz;
+    _controlDt = 1.0 / rateHz;
+}
+
+void HydraulicController::setValvePwm(uint8_t resolutionBits, float frequencyHz) {
+    if (resolutionBits < VALVE_PWM_RESOLUTION_MIN_BITS) resolutionBits = VALVE_PWM_RESOLUTION_MIN_BITS;
+    if (resolutionBits > VALVE_PWM_RESOLUTION_MAX_BITS) resolutionBits = VALVE_PWM_RESOLUTION_MAX_BITS;
+    
+    _pwmResolutionBits = resolutionBits;
+    if (frequencyHz > 0.0f) _pwmFrequencyHz = frequencyHz;
+}
+
+void HydraulicController::setProfileLimits(float maxRate, float maxAccel, float maxJerk) {
+    if (maxRate <= 0.0f || maxAccel <= 0.0f || maxJerk <= 0.0f) {
+        DiagnosticManager::logMessage(LOG_WARNING, "HydraulicController", "Ignoring non-positive profile limits");
+        return;
+    }
+    
+    noInterrupts();
+    _profileMaxRate = maxRate;
+    _profileMaxAccel = maxAccel;
+    _profileMaxJerk = maxJerk;
+    interrupts();
     
-    DiagnosticManager::logMessage(LOG_DEBUG, "HydraulicController", "Valve pins initialized");
+    DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+        "Setpoint profile limits - rate:" + String(maxRate, 1) + "%/s, accel:" + 
+        String(maxAccel, 1) + "%/s2, jerk:" + String(maxJerk, 1) + "%/s3");
+}
+
+bool HydraulicController::startControlTimer() {
+    // The tick must never block on I2C, so it needs the cached ADC scan
+    if (_adcAcquisitionMode != ADC_ACQ_CONTINUOUS) {
+        DiagnosticManager::logMessage(LOG_WARNING, "HydraulicController", 
+            "Timer scheduling requires continuous ADC acquisition");
+        return false;
+    }
+    
+    _lastTickMicros = 0;
+    _tickDeadline.setPeriod(_controlPeriodMicros);
+    if (!_controlTimer.begin(controlTickHandler, _controlPeriodMicros)) {
+        return false;
+    }
+    _controlTimer.priority(HYDRAULIC_TIMER_PRIORITY);
+    _controlTimerRunning = true;
+    
+    DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+        "Control tick started at " + String(_controlRateHz) + "Hz (dt=" + 
+        String(_controlDt * 1000.0, 2) + "ms)");
+    return true;
+}
+
+void HydraulicController::controlTickHandler() {
+    if (_instance == nullptr) return;
+    _instance->runControlTick();
+}
+
+void HydraulicController::runControlTick() {
+    // HARD REAL-TIME: runs in IntervalTimer context - no logging, no String, no blocking I2C
+    PROFILE_SCOPE(PROBE_CONTROL_TICK);
+    
+    uint32_t start = micros();
+    
+    if (_lastTickMicros != 0 && (start - _lastTickMicros) > _controlPeriodMicros + _controlPeriodMicros / 2) {
+        _tickLateStarts++;
+    }
+    _lastTickMicros = start;
+    _tickCount++;
+    _tickDeadline.observe(start);
+    
+    // Pick up a finished conversion, or queue it ahead of everything else
+    // if foreground code owns the bus
+    if (_adcReady) {
+        if (I2CBusGuard::tryAcquireFromISR(ADS_I2C_BUS)) {
+            serviceADC();
+            I2CBusGuard::releaseFromISR(ADS_I2C_BUS);
+        } else {
+            I2CBusGuard::requestDeferredService(ADS_I2C_BUS, I2C_PRIORITY_CONTROL);
+        }
+    }
+    
+    if (_emergencyStop) {
+        // In emergency stop, hold all valves at neutral
+        setAllValvesNeutral();
+    } else if (_startupHold) {
+        serviceStartupHold();
+    } else {
+        updateChannel(_ramCenter, _controlDt);
+        updateChannel(_ramLeft, _controlDt);
+        updateChannel(_ramRight, _controlDt);
+        markCommandApplied();
+    }
+    
+    // Batched telemetry samples the positions at its own rate
+    TelemetryBatcher::recordRams(oldestRamSampleMicros(), (float)_ramCenter.currentPositionPercent,
+                                 (float)_ramLeft.currentPositionPercent, (float)_ramRight.currentPositionPercent);
+    
+    uint32_t elapsed = micros() - start;
+    if (elapsed > _tickMaxMicros) _tickMaxMicros = elapsed;
+    if (elapsed > _controlPeriodMicros) _tickOverruns++;
 }
 
 void HydraulicController::update() {
     if (!_initialized || !_isActiveModule) return;
     
+    PROFILE_SCOPE(PROBE_HYDRAULIC_UPDATE);
+    
     uint32_t now = millis();
     
-    // Update at 50Hz (20ms intervals)
-    if (now - _lastUpdate < 20) return;
+    // Bring up a missing ADC in the background - the startup hold waits for it
+    if (!_adcInitialized && now - _lastAdcAttempt >= ADS_INIT_RETRY_MS) {
+        retryADC(now);
+    }
     
-    if (_emergencyStop) {
-        // In emergency stop, set all valves to neutral
-        analogWrite(_ramCenter.valvePin, 127);
-        analogWrite(_ramLeft.valvePin, 127);
-        analogWrite(_ramRight.valvePin, 127);
-        return;
+    // Keep the ram feedback cache fresh independently of the control rate
+    if (_adcInitialized && _adcAcquisitionMode == ADC_ACQ_CONTINUOUS) {
+        I2CBusLock busLock(ADS_I2C_BUS, I2C_PRIORITY_CONTROL);
+        serviceADC();
     }
     
-    // Update each ram channel
-    updateChannel(_ramCenter);
-    updateChannel(_ramLeft);
-    updateChannel(_ramRight);
+    if (_controlScheduling == CONTROL_SCHED_LOOP) {
+        // Update at 50Hz on a drift-free 20ms schedule
+        if (!_tickDeadline.due(micros())) return;
+        
+        if (_emergencyStop) {
+            // In emergency stop, set all valves to neutral
+            setAllValvesNeutral();
+            return;
+        }
+        
+        if (_startupHold) {
+            serviceStartupHold();
+            return;
+        }
+        
+        // Calculate time delta for PID
+        double dt = (now - _lastUpdate) / 1000.0; // Convert to seconds
+        if (_lastUpdate == 0 || dt <= 0) dt = 0.02; // Default 20ms if first update
+        
+        // Update each ram channel
+        updateChannel(_ramCenter, dt);
+        updateChannel(_ramLeft, dt);
+        updateChannel(_ramRight, dt);
+        markCommandApplied();
+        
+        _lastUpdate = now;
+    }
+    
+    // Height loop on wing radar, when the Toughbook has handed it over
+    if (_levellingMode == LEVELLING_LOCAL && !_startupHold && now - _lastLevellingUpdate >= LEVELLING_UPDATE_INTERVAL_MS) {
+        updateLocalLevelling(now);
+    }
     
-    _lastUpdate = now;
+    // Non-real-time follow-up of anything the control tick flagged
+    reportDeferredEvents();
     
     // Update diagnostics every second
     if (now - _lastDiagnosticUpdate >= 1000) {
@@ -120,9 +488,73 @@ void HydraulicController::update() {
     }
 }
 
-void HydraulicController::updateChannel(RamChannel& channel) {
-    if (!channel.enabled) return;
+void HydraulicController::markCommandApplied() {
+    // Runs right after the valves were written from the current setpoints
+    if (_appliedCommandSerial == _pendingCommandSerial) return;
+    
+    _appliedCommandSerial = _pendingCommandSerial;
+    _appliedCommandId = _pendingCommandId;
+    _appliedReceiveMicros = _pendingCommandMicros;
+    _appliedMicros = micros();
+    TelemetryBatcher::recordCommandEcho(_appliedCommandId, _appliedReceiveMicros, _appliedMicros);
+}
+
+void HydraulicController::reportDeferredEvents() {
+    RamChannel* channels[3] = { &_ramCenter, &_ramLeft, &_ramRight };
+    
+    for (int i = 0; i < 3; i++) {
+        RamChannel& channel = *channels[i];
+        
+        noInterrupts();
+        bool tripped = channel.safetyTripPending;
+        channel.safetyTripPending = false;
+        double position = channel.currentPositionPercent;
+        interrupts();
+        
+        if (tripped) {
+            DiagnosticManager::logError("HydraulicController", 
+                channel.name + " ram position unsafe: " + String(position) + "%");
+        }
+    }
     
+    if (_startupHoldReleased) {
+        _startupHoldReleased = false;
+        noInterrupts();
+        double centre = _ramCenter.setpointPositionPercent;
+        double left = _ramLeft.setpointPositionPercent;
+        double right = _ramRight.setpointPositionPercent;
+        interrupts();
+        
+        DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+            String("Startup hold released - ") + (_setpointsCommanded ? "commanded" : "holding measured") +
+            " setpoints Centre " + String(centre, 1) + "%, Left " + String(left, 1) + "%, Right " + String(right, 1) + "%");
+    }
+    
+    // A ram finished its autotune - report it and start the next
+    if (_autotune.phase == AUTOTUNE_REPORT) {
+        finishAutotuneRam();
+    }
+    
+    uint32_t adcRestarts = _adcRestarts;
+    if (adcRestarts != _reportedAdcRestarts) {
+        DiagnosticManager::logMessage(LOG_WARNING, "HydraulicController", 
+            "ADS1115 RDY timeout - conversion restarted (" + String(adcRestarts) + " total)");
+        _reportedAdcRestarts = adcRestarts;
+    }
+}
+
+void HydraulicController::updateChannel(RamChannel& channel, double dt) {
+    if (!channel.enabled) {
+        channel.profileActive = false; // Restart from the measurement when re-enabled
+        return;
+    }
+
+    // The RDY scan fills one ram per conversion - until this ram has its
+    // first sample, the zero in rawAdcValue is not a position
+    if (_adcAcquisitionMode == ADC_ACQ_CONTINUOUS && channel.adcSampleCount == 0) {
+        return;
+    }
+
     // Read current position
     channel.currentPositionPercent = readChannelPosition(channel);
     
@@ -130,32 +562,45 @@ void HydraulicController::updateChannel(RamChannel& channel) {
     channel.inSafeRange = isPositionSafe(channel.currentPositionPercent);
     if (!channel.inSafeRange) {
         _safetyViolations++;
-        DiagnosticManager::logError("HydraulicController", 
-            channel.name + " ram position unsafe: " + String(channel.currentPositionPercent) + "%");
+        channel.safetyTripPending = true; // Logged from loop()
         
         // Stop this channel
         channel.enabled = false;
-        analogWrite(channel.valvePin, 127); // Neutral position
+        writeValve(channel, _pwmNeutral); // Neutral position
+        if (_autotune.phase != AUTOTUNE_IDLE && _autotune.phase != AUTOTUNE_REPORT &&
+            &channel == channelForIndex(_autotune.ram)) {
+            endAutotuneRam(channel, AUTOTUNE_RESULT_SAFETY_TRIP);
+        }
+        recordChannel(channel);
+        FlightRecorder::trigger(RECORDER_TRIGGER_SAFETY, _safetyViolations);
         return;
     }
     
-    // Calculate time delta for PID
-    uint32_t now = millis();
-    double dt = (now - channel.lastUpdateTime) / 1000.0; // Convert to seconds
-    if (dt <= 0) dt = 0.02; // Default 20ms if first update
-    
-    // Run PID control
-    channel.pidOutput = runPID(channel, dt);
+    // Run PID control - the ram under autotune is driven by the tuner
+    if (_autotune.phase != AUTOTUNE_IDLE && _autotune.phase != AUTOTUNE_REPORT &&
+        &channel == channelForIndex(_autotune.ram)) {
+        channel.pidOutput = runAutotune(channel, (float)dt);
+    } else {
+        channel.pidOutput = runControlLaw(channel, dt);
+    }
     
     // Apply PID output to valve
     applyPIDOutput(channel, channel.pidOutput);
+    recordChannel(channel);
     
-    channel.lastUpdateTime = now;
+    channel.lastUpdateTime = millis();
+}
+
+double HydraulicController::runControlLaw(RamChannel& channel, double dt) {
+    if (_controlLaw == CONTROL_LAW_PROFILED) {
+        return runProfiledPID(channel, (float)dt);
+    }
+    return runPID(channel, dt);
 }
 
 double HydraulicController::runPID(RamChannel& channel, double dt) {
     // Calculate error
-    double error = channel.setpointPositionPercent - channel.currentPositionPercent;
+    double error = targetPosition(channel) - channel.currentPositionPercent;
     
     // Proportional term
     double proportional = channel.Kp * error;
@@ -183,33 +628,173 @@ double HydraulicController::runPID(RamChannel& channel, double dt) {
     return output;
 }
 
+float HydraulicController::runProfiledPID(RamChannel& channel, float dt) {
+    // Single precision throughout - the M7 FPU does float in one cycle
+    float measurement = (float)channel.currentPositionPercent;
+    
+    if (!channel.profileActive) {
+        resetProfile(channel);
+    }
+    if (dt <= 0.0f) return 0.0f;
+    
+    // The PID tracks the rate/jerk-limited reference, never the raw setpoint
+    updateSetpointProfile(channel, dt);
+    
+    float kp = (float)channel.Kp;
+    float ki = (float)channel.Ki;
+    float kd = (float)channel.Kd;
+    
+    float error = channel.profilePosition - measurement;
+    float proportional = kp * error;
+    
+    // Derivative on measurement - setpoint changes cause no derivative kick
+    float rate = (measurement - channel.previousMeasurement) / dt;
+    channel.previousMeasurement = measurement;
+    float tau = 1.0f / (2.0f * (float)PI * PID_DERIVATIVE_FILTER_HZ);
+    channel.derivativeFiltered += (dt / (tau + dt)) * (rate - channel.derivativeFiltered);
+    float derivative = -kd * channel.derivativeFiltered;
+    
+    float unsaturated = proportional + channel.integralTerm + derivative;
+    float output = unsaturated;
+    if (output > PID_OUTPUT_MAX) output = PID_OUTPUT_MAX;
+    if (output < PID_OUTPUT_MIN) output = PID_OUTPUT_MIN;
+    
+    // Back-calculation anti-windup: while the valve is saturated the excess
+    // bleeds back out of the integrator. Holding Ki inside the integrator
+    // keeps gain changes from bumping the output. Error only integrates once
+    // the reference is at rest - tracking lag during a move would otherwise
+    // wind up into overshoot.
+    float integrate = (channel.profileVelocity == 0.0f) ? ki * error : 0.0f;
+    channel.integralTerm += (integrate + PID_ANTIWINDUP_GAIN * (output - unsaturated)) * dt;
+    
+    return output;
+}
+
+void HydraulicController::updateSetpointProfile(RamChannel& channel, float dt) {
+    float target = (float)targetPosition(channel);
+    float distance = target - channel.profilePosition;
+    float direction = (distance >= 0.0f) ? 1.0f : -1.0f;
+    
+    if (fabsf(distance) < PROFILE_SETTLE_BAND && fabsf(channel.profileVelocity) < _profileMaxAccel * dt) {
+        channel.profilePosition = target;
+        channel.profileVelocity = 0.0f;
+        channel.profileAccel = 0.0f;
+        return;
+    }
+    
+    // Fastest speed that still brakes to the target at the acceleration limit,
+    // allowing for the travel while deceleration ramps up at the jerk limit
+    float lead = fabsf(channel.profileVelocity) * (_profileMaxAccel / _profileMaxJerk);
+    float brakingDistance = fabsf(distance) - lead;
+    if (brakingDistance < 0.0f) brakingDistance = 0.0f;
+    float desiredVelocity = direction * min(_profileMaxRate, sqrtf(2.0f * _profileMaxAccel * brakingDistance));
+    
+    // Acceleration toward that speed, then slewed at the jerk limit
+    float desiredAccel = (desiredVelocity - channel.profileVelocity) / dt;
+    if (desiredAccel > _profileMaxAccel) desiredAccel = _profileMaxAccel;
+    if (desiredAccel < -_profileMaxAccel) desiredAccel = -_profileMaxAccel;
+    
+    float jerkStep = _profileMaxJerk * dt;
+    float accelChange = desiredAccel - channel.profileAccel;
+    if (accelChange > jerkStep) accelChange = jerkStep;
+    if (accelChange < -jerkStep) accelChange = -jerkStep;
+    channel.profileAccel += accelChange;
+    
+    channel.profileVelocity += channel.profileAccel * dt;
+    if (channel.profileVelocity > _profileMaxRate) channel.profileVelocity = _profileMaxRate;
+    if (channel.profileVelocity < -_profileMaxRate) channel.profileVelocity = -_profileMaxRate;
+    
+    // Never step past the target
+    float next = channel.profilePosition + channel.profileVelocity * dt;
+    if ((target - next) * direction < 0.0f) {
+        next = target;
+        channel.profileVelocity = 0.0f;
+        channel.profileAccel = 0.0f;
+    }
+    channel.profilePosition = next;
+}
+
+void HydraulicController::resetProfile(RamChannel& channel) {
+    // Bumpless start: reference at the ram, at rest, nothing integrated
+    float measurement = (float)channel.currentPositionPercent;
+    channel.profilePosition = measurement;
+    channel.profileVelocity = 0.0f;
+    channel.profileAccel = 0.0f;
+    channel.integralTerm = 0.0f;
+    channel.previousMeasurement = measurement;
+    channel.derivativeFiltered = 0.0f;
+    channel.profileActive = true;
+}
+
 void HydraulicController::applyPIDOutput(RamChannel& channel, double pidOutput) {
-    // Convert PID output (-255 to +255) to PWM value (0 to 255)
-    // 127 = neutral (no movement)
+    // Convert PID output (-255 to +255) to PWM value (0 to _pwmMax)
+    // _pwmNeutral = neutral (no movement)
     // 0 = full retract
-    // 255 = full extend
+    // _pwmMax = full extend
     
-    int pwmValue = 127 + (int)(pidOutput / 2); // Scale and offset
+    int pwmValue;
+    if (_controlLaw == CONTROL_LAW_PROFILED) {
+        pwmValue = _pwmNeutral + (int)lroundf((float)pidOutput * (float)(_pwmMax - _pwmNeutral) / PID_OUTPUT_MAX);
+    } else {
+        pwmValue = _pwmNeutral + (int)(pidOutput / 2); // Scale and offset
+    }
     
     // Ensure PWM value is within valid range
     if (pwmValue < 0) pwmValue = 0;
-    if (pwmValue > 255) pwmValue = 255;
+    if (pwmValue > _pwmMax) pwmValue = _pwmMax;
     
     // Apply PWM to valve
+    writeValve(channel, pwmValue);
+}
+
+void HydraulicController::writeValve(RamChannel& channel, int pwmValue) {
     analogWrite(channel.valvePin, pwmValue);
+    channel.pwmValue = pwmValue; // Reported by logChannelStatus()
+}
+
+void HydraulicController::setAllValvesNeutral() {
+    writeValve(_ramCenter, _pwmNeutral);
+    writeValve(_ramLeft, _pwmNeutral);
+    writeValve(_ramRight, _pwmNeutral);
     
-    // Log significant movements for debugging
-    if (abs(pidOutput) > 50) {
-        DiagnosticManager::logMessage(LOG_DEBUG, "HydraulicController", 
-            channel.name + " ram: pos=" + String(channel.currentPositionPercent, 1) + 
-            "%, target=" + String(channel.setpointPositionPercent, 1) + 
-            "%, PID=" + String(pidOutput, 1) + ", PWM=" + String(pwmValue));
-    }
+    // Profiles restart from wherever the rams stop
+    _ramCenter.profileActive = false;
+    _ramLeft.profileActive = false;
+    _ramRight.profileActive = false;
+}
+
+void HydraulicController::recordChannel(const RamChannel& channel) {
+    // Control tick context - the recorder only copies into RAM
+    uint8_t flags = (channel.enabled ? RECORD_RAM_ENABLED : 0) |
+                    (channel.inSafeRange ? RECORD_RAM_SAFE : 0) |
+                    (_emergencyStop ? RECORD_RAM_ESTOP : 0);
+    FlightRecorder::recordRam(channel.adcChannel, micros(), (float)channel.currentPositionPercent,
+                              (float)targetPosition(channel), (float)channel.pidOutput,
+                              (float)channel.feedForwardPercent, channel.rawAdcValue,
+                              (uint16_t)channel.pwmValue, flags);
+}
+
+double HydraulicController::targetPosition(const RamChannel& channel) {
+    // Commanded setpoint plus terrain feed-forward, never outside the safe stroke
+    double target = channel.setpointPositionPercent + channel.feedForwardPercent;
+    if (target < MIN_POSITION_PERCENT) target = MIN_POSITION_PERCENT;
+    if (target > MAX_POSITION_PERCENT) target = MAX_POSITION_PERCENT;
+    return target;
 }
 
 double HydraulicController::readChannelPosition(RamChannel& channel) {
-    // Read ADC value
-    channel.rawAdcValue = _ads.readADC_SingleEnded(channel.adcChannel);
+    // Read ADC value - cached from the RDY-driven scan, or a blocking single-shot read
+    if (_adcAcquisitionMode == ADC_ACQ_CONTINUOUS) {
+        if (millis() - channel.adcSampleTime > ADS_SAMPLE_STALE_MS) {
+            _adcStaleSamples++;
+        }
+    } else {
+        I2CBusLock busLock(ADS_I2C_BUS, I2C_PRIORITY_CONTROL);
+        channel.rawAdcValue = _ads.readADC_SingleEnded(channel.adcChannel);
+        channel.adcSampleTime = millis();
+        channel.adcSampleMicros = micros();
+        channel.adcSampleCount++;
+    }
     
     // Convert ADC value to percentage (0-100%)
     // Assuming linear relationship between ADC value and position
@@ -228,9 +813,22 @@ bool HydraulicController::isPositionSafe(double positionPercent) {
             positionPercent <= MAX_POSITION_PERCENT);
 }
 
-void HydraulicController::processCommand(const ControlCommandPacket& command) {
+void HydraulicController::processCommand(const ControlCommandPacket& command, uint32_t receiveMicros) {
     if (!_initialized || !_isActiveModule) return;
     
+    // Only ever move forward through CommandIds - duplicates and late
+    // arrivals would step the rams back to an older setpoint
+    uint32_t now = millis();
+    if (_haveCommand && (int32_t)(command.CommandId - _lastCommandId) <= 0 && 
+        now - _lastCommandMillis < COMMAND_RESTART_MS) {
+        _commandsRejectedStale++;
+        recordCommand(command, receiveMicros, false);
+        return;
+    }
+    _haveCommand = true;
+    _lastCommandId = command.CommandId;
+    _lastCommandMillis = now;
+    
     _commandsProcessed++;
     
     // Validate command setpoints
@@ -240,42 +838,228 @@ void HydraulicController::processCommand(const ControlCommandPacket& command) {
     if (!isPositionSafe(command.SetpointRight)) validCommand = false;
     
     if (!validCommand) {
-        DiagnosticManager::logError("HydraulicController", 
-            "Invalid command received - setpoints outside safe range");
+        recordCommand(command, receiveMicros, false);
+        BLOG(LOG_ERROR, "HydraulicController", 
+            "Invalid command %lu - setpoints outside safe range", (unsigned long)command.CommandId);
         return;
     }
     
-    // Apply setpoints
-    setSetpoints(command.SetpointCenter, command.SetpointLeft, command.SetpointRight);
+    // Local levelling owns the setpoints until the Toughbook takes them back
+    if (_levellingMode == LEVELLING_LOCAL) {
+        recordCommand(command, receiveMicros, false);
+        BLOG(LOG_DEBUG, "HydraulicController", 
+            "Command %lu setpoints ignored - local levelling active", (unsigned long)command.CommandId);
+        return;
+    }
     
-    DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
-        "Command processed - Centre: " + String(command.SetpointCenter, 1) + 
-        "%, Left: " + String(command.SetpointLeft, 1) + 
-        "%, Right: " + String(command.SetpointRight, 1) + "%");
+    // Autotune owns the setpoints until it finishes or is aborted
+    if (_autotune.phase != AUTOTUNE_IDLE) {
+        recordCommand(command, receiveMicros, false);
+        BLOG(LOG_DEBUG, "HydraulicController", 
+            "Command %lu setpoints ignored - autotune running", (unsigned long)command.CommandId);
+        return;
+    }
+    
+    // Apply setpoints - arrives at the Toughbook command rate, so no
+    // logging here; updateDiagnostics() reports the counters
+    noInterrupts();
+    _ramCenter.setpointPositionPercent = command.SetpointCenter;
+    _ramLeft.setpointPositionPercent = command.SetpointLeft;
+    _ramRight.setpointPositionPercent = command.SetpointRight;
+    _pendingCommandId = command.CommandId;
+    _pendingCommandMicros = receiveMicros;
+    _pendingCommandSerial = _pendingCommandSerial + 1;
+    _setpointsCommanded = true;
+    interrupts();
+    
+    recordCommand(command, receiveMicros, true);
+}
+
+void HydraulicController::recordCommand(const ControlCommandPacket& command, uint32_t receiveMicros, bool accepted) {
+    FlightRecorder::recordCommand(micros(), command.CommandId, command.SetpointCenter, command.SetpointLeft,
+                                  command.SetpointRight, receiveMicros, accepted);
 }
 
 void HydraulicController::setSetpoints(double centerPercent, double leftPercent, double rightPercent) {
     if (!_initialized || !_isActiveModule) return;
     
+    // 64-bit stores are not atomic against the control tick
+    noInterrupts();
     _ramCenter.setpointPositionPercent = centerPercent;
     _ramLeft.setpointPositionPercent = leftPercent;
     _ramRight.setpointPositionPercent = rightPercent;
+    _setpointsCommanded = true;
+    interrupts();
+    
+    BLOG(LOG_DEBUG, "HydraulicController", 
+        "Setpoints updated - Centre: %.1f%%, Left: %.1f%%, Right: %.1f%%",
+        centerPercent, leftPercent, rightPercent);
+}
+
+void HydraulicController::setFeedForward(double centerPercent, double leftPercent, double rightPercent) {
+    if (!_initialized || !_isActiveModule) return;
+    
+    // Called at 50Hz by TerrainPreview - no logging here
+    noInterrupts();
+    _ramCenter.feedForwardPercent = centerPercent;
+    _ramLeft.feedForwardPercent = leftPercent;
+    _ramRight.feedForwardPercent = rightPercent;
+    interrupts();
+}
+
+void HydraulicController::processWingHeight(const WingHeightPacket& packet) {
+    if (!_initialized || !_isActiveModule) return;
+    
+    WingHeight* wing;
+    if (packet.Header.SenderId == SENDER_LEFT_WING) {
+        wing = &_wingLeft;
+    } else if (packet.Header.SenderId == SENDER_RIGHT_WING) {
+        wing = &_wingRight;
+    } else {
+        return;
+    }
+    
+    // Arrives at radar rate from both wings - no logging here. A stale
+    // link takes any sequence, so a rebooted wing is picked up again.
+    uint32_t now = millis();
+    bool stale = (now - wing->receivedMillis > LEVELLING_WING_STALE_MS);
+    if (wing->packets > 0 && !stale && (int32_t)(packet.Header.Sequence - wing->sequence) <= 0) {
+        wing->outOfOrder++;
+        return;
+    }
+    
+    wing->sequence = packet.Header.Sequence;
+    wing->valid = (packet.Header.Flags & LEVELLING_FLAG_RADAR_VALID) != 0;
+    wing->height = packet.HeightMm / 1000.0f;
+    wing->roll = packet.RollCdeg / 100.0f;
+    wing->pitch = packet.PitchCdeg / 100.0f;
+    wing->receivedMillis = now;
+    wing->packets++;
+}
+
+void HydraulicController::processLevellingSupervision(const LevellingSupervisionPacket& packet) {
+    if (!_initialized || !_isActiveModule) return;
+    
+    if (!(packet.Header.Flags & LEVELLING_FLAG_ENABLE)) {
+        if (_levellingMode == LEVELLING_LOCAL) setLevellingMode(LEVELLING_REMOTE, "disabled by Toughbook");
+        return;
+    }
+    
+    float targetLeft = packet.TargetHeightLeftMm / 1000.0f;
+    float targetRight = packet.TargetHeightRightMm / 1000.0f;
+    if (targetLeft < LEVELLING_MIN_TARGET_HEIGHT_M || targetLeft > LEVELLING_MAX_TARGET_HEIGHT_M ||
+        targetRight < LEVELLING_MIN_TARGET_HEIGHT_M || targetRight > LEVELLING_MAX_TARGET_HEIGHT_M) {
+        DiagnosticManager::logError("HydraulicController", 
+            "Invalid levelling supervision - target heights " + String(targetLeft, 2) + 
+            "m / " + String(targetRight, 2) + "m outside safe range");
+        return;
+    }
+    
+    // Refreshed at the supervision rate, so binary-logged only
+    if (_autotune.phase != AUTOTUNE_IDLE) {
+        BLOG(LOG_WARNING, "HydraulicController", "Local levelling refused - autotune running");
+        return;
+    }
+    
+    _levellingTargetLeft = targetLeft;
+    _levellingTargetRight = targetRight;
+    _lastSupervision = millis();
+    
+    if (_levellingMode != LEVELLING_LOCAL) {
+        _lastLevellingUpdate = _lastSupervision;
+        setLevellingMode(LEVELLING_LOCAL, "target " + String(targetLeft, 2) + "m / " + String(targetRight, 2) + "m");
+    }
+}
+
+void HydraulicController::setLevellingGains(float centreGain, float wingGain) {
+    _levellingCentreGain = centreGain;
+    _levellingWingGain = wingGain;
+    
+    DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+        "Levelling gains updated - Centre:" + String(centreGain, 1) + 
+        "%/s/m, Wing:" + String(wingGain, 1) + "%/s/m");
+}
+
+void HydraulicController::updateLocalLevelling(uint32_t now) {
+    float dt = (now - _lastLevellingUpdate) / 1000.0f;
+    _lastLevellingUpdate = now;
+    
+    // Toughbook hiccups are ridden through; a real loss hands control back
+    if (now - _lastSupervision > LEVELLING_SUPERVISION_TIMEOUT_MS) {
+        _levellingDropouts++;
+        setLevellingMode(LEVELLING_REMOTE, "supervision timeout");
+        return;
+    }
+    
+    if (_emergencyStop) return;
+    
+    // Never integrate across a long gap (loop stalled, SD flush, ...)
+    if (dt > 0.1f) dt = 0.1f;
+    
+    bool leftFresh = wingHeightFresh(_wingLeft, now);
+    bool rightFresh = wingHeightFresh(_wingRight, now);
+    
+    // Positive error = boom too low
+    float errorLeft = leftFresh ? _levellingTargetLeft - _wingLeft.height : 0.0f;
+    float errorRight = rightFresh ? _levellingTargetRight - _wingRight.height : 0.0f;
+    if (fabsf(errorLeft) < LEVELLING_DEADBAND_M) errorLeft = 0.0f;
+    if (fabsf(errorRight) < LEVELLING_DEADBAND_M) errorRight = 0.0f;
+    
+    // Centre ram carries the mean error, wings only their difference from
+    // it, so the loops do not fight. With one wing missing that wing's ram
+    // holds and the other takes its whole error; with both missing
+    // everything holds where it is.
+    if (leftFresh && rightFresh) {
+        float meanError = 0.5f * (errorLeft + errorRight);
+        moveSetpoint(_ramCenter, _levellingCentreGain * meanError, dt);
+        moveSetpoint(_ramLeft, _levellingWingGain * (errorLeft - meanError), dt);
+        moveSetpoint(_ramRight, _levellingWingGain * (errorRight - meanError), dt);
+    } else if (leftFresh) {
+        moveSetpoint(_ramLeft, _levellingWingGain * errorLeft, dt);
+    } else if (rightFresh) {
+        moveSetpoint(_ramRight, _levellingWingGain * errorRight, dt);
+    }
+}
+
+bool HydraulicController::wingHeightFresh(const WingHeight& wing, uint32_t now) {
+    return wing.packets > 0 && wing.valid && (now - wing.receivedMillis <= LEVELLING_WING_STALE_MS);
+}
+
+void HydraulicController::moveSetpoint(RamChannel& channel, float ratePercentPerSecond, float dt) {
+    if (ratePercentPerSecond > LEVELLING_MAX_SETPOINT_RATE) ratePercentPerSecond = LEVELLING_MAX_SETPOINT_RATE;
+    if (ratePercentPerSecond < -LEVELLING_MAX_SETPOINT_RATE) ratePercentPerSecond = -LEVELLING_MAX_SETPOINT_RATE;
+    if (ratePercentPerSecond == 0.0f) return;
     
-    DiagnosticManager::logMessage(LOG_DEBUG, "HydraulicController", 
-        "Setpoints updated - Centre: " + String(centerPercent, 1) + 
-        "%, Left: " + String(leftPercent, 1) + 
-        "%, Right: " + String(rightPercent, 1) + "%");
+    // 64-bit stores are not atomic against the control tick
+    noInterrupts();
+    double setpoint = channel.setpointPositionPercent + ratePercentPerSecond * dt;
+    if (setpoint < MIN_POSITION_PERCENT) setpoint = MIN_POSITION_PERCENT;
+    if (setpoint > MAX_POSITION_PERCENT) setpoint = MAX_POSITION_PERCENT;
+    channel.setpointPositionPercent = setpoint;
+    interrupts();
+}
+
+void HydraulicController::setLevellingMode(LevellingMode_t mode, const String& reason) {
+    _levellingMode = mode;
+    
+    // Either way the rams hold the setpoints they have until told otherwise
+    if (mode == LEVELLING_LOCAL) {
+        DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", "Local levelling enabled - " + reason);
+    } else {
+        DiagnosticManager::logMessage(LOG_WARNING, "HydraulicController", 
+            "Local levelling disabled (" + reason + ") - holding setpoints for Toughbook commands");
+    }
 }
 
 void HydraulicController::emergencyStop() {
     _emergencyStop = true;
+    FlightRecorder::trigger(RECORDER_TRIGGER_ESTOP, _safetyViolations);
     
     DiagnosticManager::logError("HydraulicController", "EMERGENCY STOP ACTIVATED");
     
     // Immediately set all valves to neutral
-    analogWrite(_ramCenter.valvePin, 127);
-    analogWrite(_ramLeft.valvePin, 127);
-    analogWrite(_ramRight.valvePin, 127);
+    setAllValvesNeutral();
+    abortAutotune(AUTOTUNE_RESULT_ABORTED);
 }
 
 void HydraulicController::resume() {
@@ -288,9 +1072,29 @@ void HydraulicController::resume() {
 void HydraulicController::populateRamPositions(SensorDataPacket* packet) {
     if (!packet || !_isActiveModule) return;
     
+    noInterrupts();
     packet->RamPosCenterPercent = _ramCenter.currentPositionPercent;
     packet->RamPosLeftPercent = _ramLeft.currentPositionPercent;
     packet->RamPosRightPercent = _ramRight.currentPositionPercent;
+    
+    packet->RamSampleMicros = oldestRamSampleMicros();
+    
+    // Echo of the last command the valves have acted on
+    if (_appliedCommandSerial != 0) {
+        packet->CommandEchoValid = 1;
+        packet->CommandId = _appliedCommandId;
+        packet->CommandReceiveMicros = _appliedReceiveMicros;
+        packet->CommandApplyMicros = _appliedMicros;
+    }
+    interrupts();
+}
+
+uint32_t HydraulicController::oldestRamSampleMicros() {
+    // Oldest of the three, so the receiver never extrapolates a ram position
+    uint32_t oldest = _ramCenter.adcSampleMicros;
+    if ((int32_t)(_ramLeft.adcSampleMicros - oldest) < 0) oldest = _ramLeft.adcSampleMicros;
+    if ((int32_t)(_ramRight.adcSampleMicros - oldest) < 0) oldest = _ramRight.adcSampleMicros;
+    return oldest;
 }
 
 bool HydraulicController::isInSafeState() {
@@ -306,7 +1110,10 @@ String HydraulicController::getStatusString() {
     if (!_isActiveModule) return "Inactive";
     if (!_initialized) return "Not initialized";
     if (_emergencyStop) return "EMERGENCY STOP";
+    if (_startupHold) return _adcInitialized ? "Startup hold" : "Startup hold (no ADC)";
     if (!isInSafeState()) return "UNSAFE";
+    if (_autotune.phase != AUTOTUNE_IDLE) return "Autotune (" + channelForIndex(_autotune.ram)->name + ")";
+    if (_levellingMode == LEVELLING_LOCAL) return "Active (local levelling)";
     
     return "Active";
 }
@@ -320,20 +1127,30 @@ void HydraulicController::enableChannel(int channel, bool enable) {
     
     DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
         "Channel " + String(channel) + " " + (enable ? "enabled" : "disabled"));
+    
+    if (!enable && _autotune.phase != AUTOTUNE_IDLE && _autotune.ram == channel) {
+        abortAutotune(AUTOTUNE_RESULT_ABORTED);
+    }
 }
 
-void HydraulicController::setPIDGains(int channel, double kp, double ki, double kd) {
-    RamChannel* ram = nullptr;
+RamChannel* HydraulicController::channelForIndex(int channel) {
     switch (channel) {
-        case 0: ram = &_ramCenter; break;
-        case 1: ram = &_ramLeft; break;
-        case 2: ram = &_ramRight; break;
-        default: return;
+        case 0: return &_ramCenter;
+        case 1: return &_ramLeft;
+        case 2: return &_ramRight;
+        default: return nullptr;
     }
+}
+
+void HydraulicController::setPIDGains(int channel, double kp, double ki, double kd) {
+    RamChannel* ram = channelForIndex(channel);
+    if (!ram) return;
     
+    noInterrupts();
     ram->Kp = kp;
     ram->Ki = ki;
     ram->Kd = kd;
+    interrupts();
     
     DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
         ram->name + " PID gains updated - Kp:" + String(kp, 3) + 
@@ -343,19 +1160,466 @@ void HydraulicController::setPIDGains(int channel, double kp, double ki, double
 void HydraulicController::getPIDGains(int channel, double* kp, double* ki, double* kd) {
     if (!kp || !ki || !kd) return;
     
-    RamChannel* ram = nullptr;
-    switch (channel) {
-        case 0: ram = &_ramCenter; break;
-        case 1: ram = &_ramLeft; break;
-        case 2: ram = &_ramRight; break;
-        default: return;
-    }
+    RamChannel* ram = channelForIndex(channel);
+    if (!ram) return;
     
     *kp = ram->Kp;
     *ki = ram->Ki;
     *kd = ram->Kd;
 }
 
+bool HydraulicController::savePIDGains() {
+    GainsRecord record;
+    record.magic = HYDRAULIC_GAINS_EEPROM_MAGIC;
+    
+    noInterrupts();
+    for (int i = 0; i < 3; i++) {
+        RamChannel* ram = channelForIndex(i);
+        record.gains[i][0] = (float)ram->Kp;
+        record.gains[i][1] = (float)ram->Ki;
+        record.gains[i][2] = (float)ram->Kd;
+    }
+    interrupts();
+    
+    // EEPROM.put() only rewrites the bytes that changed
+    EEPROM.put(HYDRAULIC_GAINS_EEPROM_ADDRESS, record);
+    GainsRecord check;
+    EEPROM.get(HYDRAULIC_GAINS_EEPROM_ADDRESS, check);
+    if (memcmp(&check, &record, sizeof(record)) != 0) {
+        DiagnosticManager::logError("HydraulicController", "PID gains did not read back from EEPROM");
+        return false;
+    }
+    
+    DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", "PID gains saved to EEPROM");
+    return true;
+}
+
+bool HydraulicController::loadPIDGains() {
+    GainsRecord record;
+    EEPROM.get(HYDRAULIC_GAINS_EEPROM_ADDRESS, record);
+    if (record.magic != HYDRAULIC_GAINS_EEPROM_MAGIC) return false;
+    
+    for (int i = 0; i < 3; i++) {
+        for (int term = 0; term < 3; term++) {
+            // Erased flash reads as NaN, which fails this too
+            if (!(record.gains[i][term] >= 0.0f && record.gains[i][term] < 1.0e6f)) {
+                DiagnosticManager::logMessage(LOG_WARNING, "HydraulicController", 
+                    "Saved PID gains invalid - using defaults");
+                return false;
+            }
+        }
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        RamChannel* ram = channelForIndex(i);
+        ram->Kp = record.gains[i][0];
+        ram->Ki = record.gains[i][1];
+        ram->Kd = record.gains[i][2];
+        DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+            ram->name + " PID gains restored from EEPROM - Kp:" + String(ram->Kp, 3) + 
+            ", Ki:" + String(ram->Ki, 3) + ", Kd:" + String(ram->Kd, 3));
+    }
+    return true;
+}
+
+void HydraulicController::forgetPIDGains() {
+    abortAutotune(AUTOTUNE_RESULT_ABORTED);
+    
+    noInterrupts();
+    for (int i = 0; i < 3; i++) {
+        RamChannel* ram = channelForIndex(i);
+        ram->Kp = PID_DEFAULT_KP;
+        ram->Ki = PID_DEFAULT_KI;
+        ram->Kd = PID_DEFAULT_KD;
+    }
+    interrupts();
+    
+    uint32_t erased = 0xFFFFFFFF;
+    EEPROM.put(HYDRAULIC_GAINS_EEPROM_ADDRESS, erased);
+    DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", "Saved PID gains erased - defaults in use");
+}
+
+AutotuneResult_t HydraulicController::startAutotune(uint8_t ramMask, uint16_t targetSettlingMs) {
+    ramMask &= 0x07;
+    if (!_initialized || !_isActiveModule || ramMask == 0) return AUTOTUNE_RESULT_INVALID;
+    if (_autotune.phase != AUTOTUNE_IDLE || _startupHold || _emergencyStop || _levellingMode == LEVELLING_LOCAL) {
+        return AUTOTUNE_RESULT_BUSY;
+    }
+    for (int i = 0; i < 3; i++) {
+        RamChannel* ram = channelForIndex(i);
+        if ((ramMask & (1 << i)) && (!ram->enabled || !ram->inSafeRange)) return AUTOTUNE_RESULT_BUSY;
+    }
+    
+    _autotune.ramMask = ramMask;
+    _autotune.targetSettling = targetSettlingMs / 1000.0f;
+    
+    DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+        "Autotune started - rams 0x" + String(ramMask, HEX) + ", target settling " + 
+        (targetSettlingMs ? String(targetSettlingMs) + "ms" : String("fastest")));
+    beginAutotuneRam();
+    return AUTOTUNE_RESULT_OK;
+}
+
+void HydraulicController::abortAutotune(AutotuneResult_t reason) {
+    if (_autotune.phase == AUTOTUNE_IDLE) return;
+    
+    // Whatever is under test reports this reason; nothing after it runs
+    noInterrupts();
+    _autotune.ramMask = 1 << _autotune.ram;
+    if (_autotune.phase != AUTOTUNE_REPORT) {
+        endAutotuneRam(*channelForIndex(_autotune.ram), reason);
+    }
+    interrupts();
+    
+    finishAutotuneRam();
+}
+
+bool HydraulicController::takeAutotuneReport(AutotuneReportPacket* packet) {
+    for (int i = 0; i < 3; i++) {
+        if (_autotuneReportsPending & (1 << i)) {
+            *packet = _autotuneReports[i];
+            _autotuneReportsPending &= ~(1 << i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void HydraulicController::beginAutotuneRam() {
+    // Lowest channel still to do
+    uint8_t ram = 0;
+    while (!(_autotune.ramMask & (1 << ram))) ram++;
+    RamChannel& channel = *channelForIndex(ram);
+    
+    // Tested where the ram already is, unless that is too near an end stop
+    noInterrupts();
+    double setpoint = channel.setpointPositionPercent;
+    float test = (float)channel.currentPositionPercent;
+    if (test < AUTOTUNE_TEST_MIN_POSITION) test = AUTOTUNE_TEST_MIN_POSITION;
+    if (test > AUTOTUNE_TEST_MAX_POSITION) test = AUTOTUNE_TEST_MAX_POSITION;
+    
+    _autotune.ram = ram;
+    _autotune.result = AUTOTUNE_RESULT_OK;
+    _autotune.restoreSetpoint = setpoint;
+    _autotune.testPosition = test;
+    _autotune.previousKp = channel.Kp;
+    _autotune.previousKi = channel.Ki;
+    _autotune.previousKd = channel.Kd;
+    _autotune.elapsed = 0.0f;
+    _autotune.lastOutside = 0.0f;
+    _autotune.cycles = 0;
+    _autotune.periodSum = 0.0f;
+    _autotune.amplitudeSum = 0.0f;
+    _autotune.ultimateGain = 0.0f;
+    _autotune.ultimatePeriod = 0.0f;
+    _autotune.valveGain = 0.0f;
+    _autotune.deadTime = 0.0f;
+    _autotune.closedLoopTau = 0.0f;
+    _autotune.integralFactor = AUTOTUNE_INTEGRAL_FACTOR;
+    _autotune.attempts = 0;
+    _autotune.riseTime = -1.0f;
+    _autotune.peak = 0.0f;
+    _autotune.restPosition = test;
+    channel.setpointPositionPercent = test;
+    _autotune.phase = AUTOTUNE_MOVE;
+    
+    // Tripped while an earlier ram was under test - the tick skips it
+    if (!channel.enabled || !channel.inSafeRange) {
+        endAutotuneRam(channel, AUTOTUNE_RESULT_SAFETY_TRIP);
+    }
+    interrupts();
+    
+    if (_autotune.phase == AUTOTUNE_REPORT) {
+        finishAutotuneRam();
+        return;
+    }
+    
+    DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+        "Autotune: " + channel.name + " ram, test position " + String(test, 1) + "%");
+}
+
+float HydraulicController::runAutotune(RamChannel& channel, float dt) {
+    // Control tick - no logging. Every phase ends in endAutotuneRam() or
+    // hands on to the next with elapsed reset.
+    _autotune.elapsed += dt;
+    float offset = (float)channel.currentPositionPercent - _autotune.testPosition;
+    
+    switch (_autotune.phase) {
+        case AUTOTUNE_MOVE: {
+            // Near the test position before anything is measured, and at
+            // rest before a step. Untuned gains may stop short or hunt, so
+            // the relay centres on wherever the ram got to - its first
+            // cycle is discarded anyway.
+            float position = (float)channel.currentPositionPercent;
+            bool identified = _autotune.valveGain > 0.0f;
+            if ((identified && fabsf(position - _autotune.restPosition) >= AUTOTUNE_RELAY_HYSTERESIS) ||
+                fabsf(offset) >= AUTOTUNE_MOVE_BAND) {
+                _autotune.restPosition = position;
+                _autotune.lastOutside = _autotune.elapsed;
+                if (_autotune.elapsed > AUTOTUNE_MOVE_TIMEOUT_S) {
+                    endAutotuneRam(channel, AUTOTUNE_RESULT_NOT_REACHED);
+                    return 0.0f;
+                }
+            } else if (!identified) {
+                _autotune.testPosition = position;
+                channel.setpointPositionPercent = position;
+                _autotune.phase = AUTOTUNE_RELAY;
+                _autotune.elapsed = 0.0f;
+                _autotune.relayHigh = true;
+                _autotune.peakHigh = position;
+                _autotune.peakLow = position;
+                _autotune.lastFallTime = -1.0f;
+            } else if (_autotune.elapsed - _autotune.lastOutside >= AUTOTUNE_SETTLE_HOLD_S) {
+                beginAutotuneStep(channel);
+            }
+            return (float)runControlLaw(channel, dt);
+        }
+            
+        case AUTOTUNE_RELAY:
+            return runAutotuneRelay(channel);
+            
+        case AUTOTUNE_STEP:
+            runAutotuneStep(channel);
+            return (float)runControlLaw(channel, dt);
+            
+        default:
+            return (float)runControlLaw(channel, dt);
+    }
+}
+
+float HydraulicController::runAutotuneRelay(RamChannel& channel) {
+    float position = (float)channel.currentPositionPercent;
+    float offset = position - _autotune.testPosition;
+    
+    if (fabsf(offset) > AUTOTUNE_MAX_EXCURSION) {
+        endAutotuneRam(channel, AUTOTUNE_RESULT_EXCURSION);
+        return 0.0f;
+    }
+    if (_autotune.elapsed > AUTOTUNE_RELAY_TIMEOUT_S) {
+        endAutotuneRam(channel, AUTOTUNE_RESULT_NO_OSCILLATION);
+        return 0.0f;
+    }
+    
+    // The ram carries on past each switch by the loop's lag, so the peak
+    // after a switch is final by the next one. Period and amplitude are
+    // taken from one high-to-low switch to the next.
+    if (_autotune.relayHigh) {
+        if (position < _autotune.peakLow) _autotune.peakLow = position;
+        if (offset > AUTOTUNE_RELAY_HYSTERESIS) {
+            if (_autotune.lastFallTime >= 0.0f) {
+                _autotune.cycles++;
+                if (_autotune.cycles > 1) {   // First cycle starts from rest
+                    _autotune.periodSum += _autotune.elapsed - _autotune.lastFallTime;
+                    _autotune.amplitudeSum += 0.5f * (_autotune.peakHigh - _autotune.peakLow);
+                }
+            }
+            _autotune.lastFallTime = _autotune.elapsed;
+            _autotune.peakHigh = position;
+            _autotune.relayHigh = false;
+            
+            if (_autotune.cycles > AUTOTUNE_RELAY_CYCLES) {
+                computeAutotuneGains(channel);
+                return 0.0f;
+            }
+        }
+    } else {
+        if (position > _autotune.peakHigh) _autotune.peakHigh = position;
+        if (offset < -AUTOTUNE_RELAY_HYSTERESIS) {
+            _autotune.peakLow = position;
+            _autotune.relayHigh = true;
+        }
+    }
+    
+    // The PID is bypassed - restart it clean afterwards
+    channel.profileActive = false;
+    return _autotune.relayHigh ? AUTOTUNE_RELAY_OUTPUT : -AUTOTUNE_RELAY_OUTPUT;
+}
+
+void HydraulicController::computeAutotuneGains(RamChannel& channel) {
+    float period = _autotune.periodSum / AUTOTUNE_RELAY_CYCLES;
+    float amplitude = _autotune.amplitudeSum / AUTOTUNE_RELAY_CYCLES;
+    if (period <= 0.0f || amplitude <= AUTOTUNE_RELAY_HYSTERESIS) {
+        endAutotuneRam(channel, AUTOTUNE_RESULT_NO_OSCILLATION);
+        return;
+    }
+    
+    // Relay describing function with hysteresis h on an integrator with
+    // dead time, Kv * e^(-sL) / s:
+    //   Kv = w * pi * a / (4d),  L = (pi/2 - asin(h/a)) / w
+    float omega = 2.0f * (float)PI / period;
+    _autotune.ultimatePeriod = period;
+    _autotune.ultimateGain = 4.0f * AUTOTUNE_RELAY_OUTPUT / ((float)PI * amplitude);
+    _autotune.valveGain = omega * (float)PI * amplitude / (4.0f * AUTOTUNE_RELAY_OUTPUT);
+    _autotune.deadTime = (0.5f * (float)PI - asinf(AUTOTUNE_RELAY_HYSTERESIS / amplitude)) / omega;
+    
+    // Closed-loop time constant from the target (2% settling is about four
+    // of them), never tighter than the dead time
+    float tau = _autotune.targetSettling / 4.0f;
+    if (tau < _autotune.deadTime) tau = _autotune.deadTime;
+    _autotune.closedLoopTau = tau;
+    applyAutotuneGains(channel);
+    
+    // Back to rest on the test position with the new gains, then the step
+    _autotune.phase = AUTOTUNE_MOVE;
+    _autotune.elapsed = 0.0f;
+    _autotune.lastOutside = 0.0f;
+}
+
+void HydraulicController::applyAutotuneGains(RamChannel& channel) {
+    // SIMC PI for an integrating process - derivative only adds noise on an
+    // integrator with dead time. Ki holds Kc/Ti, as both control laws expect.
+    float lag = _autotune.closedLoopTau + _autotune.deadTime;
+    float kc = 1.0f / (_autotune.valveGain * lag);
+    channel.Kp = kc;
+    channel.Ki = kc / (_autotune.integralFactor * lag);
+    channel.Kd = 0.0;
+    
+    // Bumpless restart on the new gains
+    channel.integral = 0.0;
+    channel.previousError = 0.0;
+    channel.profileActive = false;
+}
+
+void HydraulicController::beginAutotuneStep(RamChannel& channel) {
+    // From rest on the test position, toward mid stroke, through the normal
+    // setpoint path - the figures are what the operator will get
+    float direction = (_autotune.testPosition <= 50.0f) ? 1.0f : -1.0f;
+    _autotune.attempts++;
+    _autotune.stepFrom = (float)channel.currentPositionPercent;
+    _autotune.stepTo = _autotune.stepFrom + direction * AUTOTUNE_STEP_PERCENT;
+    _autotune.riseStart = -1.0f;
+    _autotune.riseTime = -1.0f;
+    _autotune.peak = 0.0f;
+    _autotune.elapsed = 0.0f;
+    _autotune.lastOutside = 0.0f;
+    channel.setpointPositionPercent = _autotune.stepTo;
+    _autotune.phase = AUTOTUNE_STEP;
+}
+
+void HydraulicController::runAutotuneStep(RamChannel& channel) {
+    float span = _autotune.stepTo - _autotune.stepFrom;
+    float progress = ((float)channel.currentPositionPercent - _autotune.stepFrom) / span;
+    
+    if (_autotune.riseStart < 0.0f && progress >= 0.1f) _autotune.riseStart = _autotune.elapsed;
+    if (_autotune.riseStart >= 0.0f && _autotune.riseTime < 0.0f && progress >= 0.9f) {
+        _autotune.riseTime = _autotune.elapsed - _autotune.riseStart;
+    }
+    if (progress > _autotune.peak) _autotune.peak = progress;
+    
+    if (fabsf(progress - 1.0f) > AUTOTUNE_SETTLE_FRACTION) {
+        _autotune.lastOutside = _autotune.elapsed;
+        if (_autotune.elapsed > AUTOTUNE_STEP_TIMEOUT_S) {
+            endAutotuneRam(channel, AUTOTUNE_RESULT_NOT_SETTLED);
+        }
+        return;
+    }
+    if (_autotune.riseTime < 0.0f || _autotune.elapsed - _autotune.lastOutside < AUTOTUNE_SETTLE_HOLD_S) return;
+    
+    // Settled - overshoot decides whether these gains stand
+    float overshoot = (_autotune.peak - 1.0f) * 100.0f;
+    if (overshoot <= AUTOTUNE_MAX_OVERSHOOT_PERCENT) {
+        endAutotuneRam(channel, AUTOTUNE_RESULT_OK);
+        return;
+    }
+    if (_autotune.attempts >= AUTOTUNE_MAX_ATTEMPTS) {
+        endAutotuneRam(channel, AUTOTUNE_RESULT_OVERSHOOT);
+        return;
+    }
+    
+    // Overshoot on an integrator comes from the integral zero - a slower
+    // loop alone keeps the same shape, so the integral time grows faster
+    _autotune.closedLoopTau *= AUTOTUNE_DETUNE_FACTOR;
+    _autotune.integralFactor *= 2.0f;
+    applyAutotuneGains(channel);
+    channel.setpointPositionPercent = _autotune.testPosition;
+    _autotune.phase = AUTOTUNE_MOVE;
+    _autotune.elapsed = 0.0f;
+    _autotune.lastOutside = 0.0f;
+}
+
+void HydraulicController::endAutotuneRam(RamChannel& channel, AutotuneResult_t result) {
+    // Control tick, or loop() with interrupts off. A failed ram keeps the
+    // gains it had; either way it goes back where it was.
+    if (result != AUTOTUNE_RESULT_OK) {
+        channel.Kp = _autotune.previousKp;
+        channel.Ki = _autotune.previousKi;
+        channel.Kd = _autotune.previousKd;
+    }
+    channel.setpointPositionPercent = _autotune.restoreSetpoint;
+    channel.integral = 0.0;
+    channel.previousError = 0.0;
+    channel.profileActive = false;
+    
+    _autotune.result = result;
+    _autotune.phase = AUTOTUNE_REPORT;
+}
+
+void HydraulicController::finishAutotuneRam() {
+    // loop() context, once per ram after the tick has let go of it
+    RamChannel& channel = *channelForIndex(_autotune.ram);
+    AutotuneResult_t result = (AutotuneResult_t)_autotune.result;
+    bool saved = (result == AUTOTUNE_RESULT_OK) && savePIDGains();
+    
+    AutotuneReportPacket& report = _autotuneReports[_autotune.ram];
+    memset(&report, 0, sizeof(report));
+    report.Header.Flags = saved ? LEVELLING_FLAG_GAINS_SAVED : 0;
+    report.Ram = _autotune.ram;
+    report.Result = result;
+    report.Attempts = _autotune.attempts;
+    report.Kp = (float)channel.Kp;
+    report.Ki = (float)channel.Ki;
+    report.Kd = (float)channel.Kd;
+    report.UltimateGain = _autotune.ultimateGain;
+    report.UltimatePeriodMs = (uint16_t)lroundf(_autotune.ultimatePeriod * 1000.0f);
+    report.DeadTimeMs = (uint16_t)lroundf(_autotune.deadTime * 1000.0f);
+    report.ValveGain = _autotune.valveGain;
+    report.TargetSettlingMs = (uint16_t)lroundf(_autotune.targetSettling * 1000.0f);
+    if (_autotune.attempts > 0 && _autotune.riseTime >= 0.0f) {
+        float overshoot = (_autotune.peak > 1.0f) ? (_autotune.peak - 1.0f) * 10000.0f : 0.0f;
+        report.RiseTimeMs = (uint16_t)lroundf(_autotune.riseTime * 1000.0f);
+        report.OvershootCentiPercent = (uint16_t)min(overshoot, 65535.0f);
+        report.SettlingTimeMs = (uint16_t)lroundf(_autotune.lastOutside * 1000.0f);
+    }
+    _autotuneReportsPending |= 1 << _autotune.ram;
+    
+    if (result == AUTOTUNE_RESULT_OK) {
+        DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", 
+            "Autotune: " + channel.name + " Kp:" + String(channel.Kp, 3) + ", Ki:" + String(channel.Ki, 3) + 
+            " (Ku " + String(_autotune.ultimateGain, 1) + ", Pu " + String(report.UltimatePeriodMs) + 
+            "ms, dead time " + String(report.DeadTimeMs) + "ms) - rise " + String(report.RiseTimeMs) + 
+            "ms, overshoot " + String(report.OvershootCentiPercent / 100.0f, 1) + "%, settling " + 
+            String(report.SettlingTimeMs) + "ms after " + String(_autotune.attempts) + " steps");
+    } else {
+        DiagnosticManager::logMessage(LOG_WARNING, "HydraulicController", 
+            "Autotune: " + channel.name + " failed (" + autotuneResultToString(result) + ") - previous gains kept");
+    }
+    
+    _autotune.ramMask &= ~(1 << _autotune.ram);
+    if (_autotune.ramMask != 0) {
+        beginAutotuneRam();
+    } else {
+        _autotune.phase = AUTOTUNE_IDLE;
+        DiagnosticManager::logMessage(LOG_INFO, "HydraulicController", "Autotune finished");
+    }
+}
+
+const char* autotuneResultToString(AutotuneResult_t result) {
+    switch (result) {
+        case AUTOTUNE_RESULT_OK:             return "OK";
+        case AUTOTUNE_RESULT_MOVING:         return "machine moving";
+        case AUTOTUNE_RESULT_BUSY:           return "controller busy";
+        case AUTOTUNE_RESULT_ABORTED:        return "aborted";
+        case AUTOTUNE_RESULT_NOT_REACHED:    return "test position not reached";
+        case AUTOTUNE_RESULT_NO_OSCILLATION: return "no relay oscillation";
+        case AUTOTUNE_RESULT_EXCURSION:      return "relay excursion too large";
+        case AUTOTUNE_RESULT_OVERSHOOT:      return "overshoot after every retry";
+        case AUTOTUNE_RESULT_NOT_SETTLED:    return "step did not settle";
+        case AUTOTUNE_RESULT_SAFETY_TRIP:    return "safety trip";
+        case AUTOTUNE_RESULT_INVALID:        return "invalid request";
+        default:                             return "unknown";
+    }
+}
+
 void HydraulicController::updateDiagnostics() {
     // Log channel status for debugging
     logChannelStatus(_ramCenter);
@@ -371,14 +1635,50 @@ void HydraulicController::updateDiagnostics() {
     }
     
     DiagnosticManager::setSystemStatus(status);
+    
+    // Deadline statistics - only noisy when the tick is actually missing
+    if (_controlScheduling == CONTROL_SCHED_TIMER) {
+        uint32_t overruns = _tickOverruns;
+        LogLevel_t level = (overruns != _reportedOverruns) ? LOG_WARNING : LOG_DEBUG;
+        DiagnosticManager::logMessage(level, "HydraulicController", 
+            "Control tick " + String(_controlRateHz) + "Hz - ticks:" + String(_tickCount) + 
+            ", overruns:" + String(overruns) + ", late:" + String(_tickLateStarts) + 
+            ", max:" + String(_tickMaxMicros) + "us");
+        _reportedOverruns = overruns;
+    }
+    
+    DIAG_LOG(LOG_DEBUG, "HydraulicController", 
+        "Commands - processed:" + String(_commandsProcessed) + 
+        ", stale:" + String(_commandsRejectedStale) + 
+        ", last id:" + String(_lastCommandId) + 
+        ", rx->valve:" + String(_appliedMicros - _appliedReceiveMicros) + "us");
+    
+    // Wing height links - only worth a line while the local loop depends on them
+    if (_levellingMode == LEVELLING_LOCAL) {
+        DIAG_LOG(LOG_DEBUG, "HydraulicController", 
+            "Levelling - Left:" + String(_wingLeft.height, 3) + "m/" + String(_levellingTargetLeft, 3) + 
+            "m (" + String(_wingLeft.packets) + " pkts), Right:" + String(_wingRight.height, 3) + 
+            "m/" + String(_levellingTargetRight, 3) + "m (" + String(_wingRight.packets) + " pkts)");
+    }
 }
 
 void HydraulicController::logChannelStatus(const RamChannel& channel) {
-    DiagnosticManager::logMessage(LOG_DEBUG, "HydraulicController", 
+    String reference = "";
+    if (channel.feedForwardPercent != 0.0) {
+        reference += ", FF:" + String(channel.feedForwardPercent, 2) + "%";
+    }
+    if (_controlLaw == CONTROL_LAW_PROFILED) {
+        reference += ", Ref:" + String(channel.profilePosition, 2) + "%";
+    }
+    
+    DIAG_LOG(LOG_DEBUG, "HydraulicController", 
         channel.name + " - Pos:" + String(channel.currentPositionPercent, 1) + 
         "%, Target:" + String(channel.setpointPositionPercent, 1) + 
         "%, ADC:" + String(channel.rawAdcValue) + 
+        " (" + String(channel.adcSampleCount) + " samples)" + 
+        reference + 
         ", PID:" + String(channel.pidOutput, 1) + 
+        ", PWM:" + String(channel.pwmValue) + 
         ", Safe:" + (channel.inSafeRange ? "Y" : "N") + 
         ", En:" + (channel.enabled ? "Y" : "N"));
 }
@@ -5,7 +5,15 @@
  * Controls three hydraulic rams (Centre, Left Wing, Right Wing) using:
  * - Adafruit ADS1115 16-bit ADC for position feedback
  * - PID control loops for smooth, accurate positioning
+ * - Profiled mode: float PID with derivative on measurement, back-calculation
+ *   anti-windup and a rate/jerk-limited setpoint, driving 12-15 bit valve PWM
+ * - Optional local levelling: wing radar heights close the height loop here,
+ *   the Toughbook only supervises target height and enable
  * - Safety limits and error handling
+ * - Startup safe hold: valves neutral from initialize() until every ram has
+ *   feedback, then holding measured position; ADC retried in the background
+ * - Autotune: relay-feedback identification and a step benchmark per ram,
+ *   gains saved to EEPROM and restored at start-up
  * - Only active on Centre module (conditional initialization)
  * 
  * Author: James Hassall @ RobotsGoFarming.com
@@ -18,6 +26,9 @@
 #include <Arduino.h>
 #include "DataPackets.h"
 #include "ModuleConfig.h"
+#include "DeadlineMonitor.h"
+#include "StartupSequencer.h"
+#include "I2CBusGuard.h"
 #include <Adafruit_ADS1X15.h>
 
 // Hydraulic ram configuration
@@ -29,11 +40,159 @@
 #define RAM_LEFT_VALVE_PIN      8
 #define RAM_RIGHT_VALVE_PIN     9
 
+// ADS1115 acquisition
+#define ADS_ALERT_RDY_PIN       23    // ADS1115 ALERT/RDY (pulses low at end of each conversion)
+
+#ifndef ADS_I2C_BUS
+#define ADS_I2C_BUS             I2C_BUS_WIRE  // Ram feedback - serviced at I2C_PRIORITY_CONTROL
+#endif
+
+#ifndef ADS_DEFAULT_DATA_RATE
+#define ADS_DEFAULT_DATA_RATE   RATE_ADS1115_860SPS  // ~290Hz per ram across three channels
+#endif
+
+#define ADS_SAMPLE_STALE_MS     50    // Cached sample older than this is treated as stale
+#define ADS_RDY_TIMEOUT_MS      20    // Restart conversion if RDY goes quiet this long
+#define ADS_INIT_RETRY_MS       2000  // Background retry of a missing ADS1115
+
+typedef enum {
+    ADC_ACQ_SINGLE_SHOT = 0,  // readADC_SingleEnded() per ram inside the control tick
+    ADC_ACQ_CONTINUOUS = 1    // Continuous conversion, mux round-robin on each RDY pulse
+} AdcAcquisitionMode_t;
+
+#ifndef ADS_DEFAULT_ACQUISITION_MODE
+#define ADS_DEFAULT_ACQUISITION_MODE ADC_ACQ_CONTINUOUS
+#endif
+
+// Control scheduling
+#define HYDRAULIC_CONTROL_RATE_MIN_HZ   100
+#define HYDRAULIC_CONTROL_RATE_MAX_HZ   500
+
+#ifndef HYDRAULIC_CONTROL_RATE_HZ
+#define HYDRAULIC_CONTROL_RATE_HZ       200
+#endif
+
+#define HYDRAULIC_TIMER_PRIORITY        64    // Above GPIO/I2C ISRs (default 128)
+#define HYDRAULIC_LOOP_PERIOD_US        20000 // 50Hz when scheduled from loop()
+
+// Command ordering - an older CommandId is dropped unless the Toughbook has
+// been silent this long (it restarted and began counting again)
+#define COMMAND_RESTART_MS              1000
+
+typedef enum {
+    CONTROL_SCHED_LOOP = 0,   // PID runs from loop() at 50Hz with measured dt
+    CONTROL_SCHED_TIMER = 1   // PID runs from IntervalTimer at fixed rate and dt
+} ControlScheduling_t;
+
+#ifndef HYDRAULIC_DEFAULT_SCHEDULING
+#define HYDRAULIC_DEFAULT_SCHEDULING CONTROL_SCHED_TIMER
+#endif
+
+// Control law
+typedef enum {
+    CONTROL_LAW_LEGACY = 0,   // double PID on error, clamped integral, 8-bit PWM
+    CONTROL_LAW_PROFILED = 1  // float PID on measurement, back-calculation, profiled setpoint
+} ControlLaw_t;
+
+#ifndef HYDRAULIC_DEFAULT_CONTROL_LAW
+#define HYDRAULIC_DEFAULT_CONTROL_LAW CONTROL_LAW_PROFILED
+#endif
+
+// Setpoint profile limits (profiled mode) - ram travel in percent of stroke
+#define PROFILE_DEFAULT_MAX_RATE    20.0f   // %/s
+#define PROFILE_DEFAULT_MAX_ACCEL   80.0f   // %/s^2
+#define PROFILE_DEFAULT_MAX_JERK    400.0f  // %/s^3
+#define PROFILE_SETTLE_BAND         0.01f   // Snap to the setpoint inside this (%)
+
+// Profiled PID shaping
+#define PID_ANTIWINDUP_GAIN         2.0f    // Back-calculation tracking gain (1/s)
+#define PID_DERIVATIVE_FILTER_HZ    20.0f   // Low-pass on the measurement derivative
+
+// Valve PWM (profiled mode) - FlexPWM gives full resolution at valve frequencies
+#define VALVE_PWM_RESOLUTION_MIN_BITS   12
+#define VALVE_PWM_RESOLUTION_MAX_BITS   15
+
+#ifndef VALVE_PWM_RESOLUTION_BITS
+#define VALVE_PWM_RESOLUTION_BITS       12
+#endif
+
+#ifndef VALVE_PWM_FREQUENCY_HZ
+#define VALVE_PWM_FREQUENCY_HZ          250     // Proportional valve coil drive
+#endif
+
+#define VALVE_PWM_LEGACY_NEUTRAL        127     // 8-bit neutral (legacy mode)
+
+// Local levelling - wing radar heights drive the ram setpoints directly.
+// Outer loop integrates height error into setpoint moves, so the ram loops
+// above stay in charge of how the rams get there.
+typedef enum {
+    LEVELLING_REMOTE = 0,     // Toughbook ControlCommandPacket setpoints
+    LEVELLING_LOCAL = 1       // Height loop closed on the centre module
+} LevellingMode_t;
+
+#define LEVELLING_UPDATE_INTERVAL_MS        20      // Outer loop rate (radar is 50Hz)
+#define LEVELLING_WING_STALE_MS             150     // Wing height older than this is ignored
+#define LEVELLING_SUPERVISION_TIMEOUT_MS    2000    // Toughbook silence before local mode drops out
+#define LEVELLING_MIN_TARGET_HEIGHT_M       0.20f
+#define LEVELLING_MAX_TARGET_HEIGHT_M       3.00f
+#define LEVELLING_DEADBAND_M                0.02f   // Height error ignored inside this
+#define LEVELLING_MAX_SETPOINT_RATE         15.0f   // %/s - below the profile rate limit
+
+// Gains in ram %/s per metre of height error (need field calibration).
+// A negative gain reverses the ram direction for that loop.
+#ifndef LEVELLING_DEFAULT_CENTRE_GAIN
+#define LEVELLING_DEFAULT_CENTRE_GAIN       25.0f   // Mean height error -> centre ram
+#endif
+
+#ifndef LEVELLING_DEFAULT_WING_GAIN
+#define LEVELLING_DEFAULT_WING_GAIN         30.0f   // Wing-relative error -> wing ram
+#endif
+
+// Autotune - one ram at a time, the others holding. The relay switches the
+// valve about a test position to find the loop's ultimate gain and period,
+// read as an integrator with dead time; gains follow from the target
+// settling time, then a step on the new gains is timed. Overshoot above
+// the limit detunes and steps again.
+#define AUTOTUNE_RELAY_OUTPUT           100.0f  // Relay drive either side of neutral (PID output units)
+#define AUTOTUNE_RELAY_HYSTERESIS       0.3f    // % either side of the test position
+#define AUTOTUNE_RELAY_CYCLES           4       // Oscillations averaged, after the first is discarded
+#define AUTOTUNE_RELAY_TIMEOUT_S        20.0f
+#define AUTOTUNE_MAX_EXCURSION          8.0f    // % from the test position before the ram is given up
+#define AUTOTUNE_TEST_MIN_POSITION      25.0f   // Test position clamped into this part of the stroke
+#define AUTOTUNE_TEST_MAX_POSITION      75.0f
+#define AUTOTUNE_MOVE_BAND              2.0f    // At rest within this of the test position (%)
+#define AUTOTUNE_MOVE_TIMEOUT_S         10.0f   // Reaching the test position
+#define AUTOTUNE_STEP_PERCENT           10.0f   // Benchmark step, toward mid stroke
+#define AUTOTUNE_SETTLE_FRACTION        0.05f   // Settled inside 5% of the step...
+#define AUTOTUNE_SETTLE_HOLD_S          0.5f    // ...for this long
+#define AUTOTUNE_STEP_TIMEOUT_S         10.0f
+#define AUTOTUNE_MAX_OVERSHOOT_PERCENT  10.0f   // Of the step
+#define AUTOTUNE_MAX_ATTEMPTS           4       // Step benchmarks per ram
+#define AUTOTUNE_INTEGRAL_FACTOR        4.0f    // SIMC Ti = 4 (tau + dead time), doubled per retry
+#define AUTOTUNE_DETUNE_FACTOR          1.5f    // Closed-loop time constant growth per retry
+
+typedef enum {
+    AUTOTUNE_IDLE = 0,
+    AUTOTUNE_MOVE,            // Driving to the test position on the current gains
+    AUTOTUNE_RELAY,           // Relay feedback about the test position
+    AUTOTUNE_STEP,            // Timing a step on the new gains
+    AUTOTUNE_REPORT           // Ram finished - loop() reports and moves to the next
+} AutotunePhase_t;
+
+// Persisted gains - GnssConfig owns EEPROM bytes 0-7
+#define HYDRAULIC_GAINS_EEPROM_ADDRESS  16
+#define HYDRAULIC_GAINS_EEPROM_MAGIC    0x52414D47  // "RAMG"
+
 // Safety limits
 #define MIN_POSITION_PERCENT    5.0   // Minimum safe position (5%)
 #define MAX_POSITION_PERCENT    95.0  // Maximum safe position (95%)
 #define DEFAULT_POSITION_PERCENT 50.0 // Default middle position
 
+// Default PID gains, until a ram is autotuned
+#define PID_DEFAULT_KP          2.0
+#define PID_DEFAULT_KI          0.5
+#define PID_DEFAULT_KD          0.1
+
 // PID output limits
 #define PID_OUTPUT_MIN          -255
 #define PID_OUTPUT_MAX          255
@@ -47,21 +206,36 @@ struct RamChannel {
     // Position data
     double currentPositionPercent = DEFAULT_POSITION_PERCENT;
     double setpointPositionPercent = DEFAULT_POSITION_PERCENT;
+    double feedForwardPercent = 0.0;  // Terrain preview offset added to the setpoint
     int16_t rawAdcValue = 0;
+    uint32_t adcSampleTime = 0;   // millis() when rawAdcValue was captured
+    uint32_t adcSampleMicros = 0; // micros() of the same sample, for packet timestamps
+    uint32_t adcSampleCount = 0;
     
-    // PID tuning parameters (will need field tuning)
-    double Kp = 2.0;   // Proportional gain
-    double Ki = 0.5;   // Integral gain  
-    double Kd = 0.1;   // Derivative gain
+    // PID gains - defaults until autotuned, then restored from EEPROM
+    double Kp = PID_DEFAULT_KP;   // Proportional gain
+    double Ki = PID_DEFAULT_KI;   // Integral gain  
+    double Kd = PID_DEFAULT_KD;   // Derivative gain
     
     // PID internal variables
     double integral = 0.0;
     double previousError = 0.0;
     double pidOutput = 0.0;
     
+    // Profiled controller state (float, control tick only)
+    bool profileActive = false;         // Cleared to restart bumpless from the measurement
+    float profilePosition = 0.0f;       // Reference the PID tracks (%)
+    float profileVelocity = 0.0f;       // %/s
+    float profileAccel = 0.0f;          // %/s^2
+    float integralTerm = 0.0f;          // Ki-weighted integrator, in output units
+    float previousMeasurement = 0.0f;
+    float derivativeFiltered = 0.0f;    // d(measurement)/dt after low-pass (%/s)
+    
     // Safety and status
     bool enabled = true;
     bool inSafeRange = true;
+    bool safetyTripPending = false;  // Set in control tick, reported from loop()
+    int pwmValue = VALVE_PWM_LEGACY_NEUTRAL;
     uint32_t lastUpdateTime = 0;
     
     // Constructor
@@ -69,18 +243,72 @@ struct RamChannel {
         adcChannel(adc), valvePin(pin), name(n) {}
 };
 
+// Latest height report from one wing module
+struct WingHeight {
+    float height = 0.0f;            // Metres above ground, tilt compensated
+    float roll = 0.0f;              // Degrees
+    float pitch = 0.0f;
+    bool valid = false;             // Radar valid in the last report
+    uint32_t sequence = 0;
+    uint32_t receivedMillis = 0;
+    uint32_t packets = 0;
+    uint32_t outOfOrder = 0;
+};
+
+// Autotune progress - written by the control tick while a ram is under test
+struct AutotuneState {
+    volatile AutotunePhase_t phase = AUTOTUNE_IDLE;
+    volatile uint8_t result = AUTOTUNE_RESULT_OK;   // AutotuneResult_t, set before AUTOTUNE_REPORT
+    uint8_t ramMask = 0;            // Rams still to tune, bit per channel
+    uint8_t ram = 0;                // Channel under test
+    float targetSettling = 0.0f;    // s, 0 = fastest the loop allows
+    double restoreSetpoint = 0.0;   // Where the ram goes back to afterwards
+    float testPosition = 0.0f;      // %
+    float elapsed = 0.0f;           // s in the current phase
+    float restPosition = 0.0f;      // Where the ram is settling, while moving
+    double previousKp = 0.0, previousKi = 0.0, previousKd = 0.0;
+    
+    // Relay
+    bool relayHigh = false;
+    float peakHigh = 0.0f;
+    float peakLow = 0.0f;
+    float lastFallTime = -1.0f;     // Elapsed at the last high-to-low switch
+    uint8_t cycles = 0;
+    float periodSum = 0.0f;
+    float amplitudeSum = 0.0f;
+    float ultimateGain = 0.0f;      // Output units per %
+    float ultimatePeriod = 0.0f;    // s
+    float valveGain = 0.0f;         // %/s per output unit
+    float deadTime = 0.0f;          // s
+    float closedLoopTau = 0.0f;     // s
+    float integralFactor = 0.0f;    // Ti in units of closed-loop tau plus dead time
+    
+    // Step benchmark
+    uint8_t attempts = 0;
+    float stepFrom = 0.0f;
+    float stepTo = 0.0f;
+    float riseStart = -1.0f;        // Elapsed at 10% of the step
+    float riseTime = -1.0f;         // 10-90%
+    float peak = 0.0f;              // Furthest travel past stepFrom, in the step direction
+    float lastOutside = 0.0f;       // Elapsed when last outside the settling band
+};
+
 class HydraulicController {
 public:
     HydraulicController();
     
-    // Initialization and lifecycle
-    bool initialize();
+    // Initialization and lifecycle - initialize() puts the valves in the startup
+    // hold and never fails; update() retries the ADC until the hold can release
+    void initialize();
     void update();
     bool isInitialized() { return _initialized; }
+    bool isStartupHoldActive() { return _startupHold; }
+    StageState_t getStartupState();
     
     // Command processing
-    void processCommand(const ControlCommandPacket& command);
+    void processCommand(const ControlCommandPacket& command, uint32_t receiveMicros);
     void setSetpoints(double centerPercent, double leftPercent, double rightPercent);
+    void setFeedForward(double centerPercent, double leftPercent, double rightPercent);
     void emergencyStop();
     void resume();
     
@@ -92,46 +320,223 @@ public:
     String getStatusString();
     void enableChannel(int channel, bool enable);
     
+    // ADC acquisition configuration (call before initialize())
+    void setAdcAcquisitionMode(AdcAcquisitionMode_t mode) { _adcAcquisitionMode = mode; }
+    void setAdcDataRate(uint16_t rate) { _adcDataRate = rate; }
+    AdcAcquisitionMode_t getAdcAcquisitionMode() { return _adcAcquisitionMode; }
+    uint32_t getAdcStaleSamples() { return _adcStaleSamples; }
+    uint32_t getAdcRestarts() { return _adcRestarts; }
+    
+    // Control scheduling (call before initialize())
+    void setControlScheduling(ControlScheduling_t scheduling) { _controlScheduling = scheduling; }
+    void setControlRate(uint16_t rateHz);
+    ControlScheduling_t getControlScheduling() { return _controlScheduling; }
+    uint16_t getControlRate() { return _controlRateHz; }
+    
+    // Control deadline statistics
+    uint32_t getControlTickCount() { return _tickCount; }
+    uint32_t getControlOverruns() { return _tickOverruns; }
+    uint32_t getControlLateStarts() { return _tickLateStarts; }
+    uint32_t getControlMaxTickMicros() { return _tickMaxMicros; }
+    DeadlineMonitor& getTickDeadline() { return _tickDeadline; }
+    
+    // Command statistics
+    uint32_t getCommandsProcessed() { return _commandsProcessed; }
+    uint32_t getCommandsRejectedStale() { return _commandsRejectedStale; }
+    
+    // Control law and valve output (call before initialize())
+    void setControlLaw(ControlLaw_t law) { _controlLaw = law; }
+    void setValvePwm(uint8_t resolutionBits, float frequencyHz);
+    ControlLaw_t getControlLaw() { return _controlLaw; }
+    uint8_t getValvePwmResolution() { return _pwmResolutionBits; }
+    
+    // Setpoint profile limits (profiled mode)
+    void setProfileLimits(float maxRate, float maxAccel, float maxJerk);
+    
+    // Local levelling (wing heights and supervision arrive from NetworkManager)
+    void processWingHeight(const WingHeightPacket& packet);
+    void processLevellingSupervision(const LevellingSupervisionPacket& packet);
+    void setLevellingGains(float centreGain, float wingGain);
+    LevellingMode_t getLevellingMode() { return _levellingMode; }
+    const WingHeight& getWingHeight(bool left) { return left ? _wingLeft : _wingRight; }
+    uint32_t getLevellingDropouts() { return _levellingDropouts; }
+    
     // PID tuning (for field calibration)
     void setPIDGains(int channel, double kp, double ki, double kd);
     void getPIDGains(int channel, double* kp, double* ki, double* kd);
+    bool savePIDGains();            // All three rams' gains to EEPROM
+    void forgetPIDGains();          // Back to the defaults, EEPROM record erased
+    
+    // Autotune - the caller checks the machine is stationary first. A ram's
+    // report is ready from takeAutotuneReport() once it finishes.
+    AutotuneResult_t startAutotune(uint8_t ramMask, uint16_t targetSettlingMs);
+    void abortAutotune(AutotuneResult_t reason);
+    bool isAutotuneActive() { return _autotune.phase != AUTOTUNE_IDLE; }
+    bool takeAutotuneReport(AutotuneReportPacket* packet);
 
 private:
+    friend class Benchmark;     // Times the private hot paths on scratch state
+    
     // Initialization state
     bool _initialized;
     bool _adcInitialized;
     bool _emergencyStop;
     
+    // Startup hold - released by the control tick once feedback is available
+    volatile bool _startupHold;
+    volatile bool _startupHoldReleased;     // Logged from loop()
+    volatile bool _setpointsCommanded;      // Release keeps these instead of the measurement
+    uint16_t _adcFailures;
+    uint32_t _lastAdcAttempt;
+    
     // Module role check
+#if ABLS_ROLE_FIXED
+    static constexpr ModuleRole_t _moduleRole = ModuleConfig::getBuildRole();
+    static constexpr bool _isActiveModule = ModuleConfig::isCentreBuild();
+#else
     ModuleRole_t _moduleRole;
     bool _isActiveModule; // Only centre module has hydraulic control
+#endif
     
     // Hardware
     Adafruit_ADS1115 _ads;  // 16-bit ADC for position feedback
     
+    // Continuous-conversion acquisition state
+    static HydraulicController* _instance; // Static instance pointer for ISR access
+    AdcAcquisitionMode_t _adcAcquisitionMode;
+    uint16_t _adcDataRate;
+    RamChannel* _adcScanOrder[3];
+    uint8_t _adcScanIndex;          // Channel currently being converted
+    volatile bool _adcReady;        // Set by RDY ISR, cleared by serviceADC()
+    uint32_t _lastAdcConversion;
+    uint32_t _adcStaleSamples;
+    uint32_t _adcRestarts;
+    
     // Ram channels
     RamChannel _ramCenter;
     RamChannel _ramLeft;
     RamChannel _ramRight;
     
+    // Control law and valve PWM
+    ControlLaw_t _controlLaw;
+    uint8_t _pwmResolutionBits;
+    float _pwmFrequencyHz;
+    int _pwmMax;
+    int _pwmNeutral;
+    float _profileMaxRate;
+    float _profileMaxAccel;
+    float _profileMaxJerk;
+    
+    // Local levelling
+    LevellingMode_t _levellingMode;
+    WingHeight _wingLeft;
+    WingHeight _wingRight;
+    float _levellingTargetLeft;     // Metres
+    float _levellingTargetRight;
+    float _levellingCentreGain;
+    float _levellingWingGain;
+    uint32_t _lastSupervision;
+    uint32_t _lastLevellingUpdate;
+    uint32_t _levellingDropouts;    // Local mode abandoned on supervision timeout
+    
+    // Autotune and saved gains
+    struct GainsRecord {
+        uint32_t magic;
+        float gains[3][3];          // Kp, Ki, Kd per channel
+    };
+    AutotuneState _autotune;
+    AutotuneReportPacket _autotuneReports[3];
+    uint8_t _autotuneReportsPending;    // Bit per channel
+    
+    // Control scheduler
+    ControlScheduling_t _controlScheduling;
+    uint16_t _controlRateHz;
+    uint32_t _controlPeriodMicros;
+    double _controlDt;              // Fixed dt in timer mode (seconds)
+    IntervalTimer _controlTimer;
+    bool _controlTimerRunning;
+    
+    // Deadline monitoring (written by control tick)
+    volatile uint32_t _tickCount;
+    volatile uint32_t _tickOverruns;     // Tick body took longer than one period
+    volatile uint32_t _tickLateStarts;   // Tick started > 1.5 periods after the last
+    volatile uint32_t _tickMaxMicros;
+    uint32_t _lastTickMicros;
+    DeadlineMonitor _tickDeadline;       // Period/jitter: observed in timer mode, scheduled in loop mode
+    uint32_t _reportedOverruns;
+    uint32_t _reportedAdcRestarts;
+    
     // Timing
     uint32_t _lastUpdate;
     uint32_t _lastDiagnosticUpdate;
     
+    // Command ordering and echo - pending is handed to the control tick,
+    // which marks it applied on the first tick that uses its setpoints
+    bool _haveCommand;
+    uint32_t _lastCommandId;
+    uint32_t _lastCommandMillis;
+    volatile uint32_t _pendingCommandSerial;
+    volatile uint32_t _pendingCommandId;
+    volatile uint32_t _pendingCommandMicros;
+    volatile uint32_t _appliedCommandSerial;
+    volatile uint32_t _appliedCommandId;
+    volatile uint32_t _appliedReceiveMicros;
+    volatile uint32_t _appliedMicros;
+    
     // Statistics
     uint32_t _commandsProcessed;
+    uint32_t _commandsRejectedStale;
     uint32_t _safetyViolations;
     
     // Internal methods
     bool initializeADC();
+    void retryADC(uint32_t now);
+    void serviceStartupHold();
+    void startContinuousConversion();
+    void serviceADC();
+    static void adcReadyHandler();
+    static void adcBusService();
+    static uint16_t muxForChannel(uint8_t adcChannel);
     void initializePins();
-    void updateChannel(RamChannel& channel);
+    bool startControlTimer();
+    static void controlTickHandler();
+    void runControlTick();
+    void reportDeferredEvents();
+    void markCommandApplied();
+    uint32_t oldestRamSampleMicros();   // Call with interrupts off or from the tick
+    void updateChannel(RamChannel& channel, double dt);
+    double runControlLaw(RamChannel& channel, double dt);
     double runPID(RamChannel& channel, double dt);
+    float runProfiledPID(RamChannel& channel, float dt);
+    void updateSetpointProfile(RamChannel& channel, float dt);
+    void resetProfile(RamChannel& channel);
+    void writeValve(RamChannel& channel, int pwmValue);
+    void setAllValvesNeutral();
     void applyPIDOutput(RamChannel& channel, double pidOutput);
+    double targetPosition(const RamChannel& channel);
+    void recordChannel(const RamChannel& channel);
+    void recordCommand(const ControlCommandPacket& command, uint32_t receiveMicros, bool accepted);
     double readChannelPosition(RamChannel& channel);
     bool isPositionSafe(double positionPercent);
     void logChannelStatus(const RamChannel& channel);
     void updateDiagnostics();
+    void updateLocalLevelling(uint32_t now);
+    bool wingHeightFresh(const WingHeight& wing, uint32_t now);
+    void setLevellingMode(LevellingMode_t mode, const String& reason);
+    void moveSetpoint(RamChannel& channel, float ratePercentPerSecond, float dt);
+    RamChannel* channelForIndex(int channel);
+    bool loadPIDGains();
+    void beginAutotuneRam();
+    void finishAutotuneRam();
+    float runAutotune(RamChannel& channel, float dt);
+    float runAutotuneRelay(RamChannel& channel);
+    void computeAutotuneGains(RamChannel& channel);
+    void applyAutotuneGains(RamChannel& channel);
+    void beginAutotuneStep(RamChannel& channel);
+    void runAutotuneStep(RamChannel& channel);
+    void endAutotuneRam(RamChannel& channel, AutotuneResult_t result);
 };
 
+const char* autotuneResultToString(AutotuneResult_t result);
+
 #endif // HYDRAULIC_CONTROLLER_H
@@ -0,0 +1,138 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * I2C Bus Guard Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "I2CBusGuard.h"
+
+#define I2C_PRIORITY_ALL    ((uint8_t)((1 << I2C_PRIORITY_COUNT) - 1))
+
+// Static member initialization
+volatile uint8_t I2CBusGuard::_depth[I2C_BUS_COUNT] = {};
+volatile uint8_t I2CBusGuard::_pending[I2C_BUS_COUNT] = {};
+volatile uint32_t I2CBusGuard::_deferredCount[I2C_BUS_COUNT] = {};
+I2CBusService I2CBusGuard::_services[I2C_BUS_COUNT][I2C_PRIORITY_COUNT] = {};
+I2CPriority_t I2CBusGuard::_holderPriority[I2C_BUS_COUNT] = {};
+uint32_t I2CBusGuard::_holdStartMicros[I2C_BUS_COUNT] = {};
+uint32_t I2CBusGuard::_maxHoldMicros[I2C_BUS_COUNT][I2C_PRIORITY_COUNT] = {};
+uint8_t I2CBusGuard::_begun = 0;
+
+TwoWire& I2CBusGuard::wire(I2CBusId_t bus) {
+    switch (bus) {
+        case I2C_BUS_WIRE1: return Wire1;
+        case I2C_BUS_WIRE2: return Wire2;
+        default:            return Wire;
+    }
+}
+
+void I2CBusGuard::beginBus(I2CBusId_t bus) {
+    if (_begun & (1 << bus)) {
+        return;
+    }
+    _begun |= (1 << bus);
+
+    wire(bus).begin();
+    restoreClock(bus);
+}
+
+void I2CBusGuard::restoreClock(I2CBusId_t bus) {
+    wire(bus).setClock(I2C_BUS_CLOCK_HZ);
+}
+
+void I2CBusGuard::acquire(I2CBusId_t bus, I2CPriority_t priority) {
+    // A single store is atomic with respect to the ISR: an ISR either ran
+    // to completion before this point or will see the bus as busy
+    if (_depth[bus] == 0) {
+        _holderPriority[bus] = priority;
+        _holdStartMicros[bus] = micros();
+    }
+    _depth[bus] = _depth[bus] + 1;
+}
+
+void I2CBusGuard::release(I2CBusId_t bus) {
+    if (_depth[bus] > 1) {
+        _depth[bus] = _depth[bus] - 1;
+        return;
+    }
+
+    uint32_t held = micros() - _holdStartMicros[bus];
+    if (held > _maxHoldMicros[bus][_holderPriority[bus]]) {
+        _maxHoldMicros[bus][_holderPriority[bus]] = held;
+    }
+
+    // Outermost release - run everything queued by ISRs while we held the
+    // bus, most urgent first. Keep ownership while they run so an ISR
+    // defers again rather than colliding with them.
+    while (true) {
+        noInterrupts();
+        if (_pending[bus] == 0) {
+            _depth[bus] = 0;
+            interrupts();
+            return;
+        }
+        interrupts();
+
+        runPending(bus, I2C_PRIORITY_ALL);
+    }
+}
+
+void I2CBusGuard::yieldTo(I2CBusId_t bus, I2CPriority_t priority) {
+    // Only classes more urgent than the holder - equal or lower work waits
+    // for the release
+    runPending(bus, (uint8_t)((1 << priority) - 1));
+}
+
+void I2CBusGuard::runPending(I2CBusId_t bus, uint8_t mask) {
+    while (true) {
+        noInterrupts();
+        uint8_t ready = _pending[bus] & mask;
+        if (ready == 0) {
+            interrupts();
+            return;
+        }
+
+        uint8_t priority = 0;
+        while (!(ready & (1 << priority))) {
+            priority++;
+        }
+        _pending[bus] = _pending[bus] & ~(1 << priority);
+        interrupts();
+
+        I2CBusService service = _services[bus][priority];
+        if (service != nullptr) {
+            service();
+        }
+    }
+}
+
+bool I2CBusGuard::tryAcquireFromISR(I2CBusId_t bus) {
+    if (_depth[bus] > 0) {
+        return false;
+    }
+    _depth[bus] = 1;
+    return true;
+}
+
+void I2CBusGuard::releaseFromISR(I2CBusId_t bus) {
+    _depth[bus] = 0;
+}
+
+void I2CBusGuard::setDeferredService(I2CBusId_t bus, I2CPriority_t priority, I2CBusService service) {
+    _services[bus][priority] = service;
+}
+
+void I2CBusGuard::requestDeferredService(I2CBusId_t bus, I2CPriority_t priority) {
+    _pending[bus] = _pending[bus] | (1 << priority);
+    _deferredCount[bus] = _deferredCount[bus] + 1;
+}
+
+void I2CBusGuard::resetHoldStats() {
+    for (int bus = 0; bus < I2C_BUS_COUNT; bus++) {
+        for (int priority = 0; priority < I2C_PRIORITY_COUNT; priority++) {
+            _maxHoldMicros[bus][priority] = 0;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * I2C Bus Guard
+ *
+ * Schedules each I2C bus (Wire, Wire1, Wire2) between foreground code
+ * (radar, ADC, OLED) and interrupt-driven readers (ram ADC in the control
+ * tick, BNO080 INT handler):
+ * - Foreground code holds a bus with I2CBusLock for each transaction
+ * - An ISR that finds its bus busy queues its work as a deferred service
+ * - Deferred services run in priority order (control > IMU > radar >
+ *   display) as soon as the holder releases the bus, or at the yield
+ *   points a long transfer such as an OLED frame push offers between chunks
+ * - Devices are mapped onto buses at build time (*_I2C_BUS defines), so
+ *   the display can be moved off the control bus entirely
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef I2C_BUS_GUARD_H
+#define I2C_BUS_GUARD_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Teensy 4.1 LPI2C ports
+typedef enum {
+    I2C_BUS_WIRE = 0,       // SDA 18 / SCL 19
+    I2C_BUS_WIRE1 = 1,      // SDA 17 / SCL 16
+    I2C_BUS_WIRE2 = 2,      // SDA 25 / SCL 24
+    I2C_BUS_COUNT
+} I2CBusId_t;
+
+// Transaction priority classes, most urgent first
+typedef enum {
+    I2C_PRIORITY_CONTROL = 0,   // Ram position feedback
+    I2C_PRIORITY_IMU,
+    I2C_PRIORITY_RADAR,
+    I2C_PRIORITY_DISPLAY,
+    I2C_PRIORITY_COUNT
+} I2CPriority_t;
+
+#ifndef I2C_BUS_CLOCK_HZ
+#define I2C_BUS_CLOCK_HZ    400000  // Every device on the boom fits 400kHz fast mode
+#endif
+
+// Deferred bus service (runs with the bus held, never re-entered)
+typedef void (*I2CBusService)();
+
+class I2CBusGuard {
+public:
+    // Bus selection - each device's bus comes from its *_I2C_BUS define
+    static TwoWire& wire(I2CBusId_t bus);
+    static void beginBus(I2CBusId_t bus);      // Idempotent - first caller starts the port
+    static void restoreClock(I2CBusId_t bus);  // After a library begin() that restarted the port at 100kHz
+
+    // Foreground bus ownership (nestable); priority is the holder's class
+    static void acquire(I2CBusId_t bus, I2CPriority_t priority);
+    static void release(I2CBusId_t bus);
+
+    // Run queued services more urgent than priority without giving up the
+    // bus - call between transactions of a long transfer
+    static void yieldTo(I2CBusId_t bus, I2CPriority_t priority);
+
+    // Interrupt-side access
+    static bool tryAcquireFromISR(I2CBusId_t bus);
+    static void releaseFromISR(I2CBusId_t bus);
+
+    // Deferred service registration, one per bus and priority class
+    static void setDeferredService(I2CBusId_t bus, I2CPriority_t priority, I2CBusService service);
+    static void requestDeferredService(I2CBusId_t bus, I2CPriority_t priority);
+
+    // Status
+    static bool isBusy(I2CBusId_t bus) { return _depth[bus] > 0; }
+    static uint32_t getDeferredCount(I2CBusId_t bus) { return _deferredCount[bus]; }
+    static uint32_t getMaxHoldMicros(I2CBusId_t bus, I2CPriority_t priority) { return _maxHoldMicros[bus][priority]; }
+    static void resetHoldStats();
+
+private:
+    static volatile uint8_t _depth[I2C_BUS_COUNT];
+    static volatile uint8_t _pending[I2C_BUS_COUNT];       // Bit per priority class
+    static volatile uint32_t _deferredCount[I2C_BUS_COUNT];
+    static I2CBusService _services[I2C_BUS_COUNT][I2C_PRIORITY_COUNT];
+    static I2CPriority_t _holderPriority[I2C_BUS_COUNT];
+    static uint32_t _holdStartMicros[I2C_BUS_COUNT];
+    static uint32_t _maxHoldMicros[I2C_BUS_COUNT][I2C_PRIORITY_COUNT];
+    static uint8_t _begun;                                  // Bit per bus
+
+    static void runPending(I2CBusId_t bus, uint8_t mask);
+};
+
+// Scoped foreground ownership of one I2C bus
+class I2CBusLock {
+public:
+    I2CBusLock(I2CBusId_t bus, I2CPriority_t priority) : _bus(bus) { I2CBusGuard::acquire(bus, priority); }
+    ~I2CBusLock() { I2CBusGuard::release(_bus); }
+
+    I2CBusLock(const I2CBusLock&) = delete;
+    I2CBusLock& operator=(const I2CBusLock&) = delete;
+
+private:
+    I2CBusId_t _bus;
+};
+
+#endif // I2C_BUS_GUARD_H
@@ -0,0 +1,90 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * IMU Sample Ring Buffer
+ *
+ * Lock-free single-producer/single-consumer ring of timestamped BNO080
+ * samples. The INT-pin ISR is the only producer and SensorManager's
+ * foreground drain is the only consumer, so no interrupt masking is
+ * needed on either side.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef IMU_SAMPLE_RING_H
+#define IMU_SAMPLE_RING_H
+
+#include <Arduino.h>
+
+// Ring capacity - must be a power of two. 64 samples = 160ms at the 400Hz
+// batched rate, far longer than any loop() stall we expect.
+#define IMU_SAMPLE_RING_SIZE    64
+
+// Data memory barrier between payload and index/sequence stores
+#ifndef MEMORY_BARRIER
+#define MEMORY_BARRIER() asm volatile("dmb" ::: "memory")
+#endif
+
+// A single timestamped IMU reading captured in interrupt context
+struct ImuSample {
+    uint32_t timestampMicros = 0;   // micros() at the INT falling edge
+    uint16_t reportId = 0;          // SH-2 report that triggered the sample
+    uint32_t accelMicros = 0;       // Batched mode: SH-2 time of the carried accelerations
+
+    // Orientation (rotation vector quaternion)
+    float quatI = 0.0f, quatJ = 0.0f, quatK = 0.0f, quatReal = 1.0f;
+
+    // Raw, gravity-compensated and angular rates
+    float accelX = 0.0f, accelY = 0.0f, accelZ = 0.0f;
+    float linAccelX = 0.0f, linAccelY = 0.0f, linAccelZ = 0.0f;
+    float gyroX = 0.0f, gyroY = 0.0f, gyroZ = 0.0f;
+
+    // Accuracy status (0=Unreliable, 3=High)
+    uint8_t quatAccuracy = 0;
+    uint8_t accelAccuracy = 0;
+    uint8_t gyroAccuracy = 0;
+    uint8_t linAccelAccuracy = 0;
+};
+
+class ImuSampleRing {
+public:
+    ImuSampleRing() : _head(0), _tail(0), _dropped(0) {}
+
+    // Producer side (ISR only). Returns false and counts a drop when full.
+    bool push(const ImuSample& sample) {
+        uint32_t head = _head;
+        if (head - _tail >= IMU_SAMPLE_RING_SIZE) {
+            _dropped = _dropped + 1;
+            return false;
+        }
+        _samples[head & (IMU_SAMPLE_RING_SIZE - 1)] = sample;
+        // Publish the sample before the index that makes it visible
+        MEMORY_BARRIER();
+        _head = head + 1;
+        return true;
+    }
+
+    // Consumer side (foreground only). Returns false when empty.
+    bool pop(ImuSample& sample) {
+        uint32_t tail = _tail;
+        if (tail == _head) {
+            return false;
+        }
+        MEMORY_BARRIER();
+        sample = _samples[tail & (IMU_SAMPLE_RING_SIZE - 1)];
+        MEMORY_BARRIER();
+        _tail = tail + 1;
+        return true;
+    }
+
+    uint32_t available() const { return _head - _tail; }
+    uint32_t getDroppedCount() const { return _dropped; }
+
+private:
+    ImuSample _samples[IMU_SAMPLE_RING_SIZE];
+    volatile uint32_t _head;        // Written by producer only
+    volatile uint32_t _tail;        // Written by consumer only
+    volatile uint32_t _dropped;     // Written by producer only
+};
+
+#endif // IMU_SAMPLE_RING_H
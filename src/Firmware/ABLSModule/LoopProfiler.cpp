@@ -0,0 +1,133 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Loop Profiler Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "LoopProfiler.h"
+#include "DiagnosticManager.h"
+
+// Indexed by ProfileProbe_t
+static const char* const PROBE_NAMES[PROBE_COUNT] = {
+    "loop",
+    "sensor",
+    "sensor.gps",
+    "sensor.imu",
+    "sensor.radar",
+    "network",
+    "hydraulic",
+    "hydraulic.tick",
+    "terrain",
+    "display",
+    "ota",
+    "log",
+    "recorder"
+};
+
+// Static member initialization
+bool LoopProfiler::_initialized = false;
+ProbeStats LoopProfiler::_stats[PROBE_COUNT];
+uint32_t LoopProfiler::_reportSequence = 0;
+uint32_t LoopProfiler::_resetMillis = 0;
+
+void LoopProfiler::initialize() {
+    // Teensyduino starts CYCCNT at boot; make sure the trace block stays on
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
+    reset();
+    _initialized = true;
+
+    DiagnosticManager::logMessage(LOG_INFO, "LoopProfiler",
+        String(PROBE_COUNT) + " probes on DWT CYCCNT at " + String(F_CPU_ACTUAL / 1000000) + "MHz");
+}
+
+void LoopProfiler::record(ProfileProbe_t probe, uint32_t cycles) {
+    if (!_initialized || probe >= PROBE_COUNT) return;
+
+    // Each probe has a single writer, so no locking on the hot path
+    ProbeStats& stats = _stats[probe];
+    if (stats.count == 0 || cycles < stats.minCycles) stats.minCycles = cycles;
+    if (cycles > stats.maxCycles) stats.maxCycles = cycles;
+    stats.count++;
+    stats.totalCycles += cycles;
+
+    int bin = (31 - __builtin_clz(cycles | 1)) - PROFILE_HISTOGRAM_FIRST_BIT;
+    if (bin < 0) bin = 0;
+    if (bin >= PROFILE_HISTOGRAM_BINS) bin = PROFILE_HISTOGRAM_BINS - 1;
+    stats.histogram[bin]++;
+}
+
+void LoopProfiler::getStats(ProfileProbe_t probe, ProbeStats* stats) {
+    if (!stats || probe >= PROBE_COUNT) return;
+
+    // The control tick probe is written from its ISR
+    noInterrupts();
+    *stats = _stats[probe];
+    interrupts();
+}
+
+void LoopProfiler::reset() {
+    noInterrupts();
+    memset(_stats, 0, sizeof(_stats));
+    interrupts();
+    _resetMillis = millis();
+}
+
+const char* LoopProfiler::probeName(ProfileProbe_t probe) {
+    return (probe < PROBE_COUNT) ? PROBE_NAMES[probe] : "unknown";
+}
+
+size_t LoopProfiler::buildReport(uint8_t* buffer, size_t size, uint8_t senderId) {
+    size_t length = sizeof(ProfileReportHeader) + PROBE_COUNT * sizeof(ProfileProbeRecord);
+    if (!buffer || size < length) return 0;
+
+    ProfileReportHeader header;
+    header.Magic = PROFILE_PACKET_MAGIC;
+    header.Version = PROFILE_PACKET_VERSION;
+    header.MessageType = PROFILE_MSG_REPORT;
+    header.SenderId = senderId;
+    header.ProbeCount = PROBE_COUNT;
+    header.HistogramBins = PROFILE_HISTOGRAM_BINS;
+    header.HistogramFirstBit = PROFILE_HISTOGRAM_FIRST_BIT;
+    header.CpuHz = F_CPU_ACTUAL;
+    header.Sequence = ++_reportSequence;
+    header.WindowMillis = millis() - _resetMillis;
+    memcpy(buffer, &header, sizeof(header));
+
+    uint8_t* out = buffer + sizeof(header);
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        ProbeStats stats;
+        getStats((ProfileProbe_t)i, &stats);
+
+        ProfileProbeRecord record;
+        record.ProbeId = i;
+        record.Reserved = 0;
+        record.Count = stats.count;
+        record.MinCycles = stats.minCycles;
+        record.MaxCycles = stats.maxCycles;
+        record.MeanCycles = stats.count ? (uint32_t)(stats.totalCycles / stats.count) : 0;
+        for (int bin = 0; bin < PROFILE_HISTOGRAM_BINS; bin++) {
+            record.Histogram[bin] = (stats.histogram[bin] > 0xFFFF) ? 0xFFFF : stats.histogram[bin];
+        }
+
+        memcpy(out, &record, sizeof(record));
+        out += sizeof(record);
+    }
+
+    return length;
+}
+
+String LoopProfiler::getStatusString() {
+    if (!_initialized) return "Not initialized";
+
+    ProbeStats loop;
+    getStats(PROBE_LOOP, &loop);
+    if (loop.count == 0) return "No samples";
+
+    uint32_t cyclesPerMicro = F_CPU_ACTUAL / 1000000;
+    uint32_t meanMicros = (uint32_t)(loop.totalCycles / loop.count) / cyclesPerMicro;
+    return "Loop avg " + String(meanMicros) + "us, max " + String(loop.maxCycles / cyclesPerMicro) + "us";
+}
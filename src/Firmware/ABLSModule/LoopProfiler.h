@@ -0,0 +1,96 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Loop Profiler
+ *
+ * Cycle-accurate timing of every subsystem update on the Cortex-M7:
+ * - PROFILE_SCOPE() probes read the DWT cycle counter on entry and exit
+ * - Per-probe count, min, max, mean and a log2 histogram of cycles
+ * - Recording is a few dozen cycles, safe from the control tick ISR
+ * - Exported as one binary datagram on request (PROFILER_PORT)
+ * - Build with PROFILER_ENABLED 0 to compile every probe away
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include "DataPackets.h"
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED    1
+#endif
+
+// Probe points - keep in step with the name table in LoopProfiler.cpp.
+// Each probe must only ever be recorded from one context.
+typedef enum {
+    PROBE_LOOP = 0,             // Whole loop() pass
+    PROBE_SENSOR_UPDATE,        // SensorManager::update()
+    PROBE_SENSOR_GPS,           // UBX parse and callbacks
+    PROBE_SENSOR_IMU,           // BNO080 read or ring drain
+    PROBE_SENSOR_RADAR,         // XM125 state machine step
+    PROBE_NETWORK_UPDATE,       // NetworkManager::update()
+    PROBE_HYDRAULIC_UPDATE,     // HydraulicController::update()
+    PROBE_CONTROL_TICK,         // HydraulicController control tick (ISR)
+    PROBE_TERRAIN_UPDATE,       // TerrainPreview::update()
+    PROBE_DISPLAY_UPDATE,       // DiagnosticManager::updateDisplay()
+    PROBE_OTA_UPDATE,           // OTAUpdateManager::update()
+    PROBE_LOG_SERVICE,          // DiagnosticManager::serviceLog()
+    PROBE_RECORDER_SERVICE,     // FlightRecorder::service()
+    PROBE_COUNT
+} ProfileProbe_t;
+
+struct ProbeStats {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t histogram[PROFILE_HISTOGRAM_BINS];
+};
+
+class LoopProfiler {
+public:
+    // Initialization - enables the DWT cycle counter
+    static void initialize();
+    static bool isInitialized() { return _initialized; }
+
+    // Recording - called by ProfileScope, safe from any context
+    static inline uint32_t cycles() { return ARM_DWT_CYCCNT; }
+    static void record(ProfileProbe_t probe, uint32_t cycles);
+
+    // Access
+    static void getStats(ProfileProbe_t probe, ProbeStats* stats);
+    static void reset();
+    static const char* probeName(ProfileProbe_t probe);
+
+    // Export - fills a report datagram, returns its length (0 if too small)
+    static size_t buildReport(uint8_t* buffer, size_t size, uint8_t senderId);
+    static String getStatusString();
+
+private:
+    static bool _initialized;
+    static ProbeStats _stats[PROBE_COUNT];
+    static uint32_t _reportSequence;
+    static uint32_t _resetMillis;
+};
+
+// Scoped probe - times from construction to end of scope
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileProbe_t probe) : _probe(probe), _start(LoopProfiler::cycles()) {}
+    ~ProfileScope() { LoopProfiler::record(_probe, LoopProfiler::cycles() - _start); }
+
+private:
+    ProfileProbe_t _probe;
+    uint32_t _start;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(probe)    ProfileScope profileScope_(probe)
+#else
+#define PROFILE_SCOPE(probe)    do { } while (0)
+#endif
+
+#endif // LOOP_PROFILER_H
@@ -60,6 +60,11 @@ void ModuleConfig::detectRole() {
         Serial.print(CONFIG_PINS[activePin]);
         Serial.print(") → Role: ");
         Serial.println(getRoleName());
+        
+        // A role-specific image only carries its own role's code
+        if (isRoleFixed() && _moduleRole != getBuildRole()) {
+            handleBuildRoleMismatch(_moduleRole);
+        }
     } else {
         // Invalid configuration
         _moduleRole = MODULE_UNKNOWN;
@@ -73,12 +78,17 @@ void ModuleConfig::detectRole() {
     }
 }
 
-ModuleRole_t ModuleConfig::getRole() {
-    return _moduleRole;
+String ModuleConfig::getRoleName() {
+    return roleName(_moduleRole);
 }
 
-String ModuleConfig::getRoleName() {
-    switch (_moduleRole) {
+String ModuleConfig::getBuildName() {
+    if (!isRoleFixed()) return "Unified image";
+    return roleName(getBuildRole()) + " image";
+}
+
+String ModuleConfig::roleName(ModuleRole_t role) {
+    switch (role) {
         case MODULE_LEFT:    return "LEFT_WING";
         case MODULE_CENTRE:  return "CENTRE";
         case MODULE_RIGHT:   return "RIGHT_WING";
@@ -127,6 +137,7 @@ void ModuleConfig::handleConfigurationError() {
     // Log error to SD card and show on OLED
     DiagnosticManager::logError("ModuleConfig", errorMsg);
     DiagnosticManager::showErrorScreen("DIP Switch Config Error - Check wiring");
+    DiagnosticManager::flushLog();
     
     // Halt execution - configuration must be fixed
     while(1) {
@@ -152,3 +163,26 @@ void ModuleConfig::printConfigurationInstructions() {
     Serial.println();
     Serial.println("Example: For Centre Module, tie Pin 3 to GND (DIP position 1)");
 }
+
+void ModuleConfig::handleBuildRoleMismatch(ModuleRole_t detected) {
+    String errorMsg = "Firmware built for " + roleName(getBuildRole()) +
+                      " but DIP switch selects " + roleName(detected);
+    
+    Serial.println();
+    Serial.println("=== BUILD ROLE MISMATCH ===");
+    Serial.println(errorMsg);
+    Serial.println("Flash the matching role image or the unified image.");
+    Serial.println("System halted.");
+    Serial.println("===========================");
+    
+    DiagnosticManager::logError("ModuleConfig", errorMsg);
+    DiagnosticManager::showErrorScreen("Wrong firmware for this module");
+    DiagnosticManager::flushLog();
+    
+    while(1) {
+        digitalWrite(LED_BUILTIN, HIGH);
+        delay(200);
+        digitalWrite(LED_BUILTIN, LOW);
+        delay(200);
+    }
+}
@@ -10,6 +10,13 @@
  * - Pin 3 tied to GND = Centre Module  
  * - Pin 4 tied to GND = Right Wing Module
  * 
+ * Role-specific builds:
+ * - Define ABLS_BUILD_ROLE (e.g. -DABLS_BUILD_ROLE=MODULE_CENTRE) to fix the
+ *   role at compile time; role flags in the managers become constants and
+ *   the other roles' code paths drop out of the image
+ * - The DIP switch is still read and must agree with the built role
+ * - Without ABLS_BUILD_ROLE the unified image detects its role at boot
+ * 
  * Author: ABLS Development Team
  */
 
@@ -31,6 +38,14 @@
 // Configuration pin array for easy iteration
 const int CONFIG_PINS[NUM_CONFIG_PINS] = {PIN_CONFIG_0, PIN_CONFIG_1, PIN_CONFIG_2, PIN_CONFIG_3, PIN_CONFIG_4};
 
+// Build role - unified image unless a role is given on the command line
+#ifdef ABLS_BUILD_ROLE
+#define ABLS_ROLE_FIXED     1
+#else
+#define ABLS_ROLE_FIXED     0
+#define ABLS_BUILD_ROLE     MODULE_UNKNOWN
+#endif
+
 typedef enum {
     MODULE_LEFT = 0,      // Left wing module (DIP position 0)
     MODULE_CENTRE = 1,    // Centre module (DIP position 1) - hydraulic control
@@ -44,7 +59,7 @@ class ModuleConfig {
 public:
     // Primary interface methods
     static void detectRole();
-    static ModuleRole_t getRole();
+    static ModuleRole_t getRole() { return isRoleFixed() ? getBuildRole() : _moduleRole; }
     static String getRoleName();
     static bool isRoleDetected();
     
@@ -55,6 +70,15 @@ public:
     static bool isRightWing();
     static bool isValidConfiguration();
     
+    // Build role - compile-time constants, fold away in role-specific images
+    static constexpr bool isRoleFixed() { return ABLS_ROLE_FIXED; }
+    static constexpr ModuleRole_t getBuildRole() { return (ModuleRole_t)(ABLS_BUILD_ROLE); }
+    static constexpr bool isCentreBuild() { return isRoleFixed() && getBuildRole() == MODULE_CENTRE; }
+    static constexpr bool isWingBuild() {
+        return isRoleFixed() && (getBuildRole() == MODULE_LEFT || getBuildRole() == MODULE_RIGHT);
+    }
+    static String getBuildName();
+    
 private:
     // Static member variables
     static ModuleRole_t _moduleRole;
@@ -63,6 +87,13 @@ private:
     // Internal methods
     static void handleConfigurationError();
     static void printConfigurationInstructions();
+    static void handleBuildRoleMismatch(ModuleRole_t detected);
+    static String roleName(ModuleRole_t role);
 };
 
+#if ABLS_ROLE_FIXED
+static_assert(ModuleConfig::isCentreBuild() || ModuleConfig::isWingBuild(),
+              "ABLS_BUILD_ROLE must be MODULE_LEFT, MODULE_CENTRE or MODULE_RIGHT");
+#endif
+
 #endif // MODULE_CONFIG_H
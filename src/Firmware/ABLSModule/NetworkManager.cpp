@@ -8,122 +8,244 @@
 
 #include "NetworkManager.h"
 #include "DiagnosticManager.h"
+#include "BinaryLog.h"
 #include "HydraulicController.h"
 #include "SensorManager.h"
+
+// Default relay filter - station position, GLONASS biases and MSM4-7 for
+// GPS, GLONASS, Galileo and BeiDou (what the wing ZED-F9Ps use)
+static const RtcmTypeRange_t DEFAULT_RTCM_TYPE_FILTER[] = {
+    { 1005, 1006 },
+    { 1074, 1077 },
+    { 1084, 1087 },
+    { 1094, 1097 },
+    { 1124, 1127 },
+    { 1230, 1230 }
+};
 #include "VersionManager.h"
 #include "UpdateSafetyManager.h"
 #include "RgFModuleUpdater.h"
+#include "LoopProfiler.h"
+#include "SensorPacketCodec.h"
+#include "TelemetryBatcher.h"
+#include "Benchmark.h"
 
 NetworkManager::NetworkManager() :
     _initialized(false),
     _ethernetInitialized(false),
+    _startState(NET_START_STACK),
+    _startStateTime(0),
+    _startFailures(0),
+    _staticFallback(false),
+#if !ABLS_ROLE_FIXED
     _moduleRole(MODULE_UNKNOWN),
     _enableRtcmBroadcast(false),
     _enableRtcmReceive(false),
     _enableCommandReceive(false),
+#endif
+    _enableLevellingSend(true),
     _hydraulicController(nullptr),
     _sensorManager(nullptr),
     _localIP(0, 0, 0, 0),
+    _benchmarkTarget(0, 0, 0, 0),
+    _rtcmRelayMode(RTCM_RELAY_DEFAULT_MODE),
+    _rtcmRelayTargetCount(0),
+    _rtcmTypeFilterCount(0),
+    _rtcmRelayQueued(0),
+    _rtcmRelayOldestMillis(0),
+    _rtcmRelayLastSendMicros(0),
+    _rtcmFramesRelayed(0),
+    _rtcmFramesFiltered(0),
+    _rtcmFramesDropped(0),
+    _rtcmDatagramsSent(0),
+    _firmwareMulticastUdp(FIRMWARE_MCAST_RX_QUEUE),
+    _firmwareMulticastStarted(false),
+    _lastMulticastStatus(0),
+    _lastMulticastState(FW_MCAST_STATE_IDLE),
+    _sensorWireFormat(SENSOR_WIRE_DEFAULT_FORMAT),
+    _sensorSequence(0),
+    _sensorSendDeadline(SENSOR_SEND_PERIOD_US),
+    _lastTimingStatus(0),
+    _timingWindowStart(0),
+    _levellingSequence(0),
+    _lastRadarUpdate(0),
+    _levellingPacketsSent(0),
+    _levellingPacketsReceived(0),
+    _levellingPacketsRejected(0),
+    _autotuneTarget(TOUGHBOOK_IP),
+    _autotunePort(LEVELLING_PORT),
+    _commandSequenceStarted(false),
+    _lastCommandId(0),
+    _commandsMissed(0),
+    _commandsDuplicated(0),
+    _commandsReordered(0),
+    _commandResyncs(0),
+    _linkProbeSequence(0),
+    _lastLinkProbe(0),
+    _probesSent(0),
+    _probesAnswered(0),
+    _rttMinUs(0),
+    _rttMaxUs(0),
+    _rttTotalUs(0),
+    _rttLastUs(0),
+    _linkWindowStart(0),
+    _linkTxFailuresReported(0),
+    _linkRxDroppedReported(0),
     _packetsSent(0),
     _packetsReceived(0),
+    _commandsSuperseded(0),
     _rtcmBytesSent(0),
     _rtcmBytesReceived(0),
     _lastStatsUpdate(0),
     _lastSensorDataSent(0),
-    _lastCommandCheck(0),
     _lastRtcmCheck(0)
 {
     // Initialize MAC address to zeros - will be configured in initialize()
     memset(_macAddress, 0, sizeof(_macAddress));
+    memset(_linkSockets, 0, sizeof(_linkSockets));
+    
+    _rtcmFramer.setFrameHandler(rtcmFrameHandler, this);
+    
+    // Relay defaults - both wings as unicast targets, MSM-only filter
+    addRtcmRelayTarget(RTCM_WING_LEFT_IP);
+    addRtcmRelayTarget(RTCM_WING_RIGHT_IP);
+    setRtcmTypeFilter(DEFAULT_RTCM_TYPE_FILTER, sizeof(DEFAULT_RTCM_TYPE_FILTER) / sizeof(DEFAULT_RTCM_TYPE_FILTER[0]));
 }
 
-bool NetworkManager::initialize() {
+void NetworkManager::initialize() {
     DiagnosticManager::logMessage(LOG_INFO, "NetworkManager", "Initializing network...");
     
-    // Get module role for conditional initialization
+    // Get module role for conditional initialization (constant in role builds)
+#if !ABLS_ROLE_FIXED
     _moduleRole = ModuleConfig::getRole();
+    _enableRtcmBroadcast = (_moduleRole == MODULE_CENTRE);
+    _enableRtcmReceive = (_moduleRole == MODULE_LEFT || _moduleRole == MODULE_RIGHT);
+    _enableCommandReceive = (_moduleRole == MODULE_CENTRE);
+#endif
     
     // Configure features based on module role
     switch (_moduleRole) {
         case MODULE_CENTRE:
-            _enableRtcmBroadcast = true;
-            _enableRtcmReceive = false;
-            _enableCommandReceive = true;
             DiagnosticManager::logMessage(LOG_INFO, "NetworkManager", "Centre module: RTCM broadcast, command receive enabled");
             break;
             
         case MODULE_LEFT:
         case MODULE_RIGHT:
-            _enableRtcmBroadcast = false;
-            _enableRtcmReceive = true;
-            _enableCommandReceive = false;
             DiagnosticManager::logMessage(LOG_INFO, "NetworkManager", "Wing module: RTCM receive enabled");
             break;
             
         default:
             DiagnosticManager::logError("NetworkManager", "Unknown module role - using minimal configuration");
-            _enableRtcmBroadcast = false;
-            _enableRtcmReceive = false;
-            _enableCommandReceive = false;
+            _enableLevellingSend = false;
             break;
     }
     
-    // Initialize Ethernet
-    _ethernetInitialized = initializeEthernet();
-    if (!_ethernetInitialized) {
-        DiagnosticManager::logError("NetworkManager", "Ethernet initialization failed");
-        return false;
-    }
-    
-    // Start UDP sockets
-    if (!startUDPSockets()) {
-        DiagnosticManager::logError("NetworkManager", "UDP socket initialization failed");
-        return false;
+    // Start the stack - link, DHCP and sockets follow from update()
+    configureMACAddress();
+    DiagnosticManager::setNetworkStatus("Starting");
+    if (!startEthernet()) {
+        _startFailures++;
+        DiagnosticManager::logError("NetworkManager", "Ethernet initialization failed - retrying in background");
     }
-    
-    _initialized = true;
-    
-    String statusMsg = "Network initialized - IP: " + String(_localIP);
-    DiagnosticManager::logMessage(LOG_INFO, "NetworkManager", statusMsg);
-    DiagnosticManager::setNetworkStatus("Connected", String(_localIP));
-    
-    return true;
 }
 
-bool NetworkManager::initializeEthernet() {
+bool NetworkManager::startEthernet() {
     logNetworkEvent("Starting Ethernet initialization");
     
-    // Configure MAC address based on module role
-    configureMACAddress();
-    
-    // Start Ethernet with DHCP
-    if (!Ethernet.begin(_macAddress)) {
-        logNetworkEvent("DHCP failed, trying static IP", LOG_WARNING);
-        
-        // Fallback to static IP configuration
-        configureIPAddress();
-        IPAddress subnet(255, 255, 255, 0);
-        IPAddress gateway(192, 168, 1, 1);
-        Ethernet.begin(_macAddress, _localIP, subnet, gateway);
-    }
-    
-    // Wait for link to come up
-    uint32_t linkTimeout = millis() + 10000; // 10 second timeout
-    while (!Ethernet.linkStatus() && millis() < linkTimeout) {
-        delay(100);
-    }
-    
-    if (!Ethernet.linkStatus()) {
-        logNetworkEvent("Ethernet link failed", LOG_ERROR);
+    // DHCP runs in the background inside QNEthernet - no waiting here
+    Ethernet.setMACAddress(_macAddress);
+    _staticFallback = false;
+    if (!Ethernet.begin()) {
+        setStartState(NET_START_STACK);
         return false;
     }
     
-    _localIP = Ethernet.localIP();
-    logNetworkEvent("Ethernet link established - IP: " + String(_localIP));
-    
+    _ethernetInitialized = true;
+    setStartState(NET_START_LINK);
     return true;
 }
 
+void NetworkManager::updateStartup(uint32_t now) {
+    uint32_t elapsed = now - _startStateTime;
+    
+    switch (_startState) {
+        case NET_START_STACK:
+            if (elapsed < NETWORK_RETRY_INTERVAL_MS) return;
+            if (!startEthernet()) {
+                _startFailures++;
+                logNetworkEvent("Ethernet stack still failing to start (" + String(_startFailures) + " attempts)", LOG_WARNING);
+            }
+            break;
+            
+        case NET_START_LINK:
+            if (!Ethernet.linkState()) {
+                // Cable or switch missing - keep waiting, say so once per timeout
+                if (elapsed >= NETWORK_LINK_TIMEOUT_MS) {
+                    _startFailures++;
+                    logNetworkEvent("No Ethernet link after " + String(NETWORK_LINK_TIMEOUT_MS / 1000) + "s - still waiting", LOG_ERROR);
+                    _startStateTime = now;
+                }
+                return;
+            }
+            logNetworkEvent("Ethernet link up");
+            setStartState(NET_START_ADDRESS);
+            break;
+            
+        case NET_START_ADDRESS:
+            if ((uint32_t)Ethernet.localIP() == 0) {
+                if (!_staticFallback && elapsed >= NETWORK_DHCP_TIMEOUT_MS) {
+                    logNetworkEvent("DHCP failed, trying static IP", LOG_WARNING);
+                    
+                    // Fallback to static IP configuration
+                    configureIPAddress();
+                    IPAddress subnet(255, 255, 255, 0);
+                    IPAddress gateway(192, 168, 1, 1);
+                    Ethernet.begin(_localIP, subnet, gateway);
+                    _staticFallback = true;
+                }
+                return;
+            }
+            
+            _localIP = Ethernet.localIP();
+            logNetworkEvent("Ethernet link established - IP: " + String(_localIP));
+            setStartState(NET_START_SOCKETS);
+            _startStateTime = now - NETWORK_RETRY_INTERVAL_MS;  // Sockets straight away
+            break;
+            
+        case NET_START_SOCKETS:
+            if (elapsed < NETWORK_RETRY_INTERVAL_MS) return;
+            if (!startUDPSockets()) {
+                _startFailures++;
+                DiagnosticManager::logError("NetworkManager", "UDP socket initialization failed - retrying");
+                _startStateTime = now;
+                return;
+            }
+            
+            setStartState(NET_START_DONE);
+            _initialized = true;
+            
+            // Batched telemetry queues from here on - nothing to send it before
+            TelemetryBatcher::setEnabled(_sensorWireFormat == SENSOR_WIRE_BATCHED);
+            
+            DiagnosticManager::logMessage(LOG_INFO, "NetworkManager", "Network initialized - IP: " + String(_localIP));
+            DiagnosticManager::setNetworkStatus("Connected", String(_localIP));
+            break;
+            
+        default:
+            break;
+    }
+}
+
+void NetworkManager::setStartState(NetworkStartState_t state) {
+    _startState = state;
+    _startStateTime = millis();
+}
+
+StageState_t NetworkManager::getStartupState() {
+    if (_initialized) return STAGE_READY;
+    return (_startFailures == 0) ? STAGE_STARTING : STAGE_RETRYING;
+}
+
 void NetworkManager::configureMACAddress() {
     // Generate unique MAC address based on module role and Teensy serial number
     _macAddress[0] = 0x02; // Locally administered MAC
@@ -144,7 +266,7 @@ void NetworkManager::configureMACAddress() {
         macStr += String(_macAddress[i], HEX);
     }
     
-    DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", "MAC Address: " + macStr);
+    DIAG_LOG(LOG_DEBUG, "NetworkManager", "MAC Address: " + macStr);
 }
 
 void NetworkManager::configureIPAddress() {
@@ -164,7 +286,7 @@ void NetworkManager::configureIPAddress() {
             break;
     }
     
-    DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", "Static IP configured: " + String(_localIP));
+    DIAG_LOG(LOG_DEBUG, "NetworkManager", "Static IP configured: " + String(_localIP));
 }
 
 bool NetworkManager::startUDPSockets() {
@@ -185,8 +307,15 @@ bool NetworkManager::startUDPSockets() {
         logNetworkEvent("Command UDP started on port " + String(COMMAND_PORT));
     }
     
-    // Start RTCM UDP (all modules, different usage)
-    if (!_rtcmUdp.begin(RTCM_PORT)) {
+    // Start RTCM UDP (all modules, different usage) - wings join the
+    // relay group when corrections are multicast
+    bool rtcmStarted;
+    if (_enableRtcmReceive && _rtcmRelayMode == RTCM_RELAY_MULTICAST) {
+        rtcmStarted = _rtcmUdp.beginMulticast(RTCM_MULTICAST_GROUP, RTCM_PORT);
+    } else {
+        rtcmStarted = _rtcmUdp.begin(RTCM_PORT);
+    }
+    if (!rtcmStarted) {
         logNetworkEvent("Failed to start RTCM UDP on port " + String(RTCM_PORT), LOG_ERROR);
         return false;
     }
@@ -205,19 +334,70 @@ bool NetworkManager::startUDPSockets() {
     }
     logNetworkEvent("RgFModuleUpdate status UDP started on port " + String(OTA_RESPONSE_PORT));
     
+    // Firmware multicast group (all modules) - unicast HTTP updates still
+    // work without it, so a failure here is not fatal
+    _firmwareMulticastStarted = _firmwareMulticastUdp.beginMulticast(FIRMWARE_MCAST_GROUP, FIRMWARE_MULTICAST_PORT);
+    if (_firmwareMulticastStarted) {
+        logNetworkEvent("Firmware multicast joined on port " + String(FIRMWARE_MULTICAST_PORT));
+    } else {
+        logNetworkEvent("Failed to join firmware multicast group on port " + String(FIRMWARE_MULTICAST_PORT), LOG_ERROR);
+    }
+    _firmwareMulticast.setRole((uint8_t)_moduleRole);
+    
+    // Profiler export (all modules) - diagnostics only, not fatal
+    if (_profilerUdp.begin(PROFILER_PORT)) {
+        logNetworkEvent("Profiler UDP started on port " + String(PROFILER_PORT));
+    } else {
+        logNetworkEvent("Failed to start profiler UDP on port " + String(PROFILER_PORT), LOG_ERROR);
+    }
+    
+    // Round-trip probes (all modules) - diagnostics only, not fatal
+    if (_linkProbeUdp.begin(LINK_PROBE_PORT)) {
+        logNetworkEvent("Link probe UDP started on port " + String(LINK_PROBE_PORT));
+    } else {
+        logNetworkEvent("Failed to start link probe UDP on port " + String(LINK_PROBE_PORT), LOG_ERROR);
+    }
+    
+    // Local levelling (centre receives, wings send) - levelling still works
+    // through the Toughbook without it
+    if (_enableCommandReceive || _enableRtcmReceive) {
+        if (_levellingUdp.begin(LEVELLING_PORT)) {
+            logNetworkEvent("Levelling UDP started on port " + String(LEVELLING_PORT));
+        } else {
+            logNetworkEvent("Failed to start levelling UDP on port " + String(LEVELLING_PORT), LOG_ERROR);
+            _enableLevellingSend = false;
+        }
+    }
+    
     logNetworkEvent("All UDP sockets started successfully");
     return true;
 }
 
 void NetworkManager::update() {
-    if (!_initialized) return;
+    PROFILE_SCOPE(PROBE_NETWORK_UPDATE);
     
     uint32_t now = millis();
     
-    // Process incoming commands (centre module only)
-    if (_enableCommandReceive && (now - _lastCommandCheck >= 10)) {
+    if (!_initialized) {
+        updateStartup(now);
+        return;
+    }
+    
+    // Wing heights and supervision for the local height loop, and ram
+    // autotune (centre module)
+    if (_enableCommandReceive) {
+        processIncomingLevelling();
+        serviceAutotune();
+    }
+    
+    // Radar height to the centre, once per new measurement (wing modules)
+    if (_enableRtcmReceive && _enableLevellingSend) {
+        sendWingHeight();
+    }
+    
+    // Drain incoming commands on every pass (centre module only)
+    if (_enableCommandReceive) {
         processIncomingCommands();
-        _lastCommandCheck = now;
     }
     
     // Process incoming RTCM data (wing modules only)
@@ -226,9 +406,30 @@ void NetworkManager::update() {
         _lastRtcmCheck = now;
     }
     
+    // Send coalesced RTCM datagrams (centre module only)
+    if (_enableRtcmBroadcast) {
+        serviceRtcmRelay();
+    }
+    
     // Process RgFModuleUpdate commands (all modules)
     processRgFModuleUpdateCommands();
     
+    // Multicast firmware distribution (all modules)
+    processFirmwareMulticast();
+    
+    // Profiler report on request (all modules)
+    processProfilerRequests();
+    
+    // Round-trip probe to the Toughbook (all modules)
+    serviceLinkProbe(now);
+    
+    // Deadline and link-quality summaries for the Toughbook
+    if (now - _lastTimingStatus >= TIMING_STATUS_INTERVAL_MS) {
+        sendTimingStatus(true);
+        sendLinkStatus(true);
+        _lastTimingStatus = now;
+    }
+    
     // Update statistics every second
     if (now - _lastStatsUpdate >= 1000) {
         updateStatistics();
@@ -236,21 +437,43 @@ void NetworkManager::update() {
     }
 }
 
+void NetworkManager::setSensorWireFormat(SensorWireFormat_t format) {
+    _sensorWireFormat = format;
+    if (_initialized) TelemetryBatcher::setEnabled(format == SENSOR_WIRE_BATCHED);
+}
+
 void NetworkManager::sendSensorData(const SensorDataPacket& packet) {
     if (!_initialized) return;
     
-    // Send sensor data to Toughbook
+    // Send sensor data to Toughbook in the configured wire format
     _sensorUdp.beginPacket(TOUGHBOOK_IP, SENSOR_DATA_PORT);
-    _sensorUdp.write((const uint8_t*)&packet, sizeof(SensorDataPacket));
     
-    if (_sensorUdp.endPacket()) {
+    size_t wireSize;
+    if (_sensorWireFormat == SENSOR_WIRE_V1) {
+        SensorDataPacketV1 wire;
+        SensorPacketCodec::encodeV1(packet, &wire);
+        wireSize = sizeof(wire);
+        _sensorUdp.write((const uint8_t*)&wire, wireSize);
+    } else if (_sensorWireFormat == SENSOR_WIRE_BATCHED) {
+        // Every sample queued since the last tick - the packet only supplies the sender
+        static uint8_t batch[TELEMETRY_MAX_DATAGRAM];
+        wireSize = TelemetryBatcher::build(packet.SenderId, ++_sensorSequence, micros(), batch, sizeof(batch));
+        _sensorUdp.write(batch, wireSize);
+    } else {
+        SensorDataPacketV2 wire;
+        SensorPacketCodec::encodeV2(packet, ++_sensorSequence, &wire);
+        wireSize = sizeof(wire);
+        _sensorUdp.write((const uint8_t*)&wire, wireSize);
+    }
+    
+    if (finishPacket(_sensorUdp, LINK_SOCKET_SENSOR)) {
         _packetsSent++;
         _lastSensorDataSent = millis();
         
-        DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", 
-            "Sensor data sent to Toughbook (" + String(sizeof(SensorDataPacket)) + " bytes)");
+        BLOG(LOG_DEBUG, "NetworkManager", 
+            "Sensor data sent to Toughbook (%u bytes, seq %lu)", (unsigned)wireSize, (unsigned long)_sensorSequence);
     } else {
-        DiagnosticManager::logError("NetworkManager", "Failed to send sensor data to Toughbook");
+        BLOG(LOG_ERROR, "NetworkManager", "Failed to send sensor data to Toughbook");
     }
 }
 
@@ -264,21 +487,22 @@ int NetworkManager::readCommandPacket(ControlCommandPacket* packet) {
             int bytesRead = _commandUdp.read((uint8_t*)packet, sizeof(ControlCommandPacket));
             
             if (bytesRead != sizeof(ControlCommandPacket)) {
-                DiagnosticManager::logError("NetworkManager", 
-                    "Incomplete command packet received: " + String(bytesRead) + "/" + String(sizeof(ControlCommandPacket)) + " bytes");
+                _linkSockets[LINK_SOCKET_COMMAND].RxInvalid++;
+                BLOG(LOG_ERROR, "NetworkManager", 
+                    "Incomplete command packet received: %d/%u bytes", bytesRead, (unsigned)sizeof(ControlCommandPacket));
                 return -1; // Error indicator for incomplete packet
             }
             
             _packetsReceived++;
-            
-            DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", 
-                "Command packet received from Toughbook (" + String(bytesRead) + " bytes)");
-            
+            _linkSockets[LINK_SOCKET_COMMAND].RxPackets++;
+            trackCommandSequence(packet->CommandId);
             return bytesRead;
         } else {
-            // ENHANCED LOGGING: Log wrong-size packets for debugging/security monitoring
-            DiagnosticManager::logError("NetworkManager", 
-                "Invalid command packet size received: " + String(packetSize) + " bytes (expected " + String(sizeof(ControlCommandPacket)) + " bytes)");
+            // Counted and logged without allocating - this runs in the
+            // per-poll command drain, so a flood must not touch the heap
+            _linkSockets[LINK_SOCKET_COMMAND].RxWrongSize++;
+            BLOG(LOG_ERROR, "NetworkManager", 
+                "Invalid command packet size received: %d bytes (expected %u bytes)", packetSize, (unsigned)sizeof(ControlCommandPacket));
             
             // Flush the invalid packet to prevent buffer issues
             _commandUdp.flush();
@@ -292,18 +516,122 @@ int NetworkManager::readCommandPacket(ControlCommandPacket* packet) {
 void NetworkManager::broadcastRtcmData(const uint8_t* data, size_t len) {
     if (!_initialized || !_enableRtcmBroadcast || !data || len == 0) return;
     
-    // Broadcast RTCM data to all wing modules
-    _rtcmUdp.beginPacket(RTCM_BROADCAST_IP, RTCM_PORT);
-    _rtcmUdp.write(data, len);
+    // Frame the correction stream - whole frames are filtered and queued
+    // by rtcmFrameHandler(), then sent from serviceRtcmRelay()
+    _rtcmFramer.push(data, len);
+}
+
+bool NetworkManager::addRtcmRelayTarget(const IPAddress& target) {
+    if (_rtcmRelayTargetCount >= RTCM_RELAY_MAX_TARGETS) return false;
+    _rtcmRelayTargets[_rtcmRelayTargetCount++] = target;
+    return true;
+}
+
+void NetworkManager::setRtcmTypeFilter(const RtcmTypeRange_t* ranges, uint8_t count) {
+    if (!ranges) count = 0;
+    if (count > RTCM_RELAY_MAX_FILTER_RANGES) count = RTCM_RELAY_MAX_FILTER_RANGES;
     
-    if (_rtcmUdp.endPacket()) {
-        _rtcmBytesSent += len;
-        
-        DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", 
-            "RTCM data broadcasted (" + String(len) + " bytes)");
+    for (uint8_t i = 0; i < count; i++) {
+        _rtcmTypeFilter[i] = ranges[i];
+    }
+    _rtcmTypeFilterCount = count;
+}
+
+bool NetworkManager::isRtcmTypeRelayed(uint16_t messageType) {
+    if (_rtcmTypeFilterCount == 0) return true;
+    
+    for (uint8_t i = 0; i < _rtcmTypeFilterCount; i++) {
+        if (messageType >= _rtcmTypeFilter[i].first && messageType <= _rtcmTypeFilter[i].last) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NetworkManager::queueRtcmRelayFrame(const uint8_t* frame, size_t len, uint16_t messageType) {
+    if (!isRtcmTypeRelayed(messageType)) {
+        _rtcmFramesFiltered++;
+        return;
+    }
+    
+    // Queue full means the link is not keeping up - drop the newest frame
+    if (_rtcmRelayQueued + len > sizeof(_rtcmRelayQueue)) {
+        _rtcmFramesDropped++;
+        BLOG(LOG_DEBUG, "NetworkManager", "RTCM relay queue full - dropped type %u", (unsigned)messageType);
+        return;
+    }
+    
+    if (_rtcmRelayQueued == 0) {
+        _rtcmRelayOldestMillis = millis();
+    }
+    memcpy(_rtcmRelayQueue + _rtcmRelayQueued, frame, len);
+    _rtcmRelayQueued += len;
+    _rtcmFramesRelayed++;
+}
+
+void NetworkManager::serviceRtcmRelay() {
+    if (_rtcmRelayQueued == 0) return;
+    
+    // COALESCING - wait for a full datagram or until the oldest frame has
+    // waited long enough
+    bool full = _rtcmRelayQueued >= RTCM_RELAY_MAX_PAYLOAD;
+    bool aged = (millis() - _rtcmRelayOldestMillis) >= RTCM_RELAY_COALESCE_MS;
+    if (!full && !aged) return;
+    
+    // PACING - one datagram per service call, spaced so an MSM burst does
+    // not arrive at the wings back to back
+    uint32_t nowMicros = micros();
+    if (nowMicros - _rtcmRelayLastSendMicros < RTCM_RELAY_MIN_GAP_US) return;
+    
+    // Whole frames up to one MTU (a single frame always fits)
+    size_t length = 0;
+    while (length < _rtcmRelayQueued) {
+        size_t payloadLength = ((size_t)(_rtcmRelayQueue[length + 1] & 0x03) << 8) | _rtcmRelayQueue[length + 2];
+        size_t frameLength = RTCM_HEADER_SIZE + payloadLength + RTCM_CRC_SIZE;
+        if (length + frameLength > RTCM_RELAY_MAX_PAYLOAD) break;
+        length += frameLength;
+    }
+    
+    sendRtcmDatagram(_rtcmRelayQueue, length);
+    _rtcmRelayLastSendMicros = nowMicros;
+    
+    _rtcmRelayQueued -= length;
+    if (_rtcmRelayQueued > 0) {
+        memmove(_rtcmRelayQueue, _rtcmRelayQueue + length, _rtcmRelayQueued);
+    }
+}
+
+bool NetworkManager::sendRtcmDatagram(const uint8_t* data, size_t len) {
+    bool success = true;
+    
+    if (_rtcmRelayMode == RTCM_RELAY_UNICAST) {
+        // Same datagram to each subscribed wing
+        for (uint8_t i = 0; i < _rtcmRelayTargetCount; i++) {
+            _rtcmUdp.beginPacket(_rtcmRelayTargets[i], RTCM_PORT);
+            _rtcmUdp.write(data, len);
+            if (finishPacket(_rtcmUdp, LINK_SOCKET_RTCM)) {
+                _rtcmBytesSent += len;
+            } else {
+                success = false;
+            }
+        }
     } else {
-        DiagnosticManager::logError("NetworkManager", "Failed to broadcast RTCM data");
+        IPAddress destination = (_rtcmRelayMode == RTCM_RELAY_MULTICAST) ? RTCM_MULTICAST_GROUP : RTCM_BROADCAST_IP;
+        _rtcmUdp.beginPacket(destination, RTCM_PORT);
+        _rtcmUdp.write(data, len);
+        success = finishPacket(_rtcmUdp, LINK_SOCKET_RTCM);
+        if (success) {
+            _rtcmBytesSent += len;
+        }
     }
+    
+    if (success) {
+        _rtcmDatagramsSent++;
+        BLOG(LOG_DEBUG, "NetworkManager", "RTCM datagram relayed (%u bytes)", (unsigned)len);
+    } else {
+        BLOG(LOG_ERROR, "NetworkManager", "Failed to relay RTCM data");
+    }
+    return success;
 }
 
 int NetworkManager::readRtcmData(uint8_t* buffer, size_t maxSize) {
@@ -315,26 +643,23 @@ int NetworkManager::readRtcmData(uint8_t* buffer, size_t maxSize) {
         
         // ENHANCED RTCM VALIDATION: Validate actual bytes read
         if (bytesRead != packetSize) {
-            DiagnosticManager::logError("NetworkManager", 
-                "Incomplete RTCM packet received: " + String(bytesRead) + "/" + String(packetSize) + " bytes");
+            _linkSockets[LINK_SOCKET_RTCM].RxInvalid++;
+            BLOG(LOG_ERROR, "NetworkManager", 
+                "Incomplete RTCM packet received: %d/%d bytes", bytesRead, packetSize);
             return -1; // Error indicator
         }
         
-        // ENHANCED RTCM VALIDATION: Basic RTCM message format validation
-        if (!validateRtcmData(buffer, bytesRead)) {
-            DiagnosticManager::logError("NetworkManager", 
-                "Invalid RTCM data format detected - discarding " + String(bytesRead) + " bytes");
-            return -2; // Invalid format indicator
-        }
-        
+        // Frame boundaries and CRC are checked by the RTCM framer - a
+        // datagram may hold part of a frame or several frames
         _rtcmBytesReceived += bytesRead;
+        _linkSockets[LINK_SOCKET_RTCM].RxPackets++;
         
-        DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", 
-            "RTCM data received and validated (" + String(bytesRead) + " bytes)");
+        BLOG(LOG_DEBUG, "NetworkManager", "RTCM data received (%d bytes)", bytesRead);
         
         return bytesRead;
     } else if (packetSize > (int)maxSize) {
         // ENHANCED RTCM VALIDATION: Log oversized packets
+        _linkSockets[LINK_SOCKET_RTCM].RxWrongSize++;
         DiagnosticManager::logError("NetworkManager", 
             "RTCM packet too large: " + String(packetSize) + " bytes (max " + String(maxSize) + " bytes)");
         _rtcmUdp.flush(); // Discard oversized packet
@@ -345,34 +670,277 @@ int NetworkManager::readRtcmData(uint8_t* buffer, size_t maxSize) {
 }
 
 void NetworkManager::processIncomingCommands() {
-    ControlCommandPacket commandPacket;
+    ControlCommandPacket packet;
+    ControlCommandPacket newest;
+    uint32_t newestReceiveMicros = 0;
+    bool haveCommand = false;
+    
+    // Empty the queue and keep only the newest CommandId - anything behind
+    // it is already out of date. Runs at the loop rate, so no logging.
+    int drained = 0;
+    for (int i = 0; i < COMMAND_MAX_PACKETS_PER_POLL; i++) {
+        int result = readCommandPacket(&packet);
+        if (result == 0) break;
+        drained++;
+        if (result < 0) continue;
+        
+        if (!haveCommand || (int32_t)(packet.CommandId - newest.CommandId) > 0) {
+            if (haveCommand) _commandsSuperseded++;
+            newest = packet;
+            newestReceiveMicros = micros();
+            haveCommand = true;
+        } else {
+            _commandsSuperseded++;
+        }
+    }
+    recordQueueDepth(LINK_SOCKET_COMMAND, drained);
     
-    if (readCommandPacket(&commandPacket) > 0) {
-        // Forward command to hydraulic controller if available
-        if (_hydraulicController) {
-            _hydraulicController->processCommand(commandPacket);
+    // Forward command to hydraulic controller if available
+    if (haveCommand && _hydraulicController) {
+        _hydraulicController->processCommand(newest, newestReceiveMicros);
+    }
+}
+
+void NetworkManager::processIncomingLevelling() {
+    // Heights arrive at radar rate from both wings - drain everything queued
+    // so the loop always sees the newest, and never log per packet
+    uint8_t buffer[sizeof(WingHeightPacket)];
+    LinkSocketRecord& link = _linkSockets[LINK_SOCKET_LEVELLING];
+    
+    int drained = 0;
+    for (int i = 0; i < LEVELLING_MAX_PACKETS_PER_POLL; i++) {
+        int packetSize = _levellingUdp.parsePacket();
+        if (packetSize <= 0) break;
+        drained++;
+        
+        if (packetSize > (int)sizeof(buffer) || packetSize < (int)sizeof(LevellingPacketHeader)) {
+            _levellingUdp.flush();
+            _levellingPacketsRejected++;
+            link.RxWrongSize++;
+            continue;
+        }
+        if (_levellingUdp.read(buffer, packetSize) != packetSize) {
+            _levellingUdp.flush();
+            _levellingPacketsRejected++;
+            link.RxInvalid++;
+            continue;
+        }
+        
+        LevellingPacketHeader header;
+        memcpy(&header, buffer, sizeof(header));
+        if (header.Magic != LEVELLING_PACKET_MAGIC || header.Version != LEVELLING_PACKET_VERSION) {
+            _levellingPacketsRejected++;
+            link.RxInvalid++;
+            continue;
         }
         
-        DiagnosticManager::logMessage(LOG_INFO, "NetworkManager", 
-            "Command processed - Centre: " + String(commandPacket.SetpointCenter) + 
-            ", Left: " + String(commandPacket.SetpointLeft) + 
-            ", Right: " + String(commandPacket.SetpointRight));
+        if (header.MessageType == LEVELLING_MSG_WING_HEIGHT && packetSize == sizeof(WingHeightPacket)) {
+            WingHeightPacket packet;
+            memcpy(&packet, buffer, sizeof(packet));
+            if (_hydraulicController) _hydraulicController->processWingHeight(packet);
+        } else if (header.MessageType == LEVELLING_MSG_SUPERVISION && packetSize == sizeof(LevellingSupervisionPacket) &&
+                   _levellingUdp.remoteIP() == TOUGHBOOK_IP) {
+            LevellingSupervisionPacket packet;
+            memcpy(&packet, buffer, sizeof(packet));
+            if (_hydraulicController) _hydraulicController->processLevellingSupervision(packet);
+        } else if (header.MessageType == LEVELLING_MSG_AUTOTUNE_REQUEST && packetSize == sizeof(AutotuneRequestPacket) &&
+                   _levellingUdp.remoteIP() == TOUGHBOOK_IP) {
+            AutotuneRequestPacket packet;
+            memcpy(&packet, buffer, sizeof(packet));
+            _autotuneTarget = _levellingUdp.remoteIP();
+            _autotunePort = _levellingUdp.remotePort();
+            handleAutotuneRequest(packet);
+        } else {
+            _levellingPacketsRejected++;
+            link.RxInvalid++;
+            continue;
+        }
+        
+        _levellingPacketsReceived++;
+        link.RxPackets++;
     }
+    recordQueueDepth(LINK_SOCKET_LEVELLING, drained);
 }
 
-void NetworkManager::processIncomingRtcm() {
-    uint8_t rtcmBuffer[1024]; // Buffer for RTCM data
+void NetworkManager::sendWingHeight() {
+    if (!_sensorManager) return;
+    
+    SensorSnapshot snapshot;
+    _sensorManager->getSnapshot(&snapshot);
+    
+    // One packet per radar measurement - nothing new, nothing to send
+    if (snapshot.radar.updateMillis == 0 || snapshot.radar.updateMillis == _lastRadarUpdate) return;
+    _lastRadarUpdate = snapshot.radar.updateMillis;
+    
+    WingHeightPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.Header.Magic = LEVELLING_PACKET_MAGIC;
+    packet.Header.Version = LEVELLING_PACKET_VERSION;
+    packet.Header.MessageType = LEVELLING_MSG_WING_HEIGHT;
+    packet.Header.SenderId = (_moduleRole == MODULE_LEFT) ? SENDER_LEFT_WING : SENDER_RIGHT_WING;
+    packet.Header.Sequence = ++_levellingSequence;
+    packet.SampleTimeMicros = snapshot.radar.sampleMicros;
+    
+    // Radar looks along the wing's down axis - project it onto the vertical
+    // with roll and pitch from the rotation vector when the IMU is alive
+    float height = snapshot.radar.distance;
+    const ImuSnapshot& imu = snapshot.imu;
+    if (imu.sampleMicros != 0 && imu.quatAccuracy > 0) {
+        float roll = atan2f(2.0f * (imu.quatReal * imu.quatI + imu.quatJ * imu.quatK),
+                            1.0f - 2.0f * (imu.quatI * imu.quatI + imu.quatJ * imu.quatJ));
+        float sinPitch = 2.0f * (imu.quatReal * imu.quatJ - imu.quatK * imu.quatI);
+        float pitch = asinf(constrain(sinPitch, -1.0f, 1.0f));
+        height *= cosf(roll) * cosf(pitch);
+        packet.RollCdeg = SensorPacketCodec::toFixed16(roll * RAD_TO_DEG, 100.0);
+        packet.PitchCdeg = SensorPacketCodec::toFixed16(pitch * RAD_TO_DEG, 100.0);
+        packet.Header.Flags |= LEVELLING_FLAG_TILT_VALID;
+    }
+    packet.HeightMm = SensorPacketCodec::toFixedU16(height, 1000.0);
+    if (snapshot.radar.valid) packet.Header.Flags |= LEVELLING_FLAG_RADAR_VALID;
     
-    int bytesReceived = readRtcmData(rtcmBuffer, sizeof(rtcmBuffer));
-    if (bytesReceived > 0) {
-        // Forward RTCM data to sensor manager for GPS injection
-        if (_sensorManager) {
-            _sensorManager->forwardRtcmToGps(rtcmBuffer, bytesReceived);
+    _levellingUdp.beginPacket(LEVELLING_CENTRE_IP, LEVELLING_PORT);
+    _levellingUdp.write((const uint8_t*)&packet, sizeof(packet));
+    if (finishPacket(_levellingUdp, LINK_SOCKET_LEVELLING)) {
+        _levellingPacketsSent++;
+    }
+}
+
+void NetworkManager::handleAutotuneRequest(const AutotuneRequestPacket& request) {
+    if (!_hydraulicController) return;
+    
+    switch (request.Action) {
+        case AUTOTUNE_ACTION_START: {
+            // The rams are driven on their own for tens of seconds - never on the
+            // move, and no GNSS fix or a stale epoch counts as moving
+            AutotuneResult_t result = UpdateSafetyManager::isConfirmedStationary() ?
+                _hydraulicController->startAutotune(request.RamMask, request.TargetSettlingMs) : AUTOTUNE_RESULT_MOVING;
+            if (result != AUTOTUNE_RESULT_OK) {
+                logNetworkEvent("Autotune refused - " + String(autotuneResultToString(result)), LOG_WARNING);
+                AutotuneReportPacket report;
+                memset(&report, 0, sizeof(report));
+                report.Ram = AUTOTUNE_RAM_NONE;
+                report.Result = result;
+                report.TargetSettlingMs = request.TargetSettlingMs;
+                sendAutotuneReport(report);
+            }
+            break;
         }
+        case AUTOTUNE_ACTION_ABORT:
+            _hydraulicController->abortAutotune(AUTOTUNE_RESULT_ABORTED);
+            break;
+        case AUTOTUNE_ACTION_FORGET:
+            _hydraulicController->forgetPIDGains();
+            break;
+        default:
+            logNetworkEvent("Unknown autotune action " + String(request.Action), LOG_WARNING);
+            break;
+    }
+}
+
+void NetworkManager::serviceAutotune() {
+    if (!_hydraulicController) return;
+    
+    // The machine must stay put, with a live fix, for the whole tune
+    if (_hydraulicController->isAutotuneActive() && !UpdateSafetyManager::isConfirmedStationary()) {
+        _hydraulicController->abortAutotune(AUTOTUNE_RESULT_MOVING);
+    }
+    
+    AutotuneReportPacket report;
+    while (_hydraulicController->takeAutotuneReport(&report)) {
+        sendAutotuneReport(report);
+    }
+}
+
+void NetworkManager::sendAutotuneReport(AutotuneReportPacket& report) {
+    report.Header.Magic = LEVELLING_PACKET_MAGIC;
+    report.Header.Version = LEVELLING_PACKET_VERSION;
+    report.Header.MessageType = LEVELLING_MSG_AUTOTUNE_REPORT;
+    report.Header.SenderId = SENDER_CENTRE;
+    report.Header.Sequence = ++_levellingSequence;
+    
+    _levellingUdp.beginPacket(_autotuneTarget, _autotunePort);
+    _levellingUdp.write((const uint8_t*)&report, sizeof(report));
+    if (finishPacket(_levellingUdp, LINK_SOCKET_LEVELLING)) {
+        _levellingPacketsSent++;
+    }
+}
+
+void NetworkManager::processProfilerRequests() {
+    int packetSize = _profilerUdp.parsePacket();
+    if (packetSize <= 0) return;
+    
+    ProfileRequestPacket request;
+    if (packetSize != sizeof(request)) {
+        _profilerUdp.flush();
+        _linkSockets[LINK_SOCKET_PROFILER].RxWrongSize++;
+        return;
+    }
+    if (_profilerUdp.read((uint8_t*)&request, sizeof(request)) != packetSize ||
+        request.Magic != PROFILE_PACKET_MAGIC || request.Version != PROFILE_PACKET_VERSION ||
+        request.MessageType != PROFILE_MSG_REQUEST) {
+        _profilerUdp.flush();
+        _linkSockets[LINK_SOCKET_PROFILER].RxInvalid++;
+        return;
+    }
+    _linkSockets[LINK_SOCKET_PROFILER].RxPackets++;
+    
+    static uint8_t report[sizeof(ProfileReportHeader) + PROBE_COUNT * sizeof(ProfileProbeRecord)];
+    uint8_t senderId = SENDER_UNKNOWN;
+    switch (_moduleRole) {
+        case MODULE_LEFT:   senderId = SENDER_LEFT_WING; break;
+        case MODULE_CENTRE: senderId = SENDER_CENTRE; break;
+        case MODULE_RIGHT:  senderId = SENDER_RIGHT_WING; break;
+        default: break;
+    }
+    
+    size_t length = LoopProfiler::buildReport(report, sizeof(report), senderId);
+    if (length == 0) return;
+    
+    // Answer whoever asked - request from any diagnostics host
+    _profilerUdp.beginPacket(_profilerUdp.remoteIP(), _profilerUdp.remotePort());
+    _profilerUdp.write(report, length);
+    if (finishPacket(_profilerUdp, LINK_SOCKET_PROFILER)) {
+        _packetsSent++;
+    }
+    
+    if (request.Flags & PROFILE_FLAG_RESET) {
+        LoopProfiler::reset();
+    }
+}
+
+void NetworkManager::processIncomingRtcm() {
+    static uint8_t rtcmBuffer[RTCM_MAX_DATAGRAM_SIZE]; // Buffer for RTCM data
+    
+    // Drain queued datagrams through the framer - valid frames reach the
+    // GPS via rtcmFrameHandler()
+    int drained = 0;
+    for (int i = 0; i < RTCM_MAX_DATAGRAMS_PER_POLL; i++) {
+        int bytesReceived = readRtcmData(rtcmBuffer, sizeof(rtcmBuffer));
+        if (bytesReceived == 0) break;
+        drained++;
+        if (bytesReceived < 0) continue;
         
-        DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", 
-            "RTCM data forwarded to GPS (" + String(bytesReceived) + " bytes)");
+        _rtcmFramer.push(rtcmBuffer, bytesReceived);
+    }
+    recordQueueDepth(LINK_SOCKET_RTCM, drained);
+}
+
+void NetworkManager::rtcmFrameHandler(const uint8_t* frame, size_t len, uint16_t messageType, void* context) {
+    NetworkManager* self = static_cast<NetworkManager*>(context);
+    
+    // Centre module relays corrections to the wings
+    if (self->_enableRtcmBroadcast) {
+        self->queueRtcmRelayFrame(frame, len, messageType);
+        return;
     }
+    
+    // Forward RTCM frame to sensor manager for GPS injection
+    if (self->_sensorManager) {
+        self->_sensorManager->forwardRtcmToGps(frame, len);
+    }
+    
+    BLOG(LOG_DEBUG, "NetworkManager", 
+        "RTCM %u forwarded to GPS (%u bytes)", (unsigned)messageType, (unsigned)len);
 }
 
 void NetworkManager::updateStatistics() {
@@ -383,16 +951,22 @@ void NetworkManager::updateStatistics() {
 
 void NetworkManager::setHydraulicController(HydraulicController* controller) {
     _hydraulicController = controller;
-    DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", "Hydraulic controller reference set");
+    DIAG_LOG(LOG_DEBUG, "NetworkManager", "Hydraulic controller reference set");
 }
 
 void NetworkManager::setSensorManager(SensorManager* sensorManager) {
     _sensorManager = sensorManager;
-    DiagnosticManager::logMessage(LOG_DEBUG, "NetworkManager", "Sensor manager reference set");
+    DIAG_LOG(LOG_DEBUG, "NetworkManager", "Sensor manager reference set");
 }
 
 String NetworkManager::getNetworkStatusString() {
-    if (!_initialized) return "Not initialized";
+    if (!_initialized) {
+        switch (_startState) {
+            case NET_START_LINK:    return "Waiting for link";
+            case NET_START_ADDRESS: return _staticFallback ? "Static IP" : "DHCP";
+            default:                return "Retrying";
+        }
+    }
     
     String status = "Connected";
     
@@ -402,6 +976,15 @@ String NetworkManager::getNetworkStatusString() {
         status += " (RTCM RX)";
     }
     
+    if (_enableCommandReceive && _hydraulicController && 
+        _hydraulicController->getLevellingMode() == LEVELLING_LOCAL) {
+        status += ", Local levelling";
+    }
+    
+    if (_firmwareMulticast.getState() != FW_MCAST_STATE_IDLE) {
+        status += ", " + _firmwareMulticast.getStageString();
+    }
+    
     return status;
 }
 
@@ -429,6 +1012,10 @@ void NetworkManager::processRgFModuleUpdateCommands() {
             // Abort any ongoing update
             handleAbortUpdateCommand();
         }
+        else if (strcmp(command.Command, "RUN_BENCHMARK") == 0) {
+            // Hot-path microbenchmarks, results back to the requester
+            handleBenchmarkCommand();
+        }
         else {
             logNetworkEvent("RgFModuleUpdate: Unknown command: " + String(command.Command), LOG_WARNING);
         }
@@ -491,14 +1078,251 @@ void NetworkManager::sendModuleStatusResponse() {
             break;
     }
     
+    // A multicast session reports its own stage
+    FirmwareMulticastState_t multicastState = _firmwareMulticast.getState();
+    if (_firmwareMulticast.isActive()) {
+        strcpy(status.Status, "UPDATING");
+        strlcpy(status.UpdateStage, _firmwareMulticast.getStageString().c_str(), sizeof(status.UpdateStage));
+        status.UpdateProgress = _firmwareMulticast.getProgress();
+    } else if (multicastState == FW_MCAST_STATE_FAILED || multicastState == FW_MCAST_STATE_DECLINED) {
+        strlcpy(status.UpdateStage, _firmwareMulticast.getStageString().c_str(), sizeof(status.UpdateStage));
+        strlcpy(status.LastError, _firmwareMulticast.getLastError().c_str(), sizeof(status.LastError));
+    }
+    
     // Set system information
     status.UptimeSeconds = millis() / 1000;
     status.FreeMemory = getFreeMemory();
     status.PacketsSent = _packetsSent;
     status.PacketsReceived = _packetsReceived;
     
-    // Send the status response
+    // Send the status response, with timing so far in the current window
     sendRgFModuleUpdateStatus(status);
+    sendTimingStatus(false);
+    sendLinkStatus(false);
+}
+
+void NetworkManager::sendTimingStatus(bool closeWindow) {
+    uint32_t now = millis();
+    
+    TimingStatusPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.Magic = TIMING_PACKET_MAGIC;
+    packet.Version = TIMING_PACKET_VERSION;
+    packet.SenderId = (uint8_t)_moduleRole;
+    packet.Timestamp = now;
+    packet.WindowMillis = now - _timingWindowStart;
+    packet.ChannelCount = TIMING_CHANNEL_COUNT;
+    
+    fillTimingRecord(_sensorSendDeadline, &packet.Channels[TIMING_CHANNEL_SENSOR_SEND], closeWindow);
+    if (_hydraulicController) {
+        fillTimingRecord(_hydraulicController->getTickDeadline(), &packet.Channels[TIMING_CHANNEL_HYDRAULIC], closeWindow);
+    }
+    if (_sensorManager) {
+        fillTimingRecord(_sensorManager->getImuDeadline(), &packet.Channels[TIMING_CHANNEL_IMU], closeWindow);
+    }
+    if (closeWindow) _timingWindowStart = now;
+    
+    _updateStatusUdp.beginPacket(TOUGHBOOK_IP, OTA_RESPONSE_PORT);
+    _updateStatusUdp.write((const uint8_t*)&packet, sizeof(packet));
+    if (finishPacket(_updateStatusUdp, LINK_SOCKET_UPDATE_STATUS)) {
+        _packetsSent++;
+    }
+    
+    // Only worth a log line when something actually missed its slot
+    const TimingChannelRecord* sensor = &packet.Channels[TIMING_CHANNEL_SENSOR_SEND];
+    const TimingChannelRecord* hydraulic = &packet.Channels[TIMING_CHANNEL_HYDRAULIC];
+    const TimingChannelRecord* imu = &packet.Channels[TIMING_CHANNEL_IMU];
+    if (closeWindow && (sensor->Overruns || hydraulic->Overruns || imu->Overruns)) {
+        logNetworkEvent("Deadline overruns - sensor:" + String(sensor->Overruns) + 
+            " (max jitter " + String(sensor->MaxJitterUs) + "us), hydraulic:" + String(hydraulic->Overruns) + 
+            " (" + String(hydraulic->MaxJitterUs) + "us), imu:" + String(imu->Overruns) + 
+            " (" + String(imu->MaxJitterUs) + "us)", LOG_WARNING);
+    }
+}
+
+void NetworkManager::fillTimingRecord(DeadlineMonitor& monitor, TimingChannelRecord* record, bool closeWindow) {
+    DeadlineStats stats;
+    monitor.getStats(&stats);
+    if (closeWindow) monitor.resetWindow();
+    
+    record->NominalPeriodUs = stats.periodMicros;
+    record->Count = stats.count;
+    record->MinPeriodUs = stats.minPeriodMicros;
+    record->MaxPeriodUs = stats.maxPeriodMicros;
+    record->MeanPeriodUs = stats.meanPeriodMicros;
+    record->MeanJitterUs = stats.meanJitterMicros;
+    record->MaxJitterUs = stats.maxJitterMicros;
+    record->Overruns = stats.overruns;
+    record->Skipped = stats.skipped;
+}
+
+bool NetworkManager::finishPacket(EthernetUDP& udp, LinkSocket_t socket) {
+    if (udp.endPacket()) {
+        _linkSockets[socket].TxPackets++;
+        return true;
+    }
+    _linkSockets[socket].TxFailures++;
+    return false;
+}
+
+void NetworkManager::recordQueueDepth(LinkSocket_t socket, int depth) {
+    // Datagrams found waiting at one poll - the receive backlog the loop saw
+    if (depth > _linkSockets[socket].RxQueueHighWater) {
+        _linkSockets[socket].RxQueueHighWater = (uint16_t)depth;
+    }
+}
+
+void NetworkManager::trackCommandSequence(uint32_t commandId) {
+    if (!_commandSequenceStarted) {
+        _commandSequenceStarted = true;
+        _lastCommandId = commandId;
+        return;
+    }
+    
+    int32_t step = (int32_t)(commandId - _lastCommandId);
+    if (step > LINK_COMMAND_RESYNC_WINDOW || step < -LINK_COMMAND_RESYNC_WINDOW) {
+        // Toughbook restarted its CommandId counter - start over from here
+        _commandResyncs++;
+        _lastCommandId = commandId;
+    } else if (step > 0) {
+        _commandsMissed += step - 1;
+        _lastCommandId = commandId;
+    } else if (step == 0) {
+        _commandsDuplicated++;
+    } else {
+        // Late, not lost - it was counted missing when the newer one arrived
+        _commandsReordered++;
+        if (_commandsMissed > 0) _commandsMissed--;
+    }
+}
+
+void NetworkManager::serviceLinkProbe(uint32_t now) {
+    LinkProbePacket probe;
+    LinkSocketRecord& link = _linkSockets[LINK_SOCKET_PROBE];
+    
+    // Echoes from the Toughbook - only this boot's recent probes are timed
+    int drained = 0;
+    for (int i = 0; i < LINK_PROBE_MAX_PER_POLL; i++) {
+        int packetSize = _linkProbeUdp.parsePacket();
+        if (packetSize <= 0) break;
+        drained++;
+        
+        if (packetSize != sizeof(probe)) {
+            _linkProbeUdp.flush();
+            link.RxWrongSize++;
+            continue;
+        }
+        if (_linkProbeUdp.read((uint8_t*)&probe, sizeof(probe)) != packetSize ||
+            probe.Magic != LINK_PACKET_MAGIC || probe.Version != LINK_PACKET_VERSION ||
+            probe.MessageType != LINK_MSG_ECHO || probe.SenderId != (uint8_t)_moduleRole) {
+            link.RxInvalid++;
+            continue;
+        }
+        link.RxPackets++;
+        
+        uint32_t outstanding = _linkProbeSequence - probe.Sequence;
+        uint32_t rtt = micros() - probe.SendMicros;
+        if (outstanding >= LINK_PROBE_TIMEOUT_MS / LINK_PROBE_INTERVAL_MS || rtt > LINK_PROBE_TIMEOUT_MS * 1000UL) {
+            continue;
+        }
+        
+        if (_probesAnswered == 0 || rtt < _rttMinUs) _rttMinUs = rtt;
+        if (rtt > _rttMaxUs) _rttMaxUs = rtt;
+        _rttTotalUs += rtt;
+        _rttLastUs = rtt;
+        _probesAnswered++;
+    }
+    recordQueueDepth(LINK_SOCKET_PROBE, drained);
+    
+    if (now - _lastLinkProbe < LINK_PROBE_INTERVAL_MS) return;
+    _lastLinkProbe = now;
+    
+    memset(&probe, 0, sizeof(probe));
+    probe.Magic = LINK_PACKET_MAGIC;
+    probe.Version = LINK_PACKET_VERSION;
+    probe.MessageType = LINK_MSG_PROBE;
+    probe.SenderId = (uint8_t)_moduleRole;
+    probe.Sequence = ++_linkProbeSequence;
+    probe.SendMicros = micros();
+    
+    _linkProbeUdp.beginPacket(TOUGHBOOK_IP, LINK_PROBE_PORT);
+    _linkProbeUdp.write((const uint8_t*)&probe, sizeof(probe));
+    finishPacket(_linkProbeUdp, LINK_SOCKET_PROBE);
+    _probesSent++;
+}
+
+void NetworkManager::sendLinkStatus(bool closeWindow) {
+    uint32_t now = millis();
+    
+    LinkStatusPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.Magic = LINK_PACKET_MAGIC;
+    packet.Version = LINK_PACKET_VERSION;
+    packet.MessageType = LINK_MSG_STATUS;
+    packet.SenderId = (uint8_t)_moduleRole;
+    packet.SocketCount = LINK_SOCKET_COUNT;
+    packet.Timestamp = now;
+    packet.WindowMillis = now - _linkWindowStart;
+    
+    packet.CommandsMissed = _commandsMissed;
+    packet.CommandsDuplicated = _commandsDuplicated;
+    packet.CommandsReordered = _commandsReordered;
+    packet.CommandResyncs = _commandResyncs;
+    
+    packet.ProbesSent = _probesSent;
+    packet.ProbesAnswered = _probesAnswered;
+    if (_probesAnswered > 0) {
+        packet.RttMinUs = _rttMinUs;
+        packet.RttMeanUs = (uint32_t)(_rttTotalUs / _probesAnswered);
+        packet.RttMaxUs = _rttMaxUs;
+    }
+    packet.RttLastUs = _rttLastUs;
+    
+    // Receive queue overflows are counted by QNEthernet, per socket - in
+    // LinkSocket_t order
+    EthernetUDP* sockets[LINK_SOCKET_COUNT] = {
+        &_sensorUdp, &_commandUdp, &_rtcmUdp, &_levellingUdp, &_updateCommandUdp,
+        &_updateStatusUdp, &_firmwareMulticastUdp, &_profilerUdp, &_linkProbeUdp
+    };
+    for (uint8_t i = 0; i < LINK_SOCKET_COUNT; i++) {
+        _linkSockets[i].RxDropped = sockets[i]->droppedReceiveCount();
+        _linkSockets[i].RxQueueCapacity = (uint16_t)sockets[i]->receiveQueueCapacity();
+    }
+    memcpy(packet.Sockets, _linkSockets, sizeof(packet.Sockets));
+    
+    if (closeWindow) {
+        _linkWindowStart = now;
+        _probesSent = 0;
+        _probesAnswered = 0;
+        _rttMinUs = 0;
+        _rttMaxUs = 0;
+        _rttTotalUs = 0;
+        for (uint8_t i = 0; i < LINK_SOCKET_COUNT; i++) {
+            _linkSockets[i].RxQueueHighWater = 0;
+        }
+    }
+    
+    _updateStatusUdp.beginPacket(TOUGHBOOK_IP, OTA_RESPONSE_PORT);
+    _updateStatusUdp.write((const uint8_t*)&packet, sizeof(packet));
+    if (finishPacket(_updateStatusUdp, LINK_SOCKET_UPDATE_STATUS)) {
+        _packetsSent++;
+    }
+    
+    // Worth a log line when the LAN actually lost something
+    if (closeWindow) {
+        uint32_t txFailures = 0;
+        uint32_t rxDropped = 0;
+        for (uint8_t i = 0; i < LINK_SOCKET_COUNT; i++) {
+            txFailures += packet.Sockets[i].TxFailures;
+            rxDropped += packet.Sockets[i].RxDropped;
+        }
+        if (txFailures != _linkTxFailuresReported || rxDropped != _linkRxDroppedReported) {
+            logNetworkEvent("Link losses - tx failures:" + String(txFailures) + ", rx dropped:" + String(rxDropped) + 
+                ", commands missed:" + String(_commandsMissed) + ", rtt max:" + String(packet.RttMaxUs) + "us", LOG_WARNING);
+            _linkTxFailuresReported = txFailures;
+            _linkRxDroppedReported = rxDropped;
+        }
+    }
 }
 
 void NetworkManager::handleStartUpdateCommand(const RgFModuleUpdateCommandPacket* command) {
@@ -520,6 +1344,11 @@ void NetworkManager::handleStartUpdateCommand(const RgFModuleUpdateCommandPacket
         return;
     }
     
+    if (_firmwareMulticast.isActive()) {
+        logNetworkEvent("RgFModuleUpdate: Multicast session in progress - rejecting unicast update request", LOG_WARNING);
+        return;
+    }
+    
     // CRITICAL FIX: Check if update is already in progress to prevent concurrent updates
     UpdateStatus_t currentStatus = VersionManager::getUpdateStatus();
     if (currentStatus != UPDATE_IDLE && currentStatus != UPDATE_SUCCESS && currentStatus != UPDATE_FAILED) {
@@ -539,7 +1368,7 @@ void NetworkManager::handleStartUpdateCommand(const RgFModuleUpdateCommandPacket
     String firmwareHash = String(command->FirmwareHash);
     
     // Use RgFModuleUpdater to perform the update
-    bool updateStarted = RgFModuleUpdater::performUpdate(firmwareUrl);
+    bool updateStarted = RgFModuleUpdater::performUpdate(firmwareUrl, firmwareHash, command->FirmwareSize);
     
     if (updateStarted) {
         logNetworkEvent("RgFModuleUpdate: Firmware update started", LOG_INFO);
@@ -551,11 +1380,92 @@ void NetworkManager::handleStartUpdateCommand(const RgFModuleUpdateCommandPacket
 void NetworkManager::handleAbortUpdateCommand() {
     logNetworkEvent("RgFModuleUpdate: ABORT_UPDATE command received", LOG_INFO);
     
+    if (_firmwareMulticast.isActive()) {
+        _firmwareMulticast.abort("ABORT_UPDATE command");
+        logNetworkEvent("RgFModuleUpdate: Multicast session aborted", LOG_INFO);
+        return;
+    }
+    
     // TODO: Implement update abort functionality in RgFModuleUpdater
     // For now, just log the command
     logNetworkEvent("RgFModuleUpdate: Update abort not yet implemented", LOG_WARNING);
 }
 
+void NetworkManager::handleBenchmarkCommand() {
+    logNetworkEvent("RgFModuleUpdate: RUN_BENCHMARK command received", LOG_INFO);
+    
+    // Hashing and flash traffic would both skew the figures and be delayed
+    UpdateStatus_t currentStatus = VersionManager::getUpdateStatus();
+    if (_firmwareMulticast.isActive() ||
+        (currentStatus != UPDATE_IDLE && currentStatus != UPDATE_SUCCESS && currentStatus != UPDATE_FAILED)) {
+        logNetworkEvent("RgFModuleUpdate: Firmware update in progress - benchmark not run", LOG_WARNING);
+        return;
+    }
+    
+    _benchmarkTarget = _updateCommandUdp.remoteIP();
+    int cases = Benchmark::run(_sensorManager, _hydraulicController, &sendBenchmarkLine, this);
+    logNetworkEvent("Benchmark: " + String(cases) + " cases sent to " + String(_benchmarkTarget) + 
+        ":" + String(BENCHMARK_REPORT_PORT), cases >= 0 ? LOG_INFO : LOG_WARNING);
+}
+
+void NetworkManager::sendBenchmarkLine(const char* line, size_t len, void* context) {
+    // One JSON line per datagram, echoed to the console for bench use
+    NetworkManager* self = (NetworkManager*)context;
+    self->_updateStatusUdp.beginPacket(self->_benchmarkTarget, BENCHMARK_REPORT_PORT);
+    self->_updateStatusUdp.write((const uint8_t*)line, len);
+    self->finishPacket(self->_updateStatusUdp, LINK_SOCKET_UPDATE_STATUS);
+    Serial.println(line);
+}
+
+void NetworkManager::processFirmwareMulticast() {
+    if (!_firmwareMulticastStarted) return;
+    
+    static FirmwareMulticastBlock datagram;
+    static FirmwareMulticastReport report;
+    
+    // Drain queued blocks - each may program flash, so the batch is bounded
+    int drained = 0;
+    for (int i = 0; i < FIRMWARE_MCAST_MAX_PER_POLL; i++) {
+        int packetSize = _firmwareMulticastUdp.parsePacket();
+        if (packetSize <= 0) break;
+        drained++;
+        
+        int bytesRead = _firmwareMulticastUdp.read((uint8_t*)&datagram, sizeof(datagram));
+        if (bytesRead > 0) {
+            _packetsReceived++;
+            _linkSockets[LINK_SOCKET_FIRMWARE_MCAST].RxPackets++;
+            _firmwareMulticast.handleDatagram((const uint8_t*)&datagram, bytesRead);
+        } else {
+            _linkSockets[LINK_SOCKET_FIRMWARE_MCAST].RxInvalid++;
+        }
+    }
+    recordQueueDepth(LINK_SOCKET_FIRMWARE_MCAST, drained);
+    
+    _firmwareMulticast.update();
+    
+    // Block report to the Toughbook (state changes, announces and queries)
+    size_t reportSize = _firmwareMulticast.takeReport(&report);
+    if (reportSize > 0) {
+        _firmwareMulticastUdp.beginPacket(TOUGHBOOK_IP, FIRMWARE_REPORT_PORT);
+        _firmwareMulticastUdp.write((const uint8_t*)&report, reportSize);
+        if (finishPacket(_firmwareMulticastUdp, LINK_SOCKET_FIRMWARE_MCAST)) {
+            _packetsSent++;
+        } else {
+            logNetworkEvent("Firmware multicast: Failed to send block report", LOG_WARNING);
+        }
+    }
+    
+    // Status packets while a session runs and on every state change
+    uint32_t now = millis();
+    FirmwareMulticastState_t state = _firmwareMulticast.getState();
+    if (state != _lastMulticastState ||
+        (_firmwareMulticast.isActive() && now - _lastMulticastStatus >= FIRMWARE_MCAST_STATUS_MS)) {
+        sendModuleStatusResponse();
+        _lastMulticastStatus = now;
+        _lastMulticastState = state;
+    }
+}
+
 uint32_t NetworkManager::getFreeMemory() {
     // Simple free memory estimation for Teensy 4.1
     char* ramend = (char*)0x20280000;  // 512KB RAM on Teensy 4.1
@@ -582,6 +1492,7 @@ int NetworkManager::readRgFModuleUpdateCommand(RgFModuleUpdateCommandPacket* pac
     }
     
     if (packetSize != sizeof(RgFModuleUpdateCommandPacket)) {
+        _linkSockets[LINK_SOCKET_UPDATE_COMMAND].RxWrongSize++;
         logNetworkEvent("RgFModuleUpdate: Invalid command packet size: " + String(packetSize), LOG_WARNING);
         _updateCommandUdp.flush(); // Discard invalid packet
         return -1;
@@ -592,6 +1503,7 @@ int NetworkManager::readRgFModuleUpdateCommand(RgFModuleUpdateCommandPacket* pac
     
     if (bytesRead == sizeof(RgFModuleUpdateCommandPacket)) {
         _packetsReceived++;
+        _linkSockets[LINK_SOCKET_UPDATE_COMMAND].RxPackets++;
         
         // CRITICAL FIX: Ensure strings are null-terminated before logging
         packet->Command[sizeof(packet->Command) - 1] = '\0';
@@ -608,6 +1520,7 @@ int NetworkManager::readRgFModuleUpdateCommand(RgFModuleUpdateCommandPacket* pac
         return bytesRead;
     }
     
+    _linkSockets[LINK_SOCKET_UPDATE_COMMAND].RxInvalid++;
     logNetworkEvent("RgFModuleUpdate: Failed to read command packet", LOG_ERROR);
     return -1;
 }
@@ -622,7 +1535,7 @@ void NetworkManager::sendRgFModuleUpdateStatus(const RgFModuleUpdateStatusPacket
     _updateStatusUdp.beginPacket(TOUGHBOOK_IP, OTA_RESPONSE_PORT);
     _updateStatusUdp.write((const uint8_t*)&packet, sizeof(RgFModuleUpdateStatusPacket));
     
-    if (_updateStatusUdp.endPacket()) {
+    if (finishPacket(_updateStatusUdp, LINK_SOCKET_UPDATE_STATUS)) {
         _packetsSent++;
         
         // Log successful transmission
@@ -635,42 +1548,3 @@ void NetworkManager::sendRgFModuleUpdateStatus(const RgFModuleUpdateStatusPacket
         logNetworkEvent("RgFModuleUpdate: Failed to send status packet", LOG_ERROR);
     }
 }
-
-// =================================================================
-// RTCM Data Validation Implementation
-// =================================================================
-
-bool NetworkManager::validateRtcmData(const uint8_t* data, size_t len) {
-    if (!data || len == 0) {
-        return false;
-    }
-    
-    // RTCM3 messages start with preamble 0xD3
-    if (data[0] != 0xD3) {
-        DiagnosticManager::logError("NetworkManager", "Invalid RTCM preamble: 0x" + String(data[0], HEX));
-        return false;
-    }
-    
-    // Basic length validation - RTCM messages are typically 6-1023 bytes
-    if (len < 6 || len > 1023) {
-        DiagnosticManager::logError("NetworkManager", "Invalid RTCM message length: " + String(len) + " bytes");
-        return false;
-    }
-    
-    // Extract message length from header (bits 14-23 of first 3 bytes)
-    if (len >= 3) {
-        uint16_t messageLength = ((data[1] & 0x03) << 8) | data[2];
-        uint16_t expectedTotalLength = messageLength + 6; // Message + header + CRC
-        
-        if (len != expectedTotalLength) {
-            DiagnosticManager::logError("NetworkManager", 
-                "RTCM length mismatch: received " + String(len) + " bytes, expected " + String(expectedTotalLength) + " bytes");
-            return false;
-        }
-    }
-    
-    // Basic CRC validation would go here, but requires full CRC24Q implementation
-    // For now, we'll rely on the above basic format checks
-    
-    return true;
-}
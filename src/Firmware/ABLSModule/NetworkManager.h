@@ -4,8 +4,12 @@
  * 
  * Handles UDP communication for all module roles:
  * - Centre Module: RTCM broadcasting, hydraulic command receiving, sensor data sending
- * - Wing Modules: RTCM receiving, sensor data sending
- * - All Modules: Toughbook communication, OTA update support
+ * - Wing Modules: RTCM receiving, sensor data sending, radar height to the centre
+ * - All Modules: Toughbook communication, OTA update support, profiler export
+ * - Link-quality telemetry: per-socket loss counters, command sequence gaps
+ *   and round-trip probes to the Toughbook
+ * - Ethernet link, DHCP (static fallback) and sockets come up from update()
+ *   without blocking; nothing is sent or read until they are ready
  * 
  * Author: James Hassall @ RobotsGoFarming.com
  * Version: 1.0.0
@@ -19,6 +23,10 @@
 #include "DataPackets.h"
 #include "ModuleConfig.h"
 #include "DiagnosticManager.h"
+#include "RtcmFramer.h"
+#include "FirmwareMulticastReceiver.h"
+#include "DeadlineMonitor.h"
+#include "StartupSequencer.h"
 
 using namespace qindesign::network;
 
@@ -33,28 +41,121 @@ class SensorManager;
 #define RTCM_PORT          8003
 #define RTCM_BROADCAST_IP   IPAddress(192, 168, 1, 255)
 
+#define COMMAND_MAX_PACKETS_PER_POLL 16      // Bound on command datagrams drained per update
+#define RTCM_MAX_DATAGRAM_SIZE      1500    // Largest correction datagram accepted
+#define RTCM_MAX_DATAGRAMS_PER_POLL 8       // Bound on datagrams drained per update
+
+// RTCM relay (centre module) - how corrections reach the wings
+typedef enum {
+    RTCM_RELAY_BROADCAST = 0,   // Subnet broadcast to RTCM_BROADCAST_IP (legacy)
+    RTCM_RELAY_MULTICAST = 1,   // Wings join RTCM_MULTICAST_GROUP
+    RTCM_RELAY_UNICAST = 2      // One datagram per configured target
+} RtcmRelayMode_t;
+
+// Inclusive range of RTCM message types passed by the relay filter
+typedef struct {
+    uint16_t first;
+    uint16_t last;
+} RtcmTypeRange_t;
+
+#define RTCM_MULTICAST_GROUP        IPAddress(239, 192, 1, 3)
+#define RTCM_WING_LEFT_IP           IPAddress(192, 168, 1, 101)
+#define RTCM_WING_RIGHT_IP          IPAddress(192, 168, 1, 103)
+
+#ifndef RTCM_RELAY_DEFAULT_MODE
+#define RTCM_RELAY_DEFAULT_MODE     RTCM_RELAY_MULTICAST    // Must match on all modules
+#endif
+
+#define RTCM_RELAY_MAX_TARGETS      4
+#define RTCM_RELAY_MAX_FILTER_RANGES 16
+#define RTCM_RELAY_QUEUE_SIZE       4096    // Frames waiting to be coalesced
+#define RTCM_RELAY_MAX_PAYLOAD      1472    // One Ethernet MTU of UDP payload
+#define RTCM_RELAY_COALESCE_MS      10      // Longest a frame waits for company
+#define RTCM_RELAY_MIN_GAP_US       1000    // Pacing between relay datagrams
+
+// Local levelling - wing heights go straight to the centre module
+#define LEVELLING_CENTRE_IP         IPAddress(192, 168, 1, 102)
+#define LEVELLING_MAX_PACKETS_PER_POLL 8    // Both wings plus supervision, with headroom
+
+// Multicast firmware distribution (all modules listen)
+#define FIRMWARE_MCAST_GROUP        IPAddress(239, 192, 1, 4)
+#define FIRMWARE_MCAST_RX_QUEUE     16      // Datagrams buffered between polls
+#define FIRMWARE_MCAST_MAX_PER_POLL 8       // Bound on blocks programmed per update
+#define FIRMWARE_MCAST_STATUS_MS    1000    // Status packet interval during a session
+
+// Non-blocking Ethernet bring-up, advanced one step per update()
+typedef enum {
+    NET_START_STACK = 0,    // Ethernet.begin() failed - retry after NETWORK_RETRY_INTERVAL_MS
+    NET_START_LINK,         // Waiting for PHY link
+    NET_START_ADDRESS,      // DHCP in progress, static fallback after NETWORK_DHCP_TIMEOUT_MS
+    NET_START_SOCKETS,      // Start sockets, retried after NETWORK_RETRY_INTERVAL_MS on failure
+    NET_START_DONE
+} NetworkStartState_t;
+
+#define NETWORK_LINK_TIMEOUT_MS     10000   // No link this long is reported as retrying
+#define NETWORK_DHCP_TIMEOUT_MS     10000   // Then the role's static address
+#define NETWORK_RETRY_INTERVAL_MS   5000
+
+// Sensor send schedule and timing telemetry
+#define SENSOR_SEND_PERIOD_US       20000   // 50Hz sensor packet
+#define TIMING_STATUS_INTERVAL_MS   10000   // Periodic deadline summary
+
+// Link-quality telemetry - sent with the timing summary
+#define LINK_PROBE_INTERVAL_MS      1000    // RTT probe to the Toughbook
+#define LINK_PROBE_TIMEOUT_MS       2000    // Later echoes are not timed
+#define LINK_PROBE_MAX_PER_POLL     4       // Bound on echoes drained per update
+#define LINK_COMMAND_RESYNC_WINDOW  1000    // CommandId jumps beyond this restart gap tracking
+
+#ifndef SENSOR_WIRE_DEFAULT_FORMAT
+#define SENSOR_WIRE_DEFAULT_FORMAT  SENSOR_WIRE_V2
+#endif
+
 class NetworkManager {
 public:
     NetworkManager();
     
-    // Initialization and lifecycle
-    bool initialize();
+    // Initialization and lifecycle - initialize() starts the stack and returns
+    // at once; update() brings up link, address and sockets in the background
+    void initialize();
     void update();
     bool isInitialized() { return _initialized; }
+    StageState_t getStartupState();
     
     // Sensor data transmission (all modules)
+    bool isSensorSendDue() { return _sensorSendDeadline.due(micros()); }
     void sendSensorData(const SensorDataPacket& packet);
+    void setSensorWireFormat(SensorWireFormat_t format);     // Before initialize(), or at any time
+    SensorWireFormat_t getSensorWireFormat() { return _sensorWireFormat; }
     
     // Command reception (centre module only)
     int readCommandPacket(ControlCommandPacket* packet);
     
+    // Local levelling - wings publish radar height (before initialize())
+    void setLevellingPublish(bool enable) { _enableLevellingSend = enable; }
+    uint32_t getLevellingPacketsSent() { return _levellingPacketsSent; }
+    uint32_t getLevellingPacketsReceived() { return _levellingPacketsReceived; }
+    uint32_t getLevellingPacketsRejected() { return _levellingPacketsRejected; }
+    
+    // Link-quality telemetry (LinkStatusPacket)
+    const LinkSocketRecord& getLinkSocketStats(LinkSocket_t socket) { return _linkSockets[socket]; }
+    uint32_t getCommandsMissed() { return _commandsMissed; }
+    uint32_t getLastRoundTripMicros() { return _rttLastUs; }
+    
     // RTCM correction handling
     void broadcastRtcmData(const uint8_t* data, size_t len);  // Centre module only
     int readRtcmData(uint8_t* buffer, size_t maxSize);        // Wing modules only
     
+    // RTCM relay configuration (mode before initialize(), on all modules)
+    void setRtcmRelayMode(RtcmRelayMode_t mode) { _rtcmRelayMode = mode; }
+    RtcmRelayMode_t getRtcmRelayMode() { return _rtcmRelayMode; }
+    bool addRtcmRelayTarget(const IPAddress& target);
+    void clearRtcmRelayTargets() { _rtcmRelayTargetCount = 0; }
+    void setRtcmTypeFilter(const RtcmTypeRange_t* ranges, uint8_t count);  // count 0 = relay all
+    
     // Component integration
     void setHydraulicController(HydraulicController* controller);
     void setSensorManager(SensorManager* sensorManager);
+    DeadlineMonitor& getSensorSendDeadline() { return _sensorSendDeadline; }
     
     // Network status
     IPAddress getLocalIP() { return Ethernet.localIP(); }
@@ -63,23 +164,42 @@ public:
     // RgFModuleUpdate protocol (all modules)
     int readRgFModuleUpdateCommand(RgFModuleUpdateCommandPacket* packet);
     void sendRgFModuleUpdateStatus(const RgFModuleUpdateStatusPacket& packet);
+    FirmwareMulticastReceiver& getFirmwareMulticast() { return _firmwareMulticast; }
     
     // Statistics
     uint32_t getPacketsSent() { return _packetsSent; }
     uint32_t getPacketsReceived() { return _packetsReceived; }
+    uint32_t getCommandsSuperseded() { return _commandsSuperseded; }
     uint32_t getRtcmBytesSent() { return _rtcmBytesSent; }
     uint32_t getRtcmBytesReceived() { return _rtcmBytesReceived; }
+    RtcmFramer& getRtcmFramer() { return _rtcmFramer; }
+    uint32_t getRtcmFramesRelayed() { return _rtcmFramesRelayed; }
+    uint32_t getRtcmFramesFiltered() { return _rtcmFramesFiltered; }
+    uint32_t getRtcmFramesDropped() { return _rtcmFramesDropped; }
+    uint32_t getRtcmDatagramsSent() { return _rtcmDatagramsSent; }
 
 private:
     // Initialization state
     bool _initialized;
     bool _ethernetInitialized;
+    NetworkStartState_t _startState;
+    uint32_t _startStateTime;       // millis() on entering _startState
+    uint16_t _startFailures;
+    bool _staticFallback;
     
     // Module role-specific configuration
+#if ABLS_ROLE_FIXED
+    static constexpr ModuleRole_t _moduleRole = ModuleConfig::getBuildRole();
+    static constexpr bool _enableRtcmBroadcast = ModuleConfig::isCentreBuild();
+    static constexpr bool _enableRtcmReceive = ModuleConfig::isWingBuild();
+    static constexpr bool _enableCommandReceive = ModuleConfig::isCentreBuild();
+#else
     ModuleRole_t _moduleRole;
     bool _enableRtcmBroadcast;  // Centre module only
     bool _enableRtcmReceive;    // Wing modules only
     bool _enableCommandReceive; // Centre module only
+#endif
+    bool _enableLevellingSend;  // Wing modules only
     
     // Network objects
     EthernetUDP _sensorUdp;     // For sending sensor data to Toughbook
@@ -87,6 +207,10 @@ private:
     EthernetUDP _rtcmUdp;       // For RTCM correction data
     EthernetUDP _updateCommandUdp;  // For receiving RgFModuleUpdate commands
     EthernetUDP _updateStatusUdp;   // For sending RgFModuleUpdate status responses
+    EthernetUDP _firmwareMulticastUdp;  // Multicast firmware blocks in, block reports out
+    EthernetUDP _profilerUdp;   // Profile requests in, LoopProfiler reports out
+    EthernetUDP _levellingUdp;  // Wing heights out (wings), heights and supervision in (centre)
+    EthernetUDP _linkProbeUdp;  // RTT probes out, Toughbook echoes in
     
     // Component references
     HydraulicController* _hydraulicController;
@@ -95,34 +219,119 @@ private:
     // Network configuration
     IPAddress _localIP;
     uint8_t _macAddress[6];
+    IPAddress _benchmarkTarget;     // RUN_BENCHMARK requester, while results are sent
+    
+    // RTCM stream reassembly (wing modules receive, centre module relay input)
+    RtcmFramer _rtcmFramer;
+    
+    // RTCM relay (centre module)
+    RtcmRelayMode_t _rtcmRelayMode;
+    IPAddress _rtcmRelayTargets[RTCM_RELAY_MAX_TARGETS];
+    uint8_t _rtcmRelayTargetCount;
+    RtcmTypeRange_t _rtcmTypeFilter[RTCM_RELAY_MAX_FILTER_RANGES];
+    uint8_t _rtcmTypeFilterCount;
+    uint8_t _rtcmRelayQueue[RTCM_RELAY_QUEUE_SIZE];
+    size_t _rtcmRelayQueued;
+    uint32_t _rtcmRelayOldestMillis;    // millis() when the oldest queued frame arrived
+    uint32_t _rtcmRelayLastSendMicros;
+    uint32_t _rtcmFramesRelayed;
+    uint32_t _rtcmFramesFiltered;
+    uint32_t _rtcmFramesDropped;
+    uint32_t _rtcmDatagramsSent;
+    
+    // Multicast firmware distribution
+    FirmwareMulticastReceiver _firmwareMulticast;
+    bool _firmwareMulticastStarted;
+    uint32_t _lastMulticastStatus;
+    FirmwareMulticastState_t _lastMulticastState;
+    
+    // Sensor data wire format
+    SensorWireFormat_t _sensorWireFormat;
+    uint32_t _sensorSequence;
+    
+    // Sensor send schedule and timing telemetry
+    DeadlineMonitor _sensorSendDeadline;
+    uint32_t _lastTimingStatus;
+    uint32_t _timingWindowStart;
+    
+    // Local levelling
+    uint32_t _levellingSequence;
+    uint32_t _lastRadarUpdate;      // RadarSnapshot::updateMillis last published
+    uint32_t _levellingPacketsSent;
+    uint32_t _levellingPacketsReceived;
+    uint32_t _levellingPacketsRejected;
+    IPAddress _autotuneTarget;      // Last autotune requester - ram reports go back to it
+    uint16_t _autotunePort;
+    
+    // Link-quality telemetry
+    LinkSocketRecord _linkSockets[LINK_SOCKET_COUNT];
+    bool _commandSequenceStarted;
+    uint32_t _lastCommandId;        // Newest CommandId seen
+    uint32_t _commandsMissed;
+    uint32_t _commandsDuplicated;
+    uint32_t _commandsReordered;
+    uint32_t _commandResyncs;
+    uint32_t _linkProbeSequence;
+    uint32_t _lastLinkProbe;
+    uint32_t _probesSent;           // Window figures from here on
+    uint32_t _probesAnswered;
+    uint32_t _rttMinUs;
+    uint32_t _rttMaxUs;
+    uint64_t _rttTotalUs;
+    uint32_t _rttLastUs;
+    uint32_t _linkWindowStart;
+    uint32_t _linkTxFailuresReported;   // Totals at the last loss log line
+    uint32_t _linkRxDroppedReported;
     
     // Statistics
     uint32_t _packetsSent;
     uint32_t _packetsReceived;
+    uint32_t _commandsSuperseded;   // Drained behind a newer CommandId, never applied
     uint32_t _rtcmBytesSent;
     uint32_t _rtcmBytesReceived;
     uint32_t _lastStatsUpdate;
     
     // Timing
     uint32_t _lastSensorDataSent;
-    uint32_t _lastCommandCheck;
     uint32_t _lastRtcmCheck;
     
     // Internal methods
-    bool initializeEthernet();
+    bool startEthernet();
+    void updateStartup(uint32_t now);
+    void setStartState(NetworkStartState_t state);
     void configureMACAddress();
     void configureIPAddress();
     bool startUDPSockets();
     void processIncomingCommands();
     void processIncomingRtcm();
+    void processIncomingLevelling();
+    void processProfilerRequests();
+    void sendWingHeight();
+    void handleAutotuneRequest(const AutotuneRequestPacket& request);
+    void serviceAutotune();
+    void sendAutotuneReport(AutotuneReportPacket& report);
     void processRgFModuleUpdateCommands();
+    void processFirmwareMulticast();
     void sendModuleStatusResponse();
+    void sendTimingStatus(bool closeWindow);
+    static void fillTimingRecord(DeadlineMonitor& monitor, TimingChannelRecord* record, bool closeWindow);
+    bool finishPacket(EthernetUDP& udp, LinkSocket_t socket);
+    void recordQueueDepth(LinkSocket_t socket, int depth);
+    void trackCommandSequence(uint32_t commandId);
+    void serviceLinkProbe(uint32_t now);
+    void sendLinkStatus(bool closeWindow);
     void handleStartUpdateCommand(const RgFModuleUpdateCommandPacket* command);
     void handleAbortUpdateCommand();
+    void handleBenchmarkCommand();
+    static void sendBenchmarkLine(const char* line, size_t len, void* context);
     uint32_t getFreeMemory();
     void updateStatistics();
     void logNetworkEvent(const String& event, LogLevel_t level = LOG_INFO);
-    bool validateRtcmData(const uint8_t* data, size_t len);
+    static void rtcmFrameHandler(const uint8_t* frame, size_t len, uint16_t messageType, void* context);
+    void queueRtcmRelayFrame(const uint8_t* frame, size_t len, uint16_t messageType);
+    bool isRtcmTypeRelayed(uint16_t messageType);
+    void serviceRtcmRelay();
+    bool sendRtcmDatagram(const uint8_t* data, size_t len);
 };
 
 #endif // NETWORK_MANAGER_H
@@ -2,9 +2,11 @@
 #include "DiagnosticManager.h"
 #include "ModuleConfig.h"
 #include "NetworkManager.h"
-// FlasherX functionality - Direct implementation for OTA updates
-// TODO: Integrate FlasherX library when properly configured
-// For now, using placeholder functions for compilation and basic OTA infrastructure
+#include "FirmwareHash.h"
+#include "FlightRecorder.h"
+#include "LoopProfiler.h"
+// Download, verification and flashing are RgFModuleUpdater's - this file
+// only handles the legacy OTA command protocol around them
 
 // Static member definitions
 EthernetUDP OTAUpdateManager::_otaUdp;
@@ -14,9 +16,6 @@ OTACommandPacket OTAUpdateManager::_currentCommand;
 uint32_t OTAUpdateManager::_updateStartTime = 0;
 uint32_t OTAUpdateManager::_lastProgressReport = 0;
 
-uint8_t* OTAUpdateManager::_firmwareBuffer = nullptr;
-uint32_t OTAUpdateManager::_firmwareBufferSize = 0;
-uint32_t OTAUpdateManager::_bytesReceived = 0;
 uint32_t OTAUpdateManager::_expectedSize = 0;
 uint32_t OTAUpdateManager::_expectedChecksum = 0;
 
@@ -29,6 +28,9 @@ bool OTAUpdateManager::initialize() {
     // Initialize version manager
     VersionManager::initialize();
     
+    // Hash backend (DCP self-test) before anything verifies firmware
+    FirmwareHash::initialize();
+    
     // Initialize RgFModuleUpdater
     if (!RgFModuleUpdater::initialize()) {
         DiagnosticManager::logMessage(LOG_ERROR, "OTAUpdateManager", "Failed to initialize RgFModuleUpdater");
@@ -60,6 +62,8 @@ bool OTAUpdateManager::initialize() {
 void OTAUpdateManager::update() {
     if (!_networkInitialized) return;
     
+    PROFILE_SCOPE(PROBE_OTA_UPDATE);
+    
     uint32_t now = millis();
     
     // Process incoming OTA commands
@@ -115,35 +119,16 @@ bool OTAUpdateManager::startUpdate(const OTACommandPacket& command) {
     _currentCommand = command;
     _updateInProgress = true;
     _updateStartTime = millis();
-    _bytesReceived = 0;
     _expectedSize = command.FirmwareSize;
     _expectedChecksum = command.Checksum;
     
-    // Allocate firmware buffer
-    _firmwareBufferSize = command.FirmwareSize;
-    _firmwareBuffer = (uint8_t*)malloc(_firmwareBufferSize);
-    if (!_firmwareBuffer) {
-        handleUpdateError("Failed to allocate firmware buffer");
-        return false;
-    }
-    
-    // Create backup of current firmware before update
-    DiagnosticManager::logMessage(LOG_INFO, "OTAUpdateManager", "Creating backup of current firmware");
-    BackupResult_t backupResult = FlashBackupManager::backupCurrentFirmware();
-    if (backupResult != BACKUP_SUCCESS) {
-        String errorMsg = "Failed to backup current firmware: " + String(backupResultToString(backupResult));
-        handleUpdateError(errorMsg);
-        return false;
-    }
-    
-    DiagnosticManager::logMessage(LOG_INFO, "OTAUpdateManager", "Firmware backup completed successfully");
-    
-    // Start the update process
+    // Start the update process - RgFModuleUpdater backs up the running
+    // image just before flashing it
     VersionManager::setUpdateStatus(UPDATE_DOWNLOADING, 0);
     
     // Begin firmware download
     if (!downloadFirmware(String(command.DownloadUrl), command.FirmwareSize, command.Checksum)) {
-        handleUpdateError("Firmware download failed");
+        handleUpdateError("Firmware update failed: " + RgFModuleUpdater::getStatusMessage());
         return false;
     }
     
@@ -192,6 +177,8 @@ bool OTAUpdateManager::rollbackFirmware() {
 
 void OTAUpdateManager::rebootModule() {
     DiagnosticManager::logMessage(LOG_INFO, "OTAUpdateManager", "Rebooting module");
+    FlightRecorder::stop();
+    DiagnosticManager::flushLog();
     
     // Give time for message to be sent
     delay(1000);
@@ -235,69 +222,13 @@ bool OTAUpdateManager::areAllSystemsHealthy() {
 bool OTAUpdateManager::downloadFirmware(const String& url, uint32_t expectedSize, uint32_t expectedChecksum) {
     DiagnosticManager::logMessage(LOG_INFO, "OTAUpdateManager", "Downloading firmware from: " + url);
     
-    // For now, simulate firmware download
-    // In a real implementation, this would use HTTP client to download firmware
-    
-    VersionManager::reportUpdateProgress(UPDATE_DOWNLOADING, 25, "Connecting to server");
-    delay(1000);
-    
-    VersionManager::reportUpdateProgress(UPDATE_DOWNLOADING, 50, "Downloading firmware");
-    delay(2000);
-    
-    VersionManager::reportUpdateProgress(UPDATE_DOWNLOADING, 75, "Download complete");
-    delay(500);
-    
-    VersionManager::reportUpdateProgress(UPDATE_DOWNLOADING, 100, "Firmware downloaded");
-    
-    // Move to verification phase
-    return verifyFirmware(expectedChecksum);
-}
-
-bool OTAUpdateManager::verifyFirmware(uint32_t expectedChecksum) {
-    DiagnosticManager::logMessage(LOG_INFO, "OTAUpdateManager", "Verifying firmware integrity");
-    
-    VersionManager::setUpdateStatus(UPDATE_VERIFYING, 0);
-    
-    // Simulate firmware verification
-    VersionManager::reportUpdateProgress(UPDATE_VERIFYING, 50, "Calculating checksum");
-    delay(1000);
-    
-    // In a real implementation, calculate actual CRC32 checksum
-    uint32_t calculatedChecksum = expectedChecksum; // Simulate successful verification
-    
-    if (calculatedChecksum != expectedChecksum) {
-        handleUpdateError("Firmware verification failed - checksum mismatch");
+    // Same engine as RgFModuleUpdate commands - streamed into the flash
+    // buffer through the update arena, checked against the command's CRC32,
+    // then flashed and verified
+    if (!RgFModuleUpdater::performUpdate(url, "", expectedSize, expectedChecksum)) {
         return false;
     }
     
-    VersionManager::reportUpdateProgress(UPDATE_VERIFYING, 100, "Firmware verified");
-    
-    // Move to flashing phase
-    return flashFirmware();
-}
-
-bool OTAUpdateManager::flashFirmware() {
-    DiagnosticManager::logMessage(LOG_INFO, "OTAUpdateManager", "Flashing new firmware");
-    
-    VersionManager::setUpdateStatus(UPDATE_FLASHING, 0);
-    
-    // Backup current firmware to alternate bank
-    if (!backupCurrentFirmware()) {
-        handleUpdateError("Failed to backup current firmware");
-        return false;
-    }
-    
-    VersionManager::reportUpdateProgress(UPDATE_FLASHING, 25, "Current firmware backed up");
-    
-    // Flash new firmware
-    VersionManager::reportUpdateProgress(UPDATE_FLASHING, 50, "Writing new firmware");
-    delay(2000);
-    
-    VersionManager::reportUpdateProgress(UPDATE_FLASHING, 75, "Verifying flash write");
-    delay(1000);
-    
-    VersionManager::reportUpdateProgress(UPDATE_FLASHING, 100, "Firmware flashed successfully");
-    
     // Update complete - prepare for reboot
     VersionManager::setUpdateStatus(UPDATE_SUCCESS, 100);
     cleanup();
@@ -310,18 +241,6 @@ bool OTAUpdateManager::flashFirmware() {
     return true;
 }
 
-bool OTAUpdateManager::backupCurrentFirmware() {
-    // In a real implementation, this would copy current firmware to backup bank
-    DiagnosticManager::logMessage(LOG_INFO, "OTAUpdateManager", "Backing up current firmware");
-    return true;
-}
-
-bool OTAUpdateManager::restoreFromBackup() {
-    // In a real implementation, this would restore firmware from backup bank
-    DiagnosticManager::logMessage(LOG_INFO, "OTAUpdateManager", "Restoring firmware from backup");
-    return true;
-}
-
 void OTAUpdateManager::handleUpdateError(const String& error) {
     DiagnosticManager::logError("OTAUpdateManager", "Update error: " + error);
     VersionManager::setUpdateError(error);
@@ -334,14 +253,6 @@ void OTAUpdateManager::cleanup() {
     // Exit update mode and restore normal operation
     UpdateSafetyManager::exitUpdateMode();
     
-    // Free firmware buffer
-    if (_firmwareBuffer) {
-        free(_firmwareBuffer);
-        _firmwareBuffer = nullptr;
-        _firmwareBufferSize = 0;
-    }
-    
-    _bytesReceived = 0;
     _expectedSize = 0;
     _expectedChecksum = 0;
     
@@ -456,7 +367,7 @@ void OTAUpdateManager::sendOTAResponse(const OTACommandPacket& originalCommand,
     _otaUdp.write((const uint8_t*)&response, sizeof(OTAResponsePacket));
     _otaUdp.endPacket();
     
-    DiagnosticManager::logMessage(LOG_DEBUG, "OTAUpdateManager", 
+    DIAG_LOG(LOG_DEBUG, "OTAUpdateManager", 
         "Sent OTA response: " + String(responseCode) + " - " + message);
 }
 
@@ -15,7 +15,8 @@ using namespace qindesign::network;
 // =================================================================
 // OTA Update Manager for ABLS Firmware
 // =================================================================
-// Handles firmware updates using RgFModuleUpdater
+// Legacy OTA command front end - download, verify and flash are done by
+// RgFModuleUpdater, the one update engine
 // (based on FlasherX by Joe Pasquariello https://github.com/joepasquariello/FlasherX.git) with Teensy 4.1 
 // dual-bank flash for rollback capability
 // =================================================================
@@ -90,14 +91,10 @@ public:
     static bool isSystemStationary();
     static bool areAllSystemsHealthy();
     
-    // Firmware download and verification
+    // Firmware download, verification and flashing (RgFModuleUpdater)
     static bool downloadFirmware(const String& url, uint32_t expectedSize, uint32_t expectedChecksum);
-    static bool verifyFirmware(uint32_t expectedChecksum);
-    static bool flashFirmware();
     
     // Dual-bank flash management
-    static bool backupCurrentFirmware();
-    static bool restoreFromBackup();
     static bool validateFirmwareBank(uint8_t bankNumber);
     
     // Progress reporting
@@ -119,10 +116,7 @@ private:
     static uint32_t _updateStartTime;
     static uint32_t _lastProgressReport;
     
-    // Firmware buffer management
-    static uint8_t* _firmwareBuffer;
-    static uint32_t _firmwareBufferSize;
-    static uint32_t _bytesReceived;
+    // Expected image (from the OTA command)
     static uint32_t _expectedSize;
     static uint32_t _expectedChecksum;
     
@@ -133,7 +127,6 @@ private:
     // HTTP download helpers
     static bool initializeHttpClient();
     static bool downloadChunk(const String& url, uint32_t offset, uint32_t chunkSize);
-    static uint32_t calculateCRC32(const uint8_t* data, uint32_t length);
     
     // Flash management helpers
     static bool eraseFlashBank(uint8_t bankNumber);
@@ -0,0 +1,214 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Radar Ground/Canopy Tracker Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "RadarTracker.h"
+
+RadarTracker::RadarTracker() :
+    _canopyDepth(0.0f),
+    _output(0.0f),
+    _lastMicros(0),
+    _lastWindowChange(0),
+    _outliers(0),
+    _lockLosses(0)
+{
+    reset();
+}
+
+void RadarTracker::reset() {
+    memset(&_ground, 0, sizeof(_ground));
+    memset(&_canopy, 0, sizeof(_canopy));
+    _canopyDepth = 0.0f;
+    _output = 0.0f;
+    _lastMicros = 0;
+}
+
+bool RadarTracker::update(uint32_t sampleMicros, const RadarPeak* peaks, uint8_t count) {
+    float dt = 0.0f;
+    if (_lastMicros != 0) {
+        dt = (sampleMicros - _lastMicros) * 1e-6f;
+        if (dt > RADAR_TRACK_MAX_DT) dt = RADAR_TRACK_MAX_DT;
+    }
+    _lastMicros = sampleMicros;
+
+    // Usable peaks, farthest first
+    float ranges[2];
+    uint8_t usable = 0;
+    for (uint8_t i = 0; i < count && usable < 2; i++) {
+        if (peaks[i].distanceMm < RADAR_RANGE_MIN_MM || peaks[i].distanceMm > RADAR_RANGE_MAX_MM) continue;
+        if (peaks[i].strength <= RADAR_TRACK_MIN_STRENGTH) continue;
+        ranges[usable++] = peaks[i].distanceMm / 1000.0f;
+    }
+    if (usable == 2 && ranges[1] > ranges[0]) {
+        float swap = ranges[0];
+        ranges[0] = ranges[1];
+        ranges[1] = swap;
+    }
+
+    // Associate: ground takes the farthest peak in its gate, canopy the
+    // nearest remaining one in its own
+    bool used[2] = {false, false};
+    int8_t groundPeak = -1, canopyPeak = -1;
+    if (_ground.active) {
+        for (uint8_t i = 0; i < usable; i++) {
+            if (inGate(_ground, ranges[i], dt)) {
+                groundPeak = i;
+                break;
+            }
+        }
+        if (groundPeak >= 0) used[groundPeak] = true;
+    }
+    if (_canopy.active) {
+        for (int8_t i = usable - 1; i >= 0; i--) {
+            if (!used[i] && inGate(_canopy, ranges[i], dt)) {
+                canopyPeak = i;
+                break;
+            }
+        }
+        if (canopyPeak >= 0) used[canopyPeak] = true;
+    }
+
+    // Correct or coast both tracks
+    if (groundPeak >= 0) {
+        correctTrack(_ground, ranges[groundPeak], dt);
+    } else if (_ground.active) {
+        missTrack(_ground);
+        _ground.range += _ground.rate * dt;
+    }
+    if (canopyPeak >= 0) {
+        correctTrack(_canopy, ranges[canopyPeak], dt);
+    } else if (_canopy.active) {
+        missTrack(_canopy);
+        _canopy.range += _canopy.rate * dt;
+    }
+
+    // Unassigned peaks open tracks where one is missing - a return beyond a
+    // lone ground track means that track was really the canopy
+    for (uint8_t i = 0; i < usable; i++) {
+        if (used[i]) continue;
+        if (!_ground.active) {
+            startTrack(_ground, ranges[i]);
+        } else if (!_canopy.active && ranges[i] < _ground.range - RADAR_TRACK_MIN_SEPARATION_M) {
+            startTrack(_canopy, ranges[i]);
+        } else if (!_canopy.active && ranges[i] > _ground.range + RADAR_TRACK_MIN_SEPARATION_M) {
+            _canopy = _ground;
+            startTrack(_ground, ranges[i]);
+            groundPeak = -1;
+            canopyPeak = -1;
+        } else {
+            _outliers++;    // Spray, dust or stubble between the tracked surfaces
+        }
+    }
+
+    // Two tracks on one surface are one target
+    if (_ground.active && _canopy.active) {
+        if (_canopy.range > _ground.range) {
+            Track swap = _ground;
+            _ground = _canopy;
+            _canopy = swap;
+            int8_t peak = groundPeak;
+            groundPeak = canopyPeak;
+            canopyPeak = peak;
+        }
+        if (_ground.range - _canopy.range < RADAR_TRACK_MIN_SEPARATION_M) {
+            memset(&_canopy, 0, sizeof(_canopy));
+            canopyPeak = -1;
+        }
+    }
+
+    // Canopy depth, learnt while both surfaces are seen together
+    bool groundSeen = (groundPeak >= 0) && _ground.locked;
+    bool canopySeen = (canopyPeak >= 0) && _canopy.locked;
+    if (groundSeen && canopySeen) {
+        float depth = _ground.range - _canopy.range;
+        _canopyDepth = (_canopyDepth == 0.0f) ? depth : _canopyDepth + RADAR_TRACK_DEPTH_FILTER * (depth - _canopyDepth);
+    }
+
+    if (groundSeen) {
+        _output = _ground.range;
+        return true;
+    }
+    if (canopySeen && _canopyDepth > 0.0f) {
+        _output = _canopy.range + _canopyDepth;
+        return true;
+    }
+    return false;
+}
+
+bool RadarTracker::windowChangeNeeded(uint32_t nowMillis, uint32_t currentStart, uint32_t currentEnd,
+                                      uint32_t* start, uint32_t* end) {
+    // Lost the ground - back to the full range straight away
+    if (!_ground.locked) {
+        if (currentStart == RADAR_RANGE_MIN_MM && currentEnd == RADAR_RANGE_MAX_MM) return false;
+        *start = RADAR_RANGE_MIN_MM;
+        *end = RADAR_RANGE_MAX_MM;
+        _lastWindowChange = nowMillis;
+        return true;
+    }
+
+    if (nowMillis - _lastWindowChange < RADAR_WINDOW_MIN_INTERVAL_MS) return false;
+
+    float nearest = _canopy.active ? _canopy.range : _ground.range;
+    int32_t desiredStart = (int32_t)(nearest * 1000.0f) - RADAR_WINDOW_MARGIN_MM;
+    int32_t desiredEnd = (int32_t)(_ground.range * 1000.0f) + RADAR_WINDOW_MARGIN_MM;
+    if (desiredStart < RADAR_RANGE_MIN_MM) desiredStart = RADAR_RANGE_MIN_MM;
+    if (desiredEnd > RADAR_RANGE_MAX_MM) desiredEnd = RADAR_RANGE_MAX_MM;
+
+    // Hysteresis: move only when a surface nears an edge or the window is
+    // much wider than needed
+    int32_t nearMm = (int32_t)(nearest * 1000.0f);
+    int32_t farMm = (int32_t)(_ground.range * 1000.0f);
+    bool nearEdge = (nearMm < (int32_t)currentStart + RADAR_WINDOW_EDGE_MM) ||
+                    (farMm > (int32_t)currentEnd - RADAR_WINDOW_EDGE_MM);
+    bool tooWide = ((int32_t)(currentEnd - currentStart) - (desiredEnd - desiredStart)) > 2 * RADAR_WINDOW_EDGE_MM;
+    if (!nearEdge && !tooWide) return false;
+
+    *start = (uint32_t)desiredStart;
+    *end = (uint32_t)desiredEnd;
+    _lastWindowChange = nowMillis;
+    return true;
+}
+
+void RadarTracker::startTrack(Track& track, float range) {
+    track.range = range;
+    track.rate = 0.0f;
+    track.hits = 1;
+    track.misses = 0;
+    track.active = true;
+    track.locked = false;
+}
+
+void RadarTracker::correctTrack(Track& track, float range, float dt) {
+    float predicted = track.range + track.rate * dt;
+    float residual = range - predicted;
+    track.range = predicted + RADAR_TRACK_ALPHA * residual;
+    if (dt > 0.0f) {
+        track.rate += RADAR_TRACK_BETA * residual / dt;
+        if (track.rate > RADAR_TRACK_MAX_RATE) track.rate = RADAR_TRACK_MAX_RATE;
+        if (track.rate < -RADAR_TRACK_MAX_RATE) track.rate = -RADAR_TRACK_MAX_RATE;
+    }
+    if (track.hits < 255) track.hits++;
+    track.misses = 0;
+    if (track.hits >= RADAR_TRACK_CONFIRM_HITS) track.locked = true;
+}
+
+void RadarTracker::missTrack(Track& track) {
+    if (!track.locked) {
+        // A tentative track lives only while its hits are consecutive
+        _outliers += track.hits;
+        memset(&track, 0, sizeof(track));
+        return;
+    }
+    if (++track.misses >= RADAR_TRACK_LOST_MISSES) {
+        _lockLosses++;
+        memset(&track, 0, sizeof(track));
+    }
+}
+
+bool RadarTracker::inGate(const Track& track, float range, float dt) {
+    return fabsf(range - (track.range + track.rate * dt)) <= RADAR_TRACK_GATE_M;
+}
@@ -0,0 +1,99 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Radar Ground/Canopy Tracker
+ *
+ * Dual-target tracking of the XM125 distance peaks (RADAR_MODE_TRACKING):
+ * - Alpha-beta range/rate tracks for the ground (farthest return) and the
+ *   crop canopy above it, each confirmed after a few consistent hits
+ * - Peaks are gated against the predicted ranges; anything outside both
+ *   gates (spray droplets, stubble, dust) is rejected as an outlier
+ * - Output is always ground distance - from the canopy plus the filtered
+ *   canopy depth while only the canopy is seen - so the height reference
+ *   no longer jumps between ground and canopy with peak strength
+ * - Suggests a measurement window around the locked tracks, and the full
+ *   range again once lock is lost
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef RADAR_TRACKER_H
+#define RADAR_TRACKER_H
+
+#include <Arduino.h>
+
+// Detector range limits (boom height 0.1m - 3.0m)
+#define RADAR_RANGE_MIN_MM          100
+#define RADAR_RANGE_MAX_MM          3000
+
+// Tracking
+#define RADAR_TRACK_MIN_STRENGTH    100     // Weaker peaks are ignored
+#define RADAR_TRACK_GATE_M          0.12f   // Association gate about the predicted range
+#define RADAR_TRACK_MIN_SEPARATION_M 0.08f  // Ground and canopy closer than this are one target
+#define RADAR_TRACK_ALPHA           0.5f
+#define RADAR_TRACK_BETA            0.1f
+#define RADAR_TRACK_MAX_RATE        2.0f    // m/s - clamps the rate estimate
+#define RADAR_TRACK_CONFIRM_HITS    3       // Consecutive hits before a track is locked
+#define RADAR_TRACK_LOST_MISSES     10      // Consecutive misses before a track is dropped
+#define RADAR_TRACK_DEPTH_FILTER    0.05f   // Canopy depth smoothing per measurement
+#define RADAR_TRACK_MAX_DT          0.2f    // Longest gap predicted across (s)
+
+// Measurement window
+#define RADAR_WINDOW_MARGIN_MM      250     // Beyond the nearest and farthest track
+#define RADAR_WINDOW_EDGE_MM        100     // Re-centre when a track comes this close to an edge
+#define RADAR_WINDOW_MIN_INTERVAL_MS 500    // Between narrowing/re-centring reconfigurations
+
+// One detector peak
+struct RadarPeak {
+    uint32_t distanceMm;                // 0 = no peak
+    int32_t strength;
+};
+
+class RadarTracker {
+public:
+    RadarTracker();
+
+    void reset();
+
+    // One measurement (up to two peaks, any order). Returns true when a
+    // ground distance is available for this measurement.
+    bool update(uint32_t sampleMicros, const RadarPeak* peaks, uint8_t count);
+
+    float getGroundDistance() const { return _output; }         // Metres
+    bool isGroundLocked() const { return _ground.locked; }
+    bool isCanopyLocked() const { return _canopy.locked; }
+    float getCanopyDepth() const { return _canopyDepth; }       // Metres, 0 = unknown
+    uint32_t getOutlierCount() const { return _outliers; }
+    uint32_t getLockLossCount() const { return _lockLosses; }
+
+    // Window the detector should use, given the one it has. Returns true and
+    // fills start/end (mm) when it should be reprogrammed.
+    bool windowChangeNeeded(uint32_t nowMillis, uint32_t currentStart, uint32_t currentEnd,
+                            uint32_t* start, uint32_t* end);
+
+private:
+    struct Track {
+        float range;                    // m
+        float rate;                     // m/s
+        uint8_t hits;
+        uint8_t misses;
+        bool active;
+        bool locked;
+    };
+
+    Track _ground;
+    Track _canopy;
+    float _canopyDepth;
+    float _output;
+    uint32_t _lastMicros;
+    uint32_t _lastWindowChange;
+    uint32_t _outliers;
+    uint32_t _lockLosses;
+
+    static void startTrack(Track& track, float range);
+    static void correctTrack(Track& track, float range, float dt);
+    void missTrack(Track& track);
+    static bool inGate(const Track& track, float range, float dt);
+};
+
+#endif // RADAR_TRACKER_H
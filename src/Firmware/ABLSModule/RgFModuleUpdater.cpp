@@ -22,6 +22,7 @@
  */
 
 #include "RgFModuleUpdater.h"
+#include "FlashBackupManager.h"
 #include <string.h>
 
 extern "C" {
@@ -32,6 +33,7 @@ extern "C" {
 bool RgFModuleUpdater::_initialized = false;
 uint32_t RgFModuleUpdater::_flashBuffer = 0;
 uint32_t RgFModuleUpdater::_flashBufferSize = 0;
+uint32_t RgFModuleUpdater::_flashBufferErased = 0;
 uint32_t RgFModuleUpdater::_backupBuffer = 0;
 uint32_t RgFModuleUpdater::_backupSize = 0;
 bool RgFModuleUpdater::_hasBackup = false;
@@ -42,11 +44,30 @@ uint8_t RgFModuleUpdater::_progress = 0;
 String RgFModuleUpdater::_statusMessage = "";
 FirmwareInfo RgFModuleUpdater::_newFirmwareInfo = {0};
 
+uint8_t RgFModuleUpdater::_expectedSha256[32] = {0};
+bool RgFModuleUpdater::_hasExpectedHash = false;
+uint32_t RgFModuleUpdater::_expectedSize = 0;
+uint32_t RgFModuleUpdater::_expectedCrc32 = 0;
+
+uint8_t* RgFModuleUpdater::_streamChunk = nullptr;
+uint32_t RgFModuleUpdater::_streamChunkFill = 0;
+uint32_t RgFModuleUpdater::_streamCommitted = 0;
+uint32_t RgFModuleUpdater::_streamResumes = 0;
+uint32_t RgFModuleUpdater::_streamReceived = 0;
+
+uint32_t RgFModuleUpdater::_stagedSize = 0;
+
+bool RgFModuleUpdater::_streamModeKnown = false;
+bool RgFModuleUpdater::_deltaMode = false;
+DeltaPatcher RgFModuleUpdater::_deltaPatcher;
+
 ProgressCallback RgFModuleUpdater::_progressCallback = nullptr;
 DiagnosticManager* RgFModuleUpdater::_diagnostics = nullptr;
 
 const char* RgFModuleUpdater::EXPECTED_TARGET_ID = FLASH_ID;
 
+static_assert(FLASH_SECTOR_SIZE == UPDATE_ARENA_SECTOR_SIZE, "Update arena sized for a different flash sector");
+
 //******************************************************************************
 // initialize() - Initialize the RgFModuleUpdater system
 //******************************************************************************
@@ -92,7 +113,7 @@ void RgFModuleUpdater::setDiagnosticManager(DiagnosticManager* diagnostics) {
 //******************************************************************************
 // createFlashBuffer() - Create flash buffer for firmware download
 //******************************************************************************
-bool RgFModuleUpdater::createFlashBuffer() {
+bool RgFModuleUpdater::createFlashBuffer(bool eraseNow) {
     if (!_initialized) {
         setError(UpdateError::BUFFER_INIT_FAILED, "RgFModuleUpdater not initialized");
         return false;
@@ -106,12 +127,19 @@ bool RgFModuleUpdater::createFlashBuffer() {
     setStatus(UPDATE_DOWNLOADING, "Creating flash buffer...");
     updateProgress(10);
     
-    // Use FlasherX firmware_buffer_init function
-    int result = firmware_buffer_init(&_flashBuffer, &_flashBufferSize);
-    
-    if (result != 0) {
-        setError(UpdateError::BUFFER_INIT_FAILED, String("Flash buffer creation failed: ") + String(result));
-        return false;
+    if (eraseNow) {
+        // Use FlasherX firmware_buffer_init function
+        int result = firmware_buffer_init(&_flashBuffer, &_flashBufferSize);
+        
+        if (result != 0) {
+            setError(UpdateError::BUFFER_INIT_FAILED, String("Flash buffer creation failed: ") + String(result));
+            return false;
+        }
+        _flashBufferErased = _flashBufferSize;
+    } else {
+        // Streaming download erases each sector just before programming it
+        firmware_buffer_locate(&_flashBuffer, &_flashBufferSize);
+        _flashBufferErased = 0;
     }
     
     logMessage(LOG_INFO, String("Flash buffer created: 0x") + String(_flashBuffer, HEX) + 
@@ -126,10 +154,15 @@ bool RgFModuleUpdater::createFlashBuffer() {
 //******************************************************************************
 void RgFModuleUpdater::freeFlashBuffer() {
     if (_flashBuffer != 0) {
-        firmware_buffer_free(_flashBuffer, _flashBufferSize);
+        // Only the sectors actually used need erasing again
+        if (_flashBufferErased > 0) {
+            firmware_buffer_free(_flashBuffer, _flashBufferErased);
+        }
+        abortStream();
         logMessage(LOG_INFO, "Flash buffer freed");
         _flashBuffer = 0;
         _flashBufferSize = 0;
+        _flashBufferErased = 0;
     }
 }
 
@@ -180,36 +213,38 @@ bool RgFModuleUpdater::validateFirmware() {
     setStatus(UPDATE_VERIFYING, "Validating firmware...");
     updateProgress(60);
     
-    // Read firmware from flash buffer for validation
-    uint8_t* firmwareData = new uint8_t[_newFirmwareInfo.size];
-    if (!readFlashBlock(_flashBuffer, firmwareData, _newFirmwareInfo.size)) {
-        delete[] firmwareData;
-        setError(UpdateError::VALIDATION_FAILED, "Failed to read firmware for validation");
+    // Validate firmware integrity - the buffer is memory-mapped flash, so
+    // it is hashed in place rather than copied to RAM
+    if (!validateFirmwareIntegrity((const uint8_t*)_flashBuffer, _newFirmwareInfo.size)) {
+        setError(UpdateError::VALIDATION_FAILED, "Firmware integrity check failed");
         return false;
     }
     
-    // Validate firmware integrity
-    if (!validateFirmwareIntegrity(firmwareData, _newFirmwareInfo.size)) {
-        delete[] firmwareData;
-        setError(UpdateError::VALIDATION_FAILED, "Firmware integrity check failed");
+    // Hash from the update command, when one was given
+    if (_hasExpectedHash && memcmp(_newFirmwareInfo.sha256_hash, _expectedSha256, 32) != 0) {
+        logMessage(LOG_ERROR, String("Expected: ") + sha256ToString(_expectedSha256));
+        logMessage(LOG_ERROR, String("Actual:   ") + sha256ToString(_newFirmwareInfo.sha256_hash));
+        setError(UpdateError::VALIDATION_FAILED, "Firmware hash does not match update command");
+        return false;
+    }
+    if (_expectedCrc32 != 0 && _newFirmwareInfo.crc32 != _expectedCrc32) {
+        setError(UpdateError::VALIDATION_FAILED, String("Firmware CRC32 0x") + String(_newFirmwareInfo.crc32, HEX) + 
+                 " does not match update command (0x" + String(_expectedCrc32, HEX) + ")");
         return false;
     }
     
     // Validate firmware compatibility
     if (!validateFirmwareCompatibility()) {
-        delete[] firmwareData;
         setError(UpdateError::VALIDATION_FAILED, "Firmware compatibility check failed");
         return false;
     }
     
     // Check for target ID in firmware
     if (!check_flash_id(_flashBuffer, _newFirmwareInfo.size)) {
-        delete[] firmwareData;
         setError(UpdateError::VALIDATION_FAILED, "Target ID not found in firmware");
         return false;
     }
     
-    delete[] firmwareData;
     updateProgress(70);
     logMessage(LOG_INFO, "Firmware validation successful");
     
@@ -234,9 +269,19 @@ bool RgFModuleUpdater::flashFirmware() {
         return false;
     }
     
-    // Create backup of current firmware if requested
+    // Back up the running image - nothing is erased without a way back
     if (!createBackup()) {
-        logMessage(LOG_WARNING, "Failed to create firmware backup");
+        return false;
+    }
+    
+    // Flash cannot be programmed from flash, so each sector of the copy
+    // passes through the update arena - taken before anything is erased
+    uint32_t chunkSize = FLASH_SECTOR_SIZE;
+    uint8_t* chunkData = UpdateArena::acquire(UPDATE_ARENA_FLASH, chunkSize);
+    if (!chunkData) {
+        setError(UpdateError::FLASH_FAILED, String("Update arena busy (") + 
+                 UpdateArena::useToString(UpdateArena::getOwner()) + ")");
+        return false;
     }
     
     // Erase main flash area (current firmware)
@@ -246,6 +291,7 @@ bool RgFModuleUpdater::flashFirmware() {
         uint32_t sectorAddr = FLASH_BASE_ADDR + (i * FLASH_SECTOR_SIZE);
         
         if (flash_erase_sector(sectorAddr) != 0) {
+            UpdateArena::release(UPDATE_ARENA_FLASH);
             setError(UpdateError::FLASH_FAILED, String("Failed to erase sector: 0x") + String(sectorAddr, HEX));
             return false;
         }
@@ -253,34 +299,32 @@ bool RgFModuleUpdater::flashFirmware() {
     
     // Copy firmware from buffer to main flash
     uint32_t bytesFlashed = 0;
-    uint32_t chunkSize = 4096; // 4KB chunks
     
     while (bytesFlashed < _newFirmwareInfo.size) {
         uint32_t remainingBytes = _newFirmwareInfo.size - bytesFlashed;
         uint32_t currentChunk = (remainingBytes < chunkSize) ? remainingBytes : chunkSize;
         
         // Read chunk from buffer
-        uint8_t* chunkData = new uint8_t[currentChunk];
         if (!readFlashBlock(_flashBuffer + bytesFlashed, chunkData, currentChunk)) {
-            delete[] chunkData;
+            UpdateArena::release(UPDATE_ARENA_FLASH);
             setError(UpdateError::FLASH_FAILED, "Failed to read firmware chunk");
             return false;
         }
         
         // Write chunk to main flash
         if (flash_write_block(FLASH_BASE_ADDR + bytesFlashed, chunkData, currentChunk) != 0) {
-            delete[] chunkData;
+            UpdateArena::release(UPDATE_ARENA_FLASH);
             setError(UpdateError::FLASH_FAILED, "Failed to write firmware chunk");
             return false;
         }
         
-        delete[] chunkData;
         bytesFlashed += currentChunk;
         
         // Update progress
         uint8_t flashProgress = 80 + (10 * bytesFlashed / _newFirmwareInfo.size);
         updateProgress(flashProgress);
     }
+    UpdateArena::release(UPDATE_ARENA_FLASH);
     
     updateProgress(90);
     logMessage(LOG_INFO, String("Firmware flashed: ") + String(bytesFlashed) + " bytes");
@@ -307,12 +351,62 @@ bool RgFModuleUpdater::verifyFirmware() {
 }
 
 //******************************************************************************
-// performUpdate() - Complete update workflow (placeholder for URL download)
+// performUpdate() - Complete update workflow from HTTP URL
 //******************************************************************************
-bool RgFModuleUpdater::performUpdate(const String& firmwareUrl) {
-    // TODO: Implement HTTP download from URL
-    setError(UpdateError::NETWORK_ERROR, "URL download not yet implemented");
-    return false;
+bool RgFModuleUpdater::performUpdate(const String& firmwareUrl, const String& expectedHash, uint32_t expectedSize,
+                                     uint32_t expectedCrc32) {
+    logMessage(LOG_INFO, "Starting firmware update from URL...");
+    
+    // Expected image from the update command
+    _hasExpectedHash = false;
+    if (expectedHash.length() > 0) {
+        if (!parseSha256String(expectedHash, _expectedSha256)) {
+            setError(UpdateError::INVALID_FIRMWARE, "Invalid firmware hash in update command");
+            return false;
+        }
+        _hasExpectedHash = true;
+    }
+    _expectedSize = expectedSize;
+    _expectedCrc32 = expectedCrc32;
+    
+    // Step 1: Locate flash buffer (sectors erased during download)
+    if (!createFlashBuffer(false)) {
+        return false;
+    }
+    
+    // Step 2: Stream firmware into the buffer, hashing as it arrives
+    if (!downloadFirmware(firmwareUrl)) {
+        freeFlashBuffer();
+        return false;
+    }
+    
+    // Step 3: Validate firmware
+    if (!validateFirmware()) {
+        freeFlashBuffer();
+        return false;
+    }
+    
+    // Step 4: Flash firmware
+    if (!flashFirmware()) {
+        freeFlashBuffer();
+        return false;
+    }
+    
+    // Step 5: Verify firmware
+    if (!verifyFirmware()) {
+        freeFlashBuffer();
+        return false;
+    }
+    
+    // Step 6: Cleanup
+    freeFlashBuffer();
+    
+    setStatus(UPDATE_SUCCESS, "Firmware update completed successfully");
+    updateProgress(100);
+    
+    logMessage(LOG_INFO, "Firmware update completed - reboot required");
+    
+    return true;
 }
 
 //******************************************************************************
@@ -362,7 +456,138 @@ bool RgFModuleUpdater::performUpdateFromBuffer(const uint8_t* data, uint32_t siz
 }
 
 //******************************************************************************
-// downloadFirmware() - Download firmware from HTTP URL (local Toughbook server)
+// beginStagedDownload() - Reserve the flash buffer for an out-of-order image
+//******************************************************************************
+bool RgFModuleUpdater::beginStagedDownload(uint32_t imageSize, uint32_t stagingSize, const uint8_t* expectedSha256) {
+    if (imageSize == 0 || stagingSize < imageSize || !expectedSha256) {
+        setError(UpdateError::INVALID_FIRMWARE, "Invalid staged download parameters");
+        return false;
+    }
+    
+    // Step 1: Locate flash buffer (erased by eraseStagedSectors)
+    if (!createFlashBuffer(false)) {
+        return false;
+    }
+    
+    if (stagingSize > _flashBufferSize) {
+        freeFlashBuffer();
+        setError(UpdateError::INSUFFICIENT_SPACE, String("Staged image too large for buffer: ") + String(stagingSize));
+        return false;
+    }
+    
+    memcpy(_expectedSha256, expectedSha256, 32);
+    _hasExpectedHash = true;
+    _expectedSize = imageSize;
+    _expectedCrc32 = 0;
+    _stagedSize = stagingSize;
+    _deltaMode = false;
+    
+    setStatus(UPDATE_DOWNLOADING, "Preparing staging area...");
+    logMessage(LOG_INFO, String("Staged download: ") + String(imageSize) + " byte image, " + 
+               String(stagingSize) + " bytes staged");
+    return true;
+}
+
+//******************************************************************************
+// eraseStagedSectors() - Erase up to maxSectors more of the staging area
+//******************************************************************************
+bool RgFModuleUpdater::eraseStagedSectors(uint32_t maxSectors) {
+    if (_flashBuffer == 0 || _stagedSize == 0) {
+        return false;
+    }
+    
+    for (uint32_t n = 0; n < maxSectors && _flashBufferErased < _stagedSize; n++) {
+        uint32_t address = _flashBuffer + _flashBufferErased;
+        if (!eraseFlashRange(address, FLASH_SECTOR_SIZE)) {
+            setError(UpdateError::FLASH_FAILED, String("Failed to erase sector: 0x") + String(address, HEX));
+            return false;
+        }
+        _flashBufferErased += FLASH_SECTOR_SIZE;
+    }
+    return true;
+}
+
+//******************************************************************************
+// writeStagedBlock() - Program one block into the erased staging area
+//******************************************************************************
+bool RgFModuleUpdater::writeStagedBlock(uint32_t offset, const uint8_t* data, uint32_t size) {
+    if (_flashBuffer == 0 || (uint64_t)offset + size > _flashBufferErased) {
+        setError(UpdateError::DOWNLOAD_FAILED, String("Staged block outside erased area: ") + String(offset));
+        return false;
+    }
+    
+    uint32_t address = _flashBuffer + offset;
+    if (!writeFlashBlock(address, data, size) || memcmp((const void*)address, data, size) != 0) {
+        setError(UpdateError::FLASH_FAILED, String("Failed to program block: 0x") + String(address, HEX));
+        return false;
+    }
+    return true;
+}
+
+//******************************************************************************
+// completeStagedDownload() - Validate, flash and verify the staged image
+//******************************************************************************
+bool RgFModuleUpdater::completeStagedDownload() {
+    if (_flashBuffer == 0 || _stagedSize == 0) {
+        setError(UpdateError::DOWNLOAD_FAILED, "No staged download in progress");
+        return false;
+    }
+    
+    // The image is only hashed once, by validateFirmware(), against the
+    // hash announced for the session
+    _newFirmwareInfo.size = _expectedSize;
+    _newFirmwareInfo.crc32 = calculateCRC32((const uint8_t*)_flashBuffer, _expectedSize);
+    memcpy(_newFirmwareInfo.sha256_hash, _expectedSha256, 32);
+    strcpy(_newFirmwareInfo.target_id, FLASH_ID);
+    _stagedSize = 0;
+    
+    logMessage(LOG_INFO, String("Staged download completed: ") + String(_expectedSize) + " bytes");
+    updateProgress(80);
+    
+    // Step 3: Validate firmware
+    if (!validateFirmware()) {
+        freeFlashBuffer();
+        return false;
+    }
+    
+    // Step 4: Flash firmware
+    if (!flashFirmware()) {
+        freeFlashBuffer();
+        return false;
+    }
+    
+    // Step 5: Verify firmware
+    if (!verifyFirmware()) {
+        freeFlashBuffer();
+        return false;
+    }
+    
+    // Step 6: Cleanup
+    freeFlashBuffer();
+    
+    setStatus(UPDATE_SUCCESS, "Firmware update completed successfully");
+    updateProgress(100);
+    
+    logMessage(LOG_INFO, "Firmware update completed - reboot required");
+    
+    return true;
+}
+
+//******************************************************************************
+// abortStagedDownload() - Abandon a staged download and release the buffer
+//******************************************************************************
+void RgFModuleUpdater::abortStagedDownload() {
+    if (_stagedSize == 0) {
+        return;
+    }
+    
+    _stagedSize = 0;
+    freeFlashBuffer();
+    setStatus(UPDATE_FAILED, "Staged download aborted");
+}
+
+//******************************************************************************
+// downloadFirmware() - Stream firmware from HTTP URL (local Toughbook server)
 //******************************************************************************
 bool RgFModuleUpdater::downloadFirmware(const String& url) {
     if (!_initialized) {
@@ -390,111 +615,68 @@ bool RgFModuleUpdater::downloadFirmware(const String& url) {
         return false;
     }
     
-    // Create HTTP client
-    qindesign::network::EthernetClient client;
-    
-    // Connect to server
-    if (!client.connect(host.c_str(), port)) {
-        setError(UpdateError::DOWNLOAD_FAILED, String("Failed to connect to ") + host + ":" + String(port));
+    // STREAMING PIPELINE - each sector is hashed, erased and programmed as
+    // soon as it fills, while the Ethernet stack keeps receiving into its
+    // own buffers. A dropped or stalled connection resumes with an HTTP
+    // Range request from the first byte not yet received. A body starting
+    // with the delta magic is a patch, rebuilt against the running image
+    // into the same sector pipeline.
+    if (!beginStream()) {
         return false;
     }
+    _streamResumes = 0;
+    uint32_t totalSize = 0;
     
-    logMessage(LOG_INFO, String("Connected to ") + host + ":" + String(port));
-    updateProgress(40);
-    
-    // Send HTTP GET request
-    client.print("GET ");
-    client.print(path);
-    client.println(" HTTP/1.1");
-    client.print("Host: ");
-    client.println(host);
-    client.println("Connection: close");
-    client.println();
-    
-    // Wait for response
-    unsigned long timeout = millis() + 10000; // 10 second timeout
-    while (client.available() == 0) {
-        if (millis() > timeout) {
-            client.stop();
-            setError(UpdateError::DOWNLOAD_FAILED, "HTTP request timeout");
+    while (true) {
+        StreamResult result = streamFromServer(host, port, path, &totalSize);
+        
+        if (result == StreamResult::COMPLETE) break;
+        if (result == StreamResult::FAILED) return false;
+        
+        if (++_streamResumes > FIRMWARE_STREAM_MAX_RESUMES) {
+            setError(UpdateError::DOWNLOAD_FAILED, String("Download incomplete after ") + 
+                     String(FIRMWARE_STREAM_MAX_RESUMES) + " resumes: " + 
+                     String(_streamReceived) + "/" + String(totalSize));
             return false;
         }
-        delay(10);
-    }
-    
-    // Parse HTTP response headers
-    String line;
-    int contentLength = -1;
-    bool headersComplete = false;
-    
-    while (client.available() && !headersComplete) {
-        line = client.readStringUntil('\n');
-        line.trim();
         
-        if (line.length() == 0) {
-            headersComplete = true;
-        } else if (line.startsWith("Content-Length:")) {
-            contentLength = line.substring(15).toInt();
-        } else if (line.startsWith("HTTP/1.1 ")) {
-            int statusCode = line.substring(9, 12).toInt();
-            if (statusCode != 200) {
-                client.stop();
-                setError(UpdateError::DOWNLOAD_FAILED, String("HTTP error: ") + String(statusCode));
-                return false;
-            }
-        }
+        logMessage(LOG_WARNING, String("Download interrupted - resuming at byte ") + 
+                   String(_streamReceived));
     }
     
-    if (contentLength <= 0) {
-        client.stop();
-        setError(UpdateError::DOWNLOAD_FAILED, "Invalid content length");
+    if (_deltaMode && !_deltaPatcher.isComplete()) {
+        setError(UpdateError::DOWNLOAD_FAILED, "Delta patch ended before image was complete");
         return false;
     }
     
-    if (contentLength > _flashBufferSize) {
-        client.stop();
-        setError(UpdateError::DOWNLOAD_FAILED, "Firmware too large for buffer");
+    // Final partial sector
+    if (_streamChunkFill > 0 && !commitStreamChunk()) {
         return false;
     }
     
-    logMessage(LOG_INFO, String("Downloading ") + String(contentLength) + " bytes...");
-    updateProgress(50);
-    
-    // Download firmware data
-    uint32_t bytesRead = 0;
-    uint8_t* bufferPtr = (uint8_t*)_flashBuffer;
+    // Update firmware info with both CRC32 and SHA256 from the stream
+    finishStream();
+    _newFirmwareInfo.size = _streamCommitted;
+    strcpy(_newFirmwareInfo.target_id, FLASH_ID);
     
-    while (client.available() && bytesRead < contentLength) {
-        int available = client.available();
-        int toRead = min(available, (int)(contentLength - bytesRead));
-        
-        if (toRead > 0) {
-            int actualRead = client.readBytes(bufferPtr + bytesRead, toRead);
-            bytesRead += actualRead;
-            
-            // Update progress
-            uint8_t progress = 50 + (30 * bytesRead / contentLength);
-            updateProgress(progress);
+    if (_deltaMode) {
+        logMessage(LOG_INFO, _deltaPatcher.getStatusString());
+        if (memcmp(_newFirmwareInfo.sha256_hash, _deltaPatcher.getTargetSha256(), 32) != 0) {
+            setError(UpdateError::VALIDATION_FAILED, "Rebuilt image does not match delta target hash");
+            return false;
         }
-        
-        delay(1); // Small delay to prevent overwhelming
     }
     
-    client.stop();
-    
-    if (bytesRead != contentLength) {
-        setError(UpdateError::DOWNLOAD_FAILED, String("Download incomplete: ") + String(bytesRead) + "/" + String(contentLength));
+    // Size from the update command describes the image, not the patch
+    if (_expectedSize > 0 && _streamCommitted != _expectedSize) {
+        setError(UpdateError::DOWNLOAD_FAILED, String("Firmware size mismatch: ") + String(_streamCommitted) + 
+                 " (expected " + String(_expectedSize) + ")");
         return false;
     }
     
-    // Update firmware info with both CRC32 and SHA256
-    _newFirmwareInfo.size = bytesRead;
-    _newFirmwareInfo.crc32 = calculateCRC32((uint8_t*)_flashBuffer, bytesRead);
-    
-    // Calculate SHA256 hash for integrity verification
-    calculateSHA256((uint8_t*)_flashBuffer, bytesRead, _newFirmwareInfo.sha256_hash);
-    
-    logMessage(LOG_INFO, String("Firmware download completed: ") + String(bytesRead) + " bytes");
+    logMessage(LOG_INFO, String(_deltaMode ? "Delta update completed: " : "Firmware download completed: ") + 
+               String(_streamCommitted) + " bytes" +
+               (_streamResumes > 0 ? String(" (") + String(_streamResumes) + " resumes)" : String("")));
     logMessage(LOG_INFO, String("CRC32: 0x") + String(_newFirmwareInfo.crc32, HEX));
     logMessage(LOG_INFO, String("SHA256: ") + sha256ToString(_newFirmwareInfo.sha256_hash));
     updateProgress(80);
@@ -585,6 +767,15 @@ void RgFModuleUpdater::logMessage(LogLevel_t level, const String& message) {
 // Flash operation helpers
 //******************************************************************************
 
+bool RgFModuleUpdater::eraseFlashRange(uint32_t address, uint32_t size) {
+    for (uint32_t offset = 0; offset < size; offset += FLASH_SECTOR_SIZE) {
+        if (flash_sector_not_erased(address + offset) && flash_erase_sector(address + offset) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool RgFModuleUpdater::writeFlashBlock(uint32_t address, const uint8_t* data, uint32_t size) {
     return flash_write_block(address, data, size) == 0;
 }
@@ -658,20 +849,22 @@ bool RgFModuleUpdater::performSafetyChecks() {
 }
 
 uint32_t RgFModuleUpdater::calculateCRC32(const uint8_t* data, uint32_t size) {
-    // Simple CRC32 implementation (to be enhanced with proper CRC32)
-    uint32_t crc = 0xFFFFFFFF;
-    for (uint32_t i = 0; i < size; i++) {
-        crc ^= data[i];
-        for (int j = 0; j < 8; j++) {
-            crc = (crc >> 1) ^ (0xEDB88320 & (-(crc & 1)));
-        }
-    }
-    return ~crc;
+    return FirmwareHash::crc32(data, size);
+}
+
+uint32_t RgFModuleUpdater::updateCRC32(uint32_t crc, const uint8_t* data, uint32_t size) {
+    // Raw running CRC - caller starts with 0xFFFFFFFF and inverts the final value
+    return FirmwareHash::crc32Update(crc, data, size);
 }
 
 bool RgFModuleUpdater::createBackup() {
-    // TODO: Implement firmware backup functionality
-    logMessage(LOG_INFO, "Firmware backup not yet implemented");
+    // The one backup point for every update path (HTTP, buffer, multicast),
+    // taken once the new image has validated and before the old is erased
+    BackupResult_t result = FlashBackupManager::backupCurrentFirmware();
+    if (result != BACKUP_SUCCESS) {
+        setError(UpdateError::FLASH_FAILED, String("Firmware backup failed: ") + backupResultToString(result));
+        return false;
+    }
     return true;
 }
 
@@ -683,6 +876,9 @@ bool RgFModuleUpdater::rollbackFirmware() {
 
 void RgFModuleUpdater::reboot() {
     logMessage(LOG_INFO, "Rebooting system...");
+    if (_diagnostics) {
+        _diagnostics->flushLog();
+    }
     delay(100); // Allow log message to be sent
     REBOOT;
 }
@@ -697,157 +893,11 @@ FirmwareInfo RgFModuleUpdater::getCurrentFirmwareInfo() {
     return info;
 }
 
-//******************************************************************************
-// SHA256 Implementation - Lightweight version for Teensy 4.1
-//******************************************************************************
-
-// SHA256 constants
-static const uint32_t sha256_k[64] = {
-    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-};
-
-// SHA256 helper functions
-#define SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
-#define SHA256_CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
-#define SHA256_MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
-#define SHA256_EP0(x) (SHA256_ROTR(x, 2) ^ SHA256_ROTR(x, 13) ^ SHA256_ROTR(x, 22))
-#define SHA256_EP1(x) (SHA256_ROTR(x, 6) ^ SHA256_ROTR(x, 11) ^ SHA256_ROTR(x, 25))
-#define SHA256_SIG0(x) (SHA256_ROTR(x, 7) ^ SHA256_ROTR(x, 18) ^ ((x) >> 3))
-#define SHA256_SIG1(x) (SHA256_ROTR(x, 17) ^ SHA256_ROTR(x, 19) ^ ((x) >> 10))
-
-struct SHA256_CTX {
-    uint32_t state[8];
-    uint64_t bitlen;
-    uint32_t datalen;
-    uint8_t data[64];
-};
-
-static void sha256_init(SHA256_CTX* ctx) {
-    ctx->datalen = 0;
-    ctx->bitlen = 0;
-    ctx->state[0] = 0x6a09e667;
-    ctx->state[1] = 0xbb67ae85;
-    ctx->state[2] = 0x3c6ef372;
-    ctx->state[3] = 0xa54ff53a;
-    ctx->state[4] = 0x510e527f;
-    ctx->state[5] = 0x9b05688c;
-    ctx->state[6] = 0x1f83d9ab;
-    ctx->state[7] = 0x5be0cd19;
-}
-
-static void sha256_transform(SHA256_CTX* ctx, const uint8_t data[]) {
-    uint32_t a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
-    
-    for (i = 0, j = 0; i < 16; ++i, j += 4)
-        m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
-    for (; i < 64; ++i)
-        m[i] = SHA256_SIG1(m[i - 2]) + m[i - 7] + SHA256_SIG0(m[i - 15]) + m[i - 16];
-    
-    a = ctx->state[0];
-    b = ctx->state[1];
-    c = ctx->state[2];
-    d = ctx->state[3];
-    e = ctx->state[4];
-    f = ctx->state[5];
-    g = ctx->state[6];
-    h = ctx->state[7];
-    
-    for (i = 0; i < 64; ++i) {
-        t1 = h + SHA256_EP1(e) + SHA256_CH(e, f, g) + sha256_k[i] + m[i];
-        t2 = SHA256_EP0(a) + SHA256_MAJ(a, b, c);
-        h = g;
-        g = f;
-        f = e;
-        e = d + t1;
-        d = c;
-        c = b;
-        b = a;
-        a = t1 + t2;
-    }
-    
-    ctx->state[0] += a;
-    ctx->state[1] += b;
-    ctx->state[2] += c;
-    ctx->state[3] += d;
-    ctx->state[4] += e;
-    ctx->state[5] += f;
-    ctx->state[6] += g;
-    ctx->state[7] += h;
-}
-
-static void sha256_update(SHA256_CTX* ctx, const uint8_t data[], size_t len) {
-    uint32_t i;
-    
-    for (i = 0; i < len; ++i) {
-        ctx->data[ctx->datalen] = data[i];
-        ctx->datalen++;
-        if (ctx->datalen == 64) {
-            sha256_transform(ctx, ctx->data);
-            ctx->bitlen += 512;
-            ctx->datalen = 0;
-        }
-    }
-}
-
-static void sha256_final(SHA256_CTX* ctx, uint8_t hash[]) {
-    uint32_t i;
-    
-    i = ctx->datalen;
-    
-    // Pad whatever data is left in the buffer.
-    if (ctx->datalen < 56) {
-        ctx->data[i++] = 0x80;
-        while (i < 56)
-            ctx->data[i++] = 0x00;
-    } else {
-        ctx->data[i++] = 0x80;
-        while (i < 64)
-            ctx->data[i++] = 0x00;
-        sha256_transform(ctx, ctx->data);
-        memset(ctx->data, 0, 56);
-    }
-    
-    // Append to the padding the total message's length in bits and transform.
-    ctx->bitlen += ctx->datalen * 8;
-    ctx->data[63] = ctx->bitlen;
-    ctx->data[62] = ctx->bitlen >> 8;
-    ctx->data[61] = ctx->bitlen >> 16;
-    ctx->data[60] = ctx->bitlen >> 24;
-    ctx->data[59] = ctx->bitlen >> 32;
-    ctx->data[58] = ctx->bitlen >> 40;
-    ctx->data[57] = ctx->bitlen >> 48;
-    ctx->data[56] = ctx->bitlen >> 56;
-    sha256_transform(ctx, ctx->data);
-    
-    // Since this implementation uses little endian byte ordering and SHA uses big endian,
-    // reverse all the bytes when copying the final state to the output hash.
-    for (i = 0; i < 4; ++i) {
-        hash[i] = (ctx->state[0] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 4] = (ctx->state[1] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 8] = (ctx->state[2] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 12] = (ctx->state[3] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 16] = (ctx->state[4] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 20] = (ctx->state[5] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 24] = (ctx->state[6] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 28] = (ctx->state[7] >> (24 - i * 8)) & 0x000000ff;
-    }
-}
-
 //******************************************************************************
 // calculateSHA256() - Calculate SHA256 hash of data
 //******************************************************************************
 void RgFModuleUpdater::calculateSHA256(const uint8_t* data, uint32_t size, uint8_t* hash) {
-    SHA256_CTX ctx;
-    sha256_init(&ctx);
-    sha256_update(&ctx, data, size);
-    sha256_final(&ctx, hash);
+    FirmwareHash::sha256(data, size, hash);
 }
 
 //******************************************************************************
@@ -870,3 +920,352 @@ String RgFModuleUpdater::sha256ToString(const uint8_t* hash) {
     }
     return result;
 }
+
+//******************************************************************************
+// parseSha256String() - Convert 64-char hex string to SHA256 hash
+//******************************************************************************
+bool RgFModuleUpdater::parseSha256String(const String& hex, uint8_t* hash) {
+    if (hex.length() != 64 || !hash) return false;
+    
+    for (int i = 0; i < 32; i++) {
+        uint8_t value = 0;
+        for (int n = 0; n < 2; n++) {
+            char c = hex.charAt(i * 2 + n);
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return false;
+        }
+        hash[i] = value;
+    }
+    return true;
+}
+
+//******************************************************************************
+// Streaming Download Pipeline
+//******************************************************************************
+
+// Running hashes over the bytes committed so far
+static Sha256Context streamSha;
+static uint32_t streamCrc = FIRMWARE_HASH_CRC32_INIT;
+static bool streamShaOpen = false;
+
+bool RgFModuleUpdater::beginStream() {
+    abortStream();
+    
+    _streamChunk = UpdateArena::acquire(UPDATE_ARENA_DOWNLOAD, FLASH_SECTOR_SIZE);
+    if (!_streamChunk) {
+        setError(UpdateError::BUFFER_INIT_FAILED, String("Update arena busy (") + 
+                 UpdateArena::useToString(UpdateArena::getOwner()) + ")");
+        return false;
+    }
+    
+    FirmwareHash::sha256Begin(&streamSha);
+    streamShaOpen = true;
+    streamCrc = FIRMWARE_HASH_CRC32_INIT;
+    _streamChunkFill = 0;
+    _streamCommitted = 0;
+    _streamReceived = 0;
+    _streamModeKnown = false;
+    _deltaMode = false;
+    _deltaPatcher.reset();
+    return true;
+}
+
+void RgFModuleUpdater::finishStream() {
+    FirmwareHash::sha256Finish(&streamSha, _newFirmwareInfo.sha256_hash);
+    streamShaOpen = false;
+    _newFirmwareInfo.crc32 = ~streamCrc;
+    
+    // Everything is in the flash buffer - validation reads it in place
+    UpdateArena::release(UPDATE_ARENA_DOWNLOAD);
+    _streamChunk = nullptr;
+    _streamChunkFill = 0;
+}
+
+void RgFModuleUpdater::abortStream() {
+    // Hands a DCP session back if a download was abandoned part way
+    if (streamShaOpen) {
+        FirmwareHash::sha256Abort(&streamSha);
+        streamShaOpen = false;
+    }
+    UpdateArena::release(UPDATE_ARENA_DOWNLOAD);
+    _streamChunk = nullptr;
+    _streamChunkFill = 0;
+}
+
+//******************************************************************************
+// commitStreamChunk() - Hash, erase and program the staged sector
+//******************************************************************************
+bool RgFModuleUpdater::commitStreamChunk() {
+    uint32_t address = _flashBuffer + _streamCommitted;
+    
+    FirmwareHash::sha256Update(&streamSha, _streamChunk, _streamChunkFill);
+    streamCrc = updateCRC32(streamCrc, _streamChunk, _streamChunkFill);
+    
+    if (!eraseFlashRange(address, FLASH_SECTOR_SIZE)) {
+        setError(UpdateError::FLASH_FAILED, String("Failed to erase sector: 0x") + String(address, HEX));
+        return false;
+    }
+    _flashBufferErased = _streamCommitted + FLASH_SECTOR_SIZE;
+    
+    if (!writeFlashBlock(address, _streamChunk, _streamChunkFill) ||
+        memcmp((const void*)address, _streamChunk, _streamChunkFill) != 0) {
+        setError(UpdateError::FLASH_FAILED, String("Failed to program sector: 0x") + String(address, HEX));
+        return false;
+    }
+    
+    _streamCommitted += _streamChunkFill;
+    _streamChunkFill = 0;
+    return true;
+}
+
+//******************************************************************************
+// consumeStreamBody() - Route HTTP body bytes to the image or delta patcher
+//******************************************************************************
+bool RgFModuleUpdater::consumeStreamBody(const uint8_t* data, uint32_t size) {
+    _streamReceived += size;
+    
+    if (_deltaMode) {
+        DeltaResult_t result = _deltaPatcher.push(data, size);
+        if (result != DELTA_OK) {
+            setError(UpdateError::DOWNLOAD_FAILED, String("Delta patch failed: ") + DeltaPatcher::resultToString(result));
+            return false;
+        }
+        return true;
+    }
+    
+    if (!stageStreamOutput(data, size)) {
+        return false;
+    }
+    
+    // First bytes decide between a full image and a delta patch
+    if (!_streamModeKnown && _streamCommitted == 0 && _streamChunkFill >= 4) {
+        _streamModeKnown = true;
+        
+        if (DeltaPatcher::isDeltaPatch(_streamChunk, _streamChunkFill)) {
+            uint8_t staged[FIRMWARE_STREAM_READ_SIZE + 4];
+            uint32_t stagedSize = _streamChunkFill;
+            memcpy(staged, _streamChunk, stagedSize);
+            _streamChunkFill = 0;
+            
+            // Source is the running image, which ends where the buffer starts
+            _deltaMode = true;
+            _deltaPatcher.begin(CURRENT_FIRMWARE_BASE, _flashBuffer - CURRENT_FIRMWARE_BASE, _flashBufferSize,
+                                deltaOutputHandler, nullptr);
+            logMessage(LOG_INFO, "Delta patch detected - rebuilding against running image");
+            
+            _streamReceived -= stagedSize;
+            return consumeStreamBody(staged, stagedSize);
+        }
+    }
+    return true;
+}
+
+//******************************************************************************
+// stageStreamOutput() - Append image bytes, committing each full sector
+//******************************************************************************
+bool RgFModuleUpdater::stageStreamOutput(const uint8_t* data, uint32_t size) {
+    if ((uint64_t)_streamCommitted + _streamChunkFill + size > _flashBufferSize) {
+        setError(UpdateError::DOWNLOAD_FAILED, "Firmware too large for buffer");
+        return false;
+    }
+    
+    while (size > 0) {
+        uint32_t take = min(size, FLASH_SECTOR_SIZE - _streamChunkFill);
+        memcpy(_streamChunk + _streamChunkFill, data, take);
+        _streamChunkFill += take;
+        data += take;
+        size -= take;
+        
+        if (_streamChunkFill == FLASH_SECTOR_SIZE && !commitStreamChunk()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RgFModuleUpdater::deltaOutputHandler(const uint8_t* data, size_t len, void* context) {
+    return stageStreamOutput(data, len);
+}
+
+//******************************************************************************
+// readHttpHeaderLine() - Read one CRLF-terminated header line before deadline
+//******************************************************************************
+bool RgFModuleUpdater::readHttpHeaderLine(qindesign::network::EthernetClient& client, String& line, uint32_t deadline) {
+    line = "";
+    while ((int32_t)(millis() - deadline) < 0) {
+        int c = client.read();
+        if (c < 0) {
+            if (!client.connected()) return false;
+            yield();
+            continue;
+        }
+        if (c == '\n') {
+            line.trim();
+            return true;
+        }
+        if (line.length() < 256) line += (char)c;
+    }
+    return false;
+}
+
+//******************************************************************************
+// streamFromServer() - One HTTP GET (ranged when resuming) into the buffer
+//******************************************************************************
+StreamResult RgFModuleUpdater::streamFromServer(const String& host, int port, const String& path, uint32_t* totalSize) {
+    uint32_t resumeOffset = _streamReceived;
+    
+    // Create HTTP client
+    qindesign::network::EthernetClient client;
+    
+    // Connect to server
+    if (!client.connect(host.c_str(), port)) {
+        logMessage(LOG_WARNING, String("Failed to connect to ") + host + ":" + String(port));
+        return StreamResult::INTERRUPTED;
+    }
+    
+    if (resumeOffset == 0) {
+        logMessage(LOG_INFO, String("Connected to ") + host + ":" + String(port));
+        updateProgress(40);
+    }
+    
+    // Send HTTP GET request
+    client.print("GET ");
+    client.print(path);
+    client.println(" HTTP/1.1");
+    client.print("Host: ");
+    client.println(host);
+    if (resumeOffset > 0) {
+        client.print("Range: bytes=");
+        client.print(resumeOffset);
+        client.println("-");
+    }
+    client.println("Connection: close");
+    client.println();
+    
+    // Parse HTTP response headers
+    uint32_t deadline = millis() + FIRMWARE_HTTP_TIMEOUT_MS;
+    String line;
+    int statusCode = 0;
+    int32_t contentLength = -1;
+    int32_t rangeStart = -1;
+    int32_t rangeTotal = -1;
+    
+    if (!readHttpHeaderLine(client, line, deadline) || !line.startsWith("HTTP/1.")) {
+        client.stop();
+        logMessage(LOG_WARNING, "HTTP response timeout");
+        return StreamResult::INTERRUPTED;
+    }
+    statusCode = line.substring(9, 12).toInt();
+    
+    while (true) {
+        if (!readHttpHeaderLine(client, line, deadline)) {
+            client.stop();
+            logMessage(LOG_WARNING, "HTTP header timeout");
+            return StreamResult::INTERRUPTED;
+        }
+        if (line.length() == 0) break;
+        
+        String lower = line;
+        lower.toLowerCase();
+        if (lower.startsWith("content-length:")) {
+            contentLength = line.substring(15).toInt();
+        } else if (lower.startsWith("content-range:")) {
+            // Content-Range: bytes <first>-<last>/<total>
+            int bytes = lower.indexOf("bytes ");
+            int dash = (bytes > 0) ? line.indexOf('-', bytes) : -1;
+            int slash = line.indexOf('/');
+            if (dash > bytes) rangeStart = line.substring(bytes + 6, dash).toInt();
+            if (slash > 0) rangeTotal = line.substring(slash + 1).toInt();
+        }
+    }
+    
+    if (statusCode == 200) {
+        // Full body - server ignored Range (or this is the first request)
+        if (resumeOffset > 0) {
+            logMessage(LOG_WARNING, "Server does not support Range - restarting download");
+            if (!beginStream()) {
+                client.stop();
+                return StreamResult::FAILED;
+            }
+            resumeOffset = 0;
+        }
+        if (contentLength <= 0) {
+            client.stop();
+            setError(UpdateError::DOWNLOAD_FAILED, "Invalid content length");
+            return StreamResult::FAILED;
+        }
+        *totalSize = contentLength;
+    } else if (statusCode == 206 && resumeOffset > 0) {
+        if (rangeTotal <= 0 || (uint32_t)rangeTotal != *totalSize) {
+            client.stop();
+            setError(UpdateError::DOWNLOAD_FAILED, "Firmware changed on server during resume");
+            return StreamResult::FAILED;
+        }
+        if (rangeStart != (int32_t)resumeOffset) {
+            // Body does not continue from the first byte not yet received -
+            // drop it and start again with a plain GET
+            client.stop();
+            logMessage(LOG_WARNING, String("Server resumed at byte ") + String(rangeStart) + ", not " +
+                       String(resumeOffset) + " - restarting download");
+            return beginStream() ? StreamResult::INTERRUPTED : StreamResult::FAILED;
+        }
+    } else {
+        client.stop();
+        setError(UpdateError::DOWNLOAD_FAILED, String("HTTP error: ") + String(statusCode));
+        return StreamResult::FAILED;
+    }
+    
+    if (*totalSize > _flashBufferSize) {
+        client.stop();
+        setError(UpdateError::DOWNLOAD_FAILED, "Firmware too large for buffer");
+        return StreamResult::FAILED;
+    }
+    
+    if (resumeOffset == 0) {
+        logMessage(LOG_INFO, String("Downloading ") + String(*totalSize) + " bytes...");
+        updateProgress(50);
+    }
+    
+    // Download firmware data into the sector pipeline
+    uint8_t buffer[FIRMWARE_STREAM_READ_SIZE];
+    uint32_t received = resumeOffset;
+    uint32_t lastData = millis();
+    uint8_t lastProgress = _progress;
+    
+    while (received < *totalSize) {
+        int available = client.available();
+        if (available <= 0) {
+            // A transient TCP stall is not an error - wait, then resume
+            if (!client.connected() || (millis() - lastData > FIRMWARE_STREAM_STALL_MS)) {
+                break;
+            }
+            yield();
+            continue;
+        }
+        
+        uint32_t toRead = min((uint32_t)available, min((uint32_t)sizeof(buffer), *totalSize - received));
+        int actualRead = client.read(buffer, toRead);
+        if (actualRead <= 0) continue;
+        
+        received += actualRead;
+        lastData = millis();
+        
+        if (!consumeStreamBody(buffer, actualRead)) {
+            client.stop();
+            return StreamResult::FAILED;
+        }
+        
+        // Update progress
+        uint8_t progress = 50 + (uint8_t)((uint64_t)30 * received / *totalSize);
+        if (progress != lastProgress) {
+            updateProgress(progress);
+            lastProgress = progress;
+        }
+    }
+    
+    client.stop();
+    return (received == *totalSize) ? StreamResult::COMPLETE : StreamResult::INTERRUPTED;
+}
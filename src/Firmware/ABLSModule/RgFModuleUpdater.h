@@ -27,6 +27,9 @@
 #include <Arduino.h>
 #include <QNEthernet.h>
 #include "FlasherX/FlashTxx.h"
+#include "FirmwareHash.h"
+#include "DeltaPatcher.h"
+#include "UpdateArena.h"
 #include "DiagnosticManager.h"
 #include "VersionManager.h"
 
@@ -53,6 +56,19 @@ enum class UpdateError {
     SAFETY_CHECK_FAILED
 };
 
+// Outcome of one HTTP transfer attempt in the streaming download
+enum class StreamResult {
+    COMPLETE = 0,       // All bytes received and programmed
+    INTERRUPTED,        // Connection closed or stalled - resume with Range
+    FAILED              // Unrecoverable (HTTP error, flash error, size mismatch)
+};
+
+// Streaming download pipeline
+#define FIRMWARE_STREAM_STALL_MS        5000    // Resume after no data for this long
+#define FIRMWARE_STREAM_MAX_RESUMES     5       // HTTP Range retries per download
+#define FIRMWARE_HTTP_TIMEOUT_MS        10000   // Connect and response header timeout
+#define FIRMWARE_STREAM_READ_SIZE       1024    // Bytes taken from the socket per read
+
 // Progress callback function type
 typedef void (*ProgressCallback)(uint8_t progress, UpdateStatus_t status, const String& message);
 
@@ -77,7 +93,7 @@ public:
     static void setDiagnosticManager(DiagnosticManager* diagnostics);
     
     // Flash buffer management
-    static bool createFlashBuffer();
+    static bool createFlashBuffer(bool eraseNow = true);  // false: erase sector by sector while streaming
     static void freeFlashBuffer();
     static uint32_t getBufferAddress() { return _flashBuffer; }
     static uint32_t getBufferSize() { return _flashBufferSize; }
@@ -101,6 +117,8 @@ public:
     static String getStatusMessage() { return _statusMessage; }
     static FirmwareInfo getCurrentFirmwareInfo();
     static FirmwareInfo getNewFirmwareInfo() { return _newFirmwareInfo; }
+    static uint32_t getStreamResumeCount() { return _streamResumes; }
+    static bool isDeltaUpdate() { return _deltaMode; }
     
     // Safety checks
     static bool performSafetyChecks();
@@ -108,14 +126,27 @@ public:
     static bool isNetworkStable();
     
     // Complete update workflow
-    static bool performUpdate(const String& firmwareUrl);
+    // expectedCrc32 is for the legacy OTA command, which carries no hash (0 = not checked)
+    static bool performUpdate(const String& firmwareUrl, const String& expectedHash = "", uint32_t expectedSize = 0,
+                              uint32_t expectedCrc32 = 0);
     static bool performUpdateFromBuffer(const uint8_t* data, uint32_t size);
     
+    // Staged download - blocks written at any offset, in any order (multicast
+    // distribution). The staging area is erased a few sectors at a time.
+    static bool beginStagedDownload(uint32_t imageSize, uint32_t stagingSize, const uint8_t* expectedSha256);
+    static bool eraseStagedSectors(uint32_t maxSectors);
+    static bool isStagingErased() { return _stagedSize > 0 && _flashBufferErased >= _stagedSize; }
+    static bool writeStagedBlock(uint32_t offset, const uint8_t* data, uint32_t size);
+    static bool completeStagedDownload();     // Validate, flash and verify the staged image
+    static void abortStagedDownload();
+    
     // Utility functions
     static uint32_t calculateCRC32(const uint8_t* data, uint32_t size);
+    static uint32_t updateCRC32(uint32_t crc, const uint8_t* data, uint32_t size);
     static void calculateSHA256(const uint8_t* data, uint32_t size, uint8_t* hash);
     static bool validateSHA256Hash(const uint8_t* data, uint32_t size, const uint8_t* expectedHash);
     static String sha256ToString(const uint8_t* hash);
+    static bool parseSha256String(const String& hex, uint8_t* hash);
     static bool validateTargetCompatibility(const char* targetId);
     static void reboot();
     
@@ -124,6 +155,7 @@ private:
     static bool _initialized;
     static uint32_t _flashBuffer;
     static uint32_t _flashBufferSize;
+    static uint32_t _flashBufferErased;     // Bytes of buffer erased so far (freed on cleanup)
     static uint32_t _backupBuffer;
     static uint32_t _backupSize;
     static bool _hasBackup;
@@ -135,6 +167,28 @@ private:
     static String _statusMessage;
     static FirmwareInfo _newFirmwareInfo;
     
+    // Expected image (from the update command)
+    static uint8_t _expectedSha256[32];
+    static bool _hasExpectedHash;
+    static uint32_t _expectedSize;
+    static uint32_t _expectedCrc32;         // 0 = not checked
+    
+    // Streaming download state - one flash sector staged in the update
+    // arena, held from beginStream() to finishStream() / abortStream()
+    static uint8_t* _streamChunk;
+    static uint32_t _streamChunkFill;       // Bytes in _streamChunk
+    static uint32_t _streamCommitted;       // Bytes programmed into the flash buffer
+    static uint32_t _streamResumes;
+    static uint32_t _streamReceived;        // HTTP body bytes consumed (Range resume point)
+    
+    // Staged download - bytes of the buffer in use (image plus parity)
+    static uint32_t _stagedSize;
+    
+    // Delta update - body is a patch against the running image
+    static bool _streamModeKnown;
+    static bool _deltaMode;
+    static DeltaPatcher _deltaPatcher;
+    
     // Callbacks and diagnostics
     static ProgressCallback _progressCallback;
     static DiagnosticManager* _diagnostics;
@@ -158,6 +212,15 @@ private:
     // Network operations
     static bool downloadFromURL(const String& url, uint32_t bufferAddr, uint32_t maxSize);
     static bool parseHttpUrl(const String& url, String& host, int& port, String& path);
+    static StreamResult streamFromServer(const String& host, int port, const String& path, uint32_t* totalSize);
+    static bool readHttpHeaderLine(qindesign::network::EthernetClient& client, String& line, uint32_t deadline);
+    static bool beginStream();
+    static bool commitStreamChunk();
+    static bool consumeStreamBody(const uint8_t* data, uint32_t size);
+    static bool stageStreamOutput(const uint8_t* data, uint32_t size);
+    static bool deltaOutputHandler(const uint8_t* data, size_t len, void* context);
+    static void finishStream();
+    static void abortStream();
     
     // Constants
     static const uint32_t FIRMWARE_HEADER_SIZE = 256;
@@ -0,0 +1,87 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * RTCM3 Stream Framer
+ * 
+ * Recovers RTCM3 frames from a byte stream that arrives in arbitrary chunks:
+ * - Frames may span several UDP datagrams or be packed several per datagram
+ * - Each frame is checked against its CRC24Q before it is passed on
+ * - On a bad header or CRC the framer resynchronises on the next preamble
+ * - Per-message-type counters for diagnostics
+ * 
+ * Frame layout: 0xD3 | 6 reserved bits + 10-bit length | payload | CRC24Q
+ * 
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef RTCM_FRAMER_H
+#define RTCM_FRAMER_H
+
+#include <Arduino.h>
+
+#define RTCM_PREAMBLE               0xD3
+#define RTCM_HEADER_SIZE            3
+#define RTCM_CRC_SIZE               3
+#define RTCM_MAX_PAYLOAD            1023
+#define RTCM_MAX_FRAME_SIZE         (RTCM_HEADER_SIZE + RTCM_MAX_PAYLOAD + RTCM_CRC_SIZE)
+
+#define RTCM_FRAME_TIMEOUT_MS       1000    // Drop a partial frame older than this
+#define RTCM_MAX_TRACKED_TYPES      32      // Distinct message types counted individually
+
+// Called once per valid frame (header, payload and CRC included)
+typedef void (*RtcmFrameHandler_t)(const uint8_t* frame, size_t len, uint16_t messageType, void* context);
+
+class RtcmFramer {
+public:
+    RtcmFramer();
+    
+    // Configuration
+    void setFrameHandler(RtcmFrameHandler_t handler, void* context);
+    void reset();
+    
+    // Feed received bytes - handler runs for each complete valid frame
+    void push(const uint8_t* data, size_t len);
+    
+    // CRC24Q (Qualcomm) over a byte range, as used by RTCM3
+    static uint32_t crc24q(const uint8_t* data, size_t len, uint32_t crc = 0);
+    
+    // Statistics
+    uint32_t getFrameCount() { return _frameCount; }
+    uint32_t getCrcErrors() { return _crcErrors; }
+    uint32_t getBytesDiscarded() { return _bytesDiscarded; }
+    uint32_t getUntrackedFrames() { return _untrackedFrames; }
+    uint8_t getTrackedTypeCount() { return _typeCount; }
+    bool getTypeCounter(uint8_t index, uint16_t* messageType, uint32_t* count);
+    String getStatusString();
+
+private:
+    // Reassembly buffer - holds at most one frame plus unparsed tail
+    uint8_t _buffer[RTCM_MAX_FRAME_SIZE];
+    size_t _count;
+    uint32_t _lastByteMillis;
+    
+    RtcmFrameHandler_t _handler;
+    void* _handlerContext;
+    
+    // Statistics
+    uint32_t _frameCount;
+    uint32_t _crcErrors;
+    uint32_t _bytesDiscarded;
+    uint32_t _untrackedFrames;
+    
+    struct TypeCounter {
+        uint16_t messageType;
+        uint32_t count;
+    };
+    TypeCounter _typeCounters[RTCM_MAX_TRACKED_TYPES];
+    uint8_t _typeCount;
+    
+    static const uint32_t _crcTable[256];
+    
+    // Internal methods
+    void parse();
+    void consume(size_t len);
+    void countType(uint16_t messageType);
+};
+
+#endif // RTCM_FRAMER_H
@@ -8,6 +8,12 @@
 
 #include "SensorManager.h"
 #include "DiagnosticManager.h"
+#include "BinaryLog.h"
+#include "FlightRecorder.h"
+#include "TelemetryBatcher.h"
+#include "I2CBusGuard.h"
+#include "GpsTimeService.h"
+#include "LoopProfiler.h"
 
 // Static member initialization
 SensorManager* SensorManager::_instance = nullptr;
@@ -17,9 +23,18 @@ SensorManager::SensorManager() :
     _gpsInitialized(false),
     _imuInitialized(false),
     _radarInitialized(false),
+    _gpsFailures(0),
+    _imuFailures(0),
+    _radarFailures(0),
+    _lastGpsAttempt(0),
+    _lastImuAttempt(0),
+    _lastRadarAttempt(0),
+#if !ABLS_ROLE_FIXED
     _moduleRole(MODULE_UNKNOWN),
-    _gpsDynamicModel(GPS_MODEL_AUTOMOTIVE),
     _enableDeadReckoning(false),
+#endif
+    _gpsDynamicModel(GPS_MODEL_AUTOMOTIVE),
+    _gnssMode(GNSS_DEFAULT_MODE),
     _freshGpsData(false),
     _gpsLatitude(0.0),
     _gpsLongitude(0.0),
@@ -28,19 +43,19 @@ SensorManager::SensorManager() :
     _gpsVerticalAccuracy(999999),
     _gpsTimeOfWeek(0),
     _gpsValidFix(false),
+    _gpsFixOk(false),
+    _gpsGroundSpeed(0.0f),
+    _gpsHeading(0.0f),
+    _gpsSatellites(0),
     _rtkStatus(RTK_NONE),
     _horizontalAccuracy(99.9f),
     _rtkStatusChanged(false),
     _lastRTKStatusChange(0),
-    _fusedLatitude(0.0f),
-    _fusedLongitude(0.0f),
-    _fusedAltitude(0.0f),
-    _velocityX(0.0f),
-    _velocityY(0.0f),
-    _velocityZ(0.0f),
+    _gpsArrivalMicros(0),
+    _freshFusionFix(false),
     _lastGpsUpdateTime(0),
     _lastImuUpdateTime(0),
-    _lastFusionUpdate(0),
+    _imuDeadline(IMU_REPORT_PERIOD_US),
     _imuQuatI(0.0f),
     _imuQuatJ(0.0f),
     _imuQuatK(0.0f),
@@ -52,111 +67,197 @@ SensorManager::SensorManager() :
     _imuGyroY(0.0f),
     _imuGyroZ(0.0f),
     _imuDataValid(false),
+    _imuAcquisitionMode(IMU_DEFAULT_ACQUISITION_MODE),
+    _imuSamplesDrained(0),
+    _lastImuSampleMicros(0),
+    _imuEdgeMicros(0),
+    _imuPacketsRead(0),
+    _imuReportsDecoded(0),
     _radarDistance(0.0f),
     _radarDataValid(false),
-    _lastRadarUpdate(0)
+    _lastRadarUpdate(0),
+    _radarState(RADAR_STATE_OFFLINE),
+    _radarStateTime(0),
+    _radarCycleStart(0),
+    _radarCalibrationPending(false),
+    _radarBusyTimeouts(0),
+    _radarMeasureMicros(0),
+    _radarSampleMicros(0),
+    _radarMode(RADAR_DEFAULT_MODE),
+    _radarWindowStart(RADAR_RANGE_MIN_MM),
+    _radarWindowEnd(RADAR_RANGE_MAX_MM),
+    _radarPendingStart(RADAR_RANGE_MIN_MM),
+    _radarPendingEnd(RADAR_RANGE_MAX_MM),
+    _radarWindowChanges(0)
 {
     // Set static instance for callback access
     _instance = this;
 }
 
-bool SensorManager::initialize() {
+void SensorManager::initialize() {
     DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "Initializing sensors...");
     
-    // Get module role for conditional initialization
+    // Get module role for conditional initialization (constant in role builds)
+#if !ABLS_ROLE_FIXED
     _moduleRole = ModuleConfig::getRole();
+    _enableDeadReckoning = (_moduleRole == MODULE_LEFT || _moduleRole == MODULE_RIGHT);
+#endif
     
     // Configure based on module role
     switch (_moduleRole) {
         case MODULE_CENTRE:
             _gpsDynamicModel = GPS_MODEL_AUTOMOTIVE;
-            _enableDeadReckoning = false;
             DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "Centre module: Automotive GPS, no dead reckoning");
             break;
             
         case MODULE_LEFT:
         case MODULE_RIGHT:
             _gpsDynamicModel = GPS_MODEL_AIRBORNE1G;
-            _enableDeadReckoning = true;
             DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "Wing module: Airborne GPS, dead reckoning enabled");
             break;
             
         default:
             DiagnosticManager::logError("SensorManager", "Unknown module role - using default configuration");
             _gpsDynamicModel = GPS_MODEL_AUTOMOTIVE;
-            _enableDeadReckoning = false;
             break;
     }
     
-    // Initialize all sensors
+    // First attempt at GPS and IMU; the radar comes up step by step from update().
+    // Anything that fails is retried in the background rather than halting -
+    // hydraulics are already holding and the rest of the module keeps running
+    uint32_t now = millis();
+    
+    _lastGpsAttempt = now;
     _gpsInitialized = initializeGPS();
-    _imuInitialized = initializeIMU();
-    _radarInitialized = initializeRadar();
-    
-    _initialized = (_gpsInitialized && _imuInitialized && _radarInitialized);
-    
-    if (_initialized) {
-        DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "All sensors initialized successfully");
-        DiagnosticManager::setSensorData(
-            getGPSStatusString(),
-            getIMUStatusString(),
-            getRadarStatusString()
-        );
-    } else {
+    if (!_gpsInitialized) _gpsFailures++;
+    
+    {
+        I2CBusLock busLock(IMU_I2C_BUS, I2C_PRIORITY_IMU);  // Hydraulic ADC may already be converting
+        _lastImuAttempt = now;
+        _imuInitialized = initializeIMU();
+    }
+    if (!_imuInitialized) _imuFailures++;
+    
+    // Start interrupt acquisition as soon as the IMU is configured - the deferred
+    // service keeps its reads clear of the radar bring-up on the same bus
+    if (_imuInitialized && _imuAcquisitionMode != IMU_ACQ_POLLED) {
+        startImuInterrupt();
+    }
+    
+    setRadarState(RADAR_STATE_OFFLINE);
+    
+    if (!_gpsInitialized || !_imuInitialized) {
         String failedSensors = "";
         if (!_gpsInitialized) failedSensors += "GPS ";
         if (!_imuInitialized) failedSensors += "IMU ";
-        if (!_radarInitialized) failedSensors += "Radar ";
         
-        DiagnosticManager::logError("SensorManager", "Sensor initialization failed: " + failedSensors);
+        DiagnosticManager::logError("SensorManager", "Sensor initialization failed: " + failedSensors + "- retrying in background");
+    }
+}
+
+void SensorManager::retryFailedSensors(uint32_t now) {
+    // GNSS: connect() blocks for its wait at each baud rate, so only retry once the
+    // receiver is talking on UART1, or rarely if it stays silent
+    if (!_gpsInitialized) {
+        uint32_t sinceAttempt = now - _lastGpsAttempt;
+        bool uartActive = Serial1.available() > 0;
+        if ((uartActive && sinceAttempt >= SENSOR_RETRY_INTERVAL_MS) || sinceAttempt >= GNSS_RETRY_MAX_INTERVAL_MS) {
+            _lastGpsAttempt = now;
+            _gpsInitialized = initializeGPS();
+            if (!_gpsInitialized) logSensorRetry("GPS", ++_gpsFailures);
+            checkAllSensorsInitialized();
+        }
     }
     
-    return _initialized;
+    if (!_imuInitialized && now - _lastImuAttempt >= SENSOR_RETRY_INTERVAL_MS) {
+        _lastImuAttempt = now;
+        {
+            I2CBusLock busLock(IMU_I2C_BUS, I2C_PRIORITY_IMU);
+            _imuInitialized = initializeIMU();
+        }
+        if (_imuInitialized) {
+            if (_imuAcquisitionMode != IMU_ACQ_POLLED) startImuInterrupt();
+        } else {
+            logSensorRetry("IMU", ++_imuFailures);
+        }
+        checkAllSensorsInitialized();
+    }
+}
+
+void SensorManager::checkAllSensorsInitialized() {
+    if (_initialized || !_gpsInitialized || !_imuInitialized || !_radarInitialized) return;
+    
+    _initialized = true;
+    DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "All sensors initialized successfully");
+    DiagnosticManager::setSensorData(
+        getGPSStatusString(),
+        getIMUStatusString(),
+        getRadarStatusString()
+    );
+}
+
+StageState_t SensorManager::getGpsStartupState() {
+    return startupState(_gpsInitialized, _gpsFailures);
+}
+
+StageState_t SensorManager::getImuStartupState() {
+    return startupState(_imuInitialized, _imuFailures);
+}
+
+StageState_t SensorManager::getRadarStartupState() {
+    return startupState(_radarInitialized, _radarFailures);
+}
+
+StageState_t SensorManager::startupState(bool initialized, uint16_t failures) {
+    if (initialized) return STAGE_READY;
+    return (failures == 0) ? STAGE_STARTING : STAGE_RETRYING;
 }
 
 bool SensorManager::initializeGPS() {
-    logSensorStatus("GPS", false); // Starting initialization
+    if (_gpsFailures == 0) logSensorStatus("GPS", false); // Starting initialization (retries log via logSensorRetry)
     
-    // Initialize GPS on Serial1 (UART)
-    if (!_gps.begin(Serial1)) {
-        logSensorStatus("GPS", false);
+    // Open the receiver on Serial1 (UART) and bring it to the role's configuration -
+    // UBX-only UART1, rate, dynamic model, messages and TIMEPULSE grid in one
+    // saved VALSET, skipped entirely on a warm boot that already has it
+    if (!GnssConfig::apply(_gps, Serial1, _gnssMode, getGPSDynamicModel())) {
+        if (_gpsFailures == 0) logSensorStatus("GPS", false);
         return false;
     }
     
-    // Configure GPS for role-specific operation
-    configureGPSForRole();
-    
-    // Enable high-precision position data with callback
-    _gps.setAutoHPPOSLLH(true);
-    _gps.setAutoHPPOSLLHcallbackPtr(&gpsHPPOSLLHCallback);
-    
-    // Set navigation frequency to 10Hz
-    _gps.setNavigationFrequency(10);
+    // Register callbacks - the library re-enables each message in RAM only,
+    // matching the saved configuration
+    _gps.setAutoPVTcallbackPtr(&gpsPVTCallback, VAL_LAYER_RAM);
+    _gps.setAutoHPPOSLLHcallbackPtr(&gpsHPPOSLLHCallback, VAL_LAYER_RAM);
     
-    // Turn off NMEA output to reduce noise
-    _gps.setI2COutput(COM_TYPE_UBX);
+    // Start disciplining the local clock to TIMEPULSE for cross-module sample timestamps
+    GpsTimeService::initialize(GNSS_TIMEPULSE_PIN);
     
     logSensorStatus("GPS", true);
-    DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "GPS configured for " + String(_gpsDynamicModel == GPS_MODEL_AUTOMOTIVE ? "Automotive" : "Airborne") + " mode");
+    DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "GPS configured for " + String(_gpsDynamicModel == GPS_MODEL_AUTOMOTIVE ? "Automotive" : "Airborne") +
+                                  " mode at " + String(GnssConfig::getNavigationRate(_gnssMode)) + "Hz");
     
     return true;
 }
 
 bool SensorManager::initializeIMU() {
-    logSensorStatus("IMU", false); // Starting initialization
-    
-    // Initialize IMU on I2C
-    if (!_bno080.begin()) {
-        DiagnosticManager::logError("SensorManager", "IMU I2C initialization failed");
-        logSensorStatus("IMU", false);
+    if (_imuFailures == 0) logSensorStatus("IMU", false); // Starting initialization (retries log via logSensorRetry)
+    
+    // Initialize IMU on I2C (INT pin lets the library skip reads when no report is ready)
+    I2CBusGuard::beginBus(IMU_I2C_BUS);
+    TwoWire& imuWire = I2CBusGuard::wire(IMU_I2C_BUS);
+    bool imuStarted = (_imuAcquisitionMode != IMU_ACQ_POLLED) ?
+        _bno080.begin(BNO080_DEFAULT_ADDRESS, imuWire, IMU_INT_PIN) :
+        _bno080.begin(BNO080_DEFAULT_ADDRESS, imuWire);
+    if (!imuStarted) {
+        if (_imuFailures == 0) {
+            DiagnosticManager::logError("SensorManager", "IMU I2C initialization failed");
+            logSensorStatus("IMU", false);
+        }
         return false;
     }
     
     // COMPREHENSIVE IMU CONFIGURATION based on SparkFun BNO080 examples
     
-    // Increase I2C speed for better performance (as shown in SparkFun examples)
-    Wire.setClock(400000); // 400kHz I2C for faster IMU communication
-    
     // Enable dynamic calibration for accelerometer and gyroscope (no magnetometer due to metal boom)
     // This enables automatic calibration as shown in SparkFun Example9-Calibrate
     _bno080.calibrateAccelerometer(); // Enable calibration for Accelerometer
@@ -165,12 +266,17 @@ bool SensorManager::initializeIMU() {
     
     DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "IMU dynamic calibration enabled for all sensors");
     
+    if (_imuAcquisitionMode == IMU_ACQ_BATCHED) {
+        enableBatchedReports();
+        return true;
+    }
+    
     // Enable multiple sensor outputs for comprehensive motion sensing
     
     // Primary sensors for navigation and control
     // Note: BNO080 enable methods return void, so we can't check for errors during enable
-    _bno080.enableRotationVector(10); // 10ms = 100Hz - quaternion for orientation
-    _bno080.enableAccelerometer(10); // 10ms = 100Hz - raw acceleration  
+    _bno080.enableRotationVector(IMU_REPORT_PERIOD_US / 1000); // 10ms = 100Hz - quaternion for orientation
+    _bno080.enableAccelerometer(IMU_REPORT_PERIOD_US / 1000); // 10ms = 100Hz - raw acceleration  
     _bno080.enableGyro(10); // 10ms = 100Hz - angular velocity
     
     // Additional sensors for enhanced accuracy and diagnostics
@@ -186,22 +292,8 @@ bool SensorManager::initializeIMU() {
     
     DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "IMU sensors enabled: Rotation Vector, Accelerometer, Gyro, Linear Accel, Game Vector");
     
-    // Allow sensors to stabilize and begin calibration
-    delay(100);
-    
-    // Check initial calibration status
-    if (_bno080.dataAvailable()) {
-        // Try to get initial accuracy readings
-        byte quatAccuracy = _bno080.getQuatAccuracy();
-        byte accelAccuracy = _bno080.getAccelAccuracy();
-        byte gyroAccuracy = _bno080.getGyroAccuracy();
-        // Note: Game rotation vector accuracy not available in this BNO080 library version
-        
-        DiagnosticManager::logMessage(LOG_INFO, "SensorManager", 
-            "IMU initial accuracy - Quat: " + String(quatAccuracy) + 
-            ", Accel: " + String(accelAccuracy) + 
-            ", Gyro: " + String(gyroAccuracy) + " (0=Unreliable, 3=High, Mag disabled for metal boom)");
-    }
+    // Initial accuracy is reported by the periodic calibration check in updateIMU() -
+    // no settling delay here, it would stall the loop on a background retry
     
     // Initialize performance monitoring variables
     _imuDataCount = 0;
@@ -215,159 +307,65 @@ bool SensorManager::initializeIMU() {
     return true;
 }
 
-bool SensorManager::initializeRadar() {
-    logSensorStatus("Radar", false); // Starting initialization
-    
-    // Initialize radar on I2C
-    if (!_radar.begin()) {
-        DiagnosticManager::logError("SensorManager", "Radar I2C initialization failed");
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // COMPREHENSIVE RADAR CONFIGURATION based on SparkFun XM125 examples
-    
-    // Reset sensor configuration to ensure clean state
-    if (_radar.setCommand(SFE_XM125_DISTANCE_RESET_MODULE) != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar reset command failed");
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // Wait for reset to complete
-    if (_radar.busyWait() != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar reset busy wait failed");
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // Check for errors after reset
-    uint32_t errorStatus = 0;
-    _radar.getDetectorErrorStatus(errorStatus);
-    if (errorStatus != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar detector error after reset: " + String(errorStatus));
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    delay(100); // Allow sensor to stabilize
-    
-    // Configure detection range for boom height sensing (100mm to 3000mm)
-    // Start range: 100mm (10cm minimum boom height)
-    if (_radar.setStart(100) != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar start range configuration failed");
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // End range: 3000mm (3m maximum boom height)
-    if (_radar.setEnd(3000) != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar end range configuration failed");
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // Configure threshold settings for agricultural environment
-    // Threshold sensitivity: 200 (moderate sensitivity to ignore spray droplets/dust)
-    if (_radar.setThresholdSensitivity(200) != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar threshold sensitivity configuration failed");
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // Fixed amplitude threshold: 150 (filter out weak reflections)
-    if (_radar.setFixedAmpThreshold(150) != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar amplitude threshold configuration failed");
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    delay(100); // Allow configuration to settle
-    
-    // Apply configuration
-    if (_radar.setCommand(SFE_XM125_DISTANCE_APPLY_CONFIGURATION) != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar configuration application failed");
-        
-        // Check for specific error details
-        _radar.getDetectorErrorStatus(errorStatus);
-        if (errorStatus != 0) {
-            DiagnosticManager::logError("SensorManager", "Radar detector error during config: " + String(errorStatus));
-        }
-        
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // Wait for configuration to complete
-    if (_radar.busyWait() != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar configuration busy wait failed");
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // Final error status check
-    _radar.getDetectorErrorStatus(errorStatus);
-    if (errorStatus != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar detector error after configuration: " + String(errorStatus));
-        logSensorStatus("Radar", false);
-        return false;
-    }
-    
-    // Verify configuration by reading back settings
-    uint32_t startVal = 0, endVal = 0;
-    _radar.getStart(startVal);
-    _radar.getEnd(endVal);
-    
-    DiagnosticManager::logMessage(LOG_INFO, "SensorManager", 
-        "Radar configured successfully - Range: " + String(startVal) + "mm to " + String(endVal) + "mm");
-    
-    logSensorStatus("Radar", true);
-    
-    return true;
-}
-
-void SensorManager::configureGPSForRole() {
-    // Set dynamic model based on module role
-    if (_gpsDynamicModel == GPS_MODEL_AUTOMOTIVE) {
-        _gps.setDynamicModel(DYN_MODEL_AUTOMOTIVE);
-        DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", "GPS dynamic model set to Automotive");
-    } else {
-        _gps.setDynamicModel(DYN_MODEL_AIRBORNE1g);
-        DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", "GPS dynamic model set to Airborne <1g");
-    }
+dynModel SensorManager::getGPSDynamicModel() {
+    // Dynamic model based on module role
+    return (_gpsDynamicModel == GPS_MODEL_AUTOMOTIVE) ? DYN_MODEL_AUTOMOTIVE : DYN_MODEL_AIRBORNE1g;
 }
 
 void SensorManager::update() {
-    if (!_initialized) return;
+    PROFILE_SCOPE(PROBE_SENSOR_UPDATE);
     
     uint32_t now = millis();
     
+    // Bring up any sensor that failed to start; each one below runs as soon as it is up
+    if (!_initialized) {
+        retryFailedSensors(now);
+    }
+    
     // Update GPS (callback-driven, just check for fresh data)
-    updateGPS();
+    if (_gpsInitialized) {
+        updateGPS();
+    }
     
-    // Update IMU at 100Hz
-    if (now - _lastImuUpdateTime >= 10) {
+    // Update IMU - drain the interrupt ring, or poll at 100Hz
+    if (!_imuInitialized) {
+        // Not started yet
+    } else if (_imuAcquisitionMode != IMU_ACQ_POLLED) {
+        drainImuSamples();
+    } else if (_imuDeadline.due(micros())) {
+        I2CBusLock busLock(IMU_I2C_BUS, I2C_PRIORITY_IMU);
         updateIMU();
         _lastImuUpdateTime = now;
     }
     
-    // Update radar at 50Hz
-    if (now - _lastRadarUpdate >= 20) {
+    // Advance radar state machine - bring-up, then measurements (self-paced at 50Hz, never blocks)
+    {
+        I2CBusLock busLock(RADAR_I2C_BUS, I2C_PRIORITY_RADAR);
         updateRadar();
-        _lastRadarUpdate = now;
     }
+    publishRadarSnapshot();
     
-    // Update dead reckoning for wing modules
-    if (_enableDeadReckoning && (now - _lastFusionUpdate >= 20)) {
+    // Apply any new GNSS epoch to the dead reckoning filter (wing modules)
+    if (_enableDeadReckoning && _gpsInitialized && _imuInitialized) {
         updateDeadReckoning();
-        _lastFusionUpdate = now;
     }
     
     // Update RTK status monitoring
-    updateRTKStatus();
+    if (_gpsInitialized) {
+        updateRTKStatus();
+    }
 }
 
 void SensorManager::updateGPS() {
+    PROFILE_SCOPE(PROBE_SENSOR_GPS);
+    
+    // Parse incoming UBX and dispatch the PVT and HPPOSLLH callbacks
+    _gps.checkUblox();
+    _gps.checkCallbacks();
+    
+    // Discipline the local clock to the latest TIMEPULSE edge
+    GpsTimeService::update();
+    
     // GPS data is updated via callback - just check for fresh data
     if (_freshGpsData) {
         _freshGpsData = false;
@@ -390,6 +388,12 @@ void SensorManager::updateGPS() {
             if (_gpsValidFix) {
                 DiagnosticManager::logError("SensorManager", "GPS communication timeout - no data for 10 seconds");
                 _gpsValidFix = false; // Mark GPS as invalid due to timeout
+                
+                // Republish the last epoch flagged invalid
+                GpsSnapshot epoch;
+                _gpsSnapshot.read(epoch);
+                epoch.validFix = false;
+                _gpsSnapshot.write(epoch);
             }
         }
     }
@@ -397,240 +401,726 @@ void SensorManager::updateGPS() {
 
 void SensorManager::updateIMU() {
     // COMPREHENSIVE IMU UPDATE based on SparkFun BNO080 examples (no magnetometer due to metal boom)
+    PROFILE_SCOPE(PROBE_SENSOR_IMU);
     
     // Check if new IMU data is available
-    if (_bno080.dataAvailable()) {
-        // ACCURACY MONITORING - Check sensor accuracy levels (SparkFun Example9-Calibrate pattern)
-        byte quatAccuracy = _bno080.getQuatAccuracy();
-        byte accelAccuracy = _bno080.getAccelAccuracy();
-        byte gyroAccuracy = _bno080.getGyroAccuracy();
-        byte linAccelAccuracy = _bno080.getLinAccelAccuracy();
-        // Note: Game rotation vector accuracy not available in this BNO080 library version
-        
-        // CALIBRATION STATUS MONITORING - Check periodically for calibration needs
-        uint32_t now = millis();
-        if (now - _lastCalibrationCheck > 30000) { // Check every 30 seconds
-            _lastCalibrationCheck = now;
-            
-            // Log accuracy status for diagnostics
-            if (quatAccuracy < 2 || accelAccuracy < 2 || gyroAccuracy < 2) {
-                DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", 
-                    "IMU calibration status - Quat: " + String(quatAccuracy) + 
-                    ", Accel: " + String(accelAccuracy) + 
-                    ", Gyro: " + String(gyroAccuracy) + 
-                    ", LinAccel: " + String(linAccelAccuracy) + " (2+ recommended for reliable operation)");
-            }
-        }
-        
-        // PRIMARY SENSOR DATA - Read rotation vector (quaternion)
-        float quatI = _bno080.getQuatI();
-        float quatJ = _bno080.getQuatJ();
-        float quatK = _bno080.getQuatK();
-        float quatReal = _bno080.getQuatReal();
-        
-        // ENHANCED VALIDATION: Check quaternion accuracy before using
-        if (quatAccuracy == 0) {
-            DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", "IMU quaternion accuracy unreliable - continuing with available data");
-            // Note: Game rotation vector methods not available in this BNO080 library version
-            // Continue with standard quaternion data but mark as lower confidence
-        }
-        
-        // Validate quaternion magnitude
-        float quatMagnitude = sqrt(quatI*quatI + quatJ*quatJ + quatK*quatK + quatReal*quatReal);
-        if (quatMagnitude < 0.9f || quatMagnitude > 1.1f) {
-            DiagnosticManager::logError("SensorManager", "Invalid IMU quaternion magnitude: " + String(quatMagnitude, 4));
-            _imuDataValid = false;
-            return;
-        }
-        
-        // RAW ACCELEROMETER - Read raw acceleration (includes gravity)
-        float accelX = _bno080.getAccelX();
-        float accelY = _bno080.getAccelY();
-        float accelZ = _bno080.getAccelZ();
-        
-        // Validate accelerometer data (reasonable range: -50g to +50g)
-        if (abs(accelX) > 50.0f || abs(accelY) > 50.0f || abs(accelZ) > 50.0f) {
-            DiagnosticManager::logError("SensorManager", "Invalid IMU acceleration values: X=" + String(accelX, 2) + ", Y=" + String(accelY, 2) + ", Z=" + String(accelZ, 2));
-            _imuDataValid = false;
-            return;
-        }
-        
-        // LINEAR ACCELEROMETER - Read gravity-compensated acceleration (SparkFun Example12 pattern)
-        float linAccelX = _bno080.getLinAccelX();
-        float linAccelY = _bno080.getLinAccelY();
-        float linAccelZ = _bno080.getLinAccelZ();
-        
-        // Validate linear acceleration (should be smaller than raw accel)
-        if (abs(linAccelX) > 20.0f || abs(linAccelY) > 20.0f || abs(linAccelZ) > 20.0f) {
-            DiagnosticManager::logError("SensorManager", "Invalid IMU linear acceleration values: X=" + String(linAccelX, 2) + ", Y=" + String(linAccelY, 2) + ", Z=" + String(linAccelZ, 2));
-            _imuDataValid = false;
-            return;
-        }
-        
-        // GYROSCOPE - Read angular velocity
-        float gyroX = _bno080.getGyroX();
-        float gyroY = _bno080.getGyroY();
-        float gyroZ = _bno080.getGyroZ();
-        
-        // Validate gyroscope data (reasonable range: -2000 deg/s)
-        if (abs(gyroX) > 2000.0f || abs(gyroY) > 2000.0f || abs(gyroZ) > 2000.0f) {
-            DiagnosticManager::logError("SensorManager", "Invalid IMU gyroscope values: X=" + String(gyroX, 2) + ", Y=" + String(gyroY, 2) + ", Z=" + String(gyroZ, 2));
-            _imuDataValid = false;
-            return;
-        }
-        
-        // ACCURACY-BASED DATA VALIDATION
-        // Only use data if minimum accuracy is achieved
-        if (quatAccuracy == 0) {
-            DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", "IMU quaternion accuracy = 0 (unreliable) - using with caution");
-            // Continue but mark as lower confidence rather than rejecting completely
-        }
-        
-        if (accelAccuracy == 0) {
-            DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", "IMU accelerometer accuracy unreliable");
-            // Continue but mark as lower confidence
-        }
-        
-        // DATA IS VALID - Update stored values
-        _imuQuatI = quatI;
-        _imuQuatJ = quatJ;
-        _imuQuatK = quatK;
-        _imuQuatReal = quatReal;
-        _imuAccelX = accelX;
-        _imuAccelY = accelY;
-        _imuAccelZ = accelZ;
-        _imuGyroX = gyroX;
-        _imuGyroY = gyroY;
-        _imuGyroZ = gyroZ;
-        
-        // Store linear acceleration for motion analysis
-        _imuLinAccelX = linAccelX;
-        _imuLinAccelY = linAccelY;
-        _imuLinAccelZ = linAccelZ;
-        
-        // Store accuracy levels for external use
-        _imuQuatAccuracy = quatAccuracy;
-        _imuAccelAccuracy = accelAccuracy;
-        _imuGyroAccuracy = gyroAccuracy;
-        
-        _imuDataValid = true;
-        _lastImuUpdateTime = now;
-        
-        // PERFORMANCE MONITORING - Track data rate (SparkFun SPI example pattern)
-        _imuDataCount++;
-        if (_imuDataCount % 1000 == 0) { // Every 1000 samples
-            float dataRate = (float)_imuDataCount / ((now - _imuStartTime) / 1000.0f);
-            DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", 
-                "IMU performance: " + String(dataRate, 1) + "Hz data rate, Accuracy: Q=" + String(quatAccuracy) + 
-                ", A=" + String(accelAccuracy) + ", G=" + String(gyroAccuracy) + ", L=" + String(linAccelAccuracy));
-        }
-        
-        // DETAILED DEBUG LOGGING (periodic)
-        if (_imuDataCount % 5000 == 0) { // Every 5000 samples (~50 seconds at 100Hz)
-            DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", 
-                "IMU detailed - Quat: [" + String(quatI, 3) + ", " + String(quatJ, 3) + ", " + String(quatK, 3) + ", " + String(quatReal, 3) + 
-                "], LinAccel: [" + String(linAccelX, 2) + ", " + String(linAccelY, 2) + ", " + String(linAccelZ, 2) + "]");
-        }
-        
+    ImuSample sample;
+    sample.timestampMicros = micros();
+    if (readImuSample(sample)) {
+        processImuSample(sample);
     } else {
-        // ENHANCED ERROR RECOVERY: Check for IMU timeout
-        if (millis() - _lastImuUpdateTime > 1000) { // 1 second timeout
-            if (_imuDataValid) {
-                DiagnosticManager::logError("SensorManager", "IMU communication timeout - no data for 1 second");
-                _imuDataValid = false;
-            }
-        }
+        checkImuTimeout();
     }
 }
 
-void SensorManager::updateRadar() {
-    // COMPREHENSIVE RADAR UPDATE based on SparkFun XM125 examples
+void SensorManager::drainImuSamples() {
+    // Consume everything the INT handler has queued since the last drain.
+    // Validation and logging happen here, never in interrupt context.
+    PROFILE_SCOPE(PROBE_SENSOR_IMU);
+    
+    ImuSample sample;
+    bool drained = false;
+    
+    while (_imuRing.pop(sample)) {
+        _imuDeadline.observe(sample.timestampMicros);
+        processImuSample(sample);
+        _imuSamplesDrained++;
+        drained = true;
+    }
     
-    uint32_t errorStatus = 0;
-    uint32_t measDistErr = 0;
-    uint32_t calibrateNeeded = 0;
+    if (!drained) {
+        checkImuTimeout();
+    }
+}
+
+bool SensorManager::readImuSample(ImuSample& sample) {
+    // Hardware read only - safe to call from the INT handler (no logging, no String)
+    uint16_t reportId = _bno080.getReadings();
+    if (reportId == 0) {
+        return false;
+    }
     
-    // Check detector error status before starting measurement
-    _radar.getDetectorErrorStatus(errorStatus);
-    if (errorStatus != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar detector error status: " + String(errorStatus));
-        _radarDataValid = false;
+    sample.reportId = reportId;
+    
+    // Accuracy status for each sensor type (SparkFun Example9-Calibrate pattern)
+    sample.quatAccuracy = _bno080.getQuatAccuracy();
+    sample.accelAccuracy = _bno080.getAccelAccuracy();
+    sample.gyroAccuracy = _bno080.getGyroAccuracy();
+    sample.linAccelAccuracy = _bno080.getLinAccelAccuracy();
+    
+    // Rotation vector (quaternion)
+    sample.quatI = _bno080.getQuatI();
+    sample.quatJ = _bno080.getQuatJ();
+    sample.quatK = _bno080.getQuatK();
+    sample.quatReal = _bno080.getQuatReal();
+    
+    // Raw acceleration (includes gravity)
+    sample.accelX = _bno080.getAccelX();
+    sample.accelY = _bno080.getAccelY();
+    sample.accelZ = _bno080.getAccelZ();
+    
+    // Gravity-compensated acceleration (SparkFun Example12 pattern)
+    sample.linAccelX = _bno080.getLinAccelX();
+    sample.linAccelY = _bno080.getLinAccelY();
+    sample.linAccelZ = _bno080.getLinAccelZ();
+    
+    // Angular velocity
+    sample.gyroX = _bno080.getGyroX();
+    sample.gyroY = _bno080.getGyroY();
+    sample.gyroZ = _bno080.getGyroZ();
+    
+    return true;
+}
+
+void SensorManager::enableBatchedReports() {
+    // Report plan for IMU_ACQ_BATCHED: orientation and rate from the gyro-integrated
+    // rotation vector on its own channel, accelerations batched by the hub with
+    // per-report timestamps. The separate gyro, rotation and game rotation vector
+    // reports would only repeat what it carries.
+    Sh2Reports::setFeature(_bno080, SH2_REPORT_GYRO_INTEGRATED_RV, IMU_GYRO_RV_PERIOD_US, 0);
+    Sh2Reports::setFeature(_bno080, SENSOR_REPORTID_ACCELEROMETER, IMU_MOTION_PERIOD_US, IMU_MOTION_BATCH_US);
+    Sh2Reports::setFeature(_bno080, SENSOR_REPORTID_LINEAR_ACCELERATION, IMU_MOTION_PERIOD_US, IMU_MOTION_BATCH_US);
+    
+    _imuBatchSample = ImuSample();
+    _imuDeadline.setPeriod(IMU_GYRO_RV_PERIOD_US);
+    
+    _imuDataCount = 0;
+    _imuStartTime = millis();
+    _lastCalibrationCheck = millis();
+    
+    logSensorStatus("IMU", true);
+    DiagnosticManager::logMessage(LOG_INFO, "SensorManager",
+        "IMU configured for batched reports - gyro-integrated rotation vector @ " + String(1000000UL / IMU_GYRO_RV_PERIOD_US) +
+        "Hz, Accel + Linear Accel @ " + String(1000000UL / IMU_MOTION_PERIOD_US) + "Hz in " +
+        String(IMU_MOTION_BATCH_US / 1000) + "ms hub batches");
+}
+
+bool SensorManager::readImuPacket() {
+    // Hardware read only - safe to call from the INT handler (no logging, no String)
+    if (!_bno080.receivePacket()) {
+        return false;
+    }
+    _imuPacketsRead = _imuPacketsRead + 1;
+    
+    Sh2DecodeResult decoded = Sh2Reports::decodePacket(_bno080.shtpHeader, _bno080.shtpData,
+                                                       _imuEdgeMicros, _imuBatchSample);
+    _imuReportsDecoded = _imuReportsDecoded + decoded.reports;
+    
+    // One ring entry per orientation report, carrying the latest accelerations
+    if (decoded.orientationReports > 0) {
+        _imuRing.push(_imuBatchSample);
+    }
+    return true;
+}
+
+void SensorManager::processImuSample(const ImuSample& sample) {
+    // Black box gets every sample, before any validation
+    const float quat[4] = { sample.quatI, sample.quatJ, sample.quatK, sample.quatReal };
+    const float linAccel[3] = { sample.linAccelX, sample.linAccelY, sample.linAccelZ };
+    const float gyro[3] = { sample.gyroX, sample.gyroY, sample.gyroZ };
+    FlightRecorder::recordImu(sample.timestampMicros, quat, linAccel, gyro,
+                              sample.quatAccuracy, sample.linAccelAccuracy, sample.reportId);
+    
+    // ACCURACY MONITORING - Check sensor accuracy levels (SparkFun Example9-Calibrate pattern)
+    byte quatAccuracy = sample.quatAccuracy;
+    byte accelAccuracy = sample.accelAccuracy;
+    byte gyroAccuracy = sample.gyroAccuracy;
+    byte linAccelAccuracy = sample.linAccelAccuracy;
+    // Note: Game rotation vector accuracy not available in this BNO080 library version
+    
+    // CALIBRATION STATUS MONITORING - Check periodically for calibration needs
+    uint32_t now = millis();
+    if (now - _lastCalibrationCheck > 30000) { // Check every 30 seconds
+        _lastCalibrationCheck = now;
+        
+        // Log accuracy status for diagnostics
+        if (quatAccuracy < 2 || accelAccuracy < 2 || gyroAccuracy < 2) {
+            DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", 
+                "IMU calibration status - Quat: " + String(quatAccuracy) + 
+                ", Accel: " + String(accelAccuracy) + 
+                ", Gyro: " + String(gyroAccuracy) + 
+                ", LinAccel: " + String(linAccelAccuracy) + " (2+ recommended for reliable operation)");
+        }
+    }
+    
+    // PRIMARY SENSOR DATA - Rotation vector (quaternion)
+    float quatI = sample.quatI;
+    float quatJ = sample.quatJ;
+    float quatK = sample.quatK;
+    float quatReal = sample.quatReal;
+    
+    // ENHANCED VALIDATION: Check quaternion accuracy before using
+    if (quatAccuracy == 0) {
+        BLOG(LOG_WARNING, "SensorManager", "IMU quaternion accuracy unreliable - continuing with available data");
+        // Note: Game rotation vector methods not available in this BNO080 library version
+        // Continue with standard quaternion data but mark as lower confidence
+    }
+    
+    // Validate quaternion magnitude
+    float quatMagnitude = sqrt(quatI*quatI + quatJ*quatJ + quatK*quatK + quatReal*quatReal);
+    if (quatMagnitude < 0.9f || quatMagnitude > 1.1f) {
+        BLOG(LOG_ERROR, "SensorManager", "Invalid IMU quaternion magnitude: %.4f", quatMagnitude);
+        _imuDataValid = false;
         return;
     }
     
-    // Start detector for measurement
-    if (_radar.setCommand(SFE_XM125_DISTANCE_START_DETECTOR) != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar start detector command failed");
-        _radarDataValid = false;
+    // RAW ACCELEROMETER - Raw acceleration (includes gravity)
+    float accelX = sample.accelX;
+    float accelY = sample.accelY;
+    float accelZ = sample.accelZ;
+    
+    // Validate accelerometer data (reasonable range: -50g to +50g)
+    if (abs(accelX) > 50.0f || abs(accelY) > 50.0f || abs(accelZ) > 50.0f) {
+        DiagnosticManager::logError("SensorManager", "Invalid IMU acceleration values: X=" + String(accelX, 2) + ", Y=" + String(accelY, 2) + ", Z=" + String(accelZ, 2));
+        _imuDataValid = false;
         return;
     }
     
-    // Wait for measurement to complete
-    if (_radar.busyWait() != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar measurement busy wait failed");
-        _radarDataValid = false;
+    // LINEAR ACCELEROMETER - Gravity-compensated acceleration (SparkFun Example12 pattern)
+    float linAccelX = sample.linAccelX;
+    float linAccelY = sample.linAccelY;
+    float linAccelZ = sample.linAccelZ;
+    
+    // Validate linear acceleration (should be smaller than raw accel)
+    if (abs(linAccelX) > 20.0f || abs(linAccelY) > 20.0f || abs(linAccelZ) > 20.0f) {
+        DiagnosticManager::logError("SensorManager", "Invalid IMU linear acceleration values: X=" + String(linAccelX, 2) + ", Y=" + String(linAccelY, 2) + ", Z=" + String(linAccelZ, 2));
+        _imuDataValid = false;
         return;
     }
     
-    // Check for errors after measurement
-    _radar.getDetectorErrorStatus(errorStatus);
-    if (errorStatus != 0) {
-        DiagnosticManager::logError("SensorManager", "Radar detector error after measurement: " + String(errorStatus));
-        _radarDataValid = false;
+    // GYROSCOPE - Angular velocity
+    float gyroX = sample.gyroX;
+    float gyroY = sample.gyroY;
+    float gyroZ = sample.gyroZ;
+    
+    // Validate gyroscope data (reasonable range: -2000 deg/s)
+    if (abs(gyroX) > 2000.0f || abs(gyroY) > 2000.0f || abs(gyroZ) > 2000.0f) {
+        DiagnosticManager::logError("SensorManager", "Invalid IMU gyroscope values: X=" + String(gyroX, 2) + ", Y=" + String(gyroY, 2) + ", Z=" + String(gyroZ, 2));
+        _imuDataValid = false;
         return;
     }
     
-    // Check for measurement distance error
-    _radar.getMeasureDistanceError(measDistErr);
-    if (measDistErr == 1) {
-        DiagnosticManager::logError("SensorManager", "Radar measurement distance error detected");
-        _radarDataValid = false;
+    // ACCURACY-BASED DATA VALIDATION
+    // Only use data if minimum accuracy is achieved
+    if (quatAccuracy == 0) {
+        DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", "IMU quaternion accuracy = 0 (unreliable) - using with caution");
+        // Continue but mark as lower confidence rather than rejecting completely
+    }
+    
+    if (accelAccuracy == 0) {
+        DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", "IMU accelerometer accuracy unreliable");
+        // Continue but mark as lower confidence
+    }
+    
+    // DATA IS VALID - Update stored values
+    _imuQuatI = quatI;
+    _imuQuatJ = quatJ;
+    _imuQuatK = quatK;
+    _imuQuatReal = quatReal;
+    _imuAccelX = accelX;
+    _imuAccelY = accelY;
+    _imuAccelZ = accelZ;
+    _imuGyroX = gyroX;
+    _imuGyroY = gyroY;
+    _imuGyroZ = gyroZ;
+    
+    // Store linear acceleration for motion analysis
+    _imuLinAccelX = linAccelX;
+    _imuLinAccelY = linAccelY;
+    _imuLinAccelZ = linAccelZ;
+    
+    // Store accuracy levels for external use
+    _imuQuatAccuracy = quatAccuracy;
+    _imuAccelAccuracy = accelAccuracy;
+    _imuGyroAccuracy = gyroAccuracy;
+    
+    _imuDataValid = true;
+    _lastImuUpdateTime = now;
+    _lastImuSampleMicros = sample.timestampMicros;
+    
+    // Publish the validated sample as one unit
+    ImuSnapshot snapshot;
+    snapshot.quatI = quatI;
+    snapshot.quatJ = quatJ;
+    snapshot.quatK = quatK;
+    snapshot.quatReal = quatReal;
+    snapshot.accelX = accelX;
+    snapshot.accelY = accelY;
+    snapshot.accelZ = accelZ;
+    snapshot.linAccelX = linAccelX;
+    snapshot.linAccelY = linAccelY;
+    snapshot.linAccelZ = linAccelZ;
+    snapshot.gyroX = gyroX;
+    snapshot.gyroY = gyroY;
+    snapshot.gyroZ = gyroZ;
+    snapshot.quatAccuracy = quatAccuracy;
+    snapshot.accelAccuracy = accelAccuracy;
+    snapshot.gyroAccuracy = gyroAccuracy;
+    snapshot.sampleMicros = sample.timestampMicros;
+    _imuSnapshot.write(snapshot);
+    TelemetryBatcher::recordImu(snapshot);
+    
+    // DEAD RECKONING - propagate the fused state to this sample
+    if (_enableDeadReckoning) {
+        _drFilter.predict(sample.timestampMicros, linAccelX, linAccelY, linAccelZ,
+                          quatI, quatJ, quatK, quatReal);
+        publishFusionSnapshot(sample.timestampMicros);
+    }
+    
+    // PERFORMANCE MONITORING - Track data rate (SparkFun SPI example pattern)
+    _imuDataCount++;
+    if (_imuDataCount % 1000 == 0) { // Every 1000 samples
+        float dataRate = (float)_imuDataCount / ((now - _imuStartTime) / 1000.0f);
+        BLOG(LOG_DEBUG, "SensorManager", 
+            "IMU performance: %.1fHz data rate, Accuracy: Q=%d, A=%d, G=%d, L=%d, Dropped: %lu",
+            dataRate, quatAccuracy, accelAccuracy, gyroAccuracy, linAccelAccuracy,
+            (unsigned long)_imuRing.getDroppedCount());
+    }
+    
+    // DETAILED DEBUG LOGGING (periodic)
+    if (_imuDataCount % 5000 == 0) { // Every 5000 samples (~50 seconds at 100Hz)
+        BLOG(LOG_DEBUG, "SensorManager", 
+            "IMU detailed - Quat: [%.3f, %.3f, %.3f, %.3f], LinAccel: [%.2f, %.2f, %.2f]",
+            quatI, quatJ, quatK, quatReal, linAccelX, linAccelY, linAccelZ);
+    }
+}
+
+void SensorManager::checkImuTimeout() {
+    // ENHANCED ERROR RECOVERY: Check for IMU timeout
+    if (millis() - _lastImuUpdateTime > 1000) { // 1 second timeout
+        if (_imuDataValid) {
+            DiagnosticManager::logError("SensorManager", "IMU communication timeout - no data for 1 second");
+            _imuDataValid = false;
+        }
+    }
+}
+
+void SensorManager::startImuInterrupt() {
+    // INT handler may share its bus with the radar, ADC and OLED - register the
+    // deferred read so a report that lands mid-transaction is serviced on release
+    I2CBusGuard::setDeferredService(IMU_I2C_BUS, I2C_PRIORITY_IMU, &imuBusService);
+    
+    pinMode(IMU_INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(IMU_INT_PIN), &imuInterruptHandler, FALLING);
+    
+    DiagnosticManager::logMessage(LOG_INFO, "SensorManager", 
+        "IMU interrupt acquisition enabled on pin " + String(IMU_INT_PIN) + 
+        " (ring: " + String(IMU_SAMPLE_RING_SIZE) + " samples)");
+    
+    // A report may already be pending from initialization - INT is level
+    // low until read, so no further edge would arrive on its own
+    if (digitalRead(IMU_INT_PIN) == LOW) {
+        noInterrupts();
+        imuInterruptHandler();
+        interrupts();
+    }
+}
+
+void SensorManager::imuInterruptHandler() {
+    if (_instance == nullptr) return;
+    
+    // Latch the edge time first - this is the sample timestamp
+    _instance->_imuEdgeMicros = micros();
+    
+    if (!I2CBusGuard::tryAcquireFromISR(IMU_I2C_BUS)) {
+        // Foreground owns the bus - read as soon as it lets go
+        I2CBusGuard::requestDeferredService(IMU_I2C_BUS, I2C_PRIORITY_IMU);
         return;
     }
     
-    // Check if recalibration is needed
-    _radar.getCalibrationNeeded(calibrateNeeded);
-    if (calibrateNeeded == 1) {
-        DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", "Radar calibration needed - recalibrating");
-        
-        // Perform recalibration
-        if (_radar.setCommand(SFE_XM125_DISTANCE_RECALIBRATE) != 0) {
-            DiagnosticManager::logError("SensorManager", "Radar recalibration command failed");
-            _radarDataValid = false;
-            return;
+    imuBusService();
+    I2CBusGuard::releaseFromISR(IMU_I2C_BUS);
+}
+
+void SensorManager::imuBusService() {
+    // Runs with the bus held, either in the ISR or from I2CBusGuard::release()/yieldTo()
+    if (_instance == nullptr) return;
+    
+    if (_instance->_imuAcquisitionMode == IMU_ACQ_BATCHED) {
+        // One I2C read per SHTP packet, however many reports it holds
+        for (int i = 0; i < IMU_MAX_REPORTS_PER_EDGE; i++) {
+            if (!_instance->readImuPacket() || digitalRead(IMU_INT_PIN) == HIGH) {
+                break;
+            }
+            _instance->_imuEdgeMicros = micros();
+        }
+        return;
+    }
+    
+    // INT stays asserted while further reports are queued - read them all
+    for (int i = 0; i < IMU_MAX_REPORTS_PER_EDGE; i++) {
+        ImuSample sample;
+        sample.timestampMicros = _instance->_imuEdgeMicros;
+        if (!_instance->readImuSample(sample)) {
+            break;
         }
         
-        // Wait for recalibration to complete
-        if (_radar.busyWait() != 0) {
-            DiagnosticManager::logError("SensorManager", "Radar recalibration busy wait failed");
-            _radarDataValid = false;
-            return;
+        // One ring entry per rotation vector report; the other reports only
+        // refresh the values carried alongside it
+        if (sample.reportId == SENSOR_REPORTID_ROTATION_VECTOR) {
+            _instance->_imuRing.push(sample);
         }
         
-        DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "Radar recalibration completed successfully");
+        if (digitalRead(IMU_INT_PIN) == HIGH) {
+            break;
+        }
+        _instance->_imuEdgeMicros = micros();
     }
+}
+
+void SensorManager::updateRadar() {
+    // NON-BLOCKING RADAR STATE MACHINE based on the SparkFun XM125 example sequence
+    // Each call performs at most one short register exchange and returns -
+    // the measurement wait is a status poll, never a busyWait()
+    PROFILE_SCOPE(PROBE_SENSOR_RADAR);
     
-    // MULTI-PEAK DETECTION for ground and crop canopy
-    // Read multiple peaks to detect both ground level and crop height
+    uint32_t now = millis();
+    uint32_t errorStatus = 0;
     
-    uint32_t peak0Distance = 0, peak1Distance = 0;
-    int32_t peak0Strength = 0, peak1Strength = 0;
+    switch (_radarState) {
+        case RADAR_STATE_OFFLINE:
+            // Bring-up, paced by the retry interval after a failure
+            if (_radarFailures > 0 && now - _lastRadarAttempt < SENSOR_RETRY_INTERVAL_MS) return;
+            _lastRadarAttempt = now;
+            if (_radarFailures == 0) logSensorStatus("Radar", false); // Starting initialization (retries log via logSensorRetry)
+            
+            I2CBusGuard::beginBus(RADAR_I2C_BUS);
+            if (!_radar.begin(SFE_XM125_I2C_ADDRESS, I2CBusGuard::wire(RADAR_I2C_BUS))) {
+                radarInitializationFailed("Radar I2C initialization failed");
+                return;
+            }
+            
+            // Reset sensor configuration to ensure clean state
+            if (_radar.setCommand(SFE_XM125_DISTANCE_RESET_MODULE) != 0) {
+                radarInitializationFailed("Radar reset command failed");
+                return;
+            }
+            setRadarState(RADAR_STATE_INIT_RESET_WAIT);
+            break;
+            
+        case RADAR_STATE_INIT_RESET_WAIT:
+            // Poll for reset complete
+            if (!pollRadarBusy("reset", RADAR_STATE_OFFLINE)) {
+                if (_radarState == RADAR_STATE_OFFLINE) radarInitializationFailed("Radar reset did not complete");
+                return;
+            }
+            
+            // Check for errors after reset
+            _radar.getDetectorErrorStatus(errorStatus);
+            if (errorStatus != 0) {
+                radarInitializationFailed("Radar detector error after reset: " + String(errorStatus));
+                return;
+            }
+            setRadarState(RADAR_STATE_INIT_CONFIGURE);
+            break;
+            
+        case RADAR_STATE_INIT_CONFIGURE:
+            // Allow sensor to stabilize
+            if (now - _radarStateTime < RADAR_INIT_SETTLE_MS) return;
+            
+            // Detection range for boom height sensing: 100mm (10cm minimum boom
+            // height) to 3000mm (3m maximum boom height). Tracking narrows it later.
+            if (_radar.setStart(RADAR_RANGE_MIN_MM) != 0 || _radar.setEnd(RADAR_RANGE_MAX_MM) != 0) {
+                radarInitializationFailed("Radar range configuration failed");
+                return;
+            }
+            
+            // Threshold settings for agricultural environment - moderate sensitivity (200)
+            // to ignore spray droplets/dust, fixed amplitude threshold (150) to filter
+            // out weak reflections
+            if (_radar.setThresholdSensitivity(200) != 0 || _radar.setFixedAmpThreshold(150) != 0) {
+                radarInitializationFailed("Radar threshold configuration failed");
+                return;
+            }
+            setRadarState(RADAR_STATE_INIT_APPLY);
+            break;
+            
+        case RADAR_STATE_INIT_APPLY:
+            // Allow configuration to settle
+            if (now - _radarStateTime < RADAR_INIT_SETTLE_MS) return;
+            
+            if (_radar.setCommand(SFE_XM125_DISTANCE_APPLY_CONFIGURATION) != 0) {
+                _radar.getDetectorErrorStatus(errorStatus);
+                radarInitializationFailed("Radar configuration application failed (detector error " + String(errorStatus) + ")");
+                return;
+            }
+            setRadarState(RADAR_STATE_INIT_APPLY_WAIT);
+            break;
+            
+        case RADAR_STATE_INIT_APPLY_WAIT: {
+            // Poll for configuration complete
+            if (!pollRadarBusy("configuration", RADAR_STATE_OFFLINE)) {
+                if (_radarState == RADAR_STATE_OFFLINE) radarInitializationFailed("Radar configuration did not complete");
+                return;
+            }
+            
+            // Final error status check
+            _radar.getDetectorErrorStatus(errorStatus);
+            if (errorStatus != 0) {
+                radarInitializationFailed("Radar detector error after configuration: " + String(errorStatus));
+                return;
+            }
+            
+            // Verify configuration by reading back settings
+            uint32_t startVal = 0, endVal = 0;
+            _radar.getStart(startVal);
+            _radar.getEnd(endVal);
+            
+            DiagnosticManager::logMessage(LOG_INFO, "SensorManager", 
+                "Radar configured successfully - Range: " + String(startVal) + "mm to " + String(endVal) + "mm");
+            logSensorStatus("Radar", true);
+            
+            _radarWindowStart = startVal;
+            _radarWindowEnd = endVal;
+            _radarTracker.reset();
+            _radarInitialized = true;
+            _radarCycleStart = now - RADAR_UPDATE_INTERVAL_MS;   // First measurement straight away
+            setRadarState(RADAR_STATE_IDLE);
+            checkAllSensorsInitialized();
+            break;
+        }
+            
+        case RADAR_STATE_IDLE: {
+            // Measurement cadence - 50Hz over the full range, 100Hz once the
+            // tracker has the ground in a narrowed window (shorter sweeps)
+            uint32_t interval = RADAR_UPDATE_INTERVAL_MS;
+            if (_radarMode == RADAR_MODE_TRACKING && _radarTracker.isGroundLocked() &&
+                (_radarWindowStart != RADAR_RANGE_MIN_MM || _radarWindowEnd != RADAR_RANGE_MAX_MM)) {
+                interval = RADAR_TRACK_INTERVAL_MS;
+            }
+            if (now - _radarCycleStart < interval) return;
+            _radarCycleStart = now;
+            
+            // Check detector error status before starting measurement
+            _radar.getDetectorErrorStatus(errorStatus);
+            if (errorStatus != 0) {
+                DiagnosticManager::logError("SensorManager", "Radar detector error status: " + String(errorStatus));
+                _radarDataValid = false;
+                return;
+            }
+            setRadarState(RADAR_STATE_START);
+            break;
+        }
+            
+        case RADAR_STATE_START:
+            // Start detector for measurement
+            if (_radar.setCommand(SFE_XM125_DISTANCE_START_DETECTOR) != 0) {
+                DiagnosticManager::logError("SensorManager", "Radar start detector command failed");
+                _radarDataValid = false;
+                setRadarState(RADAR_STATE_IDLE);
+                return;
+            }
+            setRadarState(RADAR_STATE_WAIT_MEASURE);
+            break;
+            
+        case RADAR_STATE_WAIT_MEASURE:
+            // Poll for measurement complete
+            if (!pollRadarBusy("measurement")) return;
+            _radarMeasureMicros = micros(); // Sample time for this measurement
+            setRadarState(RADAR_STATE_CHECK_RESULT);
+            break;
+            
+        case RADAR_STATE_CHECK_RESULT: {
+            uint32_t measDistErr = 0;
+            uint32_t calibrateNeeded = 0;
+            
+            // Check for errors after measurement
+            _radar.getDetectorErrorStatus(errorStatus);
+            if (errorStatus != 0) {
+                DiagnosticManager::logError("SensorManager", "Radar detector error after measurement: " + String(errorStatus));
+                _radarDataValid = false;
+                setRadarState(RADAR_STATE_IDLE);
+                return;
+            }
+            
+            // Check for measurement distance error
+            _radar.getMeasureDistanceError(measDistErr);
+            if (measDistErr == 1) {
+                DiagnosticManager::logError("SensorManager", "Radar measurement distance error detected");
+                _radarDataValid = false;
+                setRadarState(RADAR_STATE_IDLE);
+                return;
+            }
+            
+            // Check if recalibration is needed - the peaks from this
+            // measurement are still read first, as before
+            _radar.getCalibrationNeeded(calibrateNeeded);
+            _radarCalibrationPending = (calibrateNeeded == 1);
+            setRadarState(RADAR_STATE_READ_PEAKS);
+            break;
+        }
+            
+        case RADAR_STATE_READ_PEAKS: {
+            // MULTI-PEAK DETECTION for ground and crop canopy
+            // Read multiple peaks to detect both ground level and crop height
+            uint32_t peak0Distance = 0, peak1Distance = 0;
+            int32_t peak0Strength = 0, peak1Strength = 0;
+            
+            // Get primary peak (usually ground)
+            _radar.getPeak0Distance(peak0Distance);
+            _radar.getPeak0Strength(peak0Strength);
+            
+            // Get secondary peak (usually crop canopy)
+            _radar.getPeak1Distance(peak1Distance);
+            _radar.getPeak1Strength(peak1Strength);
+            
+            processRadarPeaks(peak0Distance, peak0Strength, peak1Distance, peak1Strength);
+            
+            if (_radarCalibrationPending) {
+                setRadarState(RADAR_STATE_RECALIBRATE);
+            } else if (_radarMode == RADAR_MODE_TRACKING &&
+                       _radarTracker.windowChangeNeeded(now, _radarWindowStart, _radarWindowEnd,
+                                                        &_radarPendingStart, &_radarPendingEnd)) {
+                setRadarState(RADAR_STATE_RECONFIGURE);
+            } else {
+                setRadarState(RADAR_STATE_IDLE);
+            }
+            break;
+        }
+            
+        case RADAR_STATE_RECALIBRATE:
+            DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", "Radar calibration needed - recalibrating");
+            _radarCalibrationPending = false;
+            
+            // Perform recalibration
+            if (_radar.setCommand(SFE_XM125_DISTANCE_RECALIBRATE) != 0) {
+                DiagnosticManager::logError("SensorManager", "Radar recalibration command failed");
+                _radarDataValid = false;
+                setRadarState(RADAR_STATE_IDLE);
+                return;
+            }
+            setRadarState(RADAR_STATE_WAIT_RECALIBRATE);
+            break;
+            
+        case RADAR_STATE_WAIT_RECALIBRATE:
+            // Poll for recalibration complete
+            if (!pollRadarBusy("recalibration")) return;
+            DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "Radar recalibration completed successfully");
+            setRadarState(RADAR_STATE_IDLE);
+            break;
+            
+        case RADAR_STATE_RECONFIGURE:
+            // Move the measurement window between measurements - the detector
+            // is idle here, so the new range applies from the next START
+            if (_radar.setStart(_radarPendingStart) != 0 || _radar.setEnd(_radarPendingEnd) != 0 ||
+                _radar.setCommand(SFE_XM125_DISTANCE_APPLY_CONFIGURATION) != 0) {
+                DiagnosticManager::logError("SensorManager", "Radar window reconfiguration failed");
+                _radarWindowStart = 0;      // Unknown now - the tracker asks again
+                _radarWindowEnd = 0;
+                setRadarState(RADAR_STATE_IDLE);
+                return;
+            }
+            setRadarState(RADAR_STATE_WAIT_RECONFIGURE);
+            break;
+            
+        case RADAR_STATE_WAIT_RECONFIGURE:
+            // Poll for configuration complete
+            if (!pollRadarBusy("reconfiguration")) return;
+            _radar.getDetectorErrorStatus(errorStatus);
+            if (errorStatus != 0) {
+                DiagnosticManager::logError("SensorManager", "Radar detector error after reconfiguration: " + String(errorStatus));
+                _radarDataValid = false;
+                _radarWindowStart = 0;
+                _radarWindowEnd = 0;
+                setRadarState(RADAR_STATE_IDLE);
+                return;
+            }
+            _radarWindowStart = _radarPendingStart;
+            _radarWindowEnd = _radarPendingEnd;
+            _radarWindowChanges++;
+            BLOG(LOG_DEBUG, "SensorManager", "Radar window %lu-%lumm",
+                 (unsigned long)_radarWindowStart, (unsigned long)_radarWindowEnd);
+            setRadarState(RADAR_STATE_IDLE);
+            break;
+            
+        default:
+            // Should never reach here, but recover gracefully
+            setRadarState(_radarInitialized ? RADAR_STATE_IDLE : RADAR_STATE_OFFLINE);
+            break;
+    }
+}
+
+void SensorManager::radarInitializationFailed(const String& reason) {
+    _radarFailures++;
+    if (_radarFailures == 1) {
+        DiagnosticManager::logError("SensorManager", reason);
+    } else {
+        DIAG_LOG(LOG_DEBUG, "SensorManager", reason);
+        logSensorRetry("Radar", _radarFailures);
+    }
+    setRadarState(RADAR_STATE_OFFLINE);
+}
+
+bool SensorManager::pollRadarBusy(const char* operation, RadarState_t failState) {
+    // Single status register read - returns true once the detector is idle
+    uint32_t detectorStatus = 0;
+    if (_radar.getDetectorStatus(detectorStatus) != 0) {
+        DiagnosticManager::logError("SensorManager", "Radar " + String(operation) + " status read failed");
+        _radarDataValid = false;
+        setRadarState(failState);
+        return false;
+    }
     
-    // Get primary peak (usually ground)
-    _radar.getPeak0Distance(peak0Distance);
-    _radar.getPeak0Strength(peak0Strength);
+    if ((detectorStatus & RADAR_DETECTOR_BUSY_MASK) == 0) {
+        return true;
+    }
     
-    // Get secondary peak (usually crop canopy)
-    _radar.getPeak1Distance(peak1Distance);
-    _radar.getPeak1Strength(peak1Strength);
+    // Still busy - give up if the detector never finishes
+    if (millis() - _radarStateTime > RADAR_BUSY_TIMEOUT_MS) {
+        DiagnosticManager::logError("SensorManager", 
+            "Radar " + String(operation) + " timeout after " + String(RADAR_BUSY_TIMEOUT_MS) + "ms");
+        _radarBusyTimeouts++;
+        _radarDataValid = false;
+        setRadarState(failState);
+    }
+    return false;
+}
+
+void SensorManager::publishRadarSnapshot() {
+    // Only touch the seqlock when the result actually changed
+    if (_radarDistance == _publishedRadar.distance && _radarDataValid == _publishedRadar.valid &&
+        _radarSampleMicros == _publishedRadar.sampleMicros) {
+        return;
+    }
     
+    _publishedRadar.distance = _radarDistance;
+    _publishedRadar.valid = _radarDataValid;
+    _publishedRadar.sampleMicros = _radarSampleMicros;
+    _publishedRadar.updateMillis = millis();
+    _radarSnapshot.write(_publishedRadar);
+    TelemetryBatcher::recordRadar(_publishedRadar);
+}
+
+void SensorManager::setRadarState(RadarState_t state) {
+    _radarState = state;
+    _radarStateTime = millis();
+}
+
+void SensorManager::processRadarPeaks(uint32_t peak0Distance, int32_t peak0Strength,
+                                      uint32_t peak1Distance, int32_t peak1Strength) {
     // SIGNAL STRENGTH ANALYSIS for reliability
     const int32_t MIN_SIGNAL_STRENGTH = 100; // Minimum strength for reliable detection
     
     bool peak0Valid = (peak0Distance > 0) && (peak0Strength > MIN_SIGNAL_STRENGTH);
     bool peak1Valid = (peak1Distance > 0) && (peak1Strength > MIN_SIGNAL_STRENGTH);
     
-    if (peak0Valid) {
+    if (_radarMode == RADAR_MODE_TRACKING) {
+        // Ground from the tracker - whichever peak is strongest, and the
+        // canopy plus its depth while the ground return is hidden
+        RadarPeak peaks[2] = {{peak0Distance, peak0Strength}, {peak1Distance, peak1Strength}};
+        if (_radarTracker.update(_radarMeasureMicros, peaks, 2)) {
+            _radarDistance = _radarTracker.getGroundDistance();
+            _radarDataValid = true;
+            _radarSampleMicros = _radarMeasureMicros;
+            _lastRadarUpdate = millis();
+            
+            BLOG(LOG_DEBUG, "SensorManager", "Radar ground: %.3fm, canopy depth %.3fm",
+                 _radarDistance, _radarTracker.getCanopyDepth());
+        } else {
+            _radarDataValid = false;
+        }
+        
+    } else if (peak0Valid) {
         // Primary peak detected - convert to meters and validate range
         float distanceMeters = peak0Distance / 1000.0f;
         
@@ -638,24 +1128,25 @@ void SensorManager::updateRadar() {
         if (distanceMeters >= 0.1f && distanceMeters <= 3.0f) {
             _radarDistance = distanceMeters;
             _radarDataValid = true;
+            _radarSampleMicros = _radarMeasureMicros;
             _lastRadarUpdate = millis();
             
             // Log detailed measurement for debugging
-            DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", 
-                "Radar Peak0: " + String(distanceMeters, 3) + "m, Strength: " + String(peak0Strength));
+            BLOG(LOG_DEBUG, "SensorManager", 
+                "Radar Peak0: %.3fm, Strength: %ld", distanceMeters, (long)peak0Strength);
             
             // If secondary peak is also valid, log it for crop detection analysis
             if (peak1Valid) {
                 float peak1Meters = peak1Distance / 1000.0f;
                 if (peak1Meters >= 0.1f && peak1Meters <= 3.0f && peak1Meters != distanceMeters) {
-                    DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", 
-                        "Radar Peak1: " + String(peak1Meters, 3) + "m, Strength: " + String(peak1Strength) + " (crop canopy?)");
+                    BLOG(LOG_DEBUG, "SensorManager", 
+                        "Radar Peak1: %.3fm, Strength: %ld (crop canopy?)", peak1Meters, (long)peak1Strength);
                 }
             }
             
         } else {
-            DiagnosticManager::logError("SensorManager", 
-                "Radar distance out of range: " + String(distanceMeters, 3) + "m (expected 0.1-3.0m)");
+            BLOG(LOG_ERROR, "SensorManager", 
+                "Radar distance out of range: %.3fm (expected 0.1-3.0m)", distanceMeters);
             _radarDataValid = false;
         }
         
@@ -666,13 +1157,14 @@ void SensorManager::updateRadar() {
         if (distanceMeters >= 0.1f && distanceMeters <= 3.0f) {
             _radarDistance = distanceMeters;
             _radarDataValid = true;
+            _radarSampleMicros = _radarMeasureMicros;
             _lastRadarUpdate = millis();
             
-            DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", 
-                "Radar Peak1 (backup): " + String(distanceMeters, 3) + "m, Strength: " + String(peak1Strength));
+            BLOG(LOG_DEBUG, "SensorManager", 
+                "Radar Peak1 (backup): %.3fm, Strength: %ld", distanceMeters, (long)peak1Strength);
         } else {
-            DiagnosticManager::logError("SensorManager", 
-                "Radar backup distance out of range: " + String(distanceMeters, 3) + "m");
+            BLOG(LOG_ERROR, "SensorManager", 
+                "Radar backup distance out of range: %.3fm", distanceMeters);
             _radarDataValid = false;
         }
         
@@ -680,45 +1172,63 @@ void SensorManager::updateRadar() {
         // No valid peaks detected
         if (peak0Distance > 0 || peak1Distance > 0) {
             // Peaks detected but signal strength too weak
-            DiagnosticManager::logMessage(LOG_WARNING, "SensorManager", 
-                "Radar weak signals - Peak0: " + String(peak0Strength) + ", Peak1: " + String(peak1Strength) + " (min: " + String(MIN_SIGNAL_STRENGTH) + ")");
+            BLOG(LOG_WARNING, "SensorManager", 
+                "Radar weak signals - Peak0: %ld, Peak1: %ld (min: %d)",
+                (long)peak0Strength, (long)peak1Strength, (int)MIN_SIGNAL_STRENGTH);
         } else {
             // No targets detected - could be normal (high boom) or error
-            DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", "Radar no targets detected");
+            BLOG(LOG_DEBUG, "SensorManager", "Radar no targets detected");
         }
         _radarDataValid = false;
     }
     
+    FlightRecorder::recordRadar(_radarMeasureMicros, _radarDataValid ? _radarDistance : 0.0f, _radarDataValid,
+                                peak0Distance, peak0Strength, peak1Distance, peak1Strength);
+    
     // TIMEOUT DETECTION for communication failures
     if (!_radarDataValid && (millis() - _lastRadarUpdate > 5000)) {
-        DiagnosticManager::logError("SensorManager", "Radar communication timeout - no valid readings for 5 seconds");
+        BLOG(LOG_ERROR, "SensorManager", "Radar communication timeout - no valid readings for 5 seconds");
     }
 }
 
 void SensorManager::updateDeadReckoning() {
-    // Dead reckoning implementation for wing modules
-    if (!_enableDeadReckoning || !_gpsValidFix) return;
-    
-    uint32_t now = millis();
-    float dt = (now - _lastFusionUpdate) / 1000.0f; // Convert to seconds
-    
-    if (dt <= 0) return;
+    // Dead reckoning implementation for wing modules - the filter is
+    // propagated per IMU sample in processImuSample(), GNSS corrects it here
+    if (!_enableDeadReckoning || !_freshFusionFix) return;
+    _freshFusionFix = false;
+    
+    if (!_gpsValidFix) return;
+    
+    // LATENCY COMPENSATION - local time of the navigation epoch, from the
+    // disciplined clock when available, otherwise a fixed receiver latency
+    uint32_t epochMicros;
+    if (!GpsTimeService::toLocalMicros((uint64_t)_gpsTimeOfWeek * 1000ULL, &epochMicros)) {
+        epochMicros = _gpsArrivalMicros - DR_GNSS_DEFAULT_LATENCY_US;
+    }
     
-    // Simple dead reckoning: predict position using last known velocity
-    // This is a basic implementation - more sophisticated fusion could be added
+    bool wasInitialized = _drFilter.isInitialized();
+    _drFilter.correct(epochMicros, _gpsLatitude, _gpsLongitude, _gpsAltitude / 1000.0,
+                      _gpsHorizontalAccuracy / 10000.0f, _gpsVerticalAccuracy / 10000.0f);
     
-    if (_lastGpsUpdateTime > 0) {
-        // Use GPS position as ground truth when available
-        _fusedLatitude = _gpsLatitude;
-        _fusedLongitude = _gpsLongitude;
-        _fusedAltitude = _gpsAltitude / 1000.0f; // Convert mm to meters
-    } else {
-        // Predict position using IMU data (basic integration)
-        // This would need proper coordinate transformation and drift correction
-        // For now, just maintain last known position
+    if (_drFilter.isInitialized() && !wasInitialized) {
+        DiagnosticManager::logMessage(LOG_INFO, "SensorManager", "Dead reckoning initialized from GNSS");
+        publishFusionSnapshot(_drFilter.getLastPredictMicros());
     }
 }
 
+void SensorManager::publishFusionSnapshot(uint32_t sampleMicros) {
+    FusionSnapshot fusion;
+    _drFilter.getPosition(&fusion.latitude, &fusion.longitude, &fusion.altitude);
+    _drFilter.getVelocity(&fusion.velocityNorth, &fusion.velocityEast, &fusion.velocityDown);
+    
+    // Coasting on IMU alone is only trusted for a short GNSS outage
+    fusion.valid = _drFilter.isInitialized() && _gpsValidFix &&
+                   (millis() - _lastGpsUpdateTime < DR_MAX_COAST_MS);
+    fusion.sampleMicros = sampleMicros;
+    _fusionSnapshot.write(fusion);
+    TelemetryBatcher::recordFusion(fusion);
+}
+
 void SensorManager::updateRTKStatus() {
     // Update horizontal accuracy in meters
     _horizontalAccuracy = _gpsHorizontalAccuracy / 10000.0f; // Convert from mm*0.1 to meters
@@ -740,17 +1250,63 @@ RTKStatus_t SensorManager::determineRTKStatus(uint32_t horizontalAccuracy) {
 void SensorManager::gpsHPPOSLLHCallback(UBX_NAV_HPPOSLLH_data_t *ubxDataStruct) {
     if (_instance == nullptr) return;
     
+    // Build the whole epoch first, then publish it in one step
+    GpsSnapshot epoch;
+    epoch.latitude = ubxDataStruct->lat * 1e-7 + ubxDataStruct->latHp * 1e-9;
+    epoch.longitude = ubxDataStruct->lon * 1e-7 + ubxDataStruct->lonHp * 1e-9;
+    epoch.altitudeMm = ubxDataStruct->hMSL + ubxDataStruct->hMSLHp;
+    epoch.horizontalAccuracy = ubxDataStruct->hAcc / 10000.0f; // mm*0.1 to meters
+    epoch.verticalAccuracy = ubxDataStruct->vAcc / 10000.0f;
+    epoch.timeOfWeek = ubxDataStruct->iTOW;
+    epoch.rtkStatus = (uint8_t)_instance->determineRTKStatus(ubxDataStruct->hAcc);
+    // Fix validity is gnssFixOK from this epoch's NAV-PVT; bit 0 of the
+    // HPPOSLLH flags is invalidLlh, set when this position is unusable
+    epoch.validFix = _instance->_gpsFixOk && !ubxDataStruct->flags.bits.invalidLlh;
+    epoch.groundSpeed = _instance->_gpsGroundSpeed;
+    epoch.heading = _instance->_gpsHeading;
+    epoch.satellites = _instance->_gpsSatellites;
+    epoch.updateMillis = millis();
+    _instance->_gpsSnapshot.write(epoch);
+    TelemetryBatcher::recordGnss(epoch, micros());
+    
+    FlightRecorder::recordGnss(micros(), ubxDataStruct->lat, ubxDataStruct->latHp, ubxDataStruct->lon, ubxDataStruct->lonHp,
+                               ubxDataStruct->hMSL, ubxDataStruct->hAcc, epoch.timeOfWeek, epoch.validFix, epoch.rtkStatus);
+    
+    // iTOW labels the next TIMEPULSE edge
+    GpsTimeService::onNavigationEpoch(epoch.timeOfWeek);
+    
     // Store high-precision GPS data
-    _instance->_gpsLatitude = ubxDataStruct->lat * 1e-7 + ubxDataStruct->latHp * 1e-9;
-    _instance->_gpsLongitude = ubxDataStruct->lon * 1e-7 + ubxDataStruct->lonHp * 1e-9;
-    _instance->_gpsAltitude = ubxDataStruct->hMSL + ubxDataStruct->hMSLHp;
+    _instance->_gpsLatitude = epoch.latitude;
+    _instance->_gpsLongitude = epoch.longitude;
+    _instance->_gpsAltitude = epoch.altitudeMm;
     _instance->_gpsHorizontalAccuracy = ubxDataStruct->hAcc;
     _instance->_gpsVerticalAccuracy = ubxDataStruct->vAcc;
-    _instance->_gpsTimeOfWeek = ubxDataStruct->iTOW;
-    _instance->_gpsValidFix = (ubxDataStruct->flags.all & 0x01) != 0;
+    _instance->_gpsTimeOfWeek = epoch.timeOfWeek;
+    _instance->_gpsValidFix = epoch.validFix;
+    _instance->_gpsArrivalMicros = micros();
     
-    // Set fresh data flag
+    // Set fresh data flags
     _instance->_freshGpsData = true;
+    _instance->_freshFusionFix = true;
+}
+
+void SensorManager::gpsPVTCallback(UBX_NAV_PVT_data_t *ubxDataStruct) {
+    if (_instance == nullptr) return;
+    
+    // NAV-PVT precedes NAV-HPPOSLLH in each epoch - keep the velocity for it,
+    // and republish the current epoch in case the order ever differs
+    _instance->_gpsGroundSpeed = ubxDataStruct->gSpeed / 1000.0f;  // mm/s to m/s
+    _instance->_gpsHeading = ubxDataStruct->headMot * 1e-5f;       // deg * 1e-5
+    _instance->_gpsSatellites = ubxDataStruct->numSV;
+    _instance->_gpsFixOk = ubxDataStruct->flags.bits.gnssFixOK;
+    
+    GpsSnapshot epoch;
+    _instance->_gpsSnapshot.read(epoch);
+    epoch.validFix = epoch.validFix && _instance->_gpsFixOk;    // A lost fix shows at once
+    epoch.groundSpeed = _instance->_gpsGroundSpeed;
+    epoch.heading = _instance->_gpsHeading;
+    epoch.satellites = _instance->_gpsSatellites;
+    _instance->_gpsSnapshot.write(epoch);
 }
 
 void SensorManager::forwardRtcmToGps(const uint8_t* data, size_t len) {
@@ -759,38 +1315,76 @@ void SensorManager::forwardRtcmToGps(const uint8_t* data, size_t len) {
     // Forward RTCM correction data to GPS
     _gps.pushRawData(const_cast<uint8_t*>(data), len);
     
-    DiagnosticManager::logMessage(LOG_DEBUG, "SensorManager", "RTCM data forwarded: " + String(len) + " bytes");
+    BLOG(LOG_DEBUG, "SensorManager", "RTCM data forwarded: %u bytes", (unsigned)len);
+}
+
+void SensorManager::getSnapshot(SensorSnapshot* snapshot) {
+    if (!snapshot) return;
+    
+    // A failed read may have copied a torn section, so it is reset to its
+    // defaults (not valid) - only possible if this is called from an ISR
+    // that preempted a producer
+    if (!_gpsSnapshot.read(snapshot->gps)) snapshot->gps = GpsSnapshot();
+    if (!_imuSnapshot.read(snapshot->imu)) snapshot->imu = ImuSnapshot();
+    if (!_radarSnapshot.read(snapshot->radar)) snapshot->radar = RadarSnapshot();
+    if (!_fusionSnapshot.read(snapshot->fusion)) snapshot->fusion = FusionSnapshot();
 }
 
 void SensorManager::populatePacket(SensorDataPacket* packet) {
     if (!packet) return;
     
+    // Pick up any IMU samples that arrived since the last update()
+    if (_imuAcquisitionMode != IMU_ACQ_POLLED) {
+        drainImuSamples();
+    }
+    
+    // One consistent copy per producer - never a mix of epochs
+    SensorSnapshot snapshot;
+    getSnapshot(&snapshot);
+    
     // GPS data
-    packet->Latitude = _gpsLatitude;
-    packet->Longitude = _gpsLongitude;
-    packet->Altitude = _gpsAltitude / 1000.0f; // Convert mm to meters
-    packet->GPSFixQuality = _gpsValidFix ? 1 : 0;
-    packet->RTKStatus = (uint8_t)_rtkStatus;
-    packet->HorizontalAccuracy = _horizontalAccuracy;
+    packet->Latitude = snapshot.gps.latitude;
+    packet->Longitude = snapshot.gps.longitude;
+    packet->Altitude = snapshot.gps.altitudeMm / 1000.0f; // Convert mm to meters
+    packet->GPSFixQuality = snapshot.gps.validFix ? 1 : 0;
+    packet->RTKStatus = snapshot.gps.rtkStatus;
+    packet->HorizontalAccuracy = snapshot.gps.horizontalAccuracy;
+    packet->GPSTimestamp = snapshot.gps.timeOfWeek;
+    packet->GpsHeading = snapshot.gps.heading;
+    packet->GpsSpeed = snapshot.gps.groundSpeed;
+    packet->Satellites = snapshot.gps.satellites;
     
     // IMU data
-    packet->QuaternionW = _imuQuatReal;
-    packet->QuaternionX = _imuQuatI;
-    packet->QuaternionY = _imuQuatJ;
-    packet->QuaternionZ = _imuQuatK;
-    packet->AccelX = _imuAccelX;
-    packet->AccelY = _imuAccelY;
-    packet->AccelZ = _imuAccelZ;
-    packet->GyroX = _imuGyroX;
-    packet->GyroY = _imuGyroY;
-    packet->GyroZ = _imuGyroZ;
+    packet->QuaternionW = snapshot.imu.quatReal;
+    packet->QuaternionX = snapshot.imu.quatI;
+    packet->QuaternionY = snapshot.imu.quatJ;
+    packet->QuaternionZ = snapshot.imu.quatK;
+    packet->AccelX = snapshot.imu.accelX;
+    packet->AccelY = snapshot.imu.accelY;
+    packet->AccelZ = snapshot.imu.accelZ;
+    packet->GyroX = snapshot.imu.gyroX;
+    packet->GyroY = snapshot.imu.gyroY;
+    packet->GyroZ = snapshot.imu.gyroZ;
     
     // Radar data
-    packet->RadarDistance = _radarDistance;
-    packet->RadarValid = _radarDataValid ? 1 : 0;
+    packet->RadarDistance = snapshot.radar.distance;
+    packet->RadarValid = snapshot.radar.valid ? 1 : 0;
+    packet->RadarSampleMicros = snapshot.radar.sampleMicros;
+    
+    // Dead reckoning (wing modules) - state at the latest IMU sample
+    if (_enableDeadReckoning) {
+        packet->FusedLatitude = snapshot.fusion.latitude;
+        packet->FusedLongitude = snapshot.fusion.longitude;
+        packet->FusedAltitude = snapshot.fusion.altitude;
+        packet->VelocityNorth = snapshot.fusion.velocityNorth;
+        packet->VelocityEast = snapshot.fusion.velocityEast;
+        packet->VelocityDown = snapshot.fusion.velocityDown;
+        packet->FusionValid = snapshot.fusion.valid ? 1 : 0;
+    }
     
     // Timestamp
     packet->Timestamp = millis();
+    packet->SampleTimeMicros = snapshot.imu.sampleMicros ? snapshot.imu.sampleMicros : micros();
     
     // Sender ID based on module role
     switch (_moduleRole) {
@@ -802,7 +1396,7 @@ void SensorManager::populatePacket(SensorDataPacket* packet) {
 }
 
 String SensorManager::getGPSStatusString() {
-    if (!_gpsInitialized) return "GPS: FAIL";
+    if (!_gpsInitialized) return (_gpsFailures == 0) ? "GPS: INIT" : "GPS: RETRY";
     
     String status = "GPS: ";
     if (_gpsValidFix) {
@@ -811,7 +1405,7 @@ String SensorManager::getGPSStatusString() {
             case RTK_FLOAT: status += "RTK-FLT"; break;
             default:        status += "STD"; break;
         }
-        status += " " + String(_horizontalAccuracy, 2) + "m";
+        status += " " + String(_horizontalAccuracy, 2) + "m " + String(_gpsSatellites) + "sv";
     } else {
         status += "NO FIX";
     }
@@ -820,7 +1414,7 @@ String SensorManager::getGPSStatusString() {
 }
 
 String SensorManager::getIMUStatusString() {
-    if (!_imuInitialized) return "IMU: FAIL";
+    if (!_imuInitialized) return (_imuFailures == 0) ? "IMU: INIT" : "IMU: RETRY";
     
     String status = "IMU: ";
     if (_imuDataValid) {
@@ -833,7 +1427,7 @@ String SensorManager::getIMUStatusString() {
 }
 
 String SensorManager::getRadarStatusString() {
-    if (!_radarInitialized) return "Radar: FAIL";
+    if (!_radarInitialized) return (_radarFailures == 0) ? "Radar: INIT" : "Radar: RETRY";
     
     String status = "Radar: ";
     if (_radarDataValid) {
@@ -841,6 +1435,9 @@ String SensorManager::getRadarStatusString() {
     } else {
         status += "NO DATA";
     }
+    if (_radarMode == RADAR_MODE_TRACKING) {
+        status += _radarTracker.isGroundLocked() ? " GND" : (_radarTracker.isCanopyLocked() ? " CAN" : " SRCH");
+    }
     
     return status;
 }
@@ -850,3 +1447,12 @@ void SensorManager::logSensorStatus(const String& sensor, bool success) {
     LogLevel_t level = success ? LOG_INFO : LOG_ERROR;
     DiagnosticManager::logMessage(level, "SensorManager", message);
 }
+
+void SensorManager::logSensorRetry(const String& sensor, uint16_t failures) {
+    // First failure is already an error; after that keep the log readable while a
+    // sensor stays absent
+    if (failures <= 3 || (failures % 12) == 0) {
+        DiagnosticManager::logMessage(LOG_WARNING, "SensorManager",
+            sensor + " still not responding after " + String(failures) + " attempts - retrying");
+    }
+}
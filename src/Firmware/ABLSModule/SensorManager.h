@@ -7,7 +7,7 @@
  * - RTK quality monitoring and status reporting
  * - Dead reckoning sensor fusion (wing modules only)
  * - IMU orientation and motion sensing
- * - Radar distance measurement
+ * - Radar distance measurement with ground/canopy tracking
  * - Conditional feature activation based on module role
  * 
  * Author: James Hassall @ RobotsGoFarming.com
@@ -20,6 +20,15 @@
 #include <Arduino.h>
 #include "DataPackets.h"
 #include "ModuleConfig.h"
+#include "ImuSampleRing.h"
+#include "SensorSnapshot.h"
+#include "DeadlineMonitor.h"
+#include "DeadReckoningFilter.h"
+#include "GnssConfig.h"
+#include "StartupSequencer.h"
+#include "I2CBusGuard.h"
+#include "Sh2Reports.h"
+#include "RadarTracker.h"
 #include <SparkFun_BNO080_Arduino_Library.h>
 #include <SparkFun_Qwiic_XM125_Arduino_Library.h>
 #include <SparkFun_u-blox_GNSS_v3.h>
@@ -37,25 +46,131 @@ typedef enum {
     GPS_MODEL_AIRBORNE1G = 6    // For wing modules (boom tips)
 } GPSDynamicModel_t;
 
+// BNO080 acquisition modes
+typedef enum {
+    IMU_ACQ_POLLED = 0,     // updateIMU() polls dataAvailable() every 10ms from loop()
+    IMU_ACQ_INTERRUPT = 1,  // INT pin ISR reads each report into a timestamped ring
+    IMU_ACQ_BATCHED = 2     // INT pin ISR reads whole SH-2 packets - gyro-integrated
+                            // rotation vector for control, hub-batched accelerations
+} ImuAcquisitionMode_t;
+
+// BNO080 H_INTN pin (active low, asserted when a report is ready)
+#define IMU_INT_PIN                 22
+
+// I2C bus assignment - both default to Wire alongside the ram ADC and OLED
+#ifndef IMU_I2C_BUS
+#define IMU_I2C_BUS                 I2C_BUS_WIRE
+#endif
+
+#ifndef RADAR_I2C_BUS
+#define RADAR_I2C_BUS               I2C_BUS_WIRE
+#endif
+
+#ifndef IMU_DEFAULT_ACQUISITION_MODE
+#define IMU_DEFAULT_ACQUISITION_MODE IMU_ACQ_BATCHED
+#endif
+
+// Batched mode report plan - gyro, game and magnetometer rotation vectors are
+// not enabled, the gyro-integrated rotation vector carries orientation and rate
+#ifndef IMU_GYRO_RV_PERIOD_US
+#define IMU_GYRO_RV_PERIOD_US       2500    // 400Hz
+#endif
+#define IMU_MOTION_PERIOD_US        10000   // Accelerometer and linear acceleration, 100Hz
+#define IMU_MOTION_BATCH_US         20000   // Hub delivers them two epochs per packet
+
+// Upper bound on reports read per INT edge so a stuck INT line
+// cannot hold the CPU inside the ISR
+#define IMU_MAX_REPORTS_PER_EDGE    4
+
+// Rotation vector / accelerometer report period, also the poll period
+#define IMU_REPORT_PERIOD_US        10000   // 100Hz
+
+// XM125 radar bring-up and measurement sequence, advanced one step per update()
+typedef enum {
+    RADAR_STATE_OFFLINE = 0,        // Not configured - begin() and RESET_MODULE when a retry is due
+    RADAR_STATE_INIT_RESET_WAIT,    // Poll detector status until the reset completes
+    RADAR_STATE_INIT_CONFIGURE,     // Settle, then write range and threshold registers
+    RADAR_STATE_INIT_APPLY,         // Settle, then issue APPLY_CONFIGURATION
+    RADAR_STATE_INIT_APPLY_WAIT,    // Poll detector status, check errors, read back range
+    RADAR_STATE_IDLE,               // Waiting for next measurement slot
+    RADAR_STATE_START,              // Issue START_DETECTOR
+    RADAR_STATE_WAIT_MEASURE,       // Poll detector status until not busy
+    RADAR_STATE_CHECK_RESULT,       // Error, distance error and calibration flags
+    RADAR_STATE_READ_PEAKS,         // Read peak distances/strengths
+    RADAR_STATE_RECALIBRATE,        // Issue RECALIBRATE
+    RADAR_STATE_WAIT_RECALIBRATE,   // Poll detector status until not busy
+    RADAR_STATE_RECONFIGURE,        // Write the tracker's window, issue APPLY_CONFIGURATION
+    RADAR_STATE_WAIT_RECONFIGURE    // Poll detector status until not busy
+} RadarState_t;
+
+// Radar distance selection
+typedef enum {
+    RADAR_MODE_STRONGEST = 0,       // Strongest valid peak, full range every measurement
+    RADAR_MODE_TRACKING = 1         // RadarTracker ground/canopy tracks, adaptive window
+} RadarMode_t;
+
+#ifndef RADAR_DEFAULT_MODE
+#define RADAR_DEFAULT_MODE          RADAR_MODE_TRACKING
+#endif
+
+#define RADAR_UPDATE_INTERVAL_MS    20          // 50Hz measurement cadence
+#define RADAR_TRACK_INTERVAL_MS     10          // 100Hz while the ground is locked in a narrow window
+#define RADAR_BUSY_TIMEOUT_MS       500         // Abandon a measurement after this long
+#define RADAR_DETECTOR_BUSY_MASK    0x80000000  // Detector status register BUSY bit
+#define RADAR_INIT_SETTLE_MS        100         // Between reset, configuration and apply
+
+// Background retry of a sensor that failed to start
+#define SENSOR_RETRY_INTERVAL_MS    5000
+#define GNSS_RETRY_MAX_INTERVAL_MS  30000       // GNSS retry with a silent UART1 (connect blocks ~1s)
+
 class SensorManager {
 public:
     SensorManager();
     
-    // Initialization and lifecycle
-    bool initialize();
+    // Initialization and lifecycle - initialize() makes the first attempt at each
+    // sensor and never fails; update() retries any that did not come up
+    void initialize();
     void update();
-    bool isInitialized() { return _initialized; }
+    bool isInitialized() { return _initialized; }   // All three sensors up
+    StageState_t getGpsStartupState();
+    StageState_t getImuStartupState();
+    StageState_t getRadarStartupState();
     
     // GPS RTCM correction handling
     void forwardRtcmToGps(const uint8_t* data, size_t len);
     
     // Data access
     void populatePacket(SensorDataPacket* packet);
+    void getSnapshot(SensorSnapshot* snapshot);
     RTKStatus_t getRTKStatus() { return _rtkStatus; }
     float getHorizontalAccuracy() { return _horizontalAccuracy; }
     
-    // GPS Callback function (must be static for callback registration)
+    // GPS Callback functions (must be static for callback registration)
     static void gpsHPPOSLLHCallback(UBX_NAV_HPPOSLLH_data_t *ubxDataStruct);
+    static void gpsPVTCallback(UBX_NAV_PVT_data_t *ubxDataStruct);
+    
+    // GNSS navigation mode (call before initialize())
+    void setGnssMode(GnssMode_t mode) { _gnssMode = mode; }
+    GnssMode_t getGnssMode() { return _gnssMode; }
+    
+    // IMU acquisition configuration (call before initialize())
+    void setImuAcquisitionMode(ImuAcquisitionMode_t mode) { _imuAcquisitionMode = mode; }
+    ImuAcquisitionMode_t getImuAcquisitionMode() { return _imuAcquisitionMode; }
+    uint32_t getImuSamplesDropped() { return _imuRing.getDroppedCount(); }
+    uint32_t getImuSamplesDrained() { return _imuSamplesDrained; }
+    uint32_t getImuPacketsRead() { return _imuPacketsRead; }         // Batched mode I2C packet reads
+    uint32_t getImuReportsDecoded() { return _imuReportsDecoded; }   // Batched mode reports across them
+    uint32_t getRadarBusyTimeouts() { return _radarBusyTimeouts; }
+    
+    // Radar distance selection (call before initialize())
+    void setRadarMode(RadarMode_t mode) { _radarMode = mode; }
+    RadarMode_t getRadarMode() { return _radarMode; }
+    const RadarTracker& getRadarTracker() { return _radarTracker; }
+    uint32_t getRadarWindowChanges() { return _radarWindowChanges; }
+    DeadlineMonitor& getImuDeadline() { return _imuDeadline; }
+    
+    // Dead reckoning (wing modules only)
+    DeadReckoningFilter& getDeadReckoningFilter() { return _drFilter; }
     
     // Diagnostic information
     String getGPSStatusString();
@@ -69,10 +184,20 @@ private:
     bool _imuInitialized;
     bool _radarInitialized;
     
+    // Background retry state
+    uint16_t _gpsFailures, _imuFailures, _radarFailures;
+    uint32_t _lastGpsAttempt, _lastImuAttempt, _lastRadarAttempt;
+    
     // Module role-specific configuration
+#if ABLS_ROLE_FIXED
+    static constexpr ModuleRole_t _moduleRole = ModuleConfig::getBuildRole();
+    static constexpr bool _enableDeadReckoning = ModuleConfig::isWingBuild();
+#else
     ModuleRole_t _moduleRole;
-    GPSDynamicModel_t _gpsDynamicModel;
     bool _enableDeadReckoning;  // Only for wing modules
+#endif
+    GPSDynamicModel_t _gpsDynamicModel;
+    GnssMode_t _gnssMode;
     
     // GPS Callback State
     static SensorManager* _instance; // Static instance pointer for callback access
@@ -85,6 +210,12 @@ private:
     uint32_t _gpsVerticalAccuracy;   // mm * 0.1
     uint32_t _gpsTimeOfWeek; // ms
     bool _gpsValidFix;
+    bool _gpsFixOk;         // NAV-PVT gnssFixOK of the current epoch
+    
+    // GPS velocity (from NAV-PVT, same epoch rate)
+    float _gpsGroundSpeed;  // m/s
+    float _gpsHeading;      // Degrees, direction of motion
+    uint8_t _gpsSatellites;
     
     // RTK Quality Monitoring
     RTKStatus_t _rtkStatus; // Current RTK status
@@ -93,11 +224,12 @@ private:
     uint32_t _lastRTKStatusChange;
     
     // Dead Reckoning / Sensor Fusion State (Wing modules only)
-    float _fusedLatitude, _fusedLongitude, _fusedAltitude;
-    float _velocityX, _velocityY, _velocityZ; // m/s North, East, Down
+    DeadReckoningFilter _drFilter;
+    uint32_t _gpsArrivalMicros;     // micros() when the HPPOSLLH callback ran
+    bool _freshFusionFix;           // Epoch not yet applied to the filter
     uint32_t _lastGpsUpdateTime;
     uint32_t _lastImuUpdateTime;
-    uint32_t _lastFusionUpdate;
+    DeadlineMonitor _imuDeadline;   // Poll schedule, or observed report rate on INT
     
     // IMU Data - Enhanced with SparkFun BNO080 comprehensive features
     float _imuQuatI, _imuQuatJ, _imuQuatK, _imuQuatReal;
@@ -117,10 +249,43 @@ private:
     
     bool _imuDataValid;
     
+    // Interrupt-driven acquisition state
+    ImuAcquisitionMode_t _imuAcquisitionMode;
+    ImuSampleRing _imuRing;             // ISR producer -> foreground consumer
+    uint32_t _imuSamplesDrained;
+    uint32_t _lastImuSampleMicros;      // Timestamp of most recent accepted sample
+    volatile uint32_t _imuEdgeMicros;   // micros() latched at the INT edge
+    ImuSample _imuBatchSample;          // Batched mode: latest of every report (ISR only)
+    volatile uint32_t _imuPacketsRead;
+    volatile uint32_t _imuReportsDecoded;
+    
+    // Published snapshots (seqlock per producer)
+    SeqLock<GpsSnapshot> _gpsSnapshot;
+    SeqLock<ImuSnapshot> _imuSnapshot;
+    SeqLock<RadarSnapshot> _radarSnapshot;
+    SeqLock<FusionSnapshot> _fusionSnapshot;
+    RadarSnapshot _publishedRadar;      // Last radar values published
+    
     // Radar Data
     float _radarDistance; // meters
     bool _radarDataValid;
-    uint32_t _lastRadarUpdate;
+    uint32_t _lastRadarUpdate;      // Time of last valid reading
+    
+    // Radar state machine
+    RadarState_t _radarState;
+    uint32_t _radarStateTime;       // millis() on entering current state
+    uint32_t _radarCycleStart;      // millis() at start of current measurement
+    bool _radarCalibrationPending;
+    uint32_t _radarBusyTimeouts;
+    uint32_t _radarMeasureMicros;   // micros() when the last measurement completed
+    uint32_t _radarSampleMicros;    // Sample time of _radarDistance
+    
+    // Radar tracking
+    RadarMode_t _radarMode;
+    RadarTracker _radarTracker;
+    uint32_t _radarWindowStart, _radarWindowEnd;        // mm, as applied
+    uint32_t _radarPendingStart, _radarPendingEnd;      // mm, being applied
+    uint32_t _radarWindowChanges;
     
     // Sensor objects
     BNO080 _bno080;
@@ -130,15 +295,34 @@ private:
     // Internal methods
     bool initializeGPS();
     bool initializeIMU();
-    bool initializeRadar();
+    void retryFailedSensors(uint32_t now);
+    void checkAllSensorsInitialized();
+    void radarInitializationFailed(const String& reason);
     void updateGPS();
     void updateIMU();
+    void drainImuSamples();
+    bool readImuSample(ImuSample& sample);
+    bool readImuPacket();
+    void enableBatchedReports();
+    void processImuSample(const ImuSample& sample);
+    void checkImuTimeout();
+    void startImuInterrupt();
+    static void imuInterruptHandler();
+    static void imuBusService();
     void updateRadar();
+    void publishRadarSnapshot();
+    bool pollRadarBusy(const char* operation, RadarState_t failState = RADAR_STATE_IDLE);
+    void setRadarState(RadarState_t state);
+    void processRadarPeaks(uint32_t peak0Distance, int32_t peak0Strength,
+                           uint32_t peak1Distance, int32_t peak1Strength);
     void updateDeadReckoning(); // Wing modules only
+    void publishFusionSnapshot(uint32_t sampleMicros);
     void updateRTKStatus();
-    void configureGPSForRole();
+    dynModel getGPSDynamicModel();
     RTKStatus_t determineRTKStatus(uint32_t horizontalAccuracy);
     void logSensorStatus(const String& sensor, bool success);
+    void logSensorRetry(const String& sensor, uint16_t failures);
+    StageState_t startupState(bool initialized, uint16_t failures);
 };
 
 #endif // SENSOR_MANAGER_H
@@ -0,0 +1,133 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Sensor Packet Codec Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "SensorPacketCodec.h"
+#include "GpsTimeService.h"
+
+// Saturating fixed-point conversion for the v2 wire format
+int16_t SensorPacketCodec::toFixed16(float value, double scale) {
+    double scaled = round(value * scale);
+    if (scaled > 32767.0) return 32767;
+    if (scaled < -32768.0) return -32768;
+    return (int16_t)scaled;
+}
+
+uint16_t SensorPacketCodec::toFixedU16(float value, double scale) {
+    double scaled = round(value * scale);
+    if (scaled > 65535.0) return 65535;
+    if (scaled < 0.0) return 0;
+    return (uint16_t)scaled;
+}
+
+void SensorPacketCodec::encodeV1(const SensorDataPacket& packet, SensorDataPacketV1* wire) {
+    // Field-for-field copy into the original layout
+    wire->SenderId = packet.SenderId;
+    wire->Timestamp = packet.Timestamp;
+    wire->Latitude = packet.Latitude;
+    wire->Longitude = packet.Longitude;
+    wire->Altitude = packet.Altitude;
+    wire->GpsHeading = packet.GpsHeading;
+    wire->GpsSpeed = packet.GpsSpeed;
+    wire->Satellites = packet.Satellites;
+    wire->GPSFixQuality = packet.GPSFixQuality;
+    wire->RTKStatus = packet.RTKStatus;
+    wire->HorizontalAccuracy = packet.HorizontalAccuracy;
+    wire->GPSTimestamp = packet.GPSTimestamp;
+    wire->QuaternionW = packet.QuaternionW;
+    wire->QuaternionX = packet.QuaternionX;
+    wire->QuaternionY = packet.QuaternionY;
+    wire->QuaternionZ = packet.QuaternionZ;
+    wire->AccelX = packet.AccelX;
+    wire->AccelY = packet.AccelY;
+    wire->AccelZ = packet.AccelZ;
+    wire->GyroX = packet.GyroX;
+    wire->GyroY = packet.GyroY;
+    wire->GyroZ = packet.GyroZ;
+    wire->RadarDistance = packet.RadarDistance;
+    wire->RadarValid = packet.RadarValid;
+    wire->RamPosCenterPercent = packet.RamPosCenterPercent;
+    wire->RamPosLeftPercent = packet.RamPosLeftPercent;
+    wire->RamPosRightPercent = packet.RamPosRightPercent;
+}
+
+void SensorPacketCodec::encodeV2(const SensorDataPacket& packet, uint32_t sequence, SensorDataPacketV2* wire) {
+    memset(wire, 0, sizeof(SensorDataPacketV2));
+    
+    // Header
+    wire->Header.Magic = SENSOR_PACKET_MAGIC;
+    wire->Header.Version = SENSOR_PACKET_VERSION;
+    wire->Header.SenderId = packet.SenderId;
+    wire->Header.Sequence = sequence;
+    wire->Header.SampleTimeMicros = packet.SampleTimeMicros;
+    wire->Header.PayloadLength = sizeof(SensorDataPacketV2) - sizeof(SensorPacketHeaderV2);
+    
+    // GPS-disciplined timestamp lets the Toughbook align all three modules
+    uint64_t gpsTime = 0;
+    if (GpsTimeService::toGpsTime(packet.SampleTimeMicros, &gpsTime)) {
+        wire->Header.SampleGpsTimeMicros = gpsTime;
+        wire->Flags |= SENSOR_FLAG_TIME_SYNCED;
+    }
+    
+    // GPS data - lat/lon keep full HPPOSLLH resolution as 1e-9 degrees
+    wire->LatitudeE9 = llround(packet.Latitude * SENSOR_SCALE_LATLON);
+    wire->LongitudeE9 = llround(packet.Longitude * SENSOR_SCALE_LATLON);
+    wire->AltitudeMm = (int32_t)lround(packet.Altitude * 1000.0);
+    wire->HorizontalAccuracyMm = toFixedU16(packet.HorizontalAccuracy, 1000.0);
+    wire->GPSTimestamp = packet.GPSTimestamp;
+    // Heading goes out signed so all of 0-360 fits in int16 centidegrees
+    float heading = packet.GpsHeading > 180.0f ? packet.GpsHeading - 360.0f : packet.GpsHeading;
+    wire->GpsHeadingCdeg = toFixed16(heading, 100.0);
+    wire->GpsSpeedCms = toFixedU16(packet.GpsSpeed, 100.0);
+    wire->Satellites = (uint8_t)constrain(packet.Satellites, 0, 255);
+    wire->GPSFixQuality = packet.GPSFixQuality;
+    wire->RTKStatus = packet.RTKStatus;
+    
+    if (packet.GPSFixQuality > 0) wire->Flags |= SENSOR_FLAG_GPS_FIX;
+    if (packet.RadarValid) wire->Flags |= SENSOR_FLAG_RADAR_VALID;
+    if (packet.FusionValid) wire->Flags |= SENSOR_FLAG_FUSION_VALID;
+    
+    // IMU data
+    wire->QuaternionW = toFixed16(packet.QuaternionW, SENSOR_SCALE_QUAT);
+    wire->QuaternionX = toFixed16(packet.QuaternionX, SENSOR_SCALE_QUAT);
+    wire->QuaternionY = toFixed16(packet.QuaternionY, SENSOR_SCALE_QUAT);
+    wire->QuaternionZ = toFixed16(packet.QuaternionZ, SENSOR_SCALE_QUAT);
+    wire->AccelX = toFixed16(packet.AccelX, SENSOR_SCALE_ACCEL);
+    wire->AccelY = toFixed16(packet.AccelY, SENSOR_SCALE_ACCEL);
+    wire->AccelZ = toFixed16(packet.AccelZ, SENSOR_SCALE_ACCEL);
+    wire->GyroX = toFixed16(packet.GyroX, SENSOR_SCALE_GYRO);
+    wire->GyroY = toFixed16(packet.GyroY, SENSOR_SCALE_GYRO);
+    wire->GyroZ = toFixed16(packet.GyroZ, SENSOR_SCALE_GYRO);
+    
+    // Radar data
+    wire->RadarDistanceMm = toFixedU16(packet.RadarDistance, 1000.0);
+    
+    // Hydraulic ram positions
+    wire->RamPosCenter = toFixed16(packet.RamPosCenterPercent, SENSOR_SCALE_RAM);
+    wire->RamPosLeft = toFixed16(packet.RamPosLeftPercent, SENSOR_SCALE_RAM);
+    wire->RamPosRight = toFixed16(packet.RamPosRightPercent, SENSOR_SCALE_RAM);
+    
+    // Per-sensor sample times, relative to the IMU sample
+    wire->RadarTimeOffsetUs = (int32_t)(packet.RadarSampleMicros - packet.SampleTimeMicros);
+    wire->RamTimeOffsetUs = (int32_t)(packet.RamSampleMicros - packet.SampleTimeMicros);
+    
+    // Dead reckoning - fused state is propagated to the IMU sample time
+    wire->FusedLatitudeE9 = llround(packet.FusedLatitude * SENSOR_SCALE_LATLON);
+    wire->FusedLongitudeE9 = llround(packet.FusedLongitude * SENSOR_SCALE_LATLON);
+    wire->FusedAltitudeMm = (int32_t)lround(packet.FusedAltitude * 1000.0);
+    wire->VelocityNorth = toFixed16(packet.VelocityNorth, SENSOR_SCALE_VELOCITY);
+    wire->VelocityEast = toFixed16(packet.VelocityEast, SENSOR_SCALE_VELOCITY);
+    wire->VelocityDown = toFixed16(packet.VelocityDown, SENSOR_SCALE_VELOCITY);
+    
+    // Command echo - lets the Toughbook measure command-to-valve latency
+    if (packet.CommandEchoValid) {
+        wire->CommandId = packet.CommandId;
+        wire->CommandReceiveOffsetUs = (int32_t)(packet.CommandReceiveMicros - packet.SampleTimeMicros);
+        wire->CommandApplyOffsetUs = (int32_t)(packet.CommandApplyMicros - packet.SampleTimeMicros);
+        wire->Flags |= SENSOR_FLAG_COMMAND_ECHO;
+    }
+}
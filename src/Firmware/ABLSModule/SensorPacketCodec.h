@@ -0,0 +1,31 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Sensor Packet Codec
+ *
+ * Encodes the internal SensorDataPacket into the wire formats sent to
+ * the Toughbook:
+ * - v1: the original struct layout, field for field
+ * - v2: packed, versioned, fixed-point (see DataPackets.h)
+ * - No network dependency, so the encoders also build on the host
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef SENSOR_PACKET_CODEC_H
+#define SENSOR_PACKET_CODEC_H
+
+#include <Arduino.h>
+#include "DataPackets.h"
+
+class SensorPacketCodec {
+public:
+    static void encodeV1(const SensorDataPacket& packet, SensorDataPacketV1* wire);
+    static void encodeV2(const SensorDataPacket& packet, uint32_t sequence, SensorDataPacketV2* wire);
+
+    // Saturating fixed-point conversion, shared with the other v2-style packets
+    static int16_t toFixed16(float value, double scale);
+    static uint16_t toFixedU16(float value, double scale);
+};
+
+#endif // SENSOR_PACKET_CODEC_H
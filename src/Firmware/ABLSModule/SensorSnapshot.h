@@ -0,0 +1,120 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Sensor Snapshot
+ *
+ * Epoch-coherent copies of the latest GPS, IMU and radar data:
+ * - Each sensor publishes its own section through a seqlock
+ * - Readers copy a whole section and retry if a write overlapped
+ * - Neither side disables interrupts or blocks
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef SENSOR_SNAPSHOT_H
+#define SENSOR_SNAPSHOT_H
+
+#include <Arduino.h>
+
+// Reads retried this many times before giving up (writer preempted by reader)
+#define SEQLOCK_MAX_READ_ATTEMPTS   4
+
+// Data memory barrier between payload and index/sequence stores
+#ifndef MEMORY_BARRIER
+#define MEMORY_BARRIER() asm volatile("dmb" ::: "memory")
+#endif
+
+// Single-writer sequence lock around a plain-data value.
+// Sequence is odd while a write is in progress.
+template <typename T>
+class SeqLock {
+public:
+    SeqLock() : _sequence(0), _data() {}
+
+    // Writer side - one producer per SeqLock (foreground or ISR)
+    void write(const T& value) {
+        uint32_t sequence = _sequence;
+        _sequence = sequence + 1;
+        MEMORY_BARRIER();
+        _data = value;
+        MEMORY_BARRIER();
+        _sequence = sequence + 2;
+    }
+
+    // Reader side - returns false if no consistent copy could be taken,
+    // which only happens when the reader has preempted the writer
+    bool read(T& value) const {
+        for (int attempt = 0; attempt < SEQLOCK_MAX_READ_ATTEMPTS; attempt++) {
+            uint32_t before = _sequence;
+            if (before & 1) continue;
+            MEMORY_BARRIER();
+            value = _data;
+            MEMORY_BARRIER();
+            if (_sequence == before) return true;
+        }
+        return false;
+    }
+
+    // Number of completed writes
+    uint32_t getVersion() const { return _sequence >> 1; }
+
+private:
+    volatile uint32_t _sequence;
+    T _data;
+};
+
+// GPS epoch from NAV-HPPOSLLH, with speed/heading from the epoch's NAV-PVT
+struct GpsSnapshot {
+    double latitude = 0.0;              // Degrees
+    double longitude = 0.0;             // Degrees
+    int32_t altitudeMm = 0;             // mm above MSL
+    float horizontalAccuracy = 99.9f;   // Metres
+    float verticalAccuracy = 99.9f;     // Metres
+    uint32_t timeOfWeek = 0;            // iTOW (ms)
+    uint8_t rtkStatus = 0;              // RTKStatus_t
+    bool validFix = false;
+    float groundSpeed = 0.0f;           // m/s
+    float heading = 0.0f;               // Degrees, direction of motion
+    uint8_t satellites = 0;
+    uint32_t updateMillis = 0;          // millis() when published
+};
+
+// IMU sample that passed validation
+struct ImuSnapshot {
+    float quatI = 0.0f, quatJ = 0.0f, quatK = 0.0f, quatReal = 1.0f;
+    float accelX = 0.0f, accelY = 0.0f, accelZ = 0.0f;
+    float linAccelX = 0.0f, linAccelY = 0.0f, linAccelZ = 0.0f;
+    float gyroX = 0.0f, gyroY = 0.0f, gyroZ = 0.0f;
+    uint8_t quatAccuracy = 0, accelAccuracy = 0, gyroAccuracy = 0;
+    uint32_t sampleMicros = 0;          // INT edge (or poll) time of the sample
+};
+
+// Latest radar result
+struct RadarSnapshot {
+    float distance = 0.0f;              // Metres
+    bool valid = false;
+    uint32_t sampleMicros = 0;          // Measurement completion time
+    uint32_t updateMillis = 0;
+};
+
+// Dead reckoning output, updated on every IMU sample (wing modules only)
+struct FusionSnapshot {
+    double latitude = 0.0;              // Degrees
+    double longitude = 0.0;             // Degrees
+    double altitude = 0.0;              // Metres above MSL
+    float velocityNorth = 0.0f;         // m/s
+    float velocityEast = 0.0f;
+    float velocityDown = 0.0f;
+    bool valid = false;
+    uint32_t sampleMicros = 0;          // IMU sample the state was propagated to
+};
+
+// Consistent copy of everything, taken section by section
+struct SensorSnapshot {
+    GpsSnapshot gps;
+    ImuSnapshot imu;
+    RadarSnapshot radar;
+    FusionSnapshot fusion;
+};
+
+#endif // SENSOR_SNAPSHOT_H
@@ -0,0 +1,146 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * SH-2 Report Batches Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "Sh2Reports.h"
+
+// Fixed-point Q points of the report fields (SH-2 reference manual)
+#define SH2_Q_ACCELERATION      8
+#define SH2_Q_GYRO              9
+#define SH2_Q_ROTATION          14
+#define SH2_Q_GYRO_RV_RATE      10
+
+static uint32_t read32(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static void write32(uint8_t* bytes, uint32_t value) {
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+    bytes[2] = (uint8_t)(value >> 16);
+    bytes[3] = (uint8_t)(value >> 24);
+}
+
+void Sh2Reports::setFeature(BNO080& imu, uint8_t reportId, uint32_t intervalMicros, uint32_t batchMicros) {
+    uint8_t* command = imu.shtpData;
+    memset(command, 0, SH2_SET_FEATURE_LENGTH);
+    command[0] = SH2_REPORT_SET_FEATURE;
+    command[1] = reportId;
+    write32(&command[5], intervalMicros);
+    write32(&command[9], batchMicros);
+    imu.sendPacket(SH2_CHANNEL_CONTROL, SH2_SET_FEATURE_LENGTH);
+}
+
+uint8_t Sh2Reports::reportLength(uint8_t reportId) {
+    switch (reportId) {
+        case SH2_REPORT_BASE_TIMESTAMP:
+        case SH2_REPORT_TIMESTAMP_REBASE:           return 5;
+        case SENSOR_REPORTID_ACCELEROMETER:
+        case SENSOR_REPORTID_GYROSCOPE:
+        case SENSOR_REPORTID_LINEAR_ACCELERATION:   return 10;
+        case SENSOR_REPORTID_GAME_ROTATION_VECTOR:  return 12;
+        case SENSOR_REPORTID_ROTATION_VECTOR:       return 14;
+        default:                                    return 0;
+    }
+}
+
+Sh2DecodeResult Sh2Reports::decodePacket(const uint8_t* header, const uint8_t* data,
+                                         uint32_t interruptMicros, ImuSample& sample) {
+    Sh2DecodeResult result;
+
+    // Header length includes the header itself; bit 15 marks a continuation
+    uint16_t length = (uint16_t)((header[0] | (header[1] << 8)) & 0x7FFF);
+    if (length <= 4) return result;
+    length -= 4;
+    if (length > MAX_PACKET_SIZE) length = MAX_PACKET_SIZE;     // The library keeps no more
+
+    if (header[2] == SH2_CHANNEL_GYRO_RV) {
+        // Bare report: quaternion then angular rate, no ID, status or delay.
+        // It carries no accuracy, so the fused motion reports' status stands in.
+        if (length < 14) return result;
+        sample.quatI = fixed(&data[0], SH2_Q_ROTATION);
+        sample.quatJ = fixed(&data[2], SH2_Q_ROTATION);
+        sample.quatK = fixed(&data[4], SH2_Q_ROTATION);
+        sample.quatReal = fixed(&data[6], SH2_Q_ROTATION);
+        sample.gyroX = fixed(&data[8], SH2_Q_GYRO_RV_RATE);
+        sample.gyroY = fixed(&data[10], SH2_Q_GYRO_RV_RATE);
+        sample.gyroZ = fixed(&data[12], SH2_Q_GYRO_RV_RATE);
+        sample.quatAccuracy = sample.linAccelAccuracy;
+        sample.gyroAccuracy = sample.linAccelAccuracy;
+        sample.reportId = SH2_REPORT_GYRO_INTEGRATED_RV;
+        sample.timestampMicros = interruptMicros;
+        result.reports = 1;
+        result.orientationReports = 1;
+        return result;
+    }
+
+    if (header[2] != SH2_CHANNEL_REPORTS) return result;
+
+    // Report times: interrupt - base delta (+ rebase) + each report's delay
+    uint32_t baseMicros = interruptMicros;
+    uint16_t offset = 0;
+    while (offset < length) {
+        const uint8_t* report = &data[offset];
+        uint8_t size = reportLength(report[0]);
+        if (size == 0) {
+            result.unknownReport = true;
+            break;
+        }
+        if (offset + size > length) break;
+        offset += size;
+
+        if (report[0] == SH2_REPORT_BASE_TIMESTAMP) {
+            baseMicros = interruptMicros - read32(&report[1]) * SH2_TIMESTAMP_UNIT_US;
+            continue;
+        }
+        if (report[0] == SH2_REPORT_TIMESTAMP_REBASE) {
+            baseMicros += (uint32_t)((int32_t)read32(&report[1]) * SH2_TIMESTAMP_UNIT_US);
+            continue;
+        }
+
+        uint8_t accuracy = report[2] & 0x03;
+        uint16_t delay = (uint16_t)(((report[2] & 0xFC) << 6) | report[3]);
+        uint32_t reportMicros = baseMicros + (uint32_t)delay * SH2_TIMESTAMP_UNIT_US;
+
+        switch (report[0]) {
+            case SENSOR_REPORTID_ACCELEROMETER:
+                sample.accelX = fixed(&report[4], SH2_Q_ACCELERATION);
+                sample.accelY = fixed(&report[6], SH2_Q_ACCELERATION);
+                sample.accelZ = fixed(&report[8], SH2_Q_ACCELERATION);
+                sample.accelAccuracy = accuracy;
+                sample.accelMicros = reportMicros;
+                break;
+            case SENSOR_REPORTID_LINEAR_ACCELERATION:
+                sample.linAccelX = fixed(&report[4], SH2_Q_ACCELERATION);
+                sample.linAccelY = fixed(&report[6], SH2_Q_ACCELERATION);
+                sample.linAccelZ = fixed(&report[8], SH2_Q_ACCELERATION);
+                sample.linAccelAccuracy = accuracy;
+                sample.accelMicros = reportMicros;
+                break;
+            case SENSOR_REPORTID_GYROSCOPE:
+                sample.gyroX = fixed(&report[4], SH2_Q_GYRO);
+                sample.gyroY = fixed(&report[6], SH2_Q_GYRO);
+                sample.gyroZ = fixed(&report[8], SH2_Q_GYRO);
+                sample.gyroAccuracy = accuracy;
+                break;
+            case SENSOR_REPORTID_ROTATION_VECTOR:
+            case SENSOR_REPORTID_GAME_ROTATION_VECTOR:
+                sample.quatI = fixed(&report[4], SH2_Q_ROTATION);
+                sample.quatJ = fixed(&report[6], SH2_Q_ROTATION);
+                sample.quatK = fixed(&report[8], SH2_Q_ROTATION);
+                sample.quatReal = fixed(&report[10], SH2_Q_ROTATION);
+                sample.quatAccuracy = accuracy;
+                sample.reportId = report[0];
+                sample.timestampMicros = reportMicros;
+                result.orientationReports++;
+                break;
+        }
+        result.reports++;
+    }
+
+    return result;
+}
@@ -0,0 +1,65 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * SH-2 Report Batches
+ *
+ * Direct SHTP access to the BNO080 for batched acquisition (IMU_ACQ_BATCHED):
+ * - Set Feature commands with microsecond report and hub batch intervals
+ *   (the library's enable*() calls only take whole milliseconds, so 400Hz
+ *   is out of their reach, and never batch)
+ * - Decoding of every input report in a packet from one receivePacket(),
+ *   each stamped from the base timestamp plus its own delay field
+ * - Gyro-integrated rotation vector packets on the low-latency channel
+ *
+ * Decoding is allocation and logging free - it runs in the INT handler.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef SH2_REPORTS_H
+#define SH2_REPORTS_H
+
+#include <Arduino.h>
+#include <SparkFun_BNO080_Arduino_Library.h>
+#include "ImuSampleRing.h"
+
+// SHTP channels
+#define SH2_CHANNEL_CONTROL             2
+#define SH2_CHANNEL_REPORTS             3
+#define SH2_CHANNEL_GYRO_RV             5   // Gyro-integrated rotation vector, one report per packet
+
+// SH-2 report IDs used here beyond the library's SENSOR_REPORTID_* set
+#define SH2_REPORT_SET_FEATURE          0xFD
+#define SH2_REPORT_BASE_TIMESTAMP       0xFB
+#define SH2_REPORT_TIMESTAMP_REBASE     0xFA
+#define SH2_REPORT_GYRO_INTEGRATED_RV   0x2A
+
+#define SH2_SET_FEATURE_LENGTH          17
+#define SH2_TIMESTAMP_UNIT_US           100 // Base timestamp and delay fields
+
+// What one packet contributed to the carried sample
+struct Sh2DecodeResult {
+    uint8_t reports = 0;                // Sensor reports decoded
+    uint8_t orientationReports = 0;     // Of which gyro-integrated rotation vector
+    bool unknownReport = false;         // Stopped early on an ID of unknown length
+};
+
+class Sh2Reports {
+public:
+    // Enable a report at intervalMicros, delivered in hub batches of up to
+    // batchMicros (0 = as soon as each is ready)
+    static void setFeature(BNO080& imu, uint8_t reportId, uint32_t intervalMicros, uint32_t batchMicros);
+
+    // Fold every report in the last received packet into sample. interruptMicros
+    // is the host interrupt time the SH-2 timestamps are relative to. Orientation
+    // reports set sample.timestampMicros; motion reports set sample.accelMicros.
+    static Sh2DecodeResult decodePacket(const uint8_t* header, const uint8_t* data,
+                                        uint32_t interruptMicros, ImuSample& sample);
+
+private:
+    static uint8_t reportLength(uint8_t reportId);
+    static int16_t read16(const uint8_t* bytes) { return (int16_t)(bytes[0] | (bytes[1] << 8)); }
+    static float fixed(const uint8_t* bytes, uint8_t qPoint) { return read16(bytes) / (float)(1 << qPoint); }
+};
+
+#endif // SH2_REPORTS_H
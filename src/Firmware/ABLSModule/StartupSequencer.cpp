@@ -0,0 +1,136 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Startup Sequencer Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "StartupSequencer.h"
+#include "DiagnosticManager.h"
+#include "SensorManager.h"
+#include "HydraulicController.h"
+#ifndef STARTUP_NO_NETWORK
+#include "NetworkManager.h"
+#endif
+
+// Static member initialization
+SensorManager* StartupSequencer::_sensors = nullptr;
+NetworkManager* StartupSequencer::_network = nullptr;
+HydraulicController* StartupSequencer::_hydraulics = nullptr;
+StageState_t StartupSequencer::_reported[STARTUP_STAGE_COUNT] = {};
+uint32_t StartupSequencer::_readyMillis[STARTUP_STAGE_COUNT] = {};
+uint32_t StartupSequencer::_operationalMillis = 0;
+
+void StartupSequencer::begin(SensorManager* sensors, NetworkManager* network, HydraulicController* hydraulics) {
+    _sensors = sensors;
+    _network = network;
+    _hydraulics = hydraulics;
+    _operationalMillis = 0;
+
+    for (int stage = 0; stage < STARTUP_STAGE_COUNT; stage++) {
+        _reported[stage] = STAGE_STARTING;
+        _readyMillis[stage] = 0;
+    }
+
+    DiagnosticManager::logMessage(LOG_INFO, "Startup", "Staged bring-up started at " + String(millis()) + "ms");
+    update();
+}
+
+void StartupSequencer::update() {
+    bool allReady = true;
+
+    for (int i = 0; i < STARTUP_STAGE_COUNT; i++) {
+        StartupStage_t stage = (StartupStage_t)i;
+        StageState_t state = pollStage(stage);
+        if (state != _reported[stage]) {
+            reportTransition(stage, state);
+        }
+        if (state != STAGE_READY && state != STAGE_NOT_USED) allReady = false;
+    }
+
+    // Operational is latched - a stage dropping out later is that component's fault to report
+    if (allReady && _operationalMillis == 0) {
+        _operationalMillis = millis();
+        if (_operationalMillis == 0) _operationalMillis = 1;
+        DiagnosticManager::logMessage(LOG_INFO, "Startup", "Operational after " + String(_operationalMillis) + "ms");
+        DiagnosticManager::setSystemStatus("Operational after " + String(_operationalMillis) + "ms");
+    }
+}
+
+StageState_t StartupSequencer::pollStage(StartupStage_t stage) {
+    switch (stage) {
+        case STARTUP_STAGE_HYDRAULICS:
+            return _hydraulics ? _hydraulics->getStartupState() : STAGE_NOT_USED;
+        case STARTUP_STAGE_GPS:
+            return _sensors ? _sensors->getGpsStartupState() : STAGE_NOT_USED;
+        case STARTUP_STAGE_IMU:
+            return _sensors ? _sensors->getImuStartupState() : STAGE_NOT_USED;
+        case STARTUP_STAGE_RADAR:
+            return _sensors ? _sensors->getRadarStartupState() : STAGE_NOT_USED;
+        case STARTUP_STAGE_NETWORK:
+#ifndef STARTUP_NO_NETWORK
+            return _network ? _network->getStartupState() : STAGE_NOT_USED;
+#else
+            return STAGE_NOT_USED;
+#endif
+        default:
+            return STAGE_NOT_USED;
+    }
+}
+
+void StartupSequencer::reportTransition(StartupStage_t stage, StageState_t state) {
+    _reported[stage] = state;
+
+    switch (state) {
+        case STAGE_READY:
+            _readyMillis[stage] = millis();
+            DiagnosticManager::logMessage(LOG_INFO, "Startup",
+                String(getStageName(stage)) + " ready at " + String(_readyMillis[stage]) + "ms");
+            break;
+        case STAGE_RETRYING:
+            DiagnosticManager::logMessage(LOG_WARNING, "Startup",
+                String(getStageName(stage)) + " not responding - retrying in background");
+            break;
+        case STAGE_NOT_USED:
+            DIAG_LOG(LOG_DEBUG, "Startup", String(getStageName(stage)) + " not used by this module");
+            break;
+        default:
+            break;
+    }
+}
+
+StageState_t StartupSequencer::getStageState(StartupStage_t stage) {
+    return (stage < STARTUP_STAGE_COUNT) ? _reported[stage] : STAGE_NOT_USED;
+}
+
+uint32_t StartupSequencer::getStageReadyMillis(StartupStage_t stage) {
+    return (stage < STARTUP_STAGE_COUNT) ? _readyMillis[stage] : 0;
+}
+
+const char* StartupSequencer::getStageName(StartupStage_t stage) {
+    switch (stage) {
+        case STARTUP_STAGE_HYDRAULICS: return "Hydraulics";
+        case STARTUP_STAGE_GPS:        return "GPS";
+        case STARTUP_STAGE_IMU:        return "IMU";
+        case STARTUP_STAGE_RADAR:      return "Radar";
+        case STARTUP_STAGE_NETWORK:    return "Network";
+        default:                       return "Unknown";
+    }
+}
+
+String StartupSequencer::getStatusString() {
+    if (isOperational()) return "Operational";
+
+    // Stages still outstanding, e.g. "Starting: GPS Radar(retry)"
+    String status = "Starting:";
+    for (int i = 0; i < STARTUP_STAGE_COUNT; i++) {
+        if (_reported[i] == STAGE_STARTING) {
+            status += " " + String(getStageName((StartupStage_t)i));
+            if (i == STARTUP_STAGE_HYDRAULICS) status += "(hold)";
+        } else if (_reported[i] == STAGE_RETRYING) {
+            status += " " + String(getStageName((StartupStage_t)i)) + "(retry)";
+        }
+    }
+    return status;
+}
@@ -0,0 +1,71 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Startup Sequencer
+ *
+ * Tracks the staged, non-blocking bring-up that follows setup():
+ * - Hydraulics start in a safe hold at once (valves neutral until
+ *   every ram has feedback, then holding the measured positions)
+ * - GPS, IMU, radar and network come up side by side from their own
+ *   update() calls and retry in the background - nothing halts
+ * - Each stage's state is polled here, transitions are logged with the
+ *   time since boot, and "operational" is reported once all are ready
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef STARTUP_SEQUENCER_H
+#define STARTUP_SEQUENCER_H
+
+#include <Arduino.h>
+
+// Forward declarations
+class SensorManager;
+class NetworkManager;
+class HydraulicController;
+
+// Bring-up stages
+typedef enum {
+    STARTUP_STAGE_HYDRAULICS = 0,
+    STARTUP_STAGE_GPS,
+    STARTUP_STAGE_IMU,
+    STARTUP_STAGE_RADAR,
+    STARTUP_STAGE_NETWORK,
+    STARTUP_STAGE_COUNT
+} StartupStage_t;
+
+// State of one stage, as reported by the component that owns it
+typedef enum {
+    STAGE_NOT_USED = 0,     // Not part of this module's role (or not built)
+    STAGE_STARTING,         // First attempt in progress (hydraulics: safe hold)
+    STAGE_RETRYING,         // An attempt failed - retrying in the background
+    STAGE_READY
+} StageState_t;
+
+class StartupSequencer {
+public:
+    // Components may be nullptr where a build has none; the host simulator
+    // also builds with STARTUP_NO_NETWORK as it has no Ethernet stack
+    static void begin(SensorManager* sensors, NetworkManager* network, HydraulicController* hydraulics);
+    static void update();
+
+    static StageState_t getStageState(StartupStage_t stage);
+    static const char* getStageName(StartupStage_t stage);
+    static bool isOperational() { return _operationalMillis != 0; }
+    static uint32_t getOperationalMillis() { return _operationalMillis; }  // millis() when every stage was ready
+    static uint32_t getStageReadyMillis(StartupStage_t stage);
+    static String getStatusString();
+
+private:
+    static SensorManager* _sensors;
+    static NetworkManager* _network;
+    static HydraulicController* _hydraulics;
+    static StageState_t _reported[STARTUP_STAGE_COUNT];
+    static uint32_t _readyMillis[STARTUP_STAGE_COUNT];
+    static uint32_t _operationalMillis;
+
+    static StageState_t pollStage(StartupStage_t stage);
+    static void reportTransition(StartupStage_t stage, StageState_t state);
+};
+
+#endif // STARTUP_SEQUENCER_H
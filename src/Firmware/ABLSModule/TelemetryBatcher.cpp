@@ -0,0 +1,261 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Telemetry Batcher Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "TelemetryBatcher.h"
+#include "SensorPacketCodec.h"
+#include "GpsTimeService.h"
+
+// Record storage - times are held absolute and made relative in build()
+static SensorBatchImu imuRecords[TELEMETRY_IMU_CAPACITY];
+static SensorBatchRadar radarRecords[TELEMETRY_RADAR_CAPACITY];
+static SensorBatchRam ramRecords[TELEMETRY_RAM_CAPACITY];
+static SensorBatchFusion fusionRecords[TELEMETRY_FUSION_CAPACITY];
+static SensorBatchGnss gnssRecord;
+static SensorBatchCommandEcho commandRecord;
+
+// Static member initialization
+bool TelemetryBatcher::_enabled = false;
+TelemetryBatcher::Queue TelemetryBatcher::_queues[SENSOR_STREAM_COUNT] = {
+    { (uint8_t*)imuRecords, sizeof(SensorBatchImu), TELEMETRY_IMU_CAPACITY, 0, 0 },
+    { (uint8_t*)radarRecords, sizeof(SensorBatchRadar), TELEMETRY_RADAR_CAPACITY, 0, 0 },
+    { (uint8_t*)ramRecords, sizeof(SensorBatchRam), TELEMETRY_RAM_CAPACITY, 0, 0 },
+    { (uint8_t*)fusionRecords, sizeof(SensorBatchFusion), TELEMETRY_FUSION_CAPACITY, 0, 0 },
+    { (uint8_t*)&gnssRecord, sizeof(SensorBatchGnss), 1, 0, 0 },
+    { (uint8_t*)&commandRecord, sizeof(SensorBatchCommandEcho), 1, 0, 0 }
+};
+uint32_t TelemetryBatcher::_intervalMicros[SENSOR_STREAM_COUNT] = {
+    TELEMETRY_IMU_INTERVAL_US, TELEMETRY_RADAR_INTERVAL_US, TELEMETRY_RAM_INTERVAL_US,
+    TELEMETRY_FUSION_INTERVAL_US, TELEMETRY_GNSS_INTERVAL_US, TELEMETRY_COMMAND_INTERVAL_US
+};
+uint32_t TelemetryBatcher::_lastSampleMicros[SENSOR_STREAM_COUNT] = {};
+bool TelemetryBatcher::_sampled[SENSOR_STREAM_COUNT] = {};
+bool TelemetryBatcher::_changed[SENSOR_STREAM_COUNT] = {};
+uint32_t TelemetryBatcher::_lastSentMicros[SENSOR_STREAM_COUNT] = {};
+uint32_t TelemetryBatcher::_samplesSent[SENSOR_STREAM_COUNT] = {};
+volatile uint32_t TelemetryBatcher::_samplesDropped = 0;
+uint32_t TelemetryBatcher::_droppedReported = 0;
+uint32_t TelemetryBatcher::_datagramsBuilt = 0;
+
+void TelemetryBatcher::setEnabled(bool enabled) {
+    noInterrupts();
+    _enabled = enabled;
+    for (int stream = 0; stream < SENSOR_STREAM_COUNT; stream++) {
+        _queues[stream].head = 0;
+        _queues[stream].count = 0;
+        _sampled[stream] = false;
+        _changed[stream] = false;
+    }
+    interrupts();
+}
+
+void TelemetryBatcher::setStreamInterval(SensorStreamId_t stream, uint32_t intervalMicros) {
+    if (stream >= SENSOR_STREAM_COUNT) return;
+    _intervalMicros[stream] = intervalMicros;
+}
+
+void TelemetryBatcher::recordImu(const ImuSnapshot& imu) {
+    if (!_enabled) return;
+
+    SensorBatchImu record;
+    record.TimeOffsetUs = (int32_t)imu.sampleMicros;
+    record.QuaternionW = SensorPacketCodec::toFixed16(imu.quatReal, SENSOR_SCALE_QUAT);
+    record.QuaternionX = SensorPacketCodec::toFixed16(imu.quatI, SENSOR_SCALE_QUAT);
+    record.QuaternionY = SensorPacketCodec::toFixed16(imu.quatJ, SENSOR_SCALE_QUAT);
+    record.QuaternionZ = SensorPacketCodec::toFixed16(imu.quatK, SENSOR_SCALE_QUAT);
+    record.AccelX = SensorPacketCodec::toFixed16(imu.accelX, SENSOR_SCALE_ACCEL);
+    record.AccelY = SensorPacketCodec::toFixed16(imu.accelY, SENSOR_SCALE_ACCEL);
+    record.AccelZ = SensorPacketCodec::toFixed16(imu.accelZ, SENSOR_SCALE_ACCEL);
+    record.GyroX = SensorPacketCodec::toFixed16(imu.gyroX, SENSOR_SCALE_GYRO);
+    record.GyroY = SensorPacketCodec::toFixed16(imu.gyroY, SENSOR_SCALE_GYRO);
+    record.GyroZ = SensorPacketCodec::toFixed16(imu.gyroZ, SENSOR_SCALE_GYRO);
+    push(SENSOR_STREAM_IMU, imu.sampleMicros, &record);
+}
+
+void TelemetryBatcher::recordRadar(const RadarSnapshot& radar) {
+    if (!_enabled) return;
+
+    SensorBatchRadar record;
+    record.TimeOffsetUs = (int32_t)radar.sampleMicros;
+    record.DistanceMm = radar.valid ? SensorPacketCodec::toFixedU16(radar.distance, 1000.0) : 0;
+    record.Valid = radar.valid ? 1 : 0;
+    record.Reserved = 0;
+    push(SENSOR_STREAM_RADAR, radar.sampleMicros, &record);
+}
+
+void TelemetryBatcher::recordRams(uint32_t sampleMicros, float centre, float left, float right) {
+    if (!_enabled) return;
+
+    SensorBatchRam record;
+    record.TimeOffsetUs = (int32_t)sampleMicros;
+    record.RamPosCenter = SensorPacketCodec::toFixed16(centre, SENSOR_SCALE_RAM);
+    record.RamPosLeft = SensorPacketCodec::toFixed16(left, SENSOR_SCALE_RAM);
+    record.RamPosRight = SensorPacketCodec::toFixed16(right, SENSOR_SCALE_RAM);
+    push(SENSOR_STREAM_RAM, sampleMicros, &record);
+}
+
+void TelemetryBatcher::recordFusion(const FusionSnapshot& fusion) {
+    if (!_enabled) return;
+
+    SensorBatchFusion record;
+    record.TimeOffsetUs = (int32_t)fusion.sampleMicros;
+    record.FusedLatitudeE9 = llround(fusion.latitude * SENSOR_SCALE_LATLON);
+    record.FusedLongitudeE9 = llround(fusion.longitude * SENSOR_SCALE_LATLON);
+    record.FusedAltitudeMm = (int32_t)lround(fusion.altitude * 1000.0);
+    record.VelocityNorth = SensorPacketCodec::toFixed16(fusion.velocityNorth, SENSOR_SCALE_VELOCITY);
+    record.VelocityEast = SensorPacketCodec::toFixed16(fusion.velocityEast, SENSOR_SCALE_VELOCITY);
+    record.VelocityDown = SensorPacketCodec::toFixed16(fusion.velocityDown, SENSOR_SCALE_VELOCITY);
+    record.Valid = fusion.valid ? 1 : 0;
+    record.Reserved = 0;
+    push(SENSOR_STREAM_FUSION, fusion.sampleMicros, &record);
+}
+
+void TelemetryBatcher::recordGnss(const GpsSnapshot& gps, uint32_t arrivalMicros) {
+    if (!_enabled) return;
+
+    // Same fields and scaling as SensorDataPacketV2
+    SensorBatchGnss record;
+    record.TimeOffsetUs = (int32_t)arrivalMicros;
+    record.LatitudeE9 = llround(gps.latitude * SENSOR_SCALE_LATLON);
+    record.LongitudeE9 = llround(gps.longitude * SENSOR_SCALE_LATLON);
+    record.AltitudeMm = gps.altitudeMm;
+    record.HorizontalAccuracyMm = SensorPacketCodec::toFixedU16(gps.horizontalAccuracy, 1000.0);
+    record.GPSTimestamp = gps.timeOfWeek;
+    float heading = gps.heading > 180.0f ? gps.heading - 360.0f : gps.heading;
+    record.GpsHeadingCdeg = SensorPacketCodec::toFixed16(heading, 100.0);
+    record.GpsSpeedCms = SensorPacketCodec::toFixedU16(gps.groundSpeed, 100.0);
+    record.Satellites = gps.satellites;
+    record.GPSFixQuality = gps.validFix ? 1 : 0;
+    record.RTKStatus = gps.rtkStatus;
+    record.Reserved = 0;
+    push(SENSOR_STREAM_GNSS, arrivalMicros, &record);
+}
+
+void TelemetryBatcher::recordCommandEcho(uint32_t commandId, uint32_t receiveMicros, uint32_t applyMicros) {
+    if (!_enabled) return;
+
+    SensorBatchCommandEcho record;
+    record.CommandId = commandId;
+    record.ReceiveOffsetUs = (int32_t)receiveMicros;
+    record.ApplyOffsetUs = (int32_t)applyMicros;
+    push(SENSOR_STREAM_COMMAND_ECHO, applyMicros, &record);
+}
+
+void TelemetryBatcher::push(SensorStreamId_t stream, uint32_t sampleMicros, const void* record) {
+    // Per-stream rate - a quarter interval of slack keeps jittered samples
+    // from being skipped a whole period
+    uint32_t interval = _intervalMicros[stream];
+    if (interval != 0 && _sampled[stream] && sampleMicros - _lastSampleMicros[stream] < interval - interval / 4) {
+        return;
+    }
+    _lastSampleMicros[stream] = sampleMicros;
+    _sampled[stream] = true;
+
+    Queue& queue = _queues[stream];
+    noInterrupts();
+    uint8_t slot = 0;
+    if (queue.capacity == 1) {
+        queue.count = 1;
+        _changed[stream] = true;
+    } else {
+        if (queue.count == queue.capacity) {
+            // Oldest sample gives way - the send tick fell behind
+            queue.head = (uint8_t)((queue.head + 1) % queue.capacity);
+            queue.count = queue.count - 1;
+            _samplesDropped = _samplesDropped + 1;
+        }
+        slot = (uint8_t)((queue.head + queue.count) % queue.capacity);
+        queue.count = queue.count + 1;
+    }
+    memcpy(queue.records + slot * queue.recordSize, record, queue.recordSize);
+    interrupts();
+}
+
+size_t TelemetryBatcher::takeSection(SensorStreamId_t stream, uint32_t nowMicros, uint8_t* out) {
+    Queue& queue = _queues[stream];
+    uint8_t* records = out + sizeof(SensorBatchSection);
+    uint8_t count = 0;
+
+    noInterrupts();
+    if (queue.capacity == 1) {
+        if (queue.count > 0 && (_changed[stream] || nowMicros - _lastSentMicros[stream] >= TELEMETRY_SLOW_REPEAT_US)) {
+            memcpy(records, queue.records, queue.recordSize);
+            count = 1;
+            _changed[stream] = false;
+            _lastSentMicros[stream] = nowMicros;
+        }
+    } else {
+        while (queue.count > 0) {
+            memcpy(records + count * queue.recordSize, queue.records + queue.head * queue.recordSize, queue.recordSize);
+            queue.head = (uint8_t)((queue.head + 1) % queue.capacity);
+            queue.count = queue.count - 1;
+            count++;
+        }
+    }
+    interrupts();
+
+    if (count == 0) return 0;
+
+    // Absolute sample times to offsets from the batch reference
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t* record = records + i * queue.recordSize;
+        if (stream == SENSOR_STREAM_COMMAND_ECHO) {
+            SensorBatchCommandEcho* echo = (SensorBatchCommandEcho*)record;
+            echo->ReceiveOffsetUs = (int32_t)((uint32_t)echo->ReceiveOffsetUs - nowMicros);
+            echo->ApplyOffsetUs = (int32_t)((uint32_t)echo->ApplyOffsetUs - nowMicros);
+        } else {
+            // Every other record leads with its TimeOffsetUs
+            int32_t time;
+            memcpy(&time, record, sizeof(time));
+            time = (int32_t)((uint32_t)time - nowMicros);
+            memcpy(record, &time, sizeof(time));
+        }
+    }
+
+    SensorBatchSection* section = (SensorBatchSection*)out;
+    section->StreamId = stream;
+    section->Count = count;
+    section->RecordSize = queue.recordSize;
+    section->Reserved = 0;
+    _samplesSent[stream] += count;
+    return sizeof(SensorBatchSection) + count * queue.recordSize;
+}
+
+size_t TelemetryBatcher::build(uint8_t senderId, uint32_t sequence, uint32_t nowMicros, uint8_t* buffer, size_t capacity) {
+    if (capacity < TELEMETRY_MAX_DATAGRAM) return 0;
+
+    SensorBatchHeader* header = (SensorBatchHeader*)buffer;
+    memset(header, 0, sizeof(SensorBatchHeader));
+    header->Header.Magic = SENSOR_PACKET_MAGIC;
+    header->Header.Version = SENSOR_BATCH_VERSION;
+    header->Header.SenderId = senderId;
+    header->Header.Sequence = sequence;
+    header->Header.SampleTimeMicros = nowMicros;
+
+    uint64_t gpsTime = 0;
+    if (GpsTimeService::toGpsTime(nowMicros, &gpsTime)) {
+        header->Header.SampleGpsTimeMicros = gpsTime;
+        header->Flags |= SENSOR_FLAG_TIME_SYNCED;
+    }
+
+    size_t length = sizeof(SensorBatchHeader);
+    for (int stream = 0; stream < SENSOR_STREAM_COUNT; stream++) {
+        size_t sectionLength = takeSection((SensorStreamId_t)stream, nowMicros, buffer + length);
+        if (sectionLength > 0) {
+            length += sectionLength;
+            header->SectionCount++;
+        }
+    }
+    header->Header.PayloadLength = (uint16_t)(length - sizeof(SensorPacketHeaderV2));
+
+    uint32_t dropped = _samplesDropped - _droppedReported;
+    _droppedReported += dropped;
+    header->Dropped = dropped > 65535 ? 65535 : (uint16_t)dropped;
+
+    _datagramsBuilt++;
+    return length;
+}
@@ -0,0 +1,101 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Telemetry Batcher
+ *
+ * Builds the batched sensor datagram (SENSOR_WIRE_BATCHED, DataPackets.h):
+ * - Producers record each stream at its own rate - every IMU sample and
+ *   radar measurement by default, rams at 100Hz, fused state at 50Hz
+ * - Samples queue per stream until the next send tick packs them all,
+ *   timestamped, into one datagram
+ * - GNSS epochs and the command echo go out only when they changed, with
+ *   a slow repeat so a lost datagram does not leave the Toughbook stale
+ * - No network dependency, so the builder also runs on the host
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef TELEMETRY_BATCHER_H
+#define TELEMETRY_BATCHER_H
+
+#include <Arduino.h>
+#include "DataPackets.h"
+#include "SensorSnapshot.h"
+
+// Queue depth per stream - a few send ticks of headroom at the default rates
+#define TELEMETRY_IMU_CAPACITY      32      // 400Hz gyro-integrated rotation vector
+#define TELEMETRY_RADAR_CAPACITY    8
+#define TELEMETRY_RAM_CAPACITY      16
+#define TELEMETRY_FUSION_CAPACITY   8
+
+// Default minimum spacing between recorded samples (0 = every sample)
+#define TELEMETRY_IMU_INTERVAL_US       0
+#define TELEMETRY_RADAR_INTERVAL_US     0
+#define TELEMETRY_RAM_INTERVAL_US       10000   // 100Hz of the control tick's positions
+#define TELEMETRY_FUSION_INTERVAL_US    20000   // 50Hz
+#define TELEMETRY_GNSS_INTERVAL_US      0
+#define TELEMETRY_COMMAND_INTERVAL_US   0
+
+#define TELEMETRY_SLOW_REPEAT_US    1000000 // Unchanged GNSS / command echo resent this often
+
+// Largest datagram build() produces - every queue full at once
+#define TELEMETRY_MAX_DATAGRAM      (sizeof(SensorBatchHeader) + SENSOR_STREAM_COUNT * sizeof(SensorBatchSection) + \
+                                     TELEMETRY_IMU_CAPACITY * sizeof(SensorBatchImu) + \
+                                     TELEMETRY_RADAR_CAPACITY * sizeof(SensorBatchRadar) + \
+                                     TELEMETRY_RAM_CAPACITY * sizeof(SensorBatchRam) + \
+                                     TELEMETRY_FUSION_CAPACITY * sizeof(SensorBatchFusion) + \
+                                     sizeof(SensorBatchGnss) + sizeof(SensorBatchCommandEcho))
+
+static_assert(TELEMETRY_MAX_DATAGRAM <= 1472, "Batched sensor datagram must fit one Ethernet MTU");
+
+class TelemetryBatcher {
+public:
+    // Configuration - enabled by NetworkManager in batched wire format
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return _enabled; }
+    static void setStreamInterval(SensorStreamId_t stream, uint32_t intervalMicros);
+    static uint32_t getStreamInterval(SensorStreamId_t stream) { return _intervalMicros[stream]; }
+
+    // Producers - any context, cheap no-ops when disabled
+    static void recordImu(const ImuSnapshot& imu);
+    static void recordRadar(const RadarSnapshot& radar);
+    static void recordRams(uint32_t sampleMicros, float centre, float left, float right);
+    static void recordFusion(const FusionSnapshot& fusion);
+    static void recordGnss(const GpsSnapshot& gps, uint32_t arrivalMicros);
+    static void recordCommandEcho(uint32_t commandId, uint32_t receiveMicros, uint32_t applyMicros);
+
+    // Everything queued since the last call as one datagram; buffer must hold
+    // TELEMETRY_MAX_DATAGRAM. Returns the datagram length (0 if too small).
+    static size_t build(uint8_t senderId, uint32_t sequence, uint32_t nowMicros, uint8_t* buffer, size_t capacity);
+
+    // Statistics
+    static uint32_t getDatagramsBuilt() { return _datagramsBuilt; }
+    static uint32_t getSamplesSent(SensorStreamId_t stream) { return _samplesSent[stream]; }
+    static uint32_t getSamplesDropped() { return _samplesDropped; }
+
+private:
+    struct Queue {
+        uint8_t* records;
+        uint8_t recordSize;
+        uint8_t capacity;           // 1 = latest value only, sent on change
+        volatile uint8_t head;      // Oldest record
+        volatile uint8_t count;
+    };
+
+    static bool _enabled;
+    static Queue _queues[SENSOR_STREAM_COUNT];
+    static uint32_t _intervalMicros[SENSOR_STREAM_COUNT];
+    static uint32_t _lastSampleMicros[SENSOR_STREAM_COUNT];
+    static bool _sampled[SENSOR_STREAM_COUNT];
+    static bool _changed[SENSOR_STREAM_COUNT];             // Latest-value streams: not yet sent
+    static uint32_t _lastSentMicros[SENSOR_STREAM_COUNT];
+    static uint32_t _samplesSent[SENSOR_STREAM_COUNT];
+    static volatile uint32_t _samplesDropped;
+    static uint32_t _droppedReported;
+    static uint32_t _datagramsBuilt;
+
+    static void push(SensorStreamId_t stream, uint32_t sampleMicros, const void* record);
+    static size_t takeSection(SensorStreamId_t stream, uint32_t nowMicros, uint8_t* out);
+};
+
+#endif // TELEMETRY_BATCHER_H
@@ -0,0 +1,533 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Terrain Preview Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "TerrainPreview.h"
+#include "SensorManager.h"
+#include "HydraulicController.h"
+#include "LoopProfiler.h"
+#include <ArduinoJson.h>
+
+#define METRES_PER_DEGREE_LAT   111320.0    // Spec approximation, fine over a field
+
+// Tile heights - kept off DTCM, which the control path needs
+#ifdef TERRAIN_CACHE_IN_PSRAM
+EXTMEM static int16_t tileHeights[TERRAIN_CACHE_TILES][TERRAIN_TILE_CELLS * TERRAIN_TILE_CELLS];
+#else
+DMAMEM static int16_t tileHeights[TERRAIN_CACHE_TILES][TERRAIN_TILE_CELLS * TERRAIN_TILE_CELLS];
+#endif
+
+TerrainPreview::TerrainPreview() :
+    _state(TERRAIN_DISABLED),
+    _enabled(true),
+    _demLoaded(false),
+    _sensorManager(nullptr),
+    _hydraulicController(nullptr),
+    _metresPerDegreeLon(0.0),
+    _useClock(0),
+    _lastSlot(-1),
+    _pendingCount(0),
+    _havePosition(false),
+    _haveHeading(false),
+    _trackX(0.0f),
+    _trackY(0.0f),
+    _trackMillis(0),
+    _positionX(0.0f),
+    _positionY(0.0f),
+    _headingSin(0.0f),
+    _headingCos(1.0f),
+    _speed(0.0f),
+    _lookAheadTime(TERRAIN_DEFAULT_LOOKAHEAD_S),
+    _boomHalfWidth(TERRAIN_DEFAULT_BOOM_HALF_WIDTH_M),
+    _boomOffset(TERRAIN_DEFAULT_BOOM_OFFSET_M),
+    _centreGain(TERRAIN_DEFAULT_CENTRE_GAIN),
+    _wingGain(TERRAIN_DEFAULT_WING_GAIN),
+    _feedForwardCentre(0.0f),
+    _feedForwardLeft(0.0f),
+    _feedForwardRight(0.0f),
+    _lastUpdate(0),
+    _tileLoads(0),
+    _cacheMisses(0),
+    _loadErrors(0),
+    _maxLoadMicros(0)
+{
+    memset(&_grid, 0, sizeof(_grid));
+    memset(_slots, 0, sizeof(_slots));
+}
+
+bool TerrainPreview::initialize() {
+    if (ModuleConfig::getRole() != MODULE_CENTRE) {
+        return true; // Only the centre module drives the rams
+    }
+
+    if (!DiagnosticManager::isSDCardAvailable() || !SD.exists(TERRAIN_DEM_DIRECTORY "/metadata.json")) {
+        DiagnosticManager::logMessage(LOG_INFO, "TerrainPreview",
+            "No DEM on SD (" TERRAIN_DEM_DIRECTORY ") - terrain preview disabled");
+        return true;
+    }
+
+    if (!loadMetadata() || !openElevationFile()) {
+        return false;
+    }
+
+    _demLoaded = true;
+    setState(TERRAIN_WAITING_FIX);
+
+    DiagnosticManager::logMessage(LOG_INFO, "TerrainPreview",
+        "DEM " + String(_grid.columns) + "x" + String(_grid.rows) + " @ " + String(_grid.resolution, 2) +
+        "m, " + String(_grid.tilesX * _grid.tilesY) + " tiles, cache " + String(TERRAIN_CACHE_TILES) +
+        " x " + String(TERRAIN_TILE_CELLS) + "x" + String(TERRAIN_TILE_CELLS));
+    return true;
+}
+
+bool TerrainPreview::loadMetadata() {
+    File file = SD.open(TERRAIN_DEM_DIRECTORY "/metadata.json", FILE_READ);
+    if (!file) {
+        DiagnosticManager::logError("TerrainPreview", "Cannot open metadata.json");
+        return false;
+    }
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error) {
+        DiagnosticManager::logError("TerrainPreview", "metadata.json parse failed: " + String(error.c_str()));
+        return false;
+    }
+
+    _grid.referenceLatitude = doc["ReferenceLatitude"] | 0.0;
+    _grid.referenceLongitude = doc["ReferenceLongitude"] | 0.0;
+    _grid.resolution = doc["Resolution"] | 0.0f;
+    _grid.columns = doc["PixelsX"] | 0;
+    _grid.rows = doc["PixelsY"] | 0;
+    _grid.boundsLeft = doc["Bounds"]["Left"] | 0.0f;
+    _grid.boundsTop = doc["Bounds"]["Top"] | 0.0f;
+    float minElevation = doc["MinElevation"] | 0.0f;
+    float maxElevation = doc["MaxElevation"] | 0.0f;
+    bool compressed = doc["IsCompressed"] | false;
+
+    if (compressed) {
+        // The .RgFdem container is unzipped on the PC; a DEFLATE elevation.dem cannot be tiled
+        DiagnosticManager::logError("TerrainPreview", "Compressed DEM - extract elevation.dem uncompressed");
+        return false;
+    }
+    if (_grid.resolution <= 0.0f || _grid.columns <= 0 || _grid.rows <= 0 || maxElevation < minElevation) {
+        DiagnosticManager::logError("TerrainPreview", "metadata.json has no usable grid description");
+        return false;
+    }
+
+    // int16 cells around the mid elevation - 1mm steps unless the field spans more than 65m
+    _grid.heightBase = (minElevation + maxElevation) * 0.5f;
+    _grid.heightQuantum = max(0.001f, (maxElevation - minElevation) / 65000.0f);
+    _grid.tilesX = (_grid.columns + TERRAIN_TILE_CELLS - 1) / TERRAIN_TILE_CELLS;
+    _grid.tilesY = (_grid.rows + TERRAIN_TILE_CELLS - 1) / TERRAIN_TILE_CELLS;
+    _metresPerDegreeLon = METRES_PER_DEGREE_LAT * cos(_grid.referenceLatitude * PI / 180.0);
+
+    return true;
+}
+
+bool TerrainPreview::openElevationFile() {
+    _demFile = SD.open(TERRAIN_DEM_DIRECTORY "/elevation.dem", FILE_READ);
+    if (!_demFile) {
+        DiagnosticManager::logError("TerrainPreview", "Cannot open elevation.dem");
+        return false;
+    }
+
+    int32_t header[2];
+    if (_demFile.read((uint8_t*)header, sizeof(header)) != (int)sizeof(header) ||
+        header[0] != _grid.rows || header[1] != _grid.columns) {
+        DiagnosticManager::logError("TerrainPreview", "elevation.dem header does not match metadata.json");
+        _demFile.close();
+        return false;
+    }
+
+    uint64_t expected = TERRAIN_DEM_HEADER_SIZE + (uint64_t)_grid.rows * _grid.columns * sizeof(float);
+    if (_demFile.size() != expected) {
+        DiagnosticManager::logError("TerrainPreview",
+            "elevation.dem is " + String((uint32_t)_demFile.size()) + " bytes, expected " + String((uint32_t)expected));
+        _demFile.close();
+        return false;
+    }
+    return true;
+}
+
+void TerrainPreview::setBoomGeometry(float halfWidthMetres, float offsetMetres) {
+    _boomHalfWidth = halfWidthMetres;
+    _boomOffset = offsetMetres;
+}
+
+void TerrainPreview::setFeedForwardGains(float centrePercentPerMetre, float wingPercentPerMetre) {
+    // Sign follows the ram plumbing - negative when extending the ram lowers the boom
+    _centreGain = centrePercentPerMetre;
+    _wingGain = wingPercentPerMetre;
+}
+
+void TerrainPreview::setEnabled(bool enabled) {
+    _enabled = enabled;
+    if (!enabled) {
+        applyFeedForward(0.0f, 0.0f, 0.0f);
+        if (_demLoaded) setState(TERRAIN_WAITING_FIX);
+    }
+}
+
+void TerrainPreview::update() {
+    if (!_demLoaded || !_enabled) return;
+
+    PROFILE_SCOPE(PROBE_TERRAIN_UPDATE);
+
+    uint32_t now = millis();
+    if (now - _lastUpdate < TERRAIN_UPDATE_INTERVAL_MS) return;
+    _lastUpdate = now;
+    _useClock++;
+
+    if (!updateTrack()) {
+        applyFeedForward(0.0f, 0.0f, 0.0f);
+        setState(TERRAIN_WAITING_FIX);
+        return;
+    }
+
+    // Everything the boom will cross within the look-ahead plus a margin,
+    // nearest first so the tiles needed soonest load first
+    float boomX = _positionX + _headingSin * _boomOffset;
+    float boomY = _positionY + _headingCos * _boomOffset;
+    float lookAhead = constrain(_speed * _lookAheadTime, TERRAIN_MIN_LOOKAHEAD_M, TERRAIN_MAX_LOOKAHEAD_M);
+
+    _pendingCount = 0;
+    requestTilesAlong(boomX, boomY, lookAhead + TERRAIN_PREFETCH_MARGIN_M);
+    servicePrefetch();
+
+    if (_speed < TERRAIN_MIN_SPEED_MPS) {
+        applyFeedForward(0.0f, 0.0f, 0.0f);
+        setState(TERRAIN_WAITING_FIX);
+        return;
+    }
+
+    if (computeFeedForward()) {
+        setState(TERRAIN_ACTIVE);
+    } else {
+        applyFeedForward(0.0f, 0.0f, 0.0f);
+        setState(_pendingCount > 0 ? TERRAIN_PREFETCHING : TERRAIN_OUTSIDE_DEM);
+    }
+}
+
+bool TerrainPreview::updateTrack() {
+    if (!_sensorManager) return false;
+
+    SensorSnapshot snapshot;
+    _sensorManager->getSnapshot(&snapshot);
+    const GpsSnapshot& gps = snapshot.gps;
+
+    if (!gps.validFix || millis() - gps.updateMillis > TERRAIN_GPS_STALE_MS ||
+        gps.horizontalAccuracy > TERRAIN_MAX_ACCURACY_M) {
+        _havePosition = false;
+        _haveHeading = false;
+        return false;
+    }
+
+    float x = (float)((gps.longitude - _grid.referenceLongitude) * _metresPerDegreeLon);
+    float y = (float)((gps.latitude - _grid.referenceLatitude) * METRES_PER_DEGREE_LAT);
+
+    if (!_havePosition) {
+        _trackX = x;
+        _trackY = y;
+        _trackMillis = gps.updateMillis;
+        _havePosition = true;
+    }
+
+    // Heading over ground once the tractor has moved far enough for it to mean anything
+    float dx = x - _trackX;
+    float dy = y - _trackY;
+    float travelled = sqrtf(dx * dx + dy * dy);
+    uint32_t elapsed = gps.updateMillis - _trackMillis;
+
+    if (travelled >= TERRAIN_HEADING_MIN_TRAVEL_M && elapsed > 0) {
+        _headingSin = dx / travelled;
+        _headingCos = dy / travelled;
+        _speed = travelled * 1000.0f / elapsed;
+        _haveHeading = true;
+        _trackX = x;
+        _trackY = y;
+        _trackMillis = gps.updateMillis;
+    } else if (elapsed > 2000) {
+        _speed = 0.0f; // Standing still - keep the last heading
+    }
+
+    // Carry the position forward from the fix to now
+    float sinceFix = (millis() - gps.updateMillis) / 1000.0f;
+    _positionX = x + _headingSin * _speed * sinceFix;
+    _positionY = y + _headingCos * _speed * sinceFix;
+
+    return _haveHeading;
+}
+
+void TerrainPreview::requestTilesAlong(float x, float y, float distance) {
+    // Half-tile steps along and across the swath so no tile is skipped
+    float step = TERRAIN_TILE_CELLS * _grid.resolution * 0.5f;
+    float rightX = _headingCos;     // Unit vector to the right of the heading
+    float rightY = -_headingSin;
+
+    for (float along = 0.0f; along <= distance + step; along += step) {
+        for (float across = 0.0f; across <= _boomHalfWidth + step; across += step) {
+            for (int side = -1; side <= 1; side += 2) {
+                if (across == 0.0f && side > 0) continue;
+                float px = x + _headingSin * along + rightX * across * side;
+                float py = y + _headingCos * along + rightY * across * side;
+
+                float column = (px - _grid.boundsLeft) / _grid.resolution;
+                float row = (_grid.boundsTop - py) / _grid.resolution;
+                if (column < 0.0f || row < 0.0f || column >= _grid.columns || row >= _grid.rows) continue;
+
+                requestTile((int32_t)column / TERRAIN_TILE_CELLS, (int32_t)row / TERRAIN_TILE_CELLS);
+            }
+        }
+    }
+}
+
+void TerrainPreview::requestTile(int32_t tileX, int32_t tileY) {
+    int16_t slot = findSlot(tileX, tileY);
+    if (slot >= 0) {
+        _slots[slot].lastUsed = _useClock; // Needed soon - not an eviction candidate
+        return;
+    }
+
+    for (uint16_t i = 0; i < _pendingCount; i++) {
+        if (_pendingX[i] == tileX && _pendingY[i] == tileY) return;
+    }
+    if (_pendingCount < TERRAIN_CACHE_TILES) {
+        _pendingX[_pendingCount] = tileX;
+        _pendingY[_pendingCount] = tileY;
+        _pendingCount++;
+    }
+}
+
+void TerrainPreview::servicePrefetch() {
+    uint16_t loads = 0;
+    uint16_t next = 0;
+
+    while (next < _pendingCount && loads < TERRAIN_TILE_LOADS_PER_UPDATE) {
+        if (!loadTile(_pendingX[next], _pendingY[next])) break;
+        next++;
+        loads++;
+    }
+
+    // Drop what was loaded; the rest is requested again next update
+    for (uint16_t i = next; i < _pendingCount; i++) {
+        _pendingX[i - next] = _pendingX[i];
+        _pendingY[i - next] = _pendingY[i];
+    }
+    _pendingCount -= next;
+}
+
+bool TerrainPreview::loadTile(int32_t tileX, int32_t tileY) {
+    int16_t slot = evictSlot();
+    if (slot < 0) {
+        return false; // Every slot is in the current swath - cache too small for this boom
+    }
+
+    uint32_t start = micros();
+    float rowBuffer[TERRAIN_TILE_CELLS];
+    int16_t* heights = tileHeights[slot];
+    int32_t firstColumn = tileX * TERRAIN_TILE_CELLS;
+    int32_t columns = min((int32_t)TERRAIN_TILE_CELLS, _grid.columns - firstColumn);
+
+    _slots[slot].valid = false;
+
+    for (int32_t r = 0; r < TERRAIN_TILE_CELLS; r++) {
+        int16_t* out = heights + r * TERRAIN_TILE_CELLS;
+        int32_t row = tileY * TERRAIN_TILE_CELLS + r;
+
+        int32_t have = 0;
+        if (row < _grid.rows) {
+            uint64_t offset = TERRAIN_DEM_HEADER_SIZE + ((uint64_t)row * _grid.columns + firstColumn) * sizeof(float);
+            if (!_demFile.seek(offset) ||
+                _demFile.read((uint8_t*)rowBuffer, columns * sizeof(float)) != (int)(columns * sizeof(float))) {
+                _loadErrors++;
+                return false;
+            }
+            have = columns;
+        }
+
+        for (int32_t c = 0; c < TERRAIN_TILE_CELLS; c++) {
+            if (c >= have || isnan(rowBuffer[c])) {
+                out[c] = TERRAIN_NO_DATA;
+                continue;
+            }
+            float q = roundf((rowBuffer[c] - _grid.heightBase) / _grid.heightQuantum);
+            out[c] = (int16_t)constrain(q, (float)(INT16_MIN + 1), (float)INT16_MAX);
+        }
+    }
+
+    _slots[slot].tileX = tileX;
+    _slots[slot].tileY = tileY;
+    _slots[slot].lastUsed = _useClock;
+    _slots[slot].valid = true;
+    _tileLoads++;
+
+    uint32_t elapsed = micros() - start;
+    if (elapsed > _maxLoadMicros) _maxLoadMicros = elapsed;
+    return true;
+}
+
+int16_t TerrainPreview::findSlot(int32_t tileX, int32_t tileY) {
+    if (_lastSlot >= 0 && _slots[_lastSlot].valid &&
+        _slots[_lastSlot].tileX == tileX && _slots[_lastSlot].tileY == tileY) {
+        return _lastSlot;
+    }
+
+    for (int16_t i = 0; i < TERRAIN_CACHE_TILES; i++) {
+        if (_slots[i].valid && _slots[i].tileX == tileX && _slots[i].tileY == tileY) {
+            _lastSlot = i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+int16_t TerrainPreview::evictSlot() {
+    // Empty slot first, otherwise least recently used - never one touched this update
+    int16_t oldest = -1;
+    for (int16_t i = 0; i < TERRAIN_CACHE_TILES; i++) {
+        if (!_slots[i].valid) return i;
+        if (_slots[i].lastUsed == _useClock) continue;
+        if (oldest < 0 || (int32_t)(_slots[i].lastUsed - _slots[oldest].lastUsed) < 0) {
+            oldest = i;
+        }
+    }
+    if (oldest == _lastSlot) _lastSlot = -1;
+    return oldest;
+}
+
+int16_t TerrainPreview::cell(int32_t column, int32_t row, bool* missing) {
+    int16_t slot = findSlot(column / TERRAIN_TILE_CELLS, row / TERRAIN_TILE_CELLS);
+    if (slot < 0) {
+        *missing = true;
+        return TERRAIN_NO_DATA;
+    }
+    _slots[slot].lastUsed = _useClock;
+    return tileHeights[slot][(row % TERRAIN_TILE_CELLS) * TERRAIN_TILE_CELLS + (column % TERRAIN_TILE_CELLS)];
+}
+
+bool TerrainPreview::sampleElevation(float x, float y, float* elevation) {
+    if (!_demLoaded || !elevation) return false;
+
+    float fx = (x - _grid.boundsLeft) / _grid.resolution;
+    float fy = (_grid.boundsTop - y) / _grid.resolution;
+    if (fx < 0.0f || fy < 0.0f || fx > _grid.columns - 1 || fy > _grid.rows - 1) {
+        return false;
+    }
+
+    int32_t c0 = (int32_t)fx;
+    int32_t r0 = (int32_t)fy;
+    int32_t c1 = min(c0 + 1, _grid.columns - 1);
+    int32_t r1 = min(r0 + 1, _grid.rows - 1);
+    float tx = fx - c0;
+    float ty = fy - r0;
+
+    bool missing = false;
+    int16_t h00 = cell(c0, r0, &missing);
+    int16_t h10 = cell(c1, r0, &missing);
+    int16_t h01 = cell(c0, r1, &missing);
+    int16_t h11 = cell(c1, r1, &missing);
+    if (missing) {
+        _cacheMisses++;
+        return false;
+    }
+    if (h00 == TERRAIN_NO_DATA || h10 == TERRAIN_NO_DATA || h01 == TERRAIN_NO_DATA || h11 == TERRAIN_NO_DATA) {
+        return false;
+    }
+
+    float top = h00 + (h10 - h00) * tx;
+    float bottom = h01 + (h11 - h01) * tx;
+    *elevation = _grid.heightBase + (top + (bottom - top) * ty) * _grid.heightQuantum;
+    return true;
+}
+
+bool TerrainPreview::computeFeedForward() {
+    float lookAhead = constrain(_speed * _lookAheadTime, TERRAIN_MIN_LOOKAHEAD_M, TERRAIN_MAX_LOOKAHEAD_M);
+    float rightX = _headingCos;
+    float rightY = -_headingSin;
+
+    // Boom line now and where it will be after the look-ahead time
+    float nowX = _positionX + _headingSin * _boomOffset;
+    float nowY = _positionY + _headingCos * _boomOffset;
+    float aheadX = nowX + _headingSin * lookAhead;
+    float aheadY = nowY + _headingCos * lookAhead;
+    float wingX = rightX * _boomHalfWidth;
+    float wingY = rightY * _boomHalfWidth;
+
+    float centreNow, leftNow, rightNow, centreAhead, leftAhead, rightAhead;
+    if (!sampleElevation(nowX, nowY, &centreNow) ||
+        !sampleElevation(nowX - wingX, nowY - wingY, &leftNow) ||
+        !sampleElevation(nowX + wingX, nowY + wingY, &rightNow) ||
+        !sampleElevation(aheadX, aheadY, &centreAhead) ||
+        !sampleElevation(aheadX - wingX, aheadY - wingY, &leftAhead) ||
+        !sampleElevation(aheadX + wingX, aheadY + wingY, &rightAhead)) {
+        return false;
+    }
+
+    // Radar feedback already covers the ground under the boom - only the change
+    // between now and the look-ahead point is fed forward. Wings follow their
+    // terrain relative to the centre section, which the centre ram already lifts.
+    float centre = _centreGain * (centreAhead - centreNow);
+    float left = _wingGain * ((leftAhead - centreAhead) - (leftNow - centreNow));
+    float right = _wingGain * ((rightAhead - centreAhead) - (rightNow - centreNow));
+
+    applyFeedForward(centre, left, right);
+    return true;
+}
+
+void TerrainPreview::applyFeedForward(float centre, float left, float right) {
+    centre = constrain(centre, -TERRAIN_MAX_FEEDFORWARD_PERCENT, TERRAIN_MAX_FEEDFORWARD_PERCENT);
+    left = constrain(left, -TERRAIN_MAX_FEEDFORWARD_PERCENT, TERRAIN_MAX_FEEDFORWARD_PERCENT);
+    right = constrain(right, -TERRAIN_MAX_FEEDFORWARD_PERCENT, TERRAIN_MAX_FEEDFORWARD_PERCENT);
+
+    bool unchanged = (centre == _feedForwardCentre && left == _feedForwardLeft && right == _feedForwardRight);
+    _feedForwardCentre = centre;
+    _feedForwardLeft = left;
+    _feedForwardRight = right;
+
+    if (_hydraulicController && !unchanged) {
+        _hydraulicController->setFeedForward(centre, left, right);
+    }
+}
+
+void TerrainPreview::setState(TerrainPreviewState_t state) {
+    if (state == _state) return;
+    _state = state;
+    DIAG_LOG(LOG_DEBUG, "TerrainPreview", String("State: ") + stateToString(state));
+}
+
+String TerrainPreview::getStatusString() {
+    if (!_demLoaded) return "Terrain: no DEM";
+
+    uint16_t cached = 0;
+    for (int16_t i = 0; i < TERRAIN_CACHE_TILES; i++) {
+        if (_slots[i].valid) cached++;
+    }
+
+    String status = "Terrain: ";
+    status += stateToString(_state);
+    status += ", tiles " + String(cached) + "/" + String(TERRAIN_CACHE_TILES);
+    status += " (" + String(_tileLoads) + " loads, max " + String(_maxLoadMicros) + "us, " +
+              String(_cacheMisses) + " misses, " + String(_loadErrors) + " errors)";
+    if (_state == TERRAIN_ACTIVE) {
+        status += ", FF C:" + String(_feedForwardCentre, 1) + "% L:" + String(_feedForwardLeft, 1) +
+                  "% R:" + String(_feedForwardRight, 1) + "%";
+    }
+    return status;
+}
+
+const char* TerrainPreview::stateToString(TerrainPreviewState_t state) {
+    switch (state) {
+        case TERRAIN_DISABLED: return "DISABLED";
+        case TERRAIN_WAITING_FIX: return "WAITING_FIX";
+        case TERRAIN_OUTSIDE_DEM: return "OUTSIDE_DEM";
+        case TERRAIN_PREFETCHING: return "PREFETCHING";
+        case TERRAIN_ACTIVE: return "ACTIVE";
+        default: return "UNKNOWN";
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Terrain Preview (DEM look-ahead)
+ *
+ * Centre module only. Reads the terrain ahead of the boom from a field DEM
+ * and feeds the predicted change into HydraulicController as a setpoint
+ * feed-forward, so the rams start moving before the radar sees the ground:
+ * - elevation.dem + metadata.json, extracted from a .RgFdem onto SD
+ *   (see RgF_DEM_File_Format_Specification.md)
+ * - Tiled LRU cache in RAM; tiles around the tractor are prefetched from
+ *   SD one per update() as it moves
+ * - Bilinear lookups only ever read the cache, never SD - a sample whose
+ *   tile is not loaded yet simply drops the feed-forward
+ * - Heading and speed from the GPS track over ground
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef TERRAIN_PREVIEW_H
+#define TERRAIN_PREVIEW_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include "ModuleConfig.h"
+#include "DiagnosticManager.h"
+
+class SensorManager;
+class HydraulicController;
+
+// DEM files on SD (pre-extracted from the .RgFdem archive)
+#define TERRAIN_DEM_DIRECTORY           "/dem"
+#define TERRAIN_DEM_HEADER_SIZE         8       // int32 rows, int32 columns
+
+// Tile cache - 32x32 cells of int16 (2KB), 8m square at 0.25m resolution.
+// Define TERRAIN_CACHE_IN_PSRAM on boards with PSRAM fitted for a larger cache.
+#define TERRAIN_TILE_CELLS              32
+#ifndef TERRAIN_CACHE_TILES
+#ifdef TERRAIN_CACHE_IN_PSRAM
+#define TERRAIN_CACHE_TILES             256
+#else
+#define TERRAIN_CACHE_TILES             48
+#endif
+#endif
+#define TERRAIN_NO_DATA                 INT16_MIN
+#define TERRAIN_TILE_LOADS_PER_UPDATE   1
+
+// Look-ahead and tracking
+#define TERRAIN_UPDATE_INTERVAL_MS      20      // 50Hz feed-forward
+#define TERRAIN_DEFAULT_LOOKAHEAD_S     0.8f    // Valve + ram response time
+#define TERRAIN_MIN_LOOKAHEAD_M         0.5f
+#define TERRAIN_MAX_LOOKAHEAD_M         8.0f
+#define TERRAIN_PREFETCH_MARGIN_M       8.0f    // Load tiles this far beyond the look-ahead
+#define TERRAIN_HEADING_MIN_TRAVEL_M    0.5f    // Track needed before a new heading
+#define TERRAIN_MIN_SPEED_MPS           0.3f    // Below this no feed-forward
+#define TERRAIN_GPS_STALE_MS            500
+#define TERRAIN_MAX_ACCURACY_M          0.10f   // Needs RTK-grade position
+
+// Boom geometry and feed-forward defaults (need field calibration)
+#define TERRAIN_DEFAULT_BOOM_HALF_WIDTH_M   12.0f   // Centre to wing sample point
+#define TERRAIN_DEFAULT_BOOM_OFFSET_M       -2.0f   // Boom behind the antenna (negative)
+#define TERRAIN_DEFAULT_CENTRE_GAIN         10.0f   // Ram %/m of terrain rise
+#define TERRAIN_DEFAULT_WING_GAIN           8.0f    // Ram %/m of wing-relative rise
+#define TERRAIN_MAX_FEEDFORWARD_PERCENT     15.0f
+
+typedef enum {
+    TERRAIN_DISABLED = 0,       // Not centre module, or no DEM on SD
+    TERRAIN_WAITING_FIX = 1,    // DEM loaded, no usable GPS position/heading yet
+    TERRAIN_OUTSIDE_DEM = 2,    // Tractor (or look-ahead) off the grid
+    TERRAIN_PREFETCHING = 3,    // Needed tiles still loading
+    TERRAIN_ACTIVE = 4          // Feed-forward applied
+} TerrainPreviewState_t;
+
+// Grid description from metadata.json
+struct TerrainGrid {
+    double referenceLatitude;
+    double referenceLongitude;
+    float resolution;           // Metres per cell
+    int32_t columns;            // PixelsX
+    int32_t rows;               // PixelsY
+    float boundsLeft;           // Local X of column 0
+    float boundsTop;            // Local Y of row 0
+    float heightBase;           // Cache stores (elevation - heightBase) / heightQuantum
+    float heightQuantum;
+    int32_t tilesX;
+    int32_t tilesY;
+};
+
+class TerrainPreview {
+public:
+    TerrainPreview();
+
+    // Initialization and lifecycle
+    bool initialize();              // false only on a broken DEM - no DEM is not an error
+    void update();
+    bool isActive() { return _state == TERRAIN_ACTIVE; }
+    TerrainPreviewState_t getState() { return _state; }
+
+    // Components
+    void setSensorManager(SensorManager* sensorManager) { _sensorManager = sensorManager; }
+    void setHydraulicController(HydraulicController* controller) { _hydraulicController = controller; }
+
+    // Configuration
+    void setLookAheadTime(float seconds) { _lookAheadTime = seconds; }
+    void setBoomGeometry(float halfWidthMetres, float offsetMetres);
+    void setFeedForwardGains(float centrePercentPerMetre, float wingPercentPerMetre);
+    void setEnabled(bool enabled);
+
+    // Lookup - bilinear elevation at a local grid position, from cache only
+    bool sampleElevation(float x, float y, float* elevation);
+
+    // Status and statistics
+    float getCentreFeedForward() { return _feedForwardCentre; }
+    uint32_t getTileLoads() { return _tileLoads; }
+    uint32_t getCacheMisses() { return _cacheMisses; }
+    uint32_t getMaxLoadMicros() { return _maxLoadMicros; }
+    String getStatusString();
+
+private:
+    struct TileSlot {
+        int16_t tileX;
+        int16_t tileY;
+        uint32_t lastUsed;      // _useClock at last lookup or prefetch
+        bool valid;
+    };
+
+    TerrainPreviewState_t _state;
+    bool _enabled;
+    bool _demLoaded;
+    SensorManager* _sensorManager;
+    HydraulicController* _hydraulicController;
+
+    // DEM
+    TerrainGrid _grid;
+    File _demFile;
+    double _metresPerDegreeLon;
+
+    // Cache
+    TileSlot _slots[TERRAIN_CACHE_TILES];
+    uint32_t _useClock;
+    int16_t _lastSlot;              // Most recent hit - consecutive samples share tiles
+    int32_t _pendingX[TERRAIN_CACHE_TILES];
+    int32_t _pendingY[TERRAIN_CACHE_TILES];
+    uint16_t _pendingCount;
+
+    // Track
+    bool _havePosition;
+    bool _haveHeading;
+    float _trackX;                  // Position the heading was last measured from
+    float _trackY;
+    uint32_t _trackMillis;
+    float _positionX;
+    float _positionY;
+    float _headingSin;              // Unit heading, east/north components
+    float _headingCos;
+    float _speed;
+
+    // Configuration
+    float _lookAheadTime;
+    float _boomHalfWidth;
+    float _boomOffset;
+    float _centreGain;
+    float _wingGain;
+
+    // Output
+    float _feedForwardCentre;
+    float _feedForwardLeft;
+    float _feedForwardRight;
+
+    // Timing and statistics
+    uint32_t _lastUpdate;
+    uint32_t _tileLoads;
+    uint32_t _cacheMisses;
+    uint32_t _loadErrors;
+    uint32_t _maxLoadMicros;
+
+    // Internal methods
+    bool loadMetadata();
+    bool openElevationFile();
+    bool updateTrack();
+    void requestTilesAlong(float x, float y, float distance);
+    void requestTile(int32_t tileX, int32_t tileY);
+    void servicePrefetch();
+    bool loadTile(int32_t tileX, int32_t tileY);
+    int16_t findSlot(int32_t tileX, int32_t tileY);
+    int16_t evictSlot();
+    int16_t cell(int32_t column, int32_t row, bool* missing);
+    bool computeFeedForward();
+    void applyFeedForward(float centre, float left, float right);
+    void setState(TerrainPreviewState_t state);
+    static const char* stateToString(TerrainPreviewState_t state);
+};
+
+#endif // TERRAIN_PREVIEW_H
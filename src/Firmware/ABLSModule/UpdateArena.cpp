@@ -0,0 +1,59 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Update Arena Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "UpdateArena.h"
+#include "DiagnosticManager.h"
+
+#ifdef UPDATE_ARENA_IN_EXTMEM
+EXTMEM static uint8_t arena[UPDATE_ARENA_SIZE] __attribute__((aligned(32)));
+#else
+DMAMEM static uint8_t arena[UPDATE_ARENA_SIZE] __attribute__((aligned(32)));
+#endif
+
+// Static member initialization
+UpdateArenaUse_t UpdateArena::_owner = UPDATE_ARENA_FREE;
+size_t UpdateArena::_highWater = 0;
+uint32_t UpdateArena::_conflicts = 0;
+
+uint8_t* UpdateArena::acquire(UpdateArenaUse_t use, size_t size) {
+    if (use == UPDATE_ARENA_FREE) return nullptr;
+
+    if (size > UPDATE_ARENA_SIZE) {
+        _conflicts++;
+        DiagnosticManager::logError("UpdateArena", String(useToString(use)) + " needs " + String((uint32_t)size) +
+            " bytes, arena is " + String((uint32_t)UPDATE_ARENA_SIZE));
+        return nullptr;
+    }
+
+    if (_owner != UPDATE_ARENA_FREE && _owner != use) {
+        _conflicts++;
+        DiagnosticManager::logError("UpdateArena", String(useToString(use)) + " refused - arena held by " +
+            useToString(_owner));
+        return nullptr;
+    }
+
+    _owner = use;
+    if (size > _highWater) _highWater = size;
+    return arena;
+}
+
+void UpdateArena::release(UpdateArenaUse_t use) {
+    if (_owner == use) _owner = UPDATE_ARENA_FREE;
+}
+
+const char* UpdateArena::useToString(UpdateArenaUse_t use) {
+    switch (use) {
+        case UPDATE_ARENA_FREE:     return "free";
+        case UPDATE_ARENA_DOWNLOAD: return "download";
+        case UPDATE_ARENA_MULTICAST: return "multicast";
+        case UPDATE_ARENA_FLASH:    return "flash";
+        case UPDATE_ARENA_BACKUP:   return "backup";
+        case UPDATE_ARENA_RESTORE:  return "restore";
+        default:                    return "unknown";
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Update Arena
+ *
+ * The one RAM reservation used by the firmware update and backup paths:
+ * - Statically placed in OCRAM (DMAMEM), or PSRAM with
+ *   -DUPDATE_ARENA_IN_EXTMEM on boards that have it fitted - never heap,
+ *   so getFreeMemory() does not move with an update
+ * - One owner at a time, each use holding it only for its own phase:
+ *   one flash sector for a streamed download, the multicast FEC workspace,
+ *   the flash copy, a backup (sector plus manifest) or a restore
+ * - A use that finds the arena taken gets nullptr and fails its operation
+ *   cleanly rather than allocating a second buffer
+ * - OCRAM is reachable by the DCP, so streamed sectors hash without a bounce
+ *   copy
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef UPDATE_ARENA_H
+#define UPDATE_ARENA_H
+
+#include <Arduino.h>
+
+#define UPDATE_ARENA_SECTOR_SIZE    4096    // One flash sector (FLASH_SECTOR_SIZE)
+#define UPDATE_ARENA_SIZE           (2 * UPDATE_ARENA_SECTOR_SIZE)  // Backup: sector copy plus manifest
+
+typedef enum {
+    UPDATE_ARENA_FREE = 0,
+    UPDATE_ARENA_DOWNLOAD,      // RgFModuleUpdater: sector staged while streaming, until the image is committed
+    UPDATE_ARENA_MULTICAST,     // FirmwareMulticastReceiver: block bitmaps and parity rebuild, announce to complete
+    UPDATE_ARENA_FLASH,         // RgFModuleUpdater: flash buffer to running image copy
+    UPDATE_ARENA_BACKUP,        // FlashBackupManager: sector copy and manifest working copy
+    UPDATE_ARENA_RESTORE        // FlashBackupManager: backup bank to running image copy
+} UpdateArenaUse_t;
+
+class UpdateArena {
+public:
+    // Whole arena for one use - nullptr if another use holds it or size does
+    // not fit. Acquiring again for the current owner returns the same block.
+    static uint8_t* acquire(UpdateArenaUse_t use, size_t size);
+    static void release(UpdateArenaUse_t use);     // No-op unless use is the owner
+
+    static UpdateArenaUse_t getOwner() { return _owner; }
+    static size_t getCapacity() { return UPDATE_ARENA_SIZE; }
+    static size_t getHighWater() { return _highWater; }         // Largest request granted
+    static uint32_t getConflicts() { return _conflicts; }       // Requests refused
+    static const char* useToString(UpdateArenaUse_t use);
+
+private:
+    static UpdateArenaUse_t _owner;
+    static size_t _highWater;
+    static uint32_t _conflicts;
+};
+
+#endif // UPDATE_ARENA_H
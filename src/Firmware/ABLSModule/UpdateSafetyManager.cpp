@@ -24,6 +24,7 @@ float UpdateSafetyManager::_minimumVoltage = 11.5f;           // 11.5V minimum
 uint32_t UpdateSafetyManager::_safetyCheckInterval = 1000;    // 1 second
 
 // Safety monitoring state
+SensorManager* UpdateSafetyManager::_sensorManager = nullptr;
 unsigned long UpdateSafetyManager::_lastMotionTime = 0;
 unsigned long UpdateSafetyManager::_lastHydraulicActivity = 0;
 unsigned long UpdateSafetyManager::_lastSafetyCheck = 0;
@@ -46,6 +47,10 @@ void UpdateSafetyManager::init() {
     DiagnosticManager::logMessage(LOG_INFO, "UpdateSafetyManager", "  Minimum voltage: " + String(_minimumVoltage) + " V");
 }
 
+void UpdateSafetyManager::setSensorManager(SensorManager* sensorManager) {
+    _sensorManager = sensorManager;
+}
+
 void UpdateSafetyManager::update() {
     unsigned long now = millis();
     
@@ -85,12 +90,7 @@ SafetyCheckResult_t UpdateSafetyManager::isSafeToUpdate() {
         return _lastSafetyResult;
     }
     
-    // Check if GPS data is valid
-    if (!isGPSDataValid()) {
-        _lastSafetyResult = SAFETY_GPS_UNAVAILABLE;
-        logSafetyCheckResult(_lastSafetyResult);
-        return _lastSafetyResult;
-    }
+    // No GPS requirement - updates are often run in a shed with no sky view
     
     // Check if power is sufficient
     if (!isPowerSufficient()) {
@@ -111,9 +111,10 @@ SafetyCheckResult_t UpdateSafetyManager::isSafeToUpdate() {
 }
 
 bool UpdateSafetyManager::isSystemStationary() {
-    // Get current GPS speed
+    // Without a live fix the speed is unknown - an update still goes ahead,
+    // but a fix that shows the machine moving refuses it
     if (!checkGPSSpeed()) {
-        return false;
+        return true;
     }
     
     // Check if speed is below threshold
@@ -127,6 +128,19 @@ bool UpdateSafetyManager::isSystemStationary() {
     return isStationary;
 }
 
+bool UpdateSafetyManager::isConfirmedStationary() {
+    // Fails closed - no fix or a stale epoch is never taken as standing still
+    if (!checkGPSSpeed()) {
+        return false;
+    }
+    
+    bool isStationary = (_currentSpeed <= _stationarySpeedThreshold);
+    if (!isStationary) {
+        _lastMotionTime = millis();
+    }
+    return isStationary;
+}
+
 bool UpdateSafetyManager::areHydraulicsIdle() {
     // Only check hydraulics on Centre module
     if (ModuleConfig::getRole() != MODULE_CENTRE) {
@@ -268,22 +282,20 @@ void UpdateSafetyManager::logSafetyEvent(const String& event) {
 
 // Private helper functions
 bool UpdateSafetyManager::checkGPSSpeed() {
-    // Get GPS speed from SensorManager
-    // Note: SensorManager doesn't currently expose ground speed directly
-    // For now, we'll use a conservative approach and assume stationary
-    
-    // TODO: Enhance SensorManager to provide ground speed calculation
-    // This could be calculated from consecutive GPS position updates
-    // or added as a direct method to access GPS velocity data
-    
-    _currentSpeed = 0.0f; // Conservative assumption - stationary
-    
-    // In a full implementation, this would:
-    // 1. Access GPS velocity data from SensorManager
-    // 2. Calculate ground speed from velocity components
-    // 3. Apply smoothing/filtering for stability
+    // Ground speed from the latest NAV-PVT epoch. Fails closed - no sensor
+    // manager, no fix or a stale epoch means the speed is unknown, and an
+    // unknown speed is never taken as stationary.
+    if (!_sensorManager) return false;
+    
+    SensorSnapshot snapshot;
+    _sensorManager->getSnapshot(&snapshot);
+    if (!snapshot.gps.validFix || snapshot.gps.updateMillis == 0 ||
+        millis() - snapshot.gps.updateMillis > UPDATE_SAFETY_GPS_STALE_MS) {
+        return false;
+    }
     
-    return true; // GPS data available (SensorManager handles GPS status)
+    _currentSpeed = snapshot.gps.groundSpeed;
+    return true;
 }
 
 bool UpdateSafetyManager::checkHydraulicStatus() {
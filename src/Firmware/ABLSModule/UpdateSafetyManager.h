@@ -18,6 +18,9 @@
 #include "HydraulicController.h"
 #include "DiagnosticManager.h"
 
+// GNSS epoch older than this counts as no speed - the machine may be moving
+#define UPDATE_SAFETY_GPS_STALE_MS  1000
+
 // Safety check result codes
 typedef enum {
     SAFETY_OK = 0,                    // Safe to proceed with update
@@ -43,10 +46,12 @@ public:
     // Initialization and configuration
     static void init();
     static void update();
+    static void setSensorManager(SensorManager* sensorManager);   // GNSS ground speed source
     
     // Primary safety check functions
     static SafetyCheckResult_t isSafeToUpdate();
-    static bool isSystemStationary();
+    static bool isSystemStationary();       // Updates: refused only on a live fix showing movement
+    static bool isConfirmedStationary();    // Autotune: needs a live fix at standstill
     static bool areHydraulicsIdle();
     static bool isGPSDataValid();
     static bool isPowerSufficient();
@@ -84,6 +89,7 @@ private:
     static uint32_t _safetyCheckInterval;        // ms - how often to check safety during update
     
     // Safety monitoring state
+    static SensorManager* _sensorManager;        // NAV-PVT ground speed and fix
     static unsigned long _lastMotionTime;        // Last time system was moving
     static unsigned long _lastHydraulicActivity; // Last hydraulic activity
     static unsigned long _lastSafetyCheck;       // Last safety check timestamp
@@ -0,0 +1,92 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Benchmark
+ *
+ * Runs the firmware Benchmark suite natively against the HostHal mocks,
+ * for trend tracking in CI:
+ * - Same cases and JSON-lines output as RUN_BENCHMARK on the module
+ * - "cycles" are host nanoseconds (cpu_hz 1000000000 in the header), so
+ *   compare host results with host results only
+ * - Exit status is non-zero if the suite could not run
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "HostHal.h"
+#include "HostDevices.h"
+#include "Benchmark.h"
+#include "SensorManager.h"
+#include "HydraulicController.h"
+#include "DiagnosticManager.h"
+#include "FirmwareHash.h"
+#include "LoopProfiler.h"
+#include "ModuleConfig.h"
+#include <string>
+#include <sys/stat.h>
+
+namespace {
+
+SensorManager sensorManager;
+HydraulicController hydraulicController;
+
+void writeLine(const char* line, size_t len, void* context) {
+    fwrite(line, 1, len, (FILE*)context);
+    fputc('\n', (FILE*)context);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ModuleRole_t role = MODULE_CENTRE;
+    std::string outPath;
+    std::string sdRoot = "sim-sd";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--role" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "left") role = MODULE_LEFT;
+            else if (name == "right") role = MODULE_RIGHT;
+            else role = MODULE_CENTRE;
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--sd" && i + 1 < argc) {
+            sdRoot = argv[++i];
+        } else if (arg == "--no-sd") {
+            sdRoot.clear();
+        } else {
+            printf("Usage: %s [--role centre|left|right] [--out FILE] [--sd DIR | --no-sd]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (!sdRoot.empty()) mkdir(sdRoot.c_str(), 0755);
+    HostHal::setSdRoot(sdRoot);
+    HostDevices::reset();
+    for (int i = 0; i < NUM_CONFIG_PINS; i++) {
+        HostHal::setInput(CONFIG_PINS[i], (i == (int)role) ? LOW : HIGH);
+    }
+
+    // ABLSModule.ino setup() order for the parts the suite touches
+    DiagnosticManager::initialize();
+    LoopProfiler::initialize();
+    ModuleConfig::detectRole();
+    FirmwareHash::initialize();
+    hydraulicController.initialize();
+    sensorManager.initialize();
+
+    FILE* out = stdout;
+    if (!outPath.empty()) {
+        out = fopen(outPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot write %s\n", outPath.c_str());
+            return 2;
+        }
+    }
+
+    int cases = Benchmark::run(&sensorManager, &hydraulicController, &writeLine, out);
+    DiagnosticManager::flushLog();
+    if (out != stdout) fclose(out);
+    return cases > 0 ? 0 : 1;
+}
@@ -0,0 +1,508 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator
+ *
+ * Runs the module firmware - SensorManager, HydraulicController, the dead
+ * reckoning filter, RTCM framing, logging and the flight recorder - on a
+ * PC against the HostHal mocks, as fast as the host allows:
+ * - setup() order and the loop() calls of ABLSModule.ino, without the
+ *   network and OTA stack; terrain preview on a scenario DEM (--terrain)
+ * - Inputs from a synthetic scenario or a black-box recording
+ * - Rams on the plant model (closed loop) or from recorded ADC counts
+ * - Reports tracking, per-probe CPU cost in host time, and source checks;
+ *   exits non-zero when a check fails, for scripted regression runs
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "HostHal.h"
+#include "HostDevices.h"
+#include "PlantModel.h"
+#include "Scenario.h"
+#include "ReplaySource.h"
+#include "TrackingMetrics.h"
+#include "SensorManager.h"
+#include "HydraulicController.h"
+#include "DiagnosticManager.h"
+#include "FlightRecorder.h"
+#include "LoopProfiler.h"
+#include "ModuleConfig.h"
+#include "StartupSequencer.h"
+#include "TelemetryBatcher.h"
+#include "UpdateSafetyManager.h"
+#include "TerrainPreview.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#define SIM_DEFAULT_LOOP_US     1000    // loop() pass period on the virtual clock
+#define SIM_CSV_PERIOD_US       10000
+#define SIM_SETTLE_US           1000000 // Tracking metrics ignore the first second
+#define SIM_TELEMETRY_PERIOD_US 20000   // Sensor send tick (SENSOR_SEND_PERIOD_US)
+
+namespace {
+
+struct SimOptions {
+    ModuleRole_t role = MODULE_UNKNOWN;
+    std::string replayPath;
+    bool plant = false;             // Replay only - scenarios always use the plant
+    ScenarioConfig scenario;
+    bool lawSet = false;
+    ControlLaw_t law = CONTROL_LAW_PROFILED;
+    uint16_t rateHz = 0;
+    bool imuModeSet = false;
+    ImuAcquisitionMode_t imuMode = IMU_DEFAULT_ACQUISITION_MODE;
+    bool radarModeSet = false;
+    RadarMode_t radarMode = RADAR_DEFAULT_MODE;
+    bool telemetry = false;         // Build batched sensor datagrams on the send tick
+    bool gainsSet = false;
+    double kp = 2.0, ki = 0.5, kd = 0.1;
+    uint8_t autotuneMask = 0;       // Rams to autotune once operational
+    uint16_t autotuneSettlingMs = 0;
+    AutotuneResult_t autotuneExpect = AUTOTUNE_RESULT_OK;   // Every report must carry this result
+    int32_t pwmTolerance = -1;
+    std::string csvPath;
+    std::string sdRoot = "sim-sd";
+    uint32_t loopMicros = SIM_DEFAULT_LOOP_US;
+    uint32_t seed = 1;
+    bool verbose = false;
+};
+
+// Firmware objects, as ABLSModule.ino declares them
+SensorManager sensorManager;
+HydraulicController hydraulicController;
+TerrainPreview terrainPreview;
+
+void printUsage(const char* program) {
+    printf("Usage: %s [options]\n"
+           "  --role centre|left|right   Module role (DIP switch); default centre, or the recording's\n"
+           "  --replay FILE              Replay a black-box recording (bb_NNN.bin)\n"
+           "  --plant                    Replay closed loop on the plant model\n"
+           "  --duration SECONDS         Scenario length (default 30)\n"
+           "  --profile steps|sine|hold  Scenario setpoint profile\n"
+           "  --amplitude PERCENT        Scenario setpoint swing about mid stroke\n"
+           "  --speed M/S                Scenario ground speed\n"
+           "  --radar-dropout FRACTION   Scenario radar measurements with no peak\n"
+           "  --rtcm-corrupt FRACTION    Scenario RTCM frames with a bad CRC\n"
+           "  --terrain                  Scenario DEM on SD; check the terrain preview against it (centre)\n"
+           "  --law legacy|profiled      Control law\n"
+           "  --rate HZ                  Control tick rate\n"
+           "  --imu polled|interrupt|batched  IMU acquisition mode\n"
+           "  --radar strongest|tracking      Radar distance selection\n"
+           "  --telemetry                Build a batched sensor datagram every send tick and report it\n"
+           "  --kp/--ki/--kd VALUE       PID gains for all three rams\n"
+           "  --autotune MASK            Autotune these rams (bit 0 centre, 1 left, 2 right) once operational\n"
+           "  --settling MS              Autotune target settling time (default 0 = fastest)\n"
+           "  --autotune-expect ok|moving|safety-trip  Result every autotune report must carry\n"
+           "  --tolerance COUNTS         Replay: fail if valve PWM differs by more than this\n"
+           "  --csv FILE                 Write setpoints, positions and PWM every 10ms\n"
+           "  --sd DIR | --no-sd         SD card directory (default sim-sd)\n"
+           "  --loop-us MICROS           loop() period (default %d)\n"
+           "  --seed N                   Noise seed\n"
+           "  --verbose                  Echo the firmware's Serial output\n",
+           program, SIM_DEFAULT_LOOP_US);
+}
+
+bool parseRole(const std::string& name, ModuleRole_t* role) {
+    if (name == "centre" || name == "center") *role = MODULE_CENTRE;
+    else if (name == "left") *role = MODULE_LEFT;
+    else if (name == "right") *role = MODULE_RIGHT;
+    else return false;
+    return true;
+}
+
+bool parseOptions(int argc, char** argv, SimOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        std::string value = hasValue ? argv[i + 1] : "";
+
+        if (arg == "--help" || arg == "-h") return false;
+        else if (arg == "--plant") options->plant = true;
+        else if (arg == "--no-sd") options->sdRoot.clear();
+        else if (arg == "--verbose") options->verbose = true;
+        else if (arg == "--telemetry") options->telemetry = true;
+        else if (arg == "--terrain") options->scenario.terrain = true;
+        else if (!hasValue) { fprintf(stderr, "%s: unknown option or missing value\n", arg.c_str()); return false; }
+        else {
+            i++;
+            if (arg == "--role") {
+                if (!parseRole(value, &options->role)) { fprintf(stderr, "Unknown role %s\n", value.c_str()); return false; }
+            } else if (arg == "--replay") options->replayPath = value;
+            else if (arg == "--duration") options->scenario.durationMs = (uint32_t)(atof(value.c_str()) * 1000.0);
+            else if (arg == "--profile") {
+                if (value == "steps") options->scenario.profile = SCENARIO_PROFILE_STEPS;
+                else if (value == "sine") options->scenario.profile = SCENARIO_PROFILE_SINE;
+                else if (value == "hold") options->scenario.profile = SCENARIO_PROFILE_HOLD;
+                else { fprintf(stderr, "Unknown profile %s\n", value.c_str()); return false; }
+            }
+            else if (arg == "--amplitude") options->scenario.stepAmplitude = (float)atof(value.c_str());
+            else if (arg == "--speed") options->scenario.speedMps = (float)atof(value.c_str());
+            else if (arg == "--radar-dropout") options->scenario.radarDropout = (float)atof(value.c_str());
+            else if (arg == "--rtcm-corrupt") options->scenario.rtcmCorruption = (float)atof(value.c_str());
+            else if (arg == "--law") {
+                options->lawSet = true;
+                if (value == "legacy") options->law = CONTROL_LAW_LEGACY;
+                else if (value == "profiled") options->law = CONTROL_LAW_PROFILED;
+                else { fprintf(stderr, "Unknown control law %s\n", value.c_str()); return false; }
+            }
+            else if (arg == "--rate") options->rateHz = (uint16_t)atoi(value.c_str());
+            else if (arg == "--imu") {
+                options->imuModeSet = true;
+                if (value == "polled") options->imuMode = IMU_ACQ_POLLED;
+                else if (value == "interrupt") options->imuMode = IMU_ACQ_INTERRUPT;
+                else if (value == "batched") options->imuMode = IMU_ACQ_BATCHED;
+                else { fprintf(stderr, "Unknown IMU mode %s\n", value.c_str()); return false; }
+            }
+            else if (arg == "--radar") {
+                options->radarModeSet = true;
+                if (value == "strongest") options->radarMode = RADAR_MODE_STRONGEST;
+                else if (value == "tracking") options->radarMode = RADAR_MODE_TRACKING;
+                else { fprintf(stderr, "Unknown radar mode %s\n", value.c_str()); return false; }
+            }
+            else if (arg == "--kp") { options->kp = atof(value.c_str()); options->gainsSet = true; }
+            else if (arg == "--ki") { options->ki = atof(value.c_str()); options->gainsSet = true; }
+            else if (arg == "--kd") { options->kd = atof(value.c_str()); options->gainsSet = true; }
+            else if (arg == "--autotune") options->autotuneMask = (uint8_t)strtoul(value.c_str(), nullptr, 0);
+            else if (arg == "--settling") options->autotuneSettlingMs = (uint16_t)atoi(value.c_str());
+            else if (arg == "--autotune-expect") {
+                if (value == "ok") options->autotuneExpect = AUTOTUNE_RESULT_OK;
+                else if (value == "moving") options->autotuneExpect = AUTOTUNE_RESULT_MOVING;
+                else if (value == "safety-trip") options->autotuneExpect = AUTOTUNE_RESULT_SAFETY_TRIP;
+                else { fprintf(stderr, "Unknown autotune result %s\n", value.c_str()); return false; }
+            }
+            else if (arg == "--tolerance") options->pwmTolerance = atoi(value.c_str());
+            else if (arg == "--csv") options->csvPath = value;
+            else if (arg == "--sd") options->sdRoot = value;
+            else if (arg == "--loop-us") options->loopMicros = (uint32_t)std::max(1, atoi(value.c_str()));
+            else if (arg == "--seed") options->seed = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+            else { fprintf(stderr, "Unknown option %s\n", arg.c_str()); return false; }
+        }
+    }
+    return true;
+}
+
+void setDipSwitch(ModuleRole_t role) {
+    // One position closed to ground, the rest pulled up
+    for (int i = 0; i < NUM_CONFIG_PINS; i++) {
+        HostHal::setInput(CONFIG_PINS[i], (i == (int)role) ? LOW : HIGH);
+    }
+}
+
+bool setup(const SimOptions& options) {
+    // ABLSModule.ino setup(), minus the network and OTA
+    DiagnosticManager::initialize();
+    LoopProfiler::initialize();
+    ModuleConfig::detectRole();
+    DiagnosticManager::logRoleDetection(ModuleConfig::getRole(), ModuleConfig::isRoleDetected());
+    if (!ModuleConfig::isValidConfiguration()) {
+        fprintf(stderr, "Invalid module configuration\n");
+        return false;
+    }
+
+    if (!FlightRecorder::initialize()) {
+        printf("Flight recorder not available\n");
+    }
+
+    // Hydraulics first into the startup hold, then sensors; stages finish from loopOnce()
+    if (options.lawSet) hydraulicController.setControlLaw(options.law);
+    if (options.rateHz) hydraulicController.setControlRate(options.rateHz);
+    hydraulicController.initialize();
+    if (options.gainsSet) {
+        for (int channel = 0; channel < 3; channel++) {
+            hydraulicController.setPIDGains(channel, options.kp, options.ki, options.kd);
+        }
+    }
+
+    if (options.imuModeSet) sensorManager.setImuAcquisitionMode(options.imuMode);
+    if (options.radarModeSet) sensorManager.setRadarMode(options.radarMode);
+    TelemetryBatcher::setEnabled(options.telemetry);
+    sensorManager.initialize();
+    if (options.scenario.terrain) {
+        // Only with the scenario's DEM - a DEM left on the card by an earlier run is not read
+        if (!terrainPreview.initialize()) {
+            fprintf(stderr, "Terrain preview initialization failed\n");
+            return false;
+        }
+        terrainPreview.setSensorManager(&sensorManager);
+        terrainPreview.setHydraulicController(&hydraulicController);
+    }
+    UpdateSafetyManager::init();
+    UpdateSafetyManager::setSensorManager(&sensorManager);
+    StartupSequencer::begin(&sensorManager, nullptr, &hydraulicController);
+    return true;
+}
+
+void loopOnce() {
+    // ABLSModule.ino loop() for the subsystems the simulator builds
+    PROFILE_SCOPE(PROBE_LOOP);
+    DiagnosticManager::updateDisplay();
+    sensorManager.update();
+    hydraulicController.update();
+    terrainPreview.update();
+    UpdateSafetyManager::update();
+    StartupSequencer::update();
+    DiagnosticManager::serviceLog();
+    FlightRecorder::service();
+}
+
+void readRams(const PlantModel* plant, float positions[3], int pwm[3]) {
+    static const uint8_t valvePins[3] = { RAM_CENTER_VALVE_PIN, RAM_LEFT_VALVE_PIN, RAM_RIGHT_VALVE_PIN };
+    if (plant) {
+        for (int i = 0; i < 3; i++) positions[i] = plant->getPosition(i);
+    } else {
+        SensorDataPacket packet = {};
+        hydraulicController.populateRamPositions(&packet);
+        positions[0] = packet.RamPosCenterPercent;
+        positions[1] = packet.RamPosLeftPercent;
+        positions[2] = packet.RamPosRightPercent;
+    }
+    for (int i = 0; i < 3; i++) pwm[i] = HostHal::getPwm(valvePins[i]);
+}
+
+void printAutotuneReport(const AutotuneReportPacket& report) {
+    static const char* names[3] = { "Centre", "Left", "Right" };
+    if (report.Ram == AUTOTUNE_RAM_NONE) {
+        printf("  Request refused: %s\n", autotuneResultToString((AutotuneResult_t)report.Result));
+        return;
+    }
+    printf("  %-6s %s: Kp %.3f, Ki %.3f, Kd %.3f; Ku %.1f, Pu %ums, dead time %ums, valve gain %.4f%%/s; "
+           "rise %ums, overshoot %.1f%%, settling %ums (%u steps)%s\n",
+           report.Ram < 3 ? names[report.Ram] : "-", autotuneResultToString((AutotuneResult_t)report.Result),
+           report.Kp, report.Ki, report.Kd, report.UltimateGain, report.UltimatePeriodMs, report.DeadTimeMs,
+           report.ValveGain, report.RiseTimeMs, report.OvershootCentiPercent / 100.0, report.SettlingTimeMs,
+           report.Attempts, (report.Header.Flags & LEVELLING_FLAG_GAINS_SAVED) ? ", saved" : "");
+}
+
+void printCpuReport(double wallSeconds, double virtualSeconds) {
+    printf("\nCPU cost (host, LoopProfiler probes)      count    mean(us)     max(us)\n");
+    for (int probe = 0; probe < PROBE_COUNT; probe++) {
+        ProbeStats stats;
+        LoopProfiler::getStats((ProfileProbe_t)probe, &stats);
+        if (stats.count == 0) continue;
+        double cyclesPerMicro = F_CPU_ACTUAL / 1000000.0;
+        printf("  %-36s %9lu %11.3f %11.3f\n", LoopProfiler::probeName((ProfileProbe_t)probe),
+               (unsigned long)stats.count, stats.totalCycles / (double)stats.count / cyclesPerMicro,
+               stats.maxCycles / cyclesPerMicro);
+    }
+    for (int id = 0; id < HostHal::getTimerCount(); id++) {
+        HostTimerCost cost;
+        if (!HostHal::getTimerCost(id, &cost) || cost.count == 0) continue;
+        printf("  IntervalTimer %d callback              %9lu %11.3f %11.3f\n", id, (unsigned long)cost.count,
+               cost.totalNanos / 1000.0 / cost.count, cost.maxNanos / 1000.0);
+    }
+    printf("Simulated %.1fs in %.2fs wall (%.0fx real time)\n", virtualSeconds, wallSeconds,
+           wallSeconds > 0 ? virtualSeconds / wallSeconds : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SimOptions options;
+    if (!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    // Source first - a recording knows which module it came from
+    std::unique_ptr<SimSource> source;
+    Scenario* scenario = nullptr;
+    if (!options.replayPath.empty()) {
+        std::unique_ptr<ReplaySource> replay(new ReplaySource());
+        if (!replay->load(options.replayPath)) return 2;
+        replay->setPwmTolerance(options.pwmTolerance);
+        if (options.role == MODULE_UNKNOWN && replay->getRecordedRole() <= MODULE_RIGHT) {
+            options.role = (ModuleRole_t)replay->getRecordedRole();
+        }
+        source = std::move(replay);
+    } else {
+        scenario = new Scenario(options.scenario);
+        source.reset(scenario);
+        options.plant = true;
+    }
+    if (options.role == MODULE_UNKNOWN) options.role = MODULE_CENTRE;
+    if (options.scenario.terrain && (!scenario || options.role != MODULE_CENTRE || options.sdRoot.empty())) {
+        fprintf(stderr, "--terrain needs a scenario, the centre role and an SD card\n");
+        return 2;
+    }
+
+    if (!options.sdRoot.empty()) mkdir(options.sdRoot.c_str(), 0755);
+    HostHal::setSdRoot(options.sdRoot);
+    HostHal::setSerialEcho(options.verbose);
+    HostDevices::reset();
+    setDipSwitch(options.role);
+    if (options.scenario.terrain && !scenario->writeTerrainDem()) return 2;
+
+    PlantModel plant;
+    plant.setSeed(options.seed);
+    if (options.plant) plant.attach();
+
+    if (!setup(options)) return 2;
+
+    SimContext context;
+    context.sensors = &sensorManager;
+    context.hydraulics = &hydraulicController;
+    context.plant = options.plant ? &plant : nullptr;
+    context.terrain = options.scenario.terrain ? &terrainPreview : nullptr;
+    context.seed = options.seed;
+    context.verbose = options.verbose;
+    if (!source->begin(context)) return 2;
+
+    FILE* csv = nullptr;
+    if (!options.csvPath.empty()) {
+        csv = fopen(options.csvPath.c_str(), "w");
+        if (!csv) {
+            fprintf(stderr, "Cannot write %s\n", options.csvPath.c_str());
+            return 2;
+        }
+        fprintf(csv, "time_s,setpoint_c,setpoint_l,setpoint_r,position_c,position_l,position_r,pwm_c,pwm_l,pwm_r,radar_m,radar_valid\n");
+    }
+
+    printf("Running %s as %s, %s law at %uHz, %s\n", source->getName(), ModuleConfig::getRoleName().c_str(),
+           hydraulicController.getControlLaw() == CONTROL_LAW_LEGACY ? "legacy" : "profiled",
+           hydraulicController.getControlRate(), options.plant ? "plant model" : "recorded positions");
+
+    TrackingMetrics metrics;
+    metrics.setSettleMicros(SIM_SETTLE_US);
+    LoopProfiler::reset();      // Setup cost is not loop cost
+
+    uint64_t simStart = HostHal::now();
+    uint64_t nextCsv = simStart;
+    uint64_t nextTelemetry = simStart + SIM_TELEMETRY_PERIOD_US;
+    uint64_t telemetryBytes = 0;
+    size_t telemetryMaxBytes = 0;
+    bool autotuneStarted = false;
+    std::vector<AutotuneReportPacket> autotuneReports;
+    auto wallStart = std::chrono::steady_clock::now();
+
+    while (!source->isFinished(HostHal::now())) {
+        source->update(HostHal::now());
+        HostHal::runUntil(HostHal::now() + options.loopMicros);
+        loopOnce();
+
+        float setpoints[3], positions[3];
+        int pwm[3];
+        bool haveSetpoints = source->getSetpoints(setpoints);
+        if (options.plant) plant.advanceTo(HostHal::now());
+        readRams(options.plant ? &plant : nullptr, positions, pwm);
+        if (haveSetpoints && ModuleConfig::isCentreModule()) {
+            metrics.sample(HostHal::now(), setpoints, positions, pwm, HostHal::getPwmResolution());
+        }
+
+        // What NetworkManager does with an autotune request, and with the
+        // machine moving (or losing its fix) during the tune
+        if (options.autotuneMask && !autotuneStarted && StartupSequencer::isOperational()) {
+            autotuneStarted = true;
+            AutotuneResult_t result = UpdateSafetyManager::isConfirmedStationary() ?
+                hydraulicController.startAutotune(options.autotuneMask, options.autotuneSettlingMs) : AUTOTUNE_RESULT_MOVING;
+            if (result != AUTOTUNE_RESULT_OK) {
+                AutotuneReportPacket refusal = {};
+                refusal.Ram = AUTOTUNE_RAM_NONE;
+                refusal.Result = result;
+                autotuneReports.push_back(refusal);
+            }
+        }
+        if (hydraulicController.isAutotuneActive() && !UpdateSafetyManager::isConfirmedStationary()) {
+            hydraulicController.abortAutotune(AUTOTUNE_RESULT_MOVING);
+        }
+        AutotuneReportPacket autotuneReport;
+        while (hydraulicController.takeAutotuneReport(&autotuneReport)) autotuneReports.push_back(autotuneReport);
+
+        if (options.telemetry && HostHal::now() >= nextTelemetry) {
+            // What NetworkManager::sendSensorData() would send in batched format
+            nextTelemetry += SIM_TELEMETRY_PERIOD_US;
+            static uint8_t batch[TELEMETRY_MAX_DATAGRAM];
+            SensorDataPacket packet;
+            sensorManager.populatePacket(&packet);
+            size_t length = TelemetryBatcher::build(packet.SenderId, TelemetryBatcher::getDatagramsBuilt() + 1,
+                                                    micros(), batch, sizeof(batch));
+            telemetryBytes += length;
+            if (length > telemetryMaxBytes) telemetryMaxBytes = length;
+        }
+
+        if (csv && HostHal::now() >= nextCsv) {
+            nextCsv += SIM_CSV_PERIOD_US;
+            SensorSnapshot snapshot;
+            sensorManager.getSnapshot(&snapshot);
+            fprintf(csv, "%.4f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d,%d,%.4f,%d\n",
+                    (HostHal::now() - simStart) * 1e-6, setpoints[0], setpoints[1], setpoints[2],
+                    positions[0], positions[1], positions[2], pwm[0], pwm[1], pwm[2],
+                    snapshot.radar.distance, snapshot.radar.valid ? 1 : 0);
+        }
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    FlightRecorder::stop();
+    DiagnosticManager::flushLog();
+    if (csv) fclose(csv);
+
+    if (ModuleConfig::isCentreModule()) metrics.print();
+    bool passed = source->report();
+
+    printf("Control: %lu ticks, %lu overruns, %lu late starts, %lu commands (%lu stale), %lu ADC restarts\n",
+           (unsigned long)hydraulicController.getControlTickCount(), (unsigned long)hydraulicController.getControlOverruns(),
+           (unsigned long)hydraulicController.getControlLateStarts(), (unsigned long)hydraulicController.getCommandsProcessed(),
+           (unsigned long)hydraulicController.getCommandsRejectedStale(), (unsigned long)hydraulicController.getAdcRestarts());
+    printf("IMU: %lu samples, %lu dropped",
+           (unsigned long)sensorManager.getImuSamplesDrained(), (unsigned long)sensorManager.getImuSamplesDropped());
+    if (sensorManager.getImuAcquisitionMode() == IMU_ACQ_BATCHED) {
+        printf(", %lu reports in %lu packet reads", (unsigned long)sensorManager.getImuReportsDecoded(),
+               (unsigned long)sensorManager.getImuPacketsRead());
+    }
+    printf("\n");
+    if (sensorManager.getRadarMode() == RADAR_MODE_TRACKING) {
+        const RadarTracker& tracker = sensorManager.getRadarTracker();
+        printf("Radar tracking: ground %s, canopy depth %.0fmm, %lu outliers rejected, %lu lock losses, %lu window changes\n",
+               tracker.isGroundLocked() ? "locked" : "searching", tracker.getCanopyDepth() * 1000.0f,
+               (unsigned long)tracker.getOutlierCount(), (unsigned long)tracker.getLockLossCount(),
+               (unsigned long)sensorManager.getRadarWindowChanges());
+    }
+    if (options.telemetry && TelemetryBatcher::getDatagramsBuilt() > 0) {
+        printf("Telemetry (batched): %lu datagrams, mean %.0f bytes, max %u; samples IMU %lu, radar %lu, ram %lu, "
+               "fusion %lu, GNSS %lu, command %lu, %lu dropped\n",
+               (unsigned long)TelemetryBatcher::getDatagramsBuilt(),
+               (double)telemetryBytes / TelemetryBatcher::getDatagramsBuilt(), (unsigned)telemetryMaxBytes,
+               (unsigned long)TelemetryBatcher::getSamplesSent(SENSOR_STREAM_IMU),
+               (unsigned long)TelemetryBatcher::getSamplesSent(SENSOR_STREAM_RADAR),
+               (unsigned long)TelemetryBatcher::getSamplesSent(SENSOR_STREAM_RAM),
+               (unsigned long)TelemetryBatcher::getSamplesSent(SENSOR_STREAM_FUSION),
+               (unsigned long)TelemetryBatcher::getSamplesSent(SENSOR_STREAM_GNSS),
+               (unsigned long)TelemetryBatcher::getSamplesSent(SENSOR_STREAM_COMMAND_ECHO),
+               (unsigned long)TelemetryBatcher::getSamplesDropped());
+    }
+    if (options.autotuneMask) {
+        printf("Autotune: %u reports for %u rams%s\n", (unsigned)autotuneReports.size(),
+               (unsigned)__builtin_popcount(options.autotuneMask & 0x07),
+               hydraulicController.isAutotuneActive() ? " - still running at the end of the run" : "");
+        for (const AutotuneReportPacket& report : autotuneReports) {
+            printAutotuneReport(report);
+            if (report.Result != options.autotuneExpect) passed = false;
+        }
+        // A clean tune reports every ram; a refusal or abort at least once
+        if (options.autotuneExpect == AUTOTUNE_RESULT_OK ?
+                autotuneReports.size() != (size_t)__builtin_popcount(options.autotuneMask & 0x07) :
+                autotuneReports.empty() || hydraulicController.isAutotuneActive()) {
+            passed = false;
+        }
+    }
+    printCpuReport(wallSeconds, (HostHal::now() - simStart) * 1e-6);
+
+    // Staged startup - every stage the simulator builds must have come up
+    if (StartupSequencer::isOperational()) {
+        printf("Startup: operational at %lums (hydraulics %lums, GPS %lums, IMU %lums, radar %lums)\n",
+               (unsigned long)StartupSequencer::getOperationalMillis(),
+               (unsigned long)StartupSequencer::getStageReadyMillis(STARTUP_STAGE_HYDRAULICS),
+               (unsigned long)StartupSequencer::getStageReadyMillis(STARTUP_STAGE_GPS),
+               (unsigned long)StartupSequencer::getStageReadyMillis(STARTUP_STAGE_IMU),
+               (unsigned long)StartupSequencer::getStageReadyMillis(STARTUP_STAGE_RADAR));
+    } else {
+        printf("Startup: not operational - %s\n", StartupSequencer::getStatusString().c_str());
+        passed = false;
+    }
+
+    printf("\n%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Ram and Valve Plant Model Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "PlantModel.h"
+#include "HostHal.h"
+#include "HostDevices.h"
+#include "HydraulicController.h"
+
+PlantModel::PlantModel() : _lastMicros(0), _random(1), _noise(0.0f, 1.0f) {
+    _parameters.valveTau = PLANT_DEFAULT_VALVE_TAU_S;
+    _parameters.deadband = PLANT_DEFAULT_DEADBAND;
+    _parameters.extendRate = PLANT_DEFAULT_EXTEND_RATE;
+    _parameters.retractRate = PLANT_DEFAULT_RETRACT_RATE;
+    _parameters.adcNoise = PLANT_DEFAULT_ADC_NOISE;
+
+    for (auto& ram : _rams) {
+        ram.position = DEFAULT_POSITION_PERCENT;
+        ram.spool = 0.0f;
+        ram.command = 0.0f;
+        ram.endStopHits = 0;
+    }
+}
+
+void PlantModel::attach() {
+    _lastMicros = HostHal::now();
+    HostHal::setPwmListener([this](uint8_t pin, int value) { onPwm(pin, value); });
+    HostDevices::setAdcSource([this](uint8_t channel) { return sampleAdc(channel); });
+}
+
+void PlantModel::setParameters(const RamPlantParameters& parameters) {
+    _parameters = parameters;
+}
+
+void PlantModel::setPosition(uint8_t ram, float positionPercent) {
+    if (ram < PLANT_RAM_COUNT) _rams[ram].position = constrain(positionPercent, 0.0f, 100.0f);
+}
+
+int PlantModel::ramForValvePin(uint8_t pin) {
+    switch (pin) {
+        case RAM_CENTER_VALVE_PIN: return 0;
+        case RAM_LEFT_VALVE_PIN: return 1;
+        case RAM_RIGHT_VALVE_PIN: return 2;
+        default: return -1;
+    }
+}
+
+int PlantModel::ramForAdcChannel(uint8_t channel) {
+    switch (channel) {
+        case RAM_CENTER_ADC_CHANNEL: return 0;
+        case RAM_LEFT_ADC_CHANNEL: return 1;
+        case RAM_RIGHT_ADC_CHANNEL: return 2;
+        default: return -1;
+    }
+}
+
+void PlantModel::advanceTo(uint64_t nowMicros) {
+    while (_lastMicros < nowMicros) {
+        uint64_t stepMicros = nowMicros - _lastMicros;
+        if (stepMicros > PLANT_MAX_STEP_US) stepMicros = PLANT_MAX_STEP_US;
+        float dt = stepMicros * 1e-6f;
+        for (auto& ram : _rams) step(ram, dt);
+        _lastMicros += stepMicros;
+    }
+}
+
+void PlantModel::step(RamPlantState& ram, float dt) {
+    // Spool lag, exact for a constant demand over the step
+    float alpha = 1.0f - expf(-dt / _parameters.valveTau);
+    ram.spool += (ram.command - ram.spool) * alpha;
+
+    float opening = fabsf(ram.spool);
+    if (opening <= _parameters.deadband) return;
+    opening = (opening - _parameters.deadband) / (1.0f - _parameters.deadband);
+
+    float rate = (ram.spool > 0.0f) ? _parameters.extendRate : -_parameters.retractRate;
+    float position = ram.position + rate * opening * dt;
+    if (position < 0.0f || position > 100.0f) {
+        if (ram.position > 0.0f && ram.position < 100.0f) ram.endStopHits++;
+        position = constrain(position, 0.0f, 100.0f);
+    }
+    ram.position = position;
+}
+
+void PlantModel::onPwm(uint8_t pin, int value) {
+    int index = ramForValvePin(pin);
+    if (index < 0) return;
+
+    // Hold the old drive up to now, then switch - the write is the edge
+    advanceTo(HostHal::now());
+
+    // Legacy drive is 8-bit around 127; profiled drive is centred on half scale
+    unsigned int bits = HostHal::getPwmResolution();
+    float neutral, span;
+    if (bits <= 8) {
+        neutral = VALVE_PWM_LEGACY_NEUTRAL;
+        span = 255.0f - VALVE_PWM_LEGACY_NEUTRAL;
+    } else {
+        float full = (float)((1u << bits) - 1);
+        neutral = (float)(1u << (bits - 1));
+        span = full - neutral;
+    }
+    _rams[index].command = constrain((value - neutral) / span, -1.0f, 1.0f);
+}
+
+int16_t PlantModel::sampleAdc(uint8_t channel) {
+    int index = ramForAdcChannel(channel);
+    if (index < 0) return 0;
+
+    advanceTo(HostHal::now());
+    float counts = _rams[index].position / 100.0f * 32767.0f + _noise(_random) * _parameters.adcNoise;
+    return (int16_t)constrain(lroundf(counts), 0L, 32767L);
+}
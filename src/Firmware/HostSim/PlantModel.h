@@ -0,0 +1,97 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Ram and Valve Plant Model
+ *
+ * Three hydraulic rams behind proportional valves, close enough to the
+ * rig to compare control laws and gains:
+ * - Valve spool follows the PWM command through a first-order lag
+ * - Spool deadband around neutral, then ram speed proportional to opening
+ * - Separate extend/retract full-open speeds (annulus vs full bore)
+ * - Hard end stops at 0 and 100% of stroke
+ * - Position sensor read by the ADS1115 mock with additive noise
+ *
+ * The plant is advanced to the current virtual time on every PWM write
+ * and every ADC sample, so it is exact for piecewise-constant valve drive.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_PLANT_MODEL_H
+#define HOST_PLANT_MODEL_H
+
+#include <Arduino.h>
+#include <random>
+
+#define PLANT_RAM_COUNT                 3
+
+#ifndef PLANT_DEFAULT_VALVE_TAU_S
+#define PLANT_DEFAULT_VALVE_TAU_S       0.030f  // Spool time constant
+#endif
+
+#ifndef PLANT_DEFAULT_DEADBAND
+#define PLANT_DEFAULT_DEADBAND          0.05f   // Fraction of full opening
+#endif
+
+#ifndef PLANT_DEFAULT_EXTEND_RATE
+#define PLANT_DEFAULT_EXTEND_RATE       25.0f   // %/s at full opening
+#endif
+
+#ifndef PLANT_DEFAULT_RETRACT_RATE
+#define PLANT_DEFAULT_RETRACT_RATE      30.0f   // %/s at full opening
+#endif
+
+#ifndef PLANT_DEFAULT_ADC_NOISE
+#define PLANT_DEFAULT_ADC_NOISE         8.0f    // Counts, 1 sigma
+#endif
+
+#define PLANT_MAX_STEP_US               1000    // Integration step inside one advance
+
+struct RamPlantParameters {
+    float valveTau;         // s
+    float deadband;         // 0-1
+    float extendRate;       // %/s
+    float retractRate;      // %/s
+    float adcNoise;         // counts
+};
+
+struct RamPlantState {
+    float position;         // % of stroke
+    float spool;            // -1 (full retract) .. +1 (full extend)
+    float command;          // Spool demand from the last PWM write
+    uint32_t endStopHits;
+};
+
+class PlantModel {
+public:
+    PlantModel();
+
+    // Take over the valve PWM pins and the ADS1115 inputs
+    void attach();
+
+    void setParameters(const RamPlantParameters& parameters);
+    const RamPlantParameters& getParameters() const { return _parameters; }
+    void setPosition(uint8_t ram, float positionPercent);
+    void setSeed(uint32_t seed) { _random.seed(seed); }
+
+    void advanceTo(uint64_t nowMicros);
+    const RamPlantState& getState(uint8_t ram) const { return _rams[ram]; }
+    float getPosition(uint8_t ram) const { return _rams[ram].position; }
+
+    // Valve pin / ADC channel mapping (HydraulicController RAM_*_VALVE_PIN)
+    static int ramForValvePin(uint8_t pin);
+    static int ramForAdcChannel(uint8_t channel);
+
+private:
+    RamPlantParameters _parameters;
+    RamPlantState _rams[PLANT_RAM_COUNT];
+    uint64_t _lastMicros;
+    std::mt19937 _random;
+    std::normal_distribution<float> _noise;
+
+    void onPwm(uint8_t pin, int value);
+    int16_t sampleAdc(uint8_t channel);
+    void step(RamPlantState& ram, float dt);
+};
+
+#endif // HOST_PLANT_MODEL_H
@@ -0,0 +1,310 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Black-Box Replay Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "ReplaySource.h"
+#include "HostHal.h"
+#include "PlantModel.h"
+#include "SensorManager.h"
+#include "HydraulicController.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+ReplaySource::ReplaySource()
+    : _header(), _next(0), _baseMicros(0), _durationMicros(0), _context(), _pwmTolerance(-1),
+      _setpoints{ 50.0f, 50.0f, 50.0f }, _haveSetpoints(false), _plantSeeded(false),
+      _adcCounts{ 0, 0, 0, 0 }, _radarPeaks(), _counts(), _commandsRecordedAccepted(0), _pwm() {
+    _radarPeaks.measureDistanceError = 1;
+}
+
+bool ReplaySource::load(const std::string& path) {
+    _path = path;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (data.size() < RECORDER_HEADER_SIZE) {
+        fprintf(stderr, "%s: too short for a black-box file\n", path.c_str());
+        return false;
+    }
+    memcpy(&_header, data.data(), sizeof(_header));
+    if (memcmp(_header.Magic, RECORDER_FILE_MAGIC, sizeof(_header.Magic)) != 0 ||
+        _header.RecordSize != RECORDER_RECORD_SIZE) {
+        fprintf(stderr, "%s: not a version %d black-box file\n", path.c_str(), RECORDER_FILE_VERSION);
+        return false;
+    }
+
+    // Same ordering rules as the Toughbook's BlackBoxReader
+    uint64_t available = std::min<uint64_t>(std::min(_header.DataBytes, _header.DataCapacity),
+                                            data.size() - _header.HeaderSize);
+    uint64_t start = (_header.DataBytes > _header.DataCapacity) ? _header.RingOffset : 0;
+
+    _records.clear();
+    bool first = true;
+    uint32_t previousStamp = 0;
+    int64_t stamp = 0, earliest = 0;
+    for (uint64_t done = 0; done + RECORDER_RECORD_SIZE <= available; done += RECORDER_RECORD_SIZE) {
+        uint64_t offset = _header.HeaderSize + (start + done) % _header.DataCapacity;
+        ReplayRecord entry;
+        memcpy(&entry.record, &data[offset], RECORDER_RECORD_SIZE);
+        if (entry.record.Type == RECORD_EMPTY || entry.record.Type > RECORD_TRIGGER) continue;
+
+        // Unwrap micros() - producers in ISRs can land slightly out of order
+        if (first) {
+            first = false;
+        } else {
+            stamp += (int32_t)(entry.record.TimestampMicros - previousStamp);
+        }
+        previousStamp = entry.record.TimestampMicros;
+        earliest = std::min(earliest, stamp);
+        entry.offsetMicros = (uint64_t)stamp;
+        _records.push_back(entry);
+    }
+    for (auto& entry : _records) entry.offsetMicros -= (uint64_t)earliest;
+    std::stable_sort(_records.begin(), _records.end(),
+                     [](const ReplayRecord& a, const ReplayRecord& b) { return a.offsetMicros < b.offsetMicros; });
+
+    _durationMicros = _records.empty() ? 0 : _records.back().offsetMicros;
+    printf("Replay %s: %zu records over %.1fs, role %u, %s%s\n", path.c_str(), _records.size(),
+           _durationMicros * 1e-6, _header.ModuleRole,
+           _header.Mode == RECORDER_TRIGGERED ? "triggered" : "continuous",
+           _header.Complete ? "" : " (not closed cleanly)");
+    return !_records.empty();
+}
+
+bool ReplaySource::begin(SimContext& context) {
+    _context = context;
+    _baseMicros = HostHal::now() + REPLAY_START_DELAY_US;
+    _next = 0;
+
+    // Position feedback starts where the recording does
+    for (const auto& entry : _records) {
+        if (entry.record.Type != RECORD_RAM || entry.record.Channel > 3) continue;
+        if (_adcCounts[entry.record.Channel] == 0) {
+            _adcCounts[entry.record.Channel] = entry.record.Ram.RawAdc;
+            int ram = PlantModel::ramForAdcChannel(entry.record.Channel);
+            if (_context.plant && ram >= 0) _context.plant->setPosition(ram, entry.record.Ram.PositionPercent);
+        }
+    }
+
+    if (!_context.plant) {
+        HostDevices::setAdcSource([this](uint8_t channel) { return _adcCounts[channel & 0x03]; });
+    }
+    HostDevices::setRadarSource([this] { return _radarPeaks; });
+    return true;
+}
+
+bool ReplaySource::isFinished(uint64_t nowMicros) const {
+    return _next >= _records.size() && nowMicros >= _baseMicros + _durationMicros;
+}
+
+bool ReplaySource::getSetpoints(float setpoints[3]) const {
+    for (int i = 0; i < 3; i++) setpoints[i] = _setpoints[i];
+    return _haveSetpoints;
+}
+
+void ReplaySource::update(uint64_t nowMicros) {
+    uint64_t horizon = nowMicros + SIM_LOOKAHEAD_US;
+    while (_next < _records.size() && _baseMicros + _records[_next].offsetMicros <= horizon) {
+        schedule(_records[_next]);
+        _next++;
+    }
+}
+
+void ReplaySource::schedule(const ReplayRecord& entry) {
+    uint64_t at = _baseMicros + entry.offsetMicros;
+    const FlightRecord& record = entry.record;
+    uint64_t offset = entry.offsetMicros;
+    _counts[record.Type]++;
+
+    switch (record.Type) {
+        case RECORD_IMU:
+            HostHal::schedule(at, [this, record] { replayImu(record); });
+            break;
+        case RECORD_RADAR:
+            HostHal::schedule(at, [this, record] { replayRadar(record); });
+            break;
+        case RECORD_GNSS:
+            replayGnss(record, at);
+            break;
+        case RECORD_RAM:
+            HostHal::schedule(at, [this, record, offset] { replayRam(record, offset); });
+            break;
+        case RECORD_COMMAND:
+            HostHal::schedule(at, [this, record] { replayCommand(record); });
+            break;
+        case RECORD_TRIGGER:
+            HostHal::schedule(at, [this, record, offset] { replayTrigger(record, offset); });
+            break;
+        default:
+            break;
+    }
+}
+
+void ReplaySource::replayImu(const FlightRecord& record) {
+    const FlightRecordImu& imu = record.Imu;
+    HostImuReport report = {};
+    report.reportId = imu.ReportId;
+    report.quatI = imu.Quat[0] / 16384.0f;
+    report.quatJ = imu.Quat[1] / 16384.0f;
+    report.quatK = imu.Quat[2] / 16384.0f;
+    report.quatReal = imu.Quat[3] / 16384.0f;
+    report.linAccelX = imu.LinAccel[0] / 100.0f;
+    report.linAccelY = imu.LinAccel[1] / 100.0f;
+    report.linAccelZ = imu.LinAccel[2] / 100.0f;
+    report.gyroX = imu.Gyro[0] / 1000.0f;
+    report.gyroY = imu.Gyro[1] / 1000.0f;
+    report.gyroZ = imu.Gyro[2] / 1000.0f;
+    report.quatAccuracy = imu.QuatAccuracy;
+    report.linAccelAccuracy = imu.LinAccelAccuracy;
+    report.accelAccuracy = report.gyroAccuracy = imu.LinAccelAccuracy;
+
+    // Raw accel is not recorded - put gravity back along the body axes
+    // (third row of the body-to-ENU rotation)
+    float x = report.quatI, y = report.quatJ, z = report.quatK, w = report.quatReal;
+    const float g = 9.80665f;
+    report.accelX = report.linAccelX + g * 2.0f * (x * z - w * y);
+    report.accelY = report.linAccelY + g * 2.0f * (y * z + w * x);
+    report.accelZ = report.linAccelZ + g * (1.0f - 2.0f * (x * x + y * y));
+
+    HostDevices::pushImuReport(report);
+}
+
+void ReplaySource::replayRadar(const FlightRecord& record) {
+    // The next measurement to complete returns these peaks
+    const FlightRecordRadar& radar = record.Radar;
+    _radarPeaks = HostRadarPeaks();
+    _radarPeaks.peak0Distance = radar.Peak0Mm;
+    _radarPeaks.peak1Distance = radar.Peak1Mm;
+    _radarPeaks.peak0Strength = radar.Peak0Strength;
+    _radarPeaks.peak1Strength = radar.Peak1Strength;
+}
+
+void ReplaySource::replayGnss(const FlightRecord& record, uint64_t at) {
+    const FlightRecordGnss& gnss = record.Gnss;
+    UBX_NAV_HPPOSLLH_data_t epoch = {};
+    epoch.iTOW = gnss.TimeOfWeek;
+    epoch.lat = gnss.LatE7;
+    epoch.latHp = gnss.LatHp;
+    epoch.lon = gnss.LonE7;
+    epoch.lonHp = gnss.LonHp;
+    epoch.hMSL = gnss.HeightMm;
+    epoch.height = gnss.HeightMm;
+    epoch.hAcc = gnss.HAcc;
+    epoch.vAcc = gnss.HAcc;
+    epoch.flags.all = (gnss.Flags & 0x01) ? 0x00 : 0x01;  // Recorded fix valid -> invalidLlh clear
+
+    // The epoch's NAV-PVT carries the fix flag - speed and heading are not recorded
+    UBX_NAV_PVT_data_t pvt = {};
+    pvt.iTOW = gnss.TimeOfWeek;
+    pvt.fixType = (gnss.Flags & 0x01) ? 3 : 0;
+    pvt.flags.bits.gnssFixOK = (gnss.Flags & 0x01) ? 1 : 0;
+    pvt.lat = gnss.LatE7;
+    pvt.lon = gnss.LonE7;
+    pvt.hMSL = gnss.HeightMm;
+    pvt.hAcc = gnss.HAcc / 10;
+
+    // TIMEPULSE is not recorded - regenerate it from whole-second epochs
+    if (gnss.TimeOfWeek % 1000 == 0 && at > REPLAY_GNSS_LATENCY_US) {
+        HostHal::schedule(at - REPLAY_GNSS_LATENCY_US, [] { HostDevices::pulseTimepulse(); });
+    }
+    HostHal::schedule(at, [pvt, epoch] {
+        HostDevices::pushGnssPvt(pvt);
+        HostDevices::pushGnssEpoch(epoch);
+    });
+}
+
+void ReplaySource::replayRam(const FlightRecord& record, uint64_t offset) {
+    const FlightRecordRam& ram = record.Ram;
+    if (record.Channel > 3) return;
+    if (_context.plant) return;     // Closed loop - the plant owns position
+
+    _adcCounts[record.Channel] = ram.RawAdc;
+
+    int index = PlantModel::ramForAdcChannel(record.Channel);
+    if (index < 0) return;
+    static const uint8_t valvePins[3] = { RAM_CENTER_VALVE_PIN, RAM_LEFT_VALVE_PIN, RAM_RIGHT_VALVE_PIN };
+    int32_t difference = HostHal::getPwm(valvePins[index]) - (int32_t)ram.Pwm;
+
+    ReplayChannelStats& stats = _pwm[index];
+    stats.compared++;
+    stats.sumSquared += (double)difference * difference;
+    if (abs(difference) > abs(stats.maxDifference)) stats.maxDifference = difference;
+    if (_pwmTolerance >= 0 && abs(difference) > _pwmTolerance) {
+        stats.diverged++;
+        if (stats.firstDivergenceMicros == 0) stats.firstDivergenceMicros = offset ? offset : 1;
+    }
+}
+
+void ReplaySource::replayCommand(const FlightRecord& record) {
+    const FlightRecordCommand& recorded = record.Command;
+    if (recorded.Accepted) {
+        _commandsRecordedAccepted++;
+        _setpoints[0] = recorded.SetpointCenter;
+        _setpoints[1] = recorded.SetpointLeft;
+        _setpoints[2] = recorded.SetpointRight;
+        _haveSetpoints = true;
+    }
+
+    ControlCommandPacket command;
+    command.CommandId = recorded.CommandId;
+    command.Timestamp = millis();
+    command.SetpointCenter = recorded.SetpointCenter;
+    command.SetpointLeft = recorded.SetpointLeft;
+    command.SetpointRight = recorded.SetpointRight;
+    if (_context.hydraulics) _context.hydraulics->processCommand(command, micros());
+}
+
+void ReplaySource::replayTrigger(const FlightRecord& record, uint64_t offset) {
+    printf("  %8.3fs  trigger: %s (%lu safety violations)\n", offset * 1e-6,
+           record.Trigger.Reason == RECORDER_TRIGGER_SAFETY ? "safety" :
+           record.Trigger.Reason == RECORDER_TRIGGER_ESTOP ? "emergency stop" :
+           record.Trigger.Reason == RECORDER_TRIGGER_MANUAL ? "manual" : "unknown",
+           (unsigned long)record.Trigger.SafetyViolations);
+
+    // An operator e-stop came from outside - replay it so the valves match
+    if (record.Trigger.Reason == RECORDER_TRIGGER_ESTOP && _context.hydraulics) {
+        _context.hydraulics->emergencyStop();
+    }
+}
+
+bool ReplaySource::report() {
+    bool passed = true;
+
+    printf("\nReplayed: %lu IMU, %lu radar, %lu GNSS, %lu ram steps, %lu commands (%lu accepted on the module), %lu triggers\n",
+           (unsigned long)_counts[RECORD_IMU], (unsigned long)_counts[RECORD_RADAR],
+           (unsigned long)_counts[RECORD_GNSS], (unsigned long)_counts[RECORD_RAM],
+           (unsigned long)_counts[RECORD_COMMAND], (unsigned long)_commandsRecordedAccepted,
+           (unsigned long)_counts[RECORD_TRIGGER]);
+
+    if (_context.plant) {
+        printf("Closed loop on the plant model - valve drive not compared with the recording\n");
+        return passed;
+    }
+
+    static const char* names[3] = { "Centre", "Left", "Right" };
+    if (_pwmTolerance >= 0) {
+        printf("Valve PWM against the recording (tolerance %ld counts):\n", (long)_pwmTolerance);
+    } else {
+        printf("Valve PWM against the recording:\n");
+    }
+    for (int i = 0; i < 3; i++) {
+        const ReplayChannelStats& stats = _pwm[i];
+        if (stats.compared == 0) continue;
+        printf("  %-7s %7lu steps  RMS %7.1f  max %+6ld  diverged %6lu", names[i], (unsigned long)stats.compared,
+               sqrt(stats.sumSquared / stats.compared), (long)stats.maxDifference, (unsigned long)stats.diverged);
+        if (stats.firstDivergenceMicros) printf("  first at %.3fs", stats.firstDivergenceMicros * 1e-6);
+        printf("\n");
+        if (stats.diverged > 0) passed = false;
+    }
+    if (!passed) printf("  FAIL: simulated valve drive differs from the recording\n");
+    return passed;
+}
@@ -0,0 +1,92 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Black-Box Replay
+ *
+ * Replays a FlightRecorder file (bb_NNN.bin) into the simulated module:
+ * - Records are read in ring order and re-timed onto the virtual clock,
+ *   so a 90s incident replays in well under a second
+ * - IMU, radar peaks, GNSS epochs and Toughbook commands are fed through
+ *   the device mocks at their recorded times
+ * - Open loop (default): the recorded ADC counts drive the position
+ *   feedback, and the valve PWM the simulated controller holds at each
+ *   recorded control step is compared with what the module drove - a
+ *   regression check for controller changes against field data
+ * - Closed loop (plant attached): rams come from the plant model instead,
+ *   starting from the recorded positions, for trying new gains on a
+ *   recorded command sequence
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_REPLAY_SOURCE_H
+#define HOST_REPLAY_SOURCE_H
+
+#include "SimSource.h"
+#include "FlightRecorder.h"
+#include "HostDevices.h"
+#include <string>
+#include <vector>
+
+#define REPLAY_START_DELAY_US   100000  // Settle after setup() before the first record
+#define REPLAY_GNSS_LATENCY_US  40000   // TIMEPULSE lead ahead of a recorded HPPOSLLH arrival
+
+struct ReplayRecord {
+    uint64_t offsetMicros;          // From the first record, unwrapped
+    FlightRecord record;
+};
+
+struct ReplayChannelStats {
+    uint32_t compared;
+    uint32_t diverged;              // Steps outside the tolerance
+    double sumSquared;
+    int32_t maxDifference;
+    uint64_t firstDivergenceMicros; // Offset into the recording, 0 if none
+};
+
+class ReplaySource : public SimSource {
+public:
+    ReplaySource();
+
+    // Read and order a recording - before begin()
+    bool load(const std::string& path);
+    uint8_t getRecordedRole() const { return _header.ModuleRole; }
+    void setPwmTolerance(int32_t counts) { _pwmTolerance = counts; }   // < 0: report only
+
+    const char* getName() const override { return "replay"; }
+    bool begin(SimContext& context) override;
+    void update(uint64_t nowMicros) override;
+    bool isFinished(uint64_t nowMicros) const override;
+    bool getSetpoints(float setpoints[3]) const override;
+    bool report() override;
+
+private:
+    std::string _path;
+    FlightRecorderFileHeader _header;
+    std::vector<ReplayRecord> _records;
+    size_t _next;
+    uint64_t _baseMicros;           // Virtual time of the first record
+    uint64_t _durationMicros;
+    SimContext _context;
+    int32_t _pwmTolerance;
+
+    float _setpoints[3];
+    bool _haveSetpoints;
+    bool _plantSeeded;
+    int16_t _adcCounts[4];          // Latest recorded count per ADC channel
+    HostRadarPeaks _radarPeaks;
+
+    uint32_t _counts[RECORD_TRIGGER + 1];
+    uint32_t _commandsRecordedAccepted;
+    ReplayChannelStats _pwm[3];
+
+    void schedule(const ReplayRecord& entry);
+    void replayImu(const FlightRecord& record);
+    void replayRadar(const FlightRecord& record);
+    void replayGnss(const FlightRecord& record, uint64_t at);
+    void replayRam(const FlightRecord& record, uint64_t offset);
+    void replayCommand(const FlightRecord& record);
+    void replayTrigger(const FlightRecord& record, uint64_t offset);
+};
+
+#endif // HOST_REPLAY_SOURCE_H
@@ -0,0 +1,536 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Synthetic Field Scenario Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "Scenario.h"
+#include "HostHal.h"
+#include "SensorManager.h"
+#include "HydraulicController.h"
+#include "TerrainPreview.h"
+#include <SD.h>
+#include <algorithm>
+#include <vector>
+
+#define EARTH_RADIUS_M          6378137.0
+#define SPEED_VARIATION_MPS     1.5f        // Speed swings this much either side of the mean, never into reverse
+#define SPEED_PERIOD_S          20.0
+#define GRAVITY_MPS2            9.80665f
+
+namespace {
+
+double wave(double x, double period) {
+    return sin(2.0 * PI * x / period);
+}
+
+} // namespace
+
+Scenario::Scenario(const ScenarioConfig& config)
+    : _config(config), _context(), _random(1),
+      _startMicros(0), _endMicros(0), _lastRadarSample(0), _lastFusionSample(0),
+      _nextCommand(0), _nextImu(0), _nextGnss(0), _nextPulse(0), _nextRtcm(0),
+      _commandId(0), _setpoints{ 50.0f, 50.0f, 50.0f }, _haveSetpoints(false),
+      _radarSamples(0), _radarValid(0), _radarDropouts(0), _radarErrorSum(0.0), _radarErrorMax(0.0f),
+      _fusionSamples(0), _fusionValid(0), _fusionErrorSum(0.0), _fusionErrorMax(0.0f),
+      _gnssSamples(0), _gnssValid(0), _lastGnssMillis(0),
+      _terrainChecks(0), _terrainActive(0), _terrainSamples(0), _terrainErrorSum(0.0),
+      _terrainErrorMax(0.0f), _terrainFeedForwardMax(0.0f),
+      _rtcmFramesSent(0), _rtcmFramesCorrupted(0), _rtcmBytesGood(0) {
+}
+
+bool Scenario::begin(SimContext& context) {
+    _context = context;
+    _random.seed(context.seed);
+
+    _startMicros = HostHal::now();
+    _endMicros = _startMicros + (uint64_t)_config.durationMs * 1000ULL;
+    _nextCommand = _startMicros;
+    _nextImu = _startMicros;
+    _nextGnss = _startMicros;
+    _nextPulse = _startMicros;
+    _nextRtcm = _startMicros + 500000;     // Base station bursts mid-second
+
+    _framer.setFrameHandler(&onRtcmFrame, this);
+    HostDevices::setRadarSource([this] { return measureRadar(); });
+    return true;
+}
+
+bool Scenario::isFinished(uint64_t nowMicros) const {
+    return nowMicros >= _endMicros;
+}
+
+bool Scenario::getSetpoints(float setpoints[3]) const {
+    for (int i = 0; i < 3; i++) setpoints[i] = _setpoints[i];
+    return _haveSetpoints;
+}
+
+// --- Truth ---
+
+double Scenario::speedVariation() const {
+    return std::min((double)SPEED_VARIATION_MPS, std::max(0.0, (double)_config.speedMps));
+}
+
+double Scenario::truthNorth(double t) const {
+    // speed = mean + variation * sin(wt), integrated from zero
+    double w = 2.0 * PI / SPEED_PERIOD_S;
+    return _config.speedMps * t + speedVariation() * (1.0 - cos(w * t)) / w;
+}
+
+double Scenario::truthSpeed(double t) const {
+    double w = 2.0 * PI / SPEED_PERIOD_S;
+    return _config.speedMps + speedVariation() * sin(w * t);
+}
+
+float Scenario::truthAccel(double t) const {
+    double w = 2.0 * PI / SPEED_PERIOD_S;
+    return (float)(speedVariation() * w * cos(w * t));
+}
+
+double Scenario::groundHeight(double north) {
+    // Contour banks and wheel-track ruts along the run
+    return 0.12 * wave(north, 25.0) + 0.04 * wave(north, 6.3);
+}
+
+float Scenario::groundDistance(double t) const {
+    return (float)(SCENARIO_BOOM_HEIGHT_M - groundHeight(truthNorth(t)));
+}
+
+float Scenario::canopyDensity(double t) const {
+    return (float)(0.5 + 0.5 * wave(truthNorth(t), 40.0));
+}
+
+uint64_t Scenario::localToVirtual(uint32_t micros) const {
+    // micros() is the low 32 bits of the virtual clock
+    uint64_t now = HostHal::now();
+    return now - (uint32_t)((uint32_t)now - micros);
+}
+
+void Scenario::setpointsAt(double t, float setpoints[3]) const {
+    float amplitude = _config.stepAmplitude;
+    switch (_config.profile) {
+        case SCENARIO_PROFILE_STEPS: {
+            float sign = (((int)(t / 5.0)) % 2 == 0) ? 1.0f : -1.0f;
+            setpoints[0] = 50.0f + amplitude * sign;
+            setpoints[1] = 50.0f - amplitude * sign;
+            setpoints[2] = 50.0f + 0.5f * amplitude * sign;
+            break;
+        }
+        case SCENARIO_PROFILE_SINE:
+            for (int i = 0; i < 3; i++) {
+                setpoints[i] = 50.0f + amplitude * (float)sin(2.0 * PI * t / 8.0 + i * 2.0 * PI / 3.0);
+            }
+            break;
+        default:
+            setpoints[0] = setpoints[1] = setpoints[2] = 50.0f;
+            break;
+    }
+}
+
+// --- Event generation ---
+
+void Scenario::update(uint64_t nowMicros) {
+    uint64_t horizon = std::min<uint64_t>(nowMicros + SIM_LOOKAHEAD_US, _endMicros);
+
+    while (_nextPulse <= horizon) {
+        HostHal::schedule(_nextPulse, [] { HostDevices::pulseTimepulse(); });
+        _nextPulse += 1000000;
+    }
+    while (_nextCommand <= horizon) {
+        sendCommand(_nextCommand);
+        _nextCommand += SCENARIO_COMMAND_PERIOD_US;
+    }
+    while (_nextImu <= horizon) {
+        sendImu(_nextImu);
+        _nextImu += SCENARIO_IMU_PERIOD_US;
+    }
+    while (_nextGnss <= horizon) {
+        sendGnss(_nextGnss);
+        _nextGnss += HostDevices::getGnssEpochPeriodMicros();
+    }
+    while (_nextRtcm <= horizon) {
+        sendRtcm(_nextRtcm);
+        _nextRtcm += SCENARIO_RTCM_PERIOD_US;
+    }
+
+    checkRadar();
+    checkFusion();
+    checkGnss();
+    checkTerrain();
+}
+
+void Scenario::sendCommand(uint64_t at) {
+    ControlCommandPacket command;
+    command.CommandId = ++_commandId;
+    command.Timestamp = (uint32_t)(at / 1000);
+    float setpoints[3];
+    setpointsAt(elapsed(at), setpoints);
+    command.SetpointCenter = setpoints[0];
+    command.SetpointLeft = setpoints[1];
+    command.SetpointRight = setpoints[2];
+
+    HostHal::schedule(at, [this, command] {
+        _setpoints[0] = command.SetpointCenter;
+        _setpoints[1] = command.SetpointLeft;
+        _setpoints[2] = command.SetpointRight;
+        _haveSetpoints = true;
+        if (_context.hydraulics) _context.hydraulics->processCommand(command, micros());
+    });
+}
+
+void Scenario::sendImu(uint64_t at) {
+    std::normal_distribution<float> accelNoise(0.0f, 0.05f);
+    std::normal_distribution<float> gyroNoise(0.0f, 0.002f);
+
+    // Level, heading north: body x east, y north, z up (ENU rotation vector frame)
+    HostImuReport report = {};
+    report.reportId = SENSOR_REPORTID_ROTATION_VECTOR;
+    report.quatReal = 1.0f;
+    report.linAccelX = accelNoise(_random);
+    report.linAccelY = truthAccel(elapsed(at)) + accelNoise(_random);
+    report.linAccelZ = accelNoise(_random);
+    report.accelX = report.linAccelX;
+    report.accelY = report.linAccelY;
+    report.accelZ = report.linAccelZ + GRAVITY_MPS2;
+    report.gyroX = gyroNoise(_random);
+    report.gyroY = gyroNoise(_random);
+    report.gyroZ = gyroNoise(_random);
+    report.quatAccuracy = report.accelAccuracy = report.gyroAccuracy = report.linAccelAccuracy = 3;
+
+    HostHal::schedule(at, [report] { HostDevices::pushImuReport(report); });
+}
+
+void Scenario::sendGnss(uint64_t epochAt) {
+    std::normal_distribution<double> positionNoise(0.0, 0.01);
+
+    double t = elapsed(epochAt);
+    double north = truthNorth(t) + positionNoise(_random);
+    double east = positionNoise(_random);
+    double latitude = SCENARIO_ORIGIN_LAT + north / EARTH_RADIUS_M * RAD_TO_DEG;
+    double longitude = SCENARIO_ORIGIN_LON + east / (EARTH_RADIUS_M * cos(SCENARIO_ORIGIN_LAT * DEG_TO_RAD)) * RAD_TO_DEG;
+    double altitudeMm = SCENARIO_ORIGIN_ALT_M * 1000.0;
+
+    UBX_NAV_HPPOSLLH_data_t epoch = {};
+    epoch.iTOW = SCENARIO_GPS_START_TOW_MS + (uint32_t)((epochAt - _startMicros) / 1000);
+    epoch.lat = (int32_t)floor(latitude * 1e7);
+    epoch.latHp = (int8_t)lround((latitude * 1e7 - epoch.lat) * 100.0);
+    epoch.lon = (int32_t)floor(longitude * 1e7);
+    epoch.lonHp = (int8_t)lround((longitude * 1e7 - epoch.lon) * 100.0);
+    epoch.hMSL = (int32_t)altitudeMm;
+    epoch.height = epoch.hMSL;
+    epoch.hAcc = 140;               // 14mm - RTK fixed
+    epoch.vAcc = 200;
+    epoch.flags.all = 0x00;         // invalidLlh clear - a good position, as u-blox sends it
+
+    // Same epoch's NAV-PVT - heading due north at the truth speed
+    double speed = truthSpeed(t);
+    UBX_NAV_PVT_data_t pvt = {};
+    pvt.iTOW = epoch.iTOW;
+    pvt.fixType = 3;
+    pvt.flags.bits.gnssFixOK = 1;
+    pvt.flags.bits.carrSoln = 2;    // RTK fixed
+    pvt.numSV = 18;
+    pvt.lat = epoch.lat;
+    pvt.lon = epoch.lon;
+    pvt.hMSL = epoch.hMSL;
+    pvt.hAcc = epoch.hAcc / 10;
+    pvt.velN = (int32_t)lround(speed * 1000.0);
+    pvt.gSpeed = pvt.velN;
+    pvt.headMot = 0;
+
+    HostHal::schedule(epochAt + SCENARIO_GNSS_LATENCY_US, [pvt, epoch] {
+        HostDevices::pushGnssPvt(pvt);
+        HostDevices::pushGnssEpoch(epoch);
+    });
+}
+
+void Scenario::sendRtcm(uint64_t at) {
+    // One base station burst: reference position, MSM7 GPS and GLONASS, biases
+    static const uint16_t types[] = { 1005, 1077, 1087, 1230 };
+    static const uint16_t sizes[] = { 19, 220, 170, 8 };
+    std::uniform_int_distribution<int> byteValue(0, 255);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+    std::vector<uint8_t> stream;
+    for (size_t n = 0; n < sizeof(types) / sizeof(types[0]); n++) {
+        std::vector<uint8_t> frame(3 + sizes[n] + 3);
+        frame[0] = 0xD3;
+        frame[1] = (uint8_t)(sizes[n] >> 8);
+        frame[2] = (uint8_t)sizes[n];
+        for (uint16_t i = 0; i < sizes[n]; i++) frame[3 + i] = (uint8_t)byteValue(_random);
+        frame[3] = (uint8_t)(types[n] >> 4);
+        frame[4] = (uint8_t)((types[n] << 4) | (frame[4] & 0x0F));
+        uint32_t crc = RtcmFramer::crc24q(frame.data(), 3 + sizes[n]);
+        frame[3 + sizes[n]] = (uint8_t)(crc >> 16);
+        frame[4 + sizes[n]] = (uint8_t)(crc >> 8);
+        frame[5 + sizes[n]] = (uint8_t)crc;
+
+        _rtcmFramesSent++;
+        if (chance(_random) < _config.rtcmCorruption) {
+            // Flip a payload byte past the message type so the frame still looks plausible
+            std::uniform_int_distribution<int> position(5, 2 + sizes[n]);
+            frame[position(_random)] ^= 0x5A;
+            _rtcmFramesCorrupted++;
+        } else {
+            _rtcmBytesGood += (uint32_t)frame.size();
+        }
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+
+    // Arrives as a few datagrams of arbitrary size
+    std::uniform_int_distribution<size_t> chunkSize(1, 300);
+    size_t offset = 0;
+    uint64_t when = at;
+    while (offset < stream.size()) {
+        size_t len = std::min(chunkSize(_random), stream.size() - offset);
+        std::vector<uint8_t> chunk(stream.begin() + offset, stream.begin() + offset + len);
+        HostHal::schedule(when, [this, chunk] { _framer.push(chunk.data(), chunk.size()); });
+        offset += len;
+        when += 200;
+    }
+}
+
+void Scenario::onRtcmFrame(const uint8_t* frame, size_t len, uint16_t, void* context) {
+    Scenario* scenario = static_cast<Scenario*>(context);
+    if (scenario->_context.sensors) scenario->_context.sensors->forwardRtcmToGps(frame, len);
+}
+
+HostRadarPeaks Scenario::measureRadar() {
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::normal_distribution<float> rangeNoise(0.0f, 0.003f);
+    HostRadarPeaks peaks = {};
+
+    _radarSamples++;
+    if (chance(_random) < _config.radarDropout) {
+        _radarDropouts++;
+        return peaks;
+    }
+
+    // Peaks come back strongest first - a dense canopy can outshine the ground
+    double t = elapsed(HostHal::now());
+    uint32_t ground = (uint32_t)lroundf((groundDistance(t) + rangeNoise(_random)) * 1000.0f);
+    uint32_t canopy = (uint32_t)lroundf((groundDistance(t) - SCENARIO_CANOPY_DEPTH_M + rangeNoise(_random)) * 1000.0f);
+    int32_t groundStrength = 2500;
+    int32_t canopyStrength = (int32_t)(500 + 2500 * canopyDensity(t));
+
+    if (groundStrength >= canopyStrength) {
+        peaks.peak0Distance = ground;
+        peaks.peak0Strength = groundStrength;
+        peaks.peak1Distance = canopy;
+        peaks.peak1Strength = canopyStrength;
+    } else {
+        peaks.peak0Distance = canopy;
+        peaks.peak0Strength = canopyStrength;
+        peaks.peak1Distance = ground;
+        peaks.peak1Strength = groundStrength;
+    }
+    return peaks;
+}
+
+// --- Checks against truth ---
+
+void Scenario::checkRadar() {
+    if (!_context.sensors) return;
+    SensorSnapshot snapshot;
+    _context.sensors->getSnapshot(&snapshot);
+    if (snapshot.radar.sampleMicros == 0 || snapshot.radar.sampleMicros == _lastRadarSample) return;
+    _lastRadarSample = snapshot.radar.sampleMicros;
+
+    if (!snapshot.radar.valid) return;
+    _radarValid++;
+    float error = fabsf(snapshot.radar.distance - groundDistance(elapsed(localToVirtual(snapshot.radar.sampleMicros))));
+    _radarErrorSum += error;
+    if (error > _radarErrorMax) _radarErrorMax = error;
+}
+
+void Scenario::checkFusion() {
+    if (!_context.sensors) return;
+    SensorSnapshot snapshot;
+    _context.sensors->getSnapshot(&snapshot);
+    if (snapshot.fusion.sampleMicros == 0 || snapshot.fusion.sampleMicros == _lastFusionSample) return;
+    _lastFusionSample = snapshot.fusion.sampleMicros;
+
+    _fusionSamples++;
+    if (!snapshot.fusion.valid) return;
+    _fusionValid++;
+
+    double t = elapsed(localToVirtual(snapshot.fusion.sampleMicros));
+    double north = (snapshot.fusion.latitude - SCENARIO_ORIGIN_LAT) * DEG_TO_RAD * EARTH_RADIUS_M;
+    double east = (snapshot.fusion.longitude - SCENARIO_ORIGIN_LON) * DEG_TO_RAD *
+                  EARTH_RADIUS_M * cos(SCENARIO_ORIGIN_LAT * DEG_TO_RAD);
+    float error = (float)hypot(north - truthNorth(t), east);
+    _fusionErrorSum += error;
+    if (error > _fusionErrorMax) _fusionErrorMax = error;
+}
+
+void Scenario::checkGnss() {
+    if (!_context.sensors) return;
+    SensorSnapshot snapshot;
+    _context.sensors->getSnapshot(&snapshot);
+    if (snapshot.gps.updateMillis == 0 || snapshot.gps.updateMillis == _lastGnssMillis) return;
+    _lastGnssMillis = snapshot.gps.updateMillis;
+
+    // Every scenario epoch is a good RTK fix
+    _gnssSamples++;
+    if (snapshot.gps.validFix) _gnssValid++;
+}
+
+void Scenario::checkTerrain() {
+    if (!_context.terrain || _gnssSamples == 0) return;
+    double t = elapsed(HostHal::now());
+    if (truthSpeed(t) < SCENARIO_TERRAIN_SPEED_MPS) return;
+
+    _terrainChecks++;
+    if (!_context.terrain->isActive()) return;
+    _terrainActive++;
+    _terrainFeedForwardMax = std::max(_terrainFeedForwardMax, fabsf(_context.terrain->getCentreFeedForward()));
+
+    // The DEM under the tractor (inside the boom's prefetched swath) against the ground truth
+    double north = truthNorth(t);
+    float y = (float)(north / EARTH_RADIUS_M * RAD_TO_DEG * SCENARIO_DEM_METRES_PER_DEG);
+    float elevation;
+    if (!_context.terrain->sampleElevation(0.0f, y, &elevation)) return;
+    _terrainSamples++;
+    float error = fabsf(elevation - (float)(SCENARIO_ORIGIN_ALT_M + groundHeight(north)));
+    _terrainErrorSum += error;
+    if (error > _terrainErrorMax) _terrainErrorMax = error;
+}
+
+// --- Field DEM ---
+
+bool Scenario::writeTerrainDem() const {
+    // Local grid about the origin: x east, y north, row 0 at the top (north) edge
+    double length = truthNorth(_config.durationMs / 1000.0);
+    float bottom = -SCENARIO_DEM_MARGIN_M;
+    float top = (float)(length / EARTH_RADIUS_M * RAD_TO_DEG * SCENARIO_DEM_METRES_PER_DEG) + SCENARIO_DEM_MARGIN_M;
+    float left = -SCENARIO_DEM_HALF_WIDTH_M;
+    int32_t columns = (int32_t)(2.0f * SCENARIO_DEM_HALF_WIDTH_M / SCENARIO_DEM_RESOLUTION_M) + 1;
+    int32_t rows = (int32_t)((top - bottom) / SCENARIO_DEM_RESOLUTION_M) + 1;
+
+    if (!SD.mkdir(TERRAIN_DEM_DIRECTORY)) {
+        fprintf(stderr, "Cannot create %s on the SD card\n", TERRAIN_DEM_DIRECTORY);
+        return false;
+    }
+
+    std::string demPath = SDClass::hostPath(TERRAIN_DEM_DIRECTORY "/elevation.dem");
+    FILE* dem = fopen(demPath.c_str(), "wb");
+    if (!dem) {
+        fprintf(stderr, "Cannot write %s\n", demPath.c_str());
+        return false;
+    }
+    int32_t header[2] = { rows, columns };
+    fwrite(header, sizeof(header), 1, dem);
+
+    // Ground is level across the track, so every column of a row is the same
+    std::vector<float> row(columns);
+    float minElevation = INFINITY, maxElevation = -INFINITY;
+    for (int32_t r = 0; r < rows; r++) {
+        double y = top - r * SCENARIO_DEM_RESOLUTION_M;
+        double north = y / SCENARIO_DEM_METRES_PER_DEG * DEG_TO_RAD * EARTH_RADIUS_M;
+        float elevation = (float)(SCENARIO_ORIGIN_ALT_M + groundHeight(north));
+        std::fill(row.begin(), row.end(), elevation);
+        fwrite(row.data(), sizeof(float), row.size(), dem);
+        minElevation = std::min(minElevation, elevation);
+        maxElevation = std::max(maxElevation, elevation);
+    }
+    bool written = ferror(dem) == 0;
+    written = (fclose(dem) == 0) && written;
+
+    std::string metadataPath = SDClass::hostPath(TERRAIN_DEM_DIRECTORY "/metadata.json");
+    FILE* metadata = fopen(metadataPath.c_str(), "w");
+    if (!metadata) {
+        fprintf(stderr, "Cannot write %s\n", metadataPath.c_str());
+        return false;
+    }
+    fprintf(metadata,
+            "{\n"
+            "  \"ReferenceLatitude\": %.9f,\n"
+            "  \"ReferenceLongitude\": %.9f,\n"
+            "  \"Resolution\": %.3f,\n"
+            "  \"PixelsX\": %ld,\n"
+            "  \"PixelsY\": %ld,\n"
+            "  \"Bounds\": { \"Left\": %.3f, \"Top\": %.3f, \"Right\": %.3f, \"Bottom\": %.3f },\n"
+            "  \"MinElevation\": %.4f,\n"
+            "  \"MaxElevation\": %.4f,\n"
+            "  \"IsCompressed\": false\n"
+            "}\n",
+            SCENARIO_ORIGIN_LAT, SCENARIO_ORIGIN_LON, SCENARIO_DEM_RESOLUTION_M, (long)columns, (long)rows,
+            left, top, left + (columns - 1) * SCENARIO_DEM_RESOLUTION_M, top - (rows - 1) * SCENARIO_DEM_RESOLUTION_M,
+            minElevation, maxElevation);
+    written = (fclose(metadata) == 0) && written;
+
+    if (!written) fprintf(stderr, "Writing the field DEM failed\n");
+    return written;
+}
+
+// --- Report ---
+
+bool Scenario::report() {
+    bool passed = true;
+
+    printf("\nRadar: %lu measurements, %lu valid readings, %lu dropouts injected\n",
+           (unsigned long)_radarSamples, (unsigned long)_radarValid, (unsigned long)_radarDropouts);
+    if (_radarValid > 0) {
+        printf("  Ground error: mean %.1fmm, max %.1fmm (canopy taken for ground shows as ~%.0fmm)\n",
+               _radarErrorSum / _radarValid * 1000.0, _radarErrorMax * 1000.0f, SCENARIO_CANOPY_DEPTH_M * 1000.0f);
+    }
+
+    if (_fusionSamples > 0) {
+        printf("Dead reckoning: %lu of %lu samples valid",
+               (unsigned long)_fusionValid, (unsigned long)_fusionSamples);
+        if (_fusionValid > 0) {
+            printf(", position error mean %.3fm, max %.3fm", _fusionErrorSum / _fusionValid, _fusionErrorMax);
+        }
+        printf("\n");
+    }
+
+    const HostDeviceStats& devices = HostDevices::getStats();
+    printf("GNSS: %lu PVT + %lu HPPOSLLH epochs at %.0fHz, %lu configuration VALSETs\n",
+           (unsigned long)devices.gnssPvtDelivered, (unsigned long)devices.gnssEpochsDelivered,
+           1e6 / HostDevices::getGnssEpochPeriodMicros(), (unsigned long)devices.gnssValsets);
+    if (devices.gnssEpochsDelivered == 0 || devices.gnssPvtDelivered != devices.gnssEpochsDelivered) {
+        printf("  FAIL: GNSS epochs not delivered to the firmware\n");
+        passed = false;
+    }
+    printf("  Fix: %lu of %lu published epochs valid\n", (unsigned long)_gnssValid, (unsigned long)_gnssSamples);
+    if (_gnssSamples == 0 || _gnssValid != _gnssSamples) {
+        printf("  FAIL: good fixes not published as valid (fix flags misread)\n");
+        passed = false;
+    }
+    if (_context.terrain) {
+        printf("Terrain preview: ACTIVE %lu of %lu loop passes on the move, %lu tile loads (max %luus), "
+               "%lu cache misses, feed-forward up to %.1f%%\n",
+               (unsigned long)_terrainActive, (unsigned long)_terrainChecks,
+               (unsigned long)_context.terrain->getTileLoads(), (unsigned long)_context.terrain->getMaxLoadMicros(),
+               (unsigned long)_context.terrain->getCacheMisses(), _terrainFeedForwardMax);
+        if (_terrainSamples > 0) {
+            printf("  DEM error: mean %.2fmm, max %.2fmm over %lu lookups\n", _terrainErrorSum / _terrainSamples * 1000.0,
+                   _terrainErrorMax * 1000.0f, (unsigned long)_terrainSamples);
+        }
+        if (_terrainChecks == 0) {
+            printf("  FAIL: terrain preview needs the scenario moving (--speed)\n");
+            passed = false;
+        } else if (_terrainActive < _terrainChecks * SCENARIO_TERRAIN_MIN_ACTIVE || _terrainFeedForwardMax <= 0.0f) {
+            printf("  FAIL: terrain preview not active with a good fix (%s)\n",
+                   _context.terrain->getStatusString().c_str());
+            passed = false;
+        } else if (_terrainSamples == 0 || _terrainErrorMax > SCENARIO_TERRAIN_MAX_ERROR_M) {
+            printf("  FAIL: DEM lookups do not match the ground\n");
+            passed = false;
+        }
+    }
+
+    uint32_t expectedFrames = _rtcmFramesSent - _rtcmFramesCorrupted;
+    printf("RTCM: %lu frames sent (%lu corrupted) -> %lu framed, %lu CRC errors, %lu bytes to GNSS (expected %lu)\n",
+           (unsigned long)_rtcmFramesSent, (unsigned long)_rtcmFramesCorrupted,
+           (unsigned long)_framer.getFrameCount(), (unsigned long)_framer.getCrcErrors(),
+           (unsigned long)devices.rtcmBytes, (unsigned long)_rtcmBytesGood);
+    if (_framer.getFrameCount() != expectedFrames || devices.rtcmBytes != _rtcmBytesGood) {
+        printf("  FAIL: RTCM frames lost or corrupted frames forwarded\n");
+        passed = false;
+    }
+
+    return passed;
+}
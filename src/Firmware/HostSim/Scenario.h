@@ -0,0 +1,148 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Synthetic Field Scenario
+ *
+ * A sprayer driving north across undulating ground:
+ * - Toughbook commands at 10Hz following a step or sine setpoint profile
+ * - 100Hz IMU reports from a truth trajectory with varying speed
+ * - XM125 ground and canopy peaks from terrain under the boom, with
+ *   optional dropouts (no usable peak)
+ * - NAV-PVT + HPPOSLLH epochs at the rate the firmware configured,
+ *   delivered 40ms after the epoch, TIMEPULSE at every whole GPS second
+ * - RTCM3 frames with valid CRC24Q, optionally corrupted, pushed through
+ *   RtcmFramer in random-sized chunks like UDP datagrams
+ * - Optionally a field DEM of the same ground on SD, for TerrainPreview
+ *
+ * Reports ram tracking against the commands (measured in the simulator
+ * loop), radar error and validity against terrain truth, dead-reckoning
+ * position error (wing roles), GNSS fix validity, terrain preview uptime and
+ * DEM lookups against terrain truth, and RTCM frame accounting.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_SCENARIO_H
+#define HOST_SCENARIO_H
+
+#include "SimSource.h"
+#include "HostDevices.h"
+#include "RtcmFramer.h"
+#include <random>
+
+#define SCENARIO_COMMAND_PERIOD_US  100000  // 10Hz Toughbook commands
+#define SCENARIO_IMU_PERIOD_US      10000   // 100Hz rotation vector
+#define SCENARIO_GNSS_LATENCY_US    40000   // Epoch to PVT/HPPOSLLH arrival (rate set by the firmware)
+#define SCENARIO_RTCM_PERIOD_US     1000000 // One correction burst per second
+#define SCENARIO_GPS_START_TOW_MS   216000000UL // Tuesday 12:00 GPS time
+
+#define SCENARIO_BOOM_HEIGHT_M      1.0f    // Nominal radar height
+#define SCENARIO_CANOPY_DEPTH_M     0.30f   // Crop canopy above ground
+#define SCENARIO_ORIGIN_LAT         -34.0
+#define SCENARIO_ORIGIN_LON         148.0
+#define SCENARIO_ORIGIN_ALT_M       300.0
+
+// Field DEM (--terrain) - the strip under the run, boom width either side
+#define SCENARIO_DEM_RESOLUTION_M   0.25f
+#define SCENARIO_DEM_HALF_WIDTH_M   16.0f
+#define SCENARIO_DEM_MARGIN_M       20.0f   // Behind the start and past the end of the run
+#define SCENARIO_DEM_METRES_PER_DEG 111320.0    // TerrainPreview's local frame, from the DEM spec
+#define SCENARIO_TERRAIN_MIN_ACTIVE 0.90f   // Fraction of moving time the preview must be ACTIVE
+#define SCENARIO_TERRAIN_SPEED_MPS  1.0f    // Checked only well above the preview's minimum speed
+#define SCENARIO_TERRAIN_MAX_ERROR_M 0.005f
+
+typedef enum {
+    SCENARIO_PROFILE_STEPS = 0,     // Alternating setpoint steps every 5s
+    SCENARIO_PROFILE_SINE = 1,      // 8s period sine about mid stroke
+    SCENARIO_PROFILE_HOLD = 2       // Mid stroke throughout
+} ScenarioProfile_t;
+
+struct ScenarioConfig {
+    uint32_t durationMs = 30000;
+    ScenarioProfile_t profile = SCENARIO_PROFILE_STEPS;
+    float stepAmplitude = 15.0f;    // % either side of mid stroke
+    float speedMps = 5.0f;          // Mean ground speed
+    float radarDropout = 0.0f;      // Fraction of measurements with no peak
+    float rtcmCorruption = 0.0f;    // Fraction of frames with a flipped byte
+    bool terrain = false;           // Field DEM on SD, terrain preview checked against it
+};
+
+class Scenario : public SimSource {
+public:
+    explicit Scenario(const ScenarioConfig& config);
+
+    const char* getName() const override { return "scenario"; }
+    bool begin(SimContext& context) override;
+    void update(uint64_t nowMicros) override;
+    bool isFinished(uint64_t nowMicros) const override;
+    bool getSetpoints(float setpoints[3]) const override;
+    bool report() override;
+
+    // Write the DEM of the scenario's ground to the SD card (before setup())
+    bool writeTerrainDem() const;
+
+private:
+    ScenarioConfig _config;
+    SimContext _context;
+    std::mt19937 _random;
+    RtcmFramer _framer;
+
+    uint64_t _startMicros;
+    uint64_t _endMicros;
+    uint32_t _lastRadarSample;
+    uint32_t _lastFusionSample;
+    uint64_t _nextCommand, _nextImu, _nextGnss, _nextPulse, _nextRtcm;
+    uint32_t _commandId;
+    float _setpoints[3];
+    bool _haveSetpoints;
+
+    // Radar accounting
+    uint32_t _radarSamples, _radarValid, _radarDropouts;
+    double _radarErrorSum;
+    float _radarErrorMax;
+
+    // Dead-reckoning accounting (wing roles)
+    uint32_t _fusionSamples, _fusionValid;
+    double _fusionErrorSum;
+    float _fusionErrorMax;
+
+    // GNSS fix accounting - published epochs the firmware took as a valid fix
+    uint32_t _gnssSamples, _gnssValid;
+    uint32_t _lastGnssMillis;
+
+    // Terrain preview accounting - loop passes while moving, from the first published epoch
+    uint32_t _terrainChecks, _terrainActive;
+    uint32_t _terrainSamples;
+    double _terrainErrorSum;
+    float _terrainErrorMax;
+    float _terrainFeedForwardMax;
+
+    // RTCM accounting
+    uint32_t _rtcmFramesSent, _rtcmFramesCorrupted, _rtcmBytesGood;
+
+    // Truth - closed form in time since begin(), so any event can sample it
+    double elapsed(uint64_t micros) const { return (double)(micros - _startMicros) * 1e-6; }
+    double speedVariation() const;  // Standing still stays still
+    double truthNorth(double t) const;
+    double truthSpeed(double t) const;
+    static double groundHeight(double north);   // Above the origin altitude
+    float truthAccel(double t) const;
+    float groundDistance(double t) const;   // Radar to ground
+    float canopyDensity(double t) const;    // 0-1, canopy echo strength
+    uint64_t localToVirtual(uint32_t micros) const;
+    void setpointsAt(double t, float setpoints[3]) const;
+
+    void sendCommand(uint64_t at);
+    void sendImu(uint64_t at);
+    void sendGnss(uint64_t epochAt);
+    void sendRtcm(uint64_t at);
+    HostRadarPeaks measureRadar();
+    void checkRadar();
+    void checkFusion();
+    void checkGnss();
+    void checkTerrain();
+
+    static void onRtcmFrame(const uint8_t* frame, size_t len, uint16_t messageType, void* context);
+};
+
+#endif // HOST_SCENARIO_H
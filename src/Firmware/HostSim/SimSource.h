@@ -0,0 +1,57 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Stimulus Sources
+ *
+ * A source drives the simulated module's inputs - Toughbook commands,
+ * IMU reports, radar peaks, GNSS epochs and RTCM - either synthesised
+ * (Scenario) or from a black-box recording (ReplaySource). Sources
+ * schedule device events on the HostHal clock a little ahead of the
+ * simulator loop, so everything arrives at its own time regardless of
+ * how fast the host runs.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_SIM_SOURCE_H
+#define HOST_SIM_SOURCE_H
+
+#include <Arduino.h>
+
+class SensorManager;
+class HydraulicController;
+class PlantModel;
+class TerrainPreview;
+
+#define SIM_LOOKAHEAD_US    50000   // Sources schedule this far ahead of the loop
+
+struct SimContext {
+    SensorManager* sensors;
+    HydraulicController* hydraulics;
+    PlantModel* plant;          // nullptr when ram positions come from a recording
+    TerrainPreview* terrain;    // nullptr unless the source put a field DEM on SD
+    uint32_t seed;
+    bool verbose;
+};
+
+class SimSource {
+public:
+    virtual ~SimSource() {}
+
+    virtual const char* getName() const = 0;
+
+    // Called once after setup(), at the current virtual time
+    virtual bool begin(SimContext& context) = 0;
+
+    // Schedule events up to now + SIM_LOOKAHEAD_US
+    virtual void update(uint64_t nowMicros) = 0;
+    virtual bool isFinished(uint64_t nowMicros) const = 0;
+
+    // Ram setpoints the source last commanded (centre, left, right)
+    virtual bool getSetpoints(float setpoints[3]) const = 0;
+
+    // Print the source's own results; false if a regression check failed
+    virtual bool report() = 0;
+};
+
+#endif // HOST_SIM_SOURCE_H
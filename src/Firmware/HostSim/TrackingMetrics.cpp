@@ -0,0 +1,61 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Ram Tracking Metrics Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "TrackingMetrics.h"
+
+TrackingMetrics::TrackingMetrics() : _rams(), _settleMicros(0), _startMicros(0), _lastMicros(0) {
+    for (auto& ram : _rams) {
+        ram.lastSetpoint = 50.0f;   // Rams start at mid stroke
+        ram.lastPwm = -1;
+    }
+}
+
+void TrackingMetrics::sample(uint64_t nowMicros, const float setpoints[3], const float positions[3],
+                             const int pwm[3], unsigned int pwmResolution) {
+    if (_startMicros == 0) _startMicros = nowMicros;
+    float dt = (_lastMicros == 0) ? 0.0f : (nowMicros - _lastMicros) * 1e-6f;
+    _lastMicros = nowMicros;
+    bool settled = nowMicros - _startMicros >= _settleMicros;
+    float fullScale = (float)((1u << pwmResolution) - 1);
+
+    for (int i = 0; i < 3; i++) {
+        RamTracking& ram = _rams[i];
+
+        // A new setpoint re-arms the overshoot measurement for that move
+        if (setpoints[i] != ram.lastSetpoint) {
+            float change = setpoints[i] - ram.lastSetpoint;
+            ram.travelDirection = (fabsf(change) > 0.5f) ? (change > 0 ? 1.0f : -1.0f) : ram.travelDirection;
+            ram.lastSetpoint = setpoints[i];
+        }
+
+        if (ram.lastPwm >= 0) ram.valveActivity += fabsf((float)(pwm[i] - ram.lastPwm)) / fullScale;
+        ram.lastPwm = pwm[i];
+
+        if (!settled) continue;
+
+        float error = setpoints[i] - positions[i];
+        ram.samples++;
+        ram.integralAbsError += fabsf(error) * dt;
+        ram.sumSquaredError += (double)error * error;
+        if (fabsf(error) > ram.maxAbsError) ram.maxAbsError = fabsf(error);
+
+        float overshoot = -error * ram.travelDirection;
+        if (overshoot > ram.maxOvershoot) ram.maxOvershoot = overshoot;
+    }
+}
+
+void TrackingMetrics::print() const {
+    static const char* names[3] = { "Centre", "Left", "Right" };
+    printf("\nRam tracking          IAE(%%.s)  RMS(%%)  max(%%)  overshoot(%%)  valve activity\n");
+    for (int i = 0; i < 3; i++) {
+        const RamTracking& ram = _rams[i];
+        if (ram.samples == 0) continue;
+        printf("  %-7s           %9.2f  %7.2f  %7.2f  %12.2f  %14.1f\n", names[i], ram.integralAbsError,
+               sqrt(ram.sumSquaredError / ram.samples), ram.maxAbsError, ram.maxOvershoot, ram.valveActivity);
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host Simulator - Ram Tracking Metrics
+ *
+ * Figures of merit for comparing controller variants on one run, sampled
+ * every simulator loop against the source's commanded setpoints:
+ * - IAE and RMS error, from the plant's true position when it is
+ *   attached, otherwise from the controller's own measured position
+ * - Worst overshoot past a setpoint in the direction of travel
+ * - Valve activity (sum of PWM changes, full scale = 1) - chatter costs
+ *   coils and spool wear long before it shows in the tracking error
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_TRACKING_METRICS_H
+#define HOST_TRACKING_METRICS_H
+
+#include <Arduino.h>
+
+struct RamTracking {
+    uint32_t samples;
+    double integralAbsError;    // %.s
+    double sumSquaredError;     // %^2
+    float maxAbsError;
+    float maxOvershoot;         // % past the setpoint
+    double valveActivity;       // Full-scale PWM swings
+    float lastSetpoint;
+    float travelDirection;      // +1 extending, -1 retracting, 0 unknown
+    int lastPwm;
+};
+
+class TrackingMetrics {
+public:
+    TrackingMetrics();
+
+    void sample(uint64_t nowMicros, const float setpoints[3], const float positions[3], const int pwm[3],
+                unsigned int pwmResolution);
+    const RamTracking& get(uint8_t ram) const { return _rams[ram]; }
+
+    // Skip the first part of the run (bumpless start from mid stroke)
+    void setSettleMicros(uint64_t micros) { _settleMicros = micros; }
+
+    void print() const;
+
+private:
+    RamTracking _rams[3];
+    uint64_t _settleMicros;
+    uint64_t _startMicros;
+    uint64_t _lastMicros;
+};
+
+#endif // HOST_TRACKING_METRICS_H
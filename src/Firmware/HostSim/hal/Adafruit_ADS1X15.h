@@ -0,0 +1,79 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - ADS1115 ADC
+ *
+ * Register-level behaviour the hydraulic controller depends on:
+ * - startADCReading() (re)starts conversion on a mux; in continuous mode
+ *   conversions repeat at the programmed data rate
+ * - Each completed conversion latches a sample from the simulator
+ *   (HostDevices::setAdcSource()) and pulses ALERT/RDY (pin 23) low
+ * - readADC_SingleEnded() blocks for one conversion time, as on the bus
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_ADAFRUIT_ADS1X15_H
+#define HOST_ADAFRUIT_ADS1X15_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define ADS1X15_ADDRESS                 0x48
+
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_0 0x4000
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_1 0x5000
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_2 0x6000
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_3 0x7000
+
+#define RATE_ADS1115_8SPS               0x0000
+#define RATE_ADS1115_16SPS              0x0020
+#define RATE_ADS1115_32SPS              0x0040
+#define RATE_ADS1115_64SPS              0x0060
+#define RATE_ADS1115_128SPS             0x0080
+#define RATE_ADS1115_250SPS             0x00A0
+#define RATE_ADS1115_475SPS             0x00C0
+#define RATE_ADS1115_860SPS             0x00E0
+
+#define ADS_HOST_RDY_PIN                23
+
+typedef enum {
+    GAIN_TWOTHIRDS = 0x0000,
+    GAIN_ONE = 0x0200,
+    GAIN_TWO = 0x0400,
+    GAIN_FOUR = 0x0600,
+    GAIN_EIGHT = 0x0800,
+    GAIN_SIXTEEN = 0x0A00
+} adsGain_t;
+
+class Adafruit_ADS1115 {
+public:
+    Adafruit_ADS1115();
+
+    bool begin(uint8_t address = ADS1X15_ADDRESS, TwoWire* wire = &Wire);
+    void setGain(adsGain_t gain) { _gain = gain; }
+    adsGain_t getGain() const { return _gain; }
+    void setDataRate(uint16_t rate) { _rate = rate; }
+    uint16_t getDataRate() const { return _rate; }
+
+    int16_t readADC_SingleEnded(uint8_t channel);
+    void startADCReading(uint16_t mux, bool continuous);
+    bool conversionComplete() const { return _complete; }
+    int16_t getLastConversionResults() const { return _lastResult; }
+
+    uint32_t getConversionMicros() const;
+
+private:
+    adsGain_t _gain;
+    uint16_t _rate;
+    uint8_t _channel;
+    bool _continuous;
+    bool _complete;
+    int16_t _lastResult;
+    uint32_t _generation;       // Bumped by each restart so stale completions are dropped
+
+    void scheduleConversion();
+    void completeConversion(uint32_t generation);
+};
+
+#endif // HOST_ADAFRUIT_ADS1X15_H
@@ -0,0 +1,80 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - Adafruit GFX
+ *
+ * Drawing surface for the simulated OLED. Lines and rectangles are drawn
+ * into the display buffer; text only advances the cursor (no font on the
+ * host), which is enough for the firmware's page layout to run unchanged.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+        // Bresenham
+        int16_t dx = abs(x1 - x0), dy = -abs(y1 - y0);
+        int16_t sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+        int16_t err = dx + dy;
+        for (;;) {
+            drawPixel(x0, y0, color);
+            if (x0 == x1 && y0 == y1) break;
+            int16_t e2 = 2 * err;
+            if (e2 >= dy) { err += dy; x0 += sx; }
+            if (e2 <= dx) { err += dx; y0 += sy; }
+        }
+    }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        for (int16_t j = y; j < y + h; j++)
+            for (int16_t i = x; i < x + w; i++) drawPixel(i, j, color);
+    }
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        drawFastHLine(x, y, w, color);
+        drawFastHLine(x, y + h - 1, w, color);
+        drawFastVLine(x, y, h, color);
+        drawFastVLine(x + w - 1, y, h, color);
+    }
+    void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+    void setTextSize(uint8_t size) { _textSize = size ? size : 1; }
+    void setTextColor(uint16_t color) { _textColor = color; }
+    void setTextColor(uint16_t color, uint16_t) { _textColor = color; }
+    void setTextWrap(bool) {}
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    using Print::write;
+    size_t write(uint8_t c) override {
+        // 6x8 character cell per text size step, as the built-in font
+        if (c == '\n') {
+            _cursorX = 0;
+            _cursorY += 8 * _textSize;
+        } else if (c != '\r') {
+            _cursorX += 6 * _textSize;
+        }
+        return 1;
+    }
+
+protected:
+    int16_t _width, _height;
+    int16_t _cursorX = 0, _cursorY = 0;
+    uint8_t _textSize = 1;
+    uint16_t _textColor = 1;
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
@@ -0,0 +1,56 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - SSD1306 OLED
+ *
+ * 1bpp display buffer in the SSD1306 page layout. display() counts
+ * refreshes instead of sending them anywhere.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_ADAFRUIT_SSD1306_H
+#define HOST_ADAFRUIT_SSD1306_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "Adafruit_GFX.h"
+#include <vector>
+
+#define SSD1306_BLACK           0
+#define SSD1306_WHITE           1
+#define SSD1306_INVERSE         2
+#define SSD1306_SWITCHCAPVCC    0x02
+#define SSD1306_EXTERNALVCC     0x01
+#define SSD1306_COLUMNADDR      0x21
+#define SSD1306_PAGEADDR        0x22
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* = &Wire, int8_t = -1, uint32_t = 400000UL, uint32_t = 100000UL)
+        : Adafruit_GFX(w, h), _buffer((size_t)w * ((h + 7) / 8), 0) {}
+
+    bool begin(uint8_t = SSD1306_SWITCHCAPVCC, uint8_t = 0x3C, bool = true, bool = true) { return true; }
+    void clearDisplay() { std::fill(_buffer.begin(), _buffer.end(), 0); }
+    void display() { _refreshCount++; }
+    void dim(bool) {}
+    void invertDisplay(bool) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+        uint8_t& cell = _buffer[x + (y / 8) * _width];
+        uint8_t bit = (uint8_t)(1 << (y & 7));
+        if (color == SSD1306_WHITE) cell |= bit;
+        else if (color == SSD1306_INVERSE) cell ^= bit;
+        else cell &= (uint8_t)~bit;
+    }
+
+    uint8_t* getBuffer() { return _buffer.data(); }
+    uint32_t getRefreshCount() const { return _refreshCount; }
+
+private:
+    std::vector<uint8_t> _buffer;
+    uint32_t _refreshCount = 0;
+};
+
+#endif // HOST_ADAFRUIT_SSD1306_H
@@ -0,0 +1,207 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - Teensy Core
+ *
+ * Stands in for the Teensy 4.1 core when the firmware is built on a PC:
+ * - millis()/micros() read the simulator's virtual clock
+ * - delay() advances it, running any timer and pin interrupts that fall due
+ * - Pins, PWM and attachInterrupt() are routed through HostHal
+ * - IntervalTimer callbacks are scheduled on the virtual clock
+ * - ARM_DWT_CYCCNT reads host nanoseconds, so LoopProfiler reports host cost
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdarg>
+#include <algorithm>
+#include <type_traits>
+#include "WString.h"
+
+using std::abs;
+using std::isnan;     // math.h macros on the Teensy
+using std::isinf;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// Pins
+#define LOW             0
+#define HIGH            1
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define INPUT_PULLDOWN  3
+#define CHANGE          4
+#define FALLING         2
+#define RISING          3
+#define LED_BUILTIN     13
+
+// Maths
+#ifndef PI
+#define PI              3.1415926535897932384626433832795
+#endif
+#define HALF_PI         1.5707963267948966192313216916398
+#define TWO_PI          6.283185307179586476925286766559
+#define DEG_TO_RAD      0.017453292519943295769236907684886
+#define RAD_TO_DEG      57.295779513082320876798154814105
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define radians(deg)    ((deg) * DEG_TO_RAD)
+#define degrees(rad)    ((rad) * RAD_TO_DEG)
+#define sq(x)           ((x) * (x))
+
+template <typename A, typename B>
+constexpr auto min(A a, B b) -> typename std::common_type<A, B>::type { return (b < a) ? b : a; }
+template <typename A, typename B>
+constexpr auto max(A a, B b) -> typename std::common_type<A, B>::type { return (a < b) ? b : a; }
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Memory placement attributes have no meaning on the host
+#define FLASHMEM
+#define PROGMEM
+#define DMAMEM
+#define EXTMEM
+#define FASTRUN
+#define F(text)         (text)
+
+// Time - virtual, see HostHal
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+
+// Pins and interrupts
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void analogWriteResolution(unsigned int bits);
+void analogWriteFrequency(uint8_t pin, float frequency);
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// The simulator is single threaded - interrupts only run between foreground
+// calls and inside delay(), so there is nothing to mask
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+#define MEMORY_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// DWT cycle counter - host nanoseconds
+uint32_t hostCycleCount();
+extern uint32_t hostDebugRegister;
+#define ARM_DWT_CYCCNT          (hostCycleCount())
+#define ARM_DEMCR               hostDebugRegister
+#define ARM_DWT_CTRL            hostDebugRegister
+#define ARM_DEMCR_TRCENA        (1 << 24)
+#define ARM_DWT_CTRL_CYCCNTENA  (1 << 0)
+#define F_CPU_ACTUAL            1000000000UL
+#define F_CPU                   F_CPU_ACTUAL
+
+// Print and serial ports
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const char* s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(long long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned long long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(double value, int digits = 2) { return print(String(value, (unsigned char)digits)); }
+
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+    size_t println() { return write((const uint8_t*)"\r\n", 2); }
+
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        write((const uint8_t*)buffer, strlen(buffer));
+        return len;
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    virtual void flush() {}
+};
+
+// USB serial and UARTs: output goes to the console when HostHal::setSerialEcho()
+// is on, input is always empty
+class HostSerial : public Stream {
+public:
+    explicit HostSerial(bool console) : _console(console) {}
+    void begin(unsigned long) {}
+    void end() {}
+    explicit operator bool() const { return true; }
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+private:
+    bool _console;          // Only the USB port is echoed
+};
+
+extern HostSerial Serial;
+extern HostSerial Serial1;
+extern HostSerial Serial2;
+
+// The Teensy UARTs all derive from HardwareSerial
+typedef HostSerial HardwareSerial;
+
+// IntervalTimer - periodic callback on the virtual clock
+class IntervalTimer {
+public:
+    IntervalTimer() : _id(-1) {}
+    ~IntervalTimer() { end(); }
+    bool begin(void (*callback)(), uint32_t periodMicros);
+    void end();
+    void priority(uint8_t) {}
+    void update(uint32_t periodMicros);
+
+private:
+    int _id;
+};
+
+#endif // HOST_ARDUINO_H
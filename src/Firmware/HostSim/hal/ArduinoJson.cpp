@@ -0,0 +1,167 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - ArduinoJson Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "ArduinoJson.h"
+#include <stdlib.h>
+
+namespace {
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : _text(text), _at(0) {}
+
+    DeserializationError::Code parse(JsonValue* root) {
+        skipSpace();
+        if (_at >= _text.size()) return DeserializationError::EmptyInput;
+        return parseValue(root);
+    }
+
+private:
+    const std::string& _text;
+    size_t _at;
+
+    void skipSpace() {
+        while (_at < _text.size() && isspace((unsigned char)_text[_at])) _at++;
+    }
+
+    bool take(char c) {
+        skipSpace();
+        if (_at < _text.size() && _text[_at] == c) {
+            _at++;
+            return true;
+        }
+        return false;
+    }
+
+    DeserializationError::Code incompleteOr(DeserializationError::Code code) const {
+        return _at >= _text.size() ? DeserializationError::IncompleteInput : code;
+    }
+
+    DeserializationError::Code parseValue(JsonValue* value) {
+        skipSpace();
+        if (_at >= _text.size()) return DeserializationError::IncompleteInput;
+
+        char c = _text[_at];
+        if (c == '{') return parseObject(value);
+        if (c == '[') return parseArray(value);
+        if (c == '"') {
+            value->type = JSON_STRING;
+            return parseString(&value->text);
+        }
+        if (literal("true")) { value->type = JSON_BOOLEAN; value->boolean = true; return DeserializationError::Ok; }
+        if (literal("false")) { value->type = JSON_BOOLEAN; value->boolean = false; return DeserializationError::Ok; }
+        if (literal("null")) { value->type = JSON_NULL; return DeserializationError::Ok; }
+
+        const char* start = _text.c_str() + _at;
+        char* end = nullptr;
+        double number = strtod(start, &end);
+        if (end == start) return DeserializationError::InvalidInput;
+        _at += (size_t)(end - start);
+        value->type = JSON_NUMBER;
+        value->number = number;
+        return DeserializationError::Ok;
+    }
+
+    bool literal(const char* word) {
+        size_t length = strlen(word);
+        if (_text.compare(_at, length, word) != 0) return false;
+        _at += length;
+        return true;
+    }
+
+    DeserializationError::Code parseString(std::string* out) {
+        _at++; // Opening quote
+        while (_at < _text.size()) {
+            char c = _text[_at++];
+            if (c == '"') return DeserializationError::Ok;
+            if (c != '\\') {
+                out->push_back(c);
+                continue;
+            }
+            if (_at >= _text.size()) break;
+            char escaped = _text[_at++];
+            switch (escaped) {
+                case 'b': out->push_back('\b'); break;
+                case 'f': out->push_back('\f'); break;
+                case 'n': out->push_back('\n'); break;
+                case 'r': out->push_back('\r'); break;
+                case 't': out->push_back('\t'); break;
+                case 'u':
+                    // No key the firmware reads needs more than ASCII
+                    if (_at + 4 > _text.size()) return DeserializationError::IncompleteInput;
+                    out->push_back('?');
+                    _at += 4;
+                    break;
+                default: out->push_back(escaped); break;
+            }
+        }
+        return DeserializationError::IncompleteInput;
+    }
+
+    DeserializationError::Code parseArray(JsonValue* value) {
+        _at++;
+        value->type = JSON_ARRAY;
+        if (take(']')) return DeserializationError::Ok;
+        do {
+            value->values.emplace_back();
+            DeserializationError::Code code = parseValue(&value->values.back());
+            if (code != DeserializationError::Ok) return code;
+        } while (take(','));
+        return take(']') ? DeserializationError::Ok : incompleteOr(DeserializationError::InvalidInput);
+    }
+
+    DeserializationError::Code parseObject(JsonValue* value) {
+        _at++;
+        value->type = JSON_OBJECT;
+        if (take('}')) return DeserializationError::Ok;
+        do {
+            skipSpace();
+            if (_at >= _text.size()) return DeserializationError::IncompleteInput;
+            if (_text[_at] != '"') return DeserializationError::InvalidInput;
+            value->keys.emplace_back();
+            DeserializationError::Code code = parseString(&value->keys.back());
+            if (code != DeserializationError::Ok) return code;
+            if (!take(':')) return incompleteOr(DeserializationError::InvalidInput);
+            value->values.emplace_back();
+            code = parseValue(&value->values.back());
+            if (code != DeserializationError::Ok) return code;
+        } while (take(','));
+        return take('}') ? DeserializationError::Ok : incompleteOr(DeserializationError::InvalidInput);
+    }
+};
+
+} // namespace
+
+JsonVariantConst JsonVariantConst::operator[](const char* key) const {
+    if (!_value || _value->type != JSON_OBJECT || !key) return JsonVariantConst();
+    for (size_t i = 0; i < _value->keys.size(); i++) {
+        if (_value->keys[i] == key) return JsonVariantConst(&_value->values[i]);
+    }
+    return JsonVariantConst();
+}
+
+const char* DeserializationError::c_str() const {
+    switch (_code) {
+        case Ok: return "Ok";
+        case EmptyInput: return "EmptyInput";
+        case IncompleteInput: return "IncompleteInput";
+        case InvalidInput: return "InvalidInput";
+        default: return "Unknown";
+    }
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input) {
+    std::string text;
+    int c;
+    while ((c = input.read()) >= 0) text.push_back((char)c);
+
+    doc.clear();
+    DeserializationError::Code code = JsonParser(text).parse(&doc._root);
+    if (code != DeserializationError::Ok) doc.clear();
+    return DeserializationError(code);
+}
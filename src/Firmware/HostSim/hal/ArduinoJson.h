@@ -0,0 +1,89 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - ArduinoJson
+ *
+ * The slice of the ArduinoJson 7 API the firmware uses to read small
+ * configuration files (TerrainPreview's metadata.json):
+ * - deserializeJson() from a File or any Stream into a JsonDocument
+ * - Member lookup by key, nested, and `doc["Key"] | fallback` for numbers
+ *   and booleans - a missing key or the wrong type gives the fallback
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_ARDUINO_JSON_H
+#define HOST_ARDUINO_JSON_H
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+typedef enum {
+    JSON_NULL = 0,
+    JSON_BOOLEAN,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+} JsonType_t;
+
+struct JsonValue {
+    JsonType_t type = JSON_NULL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<std::string> keys;      // Object member names, in order
+    std::vector<JsonValue> values;      // Object members or array elements
+};
+
+class DeserializationError {
+public:
+    typedef enum {
+        Ok = 0,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput
+    } Code;
+
+    DeserializationError(Code code = Ok) : _code(code) {}
+    explicit operator bool() const { return _code != Ok; }
+    Code code() const { return _code; }
+    const char* c_str() const;
+
+private:
+    Code _code;
+};
+
+class JsonVariantConst {
+public:
+    JsonVariantConst() : _value(nullptr) {}
+    explicit JsonVariantConst(const JsonValue* value) : _value(value) {}
+
+    JsonVariantConst operator[](const char* key) const;
+    bool isNull() const { return !_value || _value->type == JSON_NULL; }
+
+    double operator|(double fallback) const { return isNumber() ? _value->number : fallback; }
+    float operator|(float fallback) const { return isNumber() ? (float)_value->number : fallback; }
+    int operator|(int fallback) const { return isNumber() ? (int)_value->number : fallback; }
+    bool operator|(bool fallback) const { return (_value && _value->type == JSON_BOOLEAN) ? _value->boolean : fallback; }
+
+private:
+    bool isNumber() const { return _value && _value->type == JSON_NUMBER; }
+
+    const JsonValue* _value;
+};
+
+class JsonDocument {
+public:
+    JsonVariantConst operator[](const char* key) const { return JsonVariantConst(&_root)[key]; }
+    void clear() { _root = JsonValue(); }
+
+private:
+    friend DeserializationError deserializeJson(JsonDocument& doc, Stream& input);
+    JsonValue _root;
+};
+
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input);
+
+#endif // HOST_ARDUINO_JSON_H
@@ -0,0 +1,31 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - EEPROM Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "EEPROM.h"
+#include <string.h>
+
+namespace {
+
+struct ErasedEeprom {
+    uint8_t data[HOST_EEPROM_SIZE];
+    ErasedEeprom() { memset(data, 0xFF, sizeof(data)); }
+};
+
+ErasedEeprom g_eeprom;
+
+} // namespace
+
+EEPROMClass EEPROM;
+
+uint8_t EEPROMClass::read(int address) const {
+    return (address >= 0 && address < HOST_EEPROM_SIZE) ? g_eeprom.data[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (address >= 0 && address < HOST_EEPROM_SIZE) g_eeprom.data[address] = value;
+}
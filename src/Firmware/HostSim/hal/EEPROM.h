@@ -0,0 +1,43 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - EEPROM
+ *
+ * Teensy 4.1 EEPROM emulation as a RAM array, erased (0xFF) at start-up -
+ * every simulator run is a first boot.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <Arduino.h>
+
+#define HOST_EEPROM_SIZE    4284
+
+class EEPROMClass {
+public:
+    uint8_t read(int address) const;
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value) { write(address, value); }
+    uint16_t length() const { return HOST_EEPROM_SIZE; }
+
+    template <typename T>
+    T& get(int address, T& value) const {
+        uint8_t* bytes = (uint8_t*)&value;
+        for (size_t i = 0; i < sizeof(T); i++) bytes[i] = read(address + (int)i);
+        return value;
+    }
+
+    template <typename T>
+    const T& put(int address, const T& value) {
+        const uint8_t* bytes = (const uint8_t*)&value;
+        for (size_t i = 0; i < sizeof(T); i++) write(address + (int)i, bytes[i]);
+        return value;
+    }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // HOST_EEPROM_H
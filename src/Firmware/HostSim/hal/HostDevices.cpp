@@ -0,0 +1,421 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - Simulated Devices Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "HostDevices.h"
+#include "HostHal.h"
+#include <deque>
+#include <map>
+
+namespace {
+
+HostDevices::AdcSource g_adcSource;
+HostDevices::RadarSource g_radarSource;
+std::deque<HostImuReport> g_imuQueue;
+std::deque<UBX_NAV_HPPOSLLH_data_t> g_gnssQueue;
+std::deque<UBX_NAV_PVT_data_t> g_pvtQueue;
+std::map<uint32_t, uint32_t> g_gnssConfig;     // Receiver flash - survives reset()
+HostDeviceStats g_stats;
+
+int16_t sampleAdc(uint8_t channel) {
+    return g_adcSource ? g_adcSource(channel) : 0;
+}
+
+HostRadarPeaks sampleRadar() {
+    if (g_radarSource) return g_radarSource();
+    HostRadarPeaks none = {};
+    none.measureDistanceError = 1;
+    return none;
+}
+
+} // namespace
+
+// --- Simulator hooks ---
+
+void HostDevices::setAdcSource(AdcSource source) {
+    g_adcSource = std::move(source);
+}
+
+void HostDevices::pushImuReport(const HostImuReport& report) {
+    g_imuQueue.push_back(report);
+    g_stats.imuReportsQueued++;
+    HostHal::setInput(BNO_HOST_INT_PIN, LOW);
+}
+
+size_t HostDevices::getImuQueueDepth() {
+    return g_imuQueue.size();
+}
+
+void HostDevices::setRadarSource(RadarSource source) {
+    g_radarSource = std::move(source);
+}
+
+void HostDevices::pushGnssEpoch(const UBX_NAV_HPPOSLLH_data_t& epoch) {
+    g_gnssQueue.push_back(epoch);
+}
+
+void HostDevices::pushGnssPvt(const UBX_NAV_PVT_data_t& pvt) {
+    g_pvtQueue.push_back(pvt);
+}
+
+bool HostDevices::getGnssConfig(uint32_t key, uint32_t* value) {
+    auto it = g_gnssConfig.find(key);
+    if (it == g_gnssConfig.end()) return false;
+    *value = it->second;
+    return true;
+}
+
+uint64_t HostDevices::getGnssEpochPeriodMicros() {
+    uint32_t measMs = 1000;
+    getGnssConfig(UBLOX_CFG_RATE_MEAS, &measMs);
+    return (uint64_t)(measMs ? measMs : 1000) * 1000ULL;
+}
+
+void HostDevices::pulseTimepulse() {
+    g_stats.gnssTimepulses++;
+    HostHal::setInput(GNSS_HOST_TIMEPULSE_PIN, HIGH);
+    HostHal::schedule(HostHal::now() + GNSS_HOST_PULSE_WIDTH_US, [] {
+        HostHal::setInput(GNSS_HOST_TIMEPULSE_PIN, LOW);
+    });
+}
+
+const HostDeviceStats& HostDevices::getStats() {
+    return g_stats;
+}
+
+void HostDevices::reset() {
+    g_imuQueue.clear();
+    g_gnssQueue.clear();
+    g_pvtQueue.clear();
+    g_stats = HostDeviceStats();
+    // TIMEPULSE idles low between pulses
+    HostHal::setInput(GNSS_HOST_TIMEPULSE_PIN, LOW);
+}
+
+// --- ADS1115 ---
+
+Adafruit_ADS1115::Adafruit_ADS1115()
+    : _gain(GAIN_TWOTHIRDS), _rate(RATE_ADS1115_128SPS), _channel(0),
+      _continuous(false), _complete(false), _lastResult(0), _generation(0) {
+}
+
+bool Adafruit_ADS1115::begin(uint8_t, TwoWire*) {
+    return true;
+}
+
+uint32_t Adafruit_ADS1115::getConversionMicros() const {
+    static const uint16_t rates[8] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+    return 1000000UL / rates[(_rate >> 5) & 0x07];
+}
+
+int16_t Adafruit_ADS1115::readADC_SingleEnded(uint8_t channel) {
+    // Single-shot: the library polls the OS bit until the conversion is done
+    _generation++;
+    _continuous = false;
+    _channel = channel & 0x03;
+    delayMicroseconds(getConversionMicros());
+    _lastResult = sampleAdc(_channel);
+    g_stats.adcConversions++;
+    return _lastResult;
+}
+
+void Adafruit_ADS1115::startADCReading(uint16_t mux, bool continuous) {
+    _generation++;
+    _channel = (uint8_t)((mux >> 12) & 0x03);
+    _continuous = continuous;
+    _complete = false;
+    scheduleConversion();
+}
+
+void Adafruit_ADS1115::scheduleConversion() {
+    uint32_t generation = _generation;
+    HostHal::schedule(HostHal::now() + getConversionMicros(), [this, generation] {
+        completeConversion(generation);
+    });
+}
+
+void Adafruit_ADS1115::completeConversion(uint32_t generation) {
+    if (generation != _generation) return;  // Restarted since this was queued
+
+    _lastResult = sampleAdc(_channel);
+    _complete = true;
+    g_stats.adcConversions++;
+
+    // ALERT/RDY pulses low for ~8us
+    HostHal::setInput(ADS_HOST_RDY_PIN, LOW);
+    HostHal::setInput(ADS_HOST_RDY_PIN, HIGH);
+
+    if (_continuous && generation == _generation) scheduleConversion();
+}
+
+// --- BNO080 ---
+
+BNO080::BNO080() : shtpHeader(), shtpData(), _report() {
+}
+
+bool BNO080::begin(uint8_t, TwoWire&, uint8_t) {
+    return true;
+}
+
+uint16_t BNO080::getReadings() {
+    if (g_imuQueue.empty()) return 0;
+
+    _report = g_imuQueue.front();
+    g_imuQueue.pop_front();
+    g_stats.imuReportsRead++;
+
+    if (g_imuQueue.empty()) HostHal::setInput(BNO_HOST_INT_PIN, HIGH);
+    return _report.reportId;
+}
+
+bool BNO080::sendPacket(uint8_t channelNumber, uint8_t dataLength) {
+    // Only Set Feature on the control channel changes what receivePacket() serves
+    if (channelNumber != 2 || dataLength < 9 || shtpData[0] != 0xFD) return true;
+
+    uint32_t interval = (uint32_t)shtpData[5] | ((uint32_t)shtpData[6] << 8) |
+                        ((uint32_t)shtpData[7] << 16) | ((uint32_t)shtpData[8] << 24);
+    switch (shtpData[1]) {
+        case 0x2A: _gyroRvEnabled = interval != 0; break;
+        case SENSOR_REPORTID_ACCELEROMETER: _accelEnabled = interval != 0; break;
+        case SENSOR_REPORTID_LINEAR_ACCELERATION: _linAccelEnabled = interval != 0; break;
+    }
+    return true;
+}
+
+bool BNO080::receivePacket() {
+    if (_gyroRvPending) {
+        _gyroRvPending = false;
+        encodeGyroRv();
+    } else {
+        if (g_imuQueue.empty() || !_gyroRvEnabled) return false;
+        _report = g_imuQueue.front();
+        g_imuQueue.pop_front();
+        g_stats.imuReportsRead++;
+        encodeMotionBatch();
+        _gyroRvPending = true;
+    }
+
+    if (g_imuQueue.empty() && !_gyroRvPending) HostHal::setInput(BNO_HOST_INT_PIN, HIGH);
+    return true;
+}
+
+static void putFixed(uint8_t* bytes, float value, uint8_t qPoint) {
+    int16_t raw = (int16_t)lroundf(value * (float)(1 << qPoint));
+    bytes[0] = (uint8_t)raw;
+    bytes[1] = (uint8_t)(raw >> 8);
+}
+
+static void putHeader(uint8_t* header, uint16_t dataLength, uint8_t channel) {
+    uint16_t length = dataLength + 4;
+    header[0] = (uint8_t)length;
+    header[1] = (uint8_t)(length >> 8);
+    header[2] = channel;
+    header[3] = 0;
+}
+
+void BNO080::encodeMotionBatch() {
+    // Base timestamp (report is as old as the interrupt), then the motion reports
+    uint8_t length = 0;
+    shtpData[length++] = 0xFB;
+    for (int i = 0; i < 4; i++) shtpData[length++] = 0;
+
+    auto motionReport = [&](uint8_t reportId, float x, float y, float z, uint8_t accuracy) {
+        uint8_t* report = &shtpData[length];
+        report[0] = reportId;
+        report[1] = 0;
+        report[2] = accuracy & 0x03;
+        report[3] = 0;
+        putFixed(&report[4], x, 8);
+        putFixed(&report[6], y, 8);
+        putFixed(&report[8], z, 8);
+        length += 10;
+    };
+    if (_accelEnabled) {
+        motionReport(SENSOR_REPORTID_ACCELEROMETER, _report.accelX, _report.accelY, _report.accelZ, _report.accelAccuracy);
+    }
+    if (_linAccelEnabled) {
+        motionReport(SENSOR_REPORTID_LINEAR_ACCELERATION, _report.linAccelX, _report.linAccelY, _report.linAccelZ,
+                     _report.linAccelAccuracy);
+    }
+    putHeader(shtpHeader, length, 3);
+}
+
+void BNO080::encodeGyroRv() {
+    putFixed(&shtpData[0], _report.quatI, 14);
+    putFixed(&shtpData[2], _report.quatJ, 14);
+    putFixed(&shtpData[4], _report.quatK, 14);
+    putFixed(&shtpData[6], _report.quatReal, 14);
+    putFixed(&shtpData[8], _report.gyroX, 10);
+    putFixed(&shtpData[10], _report.gyroY, 10);
+    putFixed(&shtpData[12], _report.gyroZ, 10);
+    putHeader(shtpHeader, 14, 5);
+}
+
+// --- XM125 ---
+
+SparkFunXM125Distance::SparkFunXM125Distance()
+    : _start(0), _end(0), _sensitivity(0), _fixedThreshold(0),
+      _busyUntil(0), _measuring(false), _peaks() {
+}
+
+int32_t SparkFunXM125Distance::setCommand(uint32_t command) {
+    finishCommand();
+    switch (command) {
+        case SFE_XM125_DISTANCE_START_DETECTOR:
+            _busyUntil = HostHal::now() + measureMicros();
+            _measuring = true;
+            break;
+        case SFE_XM125_DISTANCE_RECALIBRATE:
+            _busyUntil = HostHal::now() + XM125_HOST_RECALIBRATE_US;
+            _peaks.calibrationNeeded = 0;
+            break;
+        default:
+            _busyUntil = HostHal::now() + 1000;
+            break;
+    }
+    return 0;
+}
+
+int32_t SparkFunXM125Distance::busyWait() {
+    if (HostHal::now() < _busyUntil) HostHal::runUntil(_busyUntil);
+    finishCommand();
+    return 0;
+}
+
+int32_t SparkFunXM125Distance::getDetectorStatus(uint32_t& status) {
+    finishCommand();
+    status = (HostHal::now() < _busyUntil) ? 0x80000000UL : 0;
+    return 0;
+}
+
+void SparkFunXM125Distance::finishCommand() {
+    if (!_measuring || HostHal::now() < _busyUntil) return;
+    _measuring = false;
+    _peaks = sampleRadar();
+    applyWindow();
+    g_stats.radarMeasurements++;
+}
+
+uint32_t SparkFunXM125Distance::measureMicros() const {
+    // Sweep time scales with the range covered
+    uint32_t length = (_end > _start) ? _end - _start : XM125_HOST_FULL_RANGE_MM;
+    if (length > XM125_HOST_FULL_RANGE_MM) length = XM125_HOST_FULL_RANGE_MM;
+    return XM125_HOST_MEASURE_BASE_US +
+           (uint32_t)((uint64_t)(XM125_HOST_MEASURE_US - XM125_HOST_MEASURE_BASE_US) * length / XM125_HOST_FULL_RANGE_MM);
+}
+
+void SparkFunXM125Distance::applyWindow() {
+    if (_end <= _start) return;
+    if (_peaks.peak1Distance != 0 && (_peaks.peak1Distance < _start || _peaks.peak1Distance > _end)) {
+        _peaks.peak1Distance = 0;
+        _peaks.peak1Strength = 0;
+    }
+    if (_peaks.peak0Distance != 0 && (_peaks.peak0Distance < _start || _peaks.peak0Distance > _end)) {
+        _peaks.peak0Distance = _peaks.peak1Distance;
+        _peaks.peak0Strength = _peaks.peak1Strength;
+        _peaks.peak1Distance = 0;
+        _peaks.peak1Strength = 0;
+    }
+}
+
+// --- u-blox GNSS ---
+
+SFE_UBLOX_GNSS_SERIAL::SFE_UBLOX_GNSS_SERIAL()
+    : _hpposllhCallback(nullptr), _pvtCallback(nullptr), _pendingKeys(), _pendingValues(), _pendingCount(0) {
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::begin(Stream&, uint16_t, bool) {
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::setAutoHPPOSLLHcallbackPtr(void (*callback)(UBX_NAV_HPPOSLLH_data_t*), uint8_t, uint16_t) {
+    _hpposllhCallback = callback;
+    g_gnssConfig[UBLOX_CFG_MSGOUT_UBX_NAV_HPPOSLLH_UART1] = 1;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::setAutoPVTcallbackPtr(void (*callback)(UBX_NAV_PVT_data_t*), uint8_t, uint16_t) {
+    _pvtCallback = callback;
+    g_gnssConfig[UBLOX_CFG_MSGOUT_UBX_NAV_PVT_UART1] = 1;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::setVal8(uint32_t key, uint8_t value, uint8_t, uint16_t) {
+    g_gnssConfig[key] = value;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::setVal32(uint32_t key, uint32_t value, uint8_t, uint16_t) {
+    g_gnssConfig[key] = value;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::getVal8(uint32_t key, uint8_t* value, uint8_t, uint16_t) {
+    uint32_t stored;
+    if (!HostDevices::getGnssConfig(key, &stored)) return false;
+    *value = (uint8_t)stored;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::getVal16(uint32_t key, uint16_t* value, uint8_t, uint16_t) {
+    uint32_t stored;
+    if (!HostDevices::getGnssConfig(key, &stored)) return false;
+    *value = (uint16_t)stored;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::getVal32(uint32_t key, uint32_t* value, uint8_t, uint16_t) {
+    return HostDevices::getGnssConfig(key, value);
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::newCfgValset(uint8_t) {
+    _pendingCount = 0;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::addPending(uint32_t key, uint32_t value) {
+    if (_pendingCount >= MAX_PENDING) return false;
+    _pendingKeys[_pendingCount] = key;
+    _pendingValues[_pendingCount] = value;
+    _pendingCount++;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::sendCfgValset(uint16_t) {
+    // The receiver applies a VALSET all or nothing
+    for (size_t i = 0; i < _pendingCount; i++) {
+        g_gnssConfig[_pendingKeys[i]] = _pendingValues[i];
+    }
+    _pendingCount = 0;
+    g_stats.gnssValsets++;
+    return true;
+}
+
+void SFE_UBLOX_GNSS_SERIAL::checkCallbacks() {
+    while (!g_pvtQueue.empty()) {
+        UBX_NAV_PVT_data_t pvt = g_pvtQueue.front();
+        g_pvtQueue.pop_front();
+        if (_pvtCallback) {
+            _pvtCallback(&pvt);
+            g_stats.gnssPvtDelivered++;
+        }
+    }
+    while (!g_gnssQueue.empty()) {
+        UBX_NAV_HPPOSLLH_data_t epoch = g_gnssQueue.front();
+        g_gnssQueue.pop_front();
+        if (_hpposllhCallback) {
+            _hpposllhCallback(&epoch);
+            g_stats.gnssEpochsDelivered++;
+        }
+    }
+}
+
+bool SFE_UBLOX_GNSS_SERIAL::pushRawData(uint8_t*, size_t len, bool) {
+    g_stats.rtcmBytes += (uint32_t)len;
+    g_stats.rtcmWrites++;
+    return true;
+}
@@ -0,0 +1,62 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - Simulated Devices
+ *
+ * The simulator's side of the sensor and ADC mocks. The module carries
+ * one of each device, so each is driven through a single set of hooks:
+ * - ADC: a source function sampled at the end of every conversion
+ * - IMU: reports queued with H_INTN asserted
+ * - Radar: a source function sampled when a measurement completes
+ * - GNSS: NAV-PVT and HPPOSLLH epochs queued for the next checkCallbacks(),
+ *   the TIMEPULSE pin, the receiver's configuration keys (kept across
+ *   reset(), like its flash) and a count of RTCM bytes forwarded to it
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_DEVICES_H
+#define HOST_DEVICES_H
+
+#include <Arduino.h>
+#include <functional>
+#include "Adafruit_ADS1X15.h"
+#include "SparkFun_BNO080_Arduino_Library.h"
+#include "SparkFun_Qwiic_XM125_Arduino_Library.h"
+#include "SparkFun_u-blox_GNSS_v3.h"
+
+#define GNSS_HOST_TIMEPULSE_PIN     21
+#define GNSS_HOST_PULSE_WIDTH_US    100000
+
+struct HostDeviceStats {
+    uint32_t adcConversions;
+    uint32_t imuReportsQueued;
+    uint32_t imuReportsRead;
+    uint32_t radarMeasurements;
+    uint32_t gnssEpochsDelivered;
+    uint32_t gnssPvtDelivered;
+    uint32_t gnssValsets;                   // Configuration messages accepted
+    uint32_t gnssTimepulses;
+    uint32_t rtcmBytes;
+    uint32_t rtcmWrites;
+};
+
+namespace HostDevices {
+    typedef std::function<int16_t(uint8_t channel)> AdcSource;
+    typedef std::function<HostRadarPeaks()> RadarSource;
+
+    void setAdcSource(AdcSource source);
+    void pushImuReport(const HostImuReport& report);
+    size_t getImuQueueDepth();
+    void setRadarSource(RadarSource source);
+    void pushGnssEpoch(const UBX_NAV_HPPOSLLH_data_t& epoch);
+    void pushGnssPvt(const UBX_NAV_PVT_data_t& pvt);
+    bool getGnssConfig(uint32_t key, uint32_t* value);  // False until the firmware sets it
+    uint64_t getGnssEpochPeriodMicros();    // From CFG-RATE-MEAS, 1Hz factory default
+    void pulseTimepulse();                  // Rising edge now, falling after the pulse width
+
+    const HostDeviceStats& getStats();
+    void reset();
+}
+
+#endif // HOST_DEVICES_H
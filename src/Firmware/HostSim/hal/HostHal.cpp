@@ -0,0 +1,320 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - Virtual Time, Pins and Interrupts Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "HostHal.h"
+#include "Wire.h"
+#include <chrono>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct ScheduledEvent {
+    uint64_t at;
+    uint64_t order;             // Same-time events run in the order scheduled
+    HostHal::Event event;
+    bool operator>(const ScheduledEvent& other) const {
+        return at != other.at ? at > other.at : order > other.order;
+    }
+};
+
+struct HostTimer {
+    bool active;
+    void (*callback)();
+    uint32_t period;
+    uint64_t next;
+    HostTimerCost cost;
+};
+
+struct PinState {
+    uint8_t mode = INPUT;
+    int level = HIGH;           // Inputs idle high (pull-ups everywhere on the module)
+    int output = LOW;
+    int pwm = 0;
+    void (*handler)() = nullptr;
+    int trigger = 0;
+};
+
+uint64_t g_now = 0;
+uint64_t g_order = 0;
+std::priority_queue<ScheduledEvent, std::vector<ScheduledEvent>, std::greater<ScheduledEvent>> g_events;
+HostTimer g_timers[HOST_MAX_TIMERS];
+PinState g_pins[HOST_MAX_PINS];
+unsigned int g_pwmResolution = 8;
+HostHal::PwmListener g_pwmListener;
+bool g_serialEcho = false;
+std::string g_sdRoot;
+std::mt19937 g_random(1);
+
+uint64_t hostNanos() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void runTimer(HostTimer& timer) {
+    uint64_t start = hostNanos();
+    timer.callback();
+    uint64_t elapsed = hostNanos() - start;
+
+    timer.cost.count++;
+    timer.cost.totalNanos += elapsed;
+    if (elapsed > timer.cost.maxNanos) timer.cost.maxNanos = elapsed;
+}
+
+} // namespace
+
+uint32_t hostDebugRegister = 0;
+
+// Linker symbols DiagnosticManager::getFreeMemory() reads on the Teensy
+unsigned long _heap_end = 0;
+char* __brkval = nullptr;
+
+TwoWire Wire;
+TwoWire Wire1;
+TwoWire Wire2;
+
+HostSerial Serial(true);
+HostSerial Serial1(false);
+HostSerial Serial2(false);
+
+size_t HostSerial::write(uint8_t c) {
+    if (_console && g_serialEcho) fputc(c, stdout);
+    return 1;
+}
+
+size_t HostSerial::write(const uint8_t* buffer, size_t size) {
+    if (_console && g_serialEcho) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+// --- Virtual clock ---
+
+uint64_t HostHal::now() {
+    return g_now;
+}
+
+void HostHal::runUntil(uint64_t micros) {
+    for (;;) {
+        uint64_t next = UINT64_MAX;
+        int timer = -1;
+        for (int i = 0; i < HOST_MAX_TIMERS; i++) {
+            if (g_timers[i].active && g_timers[i].next < next) {
+                next = g_timers[i].next;
+                timer = i;
+            }
+        }
+        bool event = !g_events.empty() && g_events.top().at <= next;
+        if (event) next = g_events.top().at;
+        if (next > micros) break;
+
+        if (next > g_now) g_now = next;
+        if (event) {
+            HostHal::Event handler = g_events.top().event;
+            g_events.pop();
+            handler();
+        } else {
+            // Periodic like the PIT - the deadline moves on by exactly one period
+            g_timers[timer].next += g_timers[timer].period;
+            runTimer(g_timers[timer]);
+        }
+    }
+    if (micros > g_now) g_now = micros;
+}
+
+void HostHal::schedule(uint64_t atMicros, Event event) {
+    if (atMicros < g_now) atMicros = g_now;
+    g_events.push({ atMicros, g_order++, std::move(event) });
+}
+
+void HostHal::reset() {
+    g_now = 0;
+    while (!g_events.empty()) g_events.pop();
+    for (auto& timer : g_timers) timer = HostTimer();
+    for (auto& pin : g_pins) pin = PinState();
+    g_pwmResolution = 8;
+}
+
+// --- Pins ---
+
+void HostHal::setInput(uint8_t pin, int level) {
+    if (pin >= HOST_MAX_PINS) return;
+    PinState& state = g_pins[pin];
+    int previous = state.level;
+    state.level = level ? HIGH : LOW;
+    if (!state.handler || previous == state.level) return;
+
+    bool falling = (previous == HIGH && state.level == LOW);
+    if (state.trigger == CHANGE || (state.trigger == FALLING && falling) || (state.trigger == RISING && !falling)) {
+        state.handler();
+    }
+}
+
+int HostHal::getOutput(uint8_t pin) {
+    return pin < HOST_MAX_PINS ? g_pins[pin].output : LOW;
+}
+
+int HostHal::getPwm(uint8_t pin) {
+    return pin < HOST_MAX_PINS ? g_pins[pin].pwm : 0;
+}
+
+unsigned int HostHal::getPwmResolution() {
+    return g_pwmResolution;
+}
+
+void HostHal::setPwmListener(PwmListener listener) {
+    g_pwmListener = std::move(listener);
+}
+
+// --- Timers ---
+
+int HostHal::addTimer(void (*callback)(), uint32_t periodMicros) {
+    if (!callback || periodMicros == 0) return -1;
+    for (int i = 0; i < HOST_MAX_TIMERS; i++) {
+        if (!g_timers[i].active) {
+            g_timers[i] = HostTimer();
+            g_timers[i].active = true;
+            g_timers[i].callback = callback;
+            g_timers[i].period = periodMicros;
+            g_timers[i].next = g_now + periodMicros;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void HostHal::removeTimer(int id) {
+    if (id >= 0 && id < HOST_MAX_TIMERS) g_timers[id].active = false;
+}
+
+void HostHal::setTimerPeriod(int id, uint32_t periodMicros) {
+    if (id >= 0 && id < HOST_MAX_TIMERS && periodMicros > 0) g_timers[id].period = periodMicros;
+}
+
+bool HostHal::getTimerCost(int id, HostTimerCost* cost) {
+    if (id < 0 || id >= HOST_MAX_TIMERS || !cost || g_timers[id].period == 0) return false;
+    *cost = g_timers[id].cost;
+    return true;
+}
+
+int HostHal::getTimerCount() {
+    return HOST_MAX_TIMERS;
+}
+
+// --- Console and SD ---
+
+void HostHal::setSerialEcho(bool echo) {
+    g_serialEcho = echo;
+}
+
+bool HostHal::getSerialEcho() {
+    return g_serialEcho;
+}
+
+void HostHal::setSdRoot(const std::string& root) {
+    g_sdRoot = root;
+}
+
+const std::string& HostHal::getSdRoot() {
+    return g_sdRoot;
+}
+
+// --- Teensy core ---
+
+uint32_t millis() {
+    return (uint32_t)(g_now / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)g_now;
+}
+
+void delay(uint32_t ms) {
+    HostHal::runUntil(g_now + (uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    HostHal::runUntil(g_now + us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= HOST_MAX_PINS) return;
+    g_pins[pin].mode = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= HOST_MAX_PINS) return;
+    g_pins[pin].output = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= HOST_MAX_PINS) return LOW;
+    const PinState& state = g_pins[pin];
+    return state.mode == OUTPUT ? state.output : state.level;
+}
+
+int analogRead(uint8_t) {
+    return 0;
+}
+
+void analogWrite(uint8_t pin, int value) {
+    if (pin >= HOST_MAX_PINS) return;
+    g_pins[pin].pwm = value;
+    if (g_pwmListener) g_pwmListener(pin, value);
+}
+
+void analogWriteResolution(unsigned int bits) {
+    g_pwmResolution = bits;
+}
+
+void analogWriteFrequency(uint8_t, float) {
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode) {
+    if (pin >= HOST_MAX_PINS) return;
+    g_pins[pin].handler = handler;
+    g_pins[pin].trigger = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin >= HOST_MAX_PINS) return;
+    g_pins[pin].handler = nullptr;
+}
+
+long random(long max) {
+    return max > 0 ? (long)(g_random() % (unsigned long)max) : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    g_random.seed((uint32_t)seed);
+}
+
+uint32_t hostCycleCount() {
+    return (uint32_t)hostNanos();
+}
+
+// --- IntervalTimer ---
+
+bool IntervalTimer::begin(void (*callback)(), uint32_t periodMicros) {
+    end();
+    _id = HostHal::addTimer(callback, periodMicros);
+    return _id >= 0;
+}
+
+void IntervalTimer::end() {
+    if (_id >= 0) HostHal::removeTimer(_id);
+    _id = -1;
+}
+
+void IntervalTimer::update(uint32_t periodMicros) {
+    HostHal::setTimerPeriod(_id, periodMicros);
+}
@@ -0,0 +1,67 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - Virtual Time, Pins and Interrupts
+ *
+ * The simulator's hardware kernel:
+ * - One 64-bit virtual microsecond clock; nothing advances it but
+ *   runUntil() (the simulator main loop) and delay() (firmware code)
+ * - Events (device completions, replayed samples) and IntervalTimers run
+ *   in time order as the clock passes them, like interrupts on the module
+ * - Input pin levels set here raise attachInterrupt() handlers on edges
+ * - PWM writes are kept per pin and reported to a listener (the plant)
+ * - Host cost of each IntervalTimer callback is measured for reports
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <Arduino.h>
+#include <functional>
+#include <string>
+
+#define HOST_MAX_PINS           64
+#define HOST_MAX_TIMERS         4
+
+struct HostTimerCost {
+    uint32_t count;
+    uint64_t totalNanos;
+    uint64_t maxNanos;
+};
+
+namespace HostHal {
+    typedef std::function<void()> Event;
+    typedef std::function<void(uint8_t pin, int value)> PwmListener;
+
+    // Virtual clock
+    uint64_t now();
+    void runUntil(uint64_t micros);
+    void schedule(uint64_t atMicros, Event event);
+    void reset();
+
+    // Pins
+    void setInput(uint8_t pin, int level);        // Edge raises the attached handler
+    int getOutput(uint8_t pin);
+    int getPwm(uint8_t pin);
+    unsigned int getPwmResolution();
+    void setPwmListener(PwmListener listener);
+
+    // Timers
+    int addTimer(void (*callback)(), uint32_t periodMicros);
+    void removeTimer(int id);
+    void setTimerPeriod(int id, uint32_t periodMicros);
+    bool getTimerCost(int id, HostTimerCost* cost);
+    int getTimerCount();
+
+    // Console
+    void setSerialEcho(bool echo);
+    bool getSerialEcho();
+
+    // SD card root on the host ("" = no card)
+    void setSdRoot(const std::string& root);
+    const std::string& getSdRoot();
+}
+
+#endif // HOST_HAL_H
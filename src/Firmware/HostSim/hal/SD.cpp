@@ -0,0 +1,106 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - SD Card Implementation
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#include "SD.h"
+#include "HostHal.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+SDClass SD;
+
+std::string SDClass::hostPath(const char* path) {
+    std::string result = HostHal::getSdRoot();
+    if (path == nullptr) return result;
+    if (path[0] != '/') result += '/';
+    return result + path;
+}
+
+bool SDClass::begin(uint8_t) {
+    struct stat info;
+    const std::string& root = HostHal::getSdRoot();
+    return !root.empty() && stat(root.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+bool SDClass::exists(const char* path) {
+    struct stat info;
+    return !HostHal::getSdRoot().empty() && stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool SDClass::mkdir(const char* path) {
+    if (HostHal::getSdRoot().empty()) return false;
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || exists(path);
+}
+
+bool SDClass::remove(const char* path) {
+    if (HostHal::getSdRoot().empty()) return false;
+    return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+File SDClass::open(const char* path, uint8_t mode) {
+    File file;
+    std::shared_ptr<FsFile> handle(new FsFile());
+    int oflag = (mode == FILE_READ) ? O_RDONLY : (O_RDWR | O_CREAT | O_APPEND);
+    if (handle->open(&sdfs, path, oflag)) file._file = handle;
+    return file;
+}
+
+int File::available() {
+    uint64_t length = size();
+    uint64_t at = position();
+    return at < length ? (int)min(length - at, (uint64_t)INT32_MAX) : 0;
+}
+
+bool FsFile::open(SdFs*, const char* path, int oflag) {
+    close();
+    if (HostHal::getSdRoot().empty()) return false;
+    _fd = ::open(SDClass::hostPath(path).c_str(), oflag, 0644);
+    return _fd >= 0;
+}
+
+bool FsFile::close() {
+    if (_fd < 0) return false;
+    ::close(_fd);
+    _fd = -1;
+    return true;
+}
+
+bool FsFile::sync() {
+    // Written data is already with the host OS - no need to hit the disk
+    return _fd >= 0;
+}
+
+size_t FsFile::write(const uint8_t* buffer, size_t size) {
+    if (_fd < 0) return 0;
+    ssize_t written = ::write(_fd, buffer, size);
+    return written < 0 ? 0 : (size_t)written;
+}
+
+int FsFile::read(void* buffer, size_t size) {
+    if (_fd < 0) return -1;
+    return (int)::read(_fd, buffer, size);
+}
+
+int FsFile::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+uint64_t FsFile::fileSize() const {
+    struct stat info;
+    return (_fd >= 0 && fstat(_fd, &info) == 0) ? (uint64_t)info.st_size : 0;
+}
+
+uint64_t FsFile::curPosition() const {
+    if (_fd < 0) return 0;
+    off_t position = lseek(_fd, 0, SEEK_CUR);
+    return position < 0 ? 0 : (uint64_t)position;
+}
+
+bool FsFile::seekSet(uint64_t position) {
+    return _fd >= 0 && lseek(_fd, (off_t)position, SEEK_SET) == (off_t)position;
+}
@@ -0,0 +1,101 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - SD Card
+ *
+ * SD, FsFile and File backed by a directory on the host (HostHal::setSdRoot()),
+ * so diagnostic logs, binary logs and black-box files written by the
+ * simulated module can be inspected and decoded like ones off a real card,
+ * and files put there (a field DEM) are read back as the card's.
+ * An empty root means no card is fitted and SD.begin() fails.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include <Arduino.h>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+
+#define BUILTIN_SDCARD  254
+#define FILE_READ       0
+#define FILE_WRITE      1       // Appends, as on the Teensy
+
+struct SdFs {};
+
+class FsFile : public Stream {
+public:
+    FsFile() : _fd(-1) {}
+    ~FsFile() { close(); }
+    FsFile(const FsFile&) = delete;
+    FsFile& operator=(const FsFile&) = delete;
+
+    bool open(SdFs* fs, const char* path, int oflag);
+    bool close();
+    bool sync();
+    bool isOpen() const { return _fd >= 0; }
+    explicit operator bool() const { return isOpen(); }
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    size_t write(const void* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    int read(void* buffer, size_t size);
+    int read() override;
+
+    uint64_t fileSize() const;
+    uint64_t curPosition() const;
+    bool seekSet(uint64_t position);
+
+    // The card is always pre-allocated and contiguous on the host
+    bool preAllocate(uint64_t) { return isOpen(); }
+    bool isContiguous() const { return isOpen(); }
+
+private:
+    int _fd;
+};
+
+// Arduino SD handle as SD.open() returns it - copies share the open file
+class File : public Stream {
+public:
+    File() {}
+
+    explicit operator bool() const { return _file && _file->isOpen(); }
+    void close() { if (_file) _file->close(); _file.reset(); }
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override { return *this ? _file->write(buffer, size) : 0; }
+    int read(void* buffer, size_t size) { return *this ? _file->read(buffer, size) : -1; }
+    int read() override { return *this ? _file->read() : -1; }
+    int available() override;
+
+    uint64_t size() const { return *this ? _file->fileSize() : 0; }
+    uint64_t position() const { return *this ? _file->curPosition() : 0; }
+    bool seek(uint64_t position) { return *this && _file->seekSet(position); }
+
+private:
+    friend class SDClass;
+    std::shared_ptr<FsFile> _file;
+};
+
+class SDClass {
+public:
+    SdFs sdfs;
+
+    bool begin(uint8_t csPin);
+    File open(const char* path, uint8_t mode = FILE_READ);
+    bool exists(const char* path);
+    bool mkdir(const char* path);
+    bool remove(const char* path);
+
+    // Host path for a card path
+    static std::string hostPath(const char* path);
+};
+
+extern SDClass SD;
+
+#endif // HOST_SD_H
@@ -0,0 +1,16 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - SPI
+ *
+ * Nothing on the host talks SPI (the SD card is a directory, see SD.h).
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <Arduino.h>
+
+#endif // HOST_SPI_H
@@ -0,0 +1,99 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - BNO080 IMU
+ *
+ * Report FIFO fed by the simulator (HostDevices::pushImuReport()):
+ * - H_INTN (pin 22) goes low when a report is queued and back high once
+ *   the last one has been read, like the SH-2 host interface
+ * - getReadings()/dataAvailable() consume one report and update the
+ *   values returned by the getters
+ * - receivePacket() serves the same reports as SHTP packets for batched
+ *   acquisition: once the gyro-integrated rotation vector is enabled with
+ *   a Set Feature sendPacket(), each report becomes an accelerometer/linear
+ *   acceleration batch followed by a channel 5 rotation vector packet
+ * - Library feature enables and calibration are accepted and ignored
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_SPARKFUN_BNO080_H
+#define HOST_SPARKFUN_BNO080_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define BNO080_DEFAULT_ADDRESS              0x4B
+
+#define SENSOR_REPORTID_ACCELEROMETER       0x01
+#define SENSOR_REPORTID_GYROSCOPE           0x02
+#define SENSOR_REPORTID_LINEAR_ACCELERATION 0x04
+#define SENSOR_REPORTID_ROTATION_VECTOR     0x05
+#define SENSOR_REPORTID_GAME_ROTATION_VECTOR 0x08
+
+#define BNO_HOST_INT_PIN                    22
+#define MAX_PACKET_SIZE                     128
+
+// One report as the simulator queues it - all values carried together
+struct HostImuReport {
+    uint16_t reportId;
+    float quatI, quatJ, quatK, quatReal;
+    float accelX, accelY, accelZ;           // m/s^2 including gravity
+    float linAccelX, linAccelY, linAccelZ;  // m/s^2
+    float gyroX, gyroY, gyroZ;              // rad/s
+    uint8_t quatAccuracy, accelAccuracy, gyroAccuracy, linAccelAccuracy;
+};
+
+class BNO080 {
+public:
+    BNO080();
+
+    bool begin(uint8_t address = BNO080_DEFAULT_ADDRESS, TwoWire& wire = Wire, uint8_t intPin = 255);
+
+    void enableRotationVector(uint16_t) {}
+    void enableGameRotationVector(uint16_t) {}
+    void enableAccelerometer(uint16_t) {}
+    void enableLinearAccelerometer(uint16_t) {}
+    void enableGyro(uint16_t) {}
+    void calibrateAccelerometer() {}
+    void calibrateGyro() {}
+    void calibrateAll() {}
+
+    uint16_t getReadings();
+    bool dataAvailable() { return getReadings() != 0; }
+
+    bool receivePacket();
+    bool sendPacket(uint8_t channelNumber, uint8_t dataLength);
+    uint8_t shtpHeader[4];
+    uint8_t shtpData[MAX_PACKET_SIZE];
+
+    float getQuatI() const { return _report.quatI; }
+    float getQuatJ() const { return _report.quatJ; }
+    float getQuatK() const { return _report.quatK; }
+    float getQuatReal() const { return _report.quatReal; }
+    float getAccelX() const { return _report.accelX; }
+    float getAccelY() const { return _report.accelY; }
+    float getAccelZ() const { return _report.accelZ; }
+    float getLinAccelX() const { return _report.linAccelX; }
+    float getLinAccelY() const { return _report.linAccelY; }
+    float getLinAccelZ() const { return _report.linAccelZ; }
+    float getGyroX() const { return _report.gyroX; }
+    float getGyroY() const { return _report.gyroY; }
+    float getGyroZ() const { return _report.gyroZ; }
+    uint8_t getQuatAccuracy() const { return _report.quatAccuracy; }
+    uint8_t getAccelAccuracy() const { return _report.accelAccuracy; }
+    uint8_t getGyroAccuracy() const { return _report.gyroAccuracy; }
+    uint8_t getLinAccelAccuracy() const { return _report.linAccelAccuracy; }
+
+private:
+    HostImuReport _report;
+    bool _gyroRvEnabled = false;
+    bool _accelEnabled = false;
+    bool _linAccelEnabled = false;
+    bool _gyroRvPending = false;        // Second packet of the current report still to read
+
+    void encodeMotionBatch();
+    void encodeGyroRv();
+};
+
+#endif // HOST_SPARKFUN_BNO080_H
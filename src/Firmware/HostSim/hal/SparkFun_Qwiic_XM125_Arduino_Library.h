@@ -0,0 +1,78 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - XM125 Radar (distance detector)
+ *
+ * START_DETECTOR sets the detector BUSY bit for one measurement time, which
+ * grows with the start-end window; when it clears, the peaks are latched
+ * from the simulator (HostDevices::setRadarSource()) and any outside the
+ * window are dropped. Configuration registers read back what was written.
+ * busyWait() advances the clock by the command time.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_SPARKFUN_XM125_H
+#define HOST_SPARKFUN_XM125_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define SFE_XM125_I2C_ADDRESS                   0x52
+
+#define SFE_XM125_DISTANCE_APPLY_CONFIG_AND_CALIBRATE 1
+#define SFE_XM125_DISTANCE_APPLY_CONFIGURATION  1
+#define SFE_XM125_DISTANCE_START_DETECTOR       2
+#define SFE_XM125_DISTANCE_RECALIBRATE          5
+#define SFE_XM125_DISTANCE_RESET_MODULE         0x52535421
+
+#define XM125_HOST_MEASURE_US                   8000    // Detector busy time over the full 0.1-3m range
+#define XM125_HOST_MEASURE_BASE_US              2000    // Part of it independent of the window
+#define XM125_HOST_FULL_RANGE_MM                2900
+#define XM125_HOST_RECALIBRATE_US               40000
+
+// One measurement as the simulator supplies it
+struct HostRadarPeaks {
+    uint32_t peak0Distance, peak1Distance;  // mm
+    int32_t peak0Strength, peak1Strength;
+    uint32_t measureDistanceError;          // 1 = no usable peak
+    uint32_t calibrationNeeded;
+};
+
+class SparkFunXM125Distance {
+public:
+    SparkFunXM125Distance();
+
+    bool begin(uint8_t address = SFE_XM125_I2C_ADDRESS, TwoWire& wire = Wire) { (void)address; (void)wire; return true; }
+
+    int32_t setCommand(uint32_t command);
+    int32_t busyWait();
+    int32_t getDetectorStatus(uint32_t& status);
+    int32_t getDetectorErrorStatus(uint32_t& status) { status = 0; return 0; }
+    int32_t getMeasureDistanceError(uint32_t& error) { error = _peaks.measureDistanceError; return 0; }
+    int32_t getCalibrationNeeded(uint32_t& needed) { needed = _peaks.calibrationNeeded; return 0; }
+
+    int32_t getPeak0Distance(uint32_t& distance) { distance = _peaks.peak0Distance; return 0; }
+    int32_t getPeak1Distance(uint32_t& distance) { distance = _peaks.peak1Distance; return 0; }
+    int32_t getPeak0Strength(int32_t& strength) { strength = _peaks.peak0Strength; return 0; }
+    int32_t getPeak1Strength(int32_t& strength) { strength = _peaks.peak1Strength; return 0; }
+
+    int32_t setStart(uint32_t start) { _start = start; return 0; }
+    int32_t getStart(uint32_t& start) { start = _start; return 0; }
+    int32_t setEnd(uint32_t end) { _end = end; return 0; }
+    int32_t getEnd(uint32_t& end) { end = _end; return 0; }
+    int32_t setThresholdSensitivity(uint32_t sensitivity) { _sensitivity = sensitivity; return 0; }
+    int32_t setFixedAmpThreshold(uint32_t threshold) { _fixedThreshold = threshold; return 0; }
+
+private:
+    uint32_t _start, _end, _sensitivity, _fixedThreshold;
+    uint64_t _busyUntil;            // Virtual time the current command completes
+    bool _measuring;                // Latch peaks when the busy period ends
+    HostRadarPeaks _peaks;
+
+    void finishCommand();
+    uint32_t measureMicros() const;
+    void applyWindow();
+};
+
+#endif // HOST_SPARKFUN_XM125_H
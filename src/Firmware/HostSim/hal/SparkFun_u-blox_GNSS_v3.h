@@ -0,0 +1,142 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - u-blox GNSS (UART)
+ *
+ * NAV-PVT and HPPOSLLH epochs queued by the simulator (HostDevices::
+ * pushGnssPvt() / pushGnssEpoch()) are handed to the registered callbacks
+ * from checkCallbacks(), PVT first as the receiver sends them, as the
+ * library does once checkUblox() has parsed them off the UART. VALSET keys
+ * land in the simulated receiver's configuration, which VALGET reads back.
+ * RTCM passed to pushRawData() is counted for the simulator to check.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_SPARKFUN_UBLOX_GNSS_V3_H
+#define HOST_SPARKFUN_UBLOX_GNSS_V3_H
+
+#include <Arduino.h>
+
+#define COM_TYPE_UBX                    0x01
+#define COM_TYPE_NMEA                   0x02
+#define COM_TYPE_RTCM3                  0x20
+
+#define VAL_LAYER_RAM                   0x01
+#define VAL_LAYER_BBR                   0x02
+#define VAL_LAYER_FLASH                 0x04
+
+// Configuration keys used by the firmware (u-blox F9 interface description)
+#define UBLOX_CFG_RATE_MEAS                         0x30210001
+#define UBLOX_CFG_RATE_NAV                          0x30210002
+#define UBLOX_CFG_NAVSPG_DYNMODEL                   0x20110021
+#define UBLOX_CFG_UART1_BAUDRATE                    0x40520001
+#define UBLOX_CFG_UART1INPROT_UBX                   0x10730001
+#define UBLOX_CFG_UART1INPROT_NMEA                  0x10730002
+#define UBLOX_CFG_UART1INPROT_RTCM3X                0x10730004
+#define UBLOX_CFG_UART1OUTPROT_UBX                  0x10740001
+#define UBLOX_CFG_UART1OUTPROT_NMEA                 0x10740002
+#define UBLOX_CFG_UART1OUTPROT_RTCM3X               0x10740004
+#define UBLOX_CFG_MSGOUT_UBX_NAV_PVT_UART1          0x20910007
+#define UBLOX_CFG_MSGOUT_UBX_NAV_HPPOSLLH_UART1     0x20910034
+#define UBLOX_CFG_TP_TIMEGRID_TP1                   0x2005000c
+
+typedef enum {
+    DYN_MODEL_PORTABLE = 0,
+    DYN_MODEL_STATIONARY = 2,
+    DYN_MODEL_PEDESTRIAN = 3,
+    DYN_MODEL_AUTOMOTIVE = 4,
+    DYN_MODEL_SEA = 5,
+    DYN_MODEL_AIRBORNE1g = 6,
+    DYN_MODEL_AIRBORNE2g = 7,
+    DYN_MODEL_AIRBORNE4g = 8
+} dynModel;
+
+typedef struct {
+    uint8_t version;
+    uint8_t reserved1[2];
+    union {
+        uint8_t all;
+        struct {
+            uint8_t invalidLlh : 1;
+        } bits;
+    } flags;
+    uint32_t iTOW;
+    int32_t lon;            // deg * 1e-7
+    int32_t lat;
+    int32_t height;         // mm
+    int32_t hMSL;
+    int8_t lonHp;           // deg * 1e-9
+    int8_t latHp;
+    int8_t heightHp;        // mm * 0.1
+    int8_t hMSLHp;
+    uint32_t hAcc;          // mm * 0.1
+    uint32_t vAcc;
+} UBX_NAV_HPPOSLLH_data_t;
+
+// Fields the firmware reads, with the library's names and units
+typedef struct {
+    uint32_t iTOW;
+    uint8_t fixType;        // 3 = 3D
+    union {
+        uint8_t all;
+        struct {
+            uint8_t gnssFixOK : 1;
+            uint8_t diffSoln : 1;
+            uint8_t psmState : 3;
+            uint8_t headVehValid : 1;
+            uint8_t carrSoln : 2;
+        } bits;
+    } flags;
+    uint8_t numSV;
+    int32_t lon;            // deg * 1e-7
+    int32_t lat;
+    int32_t hMSL;           // mm
+    uint32_t hAcc;          // mm
+    int32_t velN;           // mm/s
+    int32_t velE;
+    int32_t velD;
+    int32_t gSpeed;         // mm/s
+    int32_t headMot;        // deg * 1e-5
+    uint32_t sAcc;          // mm/s
+    uint32_t headAcc;       // deg * 1e-5
+} UBX_NAV_PVT_data_t;
+
+class SFE_UBLOX_GNSS_SERIAL {
+public:
+    SFE_UBLOX_GNSS_SERIAL();
+
+    bool begin(Stream& port, uint16_t maxWait = 1100, bool assumeSuccess = false);
+
+    bool setAutoHPPOSLLHcallbackPtr(void (*callback)(UBX_NAV_HPPOSLLH_data_t*), uint8_t = VAL_LAYER_RAM, uint16_t = 1100);
+    bool setAutoPVTcallbackPtr(void (*callback)(UBX_NAV_PVT_data_t*), uint8_t = VAL_LAYER_RAM, uint16_t = 1100);
+
+    // Configuration interface - single keys and batched VALSET
+    bool setVal8(uint32_t key, uint8_t value, uint8_t = VAL_LAYER_RAM, uint16_t = 1100);
+    bool setVal32(uint32_t key, uint32_t value, uint8_t = VAL_LAYER_RAM, uint16_t = 1100);
+    bool getVal8(uint32_t key, uint8_t* value, uint8_t = VAL_LAYER_RAM, uint16_t = 1100);
+    bool getVal16(uint32_t key, uint16_t* value, uint8_t = VAL_LAYER_RAM, uint16_t = 1100);
+    bool getVal32(uint32_t key, uint32_t* value, uint8_t = VAL_LAYER_RAM, uint16_t = 1100);
+    bool newCfgValset(uint8_t layer = VAL_LAYER_RAM | VAL_LAYER_BBR);
+    bool addCfgValset8(uint32_t key, uint8_t value) { return addPending(key, value); }
+    bool addCfgValset16(uint32_t key, uint16_t value) { return addPending(key, value); }
+    bool addCfgValset32(uint32_t key, uint32_t value) { return addPending(key, value); }
+    bool sendCfgValset(uint16_t maxWait = 1100);
+
+    bool checkUblox(uint8_t = 0) { return true; }
+    void checkCallbacks();
+    bool pushRawData(uint8_t* data, size_t len, bool = false);
+
+private:
+    static const size_t MAX_PENDING = 64;   // Keys per VALSET message
+
+    void (*_hpposllhCallback)(UBX_NAV_HPPOSLLH_data_t*);
+    void (*_pvtCallback)(UBX_NAV_PVT_data_t*);
+    uint32_t _pendingKeys[MAX_PENDING];
+    uint32_t _pendingValues[MAX_PENDING];
+    size_t _pendingCount;
+
+    bool addPending(uint32_t key, uint32_t value);
+};
+
+#endif // HOST_SPARKFUN_UBLOX_GNSS_V3_H
@@ -0,0 +1,136 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - Arduino String
+ *
+ * Just enough of the Arduino String class for the firmware sources the
+ * simulator builds, backed by std::string.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class String {
+public:
+    String(const char* text = "") : _text(text ? text : "") {}
+    String(const std::string& text) : _text(text) {}
+    String(char c) : _text(1, c) {}
+    String(unsigned char value, unsigned char base = DEC) { formatUnsigned(value, base); }
+    String(int value, unsigned char base = DEC) { formatSigned(value, base); }
+    String(unsigned int value, unsigned char base = DEC) { formatUnsigned(value, base); }
+    String(long value, unsigned char base = DEC) { formatSigned(value, base); }
+    String(unsigned long value, unsigned char base = DEC) { formatUnsigned(value, base); }
+    String(long long value, unsigned char base = DEC) { formatSigned(value, base); }
+    String(unsigned long long value, unsigned char base = DEC) { formatUnsigned(value, base); }
+    String(float value, unsigned char decimals = 2) { formatFloat(value, decimals); }
+    String(double value, unsigned char decimals = 2) { formatFloat(value, decimals); }
+
+    const char* c_str() const { return _text.c_str(); }
+    unsigned int length() const { return (unsigned int)_text.length(); }
+    void reserve(unsigned int size) { _text.reserve(size); }
+
+    char charAt(unsigned int index) const { return index < _text.length() ? _text[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    String substring(unsigned int from) const { return from < _text.length() ? String(_text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= _text.length()) return String();
+        return String(_text.substr(from, to - from));
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return toIndex(_text.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return toIndex(_text.find(s._text, from)); }
+    int lastIndexOf(char c) const { return toIndex(_text.rfind(c)); }
+
+    bool startsWith(const String& s) const { return _text.compare(0, s._text.length(), s._text) == 0; }
+    bool endsWith(const String& s) const {
+        return _text.length() >= s._text.length() &&
+               _text.compare(_text.length() - s._text.length(), s._text.length(), s._text) == 0;
+    }
+    bool equals(const String& s) const { return _text == s._text; }
+
+    long toInt() const { return strtol(_text.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(_text.c_str(), nullptr); }
+
+    void trim() {
+        size_t start = _text.find_first_not_of(" \t\r\n");
+        size_t end = _text.find_last_not_of(" \t\r\n");
+        _text = (start == std::string::npos) ? std::string() : _text.substr(start, end - start + 1);
+    }
+    void toUpperCase() { for (auto& c : _text) c = (char)toupper((unsigned char)c); }
+    void toLowerCase() { for (auto& c : _text) c = (char)tolower((unsigned char)c); }
+
+    String& operator+=(const String& s) { _text += s._text; return *this; }
+    String& operator+=(const char* s) { _text += s ? s : ""; return *this; }
+    String& operator+=(char c) { _text += c; return *this; }
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    String& operator+=(T value) { _text += String(value)._text; return *this; }
+    bool concat(const String& s) { _text += s._text; return true; }
+
+    bool operator==(const String& s) const { return _text == s._text; }
+    bool operator==(const char* s) const { return _text == (s ? s : ""); }
+    bool operator!=(const String& s) const { return _text != s._text; }
+    bool operator!=(const char* s) const { return !(*this == s); }
+    bool operator<(const String& s) const { return _text < s._text; }
+
+    const std::string& str() const { return _text; }
+
+private:
+    std::string _text;
+
+    static int toIndex(size_t position) { return position == std::string::npos ? -1 : (int)position; }
+
+    void formatUnsigned(unsigned long long value, unsigned char base) {
+        if (base < 2 || base > 36) base = DEC;
+        char buffer[72];
+        int i = sizeof(buffer) - 1;
+        buffer[i] = '\0';
+        do {
+            int digit = (int)(value % base);
+            buffer[--i] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+            value /= base;
+        } while (value > 0);
+        _text = &buffer[i];
+    }
+
+    void formatSigned(long long value, unsigned char base) {
+        if (base == DEC && value < 0) {
+            formatUnsigned((unsigned long long)(-value), base);
+            _text.insert(_text.begin(), '-');
+        } else if (base == DEC) {
+            formatUnsigned((unsigned long long)value, base);
+        } else {
+            // Other bases print the two's complement pattern, as on the device
+            formatUnsigned((unsigned long long)(unsigned long)value, base);
+        }
+    }
+
+    void formatFloat(double value, unsigned char decimals) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+        _text = buffer;
+    }
+};
+
+inline String operator+(const String& a, const String& b) { return String(a.str() + b.str()); }
+inline String operator+(const String& a, const char* b) { return String(a.str() + (b ? b : "")); }
+inline String operator+(const char* a, const String& b) { return String(std::string(a ? a : "") + b.str()); }
+inline String operator+(const String& a, char b) { return String(a.str() + b); }
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value>::type>
+inline String operator+(const String& a, T b) { return a + String(b); }
+
+#endif // HOST_WSTRING_H
@@ -0,0 +1,37 @@
+/*
+ * ABLS: Automatic Boom Levelling System
+ * Host HAL - I2C
+ *
+ * The simulated devices are reached through their library mocks, so the
+ * bus itself only has to accept configuration calls.
+ *
+ * Author: James Hassall @ RobotsGoFarming.com
+ * Version: 1.0.0
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire : public Stream {
+public:
+    void begin() {}
+    void end() {}
+    void setClock(uint32_t frequency) { _clock = frequency; }
+    uint32_t getClock() const { return _clock; }
+    void beginTransmission(uint8_t) {}
+    uint8_t endTransmission(bool = true) { return 0; }
+    uint8_t requestFrom(uint8_t, uint8_t, bool = true) { return 0; }
+    using Print::write;
+    size_t write(uint8_t) override { return 1; }
+
+private:
+    uint32_t _clock = 100000;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+extern TwoWire Wire2;
+
+#endif // HOST_WIRE_H
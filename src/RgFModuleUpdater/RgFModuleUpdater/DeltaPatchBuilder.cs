@@ -0,0 +1,340 @@
+/*
+ * DeltaPatchBuilder.cs
+ *
+ * Builds delta firmware patches ("RgFD" format) for the module-side
+ * DeltaPatcher. A patch rebuilds the new image from the image currently
+ * running on the module, so only changed bytes cross the network.
+ *
+ * Format (little-endian) - see DeltaPatcher.h in the module firmware:
+ *   Header: magic, version, source size + SHA256, target size + SHA256, CRC32
+ *   Records: varint diffLength, varint extraLength, zigzag varint seek,
+ *            diff as (zeroRun, literalRun, literals) pairs, extra literals
+ *
+ * Author: RgF Engineering
+ * Version: 1.0.0
+ */
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Security.Cryptography;
+
+namespace RgFModuleUpdater
+{
+    public static class DeltaPatchBuilder
+    {
+        public const uint PatchMagic = 0x44466752; // "RgFD"
+        public const ushort PatchVersion = 1;
+        public const int HeaderSize = 84;
+
+        private const int MinMatch = 16;           // Shortest exact match worth a record
+        private const int HashBits = 20;
+        private const int MaxCandidates = 32;       // Source positions examined per lookup
+
+        private static readonly uint[] CrcTable = BuildCrcTable();
+
+        /// <summary>
+        /// Build a patch that turns <paramref name="source"/> (the running image) into <paramref name="target"/>.
+        /// </summary>
+        public static byte[] Build(byte[] source, byte[] target)
+        {
+            if (target.Length == 0)
+            {
+                throw new ArgumentException("Target image is empty", nameof(target));
+            }
+
+            using var output = new MemoryStream();
+            WriteHeader(output, source, target);
+
+            var index = new SourceIndex(source);
+            long sourcePos = 0;
+            int t = 0;
+            int literalStart = 0;
+
+            // Leading literals (before the first match) go in a record with no diff
+            var (matchSource, matchLength) = FindMatch(source, target, index, t, sourcePos);
+            while (matchLength == 0 && t < target.Length)
+            {
+                t++;
+                (matchSource, matchLength) = FindMatch(source, target, index, t, sourcePos);
+            }
+
+            if (t > 0 || matchLength == 0)
+            {
+                int seekTo = matchLength > 0 ? matchSource : 0;
+                WriteRecord(output, source, target, 0, 0, 0, t, seekTo - sourcePos);
+                sourcePos = seekTo;
+            }
+
+            while (t < target.Length)
+            {
+                // Approximate extension: carry on through small differences
+                int diffLength = ExtendApproximate(source, target, matchSource, t);
+                int diffEnd = t + diffLength;
+
+                // Literals until the next usable match
+                literalStart = diffEnd;
+                int next = diffEnd;
+                int nextSource = 0, nextLength = 0;
+                while (next < target.Length)
+                {
+                    (nextSource, nextLength) = FindMatch(source, target, index, next, matchSource + diffLength);
+                    if (nextLength > 0) break;
+                    next++;
+                }
+
+                long after = matchSource + diffLength;
+                long seek = nextLength > 0 ? nextSource - after : 0;
+                WriteRecord(output, source, target, matchSource, t, diffLength, next - literalStart, seek);
+
+                t = next;
+                matchSource = nextSource;
+                sourcePos = after + seek;
+            }
+
+            return output.ToArray();
+        }
+
+        /// <summary>
+        /// Apply a patch on the PC - used to check a patch before it is published.
+        /// </summary>
+        public static byte[] Apply(byte[] source, byte[] patch)
+        {
+            if (patch.Length < HeaderSize || BitConverter.ToUInt32(patch, 0) != PatchMagic)
+            {
+                throw new InvalidDataException("Not a delta patch");
+            }
+            if (Crc32(patch, 0, 80) != BitConverter.ToUInt32(patch, 80))
+            {
+                throw new InvalidDataException("Patch header CRC mismatch");
+            }
+
+            uint sourceSize = BitConverter.ToUInt32(patch, 8);
+            uint targetSize = BitConverter.ToUInt32(patch, 44);
+            if (sourceSize != source.Length ||
+                !SHA256.HashData(source).AsSpan().SequenceEqual(patch.AsSpan(12, 32)))
+            {
+                throw new InvalidDataException("Patch was not built against this source image");
+            }
+
+            var target = new byte[targetSize];
+            int p = HeaderSize, t = 0;
+            long s = 0;
+
+            while (t < targetSize)
+            {
+                uint diffLength = ReadVarint(patch, ref p);
+                uint extraLength = ReadVarint(patch, ref p);
+                uint zigzag = ReadVarint(patch, ref p);
+                long seek = (int)((zigzag >> 1) ^ (0 - (zigzag & 1)));
+
+                uint remaining = diffLength;
+                while (remaining > 0)
+                {
+                    uint zeros = ReadVarint(patch, ref p);
+                    for (uint i = 0; i < zeros; i++) target[t++] = source[s++];
+                    uint literals = ReadVarint(patch, ref p);
+                    for (uint i = 0; i < literals; i++) target[t++] = (byte)(source[s++] + patch[p++]);
+                    remaining -= zeros + literals;
+                }
+
+                Array.Copy(patch, p, target, t, extraLength);
+                p += (int)extraLength;
+                t += (int)extraLength;
+                s += seek;
+            }
+
+            if (!SHA256.HashData(target).AsSpan().SequenceEqual(patch.AsSpan(48, 32)))
+            {
+                throw new InvalidDataException("Rebuilt image hash mismatch");
+            }
+            return target;
+        }
+
+        private static void WriteHeader(Stream output, byte[] source, byte[] target)
+        {
+            var header = new byte[HeaderSize];
+            BitConverter.GetBytes(PatchMagic).CopyTo(header, 0);
+            BitConverter.GetBytes(PatchVersion).CopyTo(header, 4);
+            BitConverter.GetBytes((uint)source.Length).CopyTo(header, 8);
+            SHA256.HashData(source).CopyTo(header, 12);
+            BitConverter.GetBytes((uint)target.Length).CopyTo(header, 44);
+            SHA256.HashData(target).CopyTo(header, 48);
+            BitConverter.GetBytes(Crc32(header, 0, 80)).CopyTo(header, 80);
+            output.Write(header, 0, header.Length);
+        }
+
+        private static void WriteRecord(Stream output, byte[] source, byte[] target,
+                                        long sourcePos, int targetPos, int diffLength, int extraLength, long seek)
+        {
+            WriteVarint(output, (uint)diffLength);
+            WriteVarint(output, (uint)extraLength);
+            WriteVarint(output, (uint)((seek << 1) ^ (seek >> 63)));
+
+            // Diff as (zeroRun, literalRun) pairs - a literal run only ends at
+            // two or more zeros, as a lone zero costs less inside the run
+            int i = 0;
+            while (i < diffLength)
+            {
+                int zeros = 0;
+                while (i + zeros < diffLength && target[targetPos + i + zeros] == source[sourcePos + i + zeros]) zeros++;
+                int literalStart = i + zeros;
+                int literals = 0;
+                while (literalStart + literals < diffLength)
+                {
+                    int k = literalStart + literals;
+                    bool zeroHere = target[targetPos + k] == source[sourcePos + k];
+                    bool zeroNext = k + 1 < diffLength && target[targetPos + k + 1] == source[sourcePos + k + 1];
+                    if (zeroHere && (zeroNext || k + 1 == diffLength)) break;
+                    literals++;
+                }
+
+                WriteVarint(output, (uint)zeros);
+                WriteVarint(output, (uint)literals);
+                for (int k = 0; k < literals; k++)
+                {
+                    int n = literalStart + k;
+                    output.WriteByte((byte)(target[targetPos + n] - source[sourcePos + n]));
+                }
+                i = literalStart + literals;
+            }
+
+            output.Write(target, targetPos + diffLength, extraLength);
+        }
+
+        private static (int source, int length) FindMatch(byte[] source, byte[] target, SourceIndex index, int t, long expected)
+        {
+            if (t + MinMatch > target.Length) return (0, 0);
+
+            // Keep the current alignment when it still matches
+            if (expected >= 0 && expected + MinMatch <= source.Length &&
+                MatchLength(source, (int)expected, target, t) >= MinMatch)
+            {
+                return ((int)expected, MatchLength(source, (int)expected, target, t));
+            }
+
+            int bestSource = 0, bestLength = 0, examined = 0;
+            for (int s = index.First(target, t); s >= 0 && examined < MaxCandidates; s = index.Next(s), examined++)
+            {
+                int length = MatchLength(source, s, target, t);
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestSource = s;
+                }
+            }
+            return bestLength >= MinMatch ? (bestSource, bestLength) : (0, 0);
+        }
+
+        private static int MatchLength(byte[] source, int s, byte[] target, int t)
+        {
+            int length = 0;
+            while (s + length < source.Length && t + length < target.Length && source[s + length] == target[t + length]) length++;
+            return length;
+        }
+
+        // bsdiff forward extension: the length maximising 2 * matches - length
+        private static int ExtendApproximate(byte[] source, byte[] target, int s, int t)
+        {
+            int matches = 0, bestScore = 0, bestLength = 0;
+            for (int i = 0; s + i < source.Length && t + i < target.Length; i++)
+            {
+                if (source[s + i] == target[t + i]) matches++;
+                int score = 2 * matches - (i + 1);
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestLength = i + 1;
+                }
+                else if (score < bestScore - 2 * MinMatch)
+                {
+                    break;
+                }
+            }
+            return bestLength;
+        }
+
+        private static void WriteVarint(Stream output, uint value)
+        {
+            while (value >= 0x80)
+            {
+                output.WriteByte((byte)(value | 0x80));
+                value >>= 7;
+            }
+            output.WriteByte((byte)value);
+        }
+
+        private static uint ReadVarint(byte[] data, ref int position)
+        {
+            uint value = 0;
+            for (int shift = 0; shift <= 28; shift += 7)
+            {
+                byte b = data[position++];
+                value |= (uint)(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) return value;
+            }
+            throw new InvalidDataException("Bad varint in patch");
+        }
+
+        public static uint Crc32(byte[] data, int offset, int length)
+        {
+            uint crc = 0xFFFFFFFF;
+            for (int i = offset; i < offset + length; i++)
+            {
+                crc = (crc >> 8) ^ CrcTable[(crc ^ data[i]) & 0xFF];
+            }
+            return ~crc;
+        }
+
+        private static uint[] BuildCrcTable()
+        {
+            var table = new uint[256];
+            for (uint i = 0; i < 256; i++)
+            {
+                uint crc = i;
+                for (int j = 0; j < 8; j++)
+                {
+                    crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        // Hash chains over 8-byte windows of the source image
+        private sealed class SourceIndex
+        {
+            private readonly byte[] _source;
+            private readonly int[] _head;
+            private readonly int[] _chain;
+
+            public SourceIndex(byte[] source)
+            {
+                _source = source;
+                _head = new int[1 << HashBits];
+                _chain = new int[Math.Max(source.Length, 1)];
+                Array.Fill(_head, -1);
+
+                for (int s = 0; s + 8 <= source.Length; s++)
+                {
+                    uint h = Hash(source, s);
+                    _chain[s] = _head[h];
+                    _head[h] = s;
+                }
+            }
+
+            public int First(byte[] data, int position)
+            {
+                return position + 8 <= data.Length ? _head[Hash(data, position)] : -1;
+            }
+
+            public int Next(int s) => _chain[s];
+
+            private static uint Hash(byte[] data, int position)
+            {
+                ulong v = BitConverter.ToUInt64(data, position);
+                return (uint)((v * 0x9E3779B97F4A7C15UL) >> (64 - HashBits));
+            }
+        }
+    }
+}
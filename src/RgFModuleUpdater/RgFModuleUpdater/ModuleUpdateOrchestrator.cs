@@ -11,6 +11,7 @@
 using System;
 using System.Collections.Generic;
 using System.IO;
+using System.Linq;
 using System.Net;
 using System.Net.Sockets;
 using System.Security.Cryptography;
@@ -237,7 +238,8 @@ namespace RgFModuleUpdater
                 Console.WriteLine("2. Update all modules");
                 Console.WriteLine("3. Update specific module");
                 Console.WriteLine("4. List firmware files");
-                Console.WriteLine("5. Exit");
+                Console.WriteLine("5. Update all modules (multicast)");
+                Console.WriteLine("6. Exit");
                 Console.Write("Select option: ");
 
                 var input = Console.ReadLine();
@@ -260,6 +262,9 @@ namespace RgFModuleUpdater
                             ListFirmwareFiles();
                             break;
                         case "5":
+                            await MulticastUpdateAllModulesAsync();
+                            break;
+                        case "6":
                             Console.WriteLine("Shutting down...");
                             _cancellationTokenSource.Cancel();
                             _httpServer.Stop();
@@ -422,6 +427,77 @@ namespace RgFModuleUpdater
             }
         }
 
+        private async Task MulticastUpdateAllModulesAsync()
+        {
+            Console.WriteLine("=== Multicast Module Update Process ===\n");
+
+            var firmwareFiles = Directory.GetFiles(_firmwareDirectory, "*.hex");
+            if (firmwareFiles.Length == 0)
+            {
+                Console.WriteLine("No firmware files found in firmware directory.\n");
+                return;
+            }
+
+            Console.WriteLine("Available firmware files:");
+            for (int i = 0; i < firmwareFiles.Length; i++)
+            {
+                Console.WriteLine($"{i + 1}. {Path.GetFileName(firmwareFiles[i])}");
+            }
+
+            Console.Write("Select firmware file (number): ");
+            if (!int.TryParse(Console.ReadLine(), out int selection) ||
+                selection < 1 || selection > firmwareFiles.Length)
+            {
+                Console.WriteLine("Invalid selection.\n");
+                return;
+            }
+
+            var selectedFirmware = firmwareFiles[selection - 1];
+            var image = await File.ReadAllBytesAsync(selectedFirmware);
+            var version = ParseFirmwareVersion(Path.GetFileNameWithoutExtension(selectedFirmware));
+            var expected = _modules.Select(m => (byte)m.Role).ToList();
+
+            Console.WriteLine($"\nMulticasting {Path.GetFileName(selectedFirmware)} ({image.Length:N0} bytes) to all modules...");
+
+            using var distributor = new MulticastDistributor();
+            distributor.Log += message => Console.WriteLine($"  {message}");
+
+            try
+            {
+                var reports = await distributor.DistributeAsync(image, expected, version, _cancellationTokenSource.Token);
+
+                foreach (var module in _modules)
+                {
+                    if (reports.TryGetValue((byte)module.Role, out var report))
+                    {
+                        var mark = report.State == MulticastModuleState.Installed ? "✓" : "✗";
+                        Console.WriteLine($"{mark} {module.Name}: {report.State} " +
+                                          $"({report.BlocksReceived} blocks, {report.BlocksRecovered} rebuilt from parity)");
+                    }
+                    else
+                    {
+                        Console.WriteLine($"✗ {module.Name}: no response");
+                    }
+                }
+                Console.WriteLine("Installed modules must be rebooted to run the new firmware.\n");
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"✗ Multicast update failed: {ex.Message}\n");
+            }
+        }
+
+        // Version from a name like ABLS_v1.2.3 - 0.0.0 when the name carries none
+        private static (ushort Major, ushort Minor, ushort Patch) ParseFirmwareVersion(string name)
+        {
+            var match = System.Text.RegularExpressions.Regex.Match(name, @"(\d+)\.(\d+)\.(\d+)");
+            if (!match.Success)
+            {
+                return (0, 0, 0);
+            }
+            return (ushort.Parse(match.Groups[1].Value), ushort.Parse(match.Groups[2].Value), ushort.Parse(match.Groups[3].Value));
+        }
+
         private void ListFirmwareFiles()
         {
             Console.WriteLine($"Firmware directory: {_firmwareDirectory}\n");
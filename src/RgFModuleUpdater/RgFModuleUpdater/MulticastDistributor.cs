@@ -0,0 +1,466 @@
+/*
+ * MulticastDistributor.cs
+ *
+ * Sends one firmware image to several ABLS modules at once over UDP
+ * multicast - see FirmwareMulticastReceiver.h in the module firmware.
+ *
+ * Session: ANNOUNCE until every module is ready, stream the blocks with one
+ * XOR parity block per FEC group, then QUERY / repair rounds that multicast
+ * the union of the blocks the modules still report missing. Modules flash
+ * the image themselves once every block is held.
+ *
+ * Wire format is little-endian and matches the packed structs in
+ * DataPackets.h (FirmwareMulticastHeader and friends).
+ *
+ * Author: RgF Engineering
+ * Version: 1.0.0
+ */
+
+using System;
+using System.Buffers.Binary;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Net;
+using System.Net.Sockets;
+using System.Security.Cryptography;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace RgFModuleUpdater
+{
+    public enum MulticastModuleState : byte
+    {
+        Idle = 0,
+        Preparing = 1,
+        Receiving = 2,
+        Complete = 3,
+        Installed = 4,
+        Failed = 5,
+        Declined = 6
+    }
+
+    public class MulticastModuleReport
+    {
+        public byte SenderId { get; set; }
+        public MulticastModuleState State { get; set; }
+        public int BlocksReceived { get; set; }
+        public int BlocksRecovered { get; set; }
+        public int MissingCount { get; set; }
+        public List<(int First, int Count)> MissingRanges { get; set; } = new();
+        public DateTime ReceivedAt { get; set; }
+    }
+
+    public sealed class MulticastDistributor : IDisposable
+    {
+        public const ushort Magic = 0xAB17;
+        public const byte ProtocolVersion = 1;
+        public const int MulticastPort = 8006;
+        public const int ReportPort = 8007;
+        public const byte RoleAll = 0xFF;
+        public static readonly IPAddress MulticastGroup = IPAddress.Parse("239.192.1.4");
+
+        private const byte TypeAnnounce = 1;
+        private const byte TypeData = 2;
+        private const byte TypeParity = 3;
+        private const byte TypeQuery = 4;
+        private const byte TypeAbort = 5;
+        private const byte TypeReport = 6;
+
+        private const int HeaderSize = 8;
+        private const int AnnounceSize = HeaderSize + 48;
+        private const int BlockHeaderSize = HeaderSize + 4;
+        private const int ReportBaseSize = HeaderSize + 9;
+        private const int MaxBlockSize = 1024;
+        private const int MaxFecGroupSize = 32;
+        private const int MaxBlocks = 4096;
+
+        public int BlockSize { get; set; } = MaxBlockSize;
+        public int FecGroupSize { get; set; } = 8;
+        public int BlockIntervalMicroseconds { get; set; } = 3000;   // Pacing for the module's RX queue
+        public int MaxRepairRounds { get; set; } = 20;
+        public TimeSpan ReadyTimeout { get; set; } = TimeSpan.FromSeconds(60);     // Staging erase takes a while
+        public TimeSpan InstallTimeout { get; set; } = TimeSpan.FromSeconds(120);
+
+        public event Action<string>? Log;
+
+        private readonly UdpClient _sender;
+        private readonly UdpClient _reportListener;
+        private readonly IPEndPoint _groupEndPoint;
+        private readonly ConcurrentDictionary<byte, MulticastModuleReport> _reports = new();
+        private uint _sessionId;
+
+        public MulticastDistributor(IPAddress? localAddress = null)
+        {
+            _sender = new UdpClient(new IPEndPoint(localAddress ?? IPAddress.Any, 0));
+            _sender.MulticastLoopback = false;
+            _sender.Ttl = 1;
+            if (localAddress != null)
+            {
+                _sender.Client.SetSocketOption(SocketOptionLevel.IP, SocketOptionName.MulticastInterface,
+                                               localAddress.GetAddressBytes());
+            }
+
+            _reportListener = new UdpClient(ReportPort);
+            _groupEndPoint = new IPEndPoint(MulticastGroup, MulticastPort);
+        }
+
+        /// <summary>
+        /// Distribute <paramref name="image"/> to the modules in <paramref name="expectedSenders"/>
+        /// and wait for them to install it. Returns the final report from every module that answered.
+        /// </summary>
+        public async Task<IReadOnlyDictionary<byte, MulticastModuleReport>> DistributeAsync(
+            byte[] image, IReadOnlyCollection<byte> expectedSenders, (ushort Major, ushort Minor, ushort Patch) version,
+            CancellationToken cancellationToken = default)
+        {
+            if (image.Length == 0)
+            {
+                throw new ArgumentException("Firmware image is empty", nameof(image));
+            }
+            if (BlockSize < 1 || BlockSize > MaxBlockSize || FecGroupSize < 0 || FecGroupSize > MaxFecGroupSize)
+            {
+                throw new InvalidOperationException("Block or FEC group size out of range");
+            }
+
+            int blockCount = (image.Length + BlockSize - 1) / BlockSize;
+            if (blockCount > MaxBlocks)
+            {
+                throw new ArgumentException($"Image needs {blockCount} blocks, modules accept {MaxBlocks}", nameof(image));
+            }
+
+            _sessionId = (uint)RandomNumberGenerator.GetInt32(1, int.MaxValue);
+            _reports.Clear();
+
+            byte roleMask = 0;
+            foreach (var sender in expectedSenders)
+            {
+                roleMask |= (byte)(1 << sender);
+            }
+
+            var announce = BuildAnnounce(image, roleMask, blockCount, version);
+            using var listenerCts = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            var listener = Task.Run(() => ListenForReportsAsync(listenerCts.Token));
+
+            try
+            {
+                // Phase 1: announce until every module is ready (or has declined)
+                var ready = await WaitForReadyAsync(announce, expectedSenders, cancellationToken);
+                if (ready.Count == 0)
+                {
+                    throw new InvalidOperationException("No module accepted the multicast session");
+                }
+                OnLog($"Session 0x{_sessionId:X8}: {ready.Count} module(s) ready, sending {blockCount} blocks");
+
+                // Phase 2: one pass over the image with parity
+                var allBlocks = Enumerable.Range(0, blockCount).ToList();
+                await SendBlocksAsync(image, allBlocks, announce, true, cancellationToken);
+
+                // Phase 3: repair rounds driven by the module reports
+                for (int round = 1; ; round++)
+                {
+                    var missing = await QueryMissingAsync(ready, cancellationToken);
+                    if (missing.Count == 0)
+                    {
+                        break;
+                    }
+                    if (round > MaxRepairRounds)
+                    {
+                        throw new InvalidOperationException($"{missing.Count} block(s) still missing after {MaxRepairRounds} repair rounds");
+                    }
+
+                    OnLog($"Repair round {round}: resending {missing.Count} block(s)");
+                    await SendBlocksAsync(image, missing, announce, false, cancellationToken);
+                }
+
+                // Phase 4: modules validate and flash on their own
+                await WaitForInstallAsync(ready, cancellationToken);
+                return new Dictionary<byte, MulticastModuleReport>(_reports);
+            }
+            catch
+            {
+                SendControl(TypeAbort);
+                throw;
+            }
+            finally
+            {
+                listenerCts.Cancel();
+                try { await listener; } catch (OperationCanceledException) { }
+            }
+        }
+
+        private async Task<List<byte>> WaitForReadyAsync(byte[] announce, IReadOnlyCollection<byte> expected,
+                                                         CancellationToken cancellationToken)
+        {
+            var deadline = DateTime.UtcNow + ReadyTimeout;
+            while (DateTime.UtcNow < deadline)
+            {
+                _sender.Send(announce, announce.Length, _groupEndPoint);
+                await Task.Delay(500, cancellationToken);
+
+                bool waiting = false;
+                foreach (var sender in expected)
+                {
+                    if (!_reports.TryGetValue(sender, out var report) ||
+                        report.State == MulticastModuleState.Idle || report.State == MulticastModuleState.Preparing)
+                    {
+                        waiting = true;
+                    }
+                }
+                if (!waiting)
+                {
+                    break;
+                }
+            }
+
+            var ready = new List<byte>();
+            foreach (var sender in expected)
+            {
+                if (_reports.TryGetValue(sender, out var report) && report.State == MulticastModuleState.Receiving)
+                {
+                    ready.Add(sender);
+                }
+                else
+                {
+                    OnLog($"Module {sender} not joining: {(report != null ? report.State.ToString() : "no response")}");
+                }
+            }
+            return ready;
+        }
+
+        private async Task SendBlocksAsync(byte[] image, List<int> blocks, byte[] announce, bool withParity,
+                                           CancellationToken cancellationToken)
+        {
+            var datagram = new byte[BlockHeaderSize + MaxBlockSize];
+            var parity = new byte[BlockSize];
+            var pacing = Stopwatch.StartNew();
+            long interval = Stopwatch.Frequency * BlockIntervalMicroseconds / 1_000_000;
+            long nextSend = 0;
+            long nextAnnounce = Stopwatch.Frequency;
+            int groupFill = 0;
+
+            void Pace()
+            {
+                while (pacing.ElapsedTicks < nextSend)
+                {
+                    Thread.Yield();
+                }
+                nextSend = Math.Max(nextSend + interval, pacing.ElapsedTicks);
+            }
+
+            foreach (int block in blocks)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+
+                int offset = block * BlockSize;
+                int length = Math.Min(BlockSize, image.Length - offset);
+                WriteHeader(datagram, TypeData);
+                BinaryPrimitives.WriteUInt16LittleEndian(datagram.AsSpan(8), (ushort)block);
+                BinaryPrimitives.WriteUInt16LittleEndian(datagram.AsSpan(10), (ushort)length);
+                Array.Copy(image, offset, datagram, BlockHeaderSize, length);
+
+                Pace();
+                _sender.Send(datagram, BlockHeaderSize + length, _groupEndPoint);
+
+                // Parity covers the group as sent in order - a short last block is zero padded
+                if (withParity && FecGroupSize > 0)
+                {
+                    for (int i = 0; i < length; i++) parity[i] ^= image[offset + i];
+                    groupFill++;
+
+                    bool lastBlock = block == blocks[^1];
+                    if (groupFill == FecGroupSize || lastBlock)
+                    {
+                        WriteHeader(datagram, TypeParity);
+                        BinaryPrimitives.WriteUInt16LittleEndian(datagram.AsSpan(8), (ushort)(block / FecGroupSize));
+                        BinaryPrimitives.WriteUInt16LittleEndian(datagram.AsSpan(10), (ushort)BlockSize);
+                        Array.Copy(parity, 0, datagram, BlockHeaderSize, BlockSize);
+
+                        Pace();
+                        _sender.Send(datagram, BlockHeaderSize + BlockSize, _groupEndPoint);
+                        Array.Clear(parity);
+                        groupFill = 0;
+                    }
+                }
+
+                // Re-announce so a module that rebooted mid-transfer rejoins
+                if (pacing.ElapsedTicks >= nextAnnounce)
+                {
+                    _sender.Send(announce, announce.Length, _groupEndPoint);
+                    nextAnnounce += Stopwatch.Frequency;
+                }
+
+                if ((block & 0xFF) == 0)
+                {
+                    await Task.Yield();
+                }
+            }
+        }
+
+        private async Task<List<int>> QueryMissingAsync(List<byte> modules, CancellationToken cancellationToken)
+        {
+            // A module answers a QUERY with at most FIRMWARE_MCAST_MAX_RANGES ranges,
+            // so large gaps take more than one round
+            var missing = new SortedSet<int>();
+            var asked = DateTime.UtcNow;
+
+            for (int attempt = 0; attempt < 5; attempt++)
+            {
+                SendControl(TypeQuery);
+                await Task.Delay(300, cancellationToken);
+
+                if (modules.All(m => _reports.TryGetValue(m, out var r) && r.ReceivedAt >= asked))
+                {
+                    break;
+                }
+            }
+
+            foreach (var module in modules)
+            {
+                if (!_reports.TryGetValue(module, out var report) || report.ReceivedAt < asked)
+                {
+                    OnLog($"Module {module} did not answer the query");
+                    continue;
+                }
+                if (report.State != MulticastModuleState.Receiving)
+                {
+                    continue;
+                }
+                foreach (var (first, count) in report.MissingRanges)
+                {
+                    for (int b = first; b < first + count; b++) missing.Add(b);
+                }
+            }
+            return missing.ToList();
+        }
+
+        private async Task WaitForInstallAsync(List<byte> modules, CancellationToken cancellationToken)
+        {
+            var deadline = DateTime.UtcNow + InstallTimeout;
+            while (DateTime.UtcNow < deadline)
+            {
+                bool pending = modules.Any(m => !_reports.TryGetValue(m, out var r) ||
+                                                (r.State != MulticastModuleState.Installed &&
+                                                 r.State != MulticastModuleState.Failed));
+                if (!pending)
+                {
+                    return;
+                }
+
+                SendControl(TypeQuery);
+                await Task.Delay(2000, cancellationToken);
+            }
+            OnLog("Timed out waiting for modules to finish installing");
+        }
+
+        private async Task ListenForReportsAsync(CancellationToken cancellationToken)
+        {
+            while (!cancellationToken.IsCancellationRequested)
+            {
+                UdpReceiveResult result;
+                try
+                {
+                    result = await _reportListener.ReceiveAsync(cancellationToken);
+                }
+                catch (OperationCanceledException)
+                {
+                    return;
+                }
+                catch (SocketException ex)
+                {
+                    OnLog($"Report listener error: {ex.Message}");
+                    continue;
+                }
+
+                var report = ParseReport(result.Buffer);
+                if (report != null)
+                {
+                    _reports[report.SenderId] = report;
+                }
+            }
+        }
+
+        private MulticastModuleReport? ParseReport(byte[] data)
+        {
+            if (data.Length < ReportBaseSize ||
+                BinaryPrimitives.ReadUInt16LittleEndian(data) != Magic ||
+                data[2] != ProtocolVersion || data[3] != TypeReport ||
+                BinaryPrimitives.ReadUInt32LittleEndian(data.AsSpan(4)) != _sessionId)
+            {
+                return null;
+            }
+
+            int rangeCount = data[16];
+            if (data.Length < ReportBaseSize + rangeCount * 4)
+            {
+                return null;
+            }
+
+            var report = new MulticastModuleReport
+            {
+                SenderId = data[8],
+                State = (MulticastModuleState)data[9],
+                BlocksReceived = BinaryPrimitives.ReadUInt16LittleEndian(data.AsSpan(10)),
+                BlocksRecovered = BinaryPrimitives.ReadUInt16LittleEndian(data.AsSpan(12)),
+                MissingCount = BinaryPrimitives.ReadUInt16LittleEndian(data.AsSpan(14)),
+                ReceivedAt = DateTime.UtcNow
+            };
+            for (int i = 0; i < rangeCount; i++)
+            {
+                int p = ReportBaseSize + i * 4;
+                report.MissingRanges.Add((BinaryPrimitives.ReadUInt16LittleEndian(data.AsSpan(p)),
+                                          BinaryPrimitives.ReadUInt16LittleEndian(data.AsSpan(p + 2))));
+            }
+            return report;
+        }
+
+        private byte[] BuildAnnounce(byte[] image, byte roleMask, int blockCount, (ushort Major, ushort Minor, ushort Patch) version)
+        {
+            var announce = new byte[AnnounceSize];
+            WriteHeader(announce, TypeAnnounce);
+            announce[8] = roleMask;
+            announce[9] = (byte)FecGroupSize;
+            BinaryPrimitives.WriteUInt16LittleEndian(announce.AsSpan(10), (ushort)BlockSize);
+            BinaryPrimitives.WriteUInt32LittleEndian(announce.AsSpan(12), (uint)image.Length);
+            BinaryPrimitives.WriteUInt16LittleEndian(announce.AsSpan(16), (ushort)blockCount);
+            BinaryPrimitives.WriteUInt16LittleEndian(announce.AsSpan(18), version.Major);
+            BinaryPrimitives.WriteUInt16LittleEndian(announce.AsSpan(20), version.Minor);
+            BinaryPrimitives.WriteUInt16LittleEndian(announce.AsSpan(22), version.Patch);
+            SHA256.HashData(image).CopyTo(announce, 24);
+            return announce;
+        }
+
+        private void WriteHeader(byte[] datagram, byte type)
+        {
+            BinaryPrimitives.WriteUInt16LittleEndian(datagram, Magic);
+            datagram[2] = ProtocolVersion;
+            datagram[3] = type;
+            BinaryPrimitives.WriteUInt32LittleEndian(datagram.AsSpan(4), _sessionId);
+        }
+
+        private void SendControl(byte type)
+        {
+            var datagram = new byte[HeaderSize];
+            WriteHeader(datagram, type);
+            try
+            {
+                _sender.Send(datagram, datagram.Length, _groupEndPoint);
+            }
+            catch (SocketException ex)
+            {
+                OnLog($"Send failed: {ex.Message}");
+            }
+        }
+
+        private void OnLog(string message)
+        {
+            Log?.Invoke(message);
+        }
+
+        public void Dispose()
+        {
+            _sender.Dispose();
+            _reportListener.Dispose();
+        }
+    }
+}